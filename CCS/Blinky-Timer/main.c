@@ -46,6 +46,7 @@
 #include <driverlib/uart.h>
 
 #include <utils/uartstdio.h>
+#include "uartlog.h"
 
 /*
  * Configure the UART and its pins. This must be called before UARTprintf().
@@ -123,7 +124,7 @@ int main(void)
      * Initialize the UART.
      */
     configureUART();
-    UARTprintf("---->> Configured clock rate %d.\n", SysCtlClockGet());
+    UARTlog("---->> Configured clock rate %d.\n", SysCtlClockGet());
 
     /*
      * Here we enable GPIOF run mode clock gating by setting bit 5 of register
@@ -139,14 +140,14 @@ int main(void)
      * 0x400FE608 - 0x40000000 = 0xEF608 and the bit number is 5.
      *
      */
-    UARTprintf("---->> Enable GPIO F.\n");
+    UARTlog("---->> Enable GPIO F.\n");
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
 
     /*
      * Here we check register 108 (using the same bit band technique) until it
      * indicates that the GPIIOF is ready.
      */
-    UARTprintf("---->> Wait for GPIO F to be ready.\n");
+    UARTlog("---->> Wait for GPIO F to be ready.\n");
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF))
     {}
 
@@ -158,13 +159,13 @@ int main(void)
     /*
      * Enable the Timer peripheral.
      */
-    UARTprintf("---->> Enable the Timer peripheral.\n");
+    UARTlog("---->> Enable the Timer peripheral.\n");
     SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
 
     /*
      * Configure the timer in Periodic mode.
      */
-    UARTprintf("---->> Configure the timer is Periodic mode.\n");
+    UARTlog("---->> Configure the timer is Periodic mode.\n");
     TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
 
     /*
@@ -175,14 +176,14 @@ int main(void)
     /*
      * Set the toggle frequency to 10HZ
      */
-    UARTprintf("---->> Set the toggle frequency to 10HZ.\n");
+    UARTlog("---->> Set the toggle frequency to 10HZ.\n");
     ui32Period = (SysCtlClockGet() / 10) / 2;
     TimerLoadSet(TIMER0_BASE, TIMER_A, ui32Period - 1);
 
     /*
      * Enable interrupts globally.
      */
-    UARTprintf("---->>  Enable interrupts globally.\n");
+    UARTlog("---->>  Enable interrupts globally.\n");
     IntEnable(INT_TIMER0A);
     TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
     IntMasterEnable();
@@ -0,0 +1,65 @@
+//*****************************************************************************
+//
+// uartport.h - Handle based uartstdio interface to UART0 to UART2.
+//
+//*****************************************************************************
+
+#ifndef __UARTPORT_H__
+#define __UARTPORT_H__
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "utils/uartstdio.h"
+#include "uartline.h"
+
+//*****************************************************************************
+//
+// Built with UART_BUFFERED and UART_STDIO_PORTS, a mask of UARTs with bit 0
+// for UART0, uartstdio.c gives each of those UARTs a port of its own, beside
+// the console of UARTStdioConfig(): ring buffers sized with
+// UARTn_TX_BUFFER_SIZE and UARTn_RX_BUFFER_SIZE, powers of two defaulting to
+// UART_TX_BUFFER_SIZE and UART_RX_BUFFER_SIZE, an echo setting and an
+// interrupt handler, UARTPortnIntHandler(), which the projects' startup files
+// put on the UART's vector.  A port is opened with UARTPortOpen() and used
+// through the handle it returns with the counterparts of the console
+// functions.  The ports and the console are independent, so each may be
+// written from its own context; a port may not be the console's UART.  The
+// console keeps its own uDMA transmission and deferred logging, which the
+// ports do not have.  With UART_RX_LINES, the input of every port is framed
+// into lines as well (see uartline.h).
+//
+//*****************************************************************************
+typedef struct tUARTPort tUARTPort;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern tUARTPort *UARTPortOpen(uint32_t ui32PortNum, uint32_t ui32Baud,
+                               uint32_t ui32SrcClock);
+extern int UARTPortWrite(tUARTPort *psPort, const char *pcBuf,
+                         uint32_t ui32Len);
+extern void UARTPortPrintf(tUARTPort *psPort, const char *pcString, ...);
+extern void UARTPortVprintf(tUARTPort *psPort, const char *pcString,
+                            va_list vaArgP);
+extern int UARTPortGets(tUARTPort *psPort, char *pcBuf, uint32_t ui32Len);
+extern unsigned char UARTPortGetc(tUARTPort *psPort);
+extern int UARTPortPeek(tUARTPort *psPort, unsigned char ucChar);
+extern int UARTPortRxBytesAvail(tUARTPort *psPort);
+extern int UARTPortTxBytesFree(tUARTPort *psPort);
+extern void UARTPortFlushRx(tUARTPort *psPort);
+extern void UARTPortFlushTx(tUARTPort *psPort, bool bDiscard);
+extern void UARTPortEchoSet(tUARTPort *psPort, bool bEnable);
+extern bool UARTPortLineGet(tUARTPort *psPort, tUARTLine *psLine);
+extern void UARTPortLineRelease(tUARTPort *psPort, const tUARTLine *psLine);
+extern void UARTPort0IntHandler(void);
+extern void UARTPort1IntHandler(void);
+extern void UARTPort2IntHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
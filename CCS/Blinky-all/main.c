@@ -24,6 +24,7 @@
 #include "driverlib/rom.h"
 
 #include "utils/uartstdio.h"
+#include "uartlog.h"
 
 /*
  * Configure the UART and its pins. This must be called before UARTprintf().
@@ -82,7 +83,7 @@ int main(void)
      * Initialize the UART.
      */
     configureUART();
-    UARTprintf("--->> Configured clock rate %d.\n", SysCtlClockGet());
+    UARTlog("--->> Configured clock rate %d.\n", SysCtlClockGet());
 
     /*
      * Here we enable GPIOF run mode clock gating by setting bit 5 of register
@@ -98,27 +99,27 @@ int main(void)
      * 0x400FE608 - 0x40000000 = 0xEF608 and the bit number is 5.
      *
      */
-    UARTprintf("---->> Enable GPIO F.\n");
+    UARTlog("---->> Enable GPIO F.\n");
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
 
     /*
      * Here we check register 108 (using the same bit band technique) until it
      * indicates that the GPIIOF is ready.
      */
-    UARTprintf("---->> Wait for GPIO F to be ready.\n");
+    UARTlog("---->> Wait for GPIO F to be ready.\n");
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF))
     {}
 
     /*
      * Set the LEDs as output.
      */
-    UARTprintf("---->> Configure all LEDs as output.\n");
+    UARTlog("---->> Configure all LEDs as output.\n");
     GPIOPinTypeGPIOOutput(GPIO_PORTF_BASE, GPIO_PIN_1|GPIO_PIN_2|GPIO_PIN_3);
 
     /*
      * Endless loop.
      */
-    UARTprintf("---->> Entering endless toggling loop.\n");
+    UARTlog("---->> Entering endless toggling loop.\n");
     while (1)
     {
         /*
@@ -42,6 +42,7 @@
 #include "driverlib/rom.h"
 
 #include "utils/uartstdio.h"
+#include "uartlog.h"
 
 /*
  * Configure the UART and its pins. This must be called before UARTprintf().
@@ -88,7 +89,7 @@ int main(void)
      * Initialize the UART.
      */
     configureUART();
-    UARTprintf("--->> Configured clock rate %d.\n", SysCtlClockGet());
+    UARTlog("--->> Configured clock rate %d.\n", SysCtlClockGet());
 
     /*
      * Here we enable GPIOF run mode clock gating by setting bit 5 of register
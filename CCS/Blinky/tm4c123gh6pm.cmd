@@ -34,6 +34,7 @@ SECTIONS
     .cinit  :   > FLASH
     .pinit  :   > FLASH
     .init_array : > FLASH
+    .uartlog :  > FLASH
 
     .vtable :   > 0x20000000
     .data   :   > SRAM
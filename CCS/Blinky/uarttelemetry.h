@@ -0,0 +1,73 @@
+//*****************************************************************************
+//
+// uarttelemetry.h - Framed binary telemetry over the uartstdio rings.
+//
+//*****************************************************************************
+
+#ifndef __UARTTELEMETRY_H__
+#define __UARTTELEMETRY_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// Built with UART_TELEMETRY, on top of UART_BUFFERED, uartstdio.c sends
+// blocks of binary data as frames, into the transmit buffer of the console
+// with UARTTelemetrySend() or of a port of uartport.h with
+// UARTPortTelemetrySend().  A frame holds a 16-bit sequence number, counted
+// per console or port, a channel byte telling the host what the data is, up
+// to UART_TELEMETRY_DATA_MAX bytes of data, and a CRC-16/CCITT-FALSE of all
+// three.  The sequence number is little-endian and the CRC high byte first,
+// so that the CRC of a whole frame is zero.  The frame is COBS encoded, which
+// takes the zeros out of it, and ends with a zero.  Before encoding it is at
+// most 254 bytes, which a single code byte of 255 covers when none of them is
+// a zero, so the encoding costs one byte whatever the data.  A frame of n
+// bytes of data is so n + 7 bytes on the line, which is 95% of it being data
+// from 133 bytes on.
+//
+// A frame is encoded straight into the transmit buffer in one pass, with a
+// table lookup a byte for the CRC, so sending one takes a time bounded by
+// its size.  A frame that does not fit in the buffer is dropped as a whole,
+// but still takes a sequence number, so the host sees it missing.  The first
+// frame, and every 65536th, is preceded by a zero, so that it is told apart
+// from any text sent before it.  The text of UARTprintf() has no zeros in it
+// and can go out between frames, at the cost of the frame after it failing
+// its CRC on the host.  The records of UARTlog() built with UART_LOG_DEFERRED
+// do have zeros, which the host takes for ends of frames, so the first frame
+// on the console after a record is preceded by a zero as well, and only the
+// pieces of the record between its zeros are seen as bad frames.  A stream
+// of frames is better given a port of its own.
+// The frames are decoded on the host by the tm4c-telemetry tool of HostSim.
+//
+//*****************************************************************************
+#define UART_TELEMETRY_DATA_MAX 249
+#define UART_TELEMETRY_OVERHEAD 7
+
+//*****************************************************************************
+//
+// The bytes a frame with a number of bytes of data takes in the transmit
+// buffer, but for the zero before the first frame.
+//
+//*****************************************************************************
+#define UART_TELEMETRY_FRAME_SIZE(ui32Len)                                    \
+                                ((ui32Len) + UART_TELEMETRY_OVERHEAD)
+
+struct tUARTPort;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern bool UARTTelemetrySend(uint8_t ui8Channel, const void *pvData,
+                              uint32_t ui32Len);
+extern bool UARTPortTelemetrySend(struct tUARTPort *psPort,
+                                  uint8_t ui8Channel, const void *pvData,
+                                  uint32_t ui32Len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
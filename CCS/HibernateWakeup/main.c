@@ -44,6 +44,7 @@
 
 #include <utils/ustdlib.h>
 #include <utils/uartstdio.h>
+#include "uartlog.h"
 
 #include <inc/hw_types.h>
 #include <inc/hw_memmap.h>
@@ -112,7 +113,7 @@ int main(void)
      * Initialize the UART.
      */
     configureUART();
-    UARTprintf("---->> Configured clock rate %d.\n", SysCtlClockGet());
+    UARTlog("---->> Configured clock rate %d.\n", SysCtlClockGet());
 
     /*
      * Here we enable GPIOF run mode clock gating by setting bit 5 of register
@@ -128,87 +129,87 @@ int main(void)
      * 0x400FE608 - 0x40000000 = 0xEF608 and the bit number is 5.
      *
      */
-    UARTprintf("---->> Enable GPIO F.\n");
+    UARTlog("---->> Enable GPIO F.\n");
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
 
     /*
      * Here we check register 108 (using the same bit band technique) until it
      * indicates that the GPIIOF is ready.
      */
-    UARTprintf("---->> Wait for GPIO F to be ready.\n");
+    UARTlog("---->> Wait for GPIO F to be ready.\n");
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOF))
     {}
 
     /*
      * Set the green LED as output.
      */
-    UARTprintf("---->> Set the green LED as output.\n");
+    UARTlog("---->> Set the green LED as output.\n");
     GPIOPinTypeGPIOOutput(GPIO_PORTF_BASE, GPIO_PIN_3);
 
     /*
      * Turn the green LED ON.
      */
-    UARTprintf("---->> Turn the green LED ON.\n");
+    UARTlog("---->> Turn the green LED ON.\n");
     GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, 0x08);
 
     /*
      * Enable the Hibernation peripheral.
      */
-    UARTprintf("---->> Enable the Hibernation peripheral.\n");
+    UARTlog("---->> Enable the Hibernation peripheral.\n");
     SysCtlPeripheralEnable(SYSCTL_PERIPH_HIBERNATE);
 
     /*
      * Enable Hibernation module for operation.
      */
-    UARTprintf("---->> Enable Hibernation module for operation.\n");
+    UARTlog("---->> Enable Hibernation module for operation.\n");
     HibernateEnableExpClk(SysCtlClockGet());
 
     /*
      * Enable GPIO retention after wake from hibernation.
      */
-    UARTprintf("---->> Enables GPIO retention after wake from hibernation.\n");
+    UARTlog("---->> Enables GPIO retention after wake from hibernation.\n");
     HibernateGPIORetentionEnable();
 
     /*
      * Wait for 4 seconds.
      */
-    UARTprintf("---->> Wait for 4 seconds.\n");
+    UARTlog("---->> Wait for 4 seconds.\n");
     SysCtlDelay(64000000);
 
     /*
      * Set the value of the real time clock (RTC) counter.
      */
-    UARTprintf("---->> Set the value of the real time clock (RTC) counter.\n");
+    UARTlog("---->> Set the value of the real time clock (RTC) counter.\n");
     HibernateRTCSet(0);
 
     /*
      * Enable the RTC feature of the Hibernation module.
      */
-    UARTprintf("---->> Enable the RTC feature of the Hibernation module.\n");
+    UARTlog("---->> Enable the RTC feature of the Hibernation module.\n");
     HibernateRTCEnable();
 
     /*
      * Set the value of the RTC match register.
      */
-    UARTprintf("---->> Set the value of the RTC match register.\n");
+    UARTlog("---->> Set the value of the RTC match register.\n");
     HibernateRTCMatchSet(0, 5);
 
     /*
      * Configure the wake conditions for the Hibernation module.
      */
-    UARTprintf("---->> Configure the wake conditions for the Hibernation module.\n");
+    UARTlog("---->> Configure the wake conditions for the Hibernation module.\n");
     HibernateWakeSet(HIBERNATE_WAKE_PIN|HIBERNATE_WAKE_RTC);
 
     /*
      * Turn the green LED OFF.
      */
-    UARTprintf("---->> Turn the green LED OFF.\n");
+    UARTlog("---->> Turn the green LED OFF.\n");
     GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_3, 0x00);
 
     /*
      * Request hibernation mode.
      */
-    UARTprintf("---->> Request hibernation mode.\n");
+    UARTlog("---->> Request hibernation mode.\n");
     HibernateRequest();
 
     while (1) {}
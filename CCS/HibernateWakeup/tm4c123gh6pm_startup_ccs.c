@@ -55,6 +55,14 @@ extern uint32_t __STACK_TOP;
 //
 //*****************************************************************************
 // To be added by user
+#ifdef UART_BUFFERED
+extern void UARTStdioIntHandler(void);
+#endif
+#ifdef UART_STDIO_PORTS
+extern void UARTPort0IntHandler(void);
+extern void UARTPort1IntHandler(void);
+extern void UARTPort2IntHandler(void);
+#endif
 
 //*****************************************************************************
 //
@@ -88,8 +96,18 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
+#if defined(UART_STDIO_PORTS) && (UART_STDIO_PORTS & 1)
+    UARTPort0IntHandler,                    // UART0 Rx and Tx
+#elif defined(UART_BUFFERED)
+    UARTStdioIntHandler,                    // UART0 Rx and Tx
+#else
     IntDefaultHandler,                      // UART0 Rx and Tx
+#endif
+#if defined(UART_STDIO_PORTS) && (UART_STDIO_PORTS & 2)
+    UARTPort1IntHandler,                    // UART1 Rx and Tx
+#else
     IntDefaultHandler,                      // UART1 Rx and Tx
+#endif
     IntDefaultHandler,                      // SSI0 Rx and Tx
     IntDefaultHandler,                      // I2C0 Master and Slave
     IntDefaultHandler,                      // PWM Fault
@@ -116,7 +134,11 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port F
     IntDefaultHandler,                      // GPIO Port G
     IntDefaultHandler,                      // GPIO Port H
+#if defined(UART_STDIO_PORTS) && (UART_STDIO_PORTS & 4)
+    UARTPort2IntHandler,                    // UART2 Rx and Tx
+#else
     IntDefaultHandler,                      // UART2 Rx and Tx
+#endif
     IntDefaultHandler,                      // SSI1 Rx and Tx
     IntDefaultHandler,                      // Timer 3 subtimer A
     IntDefaultHandler,                      // Timer 3 subtimer B
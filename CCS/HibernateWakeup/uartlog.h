@@ -0,0 +1,111 @@
+//*****************************************************************************
+//
+// uartlog.h - Deferred binary logging over the uartstdio console.
+//
+//*****************************************************************************
+
+#ifndef __UARTLOG_H__
+#define __UARTLOG_H__
+
+#include <stdint.h>
+#include "utils/uartstdio.h"
+
+//*****************************************************************************
+//
+// UARTlog() takes the format strings of UARTprintf() with up to
+// UART_LOG_ARGS_MAX arguments.  Built with UART_LOG_DEFERRED, on top of
+// UART_BUFFERED, it formats nothing: the format string is placed in the
+// .uartlog section of flash, and the call puts a record holding its address
+// and the raw argument words into the transmit buffer.  The text is rebuilt
+// on the host by the tm4c-log tool of HostSim, from the records received and
+// the .uartlog section of the ELF image.  Without UART_LOG_DEFERRED, UARTlog()
+// is UARTprintf().
+//
+// A record is a byte of UART_LOG_MARK ORed with the number of arguments, the
+// low three bytes of the address of the format string and the arguments, all
+// little-endian, so 4 + 4 * n bytes.  The mark is not ASCII, so text may be
+// mixed freely with records on the same UART.  A record that does not fit in
+// the transmit buffer is dropped as a whole.  %s arguments are only rebuilt
+// if they point into the image, and %f, whose argument is not a word, is not
+// supported.
+//
+//*****************************************************************************
+#define UART_LOG_MARK           0xF0
+#define UART_LOG_ARGS_MAX       3
+
+#ifdef UART_LOG_DEFERRED
+
+//*****************************************************************************
+//
+// Expands to the number of arguments following the format, 0 to 3.
+//
+//*****************************************************************************
+#define UART_LOG_COUNT(...)     UART_LOG_COUNT_(__VA_ARGS__, 3, 2, 1, 0, ~)
+#define UART_LOG_COUNT_(f, a, b, c, n, ...) \
+                                n
+#define UART_LOG_FORMAT(f, ...) f
+
+//*****************************************************************************
+//
+// Calls the writer for the number of arguments, with the format string in
+// .uartlog in place of the literal.  An argument wider than a word, such as a
+// double or a 64-bit integer, fails to build rather than being cut to its low
+// word.
+//
+//*****************************************************************************
+#define UART_LOG_CALL(n)        UART_LOG_CALL_(n)
+#define UART_LOG_CALL_(n)       UART_LOG_ARGS_##n
+#define UART_LOG_WORD(a)                                                      \
+    ((void)sizeof(struct                                                      \
+                  {                                                           \
+                      _Static_assert(sizeof(a) <= 4,                          \
+                                     "UARTlog() arguments must fit a word");  \
+                      char c;                                                 \
+                  }),                                                         \
+     (uint32_t)(uintptr_t)(a))
+#define UART_LOG_ARGS_0(p, f)   UARTLogWrite0(p)
+#define UART_LOG_ARGS_1(p, f, a) \
+                                UARTLogWrite1(p, UART_LOG_WORD(a))
+#define UART_LOG_ARGS_2(p, f, a, b) \
+                                UARTLogWrite2(p, UART_LOG_WORD(a), \
+                                              UART_LOG_WORD(b))
+#define UART_LOG_ARGS_3(p, f, a, b, c) \
+                                UARTLogWrite3(p, UART_LOG_WORD(a), \
+                                              UART_LOG_WORD(b), \
+                                              UART_LOG_WORD(c))
+
+#define UARTlog(...)                                                          \
+    do                                                                        \
+    {                                                                         \
+        static const char pcUARTLogFormat[]                                   \
+            __attribute__((section(".uartlog"))) =                            \
+                UART_LOG_FORMAT(__VA_ARGS__, ~);                              \
+                                                                              \
+        UART_LOG_CALL(UART_LOG_COUNT(__VA_ARGS__))(pcUARTLogFormat,           \
+                                                   __VA_ARGS__);              \
+    }                                                                         \
+    while(0)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern void UARTLogWrite0(const char *pcFormat);
+extern void UARTLogWrite1(const char *pcFormat, uint32_t ui32Arg0);
+extern void UARTLogWrite2(const char *pcFormat, uint32_t ui32Arg0,
+                          uint32_t ui32Arg1);
+extern void UARTLogWrite3(const char *pcFormat, uint32_t ui32Arg0,
+                          uint32_t ui32Arg1, uint32_t ui32Arg2);
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define UARTlog(...)            UARTprintf(__VA_ARGS__)
+
+#endif
+
+#endif
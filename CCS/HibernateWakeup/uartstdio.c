@@ -35,7 +35,63 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
+#ifdef UART_BUFFERED_DMA
+#include "driverlib/udma.h"
+#endif
 #include "utils/uartstdio.h"
+#ifdef UART_LOG_DEFERRED
+#include "uartlog.h"
+#endif
+
+//*****************************************************************************
+//
+// UART_STDIO_PORTS is a mask of the UARTs, bit 0 for UART0 and so on, to build
+// the handle based interface of uartport.h for, on top of the console.
+//
+//*****************************************************************************
+#ifndef UART_STDIO_PORTS
+#define UART_STDIO_PORTS        0
+#endif
+
+#if UART_STDIO_PORTS
+#include "uartport.h"
+#else
+typedef struct tUARTPort tUARTPort;
+#endif
+#ifdef UART_RX_LINES
+#include "uartline.h"
+#endif
+#ifdef UART_TELEMETRY
+#include "uarttelemetry.h"
+#endif
+
+#if defined(UART_BUFFERED_DMA) && !defined(UART_BUFFERED)
+#error UART_BUFFERED_DMA requires UART_BUFFERED
+#endif
+
+#if defined(UART_LOG_DEFERRED) && !defined(UART_BUFFERED)
+#error UART_LOG_DEFERRED requires UART_BUFFERED
+#endif
+
+#if UART_STDIO_PORTS && !defined(UART_BUFFERED)
+#error UART_STDIO_PORTS requires UART_BUFFERED
+#endif
+
+#if (UART_STDIO_PORTS & ~7) != 0
+#error UART_STDIO_PORTS may only have bits 0 to 2 set
+#endif
+
+#if defined(UART_RX_LINES) && !defined(UART_BUFFERED)
+#error UART_RX_LINES requires UART_BUFFERED
+#endif
+
+#if defined(UART_RX_LINES) && ((UART_RX_LINES & (UART_RX_LINES - 1)) != 0)
+#error UART_RX_LINES must be a power of two
+#endif
+
+#if defined(UART_TELEMETRY) && !defined(UART_BUFFERED)
+#error UART_TELEMETRY requires UART_BUFFERED
+#endif
 
 //*****************************************************************************
 //
@@ -65,57 +121,290 @@ static bool g_bDisableEcho;
 
 //*****************************************************************************
 //
-// Output ring buffer.  Buffer is full if g_ui32UARTTxReadIndex is one ahead of
-// g_ui32UARTTxWriteIndex.  Buffer is empty if the two indices are the same.
+// The ring buffers are single-producer, single-consumer queues: UARTwrite()
+// is the only writer of the output buffer and the UART interrupt its only
+// reader, and the other way round for the input buffer.  Each side owns its
+// index and only ever reads the other's, so neither has to disable the UART
+// interrupt to keep the indices consistent; the interrupt handler writes the
+// output buffer too, but only between the application's writes, to echo the
+// input (see tUARTEcho).  The indices count the bytes ever written and read,
+// wrapping at 2^32; the buffer is empty if they are the same and full if they
+// differ by the size of the buffer, and the sizes are powers of two so that a
+// byte's position is its index masked.
+//
+//*****************************************************************************
+#if ((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0) || \
+    ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0)
+#error UART_TX_BUFFER_SIZE and UART_RX_BUFFER_SIZE must be powers of two
+#endif
+
+//*****************************************************************************
+//
+// The indices of a ring buffer.  The buffer itself and its size are kept
+// apart, so that the console, whose buffers are fixed, hands them to the ring
+// functions below as constants.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+}
+tUARTRing;
+
+//*****************************************************************************
+//
+// Echo of the received characters goes into the transmit buffer behind what
+// the application wrote before it, so that the terminal shows the two in the
+// order they happened.  The application is the writer of that buffer,
+// though, so the interrupt handler may only add to it while the application
+// is not part way through a write: the writers set bWriting for that time,
+// and echo that comes meanwhile, or finds the buffer full, waits in pcBuf.
+// A writer pends the UART interrupt when it is done if echo is waiting, and
+// the handler queues it then.  Echo is dropped only if more than
+// UART_ECHO_BUFFER_SIZE bytes of it are waiting at once.
+//
+//*****************************************************************************
+#ifndef UART_ECHO_BUFFER_SIZE
+#define UART_ECHO_BUFFER_SIZE   16
+#endif
+
+typedef struct
+{
+    bool bWriting;
+    uint32_t ui32Count;
+    char pcBuf[UART_ECHO_BUFFER_SIZE];
+}
+tUARTEcho;
+
+//*****************************************************************************
+//
+// With UART_RX_LINES defined, the UART interrupt handler also frames the
+// input into lines, which the application takes straight out of the receive
+// buffer with UARTLineGet() (see uartline.h).  The receive index one past the
+// terminator of each complete line goes into a queue of UART_RX_LINES
+// entries, a single-producer, single-consumer queue like the ring buffers,
+// so that finding a line takes the same time however long it is.  The handler
+// also keeps where the line being received starts, so that backspace never
+// rubs out a complete line, and whether any of it was thrown away for want
+// of room, in which case the whole line is; a line is also thrown away if the
+// queue is full when it ends.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Write;
+    uint32_t ui32Read;
+    uint32_t ui32Start;
+    bool bOverflow;
+#ifdef UART_RX_LINES
+    uint32_t pui32End[UART_RX_LINES];
+#endif
+}
+tUARTLines;
+
+//*****************************************************************************
+//
+// Output ring buffer.
 //
 //*****************************************************************************
 static unsigned char g_pcUARTTxBuffer[UART_TX_BUFFER_SIZE];
-static volatile uint32_t g_ui32UARTTxWriteIndex = 0;
-static volatile uint32_t g_ui32UARTTxReadIndex = 0;
+static tUARTRing g_sUARTTxRing;
+static tUARTEcho g_sUARTEcho;
 
 //*****************************************************************************
 //
-// Input ring buffer.  Buffer is full if g_ui32UARTTxReadIndex is one ahead of
-// g_ui32UARTTxWriteIndex.  Buffer is empty if the two indices are the same.
+// Input ring buffer.
 //
 //*****************************************************************************
 static unsigned char g_pcUARTRxBuffer[UART_RX_BUFFER_SIZE];
-static volatile uint32_t g_ui32UARTRxWriteIndex = 0;
-static volatile uint32_t g_ui32UARTRxReadIndex = 0;
+static tUARTRing g_sUARTRxRing;
+
+//*****************************************************************************
+//
+// The lines of the input ring buffer, if it is framed into lines.
+//
+//*****************************************************************************
+#ifdef UART_RX_LINES
+static tUARTLines g_sUARTRxLines;
+#define UART_RX_LINES_CONSOLE   (&g_sUARTRxLines)
+#else
+#define UART_RX_LINES_CONSOLE   0
+#endif
+
+//*****************************************************************************
+//
+// The sequence number of the next telemetry frame sent on the console, and
+// whether a deferred log record, which has zeros in it, has gone into the
+// transmit buffer since the last frame, so the next one must start with a
+// zero of its own.
+//
+//*****************************************************************************
+#ifdef UART_TELEMETRY
+static uint16_t g_ui16UARTTelemetrySeq;
+#ifdef UART_LOG_DEFERRED
+static bool g_bUARTTelemetryZero;
+#endif
+#endif
 
 //*****************************************************************************
 //
 // Macros to determine number of free and used bytes in the transmit buffer.
 //
 //*****************************************************************************
-#define TX_BUFFER_USED          (GetBufferCount(&g_ui32UARTTxReadIndex,  \
-                                                &g_ui32UARTTxWriteIndex, \
-                                                UART_TX_BUFFER_SIZE))
+#define TX_BUFFER_MASK          (UART_TX_BUFFER_SIZE - 1)
+#define TX_BUFFER_USED          (GetBufferCount(&g_sUARTTxRing))
 #define TX_BUFFER_FREE          (UART_TX_BUFFER_SIZE - TX_BUFFER_USED)
-#define TX_BUFFER_EMPTY         (IsBufferEmpty(&g_ui32UARTTxReadIndex,   \
-                                               &g_ui32UARTTxWriteIndex))
-#define TX_BUFFER_FULL          (IsBufferFull(&g_ui32UARTTxReadIndex,  \
-                                              &g_ui32UARTTxWriteIndex, \
-                                              UART_TX_BUFFER_SIZE))
-#define ADVANCE_TX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_TX_BUFFER_SIZE
+#define TX_BUFFER_EMPTY         (TX_BUFFER_USED == 0)
 
 //*****************************************************************************
 //
 // Macros to determine number of free and used bytes in the receive buffer.
 //
 //*****************************************************************************
-#define RX_BUFFER_USED          (GetBufferCount(&g_ui32UARTRxReadIndex,  \
-                                                &g_ui32UARTRxWriteIndex, \
-                                                UART_RX_BUFFER_SIZE))
-#define RX_BUFFER_FREE          (UART_RX_BUFFER_SIZE - RX_BUFFER_USED)
-#define RX_BUFFER_EMPTY         (IsBufferEmpty(&g_ui32UARTRxReadIndex,   \
-                                               &g_ui32UARTRxWriteIndex))
-#define RX_BUFFER_FULL          (IsBufferFull(&g_ui32UARTRxReadIndex,  \
-                                              &g_ui32UARTRxWriteIndex, \
-                                              UART_RX_BUFFER_SIZE))
-#define ADVANCE_RX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_RX_BUFFER_SIZE
+#define RX_BUFFER_MASK          (UART_RX_BUFFER_SIZE - 1)
+#define RX_BUFFER_USED          (GetBufferCount(&g_sUARTRxRing))
+#define RX_BUFFER_EMPTY         (RX_BUFFER_USED == 0)
+#endif
+
+//*****************************************************************************
+//
+// The ports of the handle based interface.  Each has its own ring buffers,
+// sized at build time with UARTn_TX_BUFFER_SIZE and UARTn_RX_BUFFER_SIZE, which
+// default to the sizes of the console's, and its own echo and line state.  A
+// port is reached through its handle, so the console, which keeps to its own
+// globals, pays nothing for them.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS
+#ifndef UART0_TX_BUFFER_SIZE
+#define UART0_TX_BUFFER_SIZE    UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART0_RX_BUFFER_SIZE
+#define UART0_RX_BUFFER_SIZE    UART_RX_BUFFER_SIZE
+#endif
+#ifndef UART1_TX_BUFFER_SIZE
+#define UART1_TX_BUFFER_SIZE    UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART1_RX_BUFFER_SIZE
+#define UART1_RX_BUFFER_SIZE    UART_RX_BUFFER_SIZE
+#endif
+#ifndef UART2_TX_BUFFER_SIZE
+#define UART2_TX_BUFFER_SIZE    UART_TX_BUFFER_SIZE
+#endif
+#ifndef UART2_RX_BUFFER_SIZE
+#define UART2_RX_BUFFER_SIZE    UART_RX_BUFFER_SIZE
+#endif
+
+#if ((UART0_TX_BUFFER_SIZE & (UART0_TX_BUFFER_SIZE - 1)) != 0) || \
+    ((UART0_RX_BUFFER_SIZE & (UART0_RX_BUFFER_SIZE - 1)) != 0) || \
+    ((UART1_TX_BUFFER_SIZE & (UART1_TX_BUFFER_SIZE - 1)) != 0) || \
+    ((UART1_RX_BUFFER_SIZE & (UART1_RX_BUFFER_SIZE - 1)) != 0) || \
+    ((UART2_TX_BUFFER_SIZE & (UART2_TX_BUFFER_SIZE - 1)) != 0) || \
+    ((UART2_RX_BUFFER_SIZE & (UART2_RX_BUFFER_SIZE - 1)) != 0)
+#error The UARTn_TX_BUFFER_SIZE and UARTn_RX_BUFFER_SIZE must be powers of two
+#endif
+
+struct tUARTPort
+{
+    //
+    // The UART and its interrupt, zero until the port is opened.
+    //
+    uint32_t ui32Base;
+    uint32_t ui32Int;
+
+    //
+    // The ring buffers.
+    //
+    unsigned char *pcTxBuffer;
+    uint32_t ui32TxSize;
+    tUARTRing sTxRing;
+    unsigned char *pcRxBuffer;
+    uint32_t ui32RxSize;
+    tUARTRing sRxRing;
+
+    //
+    // The echo setting of UARTPortEchoSet(), whether the last character
+    // received was a CR and the echo waiting to go into the transmit buffer.
+    //
+    bool bDisableEcho;
+    bool bLastWasCR;
+    tUARTEcho sEcho;
+
+#ifdef UART_RX_LINES
+    //
+    // The lines of the receive buffer.
+    //
+    tUARTLines sRxLines;
+#endif
+
+#ifdef UART_TELEMETRY
+    //
+    // The sequence number of the next telemetry frame.
+    //
+    uint16_t ui16TelemetrySeq;
+#endif
+};
+
+#ifdef UART_RX_LINES
+#define UART_PORT_LINES         , { 0, 0, 0, false, { 0 } }
+#define UART_PORT_RX_LINES(psPort)                                            \
+                                (&(psPort)->sRxLines)
+#else
+#define UART_PORT_LINES
+#define UART_PORT_RX_LINES(psPort)                                            \
+                                0
+#endif
+
+#ifdef UART_TELEMETRY
+#define UART_PORT_TELEMETRY     , 0
+#else
+#define UART_PORT_TELEMETRY
+#endif
+
+#if UART_STDIO_PORTS & 1
+static unsigned char g_pcUART0TxBuffer[UART0_TX_BUFFER_SIZE];
+static unsigned char g_pcUART0RxBuffer[UART0_RX_BUFFER_SIZE];
+#define UART_PORT0              { 0, 0, g_pcUART0TxBuffer,                    \
+                                  UART0_TX_BUFFER_SIZE, { 0, 0 },             \
+                                  g_pcUART0RxBuffer, UART0_RX_BUFFER_SIZE,    \
+                                  { 0, 0 }, false, false,                     \
+                                  { false, 0, { 0 } } UART_PORT_LINES         \
+                                  UART_PORT_TELEMETRY }
+#else
+#define UART_PORT0              { 0 }
+#endif
+
+#if UART_STDIO_PORTS & 2
+static unsigned char g_pcUART1TxBuffer[UART1_TX_BUFFER_SIZE];
+static unsigned char g_pcUART1RxBuffer[UART1_RX_BUFFER_SIZE];
+#define UART_PORT1              { 0, 0, g_pcUART1TxBuffer,                    \
+                                  UART1_TX_BUFFER_SIZE, { 0, 0 },             \
+                                  g_pcUART1RxBuffer, UART1_RX_BUFFER_SIZE,    \
+                                  { 0, 0 }, false, false,                     \
+                                  { false, 0, { 0 } } UART_PORT_LINES         \
+                                  UART_PORT_TELEMETRY }
+#else
+#define UART_PORT1              { 0 }
+#endif
+
+#if UART_STDIO_PORTS & 4
+static unsigned char g_pcUART2TxBuffer[UART2_TX_BUFFER_SIZE];
+static unsigned char g_pcUART2RxBuffer[UART2_RX_BUFFER_SIZE];
+#define UART_PORT2              { 0, 0, g_pcUART2TxBuffer,                    \
+                                  UART2_TX_BUFFER_SIZE, { 0, 0 },             \
+                                  g_pcUART2RxBuffer, UART2_RX_BUFFER_SIZE,    \
+                                  { 0, 0 }, false, false,                     \
+                                  { false, 0, { 0 } } UART_PORT_LINES         \
+                                  UART_PORT_TELEMETRY }
+#else
+#define UART_PORT2              { 0 }
+#endif
+
+static tUARTPort g_psUARTPorts[3] =
+{
+    UART_PORT0, UART_PORT1, UART_PORT2
+};
 #endif
 
 //*****************************************************************************
@@ -162,6 +451,52 @@ static const uint32_t g_ui32UARTInt[3] =
 static uint32_t g_ui32PortNum;
 #endif
 
+#ifdef UART_BUFFERED_DMA
+//*****************************************************************************
+//
+// With UART_BUFFERED_DMA defined, the transmit buffer is drained by the uDMA
+// rather than a byte at a time from the transmit interrupt.  Each transfer
+// moves the contiguous span from the read index up to the write index, or up
+// to the end of the buffer if the data wraps, and the read index is only
+// advanced past the span once the transfer is done, so the span is never
+// overwritten while it is being sent.  The completion of a transfer interrupts
+// on the vector of the UART, which then starts the transfer of whatever was
+// written meanwhile, the wrapped part included.
+//
+// The application must enable the uDMA controller and give it a channel
+// control table with uDMAEnable() and uDMAControlBaseSet() before calling
+// UARTStdioConfig().
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The uDMA channel assignments for the transmit FIFO of each UART; the channel
+// number is in the low byte.
+//
+//*****************************************************************************
+static const uint32_t g_ui32UARTTxDMA[3] =
+{
+    UDMA_CH9_UART0TX, UDMA_CH23_UART1TX, UDMA_CH1_UART2TX
+};
+
+//*****************************************************************************
+//
+// The most bytes a single uDMA transfer can move.
+//
+//*****************************************************************************
+#define UART_DMA_SPAN_MAX       1024
+
+//*****************************************************************************
+//
+// The uDMA channel in use and the number of bytes from the read index of the
+// transmit buffer on that it is moving, zero if it is idle.
+//
+//*****************************************************************************
+static uint32_t g_ui32UARTTxChannel;
+static uint32_t g_ui32UARTTxDMASpan = 0;
+#endif
+
 //*****************************************************************************
 //
 // The list of UART peripherals.
@@ -174,64 +509,51 @@ static const uint32_t g_ui32UARTPeriph[3] =
 
 //*****************************************************************************
 //
-//! Determines whether the ring buffer whose pointers and size are provided
-//! is full or not.
+//! Reads the index of a ring buffer owned by the other side.
 //!
-//! \param pui32Read points to the read index for the buffer.
-//! \param pui32Write points to the write index for the buffer.
-//! \param ui32Size is the size of the buffer in bytes.
+//! \param pui32Index points to the index.
 //!
-//! This function is used to determine whether or not a given ring buffer is
-//! full.  The structure of the code is specifically to ensure that we do not
-//! see warnings from the compiler related to the order of volatile accesses
-//! being undefined.
+//! The two sides of a ring buffer are the UART interrupt handler and the code
+//! it interrupts, on the same core, so the bytes the other side put into or
+//! took out of the buffer before publishing its index only have to be kept in
+//! order by the compiler.  A signal fence does that without the DMB an atomic
+//! acquire would cost on the Cortex-M4.
 //!
-//! \return Returns \b true if the buffer is full or \b false otherwise.
+//! \return Returns the index.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
-static bool
-IsBufferFull(volatile uint32_t *pui32Read,
-             volatile uint32_t *pui32Write, uint32_t ui32Size)
+static inline uint32_t
+RingLoadAcquire(const uint32_t *pui32Index)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
+    uint32_t ui32Index;
 
-    ui32Write = *pui32Write;
-    ui32Read = *pui32Read;
+    ui32Index = __atomic_load_n(pui32Index, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_ACQUIRE);
 
-    return((((ui32Write + 1) % ui32Size) == ui32Read) ? true : false);
+    return(ui32Index);
 }
 #endif
 
 //*****************************************************************************
 //
-//! Determines whether the ring buffer whose pointers and size are provided
-//! is empty or not.
+//! Publishes the index of a ring buffer to the other side.
 //!
-//! \param pui32Read points to the read index for the buffer.
-//! \param pui32Write points to the write index for the buffer.
+//! \param pui32Index points to the index.
+//! \param ui32Index is its new value.
 //!
-//! This function is used to determine whether or not a given ring buffer is
-//! empty.  The structure of the code is specifically to ensure that we do not
-//! see warnings from the compiler related to the order of volatile accesses
-//! being undefined.
+//! This function makes the bytes written to or read from the buffer before it
+//! is called visible to the other side together with the index.
 //!
-//! \return Returns \b true if the buffer is empty or \b false otherwise.
+//! \return None.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
-static bool
-IsBufferEmpty(volatile uint32_t *pui32Read,
-              volatile uint32_t *pui32Write)
+static inline void
+RingStoreRelease(uint32_t *pui32Index, uint32_t ui32Index)
 {
-    uint32_t ui32Write;
-    uint32_t ui32Read;
-
-    ui32Write = *pui32Write;
-    ui32Read = *pui32Read;
-
-    return((ui32Write == ui32Read) ? true : false);
+    __atomic_signal_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(pui32Index, ui32Index, __ATOMIC_RELAXED);
 }
 #endif
 
@@ -239,226 +561,240 @@ IsBufferEmpty(volatile uint32_t *pui32Read,
 //
 //! Determines the number of bytes of data contained in a ring buffer.
 //!
-//! \param pui32Read points to the read index for the buffer.
-//! \param pui32Write points to the write index for the buffer.
-//! \param ui32Size is the size of the buffer in bytes.
+//! \param psRing points to the indices of the buffer.
 //!
 //! This function is used to determine how many bytes of data a given ring
-//! buffer currently contains.  The structure of the code is specifically to
-//! ensure that we do not see warnings from the compiler related to the order
-//! of volatile accesses being undefined.
+//! buffer currently contains.  Either side may call it.
 //!
 //! \return Returns the number of bytes of data currently in the buffer.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
-static uint32_t
-GetBufferCount(volatile uint32_t *pui32Read,
-               volatile uint32_t *pui32Write, uint32_t ui32Size)
+static inline uint32_t
+GetBufferCount(const tUARTRing *psRing)
 {
     uint32_t ui32Write;
     uint32_t ui32Read;
 
-    ui32Write = *pui32Write;
-    ui32Read = *pui32Read;
+    ui32Write = RingLoadAcquire(&psRing->ui32Write);
+    ui32Read = RingLoadAcquire(&psRing->ui32Read);
 
-    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
-           (ui32Size - (ui32Read - ui32Write)));
+    return(ui32Write - ui32Read);
 }
 #endif
 
 //*****************************************************************************
 //
-// Take as many bytes from the transmit buffer as we have space for and move
-// them into the UART transmit FIFO.
+// The functions from here to the configuration of the console do the work of
+// the buffered interface on a given UART and pair of ring buffers, for the
+// console and for the ports of uartport.h alike.  They are inlined, so that
+// for the console the buffers and their sizes fold into constants just as if
+// the code were written out against its globals.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Take as many bytes from a transmit buffer as we have space for and move
+// them into the UART transmit FIFO, then keep the transmit interrupt enabled
+// only while there is more to send.  Only the UART interrupt handler calls
+// this, as the one reader of the transmit buffer.
 //
 //*****************************************************************************
 #ifdef UART_BUFFERED
-static void
-UARTPrimeTransmit(uint32_t ui32Base)
+static inline void
+UARTRingTransmit(uint32_t ui32Base, tUARTRing *psRing,
+                 const unsigned char *pcRing, uint32_t ui32Size)
 {
+    uint32_t ui32Read, ui32Write;
+
+    ui32Read = psRing->ui32Read;
+    ui32Write = RingLoadAcquire(&psRing->ui32Write);
+
     //
-    // Do we have any data to transmit?
+    // Take some characters out of the transmit buffer and feed them to the
+    // UART transmit FIFO.
     //
-    if(!TX_BUFFER_EMPTY)
+    while((ui32Read != ui32Write) && MAP_UARTSpaceAvail(ui32Base))
     {
-        //
-        // Disable the UART interrupt.  If we don't do this there is a race
-        // condition which can cause the read index to be corrupted.
-        //
-        MAP_IntDisable(g_ui32UARTInt[g_ui32PortNum]);
+        MAP_UARTCharPutNonBlocking(ui32Base,
+                                   pcRing[ui32Read & (ui32Size - 1)]);
+        ui32Read++;
+    }
 
-        //
-        // Yes - take some characters out of the transmit buffer and feed
-        // them to the UART transmit FIFO.
-        //
-        while(MAP_UARTSpaceAvail(ui32Base) && !TX_BUFFER_EMPTY)
-        {
-            MAP_UARTCharPutNonBlocking(ui32Base,
-                                      g_pcUARTTxBuffer[g_ui32UARTTxReadIndex]);
-            ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxReadIndex);
-        }
+    //
+    // Hand the space back to the writer.
+    //
+    RingStoreRelease(&psRing->ui32Read, ui32Read);
 
-        //
-        // Reenable the UART interrupt.
-        //
-        MAP_IntEnable(g_ui32UARTInt[g_ui32PortNum]);
+    if(ui32Read == RingLoadAcquire(&psRing->ui32Write))
+    {
+        MAP_UARTIntDisable(ui32Base, UART_INT_TX);
+    }
+    else
+    {
+        MAP_UARTIntEnable(ui32Base, UART_INT_TX);
     }
 }
 #endif
 
 //*****************************************************************************
 //
-//! Configures the UART console.
-//!
-//! \param ui32PortNum is the number of UART port to use for the serial console
-//! (0-2)
-//! \param ui32Baud is the bit rate that the UART is to be configured to use.
-//! \param ui32SrcClock is the frequency of the source clock for the UART
-//! module.
-//!
-//! This function will configure the specified serial port to be used as a
-//! serial console.  The serial parameters are set to the baud rate
-//! specified by the \e ui32Baud parameter and use 8 bit, no parity, and 1 stop
-//! bit.
-//!
-//! This function must be called prior to using any of the other UART console
-//! functions: UARTprintf() or UARTgets().  This function assumes that the
-//! caller has previously configured the relevant UART pins for operation as a
-//! UART rather than as GPIOs.
-//!
-//! \return None.
+// Move the echo waiting for a transmit buffer into it, as much as fits,
+// unless the application is part way through a write (see tUARTEcho).  Only
+// the UART interrupt handler calls this.
 //
 //*****************************************************************************
-void
-UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
-{
-    //
-    // Check the arguments.
-    //
-    ASSERT((ui32PortNum == 0) || (ui32PortNum == 1) ||
-           (ui32PortNum == 2));
-
 #ifdef UART_BUFFERED
-    //
-    // In buffered mode, we only allow a single instance to be opened.
-    //
-    ASSERT(g_ui32Base == 0);
-#endif
+static inline void
+UARTEchoQueue(tUARTEcho *psEcho, tUARTRing *psRing, unsigned char *pcRing,
+              uint32_t ui32Size)
+{
+    uint32_t ui32Write, ui32Len, ui32Idx;
 
-    //
-    // Check to make sure the UART peripheral is present.
-    //
-    if(!MAP_SysCtlPeripheralPresent(g_ui32UARTPeriph[ui32PortNum]))
+    if(!psEcho->ui32Count ||
+       __atomic_load_n(&psEcho->bWriting, __ATOMIC_RELAXED))
     {
         return;
     }
 
-    //
-    // Select the base address of the UART.
-    //
-    g_ui32Base = g_ui32UARTBase[ui32PortNum];
+    ui32Write = psRing->ui32Write;
+    ui32Len = ui32Size - (ui32Write - psRing->ui32Read);
 
-    //
-    // Enable the UART peripheral for use.
-    //
-    MAP_SysCtlPeripheralEnable(g_ui32UARTPeriph[ui32PortNum]);
+    if(ui32Len > psEcho->ui32Count)
+    {
+        ui32Len = psEcho->ui32Count;
+    }
 
-    //
-    // Configure the UART for 115200, n, 8, 1
-    //
-    MAP_UARTConfigSetExpClk(g_ui32Base, ui32SrcClock, ui32Baud,
-                            (UART_CONFIG_PAR_NONE | UART_CONFIG_STOP_ONE |
-                             UART_CONFIG_WLEN_8));
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        pcRing[ui32Write++ & (ui32Size - 1)] = psEcho->pcBuf[ui32Idx];
+    }
 
-#ifdef UART_BUFFERED
     //
-    // Set the UART to interrupt whenever the TX FIFO is almost empty or
-    // when any character is received.
+    // Keep what did not fit for the next interrupt, which comes as soon as
+    // the UART has taken some of the buffer.
     //
-    MAP_UARTFIFOLevelSet(g_ui32Base, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
+    for(ui32Idx = ui32Len; ui32Idx < psEcho->ui32Count; ui32Idx++)
+    {
+        psEcho->pcBuf[ui32Idx - ui32Len] = psEcho->pcBuf[ui32Idx];
+    }
 
-    //
-    // Flush both the buffers.
-    //
-    UARTFlushRx();
-    UARTFlushTx(true);
+    psEcho->ui32Count -= ui32Len;
 
-    //
-    // Remember which interrupt we are dealing with.
-    //
-    g_ui32PortNum = ui32PortNum;
+    RingStoreRelease(&psRing->ui32Write, ui32Write);
+}
+#endif
 
-    //
-    // We are configured for buffered output so enable the master interrupt
-    // for this UART and the receive interrupts.  We don't actually enable the
-    // transmit interrupt in the UART itself until some data has been placed
-    // in the transmit buffer.
-    //
-    MAP_UARTIntDisable(g_ui32Base, 0xFFFFFFFF);
-    MAP_UARTIntEnable(g_ui32Base, UART_INT_RX | UART_INT_RT);
-    MAP_IntEnable(g_ui32UARTInt[ui32PortNum]);
+//*****************************************************************************
+//
+// Echo characters through a transmit buffer, behind what is already in it.
+// Only the UART interrupt handler calls this.
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED
+static inline void
+UARTEcho(tUARTEcho *psEcho, tUARTRing *psRing, unsigned char *pcRing,
+         uint32_t ui32Size, const char *pcBuf, uint32_t ui32Len)
+{
+    while(ui32Len-- && (psEcho->ui32Count < UART_ECHO_BUFFER_SIZE))
+    {
+        psEcho->pcBuf[psEcho->ui32Count++] = *pcBuf++;
+    }
+
+    UARTEchoQueue(psEcho, psRing, pcRing, ui32Size);
+}
 #endif
 
-    //
-    // Enable the UART operation.
-    //
-    MAP_UARTEnable(g_ui32Base);
+//*****************************************************************************
+//
+// Start a write to a transmit buffer, keeping the interrupt handler from
+// adding echo to it, and return the write index to start from.
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED
+static inline uint32_t
+UARTRingWriteBegin(tUARTRing *psRing, tUARTEcho *psEcho)
+{
+    __atomic_store_n(&psEcho->bWriting, true, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    return(psRing->ui32Write);
 }
+#endif
 
 //*****************************************************************************
 //
-//! Writes a string of characters to the UART output.
-//!
-//! \param pcBuf points to a buffer containing the string to transmit.
-//! \param ui32Len is the length of the string to transmit.
-//!
-//! This function will transmit the string to the UART output.  The number of
-//! characters transmitted is determined by the \e ui32Len parameter.  This
-//! function does no interpretation or translation of any characters.  Since
-//! the output is sent to a UART, any LF (/n) characters encountered will be
-//! replaced with a CRLF pair.
-//!
-//! Besides using the \e ui32Len parameter to stop transmitting the string, if
-//! a null character (0) is encountered, then no more characters will be
-//! transmitted and the function will return.
-//!
-//! In non-buffered mode, this function is blocking and will not return until
-//! all the characters have been written to the output FIFO.  In buffered mode,
-//! the characters are written to the UART transmit buffer and the call returns
-//! immediately.  If insufficient space remains in the transmit buffer,
-//! additional characters are discarded.
-//!
-//! \return Returns the count of characters written.
+// End a write to a transmit buffer at ui32Write, publishing what was written,
+// and pend the UART interrupt if there is anything new to send or echo is
+// waiting to be queued.
 //
 //*****************************************************************************
-int
-UARTwrite(const char *pcBuf, uint32_t ui32Len)
+#ifdef UART_BUFFERED
+static inline void
+UARTRingWriteEnd(tUARTRing *psRing, tUARTEcho *psEcho, uint32_t ui32Int,
+                 uint32_t ui32Write)
 {
+    bool bNew;
+
+    bNew = (ui32Write != psRing->ui32Write);
+    RingStoreRelease(&psRing->ui32Write, ui32Write);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    __atomic_store_n(&psEcho->bWriting, false, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    if(bNew || __atomic_load_n(&psEcho->ui32Count, __ATOMIC_RELAXED))
+    {
+        MAP_IntPendSet(ui32Int);
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Write characters to a transmit buffer, translating LF to CRLF, and pend the
+// UART interrupt to send them.  See UARTwrite().
+//
+//*****************************************************************************
 #ifdef UART_BUFFERED
+static inline int
+UARTRingWrite(tUARTRing *psRing, unsigned char *pcRing, uint32_t ui32Size,
+              tUARTEcho *psEcho, uint32_t ui32Int, const char *pcBuf,
+              uint32_t ui32Len)
+{
     unsigned int uIdx;
+    uint32_t ui32Write, ui32Free;
 
     //
-    // Check for valid arguments.
+    // See how much room there is.  The interrupt handler can only make more
+    // while we are writing, so this is looked at again only if it runs out.
     //
-    ASSERT(pcBuf != 0);
-    ASSERT(g_ui32Base != 0);
+    ui32Write = UARTRingWriteBegin(psRing, psEcho);
+    ui32Free = ui32Size - (ui32Write - RingLoadAcquire(&psRing->ui32Read));
 
     //
     // Send the characters
     //
     for(uIdx = 0; uIdx < ui32Len; uIdx++)
     {
+        if(ui32Free < 2)
+        {
+            ui32Free = ui32Size -
+                       (ui32Write - RingLoadAcquire(&psRing->ui32Read));
+        }
+
         //
         // If the character to the UART is \n, then add a \r before it so that
-        // \n is translated to \n\r in the output.
+        // \n is translated to \n\r in the output.  The two go in together or
+        // not at all, so that a write retried from the returned count does
+        // not send the \r twice.
         //
         if(pcBuf[uIdx] == '\n')
         {
-            if(!TX_BUFFER_FULL)
+            if(ui32Free >= 2)
             {
-                g_pcUARTTxBuffer[g_ui32UARTTxWriteIndex] = '\r';
-                ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxWriteIndex);
+                pcRing[ui32Write++ & (ui32Size - 1)] = '\r';
+                ui32Free--;
             }
             else
             {
@@ -469,17 +805,17 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
             }
         }
         else if(pcBuf[uIdx] == 0)
-		{
-        	break;
-		}
+        {
+            break;
+        }
 
         //
         // Send the character to the UART output.
         //
-        if(!TX_BUFFER_FULL)
+        if(ui32Free != 0)
         {
-            g_pcUARTTxBuffer[g_ui32UARTTxWriteIndex] = pcBuf[uIdx];
-            ADVANCE_TX_BUFFER_INDEX(g_ui32UARTTxWriteIndex);
+            pcRing[ui32Write++ & (ui32Size - 1)] = pcBuf[uIdx];
+            ui32Free--;
         }
         else
         {
@@ -491,270 +827,393 @@ UARTwrite(const char *pcBuf, uint32_t ui32Len)
     }
 
     //
-    // If we have anything in the buffer, make sure that the UART is set
-    // up to transmit it.
+    // If we put anything in the buffer, publish it and pend the UART
+    // interrupt, which moves it on to the UART.
     //
-    if(!TX_BUFFER_EMPTY)
-    {
-        UARTPrimeTransmit(g_ui32Base);
-        MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
-    }
+    UARTRingWriteEnd(psRing, psEcho, ui32Int, ui32Write);
 
     //
     // Return the number of characters written.
     //
     return(uIdx);
-#else
-    unsigned int uIdx;
+}
+#endif
 
-    //
-    // Check for valid UART base address, and valid arguments.
-    //
-    ASSERT(g_ui32Base != 0);
-    ASSERT(pcBuf != 0);
+//*****************************************************************************
+//
+// Return the receive index below which the interrupt handler may not take
+// characters back out of a receive buffer: the read index, or the start of
+// the line being received if the buffer is framed into lines.
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED
+static inline uint32_t
+UARTRingFloor(const tUARTRing *psRing, const tUARTLines *psLines,
+              uint32_t ui32Write)
+{
+    uint32_t ui32Read;
+
+    ui32Read = RingLoadAcquire(&psRing->ui32Read);
 
+#ifdef UART_RX_LINES
     //
-    // Send the characters
+    // The start of the line is behind the read index if UARTFlushRx() was
+    // called while the line was being received.
     //
-    for(uIdx = 0; uIdx < ui32Len; uIdx++)
+    if(psLines &&
+       ((ui32Write - psLines->ui32Start) < (ui32Write - ui32Read)))
     {
-        //
-        // If the character to the UART is \n, then add a \r before it so that
-        // \n is translated to \n\r in the output.
-        //
-        if(pcBuf[uIdx] == '\n')
-        {
-            MAP_UARTCharPut(g_ui32Base, '\r');
-        }
-        else if(pcBuf[uIdx] == 0)
-		{
-        	break;
-		}
-
-        //
-        // Send the character to the UART output.
-        //
-        MAP_UARTCharPut(g_ui32Base, pcBuf[uIdx]);
+        return(psLines->ui32Start);
     }
-
-    //
-    // Return the number of characters written.
-    //
-    return(uIdx);
+#else
+    (void)psLines;
+    (void)ui32Write;
 #endif
+
+    return(ui32Read);
 }
+#endif
 
 //*****************************************************************************
 //
-//! A simple UART based get string function, with some line processing.
-//!
-//! \param pcBuf points to a buffer for the incoming string from the UART.
-//! \param ui32Len is the length of the buffer for storage of the string,
-//! including the trailing 0.
-//!
-//! This function will receive a string from the UART input and store the
-//! characters in the buffer pointed to by \e pcBuf.  The characters will
-//! continue to be stored until a termination character is received.  The
-//! termination characters are CR, LF, or ESC.  A CRLF pair is treated as a
-//! single termination character.  The termination characters are not stored in
-//! the string.  The string will be terminated with a 0 and the function will
-//! return.
-//!
-//! In both buffered and unbuffered modes, this function will block until
-//! a termination character is received.  If non-blocking operation is required
-//! in buffered mode, a call to UARTPeek() may be made to determine whether
-//! a termination character already exists in the receive buffer prior to
-//! calling UARTgets().
-//!
-//! Since the string will be null terminated, the user must ensure that the
-//! buffer is sized to allow for the additional null character.
-//!
-//! \return Returns the count of characters that were stored, not including
-//! the trailing 0.
+// Move the characters in the UART receive FIFO to a receive buffer, with the
+// line editing and echo of a command line unless echo is disabled, and frame
+// them into lines if psLines is not 0.  The echo goes through the transmit
+// buffer psTxRing.  Only the UART interrupt handler calls this, as the one
+// writer of the receive buffer.
 //
 //*****************************************************************************
-int
-UARTgets(char *pcBuf, uint32_t ui32Len)
-{
 #ifdef UART_BUFFERED
-    uint32_t ui32Count = 0;
+static inline void
+UARTRingReceive(uint32_t ui32Base, tUARTRing *psRing, unsigned char *pcRing,
+                uint32_t ui32Size, bool bDisableEcho, bool *pbLastWasCR,
+                tUARTEcho *psEcho, tUARTRing *psTxRing,
+                unsigned char *pcTxRing, uint32_t ui32TxSize,
+                tUARTLines *psLines)
+{
+    uint32_t ui32Write;
     int8_t cChar;
+    int32_t i32Char;
+#ifdef UART_RX_LINES
+    uint32_t ui32Lines = 0;
+    bool bEnd = false;
 
-    //
-    // Check the arguments.
-    //
-    ASSERT(pcBuf != 0);
-    ASSERT(ui32Len != 0);
-    ASSERT(g_ui32Base != 0);
+    if(psLines)
+    {
+        ui32Lines = psLines->ui32Write;
+    }
+#endif
 
-    //
-    // Adjust the length back by 1 to leave space for the trailing
-    // null terminator.
-    //
-    ui32Len--;
+    ui32Write = psRing->ui32Write;
 
     //
-    // Process characters until a newline is received.
+    // Get all the available characters from the UART.
     //
-    while(1)
+    while(MAP_UARTCharsAvail(ui32Base))
     {
         //
-        // Read the next character from the receive buffer.
+        // Read a character
         //
-        if(!RX_BUFFER_EMPTY)
-        {
-            cChar = g_pcUARTRxBuffer[g_ui32UARTRxReadIndex];
-            ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxReadIndex);
+        i32Char = MAP_UARTCharGetNonBlocking(ui32Base);
+        cChar = (unsigned char)(i32Char & 0xFF);
 
+        //
+        // If echo is disabled, we skip the various text filtering operations
+        // that would typically be required when supporting a command line.
+        //
+        if(!bDisableEcho)
+        {
             //
-            // See if a newline or escape character was received.
+            // Handle backspace by erasing the last character in the buffer.
             //
-            if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
+            if(cChar == '\b')
             {
                 //
-                // Stop processing the input and end the line.
+                // If there are any characters already in the buffer, then
+                // delete the last.
                 //
-                break;
+                if(ui32Write != UARTRingFloor(psRing, psLines, ui32Write))
+                {
+                    //
+                    // Rub out the previous character on the users terminal.
+                    //
+                    UARTEcho(psEcho, psTxRing, pcTxRing, ui32TxSize,
+                             "\b \b", 3);
+
+                    //
+                    // Decrement the number of characters in the buffer.
+                    //
+                    ui32Write--;
+                }
+
+                //
+                // Skip ahead to read the next character.
+                //
+                continue;
             }
 
             //
-            // Process the received character as long as we are not at the end
-            // of the buffer.  If the end of the buffer has been reached then
-            // all additional characters are ignored until a newline is
-            // received.
+            // If this character is LF and last was CR, then just gobble up the
+            // character since we already echoed the previous CR and we don't
+            // want to store 2 characters in the buffer if we don't need to.
             //
-            if(ui32Count < ui32Len)
+            if((cChar == '\n') && *pbLastWasCR)
+            {
+                *pbLastWasCR = false;
+                continue;
+            }
+
+            //
+            // If the character is a CR, then it may be followed by an LF which
+            // should be paired with the CR.  So remember whether a CR was
+            // received; an LF after anything else ends a line of its own.
+            //
+            *pbLastWasCR = (cChar == '\r');
+
+            //
+            // See if a newline or escape character was received.
+            //
+            if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
             {
-                //
-                // Store the character in the caller supplied buffer.
-                //
-                pcBuf[ui32Count] = cChar;
 
                 //
-                // Increment the count of characters received.
+                // Regardless of the line termination character received, put
+                // a CR in the receive buffer as a marker telling UARTgets()
+                // where the line ends.  We also send an additional LF to
+                // ensure that the local terminal echo receives both CR and LF.
                 //
-                ui32Count++;
+                cChar = '\r';
+                UARTEcho(psEcho, psTxRing, pcTxRing, ui32TxSize, "\r\n", 2);
             }
         }
-    }
-
-    //
-    // Add a null termination to the string.
-    //
-    pcBuf[ui32Count] = 0;
 
-    //
-    // Return the count of int8_ts in the buffer, not counting the trailing 0.
-    //
-    return(ui32Count);
-#else
-    uint32_t ui32Count = 0;
-    int8_t cChar;
-    static int8_t bLastWasCR = 0;
+#ifdef UART_RX_LINES
+        //
+        // Lines end at a CR, LF or ESC, which with echo enabled have all
+        // been made CRs above.  Without echo, the LF of a CRLF pair is
+        // gobbled up here, so that it does not end an empty line.
+        //
+        if(psLines)
+        {
+            if(bDisableEcho)
+            {
+                if((cChar == '\n') && *pbLastWasCR)
+                {
+                    *pbLastWasCR = false;
+                    continue;
+                }
 
-    //
-    // Check the arguments.
-    //
-    ASSERT(pcBuf != 0);
-    ASSERT(ui32Len != 0);
-    ASSERT(g_ui32Base != 0);
+                *pbLastWasCR = (cChar == '\r');
+            }
 
-    //
-    // Adjust the length back by 1 to leave space for the trailing
-    // null terminator.
-    //
-    ui32Len--;
+            bEnd = (cChar == '\r') || (cChar == '\n') || (cChar == 0x1b);
+        }
+#endif
 
-    //
-    // Process characters until a newline is received.
-    //
-    while(1)
-    {
         //
-        // Read the next character from the console.
+        // If there is space in the receive buffer, put the character there,
+        // otherwise throw it away.
         //
-        cChar = MAP_UARTCharGet(g_ui32Base);
-
-        //
-        // See if the backspace key was pressed.
-        //
-        if(cChar == '\b')
+        if((ui32Write - RingLoadAcquire(&psRing->ui32Read)) < ui32Size)
         {
             //
-            // If there are any characters already in the buffer, then delete
-            // the last.
+            // Store the new character in the receive buffer
             //
-            if(ui32Count)
-            {
-                //
-                // Rub out the previous character.
-                //
-                UARTwrite("\b \b", 3);
-
-                //
-                // Decrement the number of characters in the buffer.
-                //
-                ui32Count--;
-            }
+            pcRing[ui32Write++ & (ui32Size - 1)] =
+                (unsigned char)(i32Char & 0xFF);
 
             //
-            // Skip ahead to read the next character.
+            // If echo is enabled, write the character to the transmit buffer
+            // so that the user gets some immediate feedback.
             //
-            continue;
+            if(!bDisableEcho)
+            {
+                UARTEcho(psEcho, psTxRing, pcTxRing, ui32TxSize,
+                         (const char *)&cChar, 1);
+            }
+        }
+#ifdef UART_RX_LINES
+        else if(psLines)
+        {
+            psLines->bOverflow = true;
         }
 
         //
-        // If this character is LF and last was CR, then just gobble up the
-        // character because the EOL processing was taken care of with the CR.
+        // At the end of a line, queue where it ends, or throw the whole line
+        // away if part of it was or there is no room left in the queue.
         //
-        if((cChar == '\n') && bLastWasCR)
+        if(psLines && bEnd)
         {
-            bLastWasCR = 0;
-            continue;
+            if(!psLines->bOverflow &&
+               ((ui32Lines - RingLoadAcquire(&psLines->ui32Read)) <
+                UART_RX_LINES))
+            {
+                psLines->pui32End[ui32Lines++ & (UART_RX_LINES - 1)] =
+                    ui32Write;
+            }
+            else
+            {
+                ui32Write = UARTRingFloor(psRing, psLines, ui32Write);
+            }
+
+            psLines->bOverflow = false;
+            psLines->ui32Start = ui32Write;
         }
+#endif
+    }
+
+    //
+    // Hand what we received to the application, the characters before the
+    // ends of the lines they make up.
+    //
+    RingStoreRelease(&psRing->ui32Write, ui32Write);
+
+#ifdef UART_RX_LINES
+    if(psLines)
+    {
+        RingStoreRelease(&psLines->ui32Write, ui32Lines);
+    }
+#endif
+}
+#endif
+
+//*****************************************************************************
+//
+// Describe the oldest complete line of a receive buffer framed into lines,
+// without its terminator, in psLine, in one part or two if it wraps around
+// the end of the buffer.  Return false if there is no complete line.  See
+// UARTLineGet().
+//
+//*****************************************************************************
+#ifdef UART_RX_LINES
+static inline bool
+UARTRingLineGet(tUARTRing *psRing, tUARTLines *psLines,
+                const unsigned char *pcRing, uint32_t ui32Size,
+                tUARTLine *psLine)
+{
+    uint32_t ui32Read, ui32End, ui32Offset, ui32Len;
+
+    ui32Read = psRing->ui32Read;
+
+    while(psLines->ui32Read != RingLoadAcquire(&psLines->ui32Write))
+    {
+        ui32End = psLines->pui32End[psLines->ui32Read & (UART_RX_LINES - 1)];
 
         //
-        // See if a newline or escape character was received.
+        // A line ending at or before the read index has been read otherwise,
+        // with UARTgets() say, or flushed.  Skip it.
         //
-        if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
+        if((int32_t)(ui32End - ui32Read) <= 0)
         {
-            //
-            // If the character is a CR, then it may be followed by a LF which
-            // should be paired with the CR.  So remember that a CR was
-            // received.
-            //
-            if(cChar == '\r')
-            {
-                bLastWasCR = 1;
-            }
+            RingStoreRelease(&psLines->ui32Read, psLines->ui32Read + 1);
+            continue;
+        }
 
-            //
-            // Stop processing the input and end the line.
-            //
-            break;
+        ui32Len = ui32End - ui32Read - 1;
+        ui32Offset = ui32Read & (ui32Size - 1);
+
+        psLine->ppcPart[0] = (const char *)pcRing + ui32Offset;
+        psLine->ppcPart[1] = (const char *)pcRing;
+
+        if(ui32Len > ui32Size - ui32Offset)
+        {
+            psLine->pui32PartLen[0] = ui32Size - ui32Offset;
+            psLine->pui32PartLen[1] = ui32Len - (ui32Size - ui32Offset);
+        }
+        else
+        {
+            psLine->pui32PartLen[0] = ui32Len;
+            psLine->pui32PartLen[1] = 0;
         }
 
+        psLine->ui32Len = ui32Len;
+        psLine->ui32End = ui32End;
+
+        return(true);
+    }
+
+    return(false);
+}
+#endif
+
+//*****************************************************************************
+//
+// Hand the space of a line described by UARTRingLineGet() back to the
+// interrupt handler.
+//
+//*****************************************************************************
+#ifdef UART_RX_LINES
+static inline void
+UARTRingLineRelease(tUARTRing *psRing, tUARTLines *psLines,
+                    const tUARTLine *psLine)
+{
+    RingStoreRelease(&psRing->ui32Read, psLine->ui32End);
+    RingStoreRelease(&psLines->ui32Read, psLines->ui32Read + 1);
+}
+#endif
+
+//*****************************************************************************
+//
+// Read a line from a receive buffer, blocking until its end is received.  See
+// UARTgets().
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED
+static inline int
+UARTRingGets(tUARTRing *psRing, const unsigned char *pcRing,
+             uint32_t ui32Size, char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Count = 0;
+    int8_t cChar;
+
+    //
+    // Adjust the length back by 1 to leave space for the trailing
+    // null terminator.
+    //
+    ui32Len--;
+
+    //
+    // Process characters until a newline is received.
+    //
+    while(1)
+    {
         //
-        // Process the received character as long as we are not at the end of
-        // the buffer.  If the end of the buffer has been reached then all
-        // additional characters are ignored until a newline is received.
+        // Read the next character from the receive buffer.
         //
-        if(ui32Count < ui32Len)
+        if(GetBufferCount(psRing) != 0)
         {
-            //
-            // Store the character in the caller supplied buffer.
-            //
-            pcBuf[ui32Count] = cChar;
+            cChar = pcRing[psRing->ui32Read & (ui32Size - 1)];
+            RingStoreRelease(&psRing->ui32Read, psRing->ui32Read + 1);
 
             //
-            // Increment the count of characters received.
+            // See if a newline or escape character was received.
             //
-            ui32Count++;
+            if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
+            {
+                //
+                // Stop processing the input and end the line.
+                //
+                break;
+            }
 
             //
-            // Reflect the character back to the user.
+            // Process the received character as long as we are not at the end
+            // of the buffer.  If the end of the buffer has been reached then
+            // all additional characters are ignored until a newline is
+            // received.
             //
-            MAP_UARTCharPut(g_ui32Base, cChar);
+            if(ui32Count < ui32Len)
+            {
+                //
+                // Store the character in the caller supplied buffer.
+                //
+                pcBuf[ui32Count] = cChar;
+
+                //
+                // Increment the count of characters received.
+                //
+                ui32Count++;
+            }
         }
     }
 
@@ -763,43 +1222,29 @@ UARTgets(char *pcBuf, uint32_t ui32Len)
     //
     pcBuf[ui32Count] = 0;
 
-    //
-    // Send a CRLF pair to the terminal to end the line.
-    //
-    UARTwrite("\r\n", 2);
-
     //
     // Return the count of int8_ts in the buffer, not counting the trailing 0.
     //
     return(ui32Count);
-#endif
 }
+#endif
 
 //*****************************************************************************
 //
-//! Read a single character from the UART, blocking if necessary.
-//!
-//! This function will receive a single character from the UART and store it at
-//! the supplied address.
-//!
-//! In both buffered and unbuffered modes, this function will block until a
-//! character is received.  If non-blocking operation is required in buffered
-//! mode, a call to UARTRxAvail() may be made to determine whether any
-//! characters are currently available for reading.
-//!
-//! \return Returns the character read.
+// Read a character from a receive buffer, blocking until there is one.
 //
 //*****************************************************************************
-unsigned char
-UARTgetc(void)
-{
 #ifdef UART_BUFFERED
+static inline unsigned char
+UARTRingGetc(tUARTRing *psRing, const unsigned char *pcRing,
+             uint32_t ui32Size)
+{
     unsigned char cChar;
 
     //
     // Wait for a character to be received.
     //
-    while(RX_BUFFER_EMPTY)
+    while(GetBufferCount(psRing) == 0)
     {
         //
         // Block waiting for a character to be received (if the buffer is
@@ -810,703 +1255,2395 @@ UARTgetc(void)
     //
     // Read a character from the buffer.
     //
-    cChar = g_pcUARTRxBuffer[g_ui32UARTRxReadIndex];
-    ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxReadIndex);
+    cChar = pcRing[psRing->ui32Read & (ui32Size - 1)];
+    RingStoreRelease(&psRing->ui32Read, psRing->ui32Read + 1);
 
-    //
-    // Return the character to the caller.
-    //
     return(cChar);
-#else
-    //
-    // Block until a character is received by the UART then return it to
-    // the caller.
-    //
-    return(MAP_UARTCharGet(g_ui32Base));
-#endif
 }
+#endif
 
 //*****************************************************************************
 //
-//! A simple UART based vprintf function supporting \%c, \%d, \%p, \%s, \%u,
-//! \%x, and \%X.
-//!
-//! \param pcString is the format string.
-//! \param vaArgP is a variable argument list pointer whose content will depend
-//! upon the format string passed in \e pcString.
-//!
-//! This function is very similar to the C library <tt>vprintf()</tt> function.
-//! All of its output will be sent to the UART.  Only the following formatting
-//! characters are supported:
-//!
-//! - \%c to print a character
-//! - \%d or \%i to print a decimal value
-//! - \%s to print a string
-//! - \%u to print an unsigned decimal value
-//! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
-//! - \%p to print a pointer as a hexadecimal value
-//! - \%\% to print out a \% character
-//!
-//! For \%s, \%d, \%i, \%u, \%p, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeroes instead of spaces.
-//!
-//! The type of the arguments in the variable arguments list must match the
-//! requirements of the format string.  For example, if an integer was passed
-//! where a string was expected, an error of some kind will most likely occur.
-//!
-//! \return None.
+// Find a character in a receive buffer.  See UARTPeek().
 //
 //*****************************************************************************
-void
-UARTvprintf(const char *pcString, va_list vaArgP)
+#ifdef UART_BUFFERED
+static inline int
+UARTRingPeek(const tUARTRing *psRing, const unsigned char *pcRing,
+             uint32_t ui32Size, unsigned char ucChar)
 {
-    uint32_t ui32Idx, ui32Value, ui32Pos, ui32Count, ui32Base, ui32Neg;
-    char *pcStr, pcBuf[16], cFill;
+    int iCount;
+    int iAvail;
+    uint32_t ui32ReadIndex;
 
     //
-    // Check the arguments.
+    // How many characters are there in the receive buffer?
     //
-    ASSERT(pcString != 0);
+    iAvail = (int)GetBufferCount(psRing);
+    ui32ReadIndex = psRing->ui32Read;
 
     //
-    // Loop while there are more characters in the string.
+    // Check all the unread characters looking for the one passed.
     //
-    while(*pcString)
+    for(iCount = 0; iCount < iAvail; iCount++)
     {
-        //
-        // Find the first non-% character, or the end of the string.
-        //
-        for(ui32Idx = 0;
-            (pcString[ui32Idx] != '%') && (pcString[ui32Idx] != '\0');
-            ui32Idx++)
+        if(pcRing[ui32ReadIndex & (ui32Size - 1)] == ucChar)
         {
+            //
+            // We found it so return the index
+            //
+            return(iCount);
         }
-
-        //
-        // Write this portion of the string.
-        //
-        UARTwrite(pcString, ui32Idx);
-
-        //
-        // Skip the portion of the string that was written.
-        //
-        pcString += ui32Idx;
-
-        //
-        // See if the next character is a %.
-        //
-        if(*pcString == '%')
+        else
         {
             //
-            // Skip the %.
+            // This one didn't match so move on to the next character.
             //
-            pcString++;
+            ui32ReadIndex++;
+        }
+    }
 
-            //
-            // Set the digit count to zero, and the fill character to space
-            // (in other words, to the defaults).
-            //
-            ui32Count = 0;
-            cFill = ' ';
-
-            //
-            // It may be necessary to get back here to process more characters.
-            // Goto's aren't pretty, but effective.  I feel extremely dirty for
-            // using not one but two of the beasts.
-            //
-again:
+    //
+    // If we drop out of the loop, we didn't find the character in the receive
+    // buffer.
+    //
+    return(-1);
+}
+#endif
 
-            //
-            // Determine how to handle the next character.
-            //
-            switch(*pcString++)
-            {
-                //
-                // Handle the digit characters.
-                //
-                case '0':
-                case '1':
-                case '2':
-                case '3':
-                case '4':
-                case '5':
-                case '6':
-                case '7':
-                case '8':
-                case '9':
-                {
-                    //
-                    // If this is a zero, and it is the first digit, then the
-                    // fill character is a zero instead of a space.
-                    //
-                    if((pcString[-1] == '0') && (ui32Count == 0))
-                    {
-                        cFill = '0';
-                    }
+//*****************************************************************************
+//
+// Retire the span of the transmit buffer the uDMA has finished sending, if
+// any, and if the uDMA is idle start it on the next contiguous span.  Only the
+// UART interrupt handler calls this, as the one reader of the transmit buffer.
+//
+//*****************************************************************************
+#ifdef UART_BUFFERED_DMA
+static void
+UARTPrimeTransmit(uint32_t ui32Base)
+{
+    uint32_t ui32Read, ui32Write, ui32Offset, ui32Span;
 
-                    //
-                    // Update the digit count.
-                    //
-                    ui32Count *= 10;
-                    ui32Count += pcString[-1] - '0';
+    ui32Read = g_sUARTTxRing.ui32Read;
 
-                    //
-                    // Get the next character.
-                    //
-                    goto again;
-                }
+    //
+    // Has the transfer in progress finished?  The uDMA disables the channel
+    // once the last byte is in the transmit FIFO, and the span can be handed
+    // back to UARTwrite().
+    //
+    if(g_ui32UARTTxDMASpan &&
+       !MAP_uDMAChannelIsEnabled(g_ui32UARTTxChannel))
+    {
+        MAP_uDMAIntClear(1 << g_ui32UARTTxChannel);
+        ui32Read += g_ui32UARTTxDMASpan;
+        g_ui32UARTTxDMASpan = 0;
+        RingStoreRelease(&g_sUARTTxRing.ui32Read, ui32Read);
+    }
 
-                //
-                // Handle the %c command.
-                //
-                case 'c':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
+    //
+    // If the uDMA is idle and there is anything to send, hand it the bytes
+    // from the read index up to the write index, or to the end of the buffer
+    // if they wrap.
+    //
+    ui32Write = RingLoadAcquire(&g_sUARTTxRing.ui32Write);
 
-                    //
-                    // Print out the character.
-                    //
-                    UARTwrite((char *)&ui32Value, 1);
+    if(!g_ui32UARTTxDMASpan && (ui32Read != ui32Write))
+    {
+        ui32Offset = ui32Read & TX_BUFFER_MASK;
+        ui32Span = ui32Write - ui32Read;
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+        if(ui32Span > UART_TX_BUFFER_SIZE - ui32Offset)
+        {
+            ui32Span = UART_TX_BUFFER_SIZE - ui32Offset;
+        }
 
-                //
-                // Handle the %d and %i commands.
-                //
-                case 'd':
-                case 'i':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
+        if(ui32Span > UART_DMA_SPAN_MAX)
+        {
+            ui32Span = UART_DMA_SPAN_MAX;
+        }
 
-                    //
-                    // Reset the buffer position.
-                    //
-                    ui32Pos = 0;
+        g_ui32UARTTxDMASpan = ui32Span;
 
-                    //
-                    // If the value is negative, make it positive and indicate
-                    // that a minus sign is needed.
-                    //
-                    if((int32_t)ui32Value < 0)
-                    {
-                        //
-                        // Make the value positive.
-                        //
-                        ui32Value = -(int32_t)ui32Value;
+        MAP_uDMAChannelTransferSet(g_ui32UARTTxChannel | UDMA_PRI_SELECT,
+                                   UDMA_MODE_BASIC,
+                                   g_pcUARTTxBuffer + ui32Offset,
+                                   (void *)(ui32Base + UART_O_DR), ui32Span);
+        MAP_uDMAChannelEnable(g_ui32UARTTxChannel);
+    }
+}
+#endif
 
-                        //
-                        // Indicate that the value is negative.
-                        //
-                        ui32Neg = 1;
-                    }
-                    else
-                    {
-                        //
-                        // Indicate that the value is positive so that a minus
-                        // sign isn't inserted.
-                        //
-                        ui32Neg = 0;
-                    }
+//*****************************************************************************
+//
+//! Configures the UART console.
+//!
+//! \param ui32PortNum is the number of UART port to use for the serial console
+//! (0-2)
+//! \param ui32Baud is the bit rate that the UART is to be configured to use.
+//! \param ui32SrcClock is the frequency of the source clock for the UART
+//! module.
+//!
+//! This function will configure the specified serial port to be used as a
+//! serial console.  The serial parameters are set to the baud rate
+//! specified by the \e ui32Baud parameter and use 8 bit, no parity, and 1 stop
+//! bit.
+//!
+//! This function must be called prior to using any of the other UART console
+//! functions: UARTprintf() or UARTgets().  This function assumes that the
+//! caller has previously configured the relevant UART pins for operation as a
+//! UART rather than as GPIOs.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT((ui32PortNum == 0) || (ui32PortNum == 1) ||
+           (ui32PortNum == 2));
 
-                    //
-                    // Set the base to 10.
-                    //
-                    ui32Base = 10;
+#ifdef UART_BUFFERED
+    //
+    // In buffered mode, we only allow a single instance to be opened.
+    //
+    ASSERT(g_ui32Base == 0);
+#endif
 
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
-                }
+    //
+    // Check to make sure the UART peripheral is present.
+    //
+    if(!MAP_SysCtlPeripheralPresent(g_ui32UARTPeriph[ui32PortNum]))
+    {
+        return;
+    }
 
-                //
-                // Handle the %s command.
-                //
-                case 's':
-                {
-                    //
-                    // Get the string pointer from the varargs.
-                    //
-                    pcStr = va_arg(vaArgP, char *);
+    //
+    // Select the base address of the UART.
+    //
+    g_ui32Base = g_ui32UARTBase[ui32PortNum];
 
-                    //
-                    // Determine the length of the string.
-                    //
-                    for(ui32Idx = 0; pcStr[ui32Idx] != '\0'; ui32Idx++)
-                    {
-                    }
+    //
+    // Enable the UART peripheral for use.
+    //
+    MAP_SysCtlPeripheralEnable(g_ui32UARTPeriph[ui32PortNum]);
 
-                    //
-                    // Write the string.
-                    //
-                    UARTwrite(pcStr, ui32Idx);
+    //
+    // Configure the UART for 115200, n, 8, 1
+    //
+    MAP_UARTConfigSetExpClk(g_ui32Base, ui32SrcClock, ui32Baud,
+                            (UART_CONFIG_PAR_NONE | UART_CONFIG_STOP_ONE |
+                             UART_CONFIG_WLEN_8));
 
-                    //
-                    // Write any required padding spaces
-                    //
-                    if(ui32Count > ui32Idx)
-                    {
-                        ui32Count -= ui32Idx;
-                        while(ui32Count--)
-                        {
-                            UARTwrite(" ", 1);
-                        }
-                    }
+#ifdef UART_BUFFERED
+    //
+    // Set the UART to interrupt whenever the TX FIFO is almost empty or
+    // when any character is received.
+    //
+    MAP_UARTFIFOLevelSet(g_ui32Base, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+#ifdef UART_BUFFERED_DMA
+    //
+    // Set up the uDMA channel of the transmit FIFO to move bytes, four at a
+    // time, from the transmit buffer to the data register, and let the UART
+    // request them whenever the FIFO is down to its trigger level.
+    //
+    g_ui32UARTTxChannel = g_ui32UARTTxDMA[ui32PortNum] & 0xff;
+    MAP_uDMAChannelAssign(g_ui32UARTTxDMA[ui32PortNum]);
+    MAP_uDMAChannelAttributeDisable(g_ui32UARTTxChannel,
+                                    UDMA_ATTR_ALL);
+    MAP_uDMAChannelControlSet(g_ui32UARTTxChannel | UDMA_PRI_SELECT,
+                              (UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                               UDMA_DST_INC_NONE | UDMA_ARB_4));
+    MAP_UARTDMAEnable(g_ui32Base, UART_DMA_TX);
+#endif
 
-                //
-                // Handle the %u command.
-                //
-                case 'u':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
+    //
+    // Flush both the buffers.
+    //
+    UARTFlushRx();
+    UARTFlushTx(true);
 
-                    //
-                    // Reset the buffer position.
-                    //
-                    ui32Pos = 0;
+    //
+    // Remember which interrupt we are dealing with.
+    //
+    g_ui32PortNum = ui32PortNum;
 
-                    //
-                    // Set the base to 10.
-                    //
-                    ui32Base = 10;
+    //
+    // We are configured for buffered output so enable the master interrupt
+    // for this UART and the receive interrupts.  We don't actually enable the
+    // transmit interrupt in the UART itself until some data has been placed
+    // in the transmit buffer.
+    //
+    MAP_UARTIntDisable(g_ui32Base, 0xFFFFFFFF);
+    MAP_UARTIntEnable(g_ui32Base, UART_INT_RX | UART_INT_RT);
+    MAP_IntEnable(g_ui32UARTInt[ui32PortNum]);
+#endif
 
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ui32Neg = 0;
+    //
+    // Enable the UART operation.
+    //
+    MAP_UARTEnable(g_ui32Base);
+}
 
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
-                }
+//*****************************************************************************
+//
+//! Writes a string of characters to the UART output.
+//!
+//! \param pcBuf points to a buffer containing the string to transmit.
+//! \param ui32Len is the length of the string to transmit.
+//!
+//! This function will transmit the string to the UART output.  The number of
+//! characters transmitted is determined by the \e ui32Len parameter.  This
+//! function does no interpretation or translation of any characters.  Since
+//! the output is sent to a UART, any LF (/n) characters encountered will be
+//! replaced with a CRLF pair.
+//!
+//! Besides using the \e ui32Len parameter to stop transmitting the string, if
+//! a null character (0) is encountered, then no more characters will be
+//! transmitted and the function will return.
+//!
+//! In non-buffered mode, this function is blocking and will not return until
+//! all the characters have been written to the output FIFO.  In buffered mode,
+//! the characters are written to the UART transmit buffer and the call returns
+//! immediately.  If insufficient space remains in the transmit buffer,
+//! additional characters are discarded.  In buffered mode the transmit buffer
+//! has a single writer, so this function and UARTprintf() must not be called
+//! from more than one context at a time.
+//!
+//! \return Returns the count of characters written.
+//
+//*****************************************************************************
+int
+UARTwrite(const char *pcBuf, uint32_t ui32Len)
+{
+#ifdef UART_BUFFERED
+    //
+    // Check for valid arguments.
+    //
+    ASSERT(pcBuf != 0);
+    ASSERT(g_ui32Base != 0);
+
+    return(UARTRingWrite(&g_sUARTTxRing, g_pcUARTTxBuffer, UART_TX_BUFFER_SIZE,
+                         &g_sUARTEcho, g_ui32UARTInt[g_ui32PortNum], pcBuf,
+                         ui32Len));
+#else
+    unsigned int uIdx;
+
+    //
+    // Check for valid UART base address, and valid arguments.
+    //
+    ASSERT(g_ui32Base != 0);
+    ASSERT(pcBuf != 0);
+
+    //
+    // Send the characters
+    //
+    for(uIdx = 0; uIdx < ui32Len; uIdx++)
+    {
+        //
+        // If the character to the UART is \n, then add a \r before it so that
+        // \n is translated to \n\r in the output.
+        //
+        if(pcBuf[uIdx] == '\n')
+        {
+            MAP_UARTCharPut(g_ui32Base, '\r');
+        }
+        else if(pcBuf[uIdx] == 0)
+		{
+        	break;
+		}
+
+        //
+        // Send the character to the UART output.
+        //
+        MAP_UARTCharPut(g_ui32Base, pcBuf[uIdx]);
+    }
+
+    //
+    // Return the number of characters written.
+    //
+    return(uIdx);
+#endif
+}
+
+//*****************************************************************************
+//
+//! A simple UART based get string function, with some line processing.
+//!
+//! \param pcBuf points to a buffer for the incoming string from the UART.
+//! \param ui32Len is the length of the buffer for storage of the string,
+//! including the trailing 0.
+//!
+//! This function will receive a string from the UART input and store the
+//! characters in the buffer pointed to by \e pcBuf.  The characters will
+//! continue to be stored until a termination character is received.  The
+//! termination characters are CR, LF, or ESC.  A CRLF pair is treated as a
+//! single termination character.  The termination characters are not stored in
+//! the string.  The string will be terminated with a 0 and the function will
+//! return.
+//!
+//! In both buffered and unbuffered modes, this function will block until
+//! a termination character is received.  If non-blocking operation is required
+//! in buffered mode, a call to UARTPeek() may be made to determine whether
+//! a termination character already exists in the receive buffer prior to
+//! calling UARTgets().
+//!
+//! Since the string will be null terminated, the user must ensure that the
+//! buffer is sized to allow for the additional null character.
+//!
+//! \return Returns the count of characters that were stored, not including
+//! the trailing 0.
+//
+//*****************************************************************************
+int
+UARTgets(char *pcBuf, uint32_t ui32Len)
+{
+#ifdef UART_BUFFERED
+    //
+    // Check the arguments.
+    //
+    ASSERT(pcBuf != 0);
+    ASSERT(ui32Len != 0);
+    ASSERT(g_ui32Base != 0);
+
+    return(UARTRingGets(&g_sUARTRxRing, g_pcUARTRxBuffer, UART_RX_BUFFER_SIZE,
+                        pcBuf, ui32Len));
+#else
+    uint32_t ui32Count = 0;
+    int8_t cChar;
+    static int8_t bLastWasCR = 0;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pcBuf != 0);
+    ASSERT(ui32Len != 0);
+    ASSERT(g_ui32Base != 0);
+
+    //
+    // Adjust the length back by 1 to leave space for the trailing
+    // null terminator.
+    //
+    ui32Len--;
+
+    //
+    // Process characters until a newline is received.
+    //
+    while(1)
+    {
+        //
+        // Read the next character from the console.
+        //
+        cChar = MAP_UARTCharGet(g_ui32Base);
 
+        //
+        // See if the backspace key was pressed.
+        //
+        if(cChar == '\b')
+        {
+            //
+            // If there are any characters already in the buffer, then delete
+            // the last.
+            //
+            if(ui32Count)
+            {
                 //
-                // Handle the %x and %X commands.  Note that they are treated
-                // identically; in other words, %X will use lower case letters
-                // for a-f instead of the upper case letters it should use.  We
-                // also alias %p to %x.
+                // Rub out the previous character.
                 //
-                case 'x':
-                case 'X':
-                case 'p':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ui32Value = va_arg(vaArgP, uint32_t);
+                UARTwrite("\b \b", 3);
 
-                    //
-                    // Reset the buffer position.
-                    //
-                    ui32Pos = 0;
+                //
+                // Decrement the number of characters in the buffer.
+                //
+                ui32Count--;
+            }
+
+            //
+            // Skip ahead to read the next character.
+            //
+            continue;
+        }
+
+        //
+        // If this character is LF and last was CR, then just gobble up the
+        // character because the EOL processing was taken care of with the CR.
+        //
+        if((cChar == '\n') && bLastWasCR)
+        {
+            bLastWasCR = 0;
+            continue;
+        }
+
+        //
+        // See if a newline or escape character was received.
+        //
+        if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
+        {
+            //
+            // If the character is a CR, then it may be followed by a LF which
+            // should be paired with the CR.  So remember that a CR was
+            // received.
+            //
+            if(cChar == '\r')
+            {
+                bLastWasCR = 1;
+            }
+
+            //
+            // Stop processing the input and end the line.
+            //
+            break;
+        }
+
+        //
+        // Process the received character as long as we are not at the end of
+        // the buffer.  If the end of the buffer has been reached then all
+        // additional characters are ignored until a newline is received.
+        //
+        if(ui32Count < ui32Len)
+        {
+            //
+            // Store the character in the caller supplied buffer.
+            //
+            pcBuf[ui32Count] = cChar;
+
+            //
+            // Increment the count of characters received.
+            //
+            ui32Count++;
+
+            //
+            // Reflect the character back to the user.
+            //
+            MAP_UARTCharPut(g_ui32Base, cChar);
+        }
+    }
+
+    //
+    // Add a null termination to the string.
+    //
+    pcBuf[ui32Count] = 0;
+
+    //
+    // Send a CRLF pair to the terminal to end the line.
+    //
+    UARTwrite("\r\n", 2);
+
+    //
+    // Return the count of int8_ts in the buffer, not counting the trailing 0.
+    //
+    return(ui32Count);
+#endif
+}
+
+//*****************************************************************************
+//
+//! Read a single character from the UART, blocking if necessary.
+//!
+//! This function will receive a single character from the UART and store it at
+//! the supplied address.
+//!
+//! In both buffered and unbuffered modes, this function will block until a
+//! character is received.  If non-blocking operation is required in buffered
+//! mode, a call to UARTRxAvail() may be made to determine whether any
+//! characters are currently available for reading.
+//!
+//! \return Returns the character read.
+//
+//*****************************************************************************
+unsigned char
+UARTgetc(void)
+{
+#ifdef UART_BUFFERED
+    return(UARTRingGetc(&g_sUARTRxRing, g_pcUARTRxBuffer,
+                        UART_RX_BUFFER_SIZE));
+#else
+    //
+    // Block until a character is received by the UART then return it to
+    // the caller.
+    //
+    return(MAP_UARTCharGet(g_ui32Base));
+#endif
+}
+
+//*****************************************************************************
+//
+// Write characters to a port of uartport.h, or to the console if psPort is 0.
+// Without UART_STDIO_PORTS this is UARTwrite().
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS
+#define UARTStdioWrite(psPort, pcBuf, ui32Len)                                \
+        ((psPort) ? UARTPortWrite((psPort), (pcBuf), (ui32Len)) :             \
+                    UARTwrite((pcBuf), (ui32Len)))
+#else
+#define UARTStdioWrite(psPort, pcBuf, ui32Len)                                \
+        ((void)(psPort), UARTwrite((pcBuf), (ui32Len)))
+#endif
+
+//*****************************************************************************
+//
+// The numbers of UARTvprintf() are converted without division, which the
+// Cortex-M4 takes up to 12 cycles for and a build without optimization calls
+// a library routine for.  Decimal digits come two at a time from
+// g_pcDigitPairs, the quotient by 100 being a multiply by its reciprocal,
+// and hexadecimal digits a nibble at a time.  Digits are put into the end of
+// a buffer, right to left, and the sign and padding in front of them, so the
+// number goes out with a single write.  \%f is only built with
+// UART_PRINTF_FLOAT, as fetching a double from the arguments slows down every
+// call on some targets and its conversion takes up flash that most firmware
+// has no use for.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The decimal digits of 0 to 99, two to a number.
+//
+//*****************************************************************************
+static const char g_pcDigitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+//*****************************************************************************
+//
+// The largest number of padding characters put in front of a number, the
+// widest field that is padded, and the largest number of digits after the
+// point of \%f.
+//
+//*****************************************************************************
+#define UART_FORMAT_PAD_MAX     14
+#define UART_FORMAT_WIDTH_MAX   16
+#define UART_FORMAT_PREC_MAX    9
+
+//*****************************************************************************
+//
+// The size of the buffer on the stack of UARTvprintf() that a number is
+// formatted in: 16 bytes as it has always been, for a padded field or the
+// sign and 10 digits of an integer.  With UART_PRINTF_FLOAT it is 21 bytes,
+// for the sign and 10 digits before and UART_FORMAT_PREC_MAX after the point
+// of \%f.
+//
+//*****************************************************************************
+#ifdef UART_PRINTF_FLOAT
+#define UART_FORMAT_BUFFER      (1 + 10 + 1 + UART_FORMAT_PREC_MAX)
+#else
+#define UART_FORMAT_BUFFER      UART_FORMAT_WIDTH_MAX
+#endif
+
+//*****************************************************************************
+//
+// Return ui32Value / 100.  0x51EB851F is 2^37 / 100 rounded up, which gives
+// the exact quotient for every 32-bit value.
+//
+//*****************************************************************************
+static inline uint32_t
+UARTFormatDiv100(uint32_t ui32Value)
+{
+    return((uint32_t)(((uint64_t)ui32Value * 0x51EB851FU) >> 37));
+}
+
+//*****************************************************************************
+//
+// Put the decimal digits of a value in front of pcEnd and return where they
+// start.
+//
+//*****************************************************************************
+static char *
+UARTFormatDecimal(char *pcEnd, uint32_t ui32Value)
+{
+    uint32_t ui32Quotient, ui32Pair;
+
+    while(ui32Value >= 100)
+    {
+        ui32Quotient = UARTFormatDiv100(ui32Value);
+        ui32Pair = (ui32Value - (ui32Quotient * 100)) * 2;
+        *--pcEnd = g_pcDigitPairs[ui32Pair + 1];
+        *--pcEnd = g_pcDigitPairs[ui32Pair];
+        ui32Value = ui32Quotient;
+    }
+
+    if(ui32Value >= 10)
+    {
+        *--pcEnd = g_pcDigitPairs[(ui32Value * 2) + 1];
+        *--pcEnd = g_pcDigitPairs[ui32Value * 2];
+    }
+    else
+    {
+        *--pcEnd = '0' + ui32Value;
+    }
+
+    return(pcEnd);
+}
+
+//*****************************************************************************
+//
+// Put the hexadecimal digits of a value in front of pcEnd and return where
+// they start.
+//
+//*****************************************************************************
+static char *
+UARTFormatHex(char *pcEnd, uint32_t ui32Value)
+{
+    do
+    {
+        *--pcEnd = g_pcHex[ui32Value & 15];
+        ui32Value >>= 4;
+    }
+    while(ui32Value);
+
+    return(pcEnd);
+}
+
+//*****************************************************************************
+//
+// Put the digits of a double, with ui32Prec digits after the point, in front
+// of pcEnd and return where they start, or 0 if the integer part does not fit
+// in 32 bits.  The value is taken apart from its IEEE 754 representation with
+// integer arithmetic, so that no floating-point library is needed; fraction
+// digits come from multiplying the fraction, as a fixed-point number with 60
+// bits after the point, by ten.  The sign is left to the caller.
+//
+//*****************************************************************************
+#ifdef UART_PRINTF_FLOAT
+static char *
+UARTFormatFloat(char *pcEnd, uint64_t ui64Bits, uint32_t ui32Prec)
+{
+    uint64_t ui64Mantissa, ui64Fraction;
+    int32_t i32Exp;
+    uint32_t ui32Int, ui32Idx;
+    bool bInexact;
+    char *pcDigit;
+
+    i32Exp = (int32_t)((ui64Bits >> 52) & 0x7ff);
+    ui64Mantissa = ui64Bits & ((1ULL << 52) - 1);
+
+    //
+    // Infinities and NaNs.
+    //
+    if(i32Exp == 0x7ff)
+    {
+        pcEnd -= 3;
+        pcEnd[0] = ui64Mantissa ? 'n' : 'i';
+        pcEnd[1] = ui64Mantissa ? 'a' : 'n';
+        pcEnd[2] = ui64Mantissa ? 'n' : 'f';
+        return(pcEnd);
+    }
+
+    //
+    // The value is ui64Mantissa * 2^(i32Exp - 52), the leading one made
+    // explicit for numbers that are not subnormal.
+    //
+    if(i32Exp != 0)
+    {
+        ui64Mantissa |= 1ULL << 52;
+    }
+    else
+    {
+        i32Exp = 1;
+    }
+    i32Exp -= 1023;
+
+    if(i32Exp >= 32)
+    {
+        return(0);
+    }
+
+    //
+    // Split the value into its integer part and its fraction, with 60 bits
+    // after the point.  Bits of the fraction below 2^-60 are dropped, which
+    // is far below UART_FORMAT_PREC_MAX digits, but remembered so that the
+    // rounding below can tell a value just over a half from a half.
+    //
+    bInexact = false;
+    if(i32Exp >= 0)
+    {
+        ui32Int = (uint32_t)(ui64Mantissa >> (52 - i32Exp));
+        ui64Fraction = (ui64Mantissa << (8 + i32Exp)) & ((1ULL << 60) - 1);
+    }
+    else if(i32Exp >= -8)
+    {
+        ui32Int = 0;
+        ui64Fraction = ui64Mantissa << (8 + i32Exp);
+    }
+    else if(i32Exp > -61)
+    {
+        ui32Int = 0;
+        ui64Fraction = ui64Mantissa >> (-8 - i32Exp);
+        bInexact = (ui64Fraction << (-8 - i32Exp)) != ui64Mantissa;
+    }
+    else
+    {
+        ui32Int = 0;
+        ui64Fraction = 0;
+        bInexact = ui64Mantissa != 0;
+    }
+
+    //
+    // Produce the fraction digits left to right, then round on what is left,
+    // to the even digit if it is exactly a half, as the C library does, and
+    // carry into the integer part if the digits are all nines.
+    //
+    pcDigit = pcEnd - ui32Prec;
+    for(ui32Idx = 0; ui32Idx < ui32Prec; ui32Idx++)
+    {
+        ui64Fraction *= 10;
+        pcDigit[ui32Idx] = '0' + (char)(ui64Fraction >> 60);
+        ui64Fraction &= (1ULL << 60) - 1;
+    }
+
+    if((ui64Fraction > (1ULL << 59)) ||
+       ((ui64Fraction == (1ULL << 59)) &&
+        (bInexact || (ui32Prec ? (pcDigit[ui32Prec - 1] & 1) : (ui32Int & 1)))))
+    {
+        for(ui32Idx = ui32Prec; ui32Idx; ui32Idx--)
+        {
+            if(pcDigit[ui32Idx - 1] != '9')
+            {
+                pcDigit[ui32Idx - 1]++;
+                break;
+            }
+            pcDigit[ui32Idx - 1] = '0';
+        }
+
+        if(ui32Idx == 0)
+        {
+            if(ui32Int == 0xFFFFFFFF)
+            {
+                return(0);
+            }
+            ui32Int++;
+        }
+    }
+
+    if(ui32Prec)
+    {
+        *--pcDigit = '.';
+    }
+
+    return(UARTFormatDecimal(pcDigit, ui32Int));
+}
+#endif
+
+//*****************************************************************************
+//
+// Put the sign and the padding of a number in front of its digits, at pcStr
+// up to pcEnd, for a width of ui32Count, and return where they start.  A
+// minus sign goes before zeros and after spaces.  As UARTvprintf() always
+// has, at most UART_FORMAT_PAD_MAX characters of padding are added, and none
+// at all if more would be needed or the field is wider than
+// UART_FORMAT_WIDTH_MAX, which the old formatter overflowed its buffer on.
+//
+//*****************************************************************************
+static char *
+UARTFormatPad(char *pcStr, const char *pcEnd, bool bNeg, uint32_t ui32Count,
+              char cFill)
+{
+    uint32_t ui32Len;
+
+    ui32Len = (uint32_t)(pcEnd - pcStr) + (bNeg ? 1 : 0);
+
+    if(bNeg && (cFill != '0'))
+    {
+        *--pcStr = '-';
+    }
+
+    if((ui32Count > ui32Len) && (ui32Count <= UART_FORMAT_WIDTH_MAX) &&
+       (ui32Count - ui32Len <= UART_FORMAT_PAD_MAX))
+    {
+        for(ui32Count -= ui32Len; ui32Count; ui32Count--)
+        {
+            *--pcStr = cFill;
+        }
+    }
+
+    if(bNeg && (cFill == '0'))
+    {
+        *--pcStr = '-';
+    }
+
+    return(pcStr);
+}
+
+//*****************************************************************************
+//
+// Format a string to a port of uartport.h, or to the console if psPort is 0.
+// See UARTvprintf().
+//
+//*****************************************************************************
+static void
+UARTStdioVprintf(tUARTPort *psPort, const char *pcString, va_list vaArgP)
+{
+    uint32_t ui32Idx, ui32Value, ui32Count, ui32Base, ui32Neg;
+    char *pcStr, pcBuf[UART_FORMAT_BUFFER], cFill;
+#ifdef UART_PRINTF_FLOAT
+    uint32_t ui32Prec;
+    union
+    {
+        double dValue;
+        uint64_t ui64Bits;
+    }
+    uFloat;
+#endif
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(pcString != 0);
+
+    //
+    // Loop while there are more characters in the string.
+    //
+    while(*pcString)
+    {
+        //
+        // Find the first non-% character, or the end of the string.
+        //
+        for(ui32Idx = 0;
+            (pcString[ui32Idx] != '%') && (pcString[ui32Idx] != '\0');
+            ui32Idx++)
+        {
+        }
+
+        //
+        // Write this portion of the string, if there is one.  A format that
+        // starts with a conversion or has two in a row has none.
+        //
+        if(ui32Idx)
+        {
+            UARTStdioWrite(psPort, pcString, ui32Idx);
+        }
+
+        //
+        // Skip the portion of the string that was written.
+        //
+        pcString += ui32Idx;
+
+        //
+        // See if the next character is a %.
+        //
+        if(*pcString == '%')
+        {
+            //
+            // Skip the %.
+            //
+            pcString++;
+
+            //
+            // Set the digit count to zero, and the fill character to space
+            // (in other words, to the defaults).
+            //
+            ui32Count = 0;
+            cFill = ' ';
+#ifdef UART_PRINTF_FLOAT
+            ui32Prec = 6;
+#endif
+
+            //
+            // It may be necessary to get back here to process more characters.
+            // Goto's aren't pretty, but effective.  I feel extremely dirty for
+            // using not one but two of the beasts.
+            //
+again:
+
+            //
+            // Determine how to handle the next character.
+            //
+            switch(*pcString++)
+            {
+                //
+                // Handle the digit characters.
+                //
+                case '0':
+                case '1':
+                case '2':
+                case '3':
+                case '4':
+                case '5':
+                case '6':
+                case '7':
+                case '8':
+                case '9':
+                {
+                    //
+                    // If this is a zero, and it is the first digit, then the
+                    // fill character is a zero instead of a space.
+                    //
+                    if((pcString[-1] == '0') && (ui32Count == 0))
+                    {
+                        cFill = '0';
+                    }
+
+                    //
+                    // Update the digit count.
+                    //
+                    ui32Count *= 10;
+                    ui32Count += pcString[-1] - '0';
+
+                    //
+                    // Get the next character.
+                    //
+                    goto again;
+                }
+
+#ifdef UART_PRINTF_FLOAT
+                //
+                // Handle the precision of %f.
+                //
+                case '.':
+                {
+                    for(ui32Prec = 0; (*pcString >= '0') && (*pcString <= '9');
+                        pcString++)
+                    {
+                        ui32Prec = (ui32Prec * 10) + (*pcString - '0');
+                    }
+
+                    if(ui32Prec > UART_FORMAT_PREC_MAX)
+                    {
+                        ui32Prec = UART_FORMAT_PREC_MAX;
+                    }
+
+                    //
+                    // Get the next character.
+                    //
+                    goto again;
+                }
+#endif
+
+                //
+                // Handle the %c command.
+                //
+                case 'c':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    ui32Value = va_arg(vaArgP, uint32_t);
+
+                    //
+                    // Print out the character.
+                    //
+                    UARTStdioWrite(psPort, (char *)&ui32Value, 1);
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+                //
+                // Handle the %d and %i commands.
+                //
+                case 'd':
+                case 'i':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    ui32Value = va_arg(vaArgP, uint32_t);
+
+                    //
+                    // If the value is negative, make it positive and indicate
+                    // that a minus sign is needed.
+                    //
+                    if((int32_t)ui32Value < 0)
+                    {
+                        //
+                        // Make the value positive.
+                        //
+                        ui32Value = -(int32_t)ui32Value;
+
+                        //
+                        // Indicate that the value is negative.
+                        //
+                        ui32Neg = 1;
+                    }
+                    else
+                    {
+                        //
+                        // Indicate that the value is positive so that a minus
+                        // sign isn't inserted.
+                        //
+                        ui32Neg = 0;
+                    }
+
+                    //
+                    // Set the base to 10.
+                    //
+                    ui32Base = 10;
+
+                    //
+                    // Convert the value to ASCII.
+                    //
+                    goto convert;
+                }
+
+                //
+                // Handle the %s command.
+                //
+                case 's':
+                {
+                    //
+                    // Get the string pointer from the varargs.
+                    //
+                    pcStr = va_arg(vaArgP, char *);
+
+                    //
+                    // Determine the length of the string.
+                    //
+                    for(ui32Idx = 0; pcStr[ui32Idx] != '\0'; ui32Idx++)
+                    {
+                    }
+
+                    //
+                    // Write the string.
+                    //
+                    UARTStdioWrite(psPort, pcStr, ui32Idx);
+
+                    //
+                    // Write any required padding spaces, as many at a time as
+                    // the buffer holds.
+                    //
+                    if(ui32Count > ui32Idx)
+                    {
+                        for(ui32Count -= ui32Idx; ui32Count;
+                            ui32Count -= ui32Idx)
+                        {
+                            ui32Idx = (ui32Count < sizeof(pcBuf)) ?
+                                      ui32Count : sizeof(pcBuf);
+                            for(pcStr = pcBuf; pcStr < pcBuf + ui32Idx;
+                                pcStr++)
+                            {
+                                *pcStr = ' ';
+                            }
+                            UARTStdioWrite(psPort, pcBuf, ui32Idx);
+                        }
+                    }
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+                //
+                // Handle the %u command.
+                //
+                case 'u':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    ui32Value = va_arg(vaArgP, uint32_t);
+
+                    //
+                    // Set the base to 10.
+                    //
+                    ui32Base = 10;
+
+                    //
+                    // Indicate that the value is positive so that a minus sign
+                    // isn't inserted.
+                    //
+                    ui32Neg = 0;
+
+                    //
+                    // Convert the value to ASCII.
+                    //
+                    goto convert;
+                }
+
+                //
+                // Handle the %x and %X commands.  Note that they are treated
+                // identically; in other words, %X will use lower case letters
+                // for a-f instead of the upper case letters it should use.  We
+                // also alias %p to %x.
+                //
+                case 'x':
+                case 'X':
+                case 'p':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    ui32Value = va_arg(vaArgP, uint32_t);
+
+                    //
+                    // Set the base to 16.
+                    //
+                    ui32Base = 16;
+
+                    //
+                    // Indicate that the value is positive so that a minus sign
+                    // isn't inserted.
+                    //
+                    ui32Neg = 0;
+
+                    //
+                    // Convert the value into the end of the buffer, then put
+                    // the sign and padding in front of it.
+                    //
+convert:
+                    if(ui32Base == 16)
+                    {
+                        pcStr = UARTFormatHex(pcBuf + sizeof(pcBuf),
+                                              ui32Value);
+                    }
+                    else
+                    {
+                        pcStr = UARTFormatDecimal(pcBuf + sizeof(pcBuf),
+                                                  ui32Value);
+                    }
+
+                    pcStr = UARTFormatPad(pcStr, pcBuf + sizeof(pcBuf),
+                                          ui32Neg, ui32Count, cFill);
+
+                    //
+                    // Write the string.
+                    //
+                    UARTStdioWrite(psPort, pcStr,
+                                   (pcBuf + sizeof(pcBuf)) - pcStr);
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+#ifdef UART_PRINTF_FLOAT
+                //
+                // Handle the %f command, with ui32Prec digits after the point.
+                // float arguments are promoted to double.
+                //
+                case 'f':
+                {
+                    //
+                    // Get the value from the varargs.
+                    //
+                    uFloat.dValue = va_arg(vaArgP, double);
+                    ui32Neg = (uint32_t)(uFloat.ui64Bits >> 63);
+
+                    pcStr = UARTFormatFloat(pcBuf + sizeof(pcBuf),
+                                            uFloat.ui64Bits, ui32Prec);
+
+                    //
+                    // Values of 2^32 and over are not supported.
+                    //
+                    if(!pcStr)
+                    {
+                        UARTStdioWrite(psPort, "ERROR", 5);
+                        break;
+                    }
+
+                    pcStr = UARTFormatPad(pcStr, pcBuf + sizeof(pcBuf),
+                                          ui32Neg, ui32Count, cFill);
+
+                    //
+                    // Write the string.
+                    //
+                    UARTStdioWrite(psPort, pcStr,
+                                   (pcBuf + sizeof(pcBuf)) - pcStr);
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+#endif
+
+                //
+                // Handle the %% command.
+                //
+                case '%':
+                {
+                    //
+                    // Simply write a single %.
+                    //
+                    UARTStdioWrite(psPort, pcString - 1, 1);
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+
+                //
+                // Handle all other commands.
+                //
+                default:
+                {
+                    //
+                    // Indicate an error.
+                    //
+                    UARTStdioWrite(psPort, "ERROR", 5);
+
+                    //
+                    // This command has been handled.
+                    //
+                    break;
+                }
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! A simple UART based vprintf function supporting \%c, \%d, \%p, \%s, \%u,
+//! \%x, and \%X.
+//!
+//! \param pcString is the format string.
+//! \param vaArgP is a variable argument list pointer whose content will depend
+//! upon the format string passed in \e pcString.
+//!
+//! This function is very similar to the C library <tt>vprintf()</tt> function.
+//! All of its output will be sent to the UART.  Only the following formatting
+//! characters are supported:
+//!
+//! - \%c to print a character
+//! - \%d or \%i to print a decimal value
+//! - \%s to print a string
+//! - \%u to print an unsigned decimal value
+//! - \%x to print a hexadecimal value using lower case letters
+//! - \%X to print a hexadecimal value using lower case letters (not upper case
+//! letters as would typically be used)
+//! - \%p to print a pointer as a hexadecimal value
+//! - \%f to print a double, if the module is built with \b UART_PRINTF_FLOAT
+//! - \%\% to print out a \% character
+//!
+//! For \%s, \%d, \%i, \%u, \%p, \%x, \%X and \%f, an optional number may
+//! reside between the \% and the format character, which specifies the minimum
+//! number of characters to use for that value; if preceded by a 0 then the
+//! extra characters will be filled with zeros instead of spaces.  For example,
+//! ``\%8d'' will use eight characters to print the decimal value with spaces
+//! added to reach eight; ``\%08d'' will use eight characters as well but will
+//! add zeroes instead of spaces.  \%f takes a precision too, ``\%.3f''
+//! printing three digits after the point; the default is six and the most
+//! nine, and values of 2^32 and over print as ERROR.  Numbers are padded to at
+//! most 16 characters; one with a wider field is printed without padding.
+//!
+//! The type of the arguments in the variable arguments list must match the
+//! requirements of the format string.  For example, if an integer was passed
+//! where a string was expected, an error of some kind will most likely occur.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTvprintf(const char *pcString, va_list vaArgP)
+{
+    UARTStdioVprintf(0, pcString, vaArgP);
+}
+
+//*****************************************************************************
+//
+//! A simple UART based printf function supporting \%c, \%d, \%p, \%s, \%u,
+//! \%x, and \%X.
+//!
+//! \param pcString is the format string.
+//! \param ... are the optional arguments, which depend on the contents of the
+//! format string.
+//!
+//! This function is very similar to the C library <tt>fprintf()</tt> function.
+//! All of its output will be sent to the UART.  Only the following formatting
+//! characters are supported:
+//!
+//! - \%c to print a character
+//! - \%d or \%i to print a decimal value
+//! - \%s to print a string
+//! - \%u to print an unsigned decimal value
+//! - \%x to print a hexadecimal value using lower case letters
+//! - \%X to print a hexadecimal value using lower case letters (not upper case
+//! letters as would typically be used)
+//! - \%p to print a pointer as a hexadecimal value
+//! - \%f to print a double, if the module is built with \b UART_PRINTF_FLOAT
+//! - \%\% to print out a \% character
+//!
+//! For \%s, \%d, \%i, \%u, \%p, \%x, \%X and \%f, an optional number may
+//! reside between the \% and the format character, which specifies the minimum
+//! number of characters to use for that value; if preceded by a 0 then the
+//! extra characters will be filled with zeros instead of spaces.  For example,
+//! ``\%8d'' will use eight characters to print the decimal value with spaces
+//! added to reach eight; ``\%08d'' will use eight characters as well but will
+//! add zeroes instead of spaces.  \%f takes a precision too, ``\%.3f''
+//! printing three digits after the point; the default is six and the most
+//! nine, and values of 2^32 and over print as ERROR.  Numbers are padded to at
+//! most 16 characters; one with a wider field is printed without padding.
+//!
+//! The type of the arguments after \e pcString must match the requirements of
+//! the format string.  For example, if an integer was passed where a string
+//! was expected, an error of some kind will most likely occur.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTprintf(const char *pcString, ...)
+{
+    va_list vaArgP;
+
+    //
+    // Start the varargs processing.
+    //
+    va_start(vaArgP, pcString);
+
+    UARTvprintf(pcString, vaArgP);
+
+    //
+    // We're finished with the varargs now.
+    //
+    va_end(vaArgP);
+}
+
+//*****************************************************************************
+//
+// Puts a deferred log record into the transmit buffer, or drops it if it does
+// not fit, and pends the UART interrupt to send it (see uartlog.h).  The
+// record is in the byte order of the processor, which is little-endian.
+//
+//*****************************************************************************
+#ifdef UART_LOG_DEFERRED
+static void
+UARTLogPut(const uint32_t *pui32Record, uint32_t ui32Words)
+{
+    const uint8_t *pui8Record = (const uint8_t *)pui32Record;
+    uint32_t ui32Write, ui32Size, ui32Idx;
+
+    ui32Write = UARTRingWriteBegin(&g_sUARTTxRing, &g_sUARTEcho);
+    ui32Size = ui32Words * 4;
+
+    if((UART_TX_BUFFER_SIZE -
+        (ui32Write - RingLoadAcquire(&g_sUARTTxRing.ui32Read))) >= ui32Size)
+    {
+        for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+        {
+            g_pcUARTTxBuffer[ui32Write++ & TX_BUFFER_MASK] =
+                pui8Record[ui32Idx];
+        }
+
+#ifdef UART_TELEMETRY
+        g_bUARTTelemetryZero = true;
+#endif
+    }
+
+    UARTRingWriteEnd(&g_sUARTTxRing, &g_sUARTEcho,
+                     g_ui32UARTInt[g_ui32PortNum], ui32Write);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Logs a format string and its arguments without formatting them.
+//!
+//! \param pcFormat is the format string, in the .uartlog section.
+//! \param ui32Arg0 to \e ui32Arg2 are the arguments.
+//!
+//! These functions, available only when the module is built with
+//! \b UART_LOG_DEFERRED, are called by the UARTlog() macro of uartlog.h,
+//! which picks the one for the number of arguments and places the format
+//! string.  Like UARTwrite(), they must not be called from more than one
+//! context at a time.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_LOG_DEFERRED) || defined(DOXYGEN)
+void
+UARTLogWrite0(const char *pcFormat)
+{
+    uint32_t ui32Record;
+
+    ui32Record = UART_LOG_MARK | ((uint32_t)(uintptr_t)pcFormat << 8);
+    UARTLogPut(&ui32Record, 1);
+}
+
+void
+UARTLogWrite1(const char *pcFormat, uint32_t ui32Arg0)
+{
+    uint32_t pui32Record[2];
+
+    pui32Record[0] = UART_LOG_MARK | 1 | ((uint32_t)(uintptr_t)pcFormat << 8);
+    pui32Record[1] = ui32Arg0;
+    UARTLogPut(pui32Record, 2);
+}
+
+void
+UARTLogWrite2(const char *pcFormat, uint32_t ui32Arg0, uint32_t ui32Arg1)
+{
+    uint32_t pui32Record[3];
+
+    pui32Record[0] = UART_LOG_MARK | 2 | ((uint32_t)(uintptr_t)pcFormat << 8);
+    pui32Record[1] = ui32Arg0;
+    pui32Record[2] = ui32Arg1;
+    UARTLogPut(pui32Record, 3);
+}
+
+void
+UARTLogWrite3(const char *pcFormat, uint32_t ui32Arg0, uint32_t ui32Arg1,
+              uint32_t ui32Arg2)
+{
+    uint32_t pui32Record[4];
+
+    pui32Record[0] = UART_LOG_MARK | 3 | ((uint32_t)(uintptr_t)pcFormat << 8);
+    pui32Record[1] = ui32Arg0;
+    pui32Record[2] = ui32Arg1;
+    pui32Record[3] = ui32Arg2;
+    UARTLogPut(pui32Record, 4);
+}
+#endif
+
+//*****************************************************************************
+//
+// The CRC-16/CCITT-FALSE of telemetry frames, polynomial 0x1021 and starting
+// from 0xFFFF, taken a byte at a time with this table of the CRC of each
+// byte value.
+//
+//*****************************************************************************
+#ifdef UART_TELEMETRY
+static const uint16_t g_pui16UARTTelemetryCRC[256] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+#endif
+
+//*****************************************************************************
+//
+// Add a byte to the CRC of a telemetry frame.
+//
+//*****************************************************************************
+#ifdef UART_TELEMETRY
+static inline uint16_t
+UARTTelemetryCRC(uint16_t ui16CRC, uint8_t ui8Byte)
+{
+    return((uint16_t)(ui16CRC << 8) ^
+           g_pui16UARTTelemetryCRC[(ui16CRC >> 8) ^ ui8Byte]);
+}
+#endif
+
+//*****************************************************************************
+//
+// COBS encode a byte of a telemetry frame into a transmit buffer.  A zero is
+// not written; instead the code byte at *pui32Code, which the frame or the
+// last zero left room for, is set to the distance to it, and room is left
+// for the next code byte in its place.
+//
+//*****************************************************************************
+#ifdef UART_TELEMETRY
+static inline void
+UARTTelemetryPut(unsigned char *pcRing, uint32_t ui32Size, uint32_t *pui32Code,
+                 uint32_t *pui32Write, uint8_t ui8Byte)
+{
+    if(ui8Byte == 0)
+    {
+        pcRing[*pui32Code & (ui32Size - 1)] =
+            (unsigned char)(*pui32Write - *pui32Code);
+        *pui32Code = (*pui32Write)++;
+    }
+    else
+    {
+        pcRing[(*pui32Write)++ & (ui32Size - 1)] = ui8Byte;
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Encode a telemetry frame into a transmit buffer, or drop it if it does not
+// fit, and pend the UART interrupt to send it.  See UARTTelemetrySend().  The
+// frame before encoding is at most 254 bytes, so it never needs more than one
+// block of 254 bytes without a zero, whose code byte is 255, and the encoding
+// is always one byte longer.  The frame starts with a zero if it is the first
+// of its sequence or if *pbZero, which is then cleared, pbZero being 0 for a
+// transmit buffer that gets no deferred log records.
+//
+//*****************************************************************************
+#ifdef UART_TELEMETRY
+static inline bool
+UARTRingTelemetry(tUARTRing *psRing, unsigned char *pcRing, uint32_t ui32Size,
+                  tUARTEcho *psEcho, uint32_t ui32Int, uint16_t *pui16Seq,
+                  bool *pbZero, uint8_t ui8Channel, const uint8_t *pui8Data,
+                  uint32_t ui32Len)
+{
+    uint32_t ui32Write, ui32Code, ui32Frame, ui32Idx;
+    uint16_t ui16Seq, ui16CRC;
+    bool bZero;
+
+    //
+    // The sequence number is taken whether or not the frame is sent, so that
+    // the host can tell it was dropped.
+    //
+    ui16Seq = (*pui16Seq)++;
+
+    if(ui32Len > UART_TELEMETRY_DATA_MAX)
+    {
+        return(false);
+    }
+
+    bZero = !ui16Seq || (pbZero && *pbZero);
+    ui32Frame = UART_TELEMETRY_FRAME_SIZE(ui32Len) + (bZero ? 1 : 0);
+    ui32Write = UARTRingWriteBegin(psRing, psEcho);
+
+    if((ui32Size - (ui32Write - RingLoadAcquire(&psRing->ui32Read))) <
+       ui32Frame)
+    {
+        UARTRingWriteEnd(psRing, psEcho, ui32Int, ui32Write);
+        return(false);
+    }
+
+    if(bZero)
+    {
+        pcRing[ui32Write++ & (ui32Size - 1)] = 0;
+
+        if(pbZero)
+        {
+            *pbZero = false;
+        }
+    }
+
+    //
+    // Leave room for the first code byte, then encode the header and the
+    // data, adding them to the CRC as they go.
+    //
+    ui32Code = ui32Write++;
+
+    ui16CRC = UARTTelemetryCRC(0xFFFF, (uint8_t)ui16Seq);
+    UARTTelemetryPut(pcRing, ui32Size, &ui32Code, &ui32Write,
+                     (uint8_t)ui16Seq);
+    ui16CRC = UARTTelemetryCRC(ui16CRC, (uint8_t)(ui16Seq >> 8));
+    UARTTelemetryPut(pcRing, ui32Size, &ui32Code, &ui32Write,
+                     (uint8_t)(ui16Seq >> 8));
+    ui16CRC = UARTTelemetryCRC(ui16CRC, ui8Channel);
+    UARTTelemetryPut(pcRing, ui32Size, &ui32Code, &ui32Write, ui8Channel);
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        ui16CRC = UARTTelemetryCRC(ui16CRC, pui8Data[ui32Idx]);
+        UARTTelemetryPut(pcRing, ui32Size, &ui32Code, &ui32Write,
+                         pui8Data[ui32Idx]);
+    }
+
+    UARTTelemetryPut(pcRing, ui32Size, &ui32Code, &ui32Write,
+                     (uint8_t)(ui16CRC >> 8));
+    UARTTelemetryPut(pcRing, ui32Size, &ui32Code, &ui32Write,
+                     (uint8_t)ui16CRC);
+
+    //
+    // Close the last block and end the frame.
+    //
+    pcRing[ui32Code & (ui32Size - 1)] = (unsigned char)(ui32Write - ui32Code);
+    pcRing[ui32Write++ & (ui32Size - 1)] = 0;
+
+    UARTRingWriteEnd(psRing, psEcho, ui32Int, ui32Write);
+
+    return(true);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Sends a block of binary data as a telemetry frame on the console.
+//!
+//! \param ui8Channel is the channel of the frame, telling the host what the
+//! data is.
+//! \param pvData points to the data.
+//! \param ui32Len is the number of bytes of data, up to
+//! \b UART_TELEMETRY_DATA_MAX.
+//!
+//! This function, available only when the module is built with
+//! \b UART_TELEMETRY, puts the data into the transmit buffer as a frame (see
+//! uarttelemetry.h) and returns at once.  The frame takes
+//! UART_TELEMETRY_FRAME_SIZE() bytes of the buffer, and is dropped if
+//! UARTTxBytesFree() is less.  Like UARTwrite(), this function must not be
+//! called from more than one context at a time.
+//!
+//! \return Returns \b true if the frame was sent, or \b false if it was
+//! dropped.
+//
+//*****************************************************************************
+#if defined(UART_TELEMETRY) || defined(DOXYGEN)
+bool
+UARTTelemetrySend(uint8_t ui8Channel, const void *pvData, uint32_t ui32Len)
+{
+    //
+    // Check for valid arguments.
+    //
+    ASSERT((pvData != 0) || (ui32Len == 0));
+    ASSERT(ui32Len <= UART_TELEMETRY_DATA_MAX);
+    ASSERT(g_ui32Base != 0);
+
+    return(UARTRingTelemetry(&g_sUARTTxRing, g_pcUARTTxBuffer,
+                             UART_TX_BUFFER_SIZE, &g_sUARTEcho,
+                             g_ui32UARTInt[g_ui32PortNum],
+                             &g_ui16UARTTelemetrySeq,
+#ifdef UART_LOG_DEFERRED
+                             &g_bUARTTelemetryZero,
+#else
+                             0,
+#endif
+                             ui8Channel, pvData, ui32Len));
+}
+#endif
+
+//*****************************************************************************
+//
+//! Returns the number of bytes available in the receive buffer.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, may be used to determine the number
+//! of bytes of data currently available in the receive buffer.
+//!
+//! \return Returns the number of available bytes.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+int
+UARTRxBytesAvail(void)
+{
+    return(RX_BUFFER_USED);
+}
+#endif
+
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+//*****************************************************************************
+//
+//! Returns the number of bytes free in the transmit buffer.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, may be used to determine the amount
+//! of space currently available in the transmit buffer.
+//!
+//! \return Returns the number of free bytes.
+//
+//*****************************************************************************
+int
+UARTTxBytesFree(void)
+{
+    return(TX_BUFFER_FREE);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Looks ahead in the receive buffer for a particular character.
+//!
+//! \param ucChar is the character that is to be searched for.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, may be used to look ahead in the
+//! receive buffer for a particular character and report its position if found.
+//! It is typically used to determine whether a complete line of user input is
+//! available, in which case ucChar should be set to CR ('\\r') which is used
+//! as the line end marker in the receive buffer.
+//!
+//! \return Returns -1 to indicate that the requested character does not exist
+//! in the receive buffer.  Returns a non-negative number if the character was
+//! found in which case the value represents the position of the first instance
+//! of \e ucChar relative to the receive buffer read pointer.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+int
+UARTPeek(unsigned char ucChar)
+{
+    return(UARTRingPeek(&g_sUARTRxRing, g_pcUARTRxBuffer, UART_RX_BUFFER_SIZE,
+                        ucChar));
+}
+#endif
+
+//*****************************************************************************
+//
+//! Flushes the receive buffer.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, may be used to discard any data
+//! received from the UART but not yet read using UARTgets().  Like the other
+//! functions reading the receive buffer, it must not be called from more than
+//! one context at a time.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTFlushRx(void)
+{
+    //
+    // Flush the receive buffer by reading everything written to it so far.
+    // Only the read index changes, so the interrupt handler can go on
+    // writing meanwhile.
+    //
+    RingStoreRelease(&g_sUARTRxRing.ui32Read,
+                     RingLoadAcquire(&g_sUARTRxRing.ui32Write));
+
+#ifdef UART_RX_LINES
+    //
+    // So are the lines.  Any line ended after the read index was taken is
+    // skipped by UARTLineGet() if it is already behind it.
+    //
+    RingStoreRelease(&g_sUARTRxLines.ui32Read,
+                     RingLoadAcquire(&g_sUARTRxLines.ui32Write));
+#endif
+}
+#endif
+
+//*****************************************************************************
+//
+//! Gets the oldest complete line of input without copying it.
+//!
+//! \param psLine points to the description of the line to fill in.
+//!
+//! This function, available only when the module is built with
+//! \b UART_RX_LINES, which frames the input into lines as it is received,
+//! describes the oldest line received and not yet released where it lies in
+//! the receive buffer, without its terminator: \e ui32Len characters, from
+//! \e ppcPart[0] for \e pui32PartLen[0] characters and on from
+//! \e ppcPart[1] for \e pui32PartLen[1] if the line wraps around the end of
+//! the buffer.  The line is not null terminated.  It stays in the buffer,
+//! and this function keeps returning it, until UARTLineRelease() is called.
+//! It does not block, and takes the same time however long the line.
+//!
+//! A line ends with a CR, an LF or an ESC, whether echo is enabled or not,
+//! and a CRLF pair ends a single line.  A line that does not fit in the
+//! receive buffer, or ends while UART_RX_LINES lines are waiting to be
+//! released, is thrown away whole.  Since lines are only counted as
+//! UARTLineGet() reads them, input framed into lines should not be read with
+//! UARTgets() or UARTgetc().
+//!
+//! \return Returns \b true if there is a complete line, or \b false if not.
+//
+//*****************************************************************************
+#if defined(UART_RX_LINES) || defined(DOXYGEN)
+bool
+UARTLineGet(tUARTLine *psLine)
+{
+    ASSERT(psLine != 0);
+
+    return(UARTRingLineGet(&g_sUARTRxRing, &g_sUARTRxLines, g_pcUARTRxBuffer,
+                           UART_RX_BUFFER_SIZE, psLine));
+}
+#endif
+
+//*****************************************************************************
+//
+//! Releases a line got with UARTLineGet().
+//!
+//! \param psLine points to the description of the line.
+//!
+//! This function, available only when the module is built with
+//! \b UART_RX_LINES, hands the space of the line and its terminator back to
+//! the receive buffer.  The characters of the line must not be used after.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_RX_LINES) || defined(DOXYGEN)
+void
+UARTLineRelease(const tUARTLine *psLine)
+{
+    ASSERT(psLine != 0);
+
+    UARTRingLineRelease(&g_sUARTRxRing, &g_sUARTRxLines, psLine);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Flushes the transmit buffer.
+//!
+//! \param bDiscard indicates whether any remaining data in the buffer should
+//! be discarded (\b true) or transmitted (\b false).
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, may be used to flush the transmit
+//! buffer, either discarding or transmitting any data received via calls to
+//! UARTprintf() that is waiting to be transmitted.  On return, the transmit
+//! buffer will be empty.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTFlushTx(bool bDiscard)
+{
+    uint32_t ui32Int;
+
+    //
+    // Should the remaining data be discarded or transmitted?
+    //
+    if(bDiscard)
+    {
+        //
+        // The remaining data should be discarded, so temporarily turn off
+        // interrupts.
+        //
+        ui32Int = MAP_IntMasterDisable();
+
+#ifdef UART_BUFFERED_DMA
+        //
+        // Stop the uDMA sending what is left of its span.
+        //
+        MAP_uDMAChannelDisable(g_ui32UARTTxChannel);
+        g_ui32UARTTxDMASpan = 0;
+#endif
+
+        //
+        // Flush the transmit buffer, and the echo waiting to go into it.
+        //
+        g_sUARTTxRing.ui32Read = 0;
+        g_sUARTTxRing.ui32Write = 0;
+        g_sUARTEcho.ui32Count = 0;
+
+        //
+        // If interrupts were enabled when we turned them off, turn them
+        // back on again.
+        //
+        if(!ui32Int)
+        {
+            MAP_IntMasterEnable();
+        }
+    }
+    else
+    {
+        //
+        // Wait for all remaining data to be transmitted before returning.
+        //
+        while(!TX_BUFFER_EMPTY)
+        {
+        }
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+//! Enables or disables echoing of received characters to the transmitter.
+//!
+//! \param bEnable must be set to \b true to enable echo or \b false to
+//! disable it.
+//!
+//! This function, available only when the module is built to operate in
+//! buffered mode using \b UART_BUFFERED, may be used to control whether or not
+//! received characters are automatically echoed back to the transmitter.  By
+//! default, echo is enabled and this is typically the desired behavior if
+//! the module is being used to support a serial command line.  In applications
+//! where this module is being used to provide a convenient, buffered serial
+//! interface over which application-specific binary protocols are being run,
+//! however, echo may be undesirable and this function can be used to disable
+//! it.
+//!
+//! Echo goes through the transmit buffer, behind the output written before
+//! the characters were received, and is held back while the transmit buffer
+//! is full.  Up to 16 bytes of it, or \b UART_ECHO_BUFFER_SIZE, can wait;
+//! echo beyond that is dropped.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTEchoSet(bool bEnable)
+{
+    g_bDisableEcho = !bEnable;
+}
+#endif
+
+//*****************************************************************************
+//
+//! Handles UART interrupts.
+//!
+//! This function handles interrupts from the UART.  It will copy data from the
+//! transmit buffer to the UART transmit FIFO if space is available, and it
+//! will copy data from the UART receive FIFO to the receive buffer if data is
+//! available.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if defined(UART_BUFFERED) || defined(DOXYGEN)
+void
+UARTStdioIntHandler(void)
+{
+    uint32_t ui32Ints;
+    static bool bLastWasCR = false;
 
-                    //
-                    // Set the base to 16.
-                    //
-                    ui32Base = 16;
+    //
+    // Get and clear the current interrupt source(s)
+    //
+    ui32Ints = MAP_UARTIntStatus(g_ui32Base, true);
+    MAP_UARTIntClear(g_ui32Base, ui32Ints);
 
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ui32Neg = 0;
+    //
+    // Are we being interrupted due to a received character?
+    //
+    if(ui32Ints & (UART_INT_RX | UART_INT_RT))
+    {
+        UARTRingReceive(g_ui32Base, &g_sUARTRxRing, g_pcUARTRxBuffer,
+                        UART_RX_BUFFER_SIZE, g_bDisableEcho, &bLastWasCR,
+                        &g_sUARTEcho, &g_sUARTTxRing, g_pcUARTTxBuffer,
+                        UART_TX_BUFFER_SIZE, UART_RX_LINES_CONSOLE);
+    }
 
-                    //
-                    // Determine the number of digits in the string version of
-                    // the value.
-                    //
-convert:
-                    for(ui32Idx = 1;
-                        (((ui32Idx * ui32Base) <= ui32Value) &&
-                         (((ui32Idx * ui32Base) / ui32Base) == ui32Idx));
-                        ui32Idx *= ui32Base, ui32Count--)
-                    {
-                    }
+    //
+    // Queue any echo left waiting by a write, then move what we can of the
+    // transmit buffer on to the UART.  We get here because the FIFO has
+    // space, because a uDMA transfer is done, which has no status bit in the
+    // UART, or because a write pended the interrupt after putting new data in
+    // the buffer, so look at every interrupt.
+    //
+    UARTEchoQueue(&g_sUARTEcho, &g_sUARTTxRing, g_pcUARTTxBuffer,
+                  UART_TX_BUFFER_SIZE);
+#ifdef UART_BUFFERED_DMA
+    UARTPrimeTransmit(g_ui32Base);
+#else
+    UARTRingTransmit(g_ui32Base, &g_sUARTTxRing, g_pcUARTTxBuffer,
+                     UART_TX_BUFFER_SIZE);
+#endif
+}
+#endif
 
-                    //
-                    // If the value is negative, reduce the count of padding
-                    // characters needed.
-                    //
-                    if(ui32Neg)
-                    {
-                        ui32Count--;
-                    }
+//*****************************************************************************
+//
+//! Opens a UART as a port of the handle based interface.
+//!
+//! \param ui32PortNum is the number of the UART (0-2), which must be in
+//! \b UART_STDIO_PORTS and not be the console.
+//! \param ui32Baud is the bit rate that the UART is to be configured to use.
+//! \param ui32SrcClock is the frequency of the source clock for the UART
+//! module.
+//!
+//! This function, available only when the module is built with
+//! \b UART_STDIO_PORTS, configures the UART for 8 bit, no parity and 1 stop
+//! bit at \e ui32Baud, empties the buffers of the port and enables its
+//! interrupts.  The UARTPortnIntHandler() of the UART must be in the vector
+//! table.  Like UARTStdioConfig(), it assumes that the caller has configured
+//! the pins of the UART.
+//!
+//! \return Returns the handle of the port, or 0 if the UART is not present.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
+tUARTPort *
+UARTPortOpen(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
+{
+    tUARTPort *psPort;
 
-                    //
-                    // If the value is negative and the value is padded with
-                    // zeros, then place the minus sign before the padding.
-                    //
-                    if(ui32Neg && (cFill == '0'))
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        pcBuf[ui32Pos++] = '-';
+    //
+    // Check the arguments.
+    //
+    ASSERT((ui32PortNum == 0) || (ui32PortNum == 1) ||
+           (ui32PortNum == 2));
+    ASSERT(UART_STDIO_PORTS & (1 << ui32PortNum));
+    ASSERT(g_ui32Base != g_ui32UARTBase[ui32PortNum]);
 
-                        //
-                        // The minus sign has been placed, so turn off the
-                        // negative flag.
-                        //
-                        ui32Neg = 0;
-                    }
+    psPort = &g_psUARTPorts[ui32PortNum];
 
-                    //
-                    // Provide additional padding at the beginning of the
-                    // string conversion if needed.
-                    //
-                    if((ui32Count > 1) && (ui32Count < 16))
-                    {
-                        for(ui32Count--; ui32Count; ui32Count--)
-                        {
-                            pcBuf[ui32Pos++] = cFill;
-                        }
-                    }
+    //
+    // A port may only be opened once.
+    //
+    ASSERT(psPort->ui32Base == 0);
 
-                    //
-                    // If the value is negative, then place the minus sign
-                    // before the number.
-                    //
-                    if(ui32Neg)
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        pcBuf[ui32Pos++] = '-';
-                    }
+    //
+    // Check to make sure the UART peripheral is present.
+    //
+    if(!MAP_SysCtlPeripheralPresent(g_ui32UARTPeriph[ui32PortNum]))
+    {
+        return(0);
+    }
 
-                    //
-                    // Convert the value into a string.
-                    //
-                    for(; ui32Idx; ui32Idx /= ui32Base)
-                    {
-                        pcBuf[ui32Pos++] =
-                            g_pcHex[(ui32Value / ui32Idx) % ui32Base];
-                    }
+    //
+    // Enable the UART and configure it for n, 8, 1, with the same FIFO
+    // levels as the console.
+    //
+    MAP_SysCtlPeripheralEnable(g_ui32UARTPeriph[ui32PortNum]);
+    MAP_UARTConfigSetExpClk(g_ui32UARTBase[ui32PortNum], ui32SrcClock,
+                            ui32Baud, (UART_CONFIG_PAR_NONE |
+                                       UART_CONFIG_STOP_ONE |
+                                       UART_CONFIG_WLEN_8));
+    MAP_UARTFIFOLevelSet(g_ui32UARTBase[ui32PortNum], UART_FIFO_TX1_8,
+                         UART_FIFO_RX1_8);
+
+    //
+    // Start with empty buffers and echo enabled.
+    //
+    psPort->sTxRing.ui32Write = 0;
+    psPort->sTxRing.ui32Read = 0;
+    psPort->sRxRing.ui32Write = 0;
+    psPort->sRxRing.ui32Read = 0;
+    psPort->bDisableEcho = false;
+    psPort->bLastWasCR = false;
+    psPort->sEcho.bWriting = false;
+    psPort->sEcho.ui32Count = 0;
+#ifdef UART_RX_LINES
+    psPort->sRxLines.ui32Write = 0;
+    psPort->sRxLines.ui32Read = 0;
+    psPort->sRxLines.ui32Start = 0;
+    psPort->sRxLines.bOverflow = false;
+#endif
+#ifdef UART_TELEMETRY
+    psPort->ui16TelemetrySeq = 0;
+#endif
+    psPort->ui32Base = g_ui32UARTBase[ui32PortNum];
+    psPort->ui32Int = g_ui32UARTInt[ui32PortNum];
 
-                    //
-                    // Write the string.
-                    //
-                    UARTwrite(pcBuf, ui32Pos);
+    //
+    // Enable the receive interrupts; the transmit interrupt is enabled only
+    // while there is something to send.
+    //
+    MAP_UARTIntDisable(psPort->ui32Base, 0xFFFFFFFF);
+    MAP_UARTIntEnable(psPort->ui32Base, UART_INT_RX | UART_INT_RT);
+    MAP_IntEnable(psPort->ui32Int);
+    MAP_UARTEnable(psPort->ui32Base);
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    return(psPort);
+}
+#endif
 
-                //
-                // Handle the %% command.
-                //
-                case '%':
-                {
-                    //
-                    // Simply write a single %.
-                    //
-                    UARTwrite(pcString - 1, 1);
+//*****************************************************************************
+//
+//! Writes a string of characters to a port.
+//!
+//! \param psPort is the handle of the port.
+//! \param pcBuf points to a buffer containing the string to transmit.
+//! \param ui32Len is the length of the string to transmit.
+//!
+//! This function is UARTwrite() for a port opened with UARTPortOpen().  The
+//! transmit buffer of each port has a single writer, so this function and
+//! UARTPortPrintf() must not be called for the same port from more than one
+//! context at a time; different ports may be written from different contexts.
+//!
+//! \return Returns the count of characters written.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
+int
+UARTPortWrite(tUARTPort *psPort, const char *pcBuf, uint32_t ui32Len)
+{
+    //
+    // Check for valid arguments.
+    //
+    ASSERT(psPort != 0);
+    ASSERT(psPort->ui32Base != 0);
+    ASSERT(pcBuf != 0);
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+    return(UARTRingWrite(&psPort->sTxRing, psPort->pcTxBuffer,
+                         psPort->ui32TxSize, &psPort->sEcho, psPort->ui32Int,
+                         pcBuf, ui32Len));
+}
+#endif
 
-                //
-                // Handle all other commands.
-                //
-                default:
-                {
-                    //
-                    // Indicate an error.
-                    //
-                    UARTwrite("ERROR", 5);
+//*****************************************************************************
+//
+//! A simple UART based vprintf function writing to a port.
+//!
+//! \param psPort is the handle of the port.
+//! \param pcString is the format string.
+//! \param vaArgP is a variable argument list pointer whose content will depend
+//! upon the format string passed in \e pcString.
+//!
+//! This function is UARTvprintf() for a port opened with UARTPortOpen().
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
+void
+UARTPortVprintf(tUARTPort *psPort, const char *pcString, va_list vaArgP)
+{
+    ASSERT(psPort != 0);
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
-            }
-        }
-    }
+    UARTStdioVprintf(psPort, pcString, vaArgP);
 }
+#endif
 
 //*****************************************************************************
 //
-//! A simple UART based printf function supporting \%c, \%d, \%p, \%s, \%u,
-//! \%x, and \%X.
+//! A simple UART based printf function writing to a port.
 //!
+//! \param psPort is the handle of the port.
 //! \param pcString is the format string.
 //! \param ... are the optional arguments, which depend on the contents of the
 //! format string.
 //!
-//! This function is very similar to the C library <tt>fprintf()</tt> function.
-//! All of its output will be sent to the UART.  Only the following formatting
-//! characters are supported:
-//!
-//! - \%c to print a character
-//! - \%d or \%i to print a decimal value
-//! - \%s to print a string
-//! - \%u to print an unsigned decimal value
-//! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
-//! - \%p to print a pointer as a hexadecimal value
-//! - \%\% to print out a \% character
-//!
-//! For \%s, \%d, \%i, \%u, \%p, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeroes instead of spaces.
-//!
-//! The type of the arguments after \e pcString must match the requirements of
-//! the format string.  For example, if an integer was passed where a string
-//! was expected, an error of some kind will most likely occur.
+//! This function is UARTprintf() for a port opened with UARTPortOpen().
 //!
 //! \return None.
 //
 //*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
 void
-UARTprintf(const char *pcString, ...)
+UARTPortPrintf(tUARTPort *psPort, const char *pcString, ...)
 {
     va_list vaArgP;
 
-    //
-    // Start the varargs processing.
-    //
-    va_start(vaArgP, pcString);
+    ASSERT(psPort != 0);
 
-    UARTvprintf(pcString, vaArgP);
+    va_start(vaArgP, pcString);
+    UARTStdioVprintf(psPort, pcString, vaArgP);
+    va_end(vaArgP);
+}
+#endif
 
+//*****************************************************************************
+//
+//! Reads a line from a port.
+//!
+//! \param psPort is the handle of the port.
+//! \param pcBuf points to a buffer for the incoming string.
+//! \param ui32Len is the length of the buffer for storage of the string,
+//! including the trailing 0.
+//!
+//! This function is UARTgets() for a port opened with UARTPortOpen(), and
+//! blocks until a termination character is received.
+//!
+//! \return Returns the count of characters that were stored, not including
+//! the trailing 0.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
+int
+UARTPortGets(tUARTPort *psPort, char *pcBuf, uint32_t ui32Len)
+{
     //
-    // We're finished with the varargs now.
+    // Check the arguments.
     //
-    va_end(vaArgP);
+    ASSERT(psPort != 0);
+    ASSERT(psPort->ui32Base != 0);
+    ASSERT(pcBuf != 0);
+    ASSERT(ui32Len != 0);
+
+    return(UARTRingGets(&psPort->sRxRing, psPort->pcRxBuffer,
+                        psPort->ui32RxSize, pcBuf, ui32Len));
 }
+#endif
 
 //*****************************************************************************
 //
-//! Returns the number of bytes available in the receive buffer.
+//! Reads a single character from a port, blocking if necessary.
 //!
-//! This function, available only when the module is built to operate in
-//! buffered mode using \b UART_BUFFERED, may be used to determine the number
-//! of bytes of data currently available in the receive buffer.
+//! \param psPort is the handle of the port.
+//!
+//! This function is UARTgetc() for a port opened with UARTPortOpen().
+//!
+//! \return Returns the character read.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
+unsigned char
+UARTPortGetc(tUARTPort *psPort)
+{
+    ASSERT(psPort != 0);
+
+    return(UARTRingGetc(&psPort->sRxRing, psPort->pcRxBuffer,
+                        psPort->ui32RxSize));
+}
+#endif
+
+//*****************************************************************************
+//
+//! Looks ahead in the receive buffer of a port for a particular character.
+//!
+//! \param psPort is the handle of the port.
+//! \param ucChar is the character that is to be searched for.
+//!
+//! This function is UARTPeek() for a port opened with UARTPortOpen().
+//!
+//! \return Returns -1 if the character is not in the receive buffer, or its
+//! position relative to the read pointer otherwise.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
+int
+UARTPortPeek(tUARTPort *psPort, unsigned char ucChar)
+{
+    ASSERT(psPort != 0);
+
+    return(UARTRingPeek(&psPort->sRxRing, psPort->pcRxBuffer,
+                        psPort->ui32RxSize, ucChar));
+}
+#endif
+
+//*****************************************************************************
+//
+//! Returns the number of bytes available in the receive buffer of a port.
+//!
+//! \param psPort is the handle of the port.
 //!
 //! \return Returns the number of available bytes.
 //
 //*****************************************************************************
-#if defined(UART_BUFFERED) || defined(DOXYGEN)
+#if UART_STDIO_PORTS || defined(DOXYGEN)
 int
-UARTRxBytesAvail(void)
+UARTPortRxBytesAvail(tUARTPort *psPort)
 {
-    return(RX_BUFFER_USED);
+    ASSERT(psPort != 0);
+
+    return(GetBufferCount(&psPort->sRxRing));
 }
 #endif
 
-#if defined(UART_BUFFERED) || defined(DOXYGEN)
 //*****************************************************************************
 //
-//! Returns the number of bytes free in the transmit buffer.
+//! Returns the number of bytes free in the transmit buffer of a port.
 //!
-//! This function, available only when the module is built to operate in
-//! buffered mode using \b UART_BUFFERED, may be used to determine the amount
-//! of space currently available in the transmit buffer.
+//! \param psPort is the handle of the port.
 //!
 //! \return Returns the number of free bytes.
 //
 //*****************************************************************************
+#if UART_STDIO_PORTS || defined(DOXYGEN)
 int
-UARTTxBytesFree(void)
+UARTPortTxBytesFree(tUARTPort *psPort)
 {
-    return(TX_BUFFER_FREE);
+    ASSERT(psPort != 0);
+
+    return(psPort->ui32TxSize - GetBufferCount(&psPort->sTxRing));
 }
 #endif
 
 //*****************************************************************************
 //
-//! Looks ahead in the receive buffer for a particular character.
+//! Flushes the receive buffer of a port.
 //!
-//! \param ucChar is the character that is to be searched for.
+//! \param psPort is the handle of the port.
 //!
-//! This function, available only when the module is built to operate in
-//! buffered mode using \b UART_BUFFERED, may be used to look ahead in the
-//! receive buffer for a particular character and report its position if found.
-//! It is typically used to determine whether a complete line of user input is
-//! available, in which case ucChar should be set to CR ('\\r') which is used
-//! as the line end marker in the receive buffer.
+//! This function is UARTFlushRx() for a port opened with UARTPortOpen().
 //!
-//! \return Returns -1 to indicate that the requested character does not exist
-//! in the receive buffer.  Returns a non-negative number if the character was
-//! found in which case the value represents the position of the first instance
-//! of \e ucChar relative to the receive buffer read pointer.
+//! \return None.
 //
 //*****************************************************************************
-#if defined(UART_BUFFERED) || defined(DOXYGEN)
-int
-UARTPeek(unsigned char ucChar)
+#if UART_STDIO_PORTS || defined(DOXYGEN)
+void
+UARTPortFlushRx(tUARTPort *psPort)
 {
-    int iCount;
-    int iAvail;
-    uint32_t ui32ReadIndex;
+    ASSERT(psPort != 0);
 
-    //
-    // How many characters are there in the receive buffer?
-    //
-    iAvail = (int)RX_BUFFER_USED;
-    ui32ReadIndex = g_ui32UARTRxReadIndex;
+    RingStoreRelease(&psPort->sRxRing.ui32Read,
+                     RingLoadAcquire(&psPort->sRxRing.ui32Write));
 
-    //
-    // Check all the unread characters looking for the one passed.
-    //
-    for(iCount = 0; iCount < iAvail; iCount++)
-    {
-        if(g_pcUARTRxBuffer[ui32ReadIndex] == ucChar)
-        {
-            //
-            // We found it so return the index
-            //
-            return(iCount);
-        }
-        else
-        {
-            //
-            // This one didn't match so move on to the next character.
-            //
-            ADVANCE_RX_BUFFER_INDEX(ui32ReadIndex);
-        }
-    }
+#ifdef UART_RX_LINES
+    RingStoreRelease(&psPort->sRxLines.ui32Read,
+                     RingLoadAcquire(&psPort->sRxLines.ui32Write));
+#endif
+}
+#endif
 
-    //
-    // If we drop out of the loop, we didn't find the character in the receive
-    // buffer.
-    //
-    return(-1);
+//*****************************************************************************
+//
+//! Gets the oldest complete line of input of a port without copying it.
+//!
+//! \param psPort is the handle of the port.
+//! \param psLine points to the description of the line to fill in.
+//!
+//! This function is UARTLineGet() for a port opened with UARTPortOpen().
+//!
+//! \return Returns \b true if there is a complete line, or \b false if not.
+//
+//*****************************************************************************
+#if (UART_STDIO_PORTS && defined(UART_RX_LINES)) || defined(DOXYGEN)
+bool
+UARTPortLineGet(tUARTPort *psPort, tUARTLine *psLine)
+{
+    ASSERT(psPort != 0);
+    ASSERT(psLine != 0);
+
+    return(UARTRingLineGet(&psPort->sRxRing, &psPort->sRxLines,
+                           psPort->pcRxBuffer, psPort->ui32RxSize, psLine));
 }
 #endif
 
 //*****************************************************************************
 //
-//! Flushes the receive buffer.
+//! Releases a line got with UARTPortLineGet().
 //!
-//! This function, available only when the module is built to operate in
-//! buffered mode using \b UART_BUFFERED, may be used to discard any data
-//! received from the UART but not yet read using UARTgets().
+//! \param psPort is the handle of the port.
+//! \param psLine points to the description of the line.
+//!
+//! This function is UARTLineRelease() for a port opened with UARTPortOpen().
 //!
 //! \return None.
 //
 //*****************************************************************************
-#if defined(UART_BUFFERED) || defined(DOXYGEN)
+#if (UART_STDIO_PORTS && defined(UART_RX_LINES)) || defined(DOXYGEN)
 void
-UARTFlushRx(void)
+UARTPortLineRelease(tUARTPort *psPort, const tUARTLine *psLine)
 {
-    uint32_t ui32Int;
-
-    //
-    // Temporarily turn off interrupts.
-    //
-    ui32Int = MAP_IntMasterDisable();
-
-    //
-    // Flush the receive buffer.
-    //
-    g_ui32UARTRxReadIndex = 0;
-    g_ui32UARTRxWriteIndex = 0;
+    ASSERT(psPort != 0);
+    ASSERT(psLine != 0);
 
-    //
-    // If interrupts were enabled when we turned them off, turn them
-    // back on again.
-    //
-    if(!ui32Int)
-    {
-        MAP_IntMasterEnable();
-    }
+    UARTRingLineRelease(&psPort->sRxRing, &psPort->sRxLines, psLine);
 }
 #endif
 
 //*****************************************************************************
 //
-//! Flushes the transmit buffer.
+//! Flushes the transmit buffer of a port.
 //!
+//! \param psPort is the handle of the port.
 //! \param bDiscard indicates whether any remaining data in the buffer should
 //! be discarded (\b true) or transmitted (\b false).
 //!
-//! This function, available only when the module is built to operate in
-//! buffered mode using \b UART_BUFFERED, may be used to flush the transmit
-//! buffer, either discarding or transmitting any data received via calls to
-//! UARTprintf() that is waiting to be transmitted.  On return, the transmit
-//! buffer will be empty.
+//! This function is UARTFlushTx() for a port opened with UARTPortOpen().
 //!
 //! \return None.
 //
 //*****************************************************************************
-#if defined(UART_BUFFERED) || defined(DOXYGEN)
+#if UART_STDIO_PORTS || defined(DOXYGEN)
 void
-UARTFlushTx(bool bDiscard)
+UARTPortFlushTx(tUARTPort *psPort, bool bDiscard)
 {
-    uint32_t ui32Int;
+    ASSERT(psPort != 0);
 
-    //
-    // Should the remaining data be discarded or transmitted?
-    //
     if(bDiscard)
     {
         //
-        // The remaining data should be discarded, so temporarily turn off
-        // interrupts.
-        //
-        ui32Int = MAP_IntMasterDisable();
-
-        //
-        // Flush the transmit buffer.
-        //
-        g_ui32UARTTxReadIndex = 0;
-        g_ui32UARTTxWriteIndex = 0;
-
-        //
-        // If interrupts were enabled when we turned them off, turn them
-        // back on again.
+        // Only the interrupt handler of the port reads its transmit buffer,
+        // so turning off that interrupt is enough to empty it.
         //
-        if(!ui32Int)
-        {
-            MAP_IntMasterEnable();
-        }
+        MAP_IntDisable(psPort->ui32Int);
+        psPort->sTxRing.ui32Read = 0;
+        psPort->sTxRing.ui32Write = 0;
+        psPort->sEcho.ui32Count = 0;
+        MAP_IntEnable(psPort->ui32Int);
     }
     else
     {
-        //
-        // Wait for all remaining data to be transmitted before returning.
-        //
-        while(!TX_BUFFER_EMPTY)
+        while(GetBufferCount(&psPort->sTxRing) != 0)
         {
         }
     }
@@ -1515,208 +3652,129 @@ UARTFlushTx(bool bDiscard)
 
 //*****************************************************************************
 //
-//! Enables or disables echoing of received characters to the transmitter.
+//! Enables or disables echoing of the characters received on a port.
 //!
+//! \param psPort is the handle of the port.
 //! \param bEnable must be set to \b true to enable echo or \b false to
 //! disable it.
 //!
-//! This function, available only when the module is built to operate in
-//! buffered mode using \b UART_BUFFERED, may be used to control whether or not
-//! received characters are automatically echoed back to the transmitter.  By
-//! default, echo is enabled and this is typically the desired behavior if
-//! the module is being used to support a serial command line.  In applications
-//! where this module is being used to provide a convenient, buffered serial
-//! interface over which application-specific binary protocols are being run,
-//! however, echo may be undesirable and this function can be used to disable
-//! it.
+//! This function is UARTEchoSet() for a port opened with UARTPortOpen(); each
+//! port has its own setting.
 //!
 //! \return None.
 //
 //*****************************************************************************
-#if defined(UART_BUFFERED) || defined(DOXYGEN)
+#if UART_STDIO_PORTS || defined(DOXYGEN)
 void
-UARTEchoSet(bool bEnable)
+UARTPortEchoSet(tUARTPort *psPort, bool bEnable)
 {
-    g_bDisableEcho = !bEnable;
+    ASSERT(psPort != 0);
+
+    psPort->bDisableEcho = !bEnable;
 }
 #endif
 
 //*****************************************************************************
 //
-//! Handles UART interrupts.
+//! Sends a block of binary data as a telemetry frame on a port.
 //!
-//! This function handles interrupts from the UART.  It will copy data from the
-//! transmit buffer to the UART transmit FIFO if space is available, and it
-//! will copy data from the UART receive FIFO to the receive buffer if data is
-//! available.
+//! \param psPort is the handle of the port.
+//! \param ui8Channel is the channel of the frame.
+//! \param pvData points to the data.
+//! \param ui32Len is the number of bytes of data, up to
+//! \b UART_TELEMETRY_DATA_MAX.
 //!
-//! \return None.
+//! This function, available only when the module is built with
+//! \b UART_STDIO_PORTS and \b UART_TELEMETRY, is UARTTelemetrySend() for a
+//! port opened with UARTPortOpen().  Each port counts the sequence numbers of
+//! its frames on its own.
+//!
+//! \return Returns \b true if the frame was sent, or \b false if it was
+//! dropped.
 //
 //*****************************************************************************
-#if defined(UART_BUFFERED) || defined(DOXYGEN)
-void
-UARTStdioIntHandler(void)
+#if (UART_STDIO_PORTS && defined(UART_TELEMETRY)) || defined(DOXYGEN)
+bool
+UARTPortTelemetrySend(tUARTPort *psPort, uint8_t ui8Channel,
+                      const void *pvData, uint32_t ui32Len)
 {
-    uint32_t ui32Ints;
-    int8_t cChar;
-    int32_t i32Char;
-    static bool bLastWasCR = false;
-
     //
-    // Get and clear the current interrupt source(s)
+    // Check for valid arguments.
     //
-    ui32Ints = MAP_UARTIntStatus(g_ui32Base, true);
-    MAP_UARTIntClear(g_ui32Base, ui32Ints);
+    ASSERT(psPort != 0);
+    ASSERT(psPort->ui32Base != 0);
+    ASSERT((pvData != 0) || (ui32Len == 0));
+    ASSERT(ui32Len <= UART_TELEMETRY_DATA_MAX);
 
-    //
-    // Are we being interrupted because the TX FIFO has space available?
-    //
-    if(ui32Ints & UART_INT_TX)
-    {
-        //
-        // Move as many bytes as we can into the transmit FIFO.
-        //
-        UARTPrimeTransmit(g_ui32Base);
+    return(UARTRingTelemetry(&psPort->sTxRing, psPort->pcTxBuffer,
+                             psPort->ui32TxSize, &psPort->sEcho,
+                             psPort->ui32Int, &psPort->ui16TelemetrySeq, 0,
+                             ui8Channel, pvData, ui32Len));
+}
+#endif
 
-        //
-        // If the output buffer is empty, turn off the transmit interrupt.
-        //
-        if(TX_BUFFER_EMPTY)
-        {
-            MAP_UARTIntDisable(g_ui32Base, UART_INT_TX);
-        }
-    }
+//*****************************************************************************
+//
+// Handles the interrupts of a port, as UARTStdioIntHandler() does those of the
+// console.
+//
+//*****************************************************************************
+#if UART_STDIO_PORTS
+static inline void
+UARTPortIntHandler(tUARTPort *psPort)
+{
+    uint32_t ui32Ints;
+
+    ui32Ints = MAP_UARTIntStatus(psPort->ui32Base, true);
+    MAP_UARTIntClear(psPort->ui32Base, ui32Ints);
 
-    //
-    // Are we being interrupted due to a received character?
-    //
     if(ui32Ints & (UART_INT_RX | UART_INT_RT))
     {
-        //
-        // Get all the available characters from the UART.
-        //
-        while(MAP_UARTCharsAvail(g_ui32Base))
-        {
-            //
-            // Read a character
-            //
-            i32Char = MAP_UARTCharGetNonBlocking(g_ui32Base);
-            cChar = (unsigned char)(i32Char & 0xFF);
-
-            //
-            // If echo is disabled, we skip the various text filtering
-            // operations that would typically be required when supporting a
-            // command line.
-            //
-            if(!g_bDisableEcho)
-            {
-                //
-                // Handle backspace by erasing the last character in the
-                // buffer.
-                //
-                if(cChar == '\b')
-                {
-                    //
-                    // If there are any characters already in the buffer, then
-                    // delete the last.
-                    //
-                    if(!RX_BUFFER_EMPTY)
-                    {
-                        //
-                        // Rub out the previous character on the users
-                        // terminal.
-                        //
-                        UARTwrite("\b \b", 3);
-
-                        //
-                        // Decrement the number of characters in the buffer.
-                        //
-                        if(g_ui32UARTRxWriteIndex == 0)
-                        {
-                            g_ui32UARTRxWriteIndex = UART_RX_BUFFER_SIZE - 1;
-                        }
-                        else
-                        {
-                            g_ui32UARTRxWriteIndex--;
-                        }
-                    }
-
-                    //
-                    // Skip ahead to read the next character.
-                    //
-                    continue;
-                }
-
-                //
-                // If this character is LF and last was CR, then just gobble up
-                // the character since we already echoed the previous CR and we
-                // don't want to store 2 characters in the buffer if we don't
-                // need to.
-                //
-                if((cChar == '\n') && bLastWasCR)
-                {
-                    bLastWasCR = false;
-                    continue;
-                }
-
-                //
-                // See if a newline or escape character was received.
-                //
-                if((cChar == '\r') || (cChar == '\n') || (cChar == 0x1b))
-                {
-                    //
-                    // If the character is a CR, then it may be followed by an
-                    // LF which should be paired with the CR.  So remember that
-                    // a CR was received.
-                    //
-                    if(cChar == '\r')
-                    {
-                        bLastWasCR = 1;
-                    }
+        UARTRingReceive(psPort->ui32Base, &psPort->sRxRing, psPort->pcRxBuffer,
+                        psPort->ui32RxSize, psPort->bDisableEcho,
+                        &psPort->bLastWasCR, &psPort->sEcho,
+                        &psPort->sTxRing, psPort->pcTxBuffer,
+                        psPort->ui32TxSize, UART_PORT_RX_LINES(psPort));
+    }
 
-                    //
-                    // Regardless of the line termination character received,
-                    // put a CR in the receive buffer as a marker telling
-                    // UARTgets() where the line ends.  We also send an
-                    // additional LF to ensure that the local terminal echo
-                    // receives both CR and LF.
-                    //
-                    cChar = '\r';
-                    UARTwrite("\n", 1);
-                }
-            }
+    UARTEchoQueue(&psPort->sEcho, &psPort->sTxRing, psPort->pcTxBuffer,
+                  psPort->ui32TxSize);
+    UARTRingTransmit(psPort->ui32Base, &psPort->sTxRing, psPort->pcTxBuffer,
+                     psPort->ui32TxSize);
+}
+#endif
 
-            //
-            // If there is space in the receive buffer, put the character
-            // there, otherwise throw it away.
-            //
-            if(!RX_BUFFER_FULL)
-            {
-                //
-                // Store the new character in the receive buffer
-                //
-                g_pcUARTRxBuffer[g_ui32UARTRxWriteIndex] =
-                    (unsigned char)(i32Char & 0xFF);
-                ADVANCE_RX_BUFFER_INDEX(g_ui32UARTRxWriteIndex);
+//*****************************************************************************
+//
+//! Handles the interrupts of the port on UART0, UART1 or UART2.
+//!
+//! These functions, one for each UART in \b UART_STDIO_PORTS, must be placed
+//! in the vector table entries of their UARTs.
+//!
+//! \return None.
+//
+//*****************************************************************************
+#if (UART_STDIO_PORTS & 1) || defined(DOXYGEN)
+void
+UARTPort0IntHandler(void)
+{
+    UARTPortIntHandler(&g_psUARTPorts[0]);
+}
+#endif
 
-                //
-                // If echo is enabled, write the character to the transmit
-                // buffer so that the user gets some immediate feedback.
-                //
-                if(!g_bDisableEcho)
-                {
-                    UARTwrite((const char *)&cChar, 1);
-                }
-            }
-        }
+#if (UART_STDIO_PORTS & 2) || defined(DOXYGEN)
+void
+UARTPort1IntHandler(void)
+{
+    UARTPortIntHandler(&g_psUARTPorts[1]);
+}
+#endif
 
-        //
-        // If we wrote anything to the transmit buffer, make sure it actually
-        // gets transmitted.
-        //
-        UARTPrimeTransmit(g_ui32Base);
-        MAP_UARTIntEnable(g_ui32Base, UART_INT_TX);
-    }
+#if (UART_STDIO_PORTS & 4) || defined(DOXYGEN)
+void
+UARTPort2IntHandler(void)
+{
+    UARTPortIntHandler(&g_psUARTPorts[2]);
 }
 #endif
 
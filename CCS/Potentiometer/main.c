@@ -33,6 +33,10 @@
 
 //#include <utils/ustdlib.h>
 #include <utils/uartstdio.h>
+#include "uartlog.h"
+#ifdef UART_TELEMETRY
+#include "uarttelemetry.h"
+#endif
 
 #include <inc/hw_types.h>
 #include <inc/hw_memmap.h>
@@ -44,6 +48,27 @@
 #include <driverlib/adc.h>
 #include <driverlib/uart.h>
 
+/*
+ * Built with UART_TELEMETRY, on top of UART_BUFFERED, the samples are not
+ * only stored but streamed to the host over the console as telemetry frames
+ * (see uarttelemetry.h), at 1 Mbit/s, the fastest the UART goes on the
+ * 16MHz internal oscillator. Each frame on channel 1 holds
+ * TELEMETRY_SAMPLES samples as 16-bit words, which is 97% of the frame, and
+ * every TELEMETRY_COUNTERS_EVERY of them are followed by a frame on channel
+ * 2 of three 32-bit counters: the samples taken, the frames of samples sent
+ * and the frames dropped. The frames are decoded on the host with
+ * "tm4c-telemetry --u16 1 --u32 2".
+ */
+#ifdef UART_TELEMETRY
+#define CONSOLE_BAUD            1000000
+#define TELEMETRY_SAMPLES       120
+#define TELEMETRY_COUNTERS_EVERY 64
+#define TELEMETRY_CHANNEL_SAMPLES 1
+#define TELEMETRY_CHANNEL_COUNTERS 2
+#else
+#define CONSOLE_BAUD            9600
+#endif
+
 /*
  * Configure the UART and its pins. This must be called before UARTprintf().
  */
@@ -86,11 +111,55 @@ void configureUART(void)
     /*
      * Initialize the UART for console I/O.
      */
-    UARTStdioConfig(0, 9600, 16000000);
+    UARTStdioConfig(0, CONSOLE_BAUD, 16000000);
 }
 
 uint32_t ui32ADC0Value[1];
 
+#ifdef UART_TELEMETRY
+uint16_t pui16Samples[TELEMETRY_SAMPLES];
+uint32_t ui32Samples;
+
+/*
+ * Samples taken, frames of samples sent and frames dropped, whether of
+ * samples or of these counters.
+ */
+uint32_t pui32Counters[3];
+
+/*
+ * Store a sample into the frame being filled, and send the frame once it is
+ * full. The sampling is not held up waiting for the UART: a frame the
+ * transmit buffer has no room for is dropped and counted, and the host sees
+ * it missing from the sequence numbers as well.
+ */
+void sendSample(uint32_t ui32Sample)
+{
+    pui16Samples[ui32Samples++] = (uint16_t)ui32Sample;
+    pui32Counters[0]++;
+
+    if (ui32Samples < TELEMETRY_SAMPLES)
+    {
+        return;
+    }
+
+    ui32Samples = 0;
+
+    if (!UARTTelemetrySend(TELEMETRY_CHANNEL_SAMPLES, pui16Samples,
+                           sizeof(pui16Samples)))
+    {
+        pui32Counters[2]++;
+        return;
+    }
+
+    if ((++pui32Counters[1] % TELEMETRY_COUNTERS_EVERY == 0) &&
+        !UARTTelemetrySend(TELEMETRY_CHANNEL_COUNTERS, pui32Counters,
+                           sizeof(pui32Counters)))
+    {
+        pui32Counters[2]++;
+    }
+}
+#endif
+
 int main(void)
 {
     /*
@@ -103,42 +172,42 @@ int main(void)
      * Initialize the UART.
      */
     configureUART();
-    UARTprintf("---->> Configured clock rate %d.\n", SysCtlClockGet());
+    UARTlog("---->> Configured clock rate %d.\n", SysCtlClockGet());
 
     /*
      * Initialize the ADC0 module.
      */
-    UARTprintf("---->> Initialize the ADC0 module.\n");
+    UARTlog("---->> Initialize the ADC0 module.\n");
     SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
 
     /*
      * Enable the GPIO for the ADC0 module.
      */
-    UARTprintf("---->> Enable the GPIO for the ADC0 module.\n");
+    UARTlog("---->> Enable the GPIO for the ADC0 module.\n");
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
 
     /*
      * Enable AN0 of ADC0 module.
      */
-    UARTprintf("---->> Enable AN0 of ADC0 module.");
+    UARTlog("---->> Enable AN0 of ADC0 module.");
     GPIOPinTypeADC(GPIO_PORTE_BASE, GPIO_PIN_3);
 
     /*
      * ADC0 module, trigger is processor event, sequencer 0.
      */
-    UARTprintf("---->> ADC0 module, trigger is processor event, sequencer 0.\n");
+    UARTlog("---->> ADC0 module, trigger is processor event, sequencer 0.\n");
     ADCSequenceConfigure(ADC0_BASE, 1, ADC_TRIGGER_PROCESSOR, 0);
 
     /*
      * ADC0 module, sequencer 0, for 1 sampling, input form channel 0.
      */
-    UARTprintf("---->> ADC0 module, sequencer 0, for 1 sampling, input form channel 0.\n");
+    UARTlog("---->> ADC0 module, sequencer 0, for 1 sampling, input form channel 0.\n");
     ADCSequenceStepConfigure(ADC0_BASE, 1, 0, ADC_CTL_CH0);
 
     /*
      * Enable the sequence 1 for ADC0.
      */
-    UARTprintf("---->> Enable the sequence 1 for ADC0.\n");
+    UARTlog("---->> Enable the sequence 1 for ADC0.\n");
     ADCSequenceEnable(ADC0_BASE, 1);
 
     while (1)
@@ -156,6 +225,13 @@ int main(void)
         /*
          * Store the converted value for all different sampling.
          */
+#ifdef UART_TELEMETRY
+        if (ADCSequenceDataGet(ADC0_BASE, 1, ui32ADC0Value))
+        {
+            sendSample(ui32ADC0Value[0]);
+        }
+#else
         ADCSequenceDataGet(ADC0_BASE, 1, ui32ADC0Value);
+#endif
     }
 }
@@ -0,0 +1,59 @@
+//*****************************************************************************
+//
+// uartline.h - Line framed input of the uartstdio receive buffer.
+//
+//*****************************************************************************
+
+#ifndef __UARTLINE_H__
+#define __UARTLINE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// Built with UART_BUFFERED and UART_RX_LINES, a power of two, the UART
+// interrupt handler of uartstdio.c frames the input into lines as it receives
+// it, queueing up to UART_RX_LINES complete lines.  UARTLineGet() describes
+// the oldest of them where it lies in the receive buffer, in two parts if it
+// wraps around the end of the buffer, so a command is handled without being
+// copied and in the same time however long it is; UARTLineRelease() then
+// frees its space.  A line is never null terminated, and its terminator is
+// left out of ui32Len.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The line, in one part or, if it wraps, two.  pui32PartLen[1] is zero if
+    // the line is in one part.
+    //
+    const char *ppcPart[2];
+    uint32_t pui32PartLen[2];
+
+    //
+    // The length of the line, pui32PartLen[0] + pui32PartLen[1].
+    //
+    uint32_t ui32Len;
+
+    //
+    // Where the line and its terminator end in the receive buffer, for
+    // UARTLineRelease().
+    //
+    uint32_t ui32End;
+}
+tUARTLine;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern bool UARTLineGet(tUARTLine *psLine);
+extern void UARTLineRelease(const tUARTLine *psLine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,647 @@
+/*
+ * Runs many simulated boards at once on all host cores, each with its own
+ * firmware image, seed and analog input profile, and reports what every
+ * board did.
+ *
+ * A board is a tSimMachine of its own with all its state inside it, so the
+ * boards run in parallel without sharing anything but the read-only ELF
+ * images.  Boards are handed out by the work-stealing pool in pool.h.
+ *
+ * Boards can instead all start from a snapshot of a booted firmware (see
+ * snapshot.h).  Every worker then keeps one machine and restores it from
+ * the snapshot for each of its boards, which copies back only the memory
+ * the board before wrote.
+ */
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../sim/cpu.h"
+#include "../sim/elf.h"
+#include "../sim/idle.h"
+#include "../sim/pool.h"
+#include "../sim/snapshot.h"
+#include "../sim/stimulus.h"
+#include "../sim/translate.h"
+
+/*
+ * Largest number of cycles a board runs at once, as in the single board
+ * simulator.
+ */
+#define FARM_SLICE_CYCLES       1000000
+
+typedef struct
+{
+    const char *pcPath;
+    tSimElf sElf;
+} tFarmImage;
+
+/*
+ * One board: what it runs, and what came of it.
+ */
+typedef struct
+{
+    uint32_t ui32Image;
+    uint64_t ui64Seed;
+    bool bStimulus;
+    tSimStimulus sStimulus;
+    uint32_t ui32Channel;
+
+    tSimCpuStop eStop;
+    bool bFailed;
+    uint32_t ui32PC;
+    uint64_t ui64Time;
+    uint64_t ui64Insns;
+    uint32_t ui32Resets;
+    uint64_t ppui64Edges[SIM_GPIO_PORTS][8];
+    uint64_t ui64UARTBytes;
+    uint32_t ui32UARTHash;
+} tFarmBoard;
+
+typedef struct
+{
+    tFarmImage *psImages;
+    uint32_t ui32Images;
+    tFarmBoard *psBoards;
+    uint32_t ui32Boards;
+    uint64_t ui64Run;
+    bool bTranslate;
+    bool bIdle;
+
+    /*
+     * Snapshot the boards start from, if any, and the machine of every
+     * worker.
+     */
+    const char *pcSnapshot;
+    tSimSnapshot *psSnapshot;
+    tSimMachine **ppsMachines;
+} tFarm;
+
+static void
+FarmPinChange(void *pvContext, tSimBoard *psBoard, uint32_t ui32Port,
+              uint8_t ui8Old, uint8_t ui8New)
+{
+    tFarmBoard *psFarmBoard = pvContext;
+    uint32_t ui32Pin;
+
+    for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+        if(((ui8Old ^ ui8New) >> ui32Pin) & 1)
+            psFarmBoard->ppui64Edges[ui32Port][ui32Pin]++;
+}
+
+/*
+ * Keeps a FNV-1a hash of what UART0 sent, so that boards can be told apart
+ * by their output without storing it.
+ */
+static void
+FarmUARTTransmit(void *pvContext, tSimBoard *psBoard, uint32_t ui32Port,
+                 uint8_t ui8Byte)
+{
+    tFarmBoard *psFarmBoard = pvContext;
+
+    if(ui32Port != 0)
+        return;
+
+    psFarmBoard->ui64UARTBytes++;
+    psFarmBoard->ui32UARTHash = (psFarmBoard->ui32UARTHash ^ ui8Byte) *
+                                16777619U;
+}
+
+/*
+ * Applies the board's profile to its analog input; the others stay at the
+ * levels set with SimADCSetInput().
+ */
+static uint16_t
+FarmAnalogRead(void *pvContext, tSimBoard *psBoard, uint32_t ui32Channel)
+{
+    tFarmBoard *psFarmBoard = pvContext;
+
+    if(ui32Channel != psFarmBoard->ui32Channel)
+        return(psBoard->pui16Analog[ui32Channel]);
+
+    return(SimStimulusLevel(&psFarmBoard->sStimulus, psBoard->ui64Time));
+}
+
+static tSimMachine *
+FarmMachine(const tFarm *psFarm)
+{
+    tSimMachine *psMachine = calloc(1, sizeof(*psMachine));
+
+    if(!psMachine || !SimCpuInit(psMachine, NULL) ||
+       (psFarm->bTranslate && !SimTranslateInit(psMachine)) ||
+       (psFarm->bIdle && !SimIdleInit(psMachine)))
+    {
+        if(psMachine)
+            SimCpuFree(psMachine);
+
+        free(psMachine);
+        return(NULL);
+    }
+
+    return(psMachine);
+}
+
+/*
+ * Runs one board from reset, or from the snapshot, for the run time.
+ */
+static void
+FarmBoard(void *pvContext, uint32_t ui32Job, uint32_t ui32Worker)
+{
+    tFarm *psFarm = pvContext;
+    tFarmBoard *psFarmBoard = &psFarm->psBoards[ui32Job];
+    tSimMachine *psMachine;
+    tSimBoardHooks sHooks;
+    tSimCpuStop eStop = SIM_CPU_DONE;
+    uint64_t ui64Cycles, ui64Start, ui64End, ui64Insns = 0;
+    uint32_t ui32Resets = 0;
+
+    memset(&sHooks, 0, sizeof(sHooks));
+    sHooks.pvContext = psFarmBoard;
+    sHooks.pfnPinChange = FarmPinChange;
+    sHooks.pfnUARTTransmit = FarmUARTTransmit;
+
+    psFarmBoard->ui32UARTHash = 2166136261U;
+
+    if(psFarm->psSnapshot)
+    {
+        psMachine = psFarm->ppsMachines[ui32Worker];
+
+        if(!psMachine)
+            psMachine = psFarm->ppsMachines[ui32Worker] = FarmMachine(psFarm);
+    }
+    else
+    {
+        psMachine = FarmMachine(psFarm);
+
+        if(psMachine &&
+           !SimElfLoad(&psFarm->psImages[psFarmBoard->ui32Image].sElf,
+                       &psMachine->sMemory))
+        {
+            SimCpuFree(psMachine);
+            free(psMachine);
+            psMachine = NULL;
+        }
+    }
+
+    if(!psMachine)
+    {
+        psFarmBoard->bFailed = true;
+        return;
+    }
+
+    psMachine->sBoard.sHooks = sHooks;
+
+    if(psFarmBoard->bStimulus)
+    {
+        SimStimulusInit(&psFarmBoard->sStimulus, psFarmBoard->ui64Seed);
+        psMachine->sBoard.sHooks.pfnAnalogRead = FarmAnalogRead;
+    }
+
+    if(psFarm->psSnapshot)
+    {
+        SimSnapshotRestore(psMachine, psFarm->psSnapshot);
+        ui64Insns = psMachine->sCpu.ui64Insns;
+        ui32Resets = psMachine->sCpu.ui32Resets;
+    }
+    else
+    {
+        SimCpuInvalidate(psMachine);
+        SimCpuReset(psMachine);
+    }
+
+    ui64Start = psMachine->sBoard.ui64Time;
+    ui64End = ui64Start + psFarm->ui64Run;
+
+    while(psMachine->sBoard.ui64Time < ui64End)
+    {
+        ui64Cycles = (ui64End - psMachine->sBoard.ui64Time +
+                      psMachine->sBoard.ui32CyclePs - 1) /
+                     psMachine->sBoard.ui32CyclePs;
+
+        if(ui64Cycles > FARM_SLICE_CYCLES)
+            ui64Cycles = FARM_SLICE_CYCLES;
+
+        eStop = SimCpuRun(psMachine, ui64Cycles);
+
+        if(eStop != SIM_CPU_DONE)
+            break;
+    }
+
+    psFarmBoard->eStop = eStop;
+    psFarmBoard->ui32PC = psMachine->sCpu.ui32PC;
+    psFarmBoard->ui64Time = psMachine->sBoard.ui64Time - ui64Start;
+    psFarmBoard->ui64Insns = psMachine->sCpu.ui64Insns - ui64Insns;
+    psFarmBoard->ui32Resets = psMachine->sCpu.ui32Resets - ui32Resets;
+
+    if(!psFarm->psSnapshot)
+    {
+        SimCpuFree(psMachine);
+        free(psMachine);
+    }
+}
+
+/*
+ * Returns the index of an image, opening it the first time it is named.
+ * Every image is loaded once here so that the boards cannot fail to load it.
+ */
+static int32_t
+FarmImage(tFarm *psFarm, const char *pcPath)
+{
+    tFarmImage *psImages, *psImage;
+    tSimMemory *psMemory;
+    uint32_t ui32Idx;
+    bool bLoaded;
+
+    for(ui32Idx = 0; ui32Idx < psFarm->ui32Images; ui32Idx++)
+        if(!strcmp(psFarm->psImages[ui32Idx].pcPath, pcPath))
+            return((int32_t)ui32Idx);
+
+    psImages = realloc(psFarm->psImages,
+                       (psFarm->ui32Images + 1) * sizeof(*psImages));
+    psMemory = malloc(sizeof(*psMemory));
+
+    if(!psImages || !psMemory)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    psFarm->psImages = psImages;
+    psImage = &psImages[psFarm->ui32Images];
+    psImage->pcPath = strdup(pcPath);
+
+    if(!SimElfOpen(&psImage->sElf, pcPath))
+    {
+        fprintf(stderr, "%s: %s\n", pcPath, psImage->sElf.pcError);
+        exit(1);
+    }
+
+    SimMemoryInit(psMemory);
+    bLoaded = SimElfLoad(&psImage->sElf, psMemory);
+    free(psMemory);
+
+    if(!bLoaded)
+    {
+        fprintf(stderr, "%s: %s\n", pcPath, psImage->sElf.pcError);
+        exit(1);
+    }
+
+    return((int32_t)psFarm->ui32Images++);
+}
+
+static tFarmBoard *
+FarmAddBoard(tFarm *psFarm)
+{
+    tFarmBoard *psBoards;
+
+    psBoards = realloc(psFarm->psBoards,
+                       (psFarm->ui32Boards + 1) * sizeof(*psBoards));
+
+    if(!psBoards)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    psFarm->psBoards = psBoards;
+    memset(&psBoards[psFarm->ui32Boards], 0, sizeof(*psBoards));
+
+    return(&psBoards[psFarm->ui32Boards++]);
+}
+
+/*
+ * Reads the boards from a file with one board per line:
+ *
+ *     image.elf [profile [seed]]
+ *
+ * Boards without a seed get their line number.  Blank lines and lines
+ * starting with # are skipped.
+ */
+static void
+FarmReadJobs(tFarm *psFarm, const char *pcPath, uint32_t ui32Channel)
+{
+    char pcLine[1024], pcImage[512], pcProfile[256];
+    unsigned long long ullSeed;
+    uint32_t ui32Line = 0;
+    tFarmBoard *psBoard;
+    int i32Fields;
+    FILE *psFile;
+
+    psFile = fopen(pcPath, "r");
+
+    if(!psFile)
+    {
+        fprintf(stderr, "%s: %s\n", pcPath, strerror(errno));
+        exit(1);
+    }
+
+    while(fgets(pcLine, sizeof(pcLine), psFile))
+    {
+        ui32Line++;
+        i32Fields = sscanf(pcLine, "%511s %255s %llu", pcImage, pcProfile,
+                           &ullSeed);
+
+        if((i32Fields <= 0) || (pcImage[0] == '#'))
+            continue;
+
+        psBoard = FarmAddBoard(psFarm);
+        psBoard->ui32Image = (uint32_t)FarmImage(psFarm, pcImage);
+        psBoard->ui64Seed = (i32Fields > 2) ? ullSeed : ui32Line;
+        psBoard->ui32Channel = ui32Channel;
+
+        if(i32Fields > 1)
+        {
+            if(!SimStimulusParse(&psBoard->sStimulus, pcProfile))
+            {
+                fprintf(stderr, "%s:%u: bad profile %s\n", pcPath, ui32Line,
+                        pcProfile);
+                exit(1);
+            }
+
+            psBoard->bStimulus = true;
+        }
+    }
+
+    fclose(psFile);
+}
+
+static void
+FarmReport(const tFarm *psFarm, uint32_t ui32Board)
+{
+    static const char * const ppcStop[] =
+    {
+        [SIM_CPU_DONE] = "done",
+        [SIM_CPU_LOCKUP] = "lockup",
+        [SIM_CPU_BREAKPOINT] = "breakpoint",
+        [SIM_CPU_STOPPED] = "stopped"
+    };
+    const tFarmBoard *psBoard = &psFarm->psBoards[ui32Board];
+    uint32_t ui32Port, ui32Pin;
+    char pcProfile[128];
+
+    printf("%u\t%s\t%llu", ui32Board,
+           psFarm->psSnapshot ? psFarm->pcSnapshot :
+           psFarm->psImages[psBoard->ui32Image].pcPath,
+           (unsigned long long)psBoard->ui64Seed);
+
+    if(psBoard->bStimulus)
+    {
+        SimStimulusFormat(&psBoard->sStimulus, pcProfile, sizeof(pcProfile));
+        printf("\t%s", pcProfile);
+    }
+    else
+    {
+        printf("\t-");
+    }
+
+    if(psBoard->bFailed)
+    {
+        printf("\tout of memory\n");
+        return;
+    }
+
+    printf("\t%s", ppcStop[psBoard->eStop]);
+
+    if(psBoard->eStop != SIM_CPU_DONE)
+        printf(" at 0x%08x", psBoard->ui32PC);
+
+    printf("\t%.6f s\t%llu insns\t%u resets\tUART0 %llu 0x%08x",
+           (double)psBoard->ui64Time / SIM_PS_PER_SECOND,
+           (unsigned long long)psBoard->ui64Insns, psBoard->ui32Resets,
+           (unsigned long long)psBoard->ui64UARTBytes, psBoard->ui32UARTHash);
+
+    for(ui32Port = 0; ui32Port < SIM_GPIO_PORTS; ui32Port++)
+        for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+            if(psBoard->ppui64Edges[ui32Port][ui32Pin])
+                printf("\tP%c%u %llu", 'A' + ui32Port, ui32Pin,
+                       (unsigned long long)
+                       psBoard->ppui64Edges[ui32Port][ui32Pin]);
+
+    printf("\n");
+}
+
+static void
+Usage(const char *pcName)
+{
+    fprintf(stderr,
+            "Usage: %s [--seconds S] [--threads N] [--boards N] [--seed N]\n"
+            "       [--profile P] [--channel N] [--translate] [--no-idle] "
+            "[--quiet]\n"
+            "       image.elf... | --jobs FILE | --snapshot FILE\n", pcName);
+    exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const struct option psOptions[] =
+    {
+        { "seconds", required_argument, NULL, 's' },
+        { "threads", required_argument, NULL, 'j' },
+        { "boards", required_argument, NULL, 'b' },
+        { "seed", required_argument, NULL, 'r' },
+        { "profile", required_argument, NULL, 'p' },
+        { "channel", required_argument, NULL, 'c' },
+        { "jobs", required_argument, NULL, 'f' },
+        { "snapshot", required_argument, NULL, 'S' },
+        { "translate", no_argument, NULL, 't' },
+        { "no-idle", no_argument, NULL, 'n' },
+        { "quiet", no_argument, NULL, 'q' },
+        { NULL, 0, NULL, 0 }
+    };
+    tFarm sFarm;
+    tFarmBoard *psBoard;
+    tSimStimulus sProfile;
+    tSimPoolStats sStats;
+    struct timespec sStart, sEnd;
+    double dSeconds = 10.0, dHost, dSim = 0.0;
+    uint64_t ui64Seed = 0, ui64Insns = 0;
+    uint32_t ui32Boards = 0, ui32Threads = 0, ui32Channel = 0, ui32Board;
+    uint32_t ui32Failed = 0;
+    const char *pcJobs = NULL;
+    bool bProfile = false, bQuiet = false;
+    int i32Opt;
+
+    memset(&sFarm, 0, sizeof(sFarm));
+    sFarm.bIdle = true;
+
+    while((i32Opt = getopt_long(argc, argv, "s:j:b:r:p:c:f:S:tnq", psOptions,
+                                NULL)) != -1)
+    {
+        switch(i32Opt)
+        {
+            case 's':
+                dSeconds = strtod(optarg, NULL);
+                break;
+
+            case 'j':
+                ui32Threads = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                ui32Boards = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                ui64Seed = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'p':
+                if(!SimStimulusParse(&sProfile, optarg))
+                {
+                    fprintf(stderr, "bad profile %s\n", optarg);
+                    return(2);
+                }
+
+                bProfile = true;
+                break;
+
+            case 'c':
+                ui32Channel = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'f':
+                pcJobs = optarg;
+                break;
+
+            case 'S':
+                sFarm.pcSnapshot = optarg;
+                break;
+
+            case 't':
+                sFarm.bTranslate = true;
+                break;
+
+            case 'n':
+                sFarm.bIdle = false;
+                break;
+
+            case 'q':
+                bQuiet = true;
+                break;
+
+            default:
+                Usage(argv[0]);
+        }
+    }
+
+    if((pcJobs != NULL) + (sFarm.pcSnapshot != NULL) + (optind < argc) != 1)
+        Usage(argv[0]);
+
+    if(ui32Channel > SIM_ADC_CHANNELS)
+    {
+        fprintf(stderr, "bad channel %u\n", ui32Channel);
+        return(2);
+    }
+
+    /*
+     * Boards named on the command line take the images in turn and seeds
+     * counting up from --seed.
+     */
+    if(pcJobs)
+    {
+        FarmReadJobs(&sFarm, pcJobs, ui32Channel);
+    }
+    else
+    {
+        if(sFarm.pcSnapshot)
+        {
+            if(!(sFarm.psSnapshot = SimSnapshotLoad(sFarm.pcSnapshot)))
+            {
+                fprintf(stderr, "%s: not a snapshot of this simulator\n",
+                        sFarm.pcSnapshot);
+                return(1);
+            }
+
+            if(!ui32Threads)
+                ui32Threads = SimPoolCores();
+
+            sFarm.ppsMachines = calloc(ui32Threads, sizeof(tSimMachine *));
+
+            if(!sFarm.ppsMachines)
+            {
+                fprintf(stderr, "out of memory\n");
+                return(1);
+            }
+        }
+
+        if(!ui32Boards)
+            ui32Boards = sFarm.pcSnapshot ? 1 : (uint32_t)(argc - optind);
+
+        for(ui32Board = 0; ui32Board < ui32Boards; ui32Board++)
+        {
+            psBoard = FarmAddBoard(&sFarm);
+
+            if(!sFarm.pcSnapshot)
+                psBoard->ui32Image =
+                    (uint32_t)FarmImage(&sFarm, argv[optind + ui32Board %
+                                                     (argc - optind)]);
+
+            psBoard->ui64Seed = ui64Seed + ui32Board;
+            psBoard->ui32Channel = ui32Channel;
+            psBoard->bStimulus = bProfile;
+
+            if(bProfile)
+                psBoard->sStimulus = sProfile;
+        }
+    }
+
+    sFarm.ui64Run = (uint64_t)(dSeconds * SIM_PS_PER_SECOND);
+
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+
+    if(!SimPoolRun(sFarm.ui32Boards, ui32Threads, FarmBoard, &sFarm, &sStats))
+    {
+        fprintf(stderr, "out of memory\n");
+        return(1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sEnd);
+
+    dHost = (double)(sEnd.tv_sec - sStart.tv_sec) +
+            (double)(sEnd.tv_nsec - sStart.tv_nsec) / 1e9;
+
+    for(ui32Board = 0; ui32Board < sFarm.ui32Boards; ui32Board++)
+    {
+        psBoard = &sFarm.psBoards[ui32Board];
+
+        if(!bQuiet)
+            FarmReport(&sFarm, ui32Board);
+
+        if(psBoard->bFailed || (psBoard->eStop != SIM_CPU_DONE))
+            ui32Failed++;
+
+        dSim += (double)psBoard->ui64Time / SIM_PS_PER_SECOND;
+        ui64Insns += psBoard->ui64Insns;
+    }
+
+    printf("%u boards on %u threads, %llu stolen, %u stopped early\n",
+           sFarm.ui32Boards, sStats.ui32Workers,
+           (unsigned long long)sStats.ui64Steals, ui32Failed);
+    printf("simulated %.6f s in %.6f s (%.0fx real time, %.1f MIPS)\n", dSim,
+           dHost, dHost > 0 ? dSim / dHost : 0.0,
+           dHost > 0 ? ui64Insns / dHost / 1e6 : 0.0);
+
+    for(ui32Board = 0; ui32Board < sFarm.ui32Images; ui32Board++)
+        SimElfClose(&sFarm.psImages[ui32Board].sElf);
+
+    if(sFarm.psSnapshot)
+    {
+        for(ui32Board = 0; ui32Board < ui32Threads; ui32Board++)
+        {
+            if(sFarm.ppsMachines[ui32Board])
+            {
+                SimCpuFree(sFarm.ppsMachines[ui32Board]);
+                free(sFarm.ppsMachines[ui32Board]);
+            }
+        }
+
+        free(sFarm.ppsMachines);
+        SimSnapshotFree(sFarm.psSnapshot);
+    }
+
+    return(ui32Failed ? 1 : 0);
+}
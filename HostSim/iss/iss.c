@@ -0,0 +1,1020 @@
+/*
+ * Runs a firmware ELF image built for the TM4C123GH6PM on the instruction
+ * set simulator and reports the activity of the GPIO pins.
+ */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../sim/cpu.h"
+#include "../sim/debug.h"
+#include "../sim/elf.h"
+#include "../sim/gdb.h"
+#include "../sim/idle.h"
+#include "../sim/profile.h"
+#include "../sim/replay.h"
+#include "../sim/shadow.h"
+#include "../sim/snapshot.h"
+#include "../sim/timing.h"
+#include "../sim/trace.h"
+#include "../sim/translate.h"
+#include "../sim/wave.h"
+
+/*
+ * Largest number of cycles run at once, so the simulated time is checked
+ * against the end time often enough when the clock changes.
+ */
+#define ISS_SLICE_CYCLES        1000000
+
+/*
+ * Functions and instructions listed in the report of the profile.
+ */
+#define ISS_PROFILE_FUNCTIONS   20
+#define ISS_PROFILE_PCS         10
+
+/*
+ * Pairs of exceptions listed in the report of which held up which.
+ */
+#define ISS_BLOCKED_PAIRS       16
+
+typedef struct
+{
+    uint64_t ui64Edges;
+    uint64_t ui64First;
+    uint64_t ui64Last;
+} tPinStats;
+
+static tPinStats g_psPins[SIM_GPIO_PORTS][8];
+static bool g_bEdges;
+static tSimWave *g_psWave;
+
+static void
+IssPinChange(void *pvContext, tSimBoard *psBoard, uint32_t ui32Port,
+             uint8_t ui8Old, uint8_t ui8New)
+{
+    uint32_t ui32Pin;
+    tPinStats *psPin;
+
+    (void)pvContext;
+
+    if(g_psWave)
+        SimWaveChange(g_psWave, psBoard->ui64Time, ui32Port, ui8New);
+
+    for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+    {
+        if(!(((ui8Old ^ ui8New) >> ui32Pin) & 1))
+            continue;
+
+        psPin = &g_psPins[ui32Port][ui32Pin];
+
+        if(!psPin->ui64Edges++)
+            psPin->ui64First = psBoard->ui64Time;
+
+        psPin->ui64Last = psBoard->ui64Time;
+
+        if(g_bEdges)
+            printf("%14.6f s  P%c%u %s\n",
+                   (double)psBoard->ui64Time / SIM_PS_PER_SECOND,
+                   'A' + ui32Port, ui32Pin,
+                   ((ui8New >> ui32Pin) & 1) ? "high" : "low");
+    }
+}
+
+/*
+ * Returns the name of the handler the vector of ui32Exc points at.
+ */
+static const char *
+IssHandlerName(tSimMachine *psMachine, const tSimElf *psElf, uint32_t ui32Exc)
+{
+    const tSimElfSymbol *psSymbol = NULL;
+    uint32_t ui32Vector;
+
+    if(!ui32Exc)
+        return("thread mode");
+
+    if(SimCpuReadMemory(psMachine,
+                        psMachine->sBoard.sNVIC.ui32VTOR + ui32Exc * 4, 4,
+                        &ui32Vector))
+        psSymbol = SimElfSymbolAt(psElf, ui32Vector & ~1U);
+
+    return(psSymbol ? psSymbol->pcName : "?");
+}
+
+/*
+ * Prints the pairs of exceptions where one was kept waiting longest by the
+ * other, longest first.
+ */
+static void
+IssBlockedReport(tSimMachine *psMachine, const tSimElf *psElf, uint32_t ui32Hz)
+{
+    const tSimTiming *psTiming = psMachine->psTiming;
+    uint32_t ui32Waiting, ui32Running, ui32Pair, ui32Pairs = 0;
+    uint32_t pui32Waiting[ISS_BLOCKED_PAIRS], pui32Running[ISS_BLOCKED_PAIRS];
+    uint64_t ui64Cycles;
+
+    for(ui32Waiting = 1; ui32Waiting < SIM_NVIC_EXCEPTIONS; ui32Waiting++)
+    {
+        for(ui32Running = 0; ui32Running < SIM_NVIC_EXCEPTIONS; ui32Running++)
+        {
+            ui64Cycles = psTiming->pui64Blocked[ui32Waiting][ui32Running];
+
+            if(!ui64Cycles)
+                continue;
+
+            /*
+             * Insertion into the list kept sorted, the shortest dropping out
+             * once it is full.
+             */
+            for(ui32Pair = ui32Pairs; ui32Pair > 0; ui32Pair--)
+            {
+                if(psTiming->pui64Blocked[pui32Waiting[ui32Pair - 1]]
+                                         [pui32Running[ui32Pair - 1]] >=
+                   ui64Cycles)
+                    break;
+
+                if(ui32Pair < ISS_BLOCKED_PAIRS)
+                {
+                    pui32Waiting[ui32Pair] = pui32Waiting[ui32Pair - 1];
+                    pui32Running[ui32Pair] = pui32Running[ui32Pair - 1];
+                }
+            }
+
+            if(ui32Pair < ISS_BLOCKED_PAIRS)
+            {
+                pui32Waiting[ui32Pair] = ui32Waiting;
+                pui32Running[ui32Pair] = ui32Running;
+
+                if(ui32Pairs < ISS_BLOCKED_PAIRS)
+                    ui32Pairs++;
+            }
+        }
+    }
+
+    if(!ui32Pairs)
+        return;
+
+    printf("pending exc                 behind exc                       "
+           "cycles         time\n");
+
+    for(ui32Pair = 0; ui32Pair < ui32Pairs; ui32Pair++)
+    {
+        ui32Waiting = pui32Waiting[ui32Pair];
+        ui32Running = pui32Running[ui32Pair];
+        ui64Cycles = psTiming->pui64Blocked[ui32Waiting][ui32Running];
+
+        printf("%3u %-24s %3u %-24s %12llu  %11.3f us\n", ui32Waiting,
+               IssHandlerName(psMachine, psElf, ui32Waiting), ui32Running,
+               IssHandlerName(psMachine, psElf, ui32Running),
+               (unsigned long long)ui64Cycles,
+               (double)ui64Cycles * 1e6 / ui32Hz);
+    }
+}
+
+/*
+ * Prints the latency and the cycles of the handler of every exception taken,
+ * with the handler named after the symbol its vector points at, then how
+ * the exceptions were entered, their latency histograms and which held up
+ * which.
+ */
+static void
+IssTimingReport(tSimMachine *psMachine, const tSimElf *psElf)
+{
+    const tSimTiming *psTiming = psMachine->psTiming;
+    const tSimTimingStats *psStats;
+    uint32_t ui32Exc, ui32Bin, ui32Hz = SimTimingClock(psMachine);
+    double dCycles;
+
+    printf("timing at %.3f MHz, %u flash wait state%s, priority group %u:\n",
+           ui32Hz / 1e6, SimTimingWaitStates(psMachine),
+           (SimTimingWaitStates(psMachine) == 1) ? "" : "s",
+           psMachine->sBoard.sNVIC.ui32PriGroup);
+    printf("exc handler                     count    latency min/avg/max  "
+           "jitter     handler min/avg/max        avg\n");
+
+    for(ui32Exc = 1; ui32Exc < SIM_NVIC_EXCEPTIONS; ui32Exc++)
+    {
+        psStats = &psTiming->psStats[ui32Exc];
+
+        if(!psStats->ui64Count)
+            continue;
+
+        printf("%3u %-24s %9llu  %6llu %7.1f %6llu  %6llu", ui32Exc,
+               IssHandlerName(psMachine, psElf, ui32Exc),
+               (unsigned long long)psStats->ui64Count,
+               (unsigned long long)psStats->ui64LatencyMin,
+               (double)psStats->ui64LatencySum / psStats->ui64Count,
+               (unsigned long long)psStats->ui64LatencyMax,
+               (unsigned long long)(psStats->ui64LatencyMax -
+                                    psStats->ui64LatencyMin));
+
+        if(psStats->ui64Returns)
+        {
+            dCycles = (double)psStats->ui64CyclesSum / psStats->ui64Returns;
+            printf("  %6llu %7.1f %6llu  %7.3f us",
+                   (unsigned long long)psStats->ui64CyclesMin, dCycles,
+                   (unsigned long long)psStats->ui64CyclesMax,
+                   dCycles * 1e6 / ui32Hz);
+        }
+
+        printf("\n");
+    }
+
+    printf("exc handler                  preempting  preempted    chained  "
+           "      late  latency histogram, cycles below\n");
+
+    for(ui32Exc = 1; ui32Exc < SIM_NVIC_EXCEPTIONS; ui32Exc++)
+    {
+        psStats = &psTiming->psStats[ui32Exc];
+
+        if(!psStats->ui64Count)
+            continue;
+
+        printf("%3u %-24s %10llu %10llu %10llu %10llu ", ui32Exc,
+               IssHandlerName(psMachine, psElf, ui32Exc),
+               (unsigned long long)psStats->ui64Preemptions,
+               (unsigned long long)psStats->ui64Preempted,
+               (unsigned long long)psStats->ui64TailChains,
+               (unsigned long long)psStats->ui64LateArrivals);
+
+        for(ui32Bin = 0; ui32Bin < SIM_TIMING_HIST_BINS; ui32Bin++)
+        {
+            if(!psStats->pui64Latency[ui32Bin])
+                continue;
+
+            if(ui32Bin == SIM_TIMING_HIST_BINS - 1)
+                printf(" more:%llu",
+                       (unsigned long long)psStats->pui64Latency[ui32Bin]);
+            else
+                printf(" %llu:%llu", 1ULL << ui32Bin,
+                       (unsigned long long)psStats->pui64Latency[ui32Bin]);
+        }
+
+        printf("\n");
+    }
+
+    IssBlockedReport(psMachine, psElf, ui32Hz);
+}
+
+/*
+ * Per function totals of the profile.  The cycles of a call include those of
+ * the functions it calls, but not twice for a function that calls itself.
+ */
+typedef struct
+{
+    uint32_t ui32Node;
+    uint64_t ui64Calls;
+    uint64_t ui64Insns;
+    uint64_t ui64Self;
+    uint64_t ui64Total;
+} tIssFunction;
+
+static int
+IssFunctionCompare(const void *pvA, const void *pvB)
+{
+    const tIssFunction *psA = pvA, *psB = pvB;
+
+    return((psA->ui64Total < psB->ui64Total) ? 1 :
+           (psA->ui64Total > psB->ui64Total) ? -1 : 0);
+}
+
+/*
+ * Prints the functions taking the most cycles, with and without those they
+ * call, then the instructions taking the most cycles.
+ */
+static void
+IssProfileReport(const tSimProfile *psProfile, const tSimElf *psElf)
+{
+    const tSimProfileNode *psNode;
+    const tSimElfSymbol *psSymbol;
+    tIssFunction *psFunctions, *psFunction;
+    uint64_t *pui64Total, pui64Cycles[ISS_PROFILE_PCS];
+    uint32_t pui32Offset[ISS_PROFILE_PCS];
+    uint32_t ui32Node, ui32Up, ui32Idx, ui32Offset, ui32Addr, ui32Count = 0;
+    double dCycles = psProfile->ui64Cycles ? psProfile->ui64Cycles : 1;
+
+    psFunctions = calloc(psElf->ui32Symbols + 1, sizeof(tIssFunction));
+    pui64Total = calloc(psProfile->ui32Nodes, sizeof(uint64_t));
+
+    if(!psFunctions || !pui64Total)
+    {
+        free(psFunctions);
+        free(pui64Total);
+        return;
+    }
+
+    /*
+     * Children come after their parent.
+     */
+    for(ui32Node = psProfile->ui32Nodes - 1; ui32Node; ui32Node--)
+    {
+        pui64Total[ui32Node] += psProfile->psNodes[ui32Node].ui64Cycles;
+        pui64Total[psProfile->psNodes[ui32Node].ui32Parent] +=
+            pui64Total[ui32Node];
+    }
+
+    for(ui32Node = 1; ui32Node < psProfile->ui32Nodes; ui32Node++)
+    {
+        psNode = &psProfile->psNodes[ui32Node];
+        psFunction = &psFunctions[(psNode->ui32Symbol == SIM_PROFILE_UNKNOWN) ?
+                                  psElf->ui32Symbols : psNode->ui32Symbol];
+        psFunction->ui32Node = ui32Node;
+        psFunction->ui64Calls += psNode->ui64Calls;
+        psFunction->ui64Insns += psNode->ui64Insns;
+        psFunction->ui64Self += psNode->ui64Cycles;
+
+        for(ui32Up = psNode->ui32Parent; ui32Up;
+            ui32Up = psProfile->psNodes[ui32Up].ui32Parent)
+            if(psProfile->psNodes[ui32Up].ui32Symbol == psNode->ui32Symbol)
+                break;
+
+        if(!ui32Up)
+            psFunction->ui64Total += pui64Total[ui32Node];
+    }
+
+    qsort(psFunctions, psElf->ui32Symbols + 1, sizeof(tIssFunction),
+          IssFunctionCompare);
+
+    printf("profile of %llu instructions, %llu cycles awake, %llu asleep:\n",
+           (unsigned long long)psProfile->ui64Insns,
+           (unsigned long long)psProfile->ui64Cycles,
+           (unsigned long long)psProfile->ui64SleepCycles);
+    printf("function                      calls        insns   self cycles  "
+           "total cycles  total%%   cycles/call\n");
+
+    for(ui32Idx = 0; (ui32Idx < ISS_PROFILE_FUNCTIONS) &&
+                     (ui32Idx <= psElf->ui32Symbols) &&
+                     psFunctions[ui32Idx].ui64Total; ui32Idx++)
+    {
+        psFunction = &psFunctions[ui32Idx];
+        printf("%-24s %10llu %12llu %13llu %13llu %6.2f%% %13.1f\n",
+               SimProfileName(psProfile, psFunction->ui32Node),
+               (unsigned long long)psFunction->ui64Calls,
+               (unsigned long long)psFunction->ui64Insns,
+               (unsigned long long)psFunction->ui64Self,
+               (unsigned long long)psFunction->ui64Total,
+               psFunction->ui64Total * 100 / dCycles,
+               psFunction->ui64Calls ?
+               (double)psFunction->ui64Total / psFunction->ui64Calls : 0.0);
+    }
+
+    if(psProfile->ui64Overflows)
+        printf("%llu calls deeper than %u not followed\n",
+               (unsigned long long)psProfile->ui64Overflows,
+               SIM_PROFILE_DEPTH);
+
+    /*
+     * The hottest instructions, kept in order as the arena is scanned.
+     */
+    for(ui32Offset = 0; ui32Offset < SIM_MEM_ARENA_SIZE / 2; ui32Offset++)
+    {
+        if(!psProfile->pui64Cycles[ui32Offset] ||
+           ((ui32Count == ISS_PROFILE_PCS) &&
+            (psProfile->pui64Cycles[ui32Offset] <=
+             pui64Cycles[ISS_PROFILE_PCS - 1])))
+            continue;
+
+        if(ui32Count < ISS_PROFILE_PCS)
+            ui32Count++;
+
+        for(ui32Idx = ui32Count - 1;
+            ui32Idx && (pui64Cycles[ui32Idx - 1] <
+                        psProfile->pui64Cycles[ui32Offset]); ui32Idx--)
+        {
+            pui64Cycles[ui32Idx] = pui64Cycles[ui32Idx - 1];
+            pui32Offset[ui32Idx] = pui32Offset[ui32Idx - 1];
+        }
+
+        pui64Cycles[ui32Idx] = psProfile->pui64Cycles[ui32Offset];
+        pui32Offset[ui32Idx] = ui32Offset;
+    }
+
+    printf("address     instruction                    insns        cycles  "
+           "cycles%%\n");
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        ui32Addr = pui32Offset[ui32Idx] * 2;
+        ui32Addr = (ui32Addr < SIM_MEM_SRAM_OFFSET) ?
+                   SIM_FLASH_BASE + ui32Addr :
+                   SIM_SRAM_BASE + ui32Addr - SIM_MEM_SRAM_OFFSET;
+        psSymbol = SimElfSymbolAt(psElf, ui32Addr);
+
+        printf("0x%08x  ", ui32Addr);
+
+        if(psSymbol)
+            printf("%-24s+0x%-4x", psSymbol->pcName,
+                   ui32Addr - psSymbol->ui32Value);
+        else
+            printf("%-30s", "[unknown]");
+
+        printf(" %12llu %13llu %7.2f%%\n",
+               (unsigned long long)psProfile->pui64Insns[pui32Offset[ui32Idx]],
+               (unsigned long long)pui64Cycles[ui32Idx],
+               pui64Cycles[ui32Idx] * 100 / dCycles);
+    }
+
+    free(psFunctions);
+    free(pui64Total);
+}
+
+/*
+ * Prints the high-water mark of the stack and where the accesses to SRAM
+ * went wrong.
+ */
+static void
+IssShadowReport(const tSimShadow *psShadow, const tSimElf *psElf)
+{
+    static const char * const ppcKind[SIM_SHADOW_KINDS] =
+    {
+        [SIM_SHADOW_UNDEFINED] = "uninitialized read",
+        [SIM_SHADOW_OVERFLOW] = "sp outside stack",
+        [SIM_SHADOW_CLOBBER] = "stack over .data/.bss"
+    };
+    const tSimShadowSite *psSite;
+    const tSimElfSymbol *psSymbol;
+    uint32_t ui32Size = psShadow->ui32StackTop - psShadow->ui32StackLow;
+    uint32_t ui32Used = psShadow->ui32StackTop - psShadow->ui32LowestSP;
+    uint32_t ui32Idx;
+
+    if(psShadow->ui32StackLow)
+        printf("stack 0x%08x-0x%08x, %u bytes, high-water %u bytes "
+               "(%.1f%%)", psShadow->ui32StackLow, psShadow->ui32StackTop,
+               ui32Size, ui32Used, ui32Size ? ui32Used * 100.0 / ui32Size :
+                                             0.0);
+    else
+        printf("stack below 0x%08x, high-water %u bytes",
+               psShadow->ui32StackTop, ui32Used);
+
+    psSymbol = SimElfSymbolAt(psElf, psShadow->ui32LowestPC);
+
+    if(psSymbol)
+        printf(" in %s+0x%x", psSymbol->pcName,
+               psShadow->ui32LowestPC - psSymbol->ui32Value);
+
+    printf("\n");
+
+    if(psShadow->ui32StackEnd != psShadow->ui32StackTop)
+        printf("initial sp 0x%08x is not the end of .stack at 0x%08x\n",
+               psShadow->ui32StackTop, psShadow->ui32StackEnd);
+
+    printf("%llu uninitialized reads, %llu instructions with sp outside the "
+           "stack, %llu writes\nof .data or .bss by the stack\n",
+           (unsigned long long)psShadow->pui64Count[SIM_SHADOW_UNDEFINED],
+           (unsigned long long)psShadow->pui64Count[SIM_SHADOW_OVERFLOW],
+           (unsigned long long)psShadow->pui64Count[SIM_SHADOW_CLOBBER]);
+
+    for(ui32Idx = 0; ui32Idx < psShadow->ui32Sites; ui32Idx++)
+    {
+        psSite = &psShadow->psSites[ui32Idx];
+        psSymbol = SimElfSymbolAt(psElf, psSite->ui32PC);
+        printf("  %-22s pc 0x%08x", ppcKind[psSite->eKind], psSite->ui32PC);
+
+        if(psSymbol)
+            printf(" (%s+0x%x)", psSymbol->pcName,
+                   psSite->ui32PC - psSymbol->ui32Value);
+
+        printf(", addr 0x%08x, sp 0x%08x, %llu times\n", psSite->ui32Addr,
+               psSite->ui32SP, (unsigned long long)psSite->ui64Count);
+    }
+}
+
+/*
+ * Prints how often the chip woke from hibernation and how much of the run it
+ * spent hibernating.
+ */
+static void
+IssHibReport(const tSimBoard *psBoard, double dSim)
+{
+    const tSimHib *psHib = &psBoard->sHib;
+    uint64_t ui64Hibernated = psHib->ui64Hibernated;
+
+    if(psBoard->bHibernating)
+        ui64Hibernated += psBoard->ui64Time - psHib->ui64Entered;
+
+    if(!psHib->ui64Wakes && !ui64Hibernated)
+        return;
+
+    printf("%llu wakes from hibernation, %.6f s hibernated (%.1f%% of the "
+           "run)\n", (unsigned long long)psHib->ui64Wakes,
+           (double)ui64Hibernated / SIM_PS_PER_SECOND,
+           dSim > 0 ? (double)ui64Hibernated / SIM_PS_PER_SECOND * 100 / dSim :
+                      0.0);
+}
+
+/*
+ * Prints the registers of the processor where a run stopped at --seek.
+ */
+static void
+IssRegisters(tSimMachine *psMachine, const tSimElf *psElf)
+{
+    const tSimCpu *psCpu = &psMachine->sCpu;
+    const tSimElfSymbol *psSymbol;
+    uint32_t ui32Reg;
+
+    psSymbol = SimElfSymbolAt(psElf, psCpu->ui32PC);
+    printf("cycle %llu, pc 0x%08x",
+           (unsigned long long)psMachine->sBoard.ui64Cycle, psCpu->ui32PC);
+
+    if(psSymbol)
+        printf(" (%s+0x%x)", psSymbol->pcName,
+               psCpu->ui32PC - psSymbol->ui32Value);
+
+    printf(", xpsr 0x%08x\n", SimCpuXPSR(psCpu));
+
+    for(ui32Reg = 0; ui32Reg < 15; ui32Reg++)
+        printf("r%-2u 0x%08x%s", ui32Reg, psCpu->pui32R[ui32Reg],
+               ((ui32Reg % 4 == 3) || (ui32Reg == 14)) ? "\n" : "  ");
+}
+
+static void
+Usage(const char *pcName)
+{
+    fprintf(stderr, "Usage: %s [--seconds S] [--edges] [--translate] "
+            "[--no-idle] [--vcd FILE] [--timing] [--clock MHZ]\n"
+            "       [--record FILE [--uart-input FILE]] [--replay FILE] "
+            "[--seek CYCLE]\n"
+            "       [--snapshot FILE] [--save-snapshot FILE] [--gdb PORT] "
+            "[--flame FILE] [--shadow]\n"
+            "       [--trace FILE] image.elf\n",
+            pcName);
+    exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const struct option psOptions[] =
+    {
+        { "seconds", required_argument, NULL, 's' },
+        { "edges", no_argument, NULL, 'e' },
+        { "translate", no_argument, NULL, 't' },
+        { "no-idle", no_argument, NULL, 'n' },
+        { "vcd", required_argument, NULL, 'v' },
+        { "timing", no_argument, NULL, 'T' },
+        { "clock", required_argument, NULL, 'c' },
+        { "record", required_argument, NULL, 'R' },
+        { "replay", required_argument, NULL, 'P' },
+        { "uart-input", required_argument, NULL, 'i' },
+        { "seek", required_argument, NULL, 'k' },
+        { "snapshot", required_argument, NULL, 'S' },
+        { "save-snapshot", required_argument, NULL, 'W' },
+        { "gdb", required_argument, NULL, 'g' },
+        { "flame", required_argument, NULL, 'f' },
+        { "shadow", no_argument, NULL, 'm' },
+        { "trace", required_argument, NULL, 'x' },
+        { NULL, 0, NULL, 0 }
+    };
+    static const char * const ppcStop[] =
+    {
+        [SIM_CPU_DONE] = "done",
+        [SIM_CPU_LOCKUP] = "lockup",
+        [SIM_CPU_BREAKPOINT] = "breakpoint",
+        [SIM_CPU_STOPPED] = "stopped"
+    };
+    tSimMachine *psMachine;
+    tSimBoardHooks sHooks;
+    tSimCpuStop eStop = SIM_CPU_DONE;
+    tSimElf sElf;
+    const tSimElfSymbol *psSymbol;
+    struct timespec sStart, sEnd;
+    double dSeconds = 10.0, dHost, dSim;
+    uint64_t ui64Start, ui64End, ui64Cycles, ui64Stalls, ui64Seek = 0;
+    uint32_t ui32Port, ui32Pin, ui32Addr;
+    tPinStats *psPin;
+    tSimReplay *psReplay = NULL;
+    const char *pcWave = NULL, *pcRecord = NULL, *pcReplay = NULL;
+    const char *pcInput = NULL, *pcSnapshot = NULL, *pcSave = NULL;
+    const char *pcFlame = NULL, *pcTrace = NULL;
+    tSimSnapshot *psSnapshot;
+    uint32_t ui32ClockHz = 0, ui32GdbPort = 0;
+    tSimGdb *psGdb = NULL;
+    bool bTranslate = false, bIdle = true, bTiming = false, bShadow = false;
+    int i32Opt;
+
+    while((i32Opt = getopt_long(argc, argv, "s:etnv:Tc:R:P:i:k:S:W:g:f:mx:",
+                                psOptions, NULL)) != -1)
+    {
+        switch(i32Opt)
+        {
+            case 's':
+                dSeconds = strtod(optarg, NULL);
+                break;
+
+            case 'e':
+                g_bEdges = true;
+                break;
+
+            case 't':
+                bTranslate = true;
+                break;
+
+            case 'n':
+                bIdle = false;
+                break;
+
+            case 'v':
+                pcWave = optarg;
+                break;
+
+            case 'T':
+                bTiming = true;
+                break;
+
+            case 'c':
+                ui32ClockHz = (uint32_t)(strtod(optarg, NULL) * 1e6);
+                bTiming = true;
+                break;
+
+            case 'R':
+                pcRecord = optarg;
+                break;
+
+            case 'P':
+                pcReplay = optarg;
+                break;
+
+            case 'i':
+                pcInput = optarg;
+                break;
+
+            case 'k':
+                ui64Seek = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'S':
+                pcSnapshot = optarg;
+                break;
+
+            case 'W':
+                pcSave = optarg;
+                break;
+
+            case 'g':
+                ui32GdbPort = (uint32_t)strtoul(optarg, NULL, 0);
+
+                if(!ui32GdbPort || (ui32GdbPort > 65535))
+                    Usage(argv[0]);
+                break;
+
+            case 'f':
+                pcFlame = optarg;
+                break;
+
+            case 'm':
+                bShadow = true;
+                break;
+
+            case 'x':
+                pcTrace = optarg;
+                break;
+
+            default:
+                Usage(argv[0]);
+        }
+    }
+
+    if((optind != argc - 1) || (pcReplay && (pcRecord || pcInput)))
+        Usage(argv[0]);
+
+    /*
+     * Translated blocks are charged a cycle per instruction.
+     */
+    if(bTiming && bTranslate)
+    {
+        fprintf(stderr, "%s: --timing and --translate cannot be combined\n",
+                argv[0]);
+        return(2);
+    }
+
+    /*
+     * Translated blocks do not stop at breakpoints.
+     */
+    if(ui32GdbPort && bTranslate)
+    {
+        fprintf(stderr, "%s: --gdb and --translate cannot be combined\n",
+                argv[0]);
+        return(2);
+    }
+
+    /*
+     * Nor are they profiled.
+     */
+    if(pcFlame && bTranslate)
+    {
+        fprintf(stderr, "%s: --flame and --translate cannot be combined\n",
+                argv[0]);
+        return(2);
+    }
+
+    /*
+     * Nor are their accesses shadowed.
+     */
+    if(bShadow && bTranslate)
+    {
+        fprintf(stderr, "%s: --shadow and --translate cannot be combined\n",
+                argv[0]);
+        return(2);
+    }
+
+    if(!SimElfOpen(&sElf, argv[optind]))
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], sElf.pcError);
+        return(1);
+    }
+
+    memset(&sHooks, 0, sizeof(sHooks));
+    sHooks.pfnPinChange = IssPinChange;
+
+    psMachine = calloc(1, sizeof(*psMachine));
+
+    if(!psMachine || !SimCpuInit(psMachine, &sHooks) ||
+       (bTranslate && !SimTranslateInit(psMachine)) ||
+       (bIdle && !SimIdleInit(psMachine)) ||
+       (bTiming && !SimTimingInit(psMachine, ui32ClockHz)) ||
+       (ui32GdbPort && !SimDebugInit(psMachine)))
+    {
+        fprintf(stderr, "out of memory\n");
+        return(1);
+    }
+
+    if(!SimElfLoad(&sElf, &psMachine->sMemory))
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], sElf.pcError);
+        return(1);
+    }
+
+    /*
+     * The core fetches its vector table from address 0 at reset.
+     */
+    if(SimElfSection(&sElf, ".isr_vector", &ui32Addr, NULL) && ui32Addr)
+        fprintf(stderr, "warning: .isr_vector is at 0x%08x, not 0\n",
+                ui32Addr);
+
+    SimCpuInvalidate(psMachine);
+    SimCpuReset(psMachine);
+
+    /*
+     * A run from a snapshot goes on from where the snapshot was taken.
+     */
+    if(pcSnapshot)
+    {
+        if(!(psSnapshot = SimSnapshotLoad(pcSnapshot)))
+        {
+            fprintf(stderr, "%s: not a snapshot of this simulator\n",
+                    pcSnapshot);
+            return(1);
+        }
+
+        SimSnapshotRestore(psMachine, psSnapshot);
+        SimSnapshotFree(psSnapshot);
+        psMachine->psSnapshot = NULL;
+    }
+
+    if(pcReplay && !(psReplay = SimReplayOpen(pcReplay)))
+    {
+        fprintf(stderr, "%s: not a recording\n", pcReplay);
+        return(1);
+    }
+
+    if((pcRecord || pcInput) && !(psReplay = SimReplayRecord(pcRecord)))
+    {
+        fprintf(stderr, "%s: cannot create\n",
+                pcRecord ? pcRecord : "recording");
+        return(1);
+    }
+
+    if(pcInput && !SimReplayInput(psReplay, 0, pcInput))
+    {
+        fprintf(stderr, "%s: cannot read\n", pcInput);
+        return(1);
+    }
+
+    if(psReplay)
+        SimReplayAttach(&psMachine->sBoard, psReplay);
+
+    ui64Start = psMachine->sBoard.ui64Time;
+    ui64End = ui64Start + (uint64_t)(dSeconds * SIM_PS_PER_SECOND);
+
+    if(pcWave && !(g_psWave = SimWaveOpen(pcWave)))
+    {
+        fprintf(stderr, "%s: cannot create\n", pcWave);
+        return(1);
+    }
+
+    /*
+     * The firmware waits at its first instruction for the debugger.
+     */
+    if(ui32GdbPort)
+    {
+        if(!(psGdb = SimGdbOpen((uint16_t)ui32GdbPort)))
+        {
+            fprintf(stderr, "port %u: cannot listen\n", ui32GdbPort);
+            return(1);
+        }
+
+        fprintf(stderr, "waiting for gdb on localhost:%u\n", ui32GdbPort);
+
+        if(!SimGdbAccept(psGdb))
+        {
+            fprintf(stderr, "port %u: cannot accept\n", ui32GdbPort);
+            return(1);
+        }
+    }
+
+    /*
+     * The profile and the shadow state start where the run does, from a
+     * snapshot if one was restored.
+     */
+    if((pcFlame && !SimProfileInit(psMachine, &sElf)) ||
+       (bShadow && !SimShadowInit(psMachine, &sElf)))
+    {
+        fprintf(stderr, "out of memory\n");
+        return(1);
+    }
+
+    if(bShadow && pcSnapshot)
+        SimShadowDefine(psMachine, SIM_SRAM_BASE, SIM_SRAM_SIZE);
+
+    if(pcTrace && !SimTraceInit(psMachine, pcTrace))
+    {
+        fprintf(stderr, "%s: cannot create\n", pcTrace);
+        return(1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+
+    while(psMachine->sBoard.ui64Time < ui64End)
+    {
+        ui64Cycles = (ui64End - psMachine->sBoard.ui64Time +
+                      psMachine->sBoard.ui32CyclePs - 1) /
+                     psMachine->sBoard.ui32CyclePs;
+
+        if(ui64Cycles > ISS_SLICE_CYCLES)
+            ui64Cycles = ISS_SLICE_CYCLES;
+
+        /*
+         * A run seeking a cycle stops at the first instruction boundary at
+         * or after it.
+         */
+        if(ui64Seek)
+        {
+            if(psMachine->sBoard.ui64Cycle >= ui64Seek)
+                break;
+
+            if(ui64Cycles > ui64Seek - psMachine->sBoard.ui64Cycle)
+                ui64Cycles = ui64Seek - psMachine->sBoard.ui64Cycle;
+        }
+
+        eStop = psGdb ? SimGdbRun(psGdb, psMachine, ui64Cycles) :
+                        SimCpuRun(psMachine, ui64Cycles);
+
+        if(eStop != SIM_CPU_DONE)
+            break;
+    }
+
+    SimGdbClose(psGdb, (eStop == SIM_CPU_DONE) ? 0 : 1);
+
+    clock_gettime(CLOCK_MONOTONIC, &sEnd);
+
+    if(g_psWave)
+    {
+        ui64Stalls = g_psWave->ui64Stalls;
+
+        if(!SimWaveClose(g_psWave, psMachine->sBoard.ui64Time, NULL))
+            fprintf(stderr, "%s: write error\n", pcWave);
+        else if(ui64Stalls)
+            fprintf(stderr, "%s: simulation waited %llu times for the "
+                    "writer\n", pcWave, (unsigned long long)ui64Stalls);
+    }
+
+    dSim = (double)(psMachine->sBoard.ui64Time - ui64Start) /
+           SIM_PS_PER_SECOND;
+    dHost = (double)(sEnd.tv_sec - sStart.tv_sec) +
+            (double)(sEnd.tv_nsec - sStart.tv_nsec) / 1e9;
+
+    if(g_bEdges)
+        printf("\n");
+
+    for(ui32Port = 0; ui32Port < SIM_GPIO_PORTS; ui32Port++)
+    {
+        for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+        {
+            psPin = &g_psPins[ui32Port][ui32Pin];
+
+            if(!psPin->ui64Edges)
+                continue;
+
+            printf("P%c%u: %llu edges", 'A' + ui32Port, ui32Pin,
+                   (unsigned long long)psPin->ui64Edges);
+
+            if(psPin->ui64Edges > 1)
+                printf(", %.6f s between edges",
+                       (double)(psPin->ui64Last - psPin->ui64First) /
+                       (psPin->ui64Edges - 1) / SIM_PS_PER_SECOND);
+
+            printf("\n");
+        }
+    }
+
+    if(eStop != SIM_CPU_DONE)
+    {
+        psSymbol = SimElfSymbolAt(&sElf, psMachine->sCpu.ui32PC);
+        printf("%s at 0x%08x", ppcStop[eStop], psMachine->sCpu.ui32PC);
+
+        if(psSymbol)
+            printf(" (%s+0x%x)", psSymbol->pcName,
+                   psMachine->sCpu.ui32PC - psSymbol->ui32Value);
+
+        printf(", IPSR %u, CFSR 0x%08x, HFSR 0x%08x, BFAR 0x%08x\n",
+               psMachine->sCpu.ui32IPSR, psMachine->sBoard.sNVIC.ui32CFSR,
+               psMachine->sBoard.sNVIC.ui32HFSR,
+               psMachine->sBoard.sNVIC.ui32BFAR);
+    }
+
+    IssHibReport(&psMachine->sBoard, dSim);
+
+    printf("%llu instructions, %llu cycles asleep, %u exceptions, "
+           "%u resets\n",
+           (unsigned long long)psMachine->sCpu.ui64Insns,
+           (unsigned long long)psMachine->sCpu.ui64SleepCycles,
+           psMachine->sCpu.ui32Exceptions, psMachine->sCpu.ui32Resets);
+    printf("simulated %.6f s in %.6f s (%.0fx real time, %.1f MIPS)\n", dSim,
+           dHost, dHost > 0 ? dSim / dHost : 0.0,
+           dHost > 0 ? psMachine->sCpu.ui64Insns / dHost / 1e6 : 0.0);
+
+    if(psMachine->psIdle)
+        printf("%llu cycles skipped in %llu idle loop runs\n",
+               (unsigned long long)psMachine->psIdle->ui64Cycles,
+               (unsigned long long)psMachine->psIdle->ui64Skips);
+
+    if(psMachine->psTiming)
+        IssTimingReport(psMachine, &sElf);
+
+    if(psMachine->psShadow)
+        IssShadowReport(psMachine->psShadow, &sElf);
+
+    if(psMachine->psTrace)
+    {
+        printf("%llu register accesses traced in %llu bytes\n",
+               (unsigned long long)psMachine->psTrace->ui64Records,
+               (unsigned long long)(psMachine->psTrace->ui64Written +
+                                    psMachine->psTrace->ui32Buffered));
+
+        if(!SimTraceClose(psMachine))
+            fprintf(stderr, "%s: write error\n", pcTrace);
+    }
+
+    if(psMachine->psProfile)
+    {
+        IssProfileReport(psMachine->psProfile, &sElf);
+
+        if(!SimProfileFold(psMachine->psProfile, pcFlame))
+            fprintf(stderr, "%s: write error\n", pcFlame);
+    }
+
+    if(pcRecord || pcReplay)
+    {
+        printf("%llu inputs %s", (unsigned long long)psReplay->ui64Records,
+               SimReplaying(psReplay) ? "replayed" : "recorded");
+
+        if(psReplay->ui64Divergences)
+            printf(", %llu diverged, first at cycle %llu",
+                   (unsigned long long)psReplay->ui64Divergences,
+                   (unsigned long long)psReplay->ui64Diverged);
+
+        printf("\n");
+    }
+
+    if(ui64Seek && (psMachine->sBoard.ui64Cycle >= ui64Seek))
+        IssRegisters(psMachine, &sElf);
+
+    if(psMachine->psTranslator)
+        printf("%u blocks, %zu bytes of host code, %llu instructions "
+               "translated inline, %llu called, %u flushes\n",
+               psMachine->psTranslator->ui32Blocks,
+               psMachine->psTranslator->szUsed,
+               (unsigned long long)psMachine->psTranslator->ui64Native,
+               (unsigned long long)psMachine->psTranslator->ui64Calls,
+               psMachine->psTranslator->ui32Flushes);
+
+    if(!SimReplayClose(psReplay))
+        fprintf(stderr, "%s: write error\n", pcRecord);
+
+    if(pcSave)
+    {
+        psSnapshot = SimSnapshotTake(psMachine);
+
+        if(!psSnapshot || !SimSnapshotSave(psSnapshot, pcSave))
+            fprintf(stderr, "%s: cannot write\n", pcSave);
+
+        SimSnapshotFree(psSnapshot);
+    }
+
+    SimCpuFree(psMachine);
+    free(psMachine);
+    SimElfClose(&sElf);
+
+    return((eStop == SIM_CPU_DONE) ? 0 : 1);
+}
@@ -0,0 +1,308 @@
+/*
+ * Rebuilds the text of the deferred log records a firmware built with
+ * UART_LOG_DEFERRED sends over its console UART (see uartlog.h of the CCS
+ * projects), from the format strings in the ELF image of the firmware.
+ *
+ * The bytes received, from a file or the standard input, are copied to the
+ * standard output, except that a record is replaced by its format string
+ * with the arguments put in the way UARTprintf() would.  A byte that looks
+ * like the start of a record is only taken as one if the address after it is
+ * that of a format string, in the .uartlog section if the image has one,
+ * taking as many arguments as the record holds; anything else is text.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../sim/elf.h"
+
+/*
+ * Must match uartlog.h.
+ */
+#define LOG_MARK                0xF0
+#define LOG_ARGS_MAX            3
+#define LOG_RECORD_MAX          (4 + 4 * LOG_ARGS_MAX)
+
+typedef struct
+{
+    tSimElf sElf;
+
+    /*
+     * Where format strings are taken from, the whole image if ui32Size is
+     * zero.
+     */
+    uint32_t ui32Addr;
+    uint32_t ui32Size;
+
+    uint64_t ui64Records;
+} tLog;
+
+/*
+ * Returns the string at an address of the image, or NULL if there is no
+ * string there.
+ */
+static const char *
+LogString(const tLog *psLog, uint32_t ui32Addr)
+{
+    const char *pcString;
+    uint32_t ui32Size;
+
+    pcString = SimElfData(&psLog->sElf, ui32Addr, &ui32Size);
+
+    if(!pcString || !memchr(pcString, 0, ui32Size))
+        return(NULL);
+
+    return(pcString);
+}
+
+/*
+ * Goes through a conversion of a format string, returning its character and
+ * setting its width and fill, and moving *ppcFormat past it.
+ */
+static char
+LogConversion(const char **ppcFormat, uint32_t *pui32Width, char *pcFill)
+{
+    const char *pcFormat = *ppcFormat;
+
+    *pui32Width = 0;
+    *pcFill = ' ';
+
+    while((*pcFormat >= '0') && (*pcFormat <= '9'))
+    {
+        if((*pcFormat == '0') && !*pui32Width)
+            *pcFill = '0';
+
+        *pui32Width = *pui32Width * 10 + (uint32_t)(*pcFormat++ - '0');
+    }
+
+    *ppcFormat = *pcFormat ? pcFormat + 1 : pcFormat;
+
+    return(*pcFormat);
+}
+
+/*
+ * Returns the number of arguments a format string takes.
+ */
+static uint32_t
+LogArguments(const char *pcFormat)
+{
+    uint32_t ui32Count = 0, ui32Width;
+    char cFill, cConversion;
+
+    while((pcFormat = strchr(pcFormat, '%')) != NULL)
+    {
+        pcFormat++;
+        cConversion = LogConversion(&pcFormat, &ui32Width, &cFill);
+
+        if(cConversion && strchr("cdisuxXp", cConversion))
+            ui32Count++;
+        else if(!cConversion)
+            break;
+    }
+
+    return(ui32Count);
+}
+
+/*
+ * Prints a format string with its arguments, as UARTvprintf() does: hex in
+ * lower case whatever the conversion, strings padded on the right.
+ */
+static void
+LogPrint(const tLog *psLog, const char *pcFormat, const uint32_t *pui32Args)
+{
+    const char *pcString;
+    uint32_t ui32Width;
+    char cFill, cConversion;
+
+    while(*pcFormat)
+    {
+        if(*pcFormat != '%')
+        {
+            putchar(*pcFormat++);
+            continue;
+        }
+
+        pcFormat++;
+        cConversion = LogConversion(&pcFormat, &ui32Width, &cFill);
+
+        switch(cConversion)
+        {
+            case 'c':
+                putchar((int)(*pui32Args++ & 0xFF));
+                break;
+
+            case 'd':
+            case 'i':
+                printf((cFill == '0') ? "%0*d" : "%*d", (int)ui32Width,
+                       (int32_t)*pui32Args++);
+                break;
+
+            case 'u':
+                printf((cFill == '0') ? "%0*u" : "%*u", (int)ui32Width,
+                       *pui32Args++);
+                break;
+
+            case 'x':
+            case 'X':
+            case 'p':
+                printf((cFill == '0') ? "%0*x" : "%*x", (int)ui32Width,
+                       *pui32Args++);
+                break;
+
+            case 's':
+                pcString = LogString(psLog, *pui32Args);
+
+                if(pcString)
+                    printf("%-*s", (int)ui32Width, pcString);
+                else
+                    printf("<0x%08x>", *pui32Args);
+
+                pui32Args++;
+                break;
+
+            case '%':
+                putchar('%');
+                break;
+
+            case 0:
+                return;
+
+            default:
+                fputs("ERROR", stdout);
+                break;
+        }
+    }
+}
+
+/*
+ * Decodes the record at the start of pui8Bytes, of which ui32Bytes are
+ * available.  Returns the size of the record, 0 if the bytes are not one, or
+ * -1 if more bytes are needed to tell.
+ */
+static int
+LogRecord(tLog *psLog, const uint8_t *pui8Bytes, uint32_t ui32Bytes)
+{
+    uint32_t pui32Args[LOG_ARGS_MAX], ui32Args, ui32Addr, ui32Idx;
+    const char *pcFormat;
+
+    if((pui8Bytes[0] & ~LOG_ARGS_MAX) != LOG_MARK)
+        return(0);
+
+    ui32Args = pui8Bytes[0] & LOG_ARGS_MAX;
+
+    if(ui32Bytes < 4 + 4 * ui32Args)
+        return(-1);
+
+    ui32Addr = pui8Bytes[1] | (pui8Bytes[2] << 8) | (pui8Bytes[3] << 16);
+
+    if(psLog->ui32Size &&
+       ((ui32Addr < psLog->ui32Addr) ||
+        (ui32Addr - psLog->ui32Addr >= psLog->ui32Size)))
+        return(0);
+
+    pcFormat = LogString(psLog, ui32Addr);
+
+    if(!pcFormat || (LogArguments(pcFormat) != ui32Args))
+        return(0);
+
+    for(ui32Idx = 0; ui32Idx < ui32Args; ui32Idx++)
+        pui32Args[ui32Idx] = (uint32_t)pui8Bytes[4 + ui32Idx * 4] |
+                             ((uint32_t)pui8Bytes[5 + ui32Idx * 4] << 8) |
+                             ((uint32_t)pui8Bytes[6 + ui32Idx * 4] << 16) |
+                             ((uint32_t)pui8Bytes[7 + ui32Idx * 4] << 24);
+
+    LogPrint(psLog, pcFormat, pui32Args);
+    psLog->ui64Records++;
+
+    return((int)(4 + 4 * ui32Args));
+}
+
+/*
+ * Copies the input to the output, decoding the records in it.
+ */
+static void
+LogDecode(tLog *psLog, FILE *psInput)
+{
+    uint8_t pui8Window[LOG_RECORD_MAX];
+    uint32_t ui32Bytes = 0;
+    bool bEnd = false;
+    int i32Char, i32Size;
+
+    while(!bEnd || ui32Bytes)
+    {
+        /*
+         * Keep the window full enough to hold the largest record.
+         */
+        while(!bEnd && (ui32Bytes < LOG_RECORD_MAX))
+        {
+            if((i32Char = getc(psInput)) == EOF)
+                bEnd = true;
+            else
+                pui8Window[ui32Bytes++] = (uint8_t)i32Char;
+        }
+
+        i32Size = LogRecord(psLog, pui8Window, ui32Bytes);
+
+        /*
+         * A record cut short by the end of the input is text.
+         */
+        if(i32Size <= 0)
+        {
+            putchar(pui8Window[0]);
+            i32Size = 1;
+        }
+
+        ui32Bytes -= (uint32_t)i32Size;
+        memmove(pui8Window, pui8Window + i32Size, ui32Bytes);
+    }
+}
+
+static void
+Usage(const char *pcName)
+{
+    fprintf(stderr, "Usage: %s firmware.elf [capture]\n", pcName);
+    exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+    tLog sLog;
+    FILE *psInput = stdin;
+
+    if((argc != 2) && (argc != 3))
+        Usage(argv[0]);
+
+    memset(&sLog, 0, sizeof(sLog));
+
+    if(!SimElfOpen(&sLog.sElf, argv[1]))
+    {
+        fprintf(stderr, "%s: %s\n", argv[1], sLog.sElf.pcError);
+        return(1);
+    }
+
+    if(!SimElfSection(&sLog.sElf, ".uartlog", &sLog.ui32Addr,
+                      &sLog.ui32Size))
+        fprintf(stderr, "%s: no .uartlog section, taking format strings from "
+                "anywhere in the image\n", argv[1]);
+
+    if((argc == 3) && strcmp(argv[2], "-") &&
+       !(psInput = fopen(argv[2], "rb")))
+    {
+        fprintf(stderr, "%s: cannot open\n", argv[2]);
+        SimElfClose(&sLog.sElf);
+        return(1);
+    }
+
+    LogDecode(&sLog, psInput);
+
+    fflush(stdout);
+    fprintf(stderr, "%llu records\n", (unsigned long long)sLog.ui64Records);
+
+    if(psInput != stdin)
+        fclose(psInput);
+
+    SimElfClose(&sLog.sElf);
+
+    return(0);
+}
@@ -0,0 +1,207 @@
+/*
+ * Host version of TivaWare's driverlib/adc.c.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/adc.h"
+#include "driverlib/interrupt.h"
+#include "../native.h"
+
+#define ADC_O_ACTSS             0x000
+#define ADC_O_RIS               0x004
+#define ADC_O_IM                0x008
+#define ADC_O_ISC               0x00C
+#define ADC_O_OSTAT             0x010
+#define ADC_O_EMUX              0x014
+#define ADC_O_USTAT             0x018
+#define ADC_O_SSPRI             0x020
+#define ADC_O_PSSI              0x028
+#define ADC_O_SSMUX0            0x040
+
+/*
+ * Registers of sequencer n lie at ADC_O_SSMUX0 + n * ADC_SEQ_STRIDE.
+ */
+#define ADC_SEQ_STRIDE          0x020
+#define ADC_SEQ_O_MUX           0x000
+#define ADC_SEQ_O_CTL           0x004
+#define ADC_SEQ_O_FIFO          0x008
+#define ADC_SEQ_O_FSTAT         0x00C
+
+#define ADC_ACTSS_BUSY          0x00010000
+#define ADC_SSFSTAT_EMPTY       0x00000100
+
+/*
+ * Deepest sequencer FIFO.
+ */
+#define ADC_FIFO_MAX            8
+
+static uint32_t
+ADCSeqReg(uint32_t ui32Base, uint32_t ui32SequenceNum, uint32_t ui32Offset)
+{
+    return(ui32Base + ADC_O_SSMUX0 + (ui32SequenceNum & 3) * ADC_SEQ_STRIDE +
+           ui32Offset);
+}
+
+static uint32_t
+ADCIntNumberGet(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    return(((ui32Base == ADC0_BASE) ? INT_ADC0SS0 : INT_ADC1SS0) +
+           (ui32SequenceNum & 3));
+}
+
+static void
+ADCModify(uint32_t ui32Reg, uint32_t ui32Clear, uint32_t ui32Set)
+{
+    SimNativeWrite(ui32Reg, (SimNativeRead(ui32Reg) & ~ui32Clear) | ui32Set);
+}
+
+void
+ADCIntRegister(uint32_t ui32Base, uint32_t ui32SequenceNum,
+               void (*pfnHandler)(void))
+{
+    uint32_t ui32Int = ADCIntNumberGet(ui32Base, ui32SequenceNum);
+
+    IntRegister(ui32Int, pfnHandler);
+    IntEnable(ui32Int);
+}
+
+void
+ADCIntUnregister(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    uint32_t ui32Int = ADCIntNumberGet(ui32Base, ui32SequenceNum);
+
+    IntDisable(ui32Int);
+    IntUnregister(ui32Int);
+}
+
+void
+ADCIntDisable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    ADCModify(ui32Base + ADC_O_IM, 1U << ui32SequenceNum, 0);
+}
+
+/*
+ * Enables a sequencer's interrupt, discarding a request left over from
+ * before.
+ */
+void
+ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    SimNativeWrite(ui32Base + ADC_O_ISC, 1U << ui32SequenceNum);
+    ADCModify(ui32Base + ADC_O_IM, 0, 1U << ui32SequenceNum);
+}
+
+uint32_t
+ADCIntStatus(uint32_t ui32Base, uint32_t ui32SequenceNum, bool bMasked)
+{
+    uint32_t ui32Reg = bMasked ? ADC_O_ISC : ADC_O_RIS;
+
+    return(SimNativeRead(ui32Base + ui32Reg) & (1U << ui32SequenceNum));
+}
+
+void
+ADCIntClear(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    SimNativeWrite(ui32Base + ADC_O_ISC, 1U << ui32SequenceNum);
+}
+
+void
+ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    ADCModify(ui32Base + ADC_O_ACTSS, 0, 1U << (ui32SequenceNum & 3));
+}
+
+void
+ADCSequenceDisable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    ADCModify(ui32Base + ADC_O_ACTSS, 1U << (ui32SequenceNum & 3), 0);
+}
+
+void
+ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                     uint32_t ui32Trigger, uint32_t ui32Priority)
+{
+    uint32_t ui32Shift = (ui32SequenceNum & 3) * 4;
+
+    ADCModify(ui32Base + ADC_O_EMUX, 0xFU << ui32Shift,
+              (ui32Trigger & 0xF) << ui32Shift);
+    ADCModify(ui32Base + ADC_O_SSPRI, 0xFU << ui32Shift,
+              (ui32Priority & 0x3) << ui32Shift);
+}
+
+/*
+ * Configures one step: the low nibble of ui32Config selects the input, the
+ * next holds the TS, IE, END and D flags in SSCTL order.
+ */
+void
+ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                         uint32_t ui32Step, uint32_t ui32Config)
+{
+    uint32_t ui32Shift = (ui32Step & 7) * 4;
+
+    ADCModify(ADCSeqReg(ui32Base, ui32SequenceNum, ADC_SEQ_O_MUX),
+              0xFU << ui32Shift, (ui32Config & 0xF) << ui32Shift);
+    ADCModify(ADCSeqReg(ui32Base, ui32SequenceNum, ADC_SEQ_O_CTL),
+              0xFU << ui32Shift, ((ui32Config & 0xF0) >> 4) << ui32Shift);
+}
+
+int32_t
+ADCSequenceOverflow(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    return(SimNativeRead(ui32Base + ADC_O_OSTAT) & (1U << ui32SequenceNum));
+}
+
+void
+ADCSequenceOverflowClear(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    SimNativeWrite(ui32Base + ADC_O_OSTAT, 1U << ui32SequenceNum);
+}
+
+int32_t
+ADCSequenceUnderflow(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    return(SimNativeRead(ui32Base + ADC_O_USTAT) & (1U << ui32SequenceNum));
+}
+
+void
+ADCSequenceUnderflowClear(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    SimNativeWrite(ui32Base + ADC_O_USTAT, 1U << ui32SequenceNum);
+}
+
+/*
+ * Drains the sequencer FIFO into pui32Buffer and returns the number of
+ * samples read.
+ */
+int32_t
+ADCSequenceDataGet(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                   uint32_t *pui32Buffer)
+{
+    uint32_t ui32Count = 0;
+
+    while(!(SimNativeRead(ADCSeqReg(ui32Base, ui32SequenceNum,
+                                    ADC_SEQ_O_FSTAT)) & ADC_SSFSTAT_EMPTY) &&
+          (ui32Count < ADC_FIFO_MAX))
+    {
+        *pui32Buffer++ = SimNativeRead(ADCSeqReg(ui32Base, ui32SequenceNum,
+                                                 ADC_SEQ_O_FIFO));
+        ui32Count++;
+    }
+
+    return(ui32Count);
+}
+
+void
+ADCProcessorTrigger(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    SimNativeWrite(ui32Base + ADC_O_PSSI, 1U << (ui32SequenceNum & 0xF));
+}
+
+bool
+ADCBusy(uint32_t ui32Base)
+{
+    return((SimNativeRead(ui32Base + ADC_O_ACTSS) & ADC_ACTSS_BUSY) != 0);
+}
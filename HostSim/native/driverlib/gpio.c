@@ -0,0 +1,271 @@
+/*
+ * Host version of TivaWare's driverlib/gpio.c.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "../native.h"
+
+#define GPIO_O_DATA             0x000
+#define GPIO_O_DIR              0x400
+#define GPIO_O_IS               0x404
+#define GPIO_O_IBE              0x408
+#define GPIO_O_IEV              0x40C
+#define GPIO_O_IM               0x410
+#define GPIO_O_RIS              0x414
+#define GPIO_O_MIS              0x418
+#define GPIO_O_ICR              0x41C
+#define GPIO_O_AFSEL            0x420
+#define GPIO_O_DR2R             0x500
+#define GPIO_O_DR4R             0x504
+#define GPIO_O_DR8R             0x508
+#define GPIO_O_ODR              0x50C
+#define GPIO_O_PUR              0x510
+#define GPIO_O_PDR              0x514
+#define GPIO_O_SLR              0x518
+#define GPIO_O_DEN              0x51C
+#define GPIO_O_AMSEL            0x528
+#define GPIO_O_PCTL             0x52C
+
+/*
+ * Ports by the index used in pin configurations, with their interrupts.
+ */
+static const uint32_t g_pui32GPIOBase[] =
+{
+    GPIO_PORTA_BASE, GPIO_PORTB_BASE, GPIO_PORTC_BASE,
+    GPIO_PORTD_BASE, GPIO_PORTE_BASE, GPIO_PORTF_BASE
+};
+
+static const uint32_t g_pui32GPIOAHBBase[] =
+{
+    GPIO_PORTA_AHB_BASE, GPIO_PORTB_AHB_BASE, GPIO_PORTC_AHB_BASE,
+    GPIO_PORTD_AHB_BASE, GPIO_PORTE_AHB_BASE, GPIO_PORTF_AHB_BASE
+};
+
+static const uint8_t g_pui8GPIOInt[] =
+{
+    INT_GPIOA, INT_GPIOB, INT_GPIOC, INT_GPIOD, INT_GPIOE, INT_GPIOF
+};
+
+#define NUM_GPIO_PORTS  (sizeof(g_pui32GPIOBase) / sizeof(g_pui32GPIOBase[0]))
+
+/*
+ * Sets or clears the bits in ui8Pins of a register.
+ */
+static void
+GPIOModify(uint32_t ui32Reg, uint8_t ui8Pins, bool bSet)
+{
+    uint32_t ui32Value = SimNativeRead(ui32Reg);
+
+    SimNativeWrite(ui32Reg, bSet ? (ui32Value | ui8Pins) :
+                                   (ui32Value & ~ui8Pins));
+}
+
+static uint32_t
+GPIOIntNumberGet(uint32_t ui32Port)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NUM_GPIO_PORTS; ui32Idx++)
+        if((g_pui32GPIOBase[ui32Idx] == ui32Port) ||
+           (g_pui32GPIOAHBBase[ui32Idx] == ui32Port))
+            return(g_pui8GPIOInt[ui32Idx]);
+
+    return(0);
+}
+
+void
+GPIODirModeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32PinIO)
+{
+    GPIOModify(ui32Port + GPIO_O_DIR, ui8Pins, ui32PinIO & 1);
+    GPIOModify(ui32Port + GPIO_O_AFSEL, ui8Pins, ui32PinIO & 2);
+}
+
+uint32_t
+GPIODirModeGet(uint32_t ui32Port, uint8_t ui8Pin)
+{
+    uint32_t ui32Bit = 1U << ui8Pin;
+
+    return(((SimNativeRead(ui32Port + GPIO_O_DIR) & ui32Bit) ? 1 : 0) |
+           ((SimNativeRead(ui32Port + GPIO_O_AFSEL) & ui32Bit) ? 2 : 0));
+}
+
+void
+GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType)
+{
+    GPIOModify(ui32Port + GPIO_O_IBE, ui8Pins, ui32IntType & 1);
+    GPIOModify(ui32Port + GPIO_O_IS, ui8Pins, ui32IntType & 2);
+    GPIOModify(ui32Port + GPIO_O_IEV, ui8Pins, ui32IntType & 4);
+}
+
+uint32_t
+GPIOIntTypeGet(uint32_t ui32Port, uint8_t ui8Pin)
+{
+    uint32_t ui32Bit = 1U << ui8Pin;
+
+    return(((SimNativeRead(ui32Port + GPIO_O_IBE) & ui32Bit) ? 1 : 0) |
+           ((SimNativeRead(ui32Port + GPIO_O_IS) & ui32Bit) ? 2 : 0) |
+           ((SimNativeRead(ui32Port + GPIO_O_IEV) & ui32Bit) ? 4 : 0));
+}
+
+void
+GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength,
+                 uint32_t ui32PadType)
+{
+    GPIOModify(ui32Port + GPIO_O_DR2R, ui8Pins, ui32Strength & 1);
+    GPIOModify(ui32Port + GPIO_O_DR4R, ui8Pins, ui32Strength & 2);
+    GPIOModify(ui32Port + GPIO_O_DR8R, ui8Pins, ui32Strength & 4);
+    GPIOModify(ui32Port + GPIO_O_SLR, ui8Pins, ui32Strength & 8);
+
+    GPIOModify(ui32Port + GPIO_O_ODR, ui8Pins, ui32PadType & 1);
+    GPIOModify(ui32Port + GPIO_O_PUR, ui8Pins, ui32PadType & 2);
+    GPIOModify(ui32Port + GPIO_O_PDR, ui8Pins, ui32PadType & 4);
+    GPIOModify(ui32Port + GPIO_O_DEN, ui8Pins, ui32PadType & 8);
+
+    /*
+     * Only the analog pad type connects the pin to the ADC.
+     */
+    GPIOModify(ui32Port + GPIO_O_AMSEL, ui8Pins,
+               ui32PadType == GPIO_PIN_TYPE_ANALOG);
+}
+
+void
+GPIOPadConfigGet(uint32_t ui32Port, uint8_t ui8Pin, uint32_t *pui32Strength,
+                 uint32_t *pui32PadType)
+{
+    uint32_t ui32Bit = 1U << ui8Pin;
+
+    *pui32Strength =
+        ((SimNativeRead(ui32Port + GPIO_O_DR2R) & ui32Bit) ? 1 : 0) |
+        ((SimNativeRead(ui32Port + GPIO_O_DR4R) & ui32Bit) ? 2 : 0) |
+        ((SimNativeRead(ui32Port + GPIO_O_DR8R) & ui32Bit) ? 4 : 0) |
+        ((SimNativeRead(ui32Port + GPIO_O_SLR) & ui32Bit) ? 8 : 0);
+
+    *pui32PadType =
+        ((SimNativeRead(ui32Port + GPIO_O_ODR) & ui32Bit) ? 1 : 0) |
+        ((SimNativeRead(ui32Port + GPIO_O_PUR) & ui32Bit) ? 2 : 0) |
+        ((SimNativeRead(ui32Port + GPIO_O_PDR) & ui32Bit) ? 4 : 0) |
+        ((SimNativeRead(ui32Port + GPIO_O_DEN) & ui32Bit) ? 8 : 0);
+}
+
+void
+GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    GPIOModify(ui32Port + GPIO_O_IM, (uint8_t)ui32IntFlags, true);
+}
+
+void
+GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    GPIOModify(ui32Port + GPIO_O_IM, (uint8_t)ui32IntFlags, false);
+}
+
+uint32_t
+GPIOIntStatus(uint32_t ui32Port, bool bMasked)
+{
+    return(SimNativeRead(ui32Port + (bMasked ? GPIO_O_MIS : GPIO_O_RIS)));
+}
+
+void
+GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    SimNativeWrite(ui32Port + GPIO_O_ICR, ui32IntFlags);
+}
+
+void
+GPIOIntRegister(uint32_t ui32Port, void (*pfnIntHandler)(void))
+{
+    uint32_t ui32Int = GPIOIntNumberGet(ui32Port);
+
+    IntRegister(ui32Int, pfnIntHandler);
+    IntEnable(ui32Int);
+}
+
+void
+GPIOIntUnregister(uint32_t ui32Port)
+{
+    uint32_t ui32Int = GPIOIntNumberGet(ui32Port);
+
+    IntDisable(ui32Int);
+    IntUnregister(ui32Int);
+}
+
+int32_t
+GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    return(SimNativeRead(ui32Port + GPIO_O_DATA + (ui8Pins << 2)));
+}
+
+void
+GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    SimNativeWrite(ui32Port + GPIO_O_DATA + (ui8Pins << 2), ui8Val);
+}
+
+/*
+ * Selects the alternate function of one pin.  The configuration holds the
+ * port index, the shift of the pin's PCTL field and the function number.
+ */
+void
+GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    uint32_t ui32Port = (ui32PinConfig >> 16) & 0xFF;
+    uint32_t ui32Shift = (ui32PinConfig >> 8) & 0xFF;
+    uint32_t ui32Base, ui32PCTL;
+
+    if(ui32Port >= NUM_GPIO_PORTS)
+        return;
+
+    ui32Base = g_pui32GPIOBase[ui32Port];
+    ui32PCTL = SimNativeRead(ui32Base + GPIO_O_PCTL);
+    ui32PCTL &= ~(0xFU << ui32Shift);
+    ui32PCTL |= (ui32PinConfig & 0xF) << ui32Shift;
+    SimNativeWrite(ui32Base + GPIO_O_PCTL, ui32PCTL);
+}
+
+void
+GPIOPinTypeADC(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_IN);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA,
+                     GPIO_PIN_TYPE_ANALOG);
+}
+
+void
+GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_IN);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
+
+void
+GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_OUT);
+}
+
+void
+GPIOPinTypeGPIOOutputOD(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_OD);
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_OUT);
+}
+
+void
+GPIOPinTypeTimer(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_HW);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
+
+void
+GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    GPIODirModeSet(ui32Port, ui8Pins, GPIO_DIR_MODE_HW);
+    GPIOPadConfigSet(ui32Port, ui8Pins, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD);
+}
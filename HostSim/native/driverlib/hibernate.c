@@ -0,0 +1,248 @@
+/*
+ * Host version of TivaWare's driverlib/hibernate.c.
+ *
+ * Requesting hibernation powers the simulated chip down; the firmware comes
+ * back through reset when a wake source fires.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/hibernate.h"
+#include "driverlib/interrupt.h"
+#include "../native.h"
+
+#define HIB_RTCC                0x400FC000
+#define HIB_RTCM0               0x400FC004
+#define HIB_RTCLD               0x400FC00C
+#define HIB_CTL                 0x400FC010
+#define HIB_IM                  0x400FC014
+#define HIB_RIS                 0x400FC018
+#define HIB_MIS                 0x400FC01C
+#define HIB_IC                  0x400FC020
+#define HIB_RTCT                0x400FC024
+#define HIB_RTCSS               0x400FC028
+#define HIB_DATA                0x400FC030
+
+#define HIB_CTL_WRC             0x80000000
+#define HIB_CTL_RETCLR          0x40000000
+#define HIB_CTL_VDD3ON          0x00000100
+#define HIB_CTL_CLK32EN         0x00000040
+#define HIB_CTL_PINWEN          0x00000010
+#define HIB_CTL_RTCWEN          0x00000008
+#define HIB_CTL_HIBREQ          0x00000002
+#define HIB_CTL_RTCEN           0x00000001
+
+#define HIB_RTCSS_RTCSSC_M      0x00007FFF
+
+#define HIB_DATA_WORDS          16
+
+/*
+ * Waits until the module has taken the previous write.
+ */
+static void
+HibernateWriteComplete(void)
+{
+    while(!(SimNativeRead(HIB_CTL) & HIB_CTL_WRC))
+    {
+        SimNativeWait();
+    }
+}
+
+static void
+HibernateModify(uint32_t ui32Reg, uint32_t ui32Clear, uint32_t ui32Set)
+{
+    SimNativeWrite(ui32Reg, ((SimNativeRead(ui32Reg) & ~ui32Clear) |
+                             ui32Set) & ~HIB_CTL_WRC);
+    HibernateWriteComplete();
+}
+
+void
+HibernateEnableExpClk(uint32_t ui32HibClk)
+{
+    HibernateModify(HIB_CTL, 0, HIB_CTL_CLK32EN);
+}
+
+void
+HibernateDisable(void)
+{
+    HibernateModify(HIB_CTL, HIB_CTL_CLK32EN, 0);
+}
+
+bool
+HibernateIsActive(void)
+{
+    return((SimNativeRead(HIB_CTL) & HIB_CTL_CLK32EN) != 0);
+}
+
+void
+HibernateRTCEnable(void)
+{
+    HibernateModify(HIB_CTL, 0, HIB_CTL_RTCEN);
+}
+
+void
+HibernateRTCDisable(void)
+{
+    HibernateModify(HIB_CTL, HIB_CTL_RTCEN, 0);
+}
+
+void
+HibernateRTCSet(uint32_t ui32RTCValue)
+{
+    SimNativeWrite(HIB_RTCLD, ui32RTCValue);
+    HibernateWriteComplete();
+}
+
+uint32_t
+HibernateRTCGet(void)
+{
+    return(SimNativeRead(HIB_RTCC));
+}
+
+void
+HibernateRTCMatchSet(uint32_t ui32Match, uint32_t ui32Value)
+{
+    /*
+     * The TM4C123 has a single match register.
+     */
+    if(ui32Match != 0)
+        return;
+
+    SimNativeWrite(HIB_RTCM0, ui32Value);
+    HibernateWriteComplete();
+}
+
+uint32_t
+HibernateRTCMatchGet(uint32_t ui32Match)
+{
+    return((ui32Match == 0) ? SimNativeRead(HIB_RTCM0) : 0);
+}
+
+uint32_t
+HibernateRTCSSGet(void)
+{
+    return(SimNativeRead(HIB_RTCSS) & HIB_RTCSS_RTCSSC_M);
+}
+
+void
+HibernateRTCTrimSet(uint32_t ui32Trim)
+{
+    SimNativeWrite(HIB_RTCT, ui32Trim);
+    HibernateWriteComplete();
+}
+
+uint32_t
+HibernateRTCTrimGet(void)
+{
+    return(SimNativeRead(HIB_RTCT));
+}
+
+void
+HibernateWakeSet(uint32_t ui32WakeFlags)
+{
+    HibernateModify(HIB_CTL, HIB_CTL_PINWEN | HIB_CTL_RTCWEN,
+                    ui32WakeFlags & (HIBERNATE_WAKE_PIN |
+                                     HIBERNATE_WAKE_RTC));
+}
+
+uint32_t
+HibernateWakeGet(void)
+{
+    return(SimNativeRead(HIB_CTL) & (HIBERNATE_WAKE_PIN | HIBERNATE_WAKE_RTC));
+}
+
+void
+HibernateGPIORetentionEnable(void)
+{
+    HibernateModify(HIB_CTL, 0, HIB_CTL_VDD3ON | HIB_CTL_RETCLR);
+}
+
+void
+HibernateGPIORetentionDisable(void)
+{
+    HibernateModify(HIB_CTL, HIB_CTL_VDD3ON | HIB_CTL_RETCLR, 0);
+}
+
+bool
+HibernateGPIORetentionGet(void)
+{
+    return((SimNativeRead(HIB_CTL) & (HIB_CTL_VDD3ON | HIB_CTL_RETCLR)) ==
+           (HIB_CTL_VDD3ON | HIB_CTL_RETCLR));
+}
+
+void
+HibernateDataSet(uint32_t *pui32Data, uint32_t ui32Count)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; (ui32Idx < ui32Count) && (ui32Idx < HIB_DATA_WORDS);
+        ui32Idx++)
+    {
+        SimNativeWrite(HIB_DATA + ui32Idx * 4, pui32Data[ui32Idx]);
+        HibernateWriteComplete();
+    }
+}
+
+void
+HibernateDataGet(uint32_t *pui32Data, uint32_t ui32Count)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; (ui32Idx < ui32Count) && (ui32Idx < HIB_DATA_WORDS);
+        ui32Idx++)
+        pui32Data[ui32Idx] = SimNativeRead(HIB_DATA + ui32Idx * 4);
+}
+
+/*
+ * Powers the chip down.  On the target the write takes effect after a few
+ * cycles; on the host it does not return, as the next thing the firmware
+ * does is start again from reset.
+ */
+void
+HibernateRequest(void)
+{
+    HibernateModify(HIB_CTL, 0, HIB_CTL_HIBREQ);
+}
+
+void
+HibernateIntEnable(uint32_t ui32IntFlags)
+{
+    SimNativeWrite(HIB_IM, SimNativeRead(HIB_IM) | ui32IntFlags);
+    HibernateWriteComplete();
+}
+
+void
+HibernateIntDisable(uint32_t ui32IntFlags)
+{
+    SimNativeWrite(HIB_IM, SimNativeRead(HIB_IM) & ~ui32IntFlags);
+    HibernateWriteComplete();
+}
+
+void
+HibernateIntRegister(void (*pfnHandler)(void))
+{
+    IntRegister(INT_HIBERNATE, pfnHandler);
+    IntEnable(INT_HIBERNATE);
+}
+
+void
+HibernateIntUnregister(void)
+{
+    IntDisable(INT_HIBERNATE);
+    IntUnregister(INT_HIBERNATE);
+}
+
+uint32_t
+HibernateIntStatus(bool bMasked)
+{
+    return(SimNativeRead(bMasked ? HIB_MIS : HIB_RIS));
+}
+
+void
+HibernateIntClear(uint32_t ui32IntFlags)
+{
+    SimNativeWrite(HIB_IC, ui32IntFlags);
+    HibernateWriteComplete();
+}
@@ -0,0 +1,264 @@
+/*
+ * Host version of TivaWare's driverlib/interrupt.c.
+ *
+ * Handlers are registered in the runtime's vector table; the enables,
+ * pending bits and priorities are those of the simulated NVIC.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_ints.h"
+#include "driverlib/interrupt.h"
+#include "../native.h"
+
+#define NVIC_EN0                0xE000E100
+#define NVIC_DIS0               0xE000E180
+#define NVIC_PEND0              0xE000E200
+#define NVIC_UNPEND0            0xE000E280
+#define NVIC_PRI0               0xE000E400
+#define NVIC_INT_CTRL           0xE000ED04
+#define NVIC_APINT              0xE000ED0C
+#define NVIC_SYS_PRI1           0xE000ED18
+#define NVIC_SYS_HND_CTRL       0xE000ED24
+#define NVIC_ST_CTRL            0xE000E010
+
+#define NVIC_APINT_VECTKEY      0x05FA0000
+#define NVIC_APINT_PRIGROUP_M   0x00000700
+#define NVIC_APINT_PRIGROUP_S   8
+
+#define NVIC_INT_CTRL_NMI_SET   0x80000000
+#define NVIC_INT_CTRL_PEND_SV   0x10000000
+#define NVIC_INT_CTRL_UNPEND_SV 0x08000000
+#define NVIC_INT_CTRL_PENDSTSET 0x04000000
+#define NVIC_INT_CTRL_PENDSTCLR 0x02000000
+
+#define NVIC_ST_CTRL_INTEN      0x00000002
+
+/*
+ * Sets or clears bits of a register.
+ */
+static void
+IntModify(uint32_t ui32Reg, uint32_t ui32Bits, bool bSet)
+{
+    uint32_t ui32Value = SimNativeRead(ui32Reg);
+
+    SimNativeWrite(ui32Reg, bSet ? (ui32Value | ui32Bits) :
+                                   (ui32Value & ~ui32Bits));
+}
+
+/*
+ * Returns the address of the word holding the priority byte of an exception,
+ * and the shift of the byte in pui32Shift.
+ */
+static uint32_t
+IntPriorityReg(uint32_t ui32Interrupt, uint32_t *pui32Shift)
+{
+    uint32_t ui32Byte;
+
+    ui32Byte = (ui32Interrupt >= 16) ? NVIC_PRI0 + ui32Interrupt - 16 :
+                                       NVIC_SYS_PRI1 + ui32Interrupt - 4;
+    *pui32Shift = (ui32Byte & 3) * 8;
+
+    return(ui32Byte & ~3U);
+}
+
+/*
+ * Returns the bit of a fault's enable in SYSHNDCTRL, or 0.
+ */
+static uint32_t
+IntFaultBit(uint32_t ui32Interrupt)
+{
+    switch(ui32Interrupt)
+    {
+        case FAULT_MPU:
+            return(1U << 16);
+
+        case FAULT_BUS:
+            return(1U << 17);
+
+        case FAULT_USAGE:
+            return(1U << 18);
+
+        default:
+            return(0);
+    }
+}
+
+bool
+IntMasterEnable(void)
+{
+    bool bOld = SimNativeIntMasterGet();
+
+    SimNativeIntMasterSet(false);
+
+    return(bOld);
+}
+
+bool
+IntMasterDisable(void)
+{
+    bool bOld = SimNativeIntMasterGet();
+
+    SimNativeIntMasterSet(true);
+
+    return(bOld);
+}
+
+void
+IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    if(ui32Interrupt < SIM_NVIC_EXCEPTIONS)
+        g_pfnSimVectors[ui32Interrupt] = pfnHandler;
+}
+
+void
+IntUnregister(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt < SIM_NVIC_EXCEPTIONS)
+        g_pfnSimVectors[ui32Interrupt] = SimNativeDefaultHandler;
+}
+
+void
+IntPriorityGroupingSet(uint32_t ui32Bits)
+{
+    uint32_t ui32Group;
+
+    ui32Group = (ui32Bits > 7) ? 0 : (7 - ui32Bits);
+    SimNativeWrite(NVIC_APINT, NVIC_APINT_VECTKEY |
+                               (ui32Group << NVIC_APINT_PRIGROUP_S));
+}
+
+uint32_t
+IntPriorityGroupingGet(void)
+{
+    uint32_t ui32Group;
+
+    ui32Group = (SimNativeRead(NVIC_APINT) & NVIC_APINT_PRIGROUP_M) >>
+                NVIC_APINT_PRIGROUP_S;
+
+    return(7 - ui32Group);
+}
+
+void
+IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    uint32_t ui32Reg, ui32Shift, ui32Value;
+
+    if((ui32Interrupt < 4) || (ui32Interrupt >= SIM_NVIC_EXCEPTIONS))
+        return;
+
+    ui32Reg = IntPriorityReg(ui32Interrupt, &ui32Shift);
+    ui32Value = SimNativeRead(ui32Reg) & ~(0xFFU << ui32Shift);
+    ui32Value |= (uint32_t)(ui8Priority & INT_PRIORITY_MASK) << ui32Shift;
+    SimNativeWrite(ui32Reg, ui32Value);
+}
+
+int32_t
+IntPriorityGet(uint32_t ui32Interrupt)
+{
+    uint32_t ui32Reg, ui32Shift;
+
+    if((ui32Interrupt < 4) || (ui32Interrupt >= SIM_NVIC_EXCEPTIONS))
+        return(-1);
+
+    ui32Reg = IntPriorityReg(ui32Interrupt, &ui32Shift);
+
+    return((SimNativeRead(ui32Reg) >> ui32Shift) & 0xFF);
+}
+
+void
+IntEnable(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt >= 16)
+    {
+        ui32Interrupt -= 16;
+        SimNativeWrite(NVIC_EN0 + (ui32Interrupt / 32) * 4,
+                       1U << (ui32Interrupt % 32));
+    }
+    else if(ui32Interrupt == FAULT_SYSTICK)
+    {
+        IntModify(NVIC_ST_CTRL, NVIC_ST_CTRL_INTEN, true);
+    }
+    else if(IntFaultBit(ui32Interrupt))
+    {
+        IntModify(NVIC_SYS_HND_CTRL, IntFaultBit(ui32Interrupt), true);
+    }
+}
+
+void
+IntDisable(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt >= 16)
+    {
+        ui32Interrupt -= 16;
+        SimNativeWrite(NVIC_DIS0 + (ui32Interrupt / 32) * 4,
+                       1U << (ui32Interrupt % 32));
+    }
+    else if(ui32Interrupt == FAULT_SYSTICK)
+    {
+        IntModify(NVIC_ST_CTRL, NVIC_ST_CTRL_INTEN, false);
+    }
+    else if(IntFaultBit(ui32Interrupt))
+    {
+        IntModify(NVIC_SYS_HND_CTRL, IntFaultBit(ui32Interrupt), false);
+    }
+}
+
+uint32_t
+IntIsEnabled(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt >= 16)
+    {
+        ui32Interrupt -= 16;
+
+        return(SimNativeRead(NVIC_EN0 + (ui32Interrupt / 32) * 4) &
+               (1U << (ui32Interrupt % 32)));
+    }
+
+    if(ui32Interrupt == FAULT_SYSTICK)
+        return(SimNativeRead(NVIC_ST_CTRL) & NVIC_ST_CTRL_INTEN);
+
+    return(SimNativeRead(NVIC_SYS_HND_CTRL) & IntFaultBit(ui32Interrupt));
+}
+
+void
+IntPendSet(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt >= 16)
+    {
+        ui32Interrupt -= 16;
+        SimNativeWrite(NVIC_PEND0 + (ui32Interrupt / 32) * 4,
+                       1U << (ui32Interrupt % 32));
+    }
+    else if(ui32Interrupt == FAULT_NMI)
+    {
+        SimNativeWrite(NVIC_INT_CTRL, NVIC_INT_CTRL_NMI_SET);
+    }
+    else if(ui32Interrupt == FAULT_PENDSV)
+    {
+        SimNativeWrite(NVIC_INT_CTRL, NVIC_INT_CTRL_PEND_SV);
+    }
+    else if(ui32Interrupt == FAULT_SYSTICK)
+    {
+        SimNativeWrite(NVIC_INT_CTRL, NVIC_INT_CTRL_PENDSTSET);
+    }
+}
+
+void
+IntPendClear(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt >= 16)
+    {
+        ui32Interrupt -= 16;
+        SimNativeWrite(NVIC_UNPEND0 + (ui32Interrupt / 32) * 4,
+                       1U << (ui32Interrupt % 32));
+    }
+    else if(ui32Interrupt == FAULT_PENDSV)
+    {
+        SimNativeWrite(NVIC_INT_CTRL, NVIC_INT_CTRL_UNPEND_SV);
+    }
+    else if(ui32Interrupt == FAULT_SYSTICK)
+    {
+        SimNativeWrite(NVIC_INT_CTRL, NVIC_INT_CTRL_PENDSTCLR);
+    }
+}
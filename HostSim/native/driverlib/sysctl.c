@@ -0,0 +1,246 @@
+/*
+ * Host version of TivaWare's driverlib/sysctl.c.
+ *
+ * The functions program the simulated system control block through the same
+ * register sequences as the target library, so clock changes and peripheral
+ * gating take effect on the board.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_memmap.h"
+#include "driverlib/sysctl.h"
+#include "../native.h"
+
+#define SYSCTL_O_RIS            0x050
+#define SYSCTL_O_MISC           0x058
+#define SYSCTL_O_RESC           0x05C
+#define SYSCTL_O_RCC            0x060
+#define SYSCTL_O_RCC2           0x070
+#define SYSCTL_O_PPBASE         0x300
+#define SYSCTL_O_SRBASE         0x500
+#define SYSCTL_O_RCGCBASE       0x600
+#define SYSCTL_O_PRBASE         0xA00
+
+#define SYSCTL_RIS_PLLLRIS      0x00000040
+
+#define SYSCTL_RCC_SYSDIV_M     0x07800000
+#define SYSCTL_RCC_USESYSDIV    0x00400000
+#define SYSCTL_RCC_PWRDN        0x00002000
+#define SYSCTL_RCC_BYPASS       0x00000800
+#define SYSCTL_RCC_XTAL_M       0x000007C0
+#define SYSCTL_RCC_OSCSRC_M     0x00000030
+#define SYSCTL_RCC_IOSCDIS      0x00000002
+#define SYSCTL_RCC_MOSCDIS      0x00000001
+
+#define SYSCTL_RCC2_USERCC2     0x80000000
+#define SYSCTL_RCC2_DIV400      0x40000000
+#define SYSCTL_RCC2_SYSDIV2_M   0x1F800000
+#define SYSCTL_RCC2_SYSDIV2LSB  0x00400000
+#define SYSCTL_RCC2_PWRDN2      0x00002000
+#define SYSCTL_RCC2_BYPASS2     0x00000800
+#define SYSCTL_RCC2_OSCSRC2_M   0x00000070
+
+#define NVIC_APINT              0xE000ED0C
+#define NVIC_APINT_VECTKEY      0x05FA0000
+#define NVIC_APINT_SYSRESETREQ  0x00000004
+
+/*
+ * Returns the address of the bit-field register of a peripheral in the block
+ * of registers at ui32Offset, and its bit in pui32Bit.
+ */
+static uint32_t
+SysCtlPeriphReg(uint32_t ui32Offset, uint32_t ui32Peripheral,
+                uint32_t *pui32Bit)
+{
+    *pui32Bit = 1U << (ui32Peripheral & 0xFF);
+
+    return(SYSCTL_BASE + ui32Offset + ((ui32Peripheral >> 8) & 0xFF));
+}
+
+void
+SysCtlClockSet(uint32_t ui32Config)
+{
+    uint32_t ui32RCC, ui32RCC2;
+
+    ui32RCC = SimNativeRead(SYSCTL_BASE + SYSCTL_O_RCC);
+    ui32RCC2 = SimNativeRead(SYSCTL_BASE + SYSCTL_O_RCC2);
+
+    /*
+     * Run from the raw oscillator while the PLL is reconfigured.
+     */
+    ui32RCC |= SYSCTL_RCC_BYPASS;
+    ui32RCC &= ~SYSCTL_RCC_USESYSDIV;
+    ui32RCC2 |= SYSCTL_RCC2_BYPASS2;
+
+    SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC, ui32RCC);
+    SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC2, ui32RCC2);
+
+    /*
+     * Select the crystal and oscillator source.
+     */
+    ui32RCC &= ~(SYSCTL_RCC_XTAL_M | SYSCTL_RCC_OSCSRC_M);
+    ui32RCC |= ui32Config & (SYSCTL_RCC_XTAL_M | SYSCTL_RCC_OSCSRC_M);
+    ui32RCC2 &= ~(SYSCTL_RCC2_USERCC2 | SYSCTL_RCC2_OSCSRC2_M);
+    ui32RCC2 |= ui32Config & (SYSCTL_RCC2_USERCC2 | SYSCTL_RCC_OSCSRC_M);
+    ui32RCC2 |= ui32Config & SYSCTL_RCC2_OSCSRC2_M;
+
+    /*
+     * Power the PLL up or down and clear its lock flag.
+     */
+    ui32RCC &= ~SYSCTL_RCC_PWRDN;
+    ui32RCC |= ui32Config & SYSCTL_RCC_PWRDN;
+    ui32RCC2 &= ~SYSCTL_RCC2_PWRDN2;
+    ui32RCC2 |= ui32Config & SYSCTL_RCC2_PWRDN2;
+
+    SimNativeWrite(SYSCTL_BASE + SYSCTL_O_MISC, SYSCTL_RIS_PLLLRIS);
+
+    if(ui32RCC2 & SYSCTL_RCC2_USERCC2)
+    {
+        SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC2, ui32RCC2);
+        SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC, ui32RCC);
+    }
+    else
+    {
+        SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC, ui32RCC);
+        SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC2, ui32RCC2);
+    }
+
+    /*
+     * Set the system divider.
+     */
+    ui32RCC &= ~(SYSCTL_RCC_SYSDIV_M | SYSCTL_RCC_USESYSDIV |
+                 SYSCTL_RCC_IOSCDIS | SYSCTL_RCC_MOSCDIS);
+    ui32RCC |= ui32Config & (SYSCTL_RCC_SYSDIV_M | SYSCTL_RCC_USESYSDIV |
+                             SYSCTL_RCC_IOSCDIS | SYSCTL_RCC_MOSCDIS);
+    ui32RCC2 &= ~SYSCTL_RCC2_SYSDIV2_M;
+    ui32RCC2 |= ui32Config & SYSCTL_RCC2_SYSDIV2_M;
+
+    if(ui32Config & SYSCTL_RCC2_DIV400)
+    {
+        ui32RCC |= SYSCTL_RCC_USESYSDIV;
+        ui32RCC2 &= ~SYSCTL_RCC_USESYSDIV;
+        ui32RCC2 |= ui32Config & (SYSCTL_RCC2_DIV400 | SYSCTL_RCC2_SYSDIV2LSB);
+    }
+    else
+    {
+        ui32RCC2 &= ~SYSCTL_RCC2_DIV400;
+    }
+
+    /*
+     * Wait for the PLL to lock before it drives the system clock.
+     */
+    if(!(ui32Config & SYSCTL_RCC_BYPASS))
+    {
+        while(!(SimNativeRead(SYSCTL_BASE + SYSCTL_O_RIS) &
+                SYSCTL_RIS_PLLLRIS))
+        {
+            SimNativeWait();
+        }
+
+        ui32RCC &= ~SYSCTL_RCC_BYPASS;
+        ui32RCC2 &= ~SYSCTL_RCC2_BYPASS2;
+    }
+
+    SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC, ui32RCC);
+    SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RCC2, ui32RCC2);
+
+    SysCtlDelay(16);
+}
+
+uint32_t
+SysCtlClockGet(void)
+{
+    uint32_t ui32Clock;
+
+    SimNativeEnter();
+    ui32Clock = SimBoardClockHz(SimNativeBoard());
+    SimNativeLeave();
+
+    return(ui32Clock);
+}
+
+/*
+ * The target loop takes three cycles per count.
+ */
+void
+SysCtlDelay(uint32_t ui32Count)
+{
+    SimNativeCharge((uint64_t)ui32Count * 3);
+}
+
+bool
+SysCtlPeripheralPresent(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Reg, ui32Bit;
+
+    ui32Reg = SysCtlPeriphReg(SYSCTL_O_PPBASE, ui32Peripheral, &ui32Bit);
+
+    return((SimNativeRead(ui32Reg) & ui32Bit) != 0);
+}
+
+bool
+SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Reg, ui32Bit;
+
+    ui32Reg = SysCtlPeriphReg(SYSCTL_O_PRBASE, ui32Peripheral, &ui32Bit);
+
+    return((SimNativeRead(ui32Reg) & ui32Bit) != 0);
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Reg, ui32Bit;
+
+    ui32Reg = SysCtlPeriphReg(SYSCTL_O_RCGCBASE, ui32Peripheral, &ui32Bit);
+    SimNativeWrite(ui32Reg, SimNativeRead(ui32Reg) | ui32Bit);
+}
+
+void
+SysCtlPeripheralDisable(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Reg, ui32Bit;
+
+    ui32Reg = SysCtlPeriphReg(SYSCTL_O_RCGCBASE, ui32Peripheral, &ui32Bit);
+    SimNativeWrite(ui32Reg, SimNativeRead(ui32Reg) & ~ui32Bit);
+}
+
+void
+SysCtlPeripheralReset(uint32_t ui32Peripheral)
+{
+    uint32_t ui32Reg, ui32Bit;
+
+    ui32Reg = SysCtlPeriphReg(SYSCTL_O_SRBASE, ui32Peripheral, &ui32Bit);
+    SimNativeWrite(ui32Reg, SimNativeRead(ui32Reg) | ui32Bit);
+    SysCtlDelay(16);
+    SimNativeWrite(ui32Reg, SimNativeRead(ui32Reg) & ~ui32Bit);
+}
+
+void
+SysCtlReset(void)
+{
+    SimNativeWrite(NVIC_APINT, NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ);
+
+    /*
+     * The write above restarts the firmware; this is not reached.
+     */
+    while(1)
+    {
+        SimNativeWait();
+    }
+}
+
+uint32_t
+SysCtlResetCauseGet(void)
+{
+    return(SimNativeRead(SYSCTL_BASE + SYSCTL_O_RESC));
+}
+
+void
+SysCtlResetCauseClear(uint32_t ui32Causes)
+{
+    SimNativeWrite(SYSCTL_BASE + SYSCTL_O_RESC,
+                   SimNativeRead(SYSCTL_BASE + SYSCTL_O_RESC) & ~ui32Causes);
+}
@@ -0,0 +1,228 @@
+/*
+ * Host version of TivaWare's driverlib/timer.c, for the 16/32-bit timers.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/timer.h"
+#include "../native.h"
+
+#define TIMER_O_CFG             0x000
+#define TIMER_O_TAMR            0x004
+#define TIMER_O_TBMR            0x008
+#define TIMER_O_CTL             0x00C
+#define TIMER_O_IMR             0x018
+#define TIMER_O_RIS             0x01C
+#define TIMER_O_MIS             0x020
+#define TIMER_O_ICR             0x024
+#define TIMER_O_TAILR           0x028
+#define TIMER_O_TBILR           0x02C
+#define TIMER_O_TAMATCHR        0x030
+#define TIMER_O_TBMATCHR        0x034
+#define TIMER_O_TAPR            0x038
+#define TIMER_O_TBPR            0x03C
+#define TIMER_O_TAR             0x048
+#define TIMER_O_TBR             0x04C
+
+#define TIMER_CTL_TAEN          0x00000001
+#define TIMER_CTL_TBEN          0x00000100
+
+#define TIMER_TNMR_TNPWMIE      0x00000200
+
+/*
+ * Interrupts of timer A by timer base; timer B follows at the next number.
+ */
+static const struct
+{
+    uint32_t ui32Base;
+    uint8_t ui8Int;
+}
+g_psTimerInts[] =
+{
+    { TIMER0_BASE, INT_TIMER0A },
+    { TIMER1_BASE, INT_TIMER1A },
+    { TIMER2_BASE, INT_TIMER2A },
+    { TIMER3_BASE, INT_TIMER3A },
+    { TIMER4_BASE, INT_TIMER4A },
+    { TIMER5_BASE, INT_TIMER5A },
+};
+
+#define NUM_TIMERS      (sizeof(g_psTimerInts) / sizeof(g_psTimerInts[0]))
+
+static uint32_t
+TimerIntNumberGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NUM_TIMERS; ui32Idx++)
+        if(g_psTimerInts[ui32Idx].ui32Base == ui32Base)
+            return(g_psTimerInts[ui32Idx].ui8Int +
+                   ((ui32Timer == TIMER_B) ? 1 : 0));
+
+    return(0);
+}
+
+void
+TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    SimNativeWrite(ui32Base + TIMER_O_CTL,
+                   SimNativeRead(ui32Base + TIMER_O_CTL) |
+                   (ui32Timer & (TIMER_CTL_TAEN | TIMER_CTL_TBEN)));
+}
+
+void
+TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    SimNativeWrite(ui32Base + TIMER_O_CTL,
+                   SimNativeRead(ui32Base + TIMER_O_CTL) &
+                   ~(ui32Timer & (TIMER_CTL_TAEN | TIMER_CTL_TBEN)));
+}
+
+/*
+ * Configures the timer pair.  Both halves are stopped; the mode of each half
+ * lives in the low byte of its half of ui32Config, with the extra mode bits
+ * in bits 16-23.
+ */
+void
+TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    SimNativeWrite(ui32Base + TIMER_O_CTL,
+                   SimNativeRead(ui32Base + TIMER_O_CTL) &
+                   ~(TIMER_CTL_TAEN | TIMER_CTL_TBEN));
+
+    SimNativeWrite(ui32Base + TIMER_O_CFG, ui32Config >> 24);
+    SimNativeWrite(ui32Base + TIMER_O_TAMR,
+                   ((ui32Config & 0x000F0000) >> 4) | (ui32Config & 0xFF) |
+                   TIMER_TNMR_TNPWMIE);
+    SimNativeWrite(ui32Base + TIMER_O_TBMR,
+                   ((ui32Config & 0x00F00000) >> 8) |
+                   ((ui32Config >> 8) & 0xFF) | TIMER_TNMR_TNPWMIE);
+}
+
+void
+TimerPrescaleSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    if(ui32Timer & TIMER_A)
+        SimNativeWrite(ui32Base + TIMER_O_TAPR, ui32Value);
+
+    if(ui32Timer & TIMER_B)
+        SimNativeWrite(ui32Base + TIMER_O_TBPR, ui32Value);
+}
+
+uint32_t
+TimerPrescaleGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    return(SimNativeRead(ui32Base + ((ui32Timer == TIMER_B) ? TIMER_O_TBPR :
+                                                              TIMER_O_TAPR)));
+}
+
+void
+TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    if(ui32Timer & TIMER_A)
+        SimNativeWrite(ui32Base + TIMER_O_TAILR, ui32Value);
+
+    if(ui32Timer & TIMER_B)
+        SimNativeWrite(ui32Base + TIMER_O_TBILR, ui32Value);
+}
+
+uint32_t
+TimerLoadGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    return(SimNativeRead(ui32Base + ((ui32Timer == TIMER_B) ? TIMER_O_TBILR :
+                                                              TIMER_O_TAILR)));
+}
+
+uint32_t
+TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    return(SimNativeRead(ui32Base + ((ui32Timer == TIMER_B) ? TIMER_O_TBR :
+                                                              TIMER_O_TAR)));
+}
+
+void
+TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    if(ui32Timer & TIMER_A)
+        SimNativeWrite(ui32Base + TIMER_O_TAMATCHR, ui32Value);
+
+    if(ui32Timer & TIMER_B)
+        SimNativeWrite(ui32Base + TIMER_O_TBMATCHR, ui32Value);
+}
+
+uint32_t
+TimerMatchGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    return(SimNativeRead(ui32Base + ((ui32Timer == TIMER_B) ?
+                                     TIMER_O_TBMATCHR : TIMER_O_TAMATCHR)));
+}
+
+void
+TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer,
+                 void (*pfnHandler)(void))
+{
+    uint32_t ui32Int;
+
+    if(ui32Timer & TIMER_A)
+    {
+        ui32Int = TimerIntNumberGet(ui32Base, TIMER_A);
+        IntRegister(ui32Int, pfnHandler);
+        IntEnable(ui32Int);
+    }
+
+    if(ui32Timer & TIMER_B)
+    {
+        ui32Int = TimerIntNumberGet(ui32Base, TIMER_B);
+        IntRegister(ui32Int, pfnHandler);
+        IntEnable(ui32Int);
+    }
+}
+
+void
+TimerIntUnregister(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    uint32_t ui32Int;
+
+    if(ui32Timer & TIMER_A)
+    {
+        ui32Int = TimerIntNumberGet(ui32Base, TIMER_A);
+        IntDisable(ui32Int);
+        IntUnregister(ui32Int);
+    }
+
+    if(ui32Timer & TIMER_B)
+    {
+        ui32Int = TimerIntNumberGet(ui32Base, TIMER_B);
+        IntDisable(ui32Int);
+        IntUnregister(ui32Int);
+    }
+}
+
+void
+TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    SimNativeWrite(ui32Base + TIMER_O_IMR,
+                   SimNativeRead(ui32Base + TIMER_O_IMR) | ui32IntFlags);
+}
+
+void
+TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    SimNativeWrite(ui32Base + TIMER_O_IMR,
+                   SimNativeRead(ui32Base + TIMER_O_IMR) & ~ui32IntFlags);
+}
+
+uint32_t
+TimerIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    return(SimNativeRead(ui32Base + (bMasked ? TIMER_O_MIS : TIMER_O_RIS)));
+}
+
+void
+TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    SimNativeWrite(ui32Base + TIMER_O_ICR, ui32IntFlags);
+}
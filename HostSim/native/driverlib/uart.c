@@ -0,0 +1,298 @@
+/*
+ * Host version of TivaWare's driverlib/uart.c.
+ *
+ * Calls that block on the target until the UART has room or data let
+ * simulated time run on to the next event instead of spinning.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+#include "../native.h"
+
+static const struct
+{
+    uint32_t ui32Base;
+    uint8_t ui8Int;
+}
+g_psUARTInts[] =
+{
+    { UART0_BASE, INT_UART0 },
+    { UART1_BASE, INT_UART1 },
+    { UART2_BASE, INT_UART2 },
+    { UART3_BASE, INT_UART3 },
+    { UART4_BASE, INT_UART4 },
+    { UART5_BASE, INT_UART5 },
+    { UART6_BASE, INT_UART6 },
+    { UART7_BASE, INT_UART7 },
+};
+
+#define NUM_UARTS       (sizeof(g_psUARTInts) / sizeof(g_psUARTInts[0]))
+
+static uint32_t
+UARTIntNumberGet(uint32_t ui32Base)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NUM_UARTS; ui32Idx++)
+        if(g_psUARTInts[ui32Idx].ui32Base == ui32Base)
+            return(g_psUARTInts[ui32Idx].ui8Int);
+
+    return(0);
+}
+
+static void
+UARTModify(uint32_t ui32Reg, uint32_t ui32Clear, uint32_t ui32Set)
+{
+    SimNativeWrite(ui32Reg, (SimNativeRead(ui32Reg) & ~ui32Clear) | ui32Set);
+}
+
+void
+UARTParityModeSet(uint32_t ui32Base, uint32_t ui32Parity)
+{
+    UARTModify(ui32Base + UART_O_LCRH,
+               UART_LCRH_SPS | UART_LCRH_EPS | UART_LCRH_PEN, ui32Parity);
+}
+
+uint32_t
+UARTParityModeGet(uint32_t ui32Base)
+{
+    return(SimNativeRead(ui32Base + UART_O_LCRH) &
+           (UART_LCRH_SPS | UART_LCRH_EPS | UART_LCRH_PEN));
+}
+
+void
+UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                 uint32_t ui32RxLevel)
+{
+    SimNativeWrite(ui32Base + UART_O_IFLS, ui32TxLevel | ui32RxLevel);
+}
+
+void
+UARTFIFOLevelGet(uint32_t ui32Base, uint32_t *pui32TxLevel,
+                 uint32_t *pui32RxLevel)
+{
+    uint32_t ui32Temp = SimNativeRead(ui32Base + UART_O_IFLS);
+
+    *pui32TxLevel = ui32Temp & UART_IFLS_TX_M;
+    *pui32RxLevel = ui32Temp & UART_IFLS_RX_M;
+}
+
+void
+UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                    uint32_t ui32Baud, uint32_t ui32Config)
+{
+    uint32_t ui32Div;
+
+    UARTDisable(ui32Base);
+
+    /*
+     * Use the high-speed divider when the baud rate is too high for the
+     * 16x one.
+     */
+    if((ui32Baud * 16) > ui32UARTClk)
+    {
+        UARTModify(ui32Base + UART_O_CTL, 0, UART_CTL_HSE);
+        ui32Baud /= 2;
+    }
+    else
+    {
+        UARTModify(ui32Base + UART_O_CTL, UART_CTL_HSE, 0);
+    }
+
+    /*
+     * The divisor in 1/64ths, rounded to nearest.
+     */
+    ui32Div = (((ui32UARTClk * 8) / ui32Baud) + 1) / 2;
+
+    SimNativeWrite(ui32Base + UART_O_IBRD, ui32Div / 64);
+    SimNativeWrite(ui32Base + UART_O_FBRD, ui32Div % 64);
+    SimNativeWrite(ui32Base + UART_O_LCRH, ui32Config);
+    SimNativeWrite(ui32Base + UART_O_FR, 0);
+
+    UARTEnable(ui32Base);
+}
+
+void
+UARTConfigGetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                    uint32_t *pui32Baud, uint32_t *pui32Config)
+{
+    uint32_t ui32Int, ui32Frac;
+
+    ui32Int = SimNativeRead(ui32Base + UART_O_IBRD);
+    ui32Frac = SimNativeRead(ui32Base + UART_O_FBRD);
+    *pui32Baud = (ui32UARTClk * 4) / ((64 * ui32Int) + ui32Frac);
+
+    if(SimNativeRead(ui32Base + UART_O_CTL) & UART_CTL_HSE)
+        *pui32Baud *= 2;
+
+    *pui32Config = SimNativeRead(ui32Base + UART_O_LCRH) &
+                   (UART_LCRH_SPS | UART_LCRH_WLEN_M | UART_LCRH_STP2 |
+                    UART_LCRH_EPS | UART_LCRH_PEN);
+}
+
+void
+UARTEnable(uint32_t ui32Base)
+{
+    UARTModify(ui32Base + UART_O_LCRH, 0, UART_LCRH_FEN);
+    UARTModify(ui32Base + UART_O_CTL, 0,
+               UART_CTL_UARTEN | UART_CTL_TXE | UART_CTL_RXE);
+}
+
+/*
+ * Lets the transmitter finish the frame in progress before it is disabled.
+ */
+void
+UARTDisable(uint32_t ui32Base)
+{
+    while(SimNativeRead(ui32Base + UART_O_FR) & UART_FR_BUSY)
+    {
+        SimNativeWait();
+    }
+
+    UARTModify(ui32Base + UART_O_LCRH, UART_LCRH_FEN, 0);
+    UARTModify(ui32Base + UART_O_CTL,
+               UART_CTL_UARTEN | UART_CTL_TXE | UART_CTL_RXE, 0);
+}
+
+void
+UARTFIFOEnable(uint32_t ui32Base)
+{
+    UARTModify(ui32Base + UART_O_LCRH, 0, UART_LCRH_FEN);
+}
+
+void
+UARTFIFODisable(uint32_t ui32Base)
+{
+    UARTModify(ui32Base + UART_O_LCRH, UART_LCRH_FEN, 0);
+}
+
+bool
+UARTCharsAvail(uint32_t ui32Base)
+{
+    return(!(SimNativeRead(ui32Base + UART_O_FR) & UART_FR_RXFE));
+}
+
+bool
+UARTSpaceAvail(uint32_t ui32Base)
+{
+    return(!(SimNativeRead(ui32Base + UART_O_FR) & UART_FR_TXFF));
+}
+
+int32_t
+UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    if(SimNativeRead(ui32Base + UART_O_FR) & UART_FR_RXFE)
+        return(-1);
+
+    return(SimNativeRead(ui32Base + UART_O_DR));
+}
+
+int32_t
+UARTCharGet(uint32_t ui32Base)
+{
+    while(SimNativeRead(ui32Base + UART_O_FR) & UART_FR_RXFE)
+    {
+        SimNativeWait();
+    }
+
+    return(SimNativeRead(ui32Base + UART_O_DR));
+}
+
+bool
+UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    if(SimNativeRead(ui32Base + UART_O_FR) & UART_FR_TXFF)
+        return(false);
+
+    SimNativeWrite(ui32Base + UART_O_DR, ucData);
+
+    return(true);
+}
+
+void
+UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    while(SimNativeRead(ui32Base + UART_O_FR) & UART_FR_TXFF)
+    {
+        SimNativeWait();
+    }
+
+    SimNativeWrite(ui32Base + UART_O_DR, ucData);
+}
+
+bool
+UARTBusy(uint32_t ui32Base)
+{
+    return((SimNativeRead(ui32Base + UART_O_FR) & UART_FR_BUSY) != 0);
+}
+
+void
+UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    uint32_t ui32Int = UARTIntNumberGet(ui32Base);
+
+    IntRegister(ui32Int, pfnHandler);
+    IntEnable(ui32Int);
+}
+
+void
+UARTIntUnregister(uint32_t ui32Base)
+{
+    uint32_t ui32Int = UARTIntNumberGet(ui32Base);
+
+    IntDisable(ui32Int);
+    IntUnregister(ui32Int);
+}
+
+void
+UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    UARTModify(ui32Base + UART_O_IM, 0, ui32IntFlags);
+}
+
+void
+UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    UARTModify(ui32Base + UART_O_IM, ui32IntFlags, 0);
+}
+
+uint32_t
+UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    return(SimNativeRead(ui32Base + (bMasked ? UART_O_MIS : UART_O_RIS)));
+}
+
+void
+UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    SimNativeWrite(ui32Base + UART_O_ICR, ui32IntFlags);
+}
+
+void
+UARTTxIntModeSet(uint32_t ui32Base, uint32_t ui32Mode)
+{
+    UARTModify(ui32Base + UART_O_CTL, UART_TXINT_MODE_EOT, ui32Mode);
+}
+
+uint32_t
+UARTTxIntModeGet(uint32_t ui32Base)
+{
+    return(SimNativeRead(ui32Base + UART_O_CTL) & UART_TXINT_MODE_EOT);
+}
+
+void
+UARTClockSourceSet(uint32_t ui32Base, uint32_t ui32Source)
+{
+    SimNativeWrite(ui32Base + UART_O_CC, ui32Source);
+}
+
+uint32_t
+UARTClockSourceGet(uint32_t ui32Base)
+{
+    return(SimNativeRead(ui32Base + UART_O_CC) & UART_CC_CS_M);
+}
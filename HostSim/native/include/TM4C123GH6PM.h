@@ -0,0 +1,131 @@
+/*
+ * Host version of the TM4C123GH6PM device header.
+ *
+ * The register layouts come from the device header of the GNU projects; only
+ * the base addresses are replaced, so that every peripheral access lands in
+ * the register images of the host runtime.
+ */
+#ifndef __SIM_TM4C123GH6PM_H__
+#define __SIM_TM4C123GH6PM_H__
+
+#include "../../../CCS/GNU/Blinky-SysTick/TM4C123GH6PM.h"
+
+#undef WATCHDOG0_BASE
+#undef WATCHDOG1_BASE
+#undef GPIOA_BASE
+#undef GPIOB_BASE
+#undef GPIOC_BASE
+#undef GPIOD_BASE
+#undef SSI0_BASE
+#undef SSI1_BASE
+#undef SSI2_BASE
+#undef SSI3_BASE
+#undef UART0_BASE
+#undef UART1_BASE
+#undef UART2_BASE
+#undef UART3_BASE
+#undef UART4_BASE
+#undef UART5_BASE
+#undef UART6_BASE
+#undef UART7_BASE
+#undef I2C0_BASE
+#undef I2C1_BASE
+#undef I2C2_BASE
+#undef I2C3_BASE
+#undef GPIOE_BASE
+#undef GPIOF_BASE
+#undef PWM0_BASE
+#undef PWM1_BASE
+#undef QEI0_BASE
+#undef QEI1_BASE
+#undef TIMER0_BASE
+#undef TIMER1_BASE
+#undef TIMER2_BASE
+#undef TIMER3_BASE
+#undef TIMER4_BASE
+#undef TIMER5_BASE
+#undef WTIMER0_BASE
+#undef WTIMER1_BASE
+#undef ADC0_BASE
+#undef ADC1_BASE
+#undef COMP_BASE
+#undef CAN0_BASE
+#undef CAN1_BASE
+#undef WTIMER2_BASE
+#undef WTIMER3_BASE
+#undef WTIMER4_BASE
+#undef WTIMER5_BASE
+#undef USB0_BASE
+#undef GPIOA_AHB_BASE
+#undef GPIOB_AHB_BASE
+#undef GPIOC_AHB_BASE
+#undef GPIOD_AHB_BASE
+#undef GPIOE_AHB_BASE
+#undef GPIOF_AHB_BASE
+#undef EEPROM_BASE
+#undef SYSEXC_BASE
+#undef HIB_BASE
+#undef FLASH_CTRL_BASE
+#undef SYSCTL_BASE
+#undef UDMA_BASE
+
+#define WATCHDOG0_BASE                  SimNativeWindow(0x40000000UL)
+#define WATCHDOG1_BASE                  SimNativeWindow(0x40001000UL)
+#define GPIOA_BASE                      SimNativeWindow(0x40004000UL)
+#define GPIOB_BASE                      SimNativeWindow(0x40005000UL)
+#define GPIOC_BASE                      SimNativeWindow(0x40006000UL)
+#define GPIOD_BASE                      SimNativeWindow(0x40007000UL)
+#define SSI0_BASE                       SimNativeWindow(0x40008000UL)
+#define SSI1_BASE                       SimNativeWindow(0x40009000UL)
+#define SSI2_BASE                       SimNativeWindow(0x4000A000UL)
+#define SSI3_BASE                       SimNativeWindow(0x4000B000UL)
+#define UART0_BASE                      SimNativeWindow(0x4000C000UL)
+#define UART1_BASE                      SimNativeWindow(0x4000D000UL)
+#define UART2_BASE                      SimNativeWindow(0x4000E000UL)
+#define UART3_BASE                      SimNativeWindow(0x4000F000UL)
+#define UART4_BASE                      SimNativeWindow(0x40010000UL)
+#define UART5_BASE                      SimNativeWindow(0x40011000UL)
+#define UART6_BASE                      SimNativeWindow(0x40012000UL)
+#define UART7_BASE                      SimNativeWindow(0x40013000UL)
+#define I2C0_BASE                       SimNativeWindow(0x40020000UL)
+#define I2C1_BASE                       SimNativeWindow(0x40021000UL)
+#define I2C2_BASE                       SimNativeWindow(0x40022000UL)
+#define I2C3_BASE                       SimNativeWindow(0x40023000UL)
+#define GPIOE_BASE                      SimNativeWindow(0x40024000UL)
+#define GPIOF_BASE                      SimNativeWindow(0x40025000UL)
+#define PWM0_BASE                       SimNativeWindow(0x40028000UL)
+#define PWM1_BASE                       SimNativeWindow(0x40029000UL)
+#define QEI0_BASE                       SimNativeWindow(0x4002C000UL)
+#define QEI1_BASE                       SimNativeWindow(0x4002D000UL)
+#define TIMER0_BASE                     SimNativeWindow(0x40030000UL)
+#define TIMER1_BASE                     SimNativeWindow(0x40031000UL)
+#define TIMER2_BASE                     SimNativeWindow(0x40032000UL)
+#define TIMER3_BASE                     SimNativeWindow(0x40033000UL)
+#define TIMER4_BASE                     SimNativeWindow(0x40034000UL)
+#define TIMER5_BASE                     SimNativeWindow(0x40035000UL)
+#define WTIMER0_BASE                    SimNativeWindow(0x40036000UL)
+#define WTIMER1_BASE                    SimNativeWindow(0x40037000UL)
+#define ADC0_BASE                       SimNativeWindow(0x40038000UL)
+#define ADC1_BASE                       SimNativeWindow(0x40039000UL)
+#define COMP_BASE                       SimNativeWindow(0x4003C000UL)
+#define CAN0_BASE                       SimNativeWindow(0x40040000UL)
+#define CAN1_BASE                       SimNativeWindow(0x40041000UL)
+#define WTIMER2_BASE                    SimNativeWindow(0x4004C000UL)
+#define WTIMER3_BASE                    SimNativeWindow(0x4004D000UL)
+#define WTIMER4_BASE                    SimNativeWindow(0x4004E000UL)
+#define WTIMER5_BASE                    SimNativeWindow(0x4004F000UL)
+#define USB0_BASE                       SimNativeWindow(0x40050000UL)
+#define GPIOA_AHB_BASE                  SimNativeWindow(0x40058000UL)
+#define GPIOB_AHB_BASE                  SimNativeWindow(0x40059000UL)
+#define GPIOC_AHB_BASE                  SimNativeWindow(0x4005A000UL)
+#define GPIOD_AHB_BASE                  SimNativeWindow(0x4005B000UL)
+#define GPIOE_AHB_BASE                  SimNativeWindow(0x4005C000UL)
+#define GPIOF_AHB_BASE                  SimNativeWindow(0x4005D000UL)
+#define EEPROM_BASE                     SimNativeWindow(0x400AF000UL)
+#define SYSEXC_BASE                     SimNativeWindow(0x400F9000UL)
+#define HIB_BASE                        SimNativeWindow(0x400FC000UL)
+#define FLASH_CTRL_BASE                 SimNativeWindow(0x400FD000UL)
+#define SYSCTL_BASE                     SimNativeWindow(0x400FE000UL)
+#define UDMA_BASE                       SimNativeWindow(0x400FF000UL)
+
+#endif
@@ -0,0 +1,255 @@
+/*
+ * Host replacement for the CMSIS Cortex-M4 core header.
+ *
+ * Provides the core register layouts and the subset of the CMSIS core
+ * functions used by the firmware in this repository.  Core registers go
+ * through the register images of the host runtime like every other
+ * peripheral; the intrinsics that have no memory mapped equivalent call into
+ * the runtime directly.
+ */
+#ifndef __CORE_CM4_H_GENERIC
+#define __CORE_CM4_H_GENERIC
+
+#include <stdint.h>
+
+#include "../native.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __CM4_CMSIS_VERSION_MAIN    5U
+#define __CM4_CMSIS_VERSION_SUB     1U
+#define __CORTEX_M                  4U
+
+#ifndef __FPU_PRESENT
+#define __FPU_PRESENT               0U
+#endif
+#define __FPU_USED                  0U
+
+#define __I                         volatile const
+#define __O                         volatile
+#define __IO                        volatile
+#define __IM                        volatile const
+#define __OM                        volatile
+#define __IOM                       volatile
+
+#define __ASM                       __asm
+#define __INLINE                    inline
+#define __STATIC_INLINE             static inline
+#define __STATIC_FORCEINLINE        __attribute__((always_inline)) static inline
+#define __NO_RETURN                 __attribute__((__noreturn__))
+#define __USED                      __attribute__((used))
+#define __WEAK                      __attribute__((weak))
+#define __PACKED                    __attribute__((packed, aligned(1)))
+#define __ALIGNED(x)                __attribute__((aligned(x)))
+#define __UNUSED                    __attribute__((unused))
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t LOAD;
+    __IOM uint32_t VAL;
+    __IM  uint32_t CALIB;
+} SysTick_Type;
+
+#define SysTick_CTRL_COUNTFLAG_Msk  (1UL << 16U)
+#define SysTick_CTRL_CLKSOURCE_Msk  (1UL << 2U)
+#define SysTick_CTRL_TICKINT_Msk    (1UL << 1U)
+#define SysTick_CTRL_ENABLE_Msk     (1UL << 0U)
+#define SysTick_LOAD_RELOAD_Msk     (0xFFFFFFUL)
+#define SysTick_VAL_CURRENT_Msk     (0xFFFFFFUL)
+
+typedef struct
+{
+    __IOM uint32_t ISER[8U];
+          uint32_t RESERVED0[24U];
+    __IOM uint32_t ICER[8U];
+          uint32_t RESERVED1[24U];
+    __IOM uint32_t ISPR[8U];
+          uint32_t RESERVED2[24U];
+    __IOM uint32_t ICPR[8U];
+          uint32_t RESERVED3[24U];
+    __IOM uint32_t IABR[8U];
+          uint32_t RESERVED4[56U];
+    __IOM uint8_t  IP[240U];
+          uint32_t RESERVED5[644U];
+    __OM  uint32_t STIR;
+} NVIC_Type;
+
+typedef struct
+{
+    __IM  uint32_t CPUID;
+    __IOM uint32_t ICSR;
+    __IOM uint32_t VTOR;
+    __IOM uint32_t AIRCR;
+    __IOM uint32_t SCR;
+    __IOM uint32_t CCR;
+    __IOM uint8_t  SHP[12U];
+    __IOM uint32_t SHCSR;
+    __IOM uint32_t CFSR;
+    __IOM uint32_t HFSR;
+    __IOM uint32_t DFSR;
+    __IOM uint32_t MMFAR;
+    __IOM uint32_t BFAR;
+    __IOM uint32_t AFSR;
+    __IM  uint32_t PFR[2U];
+    __IM  uint32_t DFR;
+    __IM  uint32_t ADR;
+    __IM  uint32_t MMFR[4U];
+    __IM  uint32_t ISAR[5U];
+          uint32_t RESERVED0[5U];
+    __IOM uint32_t CPACR;
+} SCB_Type;
+
+#define SCB_AIRCR_VECTKEY_Pos       16U
+#define SCB_AIRCR_VECTKEY_Msk       (0xFFFFUL << SCB_AIRCR_VECTKEY_Pos)
+#define SCB_AIRCR_PRIGROUP_Pos      8U
+#define SCB_AIRCR_PRIGROUP_Msk      (7UL << SCB_AIRCR_PRIGROUP_Pos)
+#define SCB_AIRCR_SYSRESETREQ_Msk   (1UL << 2U)
+#define SCB_ICSR_PENDSVSET_Msk      (1UL << 28U)
+#define SCB_ICSR_PENDSTSET_Msk      (1UL << 26U)
+#define SCB_SCR_SLEEPDEEP_Msk       (1UL << 2U)
+
+#define SCS_BASE                    (0xE000E000UL)
+#define SysTick_BASE                (SCS_BASE + 0x0010UL)
+#define NVIC_BASE                   (SCS_BASE + 0x0100UL)
+#define SCB_BASE                    (SCS_BASE + 0x0D00UL)
+
+#define SCB                         ((SCB_Type *) SimNativeWindow(SCB_BASE))
+#define SysTick                     ((SysTick_Type *) SimNativeWindow(SysTick_BASE))
+#define NVIC                        ((NVIC_Type *) SimNativeWindow(NVIC_BASE))
+
+/*
+ * Intrinsics.
+ */
+__STATIC_INLINE void
+__enable_irq(void)
+{
+    SimNativeIntMasterSet(false);
+}
+
+__STATIC_INLINE void
+__disable_irq(void)
+{
+    SimNativeIntMasterSet(true);
+}
+
+__STATIC_INLINE uint32_t
+__get_PRIMASK(void)
+{
+    return(SimNativeIntMasterGet() ? 1U : 0U);
+}
+
+__STATIC_INLINE void
+__set_PRIMASK(uint32_t priMask)
+{
+    SimNativeIntMasterSet((priMask & 1U) != 0);
+}
+
+#define __NOP()                     do { } while(0)
+#define __WFI()                     SimNativeSleep()
+#define __WFE()                     SimNativeSleep()
+#define __SEV()                     do { } while(0)
+#define __ISB()                     __sync_synchronize()
+#define __DSB()                     __sync_synchronize()
+#define __DMB()                     __sync_synchronize()
+
+/*
+ * NVIC functions.
+ */
+__STATIC_INLINE void
+NVIC_SetPriorityGrouping(uint32_t PriorityGroup)
+{
+    SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) |
+                 ((PriorityGroup & 7UL) << SCB_AIRCR_PRIGROUP_Pos);
+}
+
+__STATIC_INLINE uint32_t
+NVIC_GetPriorityGrouping(void)
+{
+    return((SCB->AIRCR & SCB_AIRCR_PRIGROUP_Msk) >> SCB_AIRCR_PRIGROUP_Pos);
+}
+
+__STATIC_INLINE void
+NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if((int32_t)IRQn >= 0)
+        NVIC->ISER[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1FUL);
+}
+
+__STATIC_INLINE void
+NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if((int32_t)IRQn >= 0)
+        NVIC->ICER[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1FUL);
+}
+
+__STATIC_INLINE void
+NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    if((int32_t)IRQn >= 0)
+        NVIC->ISPR[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1FUL);
+}
+
+__STATIC_INLINE void
+NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    if((int32_t)IRQn >= 0)
+        NVIC->ICPR[(uint32_t)IRQn >> 5] = 1UL << ((uint32_t)IRQn & 0x1FUL);
+}
+
+__STATIC_INLINE void
+NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    uint8_t ui8Prio = (uint8_t)((priority << (8U - __NVIC_PRIO_BITS)) & 0xFFUL);
+
+    if((int32_t)IRQn >= 0)
+        NVIC->IP[(uint32_t)IRQn] = ui8Prio;
+    else
+        SCB->SHP[((uint32_t)IRQn & 0xFUL) - 4UL] = ui8Prio;
+}
+
+__STATIC_INLINE uint32_t
+NVIC_GetPriority(IRQn_Type IRQn)
+{
+    if((int32_t)IRQn >= 0)
+        return((uint32_t)NVIC->IP[(uint32_t)IRQn] >> (8U - __NVIC_PRIO_BITS));
+
+    return((uint32_t)SCB->SHP[((uint32_t)IRQn & 0xFUL) - 4UL] >>
+           (8U - __NVIC_PRIO_BITS));
+}
+
+__NO_RETURN __STATIC_INLINE void
+NVIC_SystemReset(void)
+{
+    SimNativeReset();
+}
+
+/*
+ * SysTick functions.
+ */
+#if defined(__Vendor_SysTickConfig) && (__Vendor_SysTickConfig == 0U)
+
+__STATIC_INLINE uint32_t
+SysTick_Config(uint32_t ticks)
+{
+    if((ticks - 1UL) > SysTick_LOAD_RELOAD_Msk)
+        return(1UL);
+
+    SysTick->LOAD = (uint32_t)(ticks - 1UL);
+    NVIC_SetPriority(SysTick_IRQn, (1UL << __NVIC_PRIO_BITS) - 1UL);
+    SysTick->VAL = 0UL;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk |
+                    SysTick_CTRL_ENABLE_Msk;
+
+    return(0UL);
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,24 @@
+/*
+ * Host version of TivaWare's driverlib/debug.h.
+ */
+#ifndef __DRIVERLIB_DEBUG_H__
+#define __DRIVERLIB_DEBUG_H__
+
+#include <stdint.h>
+
+extern void __error__(char *pcFilename, uint32_t ui32Line);
+
+#ifdef DEBUG
+#define ASSERT(expr) do                                                       \
+                     {                                                        \
+                         if(!(expr))                                          \
+                         {                                                    \
+                             __error__(__FILE__, __LINE__);                   \
+                         }                                                    \
+                     }                                                        \
+                     while(0)
+#else
+#define ASSERT(expr)
+#endif
+
+#endif
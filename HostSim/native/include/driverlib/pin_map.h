@@ -0,0 +1,37 @@
+/*
+ * Host version of TivaWare's driverlib/pin_map.h, reduced to the UART and
+ * timer pins of the TM4C123GH6PM.
+ *
+ * A pin configuration holds the port index in bits 16-23, the shift of the
+ * pin's PCTL field in bits 8-15 and the function number in bits 0-3.
+ */
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define __DRIVERLIB_PIN_MAP_H__
+
+#define GPIO_PA0_U0RX           0x00000001
+#define GPIO_PA1_U0TX           0x00000401
+#define GPIO_PB0_U1RX           0x00010001
+#define GPIO_PB1_U1TX           0x00010401
+#define GPIO_PC4_U1RX           0x00021002
+#define GPIO_PC5_U1TX           0x00021402
+#define GPIO_PD6_U2RX           0x00031801
+#define GPIO_PD7_U2TX           0x00031C01
+#define GPIO_PC6_U3RX           0x00021801
+#define GPIO_PC7_U3TX           0x00021C01
+#define GPIO_PC4_U4RX           0x00021001
+#define GPIO_PC5_U4TX           0x00021401
+#define GPIO_PE4_U5RX           0x00041001
+#define GPIO_PE5_U5TX           0x00041401
+#define GPIO_PD4_U6RX           0x00031001
+#define GPIO_PD5_U6TX           0x00031401
+#define GPIO_PE0_U7RX           0x00040001
+#define GPIO_PE1_U7TX           0x00040401
+
+#define GPIO_PB6_T0CCP0         0x00011807
+#define GPIO_PB7_T0CCP1         0x00011C07
+#define GPIO_PF0_T0CCP0         0x00050007
+#define GPIO_PF1_T0CCP1         0x00050407
+#define GPIO_PF2_T1CCP0         0x00050807
+#define GPIO_PF3_T1CCP1         0x00050C07
+
+#endif
@@ -0,0 +1,8 @@
+/*
+ * Host version of TivaWare's driverlib/rom.h.  There is no ROM on the host,
+ * so no ROM_ functions are defined and rom_map.h always picks the library.
+ */
+#ifndef __DRIVERLIB_ROM_H__
+#define __DRIVERLIB_ROM_H__
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Host version of TivaWare's driverlib/rom_map.h.  Every MAP_ function maps
+ * to the library version.
+ */
+#ifndef __DRIVERLIB_ROM_MAP_H__
+#define __DRIVERLIB_ROM_MAP_H__
+
+/* adc */
+#define MAP_ADCIntRegister              ADCIntRegister
+#define MAP_ADCIntUnregister            ADCIntUnregister
+#define MAP_ADCIntDisable               ADCIntDisable
+#define MAP_ADCIntEnable                ADCIntEnable
+#define MAP_ADCIntStatus                ADCIntStatus
+#define MAP_ADCIntClear                 ADCIntClear
+#define MAP_ADCSequenceEnable           ADCSequenceEnable
+#define MAP_ADCSequenceDisable          ADCSequenceDisable
+#define MAP_ADCSequenceConfigure        ADCSequenceConfigure
+#define MAP_ADCSequenceStepConfigure    ADCSequenceStepConfigure
+#define MAP_ADCSequenceOverflow         ADCSequenceOverflow
+#define MAP_ADCSequenceOverflowClear    ADCSequenceOverflowClear
+#define MAP_ADCSequenceUnderflow        ADCSequenceUnderflow
+#define MAP_ADCSequenceUnderflowClear   ADCSequenceUnderflowClear
+#define MAP_ADCSequenceDataGet          ADCSequenceDataGet
+#define MAP_ADCProcessorTrigger         ADCProcessorTrigger
+#define MAP_ADCBusy                     ADCBusy
+
+/* gpio */
+#define MAP_GPIODirModeSet              GPIODirModeSet
+#define MAP_GPIODirModeGet              GPIODirModeGet
+#define MAP_GPIOIntTypeSet              GPIOIntTypeSet
+#define MAP_GPIOIntTypeGet              GPIOIntTypeGet
+#define MAP_GPIOPadConfigSet            GPIOPadConfigSet
+#define MAP_GPIOPadConfigGet            GPIOPadConfigGet
+#define MAP_GPIOIntEnable               GPIOIntEnable
+#define MAP_GPIOIntDisable              GPIOIntDisable
+#define MAP_GPIOIntStatus               GPIOIntStatus
+#define MAP_GPIOIntClear                GPIOIntClear
+#define MAP_GPIOIntRegister             GPIOIntRegister
+#define MAP_GPIOIntUnregister           GPIOIntUnregister
+#define MAP_GPIOPinRead                 GPIOPinRead
+#define MAP_GPIOPinWrite                GPIOPinWrite
+#define MAP_GPIOPinConfigure            GPIOPinConfigure
+#define MAP_GPIOPinTypeADC              GPIOPinTypeADC
+#define MAP_GPIOPinTypeGPIOInput        GPIOPinTypeGPIOInput
+#define MAP_GPIOPinTypeGPIOOutput       GPIOPinTypeGPIOOutput
+#define MAP_GPIOPinTypeGPIOOutputOD     GPIOPinTypeGPIOOutputOD
+#define MAP_GPIOPinTypeTimer            GPIOPinTypeTimer
+#define MAP_GPIOPinTypeUART             GPIOPinTypeUART
+
+/* hibernate */
+#define MAP_HibernateEnableExpClk       HibernateEnableExpClk
+#define MAP_HibernateDisable            HibernateDisable
+#define MAP_HibernateIsActive           HibernateIsActive
+#define MAP_HibernateRTCEnable          HibernateRTCEnable
+#define MAP_HibernateRTCDisable         HibernateRTCDisable
+#define MAP_HibernateRTCSet             HibernateRTCSet
+#define MAP_HibernateRTCGet             HibernateRTCGet
+#define MAP_HibernateRTCMatchSet        HibernateRTCMatchSet
+#define MAP_HibernateRTCMatchGet        HibernateRTCMatchGet
+#define MAP_HibernateRTCSSGet           HibernateRTCSSGet
+#define MAP_HibernateRTCTrimSet         HibernateRTCTrimSet
+#define MAP_HibernateRTCTrimGet         HibernateRTCTrimGet
+#define MAP_HibernateWakeSet            HibernateWakeSet
+#define MAP_HibernateWakeGet            HibernateWakeGet
+#define MAP_HibernateGPIORetentionEnableHibernateGPIORetentionEnable
+#define MAP_HibernateGPIORetentionDisableHibernateGPIORetentionDisable
+#define MAP_HibernateGPIORetentionGet   HibernateGPIORetentionGet
+#define MAP_HibernateDataSet            HibernateDataSet
+#define MAP_HibernateDataGet            HibernateDataGet
+#define MAP_HibernateRequest            HibernateRequest
+#define MAP_HibernateIntEnable          HibernateIntEnable
+#define MAP_HibernateIntDisable         HibernateIntDisable
+#define MAP_HibernateIntRegister        HibernateIntRegister
+#define MAP_HibernateIntUnregister      HibernateIntUnregister
+#define MAP_HibernateIntStatus          HibernateIntStatus
+#define MAP_HibernateIntClear           HibernateIntClear
+
+/* interrupt */
+#define MAP_IntMasterEnable             IntMasterEnable
+#define MAP_IntMasterDisable            IntMasterDisable
+#define MAP_IntRegister                 IntRegister
+#define MAP_IntUnregister               IntUnregister
+#define MAP_IntPriorityGroupingSet      IntPriorityGroupingSet
+#define MAP_IntPriorityGroupingGet      IntPriorityGroupingGet
+#define MAP_IntPrioritySet              IntPrioritySet
+#define MAP_IntPriorityGet              IntPriorityGet
+#define MAP_IntEnable                   IntEnable
+#define MAP_IntDisable                  IntDisable
+#define MAP_IntIsEnabled                IntIsEnabled
+#define MAP_IntPendSet                  IntPendSet
+#define MAP_IntPendClear                IntPendClear
+
+/* sysctl */
+#define MAP_SysCtlClockSet              SysCtlClockSet
+#define MAP_SysCtlClockGet              SysCtlClockGet
+#define MAP_SysCtlDelay                 SysCtlDelay
+#define MAP_SysCtlPeripheralPresent     SysCtlPeripheralPresent
+#define MAP_SysCtlPeripheralReady       SysCtlPeripheralReady
+#define MAP_SysCtlPeripheralEnable      SysCtlPeripheralEnable
+#define MAP_SysCtlPeripheralDisable     SysCtlPeripheralDisable
+#define MAP_SysCtlPeripheralReset       SysCtlPeripheralReset
+#define MAP_SysCtlReset                 SysCtlReset
+#define MAP_SysCtlResetCauseGet         SysCtlResetCauseGet
+#define MAP_SysCtlResetCauseClear       SysCtlResetCauseClear
+
+/* timer */
+#define MAP_TimerEnable                 TimerEnable
+#define MAP_TimerDisable                TimerDisable
+#define MAP_TimerConfigure              TimerConfigure
+#define MAP_TimerPrescaleSet            TimerPrescaleSet
+#define MAP_TimerPrescaleGet            TimerPrescaleGet
+#define MAP_TimerLoadSet                TimerLoadSet
+#define MAP_TimerLoadGet                TimerLoadGet
+#define MAP_TimerValueGet               TimerValueGet
+#define MAP_TimerMatchSet               TimerMatchSet
+#define MAP_TimerMatchGet               TimerMatchGet
+#define MAP_TimerIntRegister            TimerIntRegister
+#define MAP_TimerIntUnregister          TimerIntUnregister
+#define MAP_TimerIntEnable              TimerIntEnable
+#define MAP_TimerIntDisable             TimerIntDisable
+#define MAP_TimerIntStatus              TimerIntStatus
+#define MAP_TimerIntClear               TimerIntClear
+
+/* uart */
+#define MAP_UARTParityModeSet           UARTParityModeSet
+#define MAP_UARTParityModeGet           UARTParityModeGet
+#define MAP_UARTFIFOLevelSet            UARTFIFOLevelSet
+#define MAP_UARTFIFOLevelGet            UARTFIFOLevelGet
+#define MAP_UARTConfigSetExpClk         UARTConfigSetExpClk
+#define MAP_UARTConfigGetExpClk         UARTConfigGetExpClk
+#define MAP_UARTEnable                  UARTEnable
+#define MAP_UARTDisable                 UARTDisable
+#define MAP_UARTFIFOEnable              UARTFIFOEnable
+#define MAP_UARTFIFODisable             UARTFIFODisable
+#define MAP_UARTCharsAvail              UARTCharsAvail
+#define MAP_UARTSpaceAvail              UARTSpaceAvail
+#define MAP_UARTCharGetNonBlocking      UARTCharGetNonBlocking
+#define MAP_UARTCharGet                 UARTCharGet
+#define MAP_UARTCharPutNonBlocking      UARTCharPutNonBlocking
+#define MAP_UARTCharPut                 UARTCharPut
+#define MAP_UARTBusy                    UARTBusy
+#define MAP_UARTIntRegister             UARTIntRegister
+#define MAP_UARTIntUnregister           UARTIntUnregister
+#define MAP_UARTIntEnable               UARTIntEnable
+#define MAP_UARTIntDisable              UARTIntDisable
+#define MAP_UARTIntStatus               UARTIntStatus
+#define MAP_UARTIntClear                UARTIntClear
+#define MAP_UARTTxIntModeSet            UARTTxIntModeSet
+#define MAP_UARTTxIntModeGet            UARTTxIntModeGet
+#define MAP_UARTClockSourceSet          UARTClockSourceSet
+#define MAP_UARTClockSourceGet          UARTClockSourceGet
+#define MAP_UARTDMAEnable               UARTDMAEnable
+#define MAP_UARTDMADisable              UARTDMADisable
+
+/* udma */
+#define MAP_uDMAEnable                  uDMAEnable
+#define MAP_uDMADisable                 uDMADisable
+#define MAP_uDMAControlBaseSet          uDMAControlBaseSet
+#define MAP_uDMAChannelAssign           uDMAChannelAssign
+#define MAP_uDMAChannelAttributeEnable  uDMAChannelAttributeEnable
+#define MAP_uDMAChannelAttributeDisable uDMAChannelAttributeDisable
+#define MAP_uDMAChannelControlSet       uDMAChannelControlSet
+#define MAP_uDMAChannelTransferSet      uDMAChannelTransferSet
+#define MAP_uDMAChannelEnable           uDMAChannelEnable
+#define MAP_uDMAChannelDisable          uDMAChannelDisable
+#define MAP_uDMAChannelIsEnabled        uDMAChannelIsEnabled
+#define MAP_uDMAIntClear                uDMAIntClear
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Host version of TivaWare's driverlib/sysctl.h, for the TM4C123 class.
+ */
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Peripherals, encoded as 0xF000 | (RCGCxxx offset << 8) | instance.
+ */
+#define SYSCTL_PERIPH_ADC0      0xf0003800
+#define SYSCTL_PERIPH_ADC1      0xf0003801
+#define SYSCTL_PERIPH_CAN0      0xf0003400
+#define SYSCTL_PERIPH_CAN1      0xf0003401
+#define SYSCTL_PERIPH_COMP0     0xf0003c00
+#define SYSCTL_PERIPH_EEPROM0   0xf0005800
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOB     0xf0000801
+#define SYSCTL_PERIPH_GPIOC     0xf0000802
+#define SYSCTL_PERIPH_GPIOD     0xf0000803
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_GPIOF     0xf0000805
+#define SYSCTL_PERIPH_HIBERNATE 0xf0001400
+#define SYSCTL_PERIPH_I2C0      0xf0002000
+#define SYSCTL_PERIPH_I2C1      0xf0002001
+#define SYSCTL_PERIPH_I2C2      0xf0002002
+#define SYSCTL_PERIPH_I2C3      0xf0002003
+#define SYSCTL_PERIPH_PWM0      0xf0004000
+#define SYSCTL_PERIPH_PWM1      0xf0004001
+#define SYSCTL_PERIPH_QEI0      0xf0004400
+#define SYSCTL_PERIPH_QEI1      0xf0004401
+#define SYSCTL_PERIPH_SSI0      0xf0001c00
+#define SYSCTL_PERIPH_SSI1      0xf0001c01
+#define SYSCTL_PERIPH_SSI2      0xf0001c02
+#define SYSCTL_PERIPH_SSI3      0xf0001c03
+#define SYSCTL_PERIPH_TIMER0    0xf0000400
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_TIMER2    0xf0000402
+#define SYSCTL_PERIPH_TIMER3    0xf0000403
+#define SYSCTL_PERIPH_TIMER4    0xf0000404
+#define SYSCTL_PERIPH_TIMER5    0xf0000405
+#define SYSCTL_PERIPH_UART0     0xf0001800
+#define SYSCTL_PERIPH_UART1     0xf0001801
+#define SYSCTL_PERIPH_UART2     0xf0001802
+#define SYSCTL_PERIPH_UART3     0xf0001803
+#define SYSCTL_PERIPH_UART4     0xf0001804
+#define SYSCTL_PERIPH_UART5     0xf0001805
+#define SYSCTL_PERIPH_UART6     0xf0001806
+#define SYSCTL_PERIPH_UART7     0xf0001807
+#define SYSCTL_PERIPH_UDMA      0xf0000c00
+#define SYSCTL_PERIPH_USB0      0xf0002800
+#define SYSCTL_PERIPH_WDOG0     0xf0000000
+#define SYSCTL_PERIPH_WDOG1     0xf0000001
+#define SYSCTL_PERIPH_WTIMER0   0xf0005c00
+#define SYSCTL_PERIPH_WTIMER1   0xf0005c01
+#define SYSCTL_PERIPH_WTIMER2   0xf0005c02
+#define SYSCTL_PERIPH_WTIMER3   0xf0005c03
+#define SYSCTL_PERIPH_WTIMER4   0xf0005c04
+#define SYSCTL_PERIPH_WTIMER5   0xf0005c05
+
+/*
+ * Reset causes, as returned by SysCtlResetCauseGet().
+ */
+#define SYSCTL_CAUSE_HSRVREQ    0x00001000
+#define SYSCTL_CAUSE_HIB        0x00000040
+#define SYSCTL_CAUSE_WDOG1      0x00000020
+#define SYSCTL_CAUSE_SW         0x00000010
+#define SYSCTL_CAUSE_WDOG0      0x00000008
+#define SYSCTL_CAUSE_WDOG       SYSCTL_CAUSE_WDOG0
+#define SYSCTL_CAUSE_BOR        0x00000004
+#define SYSCTL_CAUSE_POR        0x00000002
+#define SYSCTL_CAUSE_EXT        0x00000001
+
+/*
+ * Configuration of SysCtlClockSet().
+ */
+#define SYSCTL_SYSDIV_1         0x07800000
+#define SYSCTL_SYSDIV_2         0x00C00000
+#define SYSCTL_SYSDIV_3         0x01400000
+#define SYSCTL_SYSDIV_4         0x01C00000
+#define SYSCTL_SYSDIV_5         0x02400000
+#define SYSCTL_SYSDIV_6         0x02C00000
+#define SYSCTL_SYSDIV_7         0x03400000
+#define SYSCTL_SYSDIV_8         0x03C00000
+#define SYSCTL_SYSDIV_9         0x04400000
+#define SYSCTL_SYSDIV_10        0x04C00000
+#define SYSCTL_SYSDIV_11        0x05400000
+#define SYSCTL_SYSDIV_12        0x05C00000
+#define SYSCTL_SYSDIV_13        0x06400000
+#define SYSCTL_SYSDIV_14        0x06C00000
+#define SYSCTL_SYSDIV_15        0x07400000
+#define SYSCTL_SYSDIV_16        0x07C00000
+#define SYSCTL_SYSDIV_2_5       0xC1000000
+#define SYSCTL_SYSDIV_3_5       0xC1800000
+#define SYSCTL_SYSDIV_4_5       0xC2000000
+#define SYSCTL_SYSDIV_5_5       0xC2800000
+#define SYSCTL_SYSDIV_6_5       0xC3000000
+#define SYSCTL_SYSDIV_7_5       0xC3800000
+#define SYSCTL_USE_PLL          0x00000000
+#define SYSCTL_USE_OSC          0x00003800
+#define SYSCTL_XTAL_4MHZ        0x00000180
+#define SYSCTL_XTAL_5MHZ        0x00000240
+#define SYSCTL_XTAL_6MHZ        0x000002C0
+#define SYSCTL_XTAL_8MHZ        0x00000380
+#define SYSCTL_XTAL_10MHZ       0x00000400
+#define SYSCTL_XTAL_12MHZ       0x00000440
+#define SYSCTL_XTAL_16MHZ       0x00000540
+#define SYSCTL_XTAL_20MHZ       0x00000600
+#define SYSCTL_XTAL_24MHZ       0x00000640
+#define SYSCTL_XTAL_25MHZ       0x00000680
+#define SYSCTL_OSC_MAIN         0x00000000
+#define SYSCTL_OSC_INT          0x00000010
+#define SYSCTL_OSC_INT4         0x00000020
+#define SYSCTL_OSC_INT30        0x00000030
+#define SYSCTL_INT_OSC_DIS      0x00000002
+#define SYSCTL_MAIN_OSC_DIS     0x00000001
+
+extern void SysCtlClockSet(uint32_t ui32Config);
+extern uint32_t SysCtlClockGet(void);
+extern void SysCtlDelay(uint32_t ui32Count);
+extern bool SysCtlPeripheralPresent(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralDisable(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralReset(uint32_t ui32Peripheral);
+extern void SysCtlReset(void);
+extern uint32_t SysCtlResetCauseGet(void);
+extern void SysCtlResetCauseClear(uint32_t ui32Causes);
+
+#endif
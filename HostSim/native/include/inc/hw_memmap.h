@@ -0,0 +1,72 @@
+/*
+ * Host version of TivaWare's inc/hw_memmap.h.
+ *
+ * The base addresses are those of the device: the host driverlib hands them
+ * to the board, and HWREG() maps them to the register images.
+ */
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define FLASH_BASE              0x00000000
+#define SRAM_BASE               0x20000000
+#define WATCHDOG0_BASE          0x40000000
+#define WATCHDOG1_BASE          0x40001000
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define GPIO_PORTC_BASE         0x40006000
+#define GPIO_PORTD_BASE         0x40007000
+#define SSI0_BASE               0x40008000
+#define SSI1_BASE               0x40009000
+#define SSI2_BASE               0x4000A000
+#define SSI3_BASE               0x4000B000
+#define UART0_BASE              0x4000C000
+#define UART1_BASE              0x4000D000
+#define UART2_BASE              0x4000E000
+#define UART3_BASE              0x4000F000
+#define UART4_BASE              0x40010000
+#define UART5_BASE              0x40011000
+#define UART6_BASE              0x40012000
+#define UART7_BASE              0x40013000
+#define I2C0_BASE               0x40020000
+#define I2C1_BASE               0x40021000
+#define I2C2_BASE               0x40022000
+#define I2C3_BASE               0x40023000
+#define GPIO_PORTE_BASE         0x40024000
+#define GPIO_PORTF_BASE         0x40025000
+#define PWM0_BASE               0x40028000
+#define PWM1_BASE               0x40029000
+#define QEI0_BASE               0x4002C000
+#define QEI1_BASE               0x4002D000
+#define TIMER0_BASE             0x40030000
+#define TIMER1_BASE             0x40031000
+#define TIMER2_BASE             0x40032000
+#define TIMER3_BASE             0x40033000
+#define TIMER4_BASE             0x40034000
+#define TIMER5_BASE             0x40035000
+#define WTIMER0_BASE            0x40036000
+#define WTIMER1_BASE            0x40037000
+#define ADC0_BASE               0x40038000
+#define ADC1_BASE               0x40039000
+#define COMP_BASE               0x4003C000
+#define CAN0_BASE               0x40040000
+#define CAN1_BASE               0x40041000
+#define WTIMER2_BASE            0x4004C000
+#define WTIMER3_BASE            0x4004D000
+#define WTIMER4_BASE            0x4004E000
+#define WTIMER5_BASE            0x4004F000
+#define USB0_BASE               0x40050000
+#define GPIO_PORTA_AHB_BASE     0x40058000
+#define GPIO_PORTB_AHB_BASE     0x40059000
+#define GPIO_PORTC_AHB_BASE     0x4005A000
+#define GPIO_PORTD_AHB_BASE     0x4005B000
+#define GPIO_PORTE_AHB_BASE     0x4005C000
+#define GPIO_PORTF_AHB_BASE     0x4005D000
+#define EEPROM_BASE             0x400AF000
+#define SYSEXC_BASE             0x400F9000
+#define HIB_BASE                0x400FC000
+#define FLASH_CTRL_BASE         0x400FD000
+#define SYSCTL_BASE             0x400FE000
+#define UDMA_BASE               0x400FF000
+#define NVIC_BASE               0xE000E000
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Host version of TivaWare's inc/hw_types.h.
+ *
+ * The register access macros go through the register images of the host
+ * runtime; bit-band accesses use the alias region, which the board decodes.
+ */
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../native.h"
+
+#define HWREG(x)                                                              \
+        (*((volatile uint32_t *)SimNativeWindow((uint32_t)(x))))
+#define HWREGH(x)                                                             \
+        (*((volatile uint16_t *)SimNativeWindow((uint32_t)(x))))
+#define HWREGB(x)                                                             \
+        (*((volatile uint8_t *)SimNativeWindow((uint32_t)(x))))
+#define HWREGBITW(x, b)                                                       \
+        HWREG(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                     \
+              (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
+#define HWREGBITH(x, b)                                                       \
+        HWREGH(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                    \
+               (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
+#define HWREGBITB(x, b)                                                       \
+        HWREGB(((uint32_t)(x) & 0xF0000000) | 0x02000000 |                    \
+               (((uint32_t)(x) & 0x000FFFFF) << 5) | ((b) << 2))
+
+#define CLASS_IS_TM4C123        1
+#define CLASS_IS_TM4C129        0
+
+#define REVISION_IS_A0          0
+#define REVISION_IS_A1          0
+#define REVISION_IS_A2          0
+#define REVISION_IS_B0          0
+#define REVISION_IS_B1          0
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Host version of TivaWare's inc/tm4c123gh6pm.h.
+ *
+ * Only the interrupt assignments are provided; the projects built for the
+ * host reach the registers through driverlib or inc/hw_types.h.
+ */
+#ifndef __TM4C123GH6PM_H__
+#define __TM4C123GH6PM_H__
+
+#include "hw_ints.h"
+
+#endif
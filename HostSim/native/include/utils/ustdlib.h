@@ -0,0 +1,30 @@
+/*
+ * Host version of TivaWare's utils/ustdlib.h.  The projects only include it,
+ * so it maps the few functions it declares onto the C library.
+ */
+#ifndef __UTILS_USTDLIB_H__
+#define __UTILS_USTDLIB_H__
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#define uvsnprintf              vsnprintf
+#define usprintf                sprintf
+#define usnprintf               snprintf
+#define ustrlen                 strlen
+#define ustrncpy                strncpy
+#define ustrstr                 strstr
+#define ustrncmp                strncmp
+#define ustrcmp                 strcmp
+#define ustrcasecmp             strcasecmp
+#define ustrncasecmp            strncasecmp
+#define ustrtoul                strtoul
+#define ustrtof                 strtof
+#define uatoi                   atoi
+#define umemcpy                 memcpy
+
+#endif
@@ -0,0 +1,815 @@
+/*
+ * Runtime for firmware compiled for the host.
+ */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "native.h"
+
+#define NATIVE_PAGE_WORDS       1024
+#define NATIVE_SIGNAL           SIGUSR1
+
+/*
+ * Cycles charged for a register access made by a host library.
+ */
+#define NATIVE_ACCESS_CYCLES    4
+
+/*
+ * Register image of one 4 KB page.  The firmware reads and writes pui32Image;
+ * pui32Shadow holds what was last published, so a difference between the
+ * two is a write still to be applied to the board.
+ */
+typedef struct
+{
+    uint32_t ui32Base;
+    volatile uint32_t pui32Image[NATIVE_PAGE_WORDS];
+    uint32_t pui32Shadow[NATIVE_PAGE_WORDS];
+} tNativeWindow;
+
+static tNativeWindow g_psWindows[SIM_NATIVE_WINDOWS];
+static volatile uint32_t g_ui32Windows;
+static tNativeWindow *volatile g_psLastWindow;
+
+static tSimBoard g_sBoard;
+static tSimNativeStats g_sStats;
+static tSimNativeConfig g_sConfig;
+
+/*
+ * State shared between the firmware thread, its signal handler and the
+ * simulator thread.
+ */
+static pthread_t g_sFirmware;
+static sigjmp_buf g_sBoot;
+static sem_t g_sServiced;
+static volatile sig_atomic_t g_i32InHook;
+static volatile sig_atomic_t g_bInService;
+static volatile sig_atomic_t g_bDeferred;
+static volatile sig_atomic_t g_bPrimask;
+static volatile sig_atomic_t g_bStop;
+static volatile sig_atomic_t g_bProbe;
+static volatile sig_atomic_t g_bBusy;
+static uint32_t g_ui32Activity;
+
+extern int SimFirmwareMain(void);
+
+static void
+NativeActivity(void)
+{
+    __atomic_store_n(&g_ui32Activity,
+                     __atomic_load_n(&g_ui32Activity, __ATOMIC_RELAXED) + 1,
+                     __ATOMIC_RELAXED);
+}
+
+/*
+ * Returns the value a register shows in its image.  The NVIC set and clear
+ * registers read as zero, so that writing a bit that is already set is still
+ * seen as a write.
+ */
+static void
+NativePeek(uint32_t ui32Addr, uint32_t *pui32Value)
+{
+    if(((ui32Addr >= 0xE000E100U) && (ui32Addr < 0xE000E300U)) ||
+       !SimBoardPeek(&g_sBoard, ui32Addr, pui32Value))
+        *pui32Value = 0;
+}
+
+/*
+ * Copies the board's view of every mapped register into the images.
+ */
+static void
+NativePublish(void)
+{
+    uint32_t ui32Win, ui32Word, ui32Value;
+    tNativeWindow *psWin;
+
+    for(ui32Win = 0; ui32Win < g_ui32Windows; ui32Win++)
+    {
+        psWin = &g_psWindows[ui32Win];
+
+        for(ui32Word = 0; ui32Word < NATIVE_PAGE_WORDS; ui32Word++)
+        {
+            NativePeek(psWin->ui32Base + ui32Word * 4, &ui32Value);
+            psWin->pui32Shadow[ui32Word] = ui32Value;
+            psWin->pui32Image[ui32Word] = ui32Value;
+        }
+    }
+}
+
+/*
+ * Returns the order in which a register write is applied.  The writes made
+ * since the last service are applied by address, which is wrong for the few
+ * registers that gate or trigger the others.
+ */
+static uint32_t
+NativeWriteRank(uint32_t ui32Addr)
+{
+    /*
+     * The GPIO lock and commit registers gate writes to the registers below
+     * them.
+     */
+    if((ui32Addr >> 20) == 0x400)
+        return(((ui32Addr & 0xFFF) == 0x520) || ((ui32Addr & 0xFFF) == 0x524) ?
+               0 : 1);
+
+    /*
+     * SysTick is enabled after its reload and current values are set.
+     */
+    if(ui32Addr == 0xE000E010U)
+        return(2);
+
+    return(1);
+}
+
+/*
+ * Applies the register writes made by the firmware to the board.
+ */
+static void
+NativeReconcile(void)
+{
+    static uint32_t pui32Changed[NATIVE_PAGE_WORDS];
+    uint32_t ui32Win, ui32Word, ui32Count, ui32Rank, ui32Idx, ui32Addr;
+    tNativeWindow *psWin;
+
+    for(ui32Win = 0; ui32Win < g_ui32Windows; ui32Win++)
+    {
+        psWin = &g_psWindows[ui32Win];
+
+        for(ui32Word = 0, ui32Count = 0; ui32Word < NATIVE_PAGE_WORDS;
+            ui32Word++)
+        {
+            if(psWin->pui32Image[ui32Word] != psWin->pui32Shadow[ui32Word])
+                pui32Changed[ui32Count++] = ui32Word;
+        }
+
+        for(ui32Rank = 0; ui32Rank < 3; ui32Rank++)
+        {
+            for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+            {
+                ui32Word = pui32Changed[ui32Idx];
+                ui32Addr = psWin->ui32Base + ui32Word * 4;
+
+                if(NativeWriteRank(ui32Addr) != ui32Rank)
+                    continue;
+
+                psWin->pui32Shadow[ui32Word] = psWin->pui32Image[ui32Word];
+                SimBoardWrite(&g_sBoard, ui32Addr, 4,
+                              psWin->pui32Shadow[ui32Word]);
+            }
+        }
+    }
+
+    if(g_sBoard.ui32ResetRequest)
+        SimNativeReset();
+}
+
+/*
+ * Updates the image of a register after the host libraries accessed it
+ * directly.
+ */
+static void
+NativeRefresh(uint32_t ui32Addr)
+{
+    uint32_t ui32Win, ui32Word, ui32Value;
+    tNativeWindow *psWin;
+
+    for(ui32Win = 0; ui32Win < g_ui32Windows; ui32Win++)
+    {
+        psWin = &g_psWindows[ui32Win];
+
+        if(psWin->ui32Base != (ui32Addr & ~0xFFFU))
+            continue;
+
+        ui32Word = (ui32Addr & 0xFFF) / 4;
+        NativePeek(ui32Addr & ~3U, &ui32Value);
+        psWin->pui32Shadow[ui32Word] = ui32Value;
+        psWin->pui32Image[ui32Word] = ui32Value;
+        return;
+    }
+}
+
+/*
+ * Runs the handlers of the interrupts the NVIC would take now.  Handlers run
+ * to completion one after the other, so pending interrupts tail-chain.
+ */
+static bool
+NativeDispatch(void)
+{
+    tSimNVIC *psNVIC = &g_sBoard.sNVIC;
+    uint32_t ui32Exc;
+    bool bTaken = false;
+
+    for(;;)
+    {
+        ui32Exc = SimNVICPendingException(psNVIC,
+                                          SimNVICExecPriority(psNVIC,
+                                                              g_bPrimask, 0,
+                                                              false));
+
+        if(!ui32Exc)
+            break;
+
+        SimNVICActivate(psNVIC, ui32Exc);
+        NativePublish();
+
+        if(g_pfnSimVectors[ui32Exc])
+            g_pfnSimVectors[ui32Exc]();
+        else
+            SimNativeDefaultHandler();
+
+        NativeReconcile();
+        SimNVICDeactivate(psNVIC, ui32Exc);
+
+        g_sStats.ui64Interrupts++;
+        bTaken = true;
+    }
+
+    return(bTaken);
+}
+
+/*
+ * Parks the firmware thread for the rest of the run.
+ */
+static __attribute__((noreturn)) void
+NativeStop(void)
+{
+    g_bStop = 1;
+
+    if(g_bInService)
+        sem_post(&g_sServiced);
+
+    for(;;)
+        pause();
+}
+
+/*
+ * Returns the number of cycles left until the end of the run.
+ */
+static uint64_t
+NativeLeft(void)
+{
+    uint64_t ui64Left, ui64Cycles;
+
+    ui64Left = (g_sConfig.ui64EndTime > g_sBoard.ui64Time) ?
+               (g_sConfig.ui64EndTime - g_sBoard.ui64Time) /
+               g_sBoard.ui32CyclePs : 0;
+
+    if(g_sConfig.ui64EndCycle)
+    {
+        ui64Cycles = (g_sConfig.ui64EndCycle > g_sBoard.ui64Cycle) ?
+                     g_sConfig.ui64EndCycle - g_sBoard.ui64Cycle : 0;
+
+        if(ui64Cycles < ui64Left)
+            ui64Left = ui64Cycles;
+    }
+
+    return(ui64Left);
+}
+
+/*
+ * Moves simulated time on to the next event.  Returns false if the end of the
+ * run comes first, in which case time stops there.
+ */
+static bool
+NativeAdvance(void)
+{
+    uint64_t ui64Cycles = SimBoardNextEvent(&g_sBoard);
+    uint64_t ui64Left = NativeLeft();
+
+    if(ui64Cycles >= ui64Left)
+    {
+        SimBoardAdvance(&g_sBoard, ui64Left);
+        return(false);
+    }
+
+    SimBoardAdvance(&g_sBoard, ui64Cycles);
+    return(true);
+}
+
+/*
+ * Carries out what the board asked for during a host library call: the
+ * power down of hibernation, a system reset, or the end of the run.
+ */
+static void
+NativeCheck(void)
+{
+    while(g_sBoard.bHibernating && !g_sBoard.ui32ResetRequest)
+    {
+        if(!NativeAdvance())
+            NativeStop();
+    }
+
+    if(g_sBoard.ui32ResetRequest)
+        SimNativeReset();
+
+    if(!NativeLeft())
+        NativeStop();
+}
+
+/*
+ * Services the idle firmware thread: takes the pending interrupts or, if
+ * there are none, moves simulated time on to the next event.
+ */
+static void
+NativeService(void)
+{
+    g_bInService = 1;
+
+    NativeReconcile();
+
+    if(!NativeDispatch())
+    {
+        if(!NativeAdvance())
+        {
+            g_bStop = 1;
+        }
+        else
+        {
+            if(g_sBoard.ui32ResetRequest)
+                SimNativeReset();
+
+            NativeDispatch();
+        }
+    }
+
+    NativePublish();
+
+    g_sStats.ui64Services++;
+    g_bInService = 0;
+    sem_post(&g_sServiced);
+}
+
+/*
+ * Returns true if the firmware thread was interrupted in a jump to itself,
+ * which is what `while(1) {}` compiles to.
+ */
+static bool
+NativeSpinning(void *pvContext)
+{
+#if defined(__x86_64__)
+    const uint8_t *pui8PC;
+
+    pui8PC = (const uint8_t *)((ucontext_t *)pvContext)->
+             uc_mcontext.gregs[REG_RIP];
+
+    return((pui8PC[0] == 0xEB) && (pui8PC[1] == 0xFE));
+#else
+    (void)pvContext;
+
+    return(false);
+#endif
+}
+
+static void
+NativeSignal(int i32Signal, siginfo_t *psInfo, void *pvContext)
+{
+    int i32Errno = errno;
+
+    (void)i32Signal;
+    (void)psInfo;
+
+    /*
+     * Once the run has ended the firmware thread stays parked and only
+     * acknowledges the simulator.
+     */
+    if(g_bStop)
+    {
+        sem_post(&g_sServiced);
+        errno = i32Errno;
+        return;
+    }
+
+    /*
+     * A probe only services a thread that is known to be idle; anything else
+     * is left to run until it settles.
+     */
+    if(g_bProbe && (g_i32InHook || g_bInService ||
+                    (!g_sStats.bFinished && !NativeSpinning(pvContext))))
+    {
+        g_bBusy = 1;
+        sem_post(&g_sServiced);
+        errno = i32Errno;
+        return;
+    }
+
+    /*
+     * Inside a hook the board may be half way through an update; the service
+     * is done when the hook is left.
+     */
+    if(g_i32InHook || g_bInService)
+        g_bDeferred = 1;
+    else
+        NativeService();
+
+    errno = i32Errno;
+}
+
+static void *
+NativeFirmwareThread(void *pvArg)
+{
+    sigset_t sSet;
+
+    (void)pvArg;
+
+    sigemptyset(&sSet);
+    sigaddset(&sSet, NATIVE_SIGNAL);
+    pthread_sigmask(SIG_UNBLOCK, &sSet, NULL);
+
+    /*
+     * A system reset restarts the firmware here.
+     */
+    sigsetjmp(g_sBoot, 1);
+
+    SimFirmwareMain();
+
+    /*
+     * Returning from main() ends up in an endless loop on the target, where
+     * interrupts are still taken.
+     */
+    g_sStats.bFinished = true;
+
+    for(;;)
+        pause();
+
+    return(NULL);
+}
+
+void
+SimNativeInit(const tSimBoardHooks *psHooks)
+{
+    SimBoardInit(&g_sBoard, psHooks);
+    sem_init(&g_sServiced, 0, 0);
+}
+
+tSimBoard *
+SimNativeBoard(void)
+{
+    return(&g_sBoard);
+}
+
+const tSimNativeStats *
+SimNativeStats(void)
+{
+    return(&g_sStats);
+}
+
+/*
+ * Runs the firmware until simulated time reaches the end of the run.
+ */
+void
+SimNativeRun(const tSimNativeConfig *psConfig)
+{
+    struct sigaction sAction;
+    uint32_t ui32Seen;
+    sigset_t sSet;
+
+    g_sConfig = *psConfig;
+
+    memset(&sAction, 0, sizeof(sAction));
+    sAction.sa_sigaction = NativeSignal;
+    sAction.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&sAction.sa_mask);
+    sigaction(NATIVE_SIGNAL, &sAction, NULL);
+
+    /*
+     * Only the firmware thread takes the service signal.
+     */
+    sigemptyset(&sSet);
+    sigaddset(&sSet, NATIVE_SIGNAL);
+    pthread_sigmask(SIG_BLOCK, &sSet, NULL);
+
+    if(pthread_create(&g_sFirmware, NULL, NativeFirmwareThread, NULL))
+    {
+        fprintf(stderr, "native: cannot start the firmware thread\n");
+        exit(1);
+    }
+
+    while(!g_bStop)
+    {
+        /*
+         * A firmware thread sitting in `while(1) {}` is serviced straight
+         * away.
+         */
+        if(g_sConfig.bIdleCheck)
+        {
+            g_bBusy = 0;
+            g_bProbe = 1;
+            pthread_kill(g_sFirmware, NATIVE_SIGNAL);
+
+            while(sem_wait(&g_sServiced) && (errno == EINTR))
+            {
+            }
+
+            g_bProbe = 0;
+
+            if(!g_bBusy)
+            {
+                if(g_sConfig.pfnServiced)
+                    g_sConfig.pfnServiced(g_sConfig.pvContext);
+
+                continue;
+            }
+        }
+
+        /*
+         * Otherwise wait until the firmware has stopped touching the
+         * hardware, which means it is spinning in an idle loop.
+         */
+        do
+        {
+            ui32Seen = __atomic_load_n(&g_ui32Activity, __ATOMIC_RELAXED);
+            usleep(g_sConfig.ui32SettleUs);
+
+            /*
+             * A firmware that never idles, going through wake after wake
+             * from hibernation for example, still has its output taken.
+             */
+            if(g_sConfig.pfnServiced)
+                g_sConfig.pfnServiced(g_sConfig.pvContext);
+        }
+        while((ui32Seen != __atomic_load_n(&g_ui32Activity,
+                                           __ATOMIC_RELAXED)) ||
+              g_i32InHook);
+
+        pthread_kill(g_sFirmware, NATIVE_SIGNAL);
+
+        while(sem_wait(&g_sServiced) && (errno == EINTR))
+        {
+        }
+
+        if(g_sConfig.pfnServiced)
+            g_sConfig.pfnServiced(g_sConfig.pvContext);
+    }
+}
+
+/*
+ * Returns the host address that stands for a peripheral register.
+ */
+uintptr_t
+SimNativeWindow(uint32_t ui32Addr)
+{
+    uint32_t ui32Base = ui32Addr & ~0xFFFU;
+    tNativeWindow *psWin = g_psLastWindow;
+    uint32_t ui32Win, ui32Word, ui32Value;
+
+    NativeActivity();
+
+    if(psWin && (psWin->ui32Base == ui32Base))
+        return((uintptr_t)psWin->pui32Image + (ui32Addr & 0xFFF));
+
+    for(ui32Win = 0; ui32Win < g_ui32Windows; ui32Win++)
+    {
+        if(g_psWindows[ui32Win].ui32Base == ui32Base)
+        {
+            psWin = &g_psWindows[ui32Win];
+            g_psLastWindow = psWin;
+            return((uintptr_t)psWin->pui32Image + (ui32Addr & 0xFFF));
+        }
+    }
+
+    if(g_ui32Windows == SIM_NATIVE_WINDOWS)
+    {
+        fprintf(stderr, "native: too many register pages (0x%08x)\n",
+                ui32Addr);
+        abort();
+    }
+
+    SimNativeEnter();
+
+    psWin = &g_psWindows[g_ui32Windows];
+    psWin->ui32Base = ui32Base;
+
+    for(ui32Word = 0; ui32Word < NATIVE_PAGE_WORDS; ui32Word++)
+    {
+        NativePeek(ui32Base + ui32Word * 4, &ui32Value);
+        psWin->pui32Shadow[ui32Word] = ui32Value;
+        psWin->pui32Image[ui32Word] = ui32Value;
+    }
+
+    g_ui32Windows++;
+    g_psLastWindow = psWin;
+
+    SimNativeLeave();
+
+    return((uintptr_t)psWin->pui32Image + (ui32Addr & 0xFFF));
+}
+
+/*
+ * Marks the start of a host library call that works on the board directly.
+ * Register writes the firmware made through the images are applied first,
+ * so the board sees all accesses in program order.
+ */
+void
+SimNativeEnter(void)
+{
+    NativeActivity();
+
+    if(!g_i32InHook++ && !g_bInService && g_ui32Windows)
+        NativeReconcile();
+}
+
+void
+SimNativeLeave(void)
+{
+    if(--g_i32InHook || g_bInService)
+        return;
+
+    /*
+     * Take what the hardware would have done in the meantime: a service the
+     * simulator asked for, or interrupts that became pending in the hook.
+     */
+    while(g_bDeferred)
+    {
+        g_bDeferred = 0;
+        NativeService();
+    }
+
+    if(!g_bPrimask &&
+       SimNVICPendingException(&g_sBoard.sNVIC,
+                               SimNVICExecPriority(&g_sBoard.sNVIC, false, 0,
+                                                   false)))
+    {
+        g_bInService = 1;
+        NativeReconcile();
+        NativeDispatch();
+        NativePublish();
+        g_bInService = 0;
+
+        while(g_bDeferred)
+        {
+            g_bDeferred = 0;
+            NativeService();
+        }
+    }
+
+    NativeCheck();
+}
+
+/*
+ * Charges the time taken by a host library call to simulated time.  Time
+ * advances from event to event, so interrupts are taken when they fall due
+ * even during a long delay.
+ */
+void
+SimNativeCharge(uint64_t ui64Cycles)
+{
+    uint64_t ui64Step;
+
+    do
+    {
+        SimNativeEnter();
+
+        ui64Step = SimBoardNextEvent(&g_sBoard);
+
+        if(ui64Step > ui64Cycles)
+            ui64Step = ui64Cycles;
+
+        SimBoardAdvance(&g_sBoard, ui64Step);
+        ui64Cycles -= ui64Step;
+
+        SimNativeLeave();
+    }
+    while(ui64Cycles);
+}
+
+/*
+ * Lets simulated time run on to the next event, for host library calls that
+ * wait for the hardware.
+ */
+void
+SimNativeWait(void)
+{
+    uint64_t ui64Cycles, ui64Left;
+
+    SimNativeEnter();
+
+    ui64Cycles = SimBoardNextEvent(&g_sBoard);
+    ui64Left = NativeLeft();
+
+    SimBoardAdvance(&g_sBoard, (ui64Cycles < ui64Left) ? ui64Cycles :
+                                                          ui64Left);
+
+    SimNativeLeave();
+}
+
+/*
+ * WFI: lets simulated time run on until an interrupt is pending, which is
+ * then taken unless PRIMASK masks it.
+ */
+void
+SimNativeSleep(void)
+{
+    tSimNVIC *psNVIC = &g_sBoard.sNVIC;
+
+    SimNativeEnter();
+
+    while(!g_sBoard.bHibernating &&
+          !SimNVICPendingException(psNVIC,
+                                   SimNVICExecPriority(psNVIC, false, 0,
+                                                       false)))
+    {
+        if(!NativeAdvance())
+            break;
+    }
+
+    SimNativeLeave();
+}
+
+/*
+ * Register accesses of the host libraries, which go to the board directly.
+ */
+uint32_t
+SimNativeRead(uint32_t ui32Addr)
+{
+    uint32_t ui32Value = 0;
+
+    SimNativeEnter();
+
+    SimBoardRead(&g_sBoard, ui32Addr, 4, &ui32Value);
+    SimBoardAdvance(&g_sBoard, NATIVE_ACCESS_CYCLES);
+    NativeRefresh(ui32Addr);
+
+    SimNativeLeave();
+
+    return(ui32Value);
+}
+
+void
+SimNativeWrite(uint32_t ui32Addr, uint32_t ui32Value)
+{
+    SimNativeEnter();
+
+    SimBoardWrite(&g_sBoard, ui32Addr, 4, ui32Value);
+    SimBoardAdvance(&g_sBoard, NATIVE_ACCESS_CYCLES);
+    NativeRefresh(ui32Addr);
+
+    SimNativeLeave();
+}
+
+void
+SimNativeIntMasterSet(bool bDisable)
+{
+    SimNativeEnter();
+    g_bPrimask = bDisable;
+    SimNativeLeave();
+}
+
+bool
+SimNativeIntMasterGet(void)
+{
+    return(g_bPrimask != 0);
+}
+
+/*
+ * Resets the board and restarts the firmware from main().  Simulated time
+ * keeps running across the reset.
+ */
+void
+SimNativeReset(void)
+{
+    g_sStats.ui32Resets++;
+
+    SimBoardReset(&g_sBoard, g_sBoard.ui32ResetRequest ?
+                             g_sBoard.ui32ResetRequest : SIM_RESET_SW);
+    NativePublish();
+
+    g_i32InHook = 0;
+    g_bPrimask = 0;
+
+    /*
+     * Wakes from hibernation are the duty cycle of the firmware rather than
+     * a sign of it crashing, and do not count against the limit.
+     */
+    if(g_sConfig.ui32MaxResets &&
+       (g_sStats.ui32Resets - (uint32_t)g_sBoard.sHib.ui64Wakes >=
+        g_sConfig.ui32MaxResets))
+        NativeStop();
+
+    if(g_bInService)
+    {
+        g_bInService = 0;
+        sem_post(&g_sServiced);
+    }
+
+    siglongjmp(g_sBoot, 1);
+}
+
+/*
+ * Handler for exceptions the firmware does not handle.  On the target these
+ * spin forever; here the run is stopped.
+ */
+void
+SimNativeDefaultHandler(void)
+{
+    g_sStats.ui32Unhandled = SimNVICCurrent(&g_sBoard.sNVIC);
+    NativeStop();
+}
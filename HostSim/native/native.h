@@ -0,0 +1,104 @@
+#ifndef __SIM_NATIVE_H__
+#define __SIM_NATIVE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../sim/board.h"
+
+/*
+ * Runtime for firmware compiled for the host.
+ *
+ * The firmware's main() (renamed SimFirmwareMain) runs on a thread of its own.
+ * Register accesses through the device header land in per-page register
+ * images that are reconciled with the simulated board whenever the firmware
+ * thread is serviced: when it is idle the simulator thread interrupts it with
+ * SIGUSR1, the service routine applies the pending register writes, advances
+ * simulated time to the next event and runs the interrupt handlers that
+ * became pending, exactly as the NVIC would.  A thread found in
+ * `while(1) {}` is serviced at once, and WFI sleeps until the next interrupt.
+ */
+
+#define SIM_NATIVE_WINDOWS      32
+
+/*
+ * Handler table indexed by exception number; entries not provided by the
+ * firmware point at SimNativeDefaultHandler.
+ */
+typedef void (*tSimVector)(void);
+extern tSimVector g_pfnSimVectors[SIM_NVIC_EXCEPTIONS];
+
+/*
+ * Settings of a run, filled in by the runner before SimNativeRun().
+ */
+typedef struct
+{
+    /*
+     * Simulated time at which the run stops, in picoseconds.
+     */
+    uint64_t ui64EndTime;
+
+    /*
+     * Board cycle at which the run stops instead, if not zero.
+     */
+    uint64_t ui64EndCycle;
+
+    /*
+     * Time the firmware thread must stay idle before it is serviced.
+     */
+    uint32_t ui32SettleUs;
+
+    /*
+     * Service the firmware thread without waiting for it to settle when it
+     * is interrupted in `while(1) {}`.
+     */
+    bool bIdleCheck;
+
+    /*
+     * Number of system resets, not counting wakes from hibernation, after
+     * which the run is abandoned.
+     */
+    uint32_t ui32MaxResets;
+
+    /*
+     * Called on the simulator thread after every service, and while it waits
+     * for a busy firmware thread to settle.
+     */
+    void (*pfnServiced)(void *pvContext);
+    void *pvContext;
+} tSimNativeConfig;
+
+typedef struct
+{
+    uint64_t ui64Services;
+    uint64_t ui64Interrupts;
+    uint32_t ui32Resets;
+    uint32_t ui32Unhandled;
+    bool bFinished;
+} tSimNativeStats;
+
+/*
+ * Interface for the simulator thread.
+ */
+void SimNativeInit(const tSimBoardHooks *psHooks);
+void SimNativeRun(const tSimNativeConfig *psConfig);
+tSimBoard *SimNativeBoard(void);
+const tSimNativeStats *SimNativeStats(void);
+
+/*
+ * Interface for the firmware and the host versions of its libraries.
+ */
+uintptr_t SimNativeWindow(uint32_t ui32Addr);
+void SimNativeEnter(void);
+void SimNativeLeave(void);
+void SimNativeCharge(uint64_t ui64Cycles);
+void SimNativeWait(void);
+void SimNativeSleep(void);
+uint32_t SimNativeRead(uint32_t ui32Addr);
+void SimNativeWrite(uint32_t ui32Addr, uint32_t ui32Value);
+void SimNativeIntMasterSet(bool bDisable);
+bool SimNativeIntMasterGet(void);
+__attribute__((noreturn)) void SimNativeReset(void);
+void SimNativeDefaultHandler(void);
+
+#endif
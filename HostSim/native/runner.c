@@ -0,0 +1,682 @@
+/*
+ * Runs firmware compiled for the host on the simulated board and reports the
+ * activity of the GPIO pins and the output of UART0, whose lines can also be
+ * connected to a pseudo-terminal.
+ */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "native.h"
+#include "../sim/pty.h"
+#include "../sim/replay.h"
+#include "../sim/stimulus.h"
+#include "../sim/wave.h"
+
+/*
+ * Pin changes and the characters sent on UART0 are recorded by the firmware
+ * thread, possibly from its signal handler, in one ring, so that they stay
+ * in the order of simulated time, and printed by the simulator thread.  The
+ * characters are printed line by line, each line stamped with the time of
+ * its first character, and pin changes made while a line is being sent are
+ * held back, up to OUTPUT_HELD_SIZE of them, until it has been printed.
+ */
+#define OUTPUT_RING_SIZE        8192
+#define OUTPUT_HELD_SIZE        4096
+#define OUTPUT_UART             0xFF
+#define UART_LINE_SIZE          256
+
+/*
+ * While nothing moves on the lines of UART0, simulated time is held back to
+ * real time, in sleeps of at most this long, so that the firmware does not
+ * run away from someone typing at the terminal.
+ */
+#define PTY_PACE_MAX_NS         10000000
+
+/*
+ * A pin change, or a character of UART0 in ui8New if ui8Port is
+ * OUTPUT_UART.
+ */
+typedef struct
+{
+    uint64_t ui64Time;
+    uint8_t ui8Port;
+    uint8_t ui8Old;
+    uint8_t ui8New;
+} tOutput;
+
+typedef struct
+{
+    uint64_t ui64Edges;
+    uint64_t ui64First;
+    uint64_t ui64Last;
+} tPinStats;
+
+static tOutput g_psOutput[OUTPUT_RING_SIZE];
+static uint32_t g_ui32OutputHead;
+static uint32_t g_ui32OutputTail;
+static tOutput g_psHeld[OUTPUT_HELD_SIZE];
+static uint32_t g_ui32Held;
+static uint32_t g_ui32EdgeLost;
+
+static tPinStats g_psPins[SIM_GPIO_PORTS][8];
+static bool g_bQuiet;
+static tSimWave *g_psWave;
+
+static uint32_t g_ui32UARTLost;
+static char g_pcUARTLine[UART_LINE_SIZE];
+static uint32_t g_ui32UARTLineLen;
+static uint64_t g_ui64UARTLineTime;
+static uint64_t g_ui64UARTBytes;
+
+/*
+ * The terminal UART0 is connected to, and the simulated and host times at
+ * which a character last went either way.
+ */
+static tSimPty *g_psPty;
+static uint64_t g_ui64PtyActive;
+static struct timespec g_sPtyActive;
+static uint64_t g_ui64PtyReceived;
+
+/*
+ * Profile applied to the analog input g_ui32Channel, if any.
+ */
+static tSimStimulus g_sStimulus;
+static bool g_bStimulus;
+static uint32_t g_ui32Channel;
+
+/*
+ * Puts a pin change or a character into the ring.  Returns false if it is
+ * full.
+ */
+static bool
+RunnerOutput(const tSimBoard *psBoard, uint8_t ui8Port, uint8_t ui8Old,
+             uint8_t ui8New)
+{
+    uint32_t ui32Head = __atomic_load_n(&g_ui32OutputHead, __ATOMIC_RELAXED);
+    tOutput *psOutput;
+
+    if(ui32Head - __atomic_load_n(&g_ui32OutputTail, __ATOMIC_ACQUIRE) ==
+       OUTPUT_RING_SIZE)
+        return(false);
+
+    psOutput = &g_psOutput[ui32Head % OUTPUT_RING_SIZE];
+    psOutput->ui64Time = psBoard->ui64Time;
+    psOutput->ui8Port = ui8Port;
+    psOutput->ui8Old = ui8Old;
+    psOutput->ui8New = ui8New;
+
+    __atomic_store_n(&g_ui32OutputHead, ui32Head + 1, __ATOMIC_RELEASE);
+
+    return(true);
+}
+
+static void
+RunnerPinChange(void *pvContext, tSimBoard *psBoard, uint32_t ui32Port,
+                uint8_t ui8Old, uint8_t ui8New)
+{
+    (void)pvContext;
+
+    if(g_psWave)
+        SimWaveChange(g_psWave, psBoard->ui64Time, ui32Port, ui8New);
+
+    if(!RunnerOutput(psBoard, (uint8_t)ui32Port, ui8Old, ui8New))
+        g_ui32EdgeLost++;
+}
+
+static void
+RunnerPtyActive(const tSimBoard *psBoard)
+{
+    g_ui64PtyActive = psBoard->ui64Time;
+    clock_gettime(CLOCK_MONOTONIC, &g_sPtyActive);
+}
+
+static void
+RunnerUARTTransmit(void *pvContext, tSimBoard *psBoard, uint32_t ui32Port,
+                   uint8_t ui8Byte)
+{
+    (void)pvContext;
+
+    if(ui32Port != 0)
+        return;
+
+    if(g_psPty)
+    {
+        SimPtyTransmit(g_psPty, ui8Byte);
+        RunnerPtyActive(psBoard);
+    }
+
+    if(!RunnerOutput(psBoard, OUTPUT_UART, 0, ui8Byte))
+        g_ui32UARTLost++;
+}
+
+static uint16_t
+RunnerAnalogRead(void *pvContext, tSimBoard *psBoard, uint32_t ui32Channel)
+{
+    (void)pvContext;
+
+    if(!g_bStimulus || (ui32Channel != g_ui32Channel))
+        return(psBoard->pui16Analog[ui32Channel]);
+
+    return(SimStimulusLevel(&g_sStimulus, psBoard->ui64Time));
+}
+
+/*
+ * Gives UART0 the next character typed at the terminal, on the firmware
+ * thread.  Sleeps instead while the lines are quiet and simulated time has
+ * got ahead of real time.
+ */
+static int32_t
+RunnerUARTPoll(void *pvContext, tSimBoard *psBoard, uint32_t ui32Port)
+{
+    struct timespec sNow, sSleep;
+    uint64_t ui64Host, ui64Sim;
+    int32_t i32Byte;
+
+    (void)pvContext;
+
+    if((ui32Port != 0) || !g_psPty)
+        return(-1);
+
+    i32Byte = SimPtyReceive(g_psPty);
+
+    if(i32Byte >= 0)
+    {
+        g_ui64PtyReceived++;
+        RunnerPtyActive(psBoard);
+        return(i32Byte);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    ui64Host = (uint64_t)(sNow.tv_sec - g_sPtyActive.tv_sec) * 1000000000 +
+               (uint64_t)sNow.tv_nsec - (uint64_t)g_sPtyActive.tv_nsec;
+    ui64Sim = (psBoard->ui64Time - g_ui64PtyActive) / 1000;
+
+    if(ui64Sim > ui64Host)
+    {
+        ui64Sim -= ui64Host;
+
+        if(ui64Sim > PTY_PACE_MAX_NS)
+            ui64Sim = PTY_PACE_MAX_NS;
+
+        sSleep.tv_sec = 0;
+        sSleep.tv_nsec = (long)ui64Sim;
+        nanosleep(&sSleep, NULL);
+    }
+
+    return(-1);
+}
+
+static void
+RunnerEdgePrint(const tOutput *psEdge)
+{
+    uint32_t ui32Pin;
+
+    for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+        if(((psEdge->ui8Old ^ psEdge->ui8New) >> ui32Pin) & 1)
+            printf("%14.6f s  P%c%u %s\n",
+                   (double)psEdge->ui64Time / SIM_PS_PER_SECOND,
+                   'A' + psEdge->ui8Port, ui32Pin,
+                   ((psEdge->ui8New >> ui32Pin) & 1) ? "high" : "low");
+}
+
+/*
+ * Prints the line of UART0 collected so far, and the pin changes held back
+ * while it was.
+ */
+static void
+RunnerUARTFlush(void)
+{
+    uint32_t ui32Held;
+
+    if(!g_bQuiet)
+        printf("%14.6f s  UART0 %.*s\n",
+               (double)g_ui64UARTLineTime / SIM_PS_PER_SECOND,
+               (int)g_ui32UARTLineLen, g_pcUARTLine);
+
+    g_ui32UARTLineLen = 0;
+
+    for(ui32Held = 0; ui32Held < g_ui32Held; ui32Held++)
+        RunnerEdgePrint(&g_psHeld[ui32Held]);
+
+    g_ui32Held = 0;
+}
+
+/*
+ * Collects the characters sent on UART0 into lines, each stamped with the
+ * time its first character was sent.
+ */
+static void
+RunnerUARTChar(const tOutput *psChar)
+{
+    if(!g_ui32UARTLineLen)
+        g_ui64UARTLineTime = psChar->ui64Time;
+
+    g_ui64UARTBytes++;
+
+    if(psChar->ui8New == '\n')
+        RunnerUARTFlush();
+    else if((psChar->ui8New != '\r') && (g_ui32UARTLineLen < UART_LINE_SIZE))
+        g_pcUARTLine[g_ui32UARTLineLen++] = (char)psChar->ui8New;
+}
+
+/*
+ * Counts a pin change and prints it, after the line of UART0 being sent if
+ * there is one.  If too many are held back, the line is printed as far as
+ * it goes and the rest of it makes a line of its own.
+ */
+static void
+RunnerEdge(const tOutput *psEdge)
+{
+    uint32_t ui32Pin;
+    tPinStats *psPin;
+
+    for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+    {
+        if(!(((psEdge->ui8Old ^ psEdge->ui8New) >> ui32Pin) & 1))
+            continue;
+
+        psPin = &g_psPins[psEdge->ui8Port][ui32Pin];
+
+        if(!psPin->ui64Edges++)
+            psPin->ui64First = psEdge->ui64Time;
+
+        psPin->ui64Last = psEdge->ui64Time;
+    }
+
+    if(g_bQuiet)
+        return;
+
+    if(!g_ui32UARTLineLen)
+    {
+        RunnerEdgePrint(psEdge);
+        return;
+    }
+
+    if(g_ui32Held == OUTPUT_HELD_SIZE)
+        RunnerUARTFlush();
+
+    g_psHeld[g_ui32Held++] = *psEdge;
+}
+
+static void
+RunnerServiced(void *pvContext)
+{
+    uint32_t ui32Tail = g_ui32OutputTail;
+    const tOutput *psOutput;
+
+    (void)pvContext;
+
+    while(ui32Tail != __atomic_load_n(&g_ui32OutputHead, __ATOMIC_ACQUIRE))
+    {
+        psOutput = &g_psOutput[ui32Tail % OUTPUT_RING_SIZE];
+
+        if(psOutput->ui8Port == OUTPUT_UART)
+            RunnerUARTChar(psOutput);
+        else
+            RunnerEdge(psOutput);
+
+        __atomic_store_n(&g_ui32OutputTail, ++ui32Tail, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Prints what every ADC sequence that ran converted, with its rate in
+ * simulated and in host time, and the conversions the firmware lost.
+ */
+static void
+RunnerADCReport(const tSimBoard *psBoard, double dSim, double dHost)
+{
+    const tSimADC *psADC;
+    uint32_t ui32ADC, ui32Seq;
+
+    for(ui32ADC = 0; ui32ADC < SIM_ADCS; ui32ADC++)
+    {
+        psADC = &psBoard->psADC[ui32ADC];
+
+        for(ui32Seq = 0; ui32Seq < SIM_ADC_SEQUENCERS; ui32Seq++)
+        {
+            if(!psADC->pui64Converted[ui32Seq])
+                continue;
+
+            printf("ADC%u SS%u: %llu conversions, %.0f/s simulated, "
+                   "%.0f/s host, %llu read\n", ui32ADC, ui32Seq,
+                   (unsigned long long)psADC->pui64Converted[ui32Seq],
+                   dSim > 0 ? psADC->pui64Converted[ui32Seq] / dSim : 0.0,
+                   dHost > 0 ? psADC->pui64Converted[ui32Seq] / dHost : 0.0,
+                   (unsigned long long)psADC->pui64Read[ui32Seq]);
+
+            if(psADC->pui64Overflows[ui32Seq] ||
+               psADC->pui64Underflows[ui32Seq] ||
+               psADC->pui64Ignored[ui32Seq])
+                printf("ADC%u SS%u: %llu lost to a full FIFO, %llu reads of "
+                       "an empty FIFO, %llu triggers while busy\n", ui32ADC,
+                       ui32Seq,
+                       (unsigned long long)psADC->pui64Overflows[ui32Seq],
+                       (unsigned long long)psADC->pui64Underflows[ui32Seq],
+                       (unsigned long long)psADC->pui64Ignored[ui32Seq]);
+        }
+    }
+}
+
+/*
+ * Prints how often the chip woke from hibernation and how much of the run it
+ * spent hibernating.
+ */
+static void
+RunnerHibReport(const tSimBoard *psBoard, double dSim)
+{
+    const tSimHib *psHib = &psBoard->sHib;
+    uint64_t ui64Hibernated = psHib->ui64Hibernated;
+
+    if(psBoard->bHibernating)
+        ui64Hibernated += psBoard->ui64Time - psHib->ui64Entered;
+
+    if(!psHib->ui64Wakes && !ui64Hibernated)
+        return;
+
+    printf("%llu wakes from hibernation, %.6f s hibernated (%.1f%% of the "
+           "run)\n", (unsigned long long)psHib->ui64Wakes,
+           (double)ui64Hibernated / SIM_PS_PER_SECOND,
+           dSim > 0 ? (double)ui64Hibernated / SIM_PS_PER_SECOND * 100 / dSim :
+                      0.0);
+}
+
+static void
+Usage(const char *pcName)
+{
+    fprintf(stderr,
+            "Usage: %s [--seconds S] [--settle-us N] [--max-resets N] "
+            "[--no-idle] [--vcd FILE] [--quiet]\n"
+            "       [--record FILE [--uart-input FILE]] [--replay FILE] "
+            "[--seek CYCLE]\n"
+            "       [--pty] [--infinite-baud] [--profile P [--channel N] "
+            "[--seed N]]\n", pcName);
+    exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const struct option psOptions[] =
+    {
+        { "seconds", required_argument, NULL, 's' },
+        { "settle-us", required_argument, NULL, 'u' },
+        { "max-resets", required_argument, NULL, 'r' },
+        { "no-idle", no_argument, NULL, 'n' },
+        { "vcd", required_argument, NULL, 'v' },
+        { "quiet", no_argument, NULL, 'q' },
+        { "record", required_argument, NULL, 'R' },
+        { "replay", required_argument, NULL, 'P' },
+        { "uart-input", required_argument, NULL, 'i' },
+        { "seek", required_argument, NULL, 'k' },
+        { "pty", no_argument, NULL, 'p' },
+        { "infinite-baud", no_argument, NULL, 'b' },
+        { "profile", required_argument, NULL, 'a' },
+        { "channel", required_argument, NULL, 'c' },
+        { "seed", required_argument, NULL, 'e' },
+        { NULL, 0, NULL, 0 }
+    };
+    tSimNativeConfig sConfig;
+    tSimBoardHooks sHooks;
+    const tSimNativeStats *psStats;
+    struct timespec sStart, sEnd;
+    double dSeconds = 10.0, dHost, dSim;
+    uint32_t ui32Port, ui32Pin;
+    const char *pcWave = NULL, *pcRecord = NULL, *pcReplay = NULL;
+    const char *pcInput = NULL;
+    tSimReplay *psReplay = NULL;
+    uint32_t ui32Line = 0, ui32Unsent;
+    uint64_t ui64Seed = 1;
+    tPinStats *psPin;
+    int i32Opt;
+
+    memset(&sConfig, 0, sizeof(sConfig));
+    sConfig.ui32SettleUs = 100;
+    sConfig.ui32MaxResets = 16;
+    sConfig.bIdleCheck = true;
+
+    while((i32Opt = getopt_long(argc, argv, "s:u:r:nv:qR:P:i:k:pba:c:e:",
+                                psOptions,
+                                NULL)) != -1)
+    {
+        switch(i32Opt)
+        {
+            case 's':
+                dSeconds = strtod(optarg, NULL);
+                break;
+
+            case 'u':
+                sConfig.ui32SettleUs = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                sConfig.ui32MaxResets = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                sConfig.bIdleCheck = false;
+                break;
+
+            case 'v':
+                pcWave = optarg;
+                break;
+
+            case 'q':
+                g_bQuiet = true;
+                break;
+
+            case 'R':
+                pcRecord = optarg;
+                break;
+
+            case 'P':
+                pcReplay = optarg;
+                break;
+
+            case 'i':
+                pcInput = optarg;
+                break;
+
+            case 'k':
+                sConfig.ui64EndCycle = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'p':
+                ui32Line |= SIM_UART_LINE_POLLED;
+                break;
+
+            case 'b':
+                ui32Line |= SIM_UART_LINE_INSTANT;
+                break;
+
+            case 'a':
+                if(!SimStimulusParse(&g_sStimulus, optarg))
+                {
+                    fprintf(stderr, "bad profile %s\n", optarg);
+                    return(1);
+                }
+
+                g_bStimulus = true;
+                break;
+
+            case 'c':
+                g_ui32Channel = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                ui64Seed = strtoull(optarg, NULL, 0);
+                break;
+
+            default:
+                Usage(argv[0]);
+        }
+    }
+
+    if((pcReplay && (pcRecord || pcInput)) ||
+       (g_ui32Channel >= SIM_ADC_CHANNELS))
+        Usage(argv[0]);
+
+    if(g_bStimulus)
+        SimStimulusInit(&g_sStimulus, ui64Seed);
+
+    memset(&sHooks, 0, sizeof(sHooks));
+    sHooks.pfnPinChange = RunnerPinChange;
+    sHooks.pfnUARTTransmit = RunnerUARTTransmit;
+    sHooks.pfnUARTPoll = RunnerUARTPoll;
+    sHooks.pfnAnalogRead = RunnerAnalogRead;
+
+    sConfig.ui64EndTime = (uint64_t)(dSeconds * SIM_PS_PER_SECOND);
+    sConfig.pfnServiced = RunnerServiced;
+
+    SimNativeInit(&sHooks);
+
+    if(pcReplay && !(psReplay = SimReplayOpen(pcReplay)))
+    {
+        fprintf(stderr, "%s: not a recording\n", pcReplay);
+        return(1);
+    }
+
+    if((pcRecord || pcInput) && !(psReplay = SimReplayRecord(pcRecord)))
+    {
+        fprintf(stderr, "%s: cannot create\n",
+                pcRecord ? pcRecord : "recording");
+        return(1);
+    }
+
+    if(pcInput && !SimReplayInput(psReplay, 0, pcInput))
+    {
+        fprintf(stderr, "%s: cannot read\n", pcInput);
+        return(1);
+    }
+
+    if(psReplay)
+        SimReplayAttach(SimNativeBoard(), psReplay);
+
+    if(pcWave && !(g_psWave = SimWaveOpen(pcWave)))
+    {
+        fprintf(stderr, "%s: cannot create\n", pcWave);
+        return(1);
+    }
+
+    if(ui32Line & SIM_UART_LINE_POLLED)
+    {
+        if(!(g_psPty = SimPtyOpen()))
+        {
+            fprintf(stderr, "cannot open a pseudo-terminal\n");
+            return(1);
+        }
+
+        printf("UART0 on %s\n", g_psPty->pcName);
+        fflush(stdout);
+        RunnerPtyActive(SimNativeBoard());
+    }
+
+    SimUARTConnect(SimNativeBoard(), 0, ui32Line);
+
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    SimNativeRun(&sConfig);
+    clock_gettime(CLOCK_MONOTONIC, &sEnd);
+
+    RunnerServiced(NULL);
+
+    /*
+     * The firmware thread is parked for good once the run has ended.
+     */
+    if(g_psWave && !SimWaveClose(g_psWave, SimNativeBoard()->ui64Time, NULL))
+        fprintf(stderr, "%s: write error\n", pcWave);
+
+    ui32Unsent = SimPtyClose(g_psPty);
+
+    if(g_ui32UARTLineLen)
+        RunnerUARTFlush();
+
+    psStats = SimNativeStats();
+    dSim = (double)SimNativeBoard()->ui64Time / SIM_PS_PER_SECOND;
+    dHost = (double)(sEnd.tv_sec - sStart.tv_sec) +
+            (double)(sEnd.tv_nsec - sStart.tv_nsec) / 1e9;
+
+    printf("\n");
+
+    for(ui32Port = 0; ui32Port < SIM_GPIO_PORTS; ui32Port++)
+    {
+        for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+        {
+            psPin = &g_psPins[ui32Port][ui32Pin];
+
+            if(!psPin->ui64Edges)
+                continue;
+
+            printf("P%c%u: %llu edges", 'A' + ui32Port, ui32Pin,
+                   (unsigned long long)psPin->ui64Edges);
+
+            if(psPin->ui64Edges > 1)
+                printf(", %.6f s between edges",
+                       (double)(psPin->ui64Last - psPin->ui64First) /
+                       (psPin->ui64Edges - 1) / SIM_PS_PER_SECOND);
+
+            printf("\n");
+        }
+    }
+
+    RunnerADCReport(SimNativeBoard(), dSim, dHost);
+
+    if(g_ui64UARTBytes)
+        printf("UART0: %llu characters sent\n",
+               (unsigned long long)g_ui64UARTBytes);
+
+    if(g_ui64PtyReceived)
+        printf("UART0: %llu characters received from the terminal\n",
+               (unsigned long long)g_ui64PtyReceived);
+
+    if(ui32Unsent)
+        printf("%u UART0 characters not taken by the terminal\n",
+               ui32Unsent);
+
+    if(g_ui32EdgeLost)
+        printf("%u pin changes lost\n", g_ui32EdgeLost);
+
+    if(g_ui32UARTLost)
+        printf("%u UART0 characters lost\n", g_ui32UARTLost);
+
+    if(psStats->ui32Unhandled)
+        printf("stopped in the default handler of exception %u\n",
+               psStats->ui32Unhandled);
+
+    /*
+     * Firmware compiled for the host does not take the same cycles as on
+     * the chip, so a replay only gives it the logged inputs in order.
+     */
+    if(pcRecord || pcReplay)
+    {
+        printf("%llu inputs %s", (unsigned long long)psReplay->ui64Records,
+               SimReplaying(psReplay) ? "replayed" : "recorded");
+
+        if(psReplay->ui64Divergences)
+            printf(", %llu diverged",
+                   (unsigned long long)psReplay->ui64Divergences);
+
+        printf("\n");
+    }
+
+    if(sConfig.ui64EndCycle &&
+       (SimNativeBoard()->ui64Cycle >= sConfig.ui64EndCycle))
+        printf("stopped at cycle %llu\n",
+               (unsigned long long)SimNativeBoard()->ui64Cycle);
+
+    if(!SimReplayClose(psReplay))
+        fprintf(stderr, "%s: write error\n", pcRecord);
+
+    RunnerHibReport(SimNativeBoard(), dSim);
+
+    printf("%llu interrupts, %llu services, %u resets%s\n",
+           (unsigned long long)psStats->ui64Interrupts,
+           (unsigned long long)psStats->ui64Services, psStats->ui32Resets,
+           psStats->bFinished ? ", main() returned" : "");
+    printf("simulated %.6f s in %.6f s (%.0fx real time)\n", dSim, dHost,
+           dHost > 0 ? dSim / dHost : 0.0);
+
+    return(psStats->ui32Unhandled ? 1 : 0);
+}
@@ -0,0 +1,375 @@
+/*
+ * 12-bit ADC modules 0 and 1.
+ */
+#include <string.h>
+
+#include "board.h"
+
+#define ADC_O_ACTSS             0x000
+#define ADC_O_RIS               0x004
+#define ADC_O_IM                0x008
+#define ADC_O_ISC               0x00C
+#define ADC_O_OSTAT             0x010
+#define ADC_O_EMUX              0x014
+#define ADC_O_USTAT             0x018
+#define ADC_O_SSPRI             0x020
+#define ADC_O_PSSI              0x028
+#define ADC_O_SSMUX0            0x040
+#define ADC_O_PC                0xFC4
+
+/*
+ * Registers of sequencer n lie at ADC_O_SSMUX0 + n * ADC_SEQ_STRIDE.
+ */
+#define ADC_SEQ_STRIDE          0x020
+#define ADC_SEQ_O_MUX           0x000
+#define ADC_SEQ_O_CTL           0x004
+#define ADC_SEQ_O_FIFO          0x008
+#define ADC_SEQ_O_FSTAT         0x00C
+
+#define ADC_ACTSS_BUSY          0x00010000U
+
+#define ADC_SSCTL_END           0x2
+#define ADC_SSCTL_IE            0x4
+#define ADC_SSCTL_TS            0x8
+
+#define ADC_SSFSTAT_EMPTY       0x00000100U
+#define ADC_SSFSTAT_FULL        0x00001000U
+
+#define ADC_EMUX_PROCESSOR      0x0
+
+static const uint8_t g_pui8Depth[SIM_ADC_SEQUENCERS] = { 8, 4, 4, 1 };
+
+static const uint8_t g_pui8Interrupt[SIM_ADCS] =
+{
+    SIM_INT_ADC0SS0, SIM_INT_ADC1SS0
+};
+
+static uint32_t
+ADCEvent(uint32_t ui32ADC, uint32_t ui32Seq)
+{
+    return(SIM_EVENT_ADC0SS0 + ui32ADC * SIM_ADC_SEQUENCERS + ui32Seq);
+}
+
+static void
+ADCUpdateLines(tSimBoard *psBoard, uint32_t ui32ADC)
+{
+    tSimADC *psADC = &psBoard->psADC[ui32ADC];
+    uint32_t ui32Seq;
+
+    for(ui32Seq = 0; ui32Seq < SIM_ADC_SEQUENCERS; ui32Seq++)
+        SimNVICSetLine(&psBoard->sNVIC, g_pui8Interrupt[ui32ADC] + ui32Seq,
+                       ((psADC->ui32RIS & psADC->ui32IM) >> ui32Seq) & 1);
+}
+
+void
+SimADCReset(tSimBoard *psBoard, uint32_t ui32ADC)
+{
+    tSimADC *psADC = &psBoard->psADC[ui32ADC];
+
+    memset(psADC, 0, sizeof(*psADC));
+
+    psADC->ui32SSPri = 0x3210;
+    psADC->ui32PC = 0x7;
+}
+
+/*
+ * Sets the level applied to an analog input, as a 12-bit conversion result.
+ */
+void
+SimADCSetInput(tSimBoard *psBoard, uint32_t ui32Channel, uint16_t ui16Level)
+{
+    if(ui32Channel <= SIM_ADC_TS)
+        psBoard->pui16Analog[ui32Channel] = ui16Level & 0xFFF;
+}
+
+/*
+ * Returns the conversion result of an input at the current time, or the one
+ * a recording being replayed gives.
+ */
+static uint16_t
+ADCSample(tSimBoard *psBoard, uint32_t ui32Channel)
+{
+    uint16_t ui16Level;
+
+    if(psBoard->sHooks.pfnAnalogRead)
+        ui16Level = psBoard->sHooks.pfnAnalogRead(psBoard->sHooks.pvContext,
+                                                  psBoard, ui32Channel) & 0xFFF;
+    else
+        ui16Level = psBoard->pui16Analog[ui32Channel];
+
+    if(psBoard->psReplay)
+        ui16Level = SimReplayADC(psBoard, ui32Channel, ui16Level);
+
+    return(ui16Level);
+}
+
+/*
+ * Completes the conversion of the current step of a sequence.
+ */
+void
+SimADCEvent(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Seq,
+            uint64_t ui64Deadline)
+{
+    tSimADC *psADC = &psBoard->psADC[ui32ADC];
+    tSimADCSequencer *psSeq = &psADC->psSeq[ui32Seq];
+    uint32_t ui32Step = psSeq->ui8Step;
+    uint32_t ui32Ctl = (psSeq->ui32Ctl >> (ui32Step * 4)) & 0xF;
+    uint32_t ui32Channel = (psSeq->ui32Mux >> (ui32Step * 4)) & 0xF;
+    uint8_t ui8Depth = g_pui8Depth[ui32Seq];
+
+    if(ui32Ctl & ADC_SSCTL_TS)
+        ui32Channel = SIM_ADC_TS;
+    else if(ui32Channel >= SIM_ADC_CHANNELS)
+        ui32Channel = 0;
+
+    psADC->pui64Converted[ui32Seq]++;
+
+    if(psSeq->ui8Count < ui8Depth)
+    {
+        psSeq->pui16FIFO[(psSeq->ui8Head + psSeq->ui8Count++) % ui8Depth] =
+            ADCSample(psBoard, ui32Channel);
+    }
+    else
+    {
+        psADC->ui32OStat |= 1U << ui32Seq;
+        psADC->pui64Overflows[ui32Seq]++;
+    }
+
+    if(ui32Ctl & ADC_SSCTL_IE)
+    {
+        psADC->ui32RIS |= 1U << ui32Seq;
+        ADCUpdateLines(psBoard, ui32ADC);
+    }
+
+    /*
+     * The sequence ends at the step marked END or at its last step.
+     */
+    if((ui32Ctl & ADC_SSCTL_END) || (ui32Step + 1 == ui8Depth))
+        return;
+
+    psSeq->ui8Step++;
+    SimEventSchedule(&psBoard->sEvents, ADCEvent(ui32ADC, ui32Seq),
+                     ui64Deadline + SIM_ADC_SAMPLE_PS);
+}
+
+/*
+ * Starts a sequence on a processor trigger.  A trigger arriving while the
+ * sequence runs is ignored.
+ */
+static void
+ADCTrigger(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Seq)
+{
+    tSimADC *psADC = &psBoard->psADC[ui32ADC];
+
+    if(!((psADC->ui32ACTSS >> ui32Seq) & 1) ||
+       (((psADC->ui32EMUX >> (ui32Seq * 4)) & 0xF) != ADC_EMUX_PROCESSOR))
+        return;
+
+    if(SimEventPending(&psBoard->sEvents, ADCEvent(ui32ADC, ui32Seq)))
+    {
+        psADC->pui64Ignored[ui32Seq]++;
+        return;
+    }
+
+    psADC->psSeq[ui32Seq].ui8Step = 0;
+    SimEventSchedule(&psBoard->sEvents, ADCEvent(ui32ADC, ui32Seq),
+                     psBoard->ui64Time + SIM_ADC_SAMPLE_PS);
+}
+
+static uint32_t
+ADCSeqRead(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Seq,
+           uint32_t ui32Offset, bool bPeek)
+{
+    tSimADC *psADC = &psBoard->psADC[ui32ADC];
+    tSimADCSequencer *psSeq = &psADC->psSeq[ui32Seq];
+    uint8_t ui8Depth = g_pui8Depth[ui32Seq];
+    uint32_t ui32Value;
+
+    switch(ui32Offset)
+    {
+        case ADC_SEQ_O_MUX:
+            return(psSeq->ui32Mux);
+
+        case ADC_SEQ_O_CTL:
+            return(psSeq->ui32Ctl);
+
+        case ADC_SEQ_O_FIFO:
+            if(!psSeq->ui8Count)
+            {
+                if(!bPeek)
+                {
+                    psADC->ui32UStat |= 1U << ui32Seq;
+                    psADC->pui64Underflows[ui32Seq]++;
+                }
+
+                return(0);
+            }
+
+            ui32Value = psSeq->pui16FIFO[psSeq->ui8Head];
+
+            if(!bPeek)
+            {
+                psSeq->ui8Head = (psSeq->ui8Head + 1) % ui8Depth;
+                psSeq->ui8Count--;
+                psADC->pui64Read[ui32Seq]++;
+            }
+
+            return(ui32Value);
+
+        case ADC_SEQ_O_FSTAT:
+            ui32Value = psSeq->ui8Head |
+                        (((psSeq->ui8Head + psSeq->ui8Count) % ui8Depth) << 4);
+
+            if(!psSeq->ui8Count)
+                ui32Value |= ADC_SSFSTAT_EMPTY;
+
+            if(psSeq->ui8Count == ui8Depth)
+                ui32Value |= ADC_SSFSTAT_FULL;
+
+            return(ui32Value);
+
+        default:
+            return(0);
+    }
+}
+
+uint32_t
+SimADCRead(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Offset,
+           bool bPeek)
+{
+    tSimADC *psADC = &psBoard->psADC[ui32ADC];
+    uint32_t ui32Seq, ui32Value;
+
+    if((ui32Offset >= ADC_O_SSMUX0) &&
+       (ui32Offset < ADC_O_SSMUX0 + SIM_ADC_SEQUENCERS * ADC_SEQ_STRIDE))
+        return(ADCSeqRead(psBoard, ui32ADC,
+                          (ui32Offset - ADC_O_SSMUX0) / ADC_SEQ_STRIDE,
+                          (ui32Offset - ADC_O_SSMUX0) % ADC_SEQ_STRIDE,
+                          bPeek));
+
+    switch(ui32Offset)
+    {
+        case ADC_O_ACTSS:
+            ui32Value = psADC->ui32ACTSS;
+
+            for(ui32Seq = 0; ui32Seq < SIM_ADC_SEQUENCERS; ui32Seq++)
+                if(SimEventPending(&psBoard->sEvents,
+                                   ADCEvent(ui32ADC, ui32Seq)))
+                    ui32Value |= ADC_ACTSS_BUSY;
+
+            return(ui32Value);
+
+        case ADC_O_RIS:
+            return(psADC->ui32RIS);
+
+        case ADC_O_IM:
+            return(psADC->ui32IM);
+
+        case ADC_O_ISC:
+            return(psADC->ui32RIS & psADC->ui32IM);
+
+        case ADC_O_OSTAT:
+            return(psADC->ui32OStat);
+
+        case ADC_O_EMUX:
+            return(psADC->ui32EMUX);
+
+        case ADC_O_USTAT:
+            return(psADC->ui32UStat);
+
+        case ADC_O_SSPRI:
+            return(psADC->ui32SSPri);
+
+        case ADC_O_PC:
+            return(psADC->ui32PC);
+
+        default:
+            return(0);
+    }
+}
+
+void
+SimADCWrite(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Offset,
+            uint32_t ui32Value)
+{
+    tSimADC *psADC = &psBoard->psADC[ui32ADC];
+    tSimADCSequencer *psSeq;
+    uint32_t ui32Seq;
+
+    if((ui32Offset >= ADC_O_SSMUX0) &&
+       (ui32Offset < ADC_O_SSMUX0 + SIM_ADC_SEQUENCERS * ADC_SEQ_STRIDE))
+    {
+        ui32Seq = (ui32Offset - ADC_O_SSMUX0) / ADC_SEQ_STRIDE;
+        psSeq = &psADC->psSeq[ui32Seq];
+
+        switch((ui32Offset - ADC_O_SSMUX0) % ADC_SEQ_STRIDE)
+        {
+            case ADC_SEQ_O_MUX:
+                psSeq->ui32Mux = ui32Value;
+                break;
+
+            case ADC_SEQ_O_CTL:
+                psSeq->ui32Ctl = ui32Value;
+                break;
+
+            default:
+                break;
+        }
+
+        return;
+    }
+
+    switch(ui32Offset)
+    {
+        case ADC_O_ACTSS:
+            psADC->ui32ACTSS = ui32Value & 0xF;
+
+            /*
+             * Disabling a sequencer abandons its conversion.
+             */
+            for(ui32Seq = 0; ui32Seq < SIM_ADC_SEQUENCERS; ui32Seq++)
+                if(!((ui32Value >> ui32Seq) & 1))
+                    SimEventCancel(&psBoard->sEvents,
+                                   ADCEvent(ui32ADC, ui32Seq));
+            break;
+
+        case ADC_O_IM:
+            psADC->ui32IM = ui32Value & 0xF;
+            ADCUpdateLines(psBoard, ui32ADC);
+            break;
+
+        case ADC_O_ISC:
+            psADC->ui32RIS &= ~ui32Value;
+            ADCUpdateLines(psBoard, ui32ADC);
+            break;
+
+        case ADC_O_OSTAT:
+            psADC->ui32OStat &= ~ui32Value;
+            break;
+
+        case ADC_O_EMUX:
+            psADC->ui32EMUX = ui32Value & 0xFFFF;
+            break;
+
+        case ADC_O_USTAT:
+            psADC->ui32UStat &= ~ui32Value;
+            break;
+
+        case ADC_O_SSPRI:
+            psADC->ui32SSPri = ui32Value & 0x3333;
+            break;
+
+        case ADC_O_PSSI:
+            for(ui32Seq = 0; ui32Seq < SIM_ADC_SEQUENCERS; ui32Seq++)
+                if((ui32Value >> ui32Seq) & 1)
+                    ADCTrigger(psBoard, ui32ADC, ui32Seq);
+            break;
+
+        case ADC_O_PC:
+            psADC->ui32PC = ui32Value & 0xF;
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef __SIM_ADC_H__
+#define __SIM_ADC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+#define SIM_ADCS                2
+#define SIM_ADC_SEQUENCERS      4
+
+/*
+ * Analog inputs AIN0 to AIN11, followed by the internal temperature sensor.
+ */
+#define SIM_ADC_CHANNELS        12
+#define SIM_ADC_TS              SIM_ADC_CHANNELS
+
+/*
+ * Reading of the temperature sensor at 25 degrees C.
+ */
+#define SIM_ADC_TS_25C          2027
+
+/*
+ * Time taken by one conversion at the full rate of 1 Msps.
+ */
+#define SIM_ADC_SAMPLE_PS       1000000ULL
+
+/*
+ * One sample sequencer.  A running sequence converts step ui8Step next.
+ */
+typedef struct
+{
+    uint32_t ui32Mux;
+    uint32_t ui32Ctl;
+    uint16_t pui16FIFO[8];
+    uint8_t ui8Head;
+    uint8_t ui8Count;
+    uint8_t ui8Step;
+} tSimADCSequencer;
+
+/*
+ * One ADC module.  Only the processor trigger is modeled; conversions take
+ * SIM_ADC_SAMPLE_PS each and read the levels applied to the board's analog
+ * inputs.
+ */
+typedef struct
+{
+    uint32_t ui32ACTSS;
+    uint32_t ui32RIS;
+    uint32_t ui32IM;
+    uint32_t ui32OStat;
+    uint32_t ui32UStat;
+    uint32_t ui32EMUX;
+    uint32_t ui32SSPri;
+    uint32_t ui32PC;
+    tSimADCSequencer psSeq[SIM_ADC_SEQUENCERS];
+
+    /*
+     * Counts for the runners, which the firmware cannot see: results
+     * converted, read, lost to a full FIFO and read from an empty one, and
+     * processor triggers ignored because the sequence was still running.
+     */
+    uint64_t pui64Converted[SIM_ADC_SEQUENCERS];
+    uint64_t pui64Read[SIM_ADC_SEQUENCERS];
+    uint64_t pui64Overflows[SIM_ADC_SEQUENCERS];
+    uint64_t pui64Underflows[SIM_ADC_SEQUENCERS];
+    uint64_t pui64Ignored[SIM_ADC_SEQUENCERS];
+} tSimADC;
+
+void SimADCReset(tSimBoard *psBoard, uint32_t ui32ADC);
+uint32_t SimADCRead(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Offset,
+                    bool bPeek);
+void SimADCWrite(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Offset,
+                 uint32_t ui32Value);
+void SimADCEvent(tSimBoard *psBoard, uint32_t ui32ADC, uint32_t ui32Seq,
+                 uint64_t ui64Deadline);
+void SimADCSetInput(tSimBoard *psBoard, uint32_t ui32Channel,
+                    uint16_t ui16Level);
+
+#endif
@@ -0,0 +1,457 @@
+/*
+ * Simulated board: address decoding, time base and event dispatch.
+ */
+#include <string.h>
+
+#include "board.h"
+
+/*
+ * Peripheral blocks, encoded as (block << 4) | instance in the page table.
+ */
+#define BOARD_NONE              0
+#define BOARD_GPIO              1
+#define BOARD_SYSCTL            2
+#define BOARD_TIMER             3
+#define BOARD_ADC               4
+#define BOARD_UART              5
+#define BOARD_HIB               6
+
+#define PAGE(ui32Block, ui32Instance) (((ui32Block) << 4) | (ui32Instance))
+
+#define BOARD_PERIPH_BASE       0x40000000U
+#define BOARD_BITBAND_BASE      0x42000000U
+#define BOARD_BITBAND_END       0x44000000U
+#define BOARD_SCS_BASE          0xE000E000U
+
+/*
+ * Decodes the 4 KB pages from 0x40000000 to 0x400FFFFF.
+ */
+static const uint8_t g_pui8Page[256] =
+{
+    [0x04] = PAGE(BOARD_GPIO, 0),
+    [0x05] = PAGE(BOARD_GPIO, 1),
+    [0x06] = PAGE(BOARD_GPIO, 2),
+    [0x07] = PAGE(BOARD_GPIO, 3),
+    [0x0C] = PAGE(BOARD_UART, 0),
+    [0x0D] = PAGE(BOARD_UART, 1),
+    [0x0E] = PAGE(BOARD_UART, 2),
+    [0x0F] = PAGE(BOARD_UART, 3),
+    [0x10] = PAGE(BOARD_UART, 4),
+    [0x11] = PAGE(BOARD_UART, 5),
+    [0x12] = PAGE(BOARD_UART, 6),
+    [0x13] = PAGE(BOARD_UART, 7),
+    [0x24] = PAGE(BOARD_GPIO, 4),
+    [0x25] = PAGE(BOARD_GPIO, 5),
+    [0x30] = PAGE(BOARD_TIMER, 0),
+    [0x31] = PAGE(BOARD_TIMER, 1),
+    [0x32] = PAGE(BOARD_TIMER, 2),
+    [0x33] = PAGE(BOARD_TIMER, 3),
+    [0x34] = PAGE(BOARD_TIMER, 4),
+    [0x35] = PAGE(BOARD_TIMER, 5),
+    [0x38] = PAGE(BOARD_ADC, 0),
+    [0x39] = PAGE(BOARD_ADC, 1),
+    [0x58] = PAGE(BOARD_GPIO, 0),
+    [0x59] = PAGE(BOARD_GPIO, 1),
+    [0x5A] = PAGE(BOARD_GPIO, 2),
+    [0x5B] = PAGE(BOARD_GPIO, 3),
+    [0x5C] = PAGE(BOARD_GPIO, 4),
+    [0x5D] = PAGE(BOARD_GPIO, 5),
+    [0xFC] = PAGE(BOARD_HIB, 0),
+    [0xFE] = PAGE(BOARD_SYSCTL, 0),
+};
+
+void
+SimBoardInit(tSimBoard *psBoard, const tSimBoardHooks *psHooks)
+{
+    memset(psBoard, 0, sizeof(*psBoard));
+
+    if(psHooks)
+        psBoard->sHooks = *psHooks;
+
+    SimHibReset(psBoard);
+    SimADCSetInput(psBoard, SIM_ADC_TS, SIM_ADC_TS_25C);
+    SimBoardReset(psBoard, SIM_RESET_POR | SIM_RESET_EXT);
+}
+
+/*
+ * Resets the chip.  Simulated time keeps running and the levels applied to
+ * the pins from outside are retained, as is the battery-backed hibernation
+ * module.
+ */
+void
+SimBoardReset(tSimBoard *psBoard, uint32_t ui32Cause)
+{
+    uint32_t ui32Idx;
+
+    SimEventQueueInit(&psBoard->sEvents);
+    SimSysCtlReset(&psBoard->sSysCtl, ui32Cause);
+    SimNVICReset(&psBoard->sNVIC);
+    psBoard->sNVIC.ui64Now = psBoard->ui64Cycle;
+    SimSysTickReset(&psBoard->sSysTick);
+
+    for(ui32Idx = 0; ui32Idx < SIM_GPIO_PORTS; ui32Idx++)
+        SimGPIOReset(psBoard, ui32Idx);
+
+    for(ui32Idx = 0; ui32Idx < SIM_TIMERS; ui32Idx++)
+        SimTimerReset(psBoard, ui32Idx);
+
+    for(ui32Idx = 0; ui32Idx < SIM_ADCS; ui32Idx++)
+        SimADCReset(psBoard, ui32Idx);
+
+    for(ui32Idx = 0; ui32Idx < SIM_UARTS; ui32Idx++)
+        SimUARTReset(psBoard, ui32Idx);
+
+    psBoard->ui32CyclePs = (uint32_t)SimSysCtlClockPeriod(&psBoard->sSysCtl);
+    psBoard->ui32ResetRequest = 0;
+    psBoard->bHibernating = false;
+
+    SimHibResume(psBoard);
+    SimReplaySchedule(psBoard);
+}
+
+/*
+ * Powers the chip down until the hibernation module wakes it with a reset.
+ * Everything but the hibernation module loses its state.
+ */
+void
+SimBoardHibernate(tSimBoard *psBoard)
+{
+    SimBoardReset(psBoard, 0);
+    psBoard->bHibernating = true;
+}
+
+void
+SimBoardClockSet(tSimBoard *psBoard, uint64_t ui64CyclePs)
+{
+    uint32_t ui32Timer;
+
+    if(ui64CyclePs == psBoard->ui32CyclePs)
+        return;
+
+    /*
+     * Peripherals counting system clocks are brought up to date with the old
+     * clock before their next deadlines are computed with the new one.
+     */
+    SimSysTickSync(psBoard);
+
+    for(ui32Timer = 0; ui32Timer < SIM_TIMERS; ui32Timer++)
+        SimTimerSync(psBoard, ui32Timer);
+
+    psBoard->ui32CyclePs = (uint32_t)ui64CyclePs;
+    SimSysTickSchedule(psBoard);
+
+    for(ui32Timer = 0; ui32Timer < SIM_TIMERS; ui32Timer++)
+        SimTimerSchedule(psBoard, ui32Timer);
+}
+
+void
+SimBoardPinChange(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Old,
+                  uint8_t ui8New)
+{
+    if(psBoard->sHooks.pfnPinChange)
+        psBoard->sHooks.pfnPinChange(psBoard->sHooks.pvContext, psBoard,
+                                     ui32Port, ui8Old, ui8New);
+}
+
+/*
+ * Performs a word access to a peripheral register.  Returns false if nothing
+ * is mapped at the address.
+ */
+static bool
+BoardAccess(tSimBoard *psBoard, uint32_t ui32Addr, bool bWrite, bool bPeek,
+            uint32_t *pui32Value)
+{
+    uint32_t ui32Offset = ui32Addr & 0xFFC;
+    uint32_t ui32Page;
+
+    if((ui32Addr & 0xFFF00000U) == BOARD_PERIPH_BASE)
+    {
+        ui32Page = g_pui8Page[(ui32Addr >> 12) & 0xFF];
+
+        switch(ui32Page >> 4)
+        {
+            case BOARD_GPIO:
+                if(bWrite)
+                    SimGPIOWrite(psBoard, ui32Page & 0xF, ui32Offset,
+                                 *pui32Value);
+                else
+                    *pui32Value = SimGPIORead(psBoard, ui32Page & 0xF,
+                                              ui32Offset, bPeek);
+                return(true);
+
+            case BOARD_SYSCTL:
+                if(bWrite)
+                    SimSysCtlWrite(psBoard, ui32Offset, *pui32Value);
+                else
+                    *pui32Value = SimSysCtlRead(psBoard, ui32Offset, bPeek);
+                return(true);
+
+            case BOARD_TIMER:
+                if(bWrite)
+                    SimTimerWrite(psBoard, ui32Page & 0xF, ui32Offset,
+                                  *pui32Value);
+                else
+                    *pui32Value = SimTimerRead(psBoard, ui32Page & 0xF,
+                                               ui32Offset, bPeek);
+                return(true);
+
+            case BOARD_ADC:
+                if(bWrite)
+                    SimADCWrite(psBoard, ui32Page & 0xF, ui32Offset,
+                                *pui32Value);
+                else
+                    *pui32Value = SimADCRead(psBoard, ui32Page & 0xF,
+                                             ui32Offset, bPeek);
+                return(true);
+
+            case BOARD_UART:
+                if(bWrite)
+                    SimUARTWrite(psBoard, ui32Page & 0xF, ui32Offset,
+                                 *pui32Value);
+                else
+                    *pui32Value = SimUARTRead(psBoard, ui32Page & 0xF,
+                                              ui32Offset, bPeek);
+                return(true);
+
+            case BOARD_HIB:
+                if(bWrite)
+                    SimHibWrite(psBoard, ui32Offset, *pui32Value);
+                else
+                    *pui32Value = SimHibRead(psBoard, ui32Offset, bPeek);
+                return(true);
+
+            default:
+                return(false);
+        }
+    }
+
+    if((ui32Addr & 0xFFFFF000U) == BOARD_SCS_BASE)
+    {
+        if((ui32Offset >= SIM_SYSTICK_O_CTRL) &&
+           (ui32Offset <= SIM_SYSTICK_O_CALIB))
+        {
+            if(bWrite)
+                SimSysTickWrite(psBoard, ui32Offset, *pui32Value);
+            else
+                *pui32Value = SimSysTickRead(psBoard, ui32Offset, bPeek);
+        }
+        else
+        {
+            if(bWrite)
+                SimNVICWrite(psBoard, ui32Offset, *pui32Value);
+            else
+                *pui32Value = SimNVICRead(psBoard, ui32Offset, bPeek);
+        }
+
+        return(true);
+    }
+
+    return(false);
+}
+
+/*
+ * Returns true for registers where writing back the value read has a side
+ * effect, so a partial write must leave the other bytes zero.
+ */
+static bool
+BoardWriteActsOnOnes(uint32_t ui32Addr)
+{
+    uint32_t ui32Offset = ui32Addr & 0xFFF;
+
+    if((ui32Addr & 0xFFFFF000U) == BOARD_SCS_BASE)
+        return(((ui32Offset >= 0x180) && (ui32Offset < 0x300)) ||
+               (ui32Offset == 0xD04) ||
+               ((ui32Offset >= 0xD28) && (ui32Offset < 0xD30)) ||
+               (ui32Offset == 0xF00));
+
+    if(ui32Addr == 0x400FE058U)
+        return(true);
+
+    return(false);
+}
+
+/*
+ * Writes the bytes of ui32Value selected by ui32Mask into a register.
+ */
+static bool
+BoardWriteMasked(tSimBoard *psBoard, uint32_t ui32Addr, uint32_t ui32Value,
+                 uint32_t ui32Mask)
+{
+    uint32_t ui32Word = 0;
+
+    if((ui32Mask != 0xFFFFFFFFU) && !BoardWriteActsOnOnes(ui32Addr) &&
+       !BoardAccess(psBoard, ui32Addr, false, true, &ui32Word))
+        return(false);
+
+    ui32Word = (ui32Word & ~ui32Mask) | (ui32Value & ui32Mask);
+
+    return(BoardAccess(psBoard, ui32Addr, true, false, &ui32Word));
+}
+
+static uint32_t
+BoardLaneMask(uint32_t ui32Addr, uint32_t ui32Size)
+{
+    uint32_t ui32Mask = (ui32Size >= 4) ? 0xFFFFFFFFU :
+                        ((1U << (ui32Size * 8)) - 1);
+
+    return(ui32Mask << ((ui32Addr & 3) * 8));
+}
+
+bool
+SimBoardRead(tSimBoard *psBoard, uint32_t ui32Addr, uint32_t ui32Size,
+             uint32_t *pui32Value)
+{
+    uint32_t ui32Word, ui32Bit;
+
+    /*
+     * A read of the bit-band alias returns a single bit of the word.
+     */
+    if((ui32Addr >= BOARD_BITBAND_BASE) && (ui32Addr < BOARD_BITBAND_END))
+    {
+        ui32Bit = (ui32Addr >> 2) & 31;
+        ui32Addr = BOARD_PERIPH_BASE + ((ui32Addr - BOARD_BITBAND_BASE) >> 5);
+
+        if(!BoardAccess(psBoard, ui32Addr & ~3U, false, false, &ui32Word))
+            return(false);
+
+        *pui32Value = (ui32Word >> (((ui32Addr & 3) * 8) + (ui32Bit & 7))) &
+                      1;
+        return(true);
+    }
+
+    if(!BoardAccess(psBoard, ui32Addr & ~3U, false, false, &ui32Word))
+        return(false);
+
+    *pui32Value = (ui32Word & BoardLaneMask(ui32Addr, ui32Size)) >>
+                  ((ui32Addr & 3) * 8);
+    return(true);
+}
+
+bool
+SimBoardWrite(tSimBoard *psBoard, uint32_t ui32Addr, uint32_t ui32Size,
+              uint32_t ui32Value)
+{
+    uint32_t ui32Bit;
+
+    /*
+     * A write to the bit-band alias modifies a single bit of the word.
+     */
+    if((ui32Addr >= BOARD_BITBAND_BASE) && (ui32Addr < BOARD_BITBAND_END))
+    {
+        ui32Bit = (ui32Addr >> 2) & 7;
+        ui32Addr = BOARD_PERIPH_BASE + ((ui32Addr - BOARD_BITBAND_BASE) >> 5);
+        ui32Bit += (ui32Addr & 3) * 8;
+
+        return(BoardWriteMasked(psBoard, ui32Addr & ~3U,
+                                (ui32Value & 1) << ui32Bit, 1U << ui32Bit));
+    }
+
+    return(BoardWriteMasked(psBoard, ui32Addr & ~3U,
+                            ui32Value << ((ui32Addr & 3) * 8),
+                            BoardLaneMask(ui32Addr, ui32Size)));
+}
+
+/*
+ * Reads a register word without side effects.
+ */
+bool
+SimBoardPeek(tSimBoard *psBoard, uint32_t ui32Addr, uint32_t *pui32Value)
+{
+    return(BoardAccess(psBoard, ui32Addr & ~3U, false, true, pui32Value));
+}
+
+/*
+ * Returns the number of cycles until the next event fires, which happens on
+ * the first clock edge at or after its deadline.
+ */
+uint64_t
+SimBoardNextEvent(const tSimBoard *psBoard)
+{
+    uint32_t ui32Event = SimEventFirst(&psBoard->sEvents);
+    uint64_t ui64Deadline;
+
+    if(ui32Event == SIM_EVENT_NONE)
+        return(UINT64_MAX);
+
+    ui64Deadline = psBoard->sEvents.pui64Time[ui32Event];
+
+    if(ui64Deadline <= psBoard->ui64Time)
+        return(0);
+
+    return((ui64Deadline - psBoard->ui64Time + psBoard->ui32CyclePs - 1) /
+           psBoard->ui32CyclePs);
+}
+
+static void
+BoardDispatch(tSimBoard *psBoard, uint32_t ui32Event, uint64_t ui64Deadline)
+{
+    uint32_t ui32Idx;
+
+    if(ui32Event == SIM_EVENT_SYSTICK)
+    {
+        SimSysTickEvent(psBoard, ui64Deadline);
+    }
+    else if(ui32Event < SIM_EVENT_ADC0SS0)
+    {
+        ui32Idx = ui32Event - SIM_EVENT_TIMER0A;
+        SimTimerEvent(psBoard, ui32Idx / 2, ui32Idx % 2, ui64Deadline);
+    }
+    else if(ui32Event < SIM_EVENT_UART0TX)
+    {
+        ui32Idx = ui32Event - SIM_EVENT_ADC0SS0;
+        SimADCEvent(psBoard, ui32Idx / SIM_ADC_SEQUENCERS,
+                    ui32Idx % SIM_ADC_SEQUENCERS, ui64Deadline);
+    }
+    else if(ui32Event < SIM_EVENT_UART0RT)
+    {
+        SimUARTTxEvent(psBoard, ui32Event - SIM_EVENT_UART0TX, ui64Deadline);
+    }
+    else if(ui32Event < SIM_EVENT_UART0RX)
+    {
+        SimUARTTimeoutEvent(psBoard, ui32Event - SIM_EVENT_UART0RT);
+    }
+    else if(ui32Event < SIM_EVENT_HIB)
+    {
+        SimUARTPollEvent(psBoard, ui32Event - SIM_EVENT_UART0RX);
+    }
+    else if(ui32Event == SIM_EVENT_HIB)
+    {
+        SimHibEvent(psBoard);
+    }
+    else if(ui32Event == SIM_EVENT_REPLAY)
+    {
+        SimReplayEvent(psBoard);
+    }
+}
+
+/*
+ * Advances simulated time by a number of system clock cycles, firing every
+ * event that falls due on the way.
+ */
+void
+SimBoardAdvance(tSimBoard *psBoard, uint64_t ui64Cycles)
+{
+    uint64_t ui64Step, ui64Deadline;
+    uint32_t ui32Event;
+
+    while((ui32Event = SimEventFirst(&psBoard->sEvents)) != SIM_EVENT_NONE)
+    {
+        ui64Step = SimBoardNextEvent(psBoard);
+
+        if(ui64Step > ui64Cycles)
+            break;
+
+        psBoard->ui64Cycle += ui64Step;
+        psBoard->ui64Time += ui64Step * psBoard->ui32CyclePs;
+        ui64Cycles -= ui64Step;
+
+        ui64Deadline = psBoard->sEvents.pui64Time[ui32Event];
+        SimEventCancel(&psBoard->sEvents, ui32Event);
+        psBoard->sNVIC.ui64Now = psBoard->ui64Cycle;
+        BoardDispatch(psBoard, ui32Event, ui64Deadline);
+    }
+
+    psBoard->ui64Cycle += ui64Cycles;
+    psBoard->ui64Time += ui64Cycles * psBoard->ui32CyclePs;
+    psBoard->sNVIC.ui64Now = psBoard->ui64Cycle;
+}
@@ -0,0 +1,126 @@
+#ifndef __SIM_BOARD_H__
+#define __SIM_BOARD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "event.h"
+#include "nvic.h"
+#include "systick.h"
+#include "sysctl.h"
+#include "gpio.h"
+#include "timer.h"
+#include "adc.h"
+#include "uart.h"
+#include "hib.h"
+#include "replay.h"
+
+#define SIM_PS_PER_SECOND       1000000000000ULL
+
+/*
+ * Callbacks from the board into its environment.  pvContext is passed back
+ * unchanged.
+ */
+typedef struct
+{
+    void *pvContext;
+
+    /*
+     * Called when the level driven by a GPIO port changes.
+     */
+    void (*pfnPinChange)(void *pvContext, tSimBoard *psBoard,
+                         uint32_t ui32Port, uint8_t ui8Old, uint8_t ui8New);
+
+    /*
+     * Called when a UART has finished sending a character.
+     */
+    void (*pfnUARTTransmit)(void *pvContext, tSimBoard *psBoard,
+                            uint32_t ui32Port, uint8_t ui8Byte);
+
+    /*
+     * Called for every ADC conversion, if set, to return the level of an
+     * analog input (or SIM_ADC_TS) as a 12-bit result.  Otherwise the level
+     * last set with SimADCSetInput() is converted.
+     */
+    uint16_t (*pfnAnalogRead)(void *pvContext, tSimBoard *psBoard,
+                              uint32_t ui32Channel);
+
+    /*
+     * Called when a UART connected with SIM_UART_LINE_POLLED can take
+     * another character, to return the next character arriving on its
+     * receive line or -1 if none has arrived yet.
+     */
+    int32_t (*pfnUARTPoll)(void *pvContext, tSimBoard *psBoard,
+                           uint32_t ui32Port);
+} tSimBoardHooks;
+
+/*
+ * The simulated TM4C123GH6PM peripherals and their time base.  Apart from
+ * sHooks and psReplay the board is plain data, so it can be copied with
+ * memcpy().
+ *
+ * Simulated time is kept in picoseconds.  Every system clock frequency
+ * derived from the PLL or PIOSC has an integral period in picoseconds, so
+ * ui64Time is always exact.
+ *
+ * ui32ResetRequest collects the causes of a pending system reset, which the
+ * processor model carries out at the next instruction boundary.  While
+ * bHibernating is set the processor is powered down and only the hibernation
+ * module runs.
+ */
+struct tSimBoard
+{
+    uint64_t ui64Time;
+    uint64_t ui64Cycle;
+    uint32_t ui32CyclePs;
+    uint32_t ui32ResetRequest;
+    bool bHibernating;
+
+    tSimEventQueue sEvents;
+    tSimSysCtl sSysCtl;
+    tSimNVIC sNVIC;
+    tSimSysTick sSysTick;
+    tSimGPIO psGPIO[SIM_GPIO_PORTS];
+    tSimTimer psTimer[SIM_TIMERS];
+    tSimADC psADC[SIM_ADCS];
+    tSimUART psUART[SIM_UARTS];
+    tSimHib sHib;
+
+    /*
+     * Levels applied to the analog inputs from outside the chip.
+     */
+    uint16_t pui16Analog[SIM_ADC_CHANNELS + 1];
+
+    tSimBoardHooks sHooks;
+
+    /*
+     * Recording of the inputs being made or replayed, if any.
+     */
+    tSimReplay *psReplay;
+};
+
+void SimBoardInit(tSimBoard *psBoard, const tSimBoardHooks *psHooks);
+void SimBoardReset(tSimBoard *psBoard, uint32_t ui32Cause);
+void SimBoardHibernate(tSimBoard *psBoard);
+void SimBoardClockSet(tSimBoard *psBoard, uint64_t ui64CyclePs);
+
+bool SimBoardRead(tSimBoard *psBoard, uint32_t ui32Addr, uint32_t ui32Size,
+                  uint32_t *pui32Value);
+bool SimBoardWrite(tSimBoard *psBoard, uint32_t ui32Addr, uint32_t ui32Size,
+                   uint32_t ui32Value);
+bool SimBoardPeek(tSimBoard *psBoard, uint32_t ui32Addr, uint32_t *pui32Value);
+
+void SimBoardAdvance(tSimBoard *psBoard, uint64_t ui64Cycles);
+uint64_t SimBoardNextEvent(const tSimBoard *psBoard);
+
+void SimBoardPinChange(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Old,
+                       uint8_t ui8New);
+
+static inline uint32_t
+SimBoardClockHz(const tSimBoard *psBoard)
+{
+    return((uint32_t)((SIM_PS_PER_SECOND + psBoard->ui32CyclePs / 2) /
+                      psBoard->ui32CyclePs));
+}
+
+#endif
@@ -0,0 +1,1282 @@
+/*
+ * Cortex-M4F processor core: execution loop, exception model and the slow
+ * paths of the memory map.
+ */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "idle.h"
+#include "profile.h"
+#include "shadow.h"
+#include "trace.h"
+#include "thumb.h"
+#include "timing.h"
+#include "translate.h"
+
+#define CPU_SRAM_BITBAND_BASE   0x22000000U
+#define CPU_SRAM_BITBAND_END    0x24000000U
+#define CPU_PERIPH_BASE         0x40000000U
+#define CPU_PERIPH_END          0x60000000U
+#define CPU_PPB_BASE            0xE0000000U
+#define CPU_PPB_END             0xE0100000U
+
+#define CPU_EXC_RETURN          0xF0000000U
+
+#define CCR_UNALIGN_TRP         0x00000008U
+#define CCR_STKALIGN            0x00000200U
+#define SCR_SLEEPONEXIT         0x00000002U
+#define HFSR_VECTTBL            0x00000002U
+#define HFSR_FORCED             0x40000000U
+#define FPCCR_ASPEN             0x80000000U
+
+static bool CpuBusRead(tSimMachine *psMachine, uint32_t ui32Addr,
+                       uint32_t ui32Size, uint32_t *pui32Value, bool bPeek);
+
+bool
+SimCpuInit(tSimMachine *psMachine, const tSimBoardHooks *psHooks)
+{
+    memset(psMachine, 0, sizeof(*psMachine));
+
+    psMachine->psCode = calloc(SIM_MEM_ARENA_SIZE / 2, sizeof(tSimInsn));
+
+    if(!psMachine->psCode)
+        return(false);
+
+    SimBoardInit(&psMachine->sBoard, psHooks);
+    SimMemoryInit(&psMachine->sMemory);
+
+    return(true);
+}
+
+void
+SimCpuFree(tSimMachine *psMachine)
+{
+    SimTranslateFree(psMachine);
+    SimIdleFree(psMachine);
+    SimTimingFree(psMachine);
+    SimDebugFree(psMachine);
+    SimProfileFree(psMachine);
+    SimShadowFree(psMachine);
+    SimTraceClose(psMachine);
+    free(psMachine->psCode);
+    psMachine->psCode = NULL;
+}
+
+/*
+ * Forgets all decoded instructions, for use after memory has been modified
+ * from outside.
+ */
+void
+SimCpuInvalidate(tSimMachine *psMachine)
+{
+    memset(psMachine->psCode, 0,
+           (SIM_MEM_ARENA_SIZE / 2) * sizeof(tSimInsn));
+
+    if(psMachine->psTranslator)
+        SimTranslateFlush(psMachine);
+
+    SimIdleFlush(psMachine);
+}
+
+/*
+ * Forgets the decoded instructions overlapping a range of memory that has
+ * been written.
+ */
+void
+SimCpuInvalidateRange(tSimMachine *psMachine, uint32_t ui32Addr,
+                      uint32_t ui32Size)
+{
+    uint32_t ui32Insn, ui32Offset;
+    tSimInsn *psInsn;
+    bool bDecoded = false;
+
+    /*
+     * A 32-bit instruction starting two bytes earlier overlaps the range.
+     */
+    for(ui32Insn = (ui32Addr & ~1U) - 2; ui32Insn < ui32Addr + ui32Size;
+        ui32Insn += 2)
+    {
+        ui32Offset = SimMemoryOffset(psMachine->sMemory.pui32Read, ui32Insn);
+
+        if(!ui32Offset)
+            continue;
+
+        psInsn = &psMachine->psCode[(ui32Offset - 1) / 2];
+        bDecoded |= (psInsn->pfnExec != NULL);
+        psInsn->pfnExec = NULL;
+    }
+
+    /*
+     * Translated code built from the old instructions is dropped, and the
+     * block doing the write leaves at the end of the instruction.
+     */
+    if(bDecoded && psMachine->psTranslator)
+    {
+        SimTranslateFlush(psMachine);
+        ThumbEndSlice(psMachine);
+    }
+
+    if(bDecoded)
+        SimIdleFlush(psMachine);
+}
+
+uint32_t
+SimCpuXPSR(const tSimCpu *psCpu)
+{
+    return(((uint32_t)psCpu->ui8N << 31) | ((uint32_t)psCpu->ui8Z << 30) |
+           ((uint32_t)psCpu->ui8C << 29) | ((uint32_t)psCpu->ui8V << 28) |
+           ((uint32_t)psCpu->ui8Q << 27) | ((psCpu->ui32IT & 3) << 25) |
+           (psCpu->bThumb ? SIM_CPU_XPSR_T : 0) |
+           ((uint32_t)psCpu->ui8GE << 16) | ((psCpu->ui32IT & 0xFC) << 8) |
+           psCpu->ui32IPSR);
+}
+
+static void
+CpuSetAPSR(tSimCpu *psCpu, uint32_t ui32Value)
+{
+    psCpu->ui8N = (ui32Value >> 31) & 1;
+    psCpu->ui8Z = (ui32Value >> 30) & 1;
+    psCpu->ui8C = (ui32Value >> 29) & 1;
+    psCpu->ui8V = (ui32Value >> 28) & 1;
+    psCpu->ui8Q = (ui32Value >> 27) & 1;
+}
+
+static bool
+CpuPrivileged(const tSimCpu *psCpu)
+{
+    return(psCpu->bHandler || !(psCpu->ui32Control & SIM_CPU_CONTROL_NPRIV));
+}
+
+/*
+ * Changes the mode and CONTROL, swapping the banked stack pointers when the
+ * active one changes.
+ */
+static void
+CpuSetMode(tSimCpu *psCpu, bool bHandler, uint32_t ui32Control)
+{
+    bool bProcess = !psCpu->bHandler &&
+                    (psCpu->ui32Control & SIM_CPU_CONTROL_SPSEL);
+    bool bNewProcess = !bHandler && (ui32Control & SIM_CPU_CONTROL_SPSEL);
+    uint32_t ui32SP;
+
+    if(bProcess != bNewProcess)
+    {
+        ui32SP = psCpu->pui32R[13];
+        psCpu->pui32R[13] = psCpu->ui32OtherSP;
+        psCpu->ui32OtherSP = ui32SP;
+    }
+
+    psCpu->bHandler = bHandler;
+    psCpu->ui32Control = ui32Control;
+}
+
+static int32_t
+CpuExecPriority(const tSimMachine *psMachine)
+{
+    return(SimNVICExecPriority(&psMachine->sBoard.sNVIC,
+                               psMachine->sCpu.bPrimask,
+                               psMachine->sCpu.ui32BasePri,
+                               psMachine->sCpu.bFaultmask));
+}
+
+/*
+ * Reset of the core: the stack pointer and the entry point are taken from
+ * the vector table.  The counters keep running.
+ */
+void
+SimCpuReset(tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32SP = 0, ui32Entry = 0;
+
+    memset(psCpu, 0, offsetof(tSimCpu, ui64Cycle));
+    psCpu->ui64Limit = 0;
+
+    CpuBusRead(psMachine, psMachine->sBoard.sNVIC.ui32VTOR, 4, &ui32SP, true);
+    CpuBusRead(psMachine, psMachine->sBoard.sNVIC.ui32VTOR + 4, 4, &ui32Entry,
+               true);
+
+    psCpu->pui32R[13] = ui32SP & ~3U;
+    psCpu->pui32R[14] = 0xFFFFFFFFU;
+    psCpu->ui32PC = ui32Entry & ~1U;
+    psCpu->bThumb = ui32Entry & 1;
+
+    SimTimingReset(psMachine);
+}
+
+/*
+ * Lowers the end of the current slice after a peripheral write, which may
+ * have moved a deadline or pended an interrupt.
+ */
+static void
+CpuRecheck(tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint64_t ui64Next = SimBoardNextEvent(&psMachine->sBoard);
+
+    if((ui64Next != UINT64_MAX) &&
+       (psCpu->ui64Cycle + ui64Next < psCpu->ui64Limit))
+        psCpu->ui64Limit = psCpu->ui64Cycle + ui64Next;
+
+    if(SimNVICPendingException(&psMachine->sBoard.sNVIC,
+                               CpuExecPriority(psMachine)))
+        psCpu->ui64Limit = 0;
+}
+
+static bool
+CpuPeripheral(uint32_t ui32Addr)
+{
+    return(((ui32Addr >= CPU_PERIPH_BASE) && (ui32Addr < CPU_PERIPH_END)) ||
+           ((ui32Addr >= CPU_PPB_BASE) && (ui32Addr < CPU_PPB_END)));
+}
+
+/*
+ * Accesses the memory map without faulting.  Returns false on a bus error.
+ */
+static bool
+CpuBusRead(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+           uint32_t *pui32Value, bool bPeek)
+{
+    tSimMemory *psMemory = &psMachine->sMemory;
+    uint32_t ui32Offset, ui32Idx, ui32Word;
+
+    if(!bPeek)
+        SimDebugAccess(psMachine, ui32Addr, ui32Size, false);
+
+    if(SimMemoryOffset(psMemory->pui32Read, ui32Addr))
+    {
+        *pui32Value = 0;
+
+        for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+        {
+            ui32Offset = SimMemoryOffset(psMemory->pui32Read,
+                                         ui32Addr + ui32Idx);
+
+            if(!ui32Offset)
+                return(false);
+
+            *pui32Value |= (uint32_t)psMemory->pui8Arena[ui32Offset - 1] <<
+                           (ui32Idx * 8);
+        }
+
+        return(true);
+    }
+
+    if((ui32Addr >= CPU_SRAM_BITBAND_BASE) && (ui32Addr < CPU_SRAM_BITBAND_END))
+    {
+        ui32Offset = SimMemoryOffset(psMemory->pui32Read,
+                                     SIM_SRAM_BASE +
+                                     ((ui32Addr - CPU_SRAM_BITBAND_BASE) >> 5));
+
+        if(!ui32Offset)
+            return(false);
+
+        *pui32Value = (psMemory->pui8Arena[ui32Offset - 1] >>
+                       ((ui32Addr >> 2) & 7)) & 1;
+        return(true);
+    }
+
+    if(!CpuPeripheral(ui32Addr) ||
+       ((ui32Addr & 3) + ui32Size > 4))
+        return(false);
+
+    if(bPeek)
+    {
+        if(!SimBoardPeek(&psMachine->sBoard, ui32Addr, &ui32Word))
+            return(false);
+
+        ui32Word >>= (ui32Addr & 3) * 8;
+        *pui32Value = (ui32Size == 4) ? ui32Word :
+                      ui32Word & ((1U << (ui32Size * 8)) - 1);
+        return(true);
+    }
+
+    ThumbSync(psMachine);
+
+    if(!SimBoardRead(&psMachine->sBoard, ui32Addr, ui32Size, pui32Value))
+    {
+        /*
+         * The debug components of the private peripheral bus that are not
+         * modeled read as zero.
+         */
+        if(ui32Addr < CPU_PPB_BASE)
+            return(false);
+
+        *pui32Value = 0;
+    }
+
+    if(psMachine->psTrace && SimTraced(ui32Addr))
+        SimTraceAccess(psMachine, ui32Addr, ui32Size, *pui32Value, false);
+
+    return(true);
+}
+
+static bool
+CpuBusWrite(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+            uint32_t ui32Value, bool bDebug)
+{
+    tSimMemory *psMemory = &psMachine->sMemory;
+    uint32_t ui32Offset, ui32Idx, ui32Bit;
+
+    if(!bDebug)
+        SimDebugAccess(psMachine, ui32Addr, ui32Size, true);
+
+    if(SimMemoryOffset(psMemory->pui32Read, ui32Addr))
+    {
+        /*
+         * Flash can only be programmed from outside.
+         */
+        if((ui32Addr < SIM_SRAM_BASE) && !bDebug)
+            return(false);
+
+        for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+        {
+            ui32Offset = SimMemoryOffset(psMemory->pui32Read,
+                                         ui32Addr + ui32Idx);
+
+            if(!ui32Offset || ((ui32Addr + ui32Idx < SIM_SRAM_BASE) &&
+                               !bDebug))
+                return(false);
+
+            psMemory->pui8Arena[ui32Offset - 1] =
+                (uint8_t)(ui32Value >> (ui32Idx * 8));
+        }
+
+        SimMemoryTouch(psMemory, ui32Addr);
+        SimMemoryTouch(psMemory, ui32Addr + ui32Size - 1);
+        SimCpuInvalidateRange(psMachine, ui32Addr, ui32Size);
+
+        if(bDebug && psMachine->psShadow)
+            SimShadowDefine(psMachine, ui32Addr, ui32Size);
+
+        return(true);
+    }
+
+    if((ui32Addr >= CPU_SRAM_BITBAND_BASE) && (ui32Addr < CPU_SRAM_BITBAND_END))
+    {
+        ui32Bit = 1U << ((ui32Addr >> 2) & 7);
+        ui32Addr = SIM_SRAM_BASE + ((ui32Addr - CPU_SRAM_BITBAND_BASE) >> 5);
+        ui32Offset = SimMemoryOffset(psMemory->pui32Read, ui32Addr);
+
+        if(!ui32Offset)
+            return(false);
+
+        if(ui32Value & 1)
+            psMemory->pui8Arena[ui32Offset - 1] |= ui32Bit;
+        else
+            psMemory->pui8Arena[ui32Offset - 1] &= ~ui32Bit;
+
+        SimMemoryTouch(psMemory, ui32Addr);
+        SimCpuInvalidateRange(psMachine, ui32Addr, 1);
+        return(true);
+    }
+
+    if(!CpuPeripheral(ui32Addr) ||
+       ((ui32Addr & 3) + ui32Size > 4))
+        return(false);
+
+    ThumbSync(psMachine);
+
+    if(!SimBoardWrite(&psMachine->sBoard, ui32Addr, ui32Size, ui32Value) &&
+       (ui32Addr < CPU_PPB_BASE))
+        return(false);
+
+    if(psMachine->psTrace && !bDebug && SimTraced(ui32Addr))
+        SimTraceAccess(psMachine, ui32Addr, ui32Size, ui32Value, true);
+
+    CpuRecheck(psMachine);
+    return(true);
+}
+
+bool
+SimCpuReadMemory(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+                 uint32_t *pui32Value)
+{
+    return(CpuBusRead(psMachine, ui32Addr, ui32Size, pui32Value, true));
+}
+
+/*
+ * Writes the memory map as a debugger does: flash can be written and the
+ * decoded instructions of what is written are forgotten.
+ */
+bool
+SimCpuWriteMemory(tSimMachine *psMachine, uint32_t ui32Addr,
+                  uint32_t ui32Size, uint32_t ui32Value)
+{
+    return(CpuBusWrite(psMachine, ui32Addr, ui32Size, ui32Value, true));
+}
+
+/*
+ * Makes a synchronous exception pending, escalating it to HardFault if it
+ * cannot be taken right away.  A fault that cannot be handled at all locks
+ * the processor up.
+ */
+static void
+CpuRaise(tSimMachine *psMachine, uint32_t ui32Exc)
+{
+    tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    int32_t i32ExecPriority = CpuExecPriority(psMachine);
+
+    if(((ui32Exc >= SIM_EXC_MEMMANAGE) && (ui32Exc <= SIM_EXC_USAGEFAULT) &&
+        !(psNVIC->ui32SHCSR & (1U << (12 + ui32Exc)))) ||
+       ((ui32Exc != SIM_EXC_HARDFAULT) &&
+        (SimNVICGroupPriority(psNVIC, SimNVICPriority(psNVIC, ui32Exc)) >=
+         i32ExecPriority)))
+    {
+        ui32Exc = SIM_EXC_HARDFAULT;
+        psNVIC->ui32HFSR |= HFSR_FORCED;
+    }
+
+    if((ui32Exc == SIM_EXC_HARDFAULT) && (i32ExecPriority <= -1))
+    {
+        psMachine->sCpu.bLockup = true;
+        return;
+    }
+
+    SimNVICSetPending(psNVIC, ui32Exc);
+}
+
+void
+SimCpuFault(tSimMachine *psMachine, uint32_t ui32Exc, uint32_t ui32Status)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    psMachine->sBoard.sNVIC.ui32CFSR |= ui32Status;
+    CpuRaise(psMachine, ui32Exc);
+
+    /*
+     * The faulting instruction is abandoned and becomes the return address.
+     */
+    psCpu->ui32PC = psCpu->ui32InsnPC;
+    psCpu->ui64Limit = 0;
+    longjmp(psCpu->sAbort, 1);
+}
+
+uint32_t
+SimCpuLoadSlow(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size)
+{
+    uint32_t ui32Value;
+
+    if((ui32Addr & (ui32Size - 1)) &&
+       (psMachine->sBoard.sNVIC.ui32CCR & CCR_UNALIGN_TRP))
+        SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_UNALIGNED);
+
+    if(!CpuBusRead(psMachine, ui32Addr, ui32Size, &ui32Value, false))
+    {
+        psMachine->sBoard.sNVIC.ui32BFAR = ui32Addr;
+        SimCpuFault(psMachine, SIM_EXC_BUSFAULT,
+                    SIM_CFSR_PRECISERR | SIM_CFSR_BFARVALID);
+    }
+
+    return(ui32Value);
+}
+
+void
+SimCpuStoreSlow(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+                uint32_t ui32Value)
+{
+    if((ui32Addr & (ui32Size - 1)) &&
+       (psMachine->sBoard.sNVIC.ui32CCR & CCR_UNALIGN_TRP))
+        SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_UNALIGNED);
+
+    if(!CpuBusWrite(psMachine, ui32Addr, ui32Size, ui32Value, false))
+    {
+        psMachine->sBoard.sNVIC.ui32BFAR = ui32Addr;
+        SimCpuFault(psMachine, SIM_EXC_BUSFAULT,
+                    SIM_CFSR_PRECISERR | SIM_CFSR_BFARVALID);
+    }
+}
+
+/*
+ * Pushes the exception frame and enters the handler.
+ */
+static void
+CpuExceptionEntry(tSimMachine *psMachine, uint32_t ui32Exc)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    bool bFP = (psCpu->ui32Control & SIM_CPU_CONTROL_FPCA) != 0;
+    uint32_t ui32SP = psCpu->pui32R[13], ui32Frame, ui32Idx, ui32Vector;
+    uint32_t pui32Frame[8];
+    bool bOk = true;
+
+    ui32Frame = (ui32SP - (bFP ? 0x68 : 0x20)) &
+                ((psNVIC->ui32CCR & CCR_STKALIGN) ? ~7U : ~3U);
+
+    pui32Frame[0] = psCpu->pui32R[0];
+    pui32Frame[1] = psCpu->pui32R[1];
+    pui32Frame[2] = psCpu->pui32R[2];
+    pui32Frame[3] = psCpu->pui32R[3];
+    pui32Frame[4] = psCpu->pui32R[12];
+    pui32Frame[5] = psCpu->pui32R[14];
+    pui32Frame[6] = psCpu->ui32PC;
+    pui32Frame[7] = SimCpuXPSR(psCpu) |
+                    (((psNVIC->ui32CCR & CCR_STKALIGN) && (ui32SP & 4)) ?
+                     SIM_CPU_XPSR_ALIGN : 0);
+
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+        bOk &= CpuBusWrite(psMachine, ui32Frame + ui32Idx * 4, 4,
+                           pui32Frame[ui32Idx], false);
+
+    if(bFP)
+    {
+        for(ui32Idx = 0; ui32Idx < 16; ui32Idx++)
+            bOk &= CpuBusWrite(psMachine, ui32Frame + 0x20 + ui32Idx * 4, 4,
+                               psCpu->pui32S[ui32Idx], false);
+
+        bOk &= CpuBusWrite(psMachine, ui32Frame + 0x60, 4, psCpu->ui32FPSCR,
+                           false);
+    }
+
+    if(psMachine->psShadow)
+        SimShadowStore(psMachine, ui32Frame, bFP ? 0x68 : 0x20);
+
+    psCpu->pui32R[13] = ui32Frame;
+    psCpu->pui32R[14] = psCpu->bHandler ? 0xFFFFFFF1U :
+                        (psCpu->ui32Control & SIM_CPU_CONTROL_SPSEL) ?
+                        0xFFFFFFFDU : 0xFFFFFFF9U;
+
+    if(bFP)
+        psCpu->pui32R[14] &= ~0x10U;
+
+    CpuSetMode(psCpu, true,
+               psCpu->ui32Control & ~(SIM_CPU_CONTROL_SPSEL |
+                                      SIM_CPU_CONTROL_FPCA));
+
+    psCpu->ui32IPSR = ui32Exc;
+    psCpu->ui32IT = 0;
+    psCpu->bExclusive = false;
+    psCpu->bSleeping = false;
+    psCpu->ui32Exceptions++;
+
+    SimNVICActivate(psNVIC, ui32Exc);
+
+    if(!CpuBusRead(psMachine, psNVIC->ui32VTOR + ui32Exc * 4, 4, &ui32Vector,
+                   false))
+    {
+        psNVIC->ui32HFSR |= HFSR_VECTTBL;
+        psCpu->bLockup = true;
+        return;
+    }
+
+    psCpu->ui32PC = ui32Vector & ~1U;
+    psCpu->bThumb = ui32Vector & 1;
+
+    /*
+     * A failed push is reported as a derived exception, taken once the
+     * handler has been entered.
+     */
+    if(!bOk)
+    {
+        psNVIC->ui32CFSR |= SIM_CFSR_STKERR;
+        CpuRaise(psMachine, SIM_EXC_BUSFAULT);
+    }
+}
+
+static void
+CpuExceptionReturn(tSimMachine *psMachine, uint32_t ui32ExcReturn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    uint32_t ui32Exc = psCpu->ui32IPSR, ui32Frame, ui32Idx, ui32XPSR;
+    uint32_t ui32Control = psCpu->ui32Control;
+    uint32_t pui32Frame[8];
+    bool bThread = (ui32ExcReturn & 8) != 0, bFP, bOk = true;
+
+    if(((ui32ExcReturn & 0x0FFFFFE0U) != 0x0FFFFFE0U) ||
+       (((ui32ExcReturn & 0xF) != 0x1) && ((ui32ExcReturn & 0xF) != 0x9) &&
+        ((ui32ExcReturn & 0xF) != 0xD)) ||
+       !SimNVICBit(psNVIC->pui32Active, ui32Exc))
+        SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_INVPC);
+
+    bFP = !(ui32ExcReturn & 0x10);
+
+    if(ui32Exc != SIM_EXC_NMI)
+        psCpu->bFaultmask = false;
+
+    SimNVICDeactivate(psNVIC, ui32Exc);
+
+    if(psMachine->psTiming)
+        SimTimingReturn(psMachine, ui32Exc);
+
+    if(bThread && (ui32ExcReturn & 4))
+        ui32Control |= SIM_CPU_CONTROL_SPSEL;
+    else
+        ui32Control &= ~SIM_CPU_CONTROL_SPSEL;
+
+    if(bFP)
+        ui32Control |= SIM_CPU_CONTROL_FPCA;
+    else
+        ui32Control &= ~SIM_CPU_CONTROL_FPCA;
+
+    CpuSetMode(psCpu, !bThread, ui32Control);
+    ui32Frame = psCpu->pui32R[13];
+
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+        bOk &= CpuBusRead(psMachine, ui32Frame + ui32Idx * 4, 4,
+                          &pui32Frame[ui32Idx], false);
+
+    if(bFP)
+    {
+        for(ui32Idx = 0; ui32Idx < 16; ui32Idx++)
+            bOk &= CpuBusRead(psMachine, ui32Frame + 0x20 + ui32Idx * 4, 4,
+                              &psCpu->pui32S[ui32Idx], false);
+
+        bOk &= CpuBusRead(psMachine, ui32Frame + 0x60, 4, &psCpu->ui32FPSCR,
+                          false);
+    }
+
+    if(!bOk)
+    {
+        psNVIC->ui32CFSR |= SIM_CFSR_UNSTKERR;
+        CpuRaise(psMachine, SIM_EXC_BUSFAULT);
+    }
+
+    ui32XPSR = pui32Frame[7];
+    psCpu->pui32R[0] = pui32Frame[0];
+    psCpu->pui32R[1] = pui32Frame[1];
+    psCpu->pui32R[2] = pui32Frame[2];
+    psCpu->pui32R[3] = pui32Frame[3];
+    psCpu->pui32R[12] = pui32Frame[4];
+    psCpu->pui32R[14] = pui32Frame[5];
+    psCpu->ui32PC = pui32Frame[6] & ~1U;
+    psCpu->pui32R[13] = (ui32Frame + (bFP ? 0x68 : 0x20)) |
+                        (((psNVIC->ui32CCR & CCR_STKALIGN) &&
+                          (ui32XPSR & SIM_CPU_XPSR_ALIGN)) ? 4 : 0);
+
+    CpuSetAPSR(psCpu, ui32XPSR);
+    psCpu->ui8GE = (ui32XPSR >> 16) & 0xF;
+    psCpu->ui32IT = ((ui32XPSR >> 25) & 3) | ((ui32XPSR >> 8) & 0xFC);
+    psCpu->bThumb = (ui32XPSR & SIM_CPU_XPSR_T) != 0;
+    psCpu->ui32IPSR = ui32XPSR & 0x1FF;
+    psCpu->bExclusive = false;
+
+    if(bThread && (psNVIC->ui32SCR & SCR_SLEEPONEXIT))
+        psCpu->bSleeping = true;
+
+    ThumbEndSlice(psMachine);
+}
+
+/*
+ * BXWritePC() of the architecture, which also performs exception returns.
+ */
+void
+SimCpuBranchExchange(tSimMachine *psMachine, uint32_t ui32Target)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    if(psCpu->bHandler &&
+       ((ui32Target & CPU_EXC_RETURN) == CPU_EXC_RETURN))
+    {
+        CpuExceptionReturn(psMachine, ui32Target);
+        return;
+    }
+
+    psCpu->ui32PC = ui32Target & ~1U;
+
+    if(!(ui32Target & 1))
+    {
+        psCpu->bThumb = false;
+        ThumbEndSlice(psMachine);
+    }
+}
+
+uint32_t
+SimCpuSpecialRead(tSimMachine *psMachine, uint32_t ui32SYSm)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Value = 0;
+
+    if(ui32SYSm < 8)
+    {
+        if(ui32SYSm & 1)
+            ui32Value |= psCpu->ui32IPSR;
+
+        if(!(ui32SYSm & 4))
+            ui32Value |= (SimCpuXPSR(psCpu) & 0xF80F0000U);
+
+        return(ui32Value);
+    }
+
+    switch(ui32SYSm)
+    {
+        case 8:
+            return((!psCpu->bHandler &&
+                    (psCpu->ui32Control & SIM_CPU_CONTROL_SPSEL)) ?
+                   psCpu->ui32OtherSP : psCpu->pui32R[13]);
+
+        case 9:
+            return((!psCpu->bHandler &&
+                    (psCpu->ui32Control & SIM_CPU_CONTROL_SPSEL)) ?
+                   psCpu->pui32R[13] : psCpu->ui32OtherSP);
+
+        case 16:
+            return(psCpu->bPrimask);
+
+        case 17:
+        case 18:
+            return(psCpu->ui32BasePri);
+
+        case 19:
+            return(psCpu->bFaultmask);
+
+        case 20:
+            return(psCpu->ui32Control);
+
+        default:
+            return(0);
+    }
+}
+
+void
+SimCpuSpecialWrite(tSimMachine *psMachine, uint32_t ui32SYSm,
+                   uint32_t ui32Mask, uint32_t ui32Value)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    bool bProcess = !psCpu->bHandler &&
+                    (psCpu->ui32Control & SIM_CPU_CONTROL_SPSEL);
+
+    if(ui32SYSm < 8)
+    {
+        if(ui32SYSm & 4)
+            return;
+
+        if(ui32Mask & 2)
+            CpuSetAPSR(psCpu, ui32Value);
+
+        if(ui32Mask & 1)
+            psCpu->ui8GE = (ui32Value >> 16) & 0xF;
+
+        return;
+    }
+
+    if(!CpuPrivileged(psCpu))
+        return;
+
+    switch(ui32SYSm)
+    {
+        case 8:
+            if(bProcess)
+                psCpu->ui32OtherSP = ui32Value & ~3U;
+            else
+                psCpu->pui32R[13] = ui32Value & ~3U;
+            break;
+
+        case 9:
+            if(bProcess)
+                psCpu->pui32R[13] = ui32Value & ~3U;
+            else
+                psCpu->ui32OtherSP = ui32Value & ~3U;
+            break;
+
+        case 16:
+            psCpu->bPrimask = ui32Value & 1;
+            break;
+
+        case 17:
+            psCpu->ui32BasePri = ui32Value & 0xE0;
+            break;
+
+        case 18:
+            ui32Value &= 0xE0;
+
+            if(ui32Value && (!psCpu->ui32BasePri ||
+                             (ui32Value < psCpu->ui32BasePri)))
+                psCpu->ui32BasePri = ui32Value;
+            break;
+
+        case 19:
+            if(!(ui32Value & 1))
+                psCpu->bFaultmask = false;
+            else if(CpuExecPriority(psMachine) > -1)
+                psCpu->bFaultmask = true;
+            break;
+
+        case 20:
+            ui32Value &= SIM_CPU_CONTROL_NPRIV | SIM_CPU_CONTROL_SPSEL |
+                         SIM_CPU_CONTROL_FPCA;
+
+            /*
+             * The stack pointer selection is fixed in handler mode.
+             */
+            if(psCpu->bHandler)
+                ui32Value = (ui32Value & ~SIM_CPU_CONTROL_SPSEL) |
+                            (psCpu->ui32Control & SIM_CPU_CONTROL_SPSEL);
+
+            CpuSetMode(psCpu, psCpu->bHandler, ui32Value);
+            break;
+
+        default:
+            break;
+    }
+
+    ThumbEndSlice(psMachine);
+}
+
+/*
+ * CPSIE and CPSID.
+ */
+void
+SimCpuChangeMask(tSimMachine *psMachine, bool bFaultmask, bool bDisable)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    if(!CpuPrivileged(psCpu))
+        return;
+
+    if(!bFaultmask)
+        psCpu->bPrimask = bDisable;
+    else if(!bDisable)
+        psCpu->bFaultmask = false;
+    else if(CpuExecPriority(psMachine) > -1)
+        psCpu->bFaultmask = true;
+
+    ThumbEndSlice(psMachine);
+}
+
+/*
+ * WFI and WFE.  The processor sleeps until the next slice finds a reason to
+ * wake it up.
+ */
+void
+SimCpuWait(tSimMachine *psMachine, bool bForEvent)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    if(bForEvent && psCpu->bEvent)
+    {
+        psCpu->bEvent = false;
+        return;
+    }
+
+    psCpu->bSleeping = true;
+    ThumbEndSlice(psMachine);
+}
+
+void
+SimCpuSupervisorCall(tSimMachine *psMachine)
+{
+    CpuRaise(psMachine, SIM_EXC_SVCALL);
+    ThumbEndSlice(psMachine);
+}
+
+/*
+ * BKPT halts the processor at the instruction, as a debugger would.
+ */
+void
+SimCpuBreakpoint(tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    psCpu->ui32PC = psCpu->ui32InsnPC;
+    psCpu->bBreakpoint = true;
+    ThumbEndSlice(psMachine);
+}
+
+/*
+ * Checks that the floating-point unit is enabled and marks the
+ * floating-point context as active.
+ */
+void
+SimCpuFPUsed(tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Access = (psMachine->sBoard.sNVIC.ui32CPACR >> 20) & 3;
+
+    if(!ui32Access || (ui32Access == 2) ||
+       ((ui32Access == 1) && !CpuPrivileged(psCpu)))
+        SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_NOCP);
+
+    if(psMachine->sBoard.sNVIC.ui32FPCCR & FPCCR_ASPEN)
+        psCpu->ui32Control |= SIM_CPU_CONTROL_FPCA;
+}
+
+/*
+ * Requests SimCpuRun() to return at the next instruction boundary.
+ */
+void
+SimCpuStop(tSimMachine *psMachine)
+{
+    psMachine->sCpu.bStop = true;
+    ThumbEndSlice(psMachine);
+}
+
+static void __attribute__((noreturn))
+CpuFetchFault(tSimMachine *psMachine, uint32_t ui32Addr)
+{
+    psMachine->sCpu.ui32InsnPC = psMachine->sCpu.ui32PC;
+
+    if(ui32Addr >= CPU_PERIPH_BASE)
+        SimCpuFault(psMachine, SIM_EXC_MEMMANAGE, SIM_CFSR_IACCVIOL);
+
+    SimCpuFault(psMachine, SIM_EXC_BUSFAULT, SIM_CFSR_IBUSERR);
+}
+
+static const tSimInsn *
+CpuDecode(tSimMachine *psMachine, uint32_t ui32PC, uint32_t ui32Offset)
+{
+    tSimMemory *psMemory = &psMachine->sMemory;
+    tSimInsn *psInsn = &psMachine->psCode[(ui32Offset - 1) / 2];
+    uint16_t ui16Hw1, ui16Hw2 = 0;
+    uint32_t ui32Offset2;
+
+    memcpy(&ui16Hw1, &psMemory->pui8Arena[ui32Offset - 1], 2);
+
+    if((ui16Hw1 >> 11) >= 0x1D)
+    {
+        ui32Offset2 = SimMemoryOffset(psMemory->pui32Read, ui32PC + 2);
+
+        if(!ui32Offset2)
+            CpuFetchFault(psMachine, ui32PC + 2);
+
+        memcpy(&ui16Hw2, &psMemory->pui8Arena[ui32Offset2 - 1], 2);
+    }
+
+    SimThumbDecode(ui32PC, ui16Hw1, ui16Hw2, psInsn);
+    psInsn->ui8Cycles = SimThumbCycles(psInsn);
+
+    /*
+     * Writes to SRAM holding decoded instructions must invalidate them.
+     */
+    if(ui32PC >= SIM_SRAM_BASE)
+    {
+        SimMemoryProtect(psMemory, ui32PC, true);
+        SimMemoryProtect(psMemory, ui32PC + psInsn->ui8Size - 1, true);
+    }
+
+    return(psInsn);
+}
+
+/*
+ * Returns the decoded instruction at ui32PC without faulting, or NULL if it
+ * cannot be fetched.
+ */
+const tSimInsn *
+SimCpuInsn(tSimMachine *psMachine, uint32_t ui32PC)
+{
+    tSimMemory *psMemory = &psMachine->sMemory;
+    uint32_t ui32Offset = SimMemoryOffset(psMemory->pui32Read, ui32PC);
+    const tSimInsn *psInsn;
+
+    if(!ui32Offset)
+        return(NULL);
+
+    psInsn = &psMachine->psCode[(ui32Offset - 1) / 2];
+
+    if(psInsn->pfnExec)
+        return(psInsn);
+
+    if((psMemory->pui8Arena[ui32Offset] >= 0xE8) &&
+       !SimMemoryOffset(psMemory->pui32Read, ui32PC + 2))
+        return(NULL);
+
+    return(CpuDecode(psMachine, ui32PC, ui32Offset));
+}
+
+/*
+ * Returns the decoded instruction at ui32PC, decoding it if necessary.
+ */
+static inline const tSimInsn *
+CpuFetch(tSimMachine *psMachine, uint32_t ui32PC)
+{
+    uint32_t ui32Offset = SimMemoryOffset(psMachine->sMemory.pui32Read,
+                                          ui32PC);
+
+    if(!ui32Offset)
+        CpuFetchFault(psMachine, ui32PC);
+
+    return(&psMachine->psCode[(ui32Offset - 1) / 2]);
+}
+
+/*
+ * Executes instructions until the end of the slice.  While execution falls
+ * through within a page the next decoded instruction directly follows the
+ * current one, so the page tables are only consulted after branches.
+ *
+ * Translated code is tried at branch targets and after IT blocks, and
+ * again only after the next branch if nothing could run.  Short backward
+ * branches are reported to the idle loop detector.  Only while a debugger
+ * has breakpoints set is every instruction checked against them, only
+ * while profiling is every instruction counted and only while shadowing
+ * SRAM is the stack pointer checked after every instruction.
+ */
+static void
+CpuExecute(tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    const tSimInsn *psInsn;
+    uint32_t ui32PC, ui32Next, ui32IT;
+    bool bTranslate = (psMachine->psTranslator != NULL);
+    bool bBreak = psMachine->psDebug && psMachine->psDebug->ui32Breaks;
+    bool bProfile = (psMachine->psProfile != NULL);
+    bool bShadow = (psMachine->psShadow != NULL);
+
+    ui32PC = psCpu->ui32PC;
+    psInsn = NULL;
+
+    while(psCpu->ui64Cycle < psCpu->ui64Limit)
+    {
+        if(bTranslate && !psCpu->ui32IT)
+        {
+            if(SimTranslateRun(psMachine))
+            {
+                ui32PC = psCpu->ui32PC;
+                psInsn = NULL;
+                continue;
+            }
+
+            bTranslate = false;
+        }
+
+        if(__builtin_expect(bBreak, 0) && SimDebugBreak(psMachine, ui32PC))
+            break;
+
+        if(!psInsn)
+            psInsn = CpuFetch(psMachine, ui32PC);
+
+        if(__builtin_expect(!psInsn->pfnExec, 0))
+            psInsn = CpuDecode(psMachine, ui32PC,
+                               SimMemoryOffset(psMachine->sMemory.pui32Read,
+                                               ui32PC));
+
+        ui32Next = ui32PC + psInsn->ui8Size;
+
+        psCpu->ui32InsnPC = ui32PC;
+        psCpu->pui32R[15] = ui32PC + 4;
+        psCpu->ui32PC = ui32Next;
+        psCpu->ui64Cycle++;
+        psCpu->ui64Insns++;
+
+        ui32IT = psCpu->ui32IT;
+
+        if(__builtin_expect(!ui32IT, 1))
+            psInsn->pfnExec(psMachine, psInsn);
+        else
+        {
+            /*
+             * Inside an IT block the instruction is skipped when its
+             * condition fails.  ITSTATE advances unless the instruction
+             * replaced it.
+             */
+            if(ThumbCondition(psCpu, ui32IT >> 4))
+                psInsn->pfnExec(psMachine, psInsn);
+
+            if(psCpu->ui32IT == ui32IT)
+                psCpu->ui32IT = (ui32IT & 7) ?
+                                ((ui32IT & 0xE0) | ((ui32IT << 1) & 0x1F)) :
+                                0;
+
+            bTranslate = (psMachine->psTranslator && !psCpu->ui32IT);
+        }
+
+        if(psMachine->psTiming)
+            SimTimingInsn(psMachine, psInsn, ui32Next);
+
+        if((psCpu->ui32PC == ui32Next) &&
+           (ui32Next & (SIM_MEM_PAGE_SIZE - 1)))
+            psInsn += psInsn->ui8Size / 2;
+        else
+        {
+            psInsn = NULL;
+            bTranslate = (psMachine->psTranslator != NULL);
+
+            if(psMachine->psIdle && (psCpu->ui32PC < ui32Next) &&
+               (ui32Next - psCpu->ui32PC <= SIM_IDLE_MAX_BYTES))
+                SimIdleBranch(psMachine);
+        }
+
+        if(__builtin_expect(bProfile, 0))
+            SimProfileInsn(psMachine, ui32PC, ui32Next);
+
+        if(__builtin_expect(bShadow, 0))
+            SimShadowInsn(psMachine);
+
+        ui32PC = psCpu->ui32PC;
+    }
+}
+
+/*
+ * Lets an exception that became pending during the entry into ui32Exc, and
+ * preempts it, take over that entry: the frame stacked serves both, the
+ * handler of the late one runs first and ui32Exc goes back to pending, to
+ * tail-chain from it.  Returns the exception taking over, or zero.
+ */
+static uint32_t
+CpuLateArrival(tSimMachine *psMachine, uint32_t ui32Exc)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    uint32_t ui32Late, ui32Vector;
+    uint64_t ui64Pended = psNVIC->pui64Pended[ui32Exc];
+
+    /*
+     * Events of the cycles the entry took are seen now.
+     */
+    ThumbSync(psMachine);
+
+    ui32Late = SimNVICPendingException(psNVIC, CpuExecPriority(psMachine));
+
+    if(!ui32Late ||
+       !CpuBusRead(psMachine, psNVIC->ui32VTOR + ui32Late * 4, 4, &ui32Vector,
+                   false))
+        return(0);
+
+    SimNVICDeactivate(psNVIC, ui32Exc);
+    SimNVICSetPending(psNVIC, ui32Exc);
+    psNVIC->pui64Pended[ui32Exc] = ui64Pended;
+
+    SimNVICActivate(psNVIC, ui32Late);
+    psCpu->ui32IPSR = ui32Late;
+    psCpu->ui32PC = ui32Vector & ~1U;
+    psCpu->bThumb = ui32Vector & 1;
+    psCpu->ui32Exceptions++;
+
+    return(ui32Late);
+}
+
+/*
+ * Takes the highest priority pending exception if it preempts the current
+ * execution priority.  A sleeping processor also wakes up for interrupts
+ * masked by PRIMASK alone.  The timing model charges an exception return
+ * only here, once it is known whether the return tail-chains.  Without it
+ * an entry takes no time, so no exception can arrive late.
+ */
+static void
+CpuTakeException(tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    uint32_t ui32Exc, ui32Late;
+
+    ui32Exc = SimNVICPendingException(psNVIC, CpuExecPriority(psMachine));
+
+    if(ui32Exc)
+    {
+        CpuExceptionEntry(psMachine, ui32Exc);
+
+        if(psMachine->psTiming)
+        {
+            SimTimingEntry(psMachine, ui32Exc,
+                           !(psCpu->pui32R[14] & 0x10));
+
+            ui32Late = psCpu->bLockup ? 0 :
+                       CpuLateArrival(psMachine, ui32Exc);
+            SimTimingEntered(psMachine, ui32Late ? ui32Late : ui32Exc,
+                             ui32Late != 0);
+        }
+
+        return;
+    }
+
+    if(psMachine->psTiming)
+        SimTimingResume(psMachine);
+
+    if(psCpu->bSleeping &&
+       SimNVICPendingException(psNVIC,
+                               SimNVICExecPriority(psNVIC, false,
+                                                   psCpu->ui32BasePri,
+                                                   psCpu->bFaultmask)))
+        psCpu->bSleeping = false;
+}
+
+static tSimCpuStop
+CpuStopReason(tSimCpu *psCpu)
+{
+    if(psCpu->bLockup)
+        return(SIM_CPU_LOCKUP);
+
+    if(psCpu->bBreakpoint)
+    {
+        psCpu->bBreakpoint = false;
+        return(SIM_CPU_BREAKPOINT);
+    }
+
+    if(psCpu->bStop)
+    {
+        psCpu->bStop = false;
+        return(SIM_CPU_STOPPED);
+    }
+
+    return(SIM_CPU_DONE);
+}
+
+/*
+ * Runs the processor for up to ui64Cycles cycles.  Time is divided into
+ * slices that end at the next board event, so that interrupts are taken on
+ * the first instruction boundary after they become pending.
+ */
+tSimCpuStop
+SimCpuRun(tSimMachine *psMachine, uint64_t ui64Cycles)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimBoard *psBoard = &psMachine->sBoard;
+    uint64_t ui64Next, ui64Step, ui64Lag;
+    tSimCpuStop eStop;
+
+    psCpu->ui64End = psCpu->ui64Cycle + ui64Cycles;
+
+    /*
+     * Faults abandon the instruction and resume here.
+     */
+    setjmp(psCpu->sAbort);
+
+    while(psCpu->ui64Cycle < psCpu->ui64End)
+    {
+        ThumbSync(psMachine);
+
+        if(psBoard->ui32ResetRequest)
+        {
+            SimBoardReset(psBoard, psBoard->ui32ResetRequest);
+            SimCpuReset(psMachine);
+            psCpu->ui32Resets++;
+        }
+
+        if((eStop = CpuStopReason(psCpu)) != SIM_CPU_DONE)
+            return(eStop);
+
+        CpuTakeException(psMachine);
+
+        /*
+         * The timing model may have charged an exception entry or return
+         * above, moving the processor past the board and even past the end
+         * of the run.
+         */
+        if(psCpu->bLockup || (psCpu->ui64Cycle >= psCpu->ui64End))
+            continue;
+
+        ui64Next = SimBoardNextEvent(psBoard);
+        ui64Lag = psCpu->ui64Cycle - psBoard->ui64Cycle;
+
+        if(ui64Next <= ui64Lag)
+            ui64Next = 1;
+        else
+            ui64Next -= ui64Lag;
+
+        ui64Step = psCpu->ui64End - psCpu->ui64Cycle;
+
+        if(ui64Next < ui64Step)
+            ui64Step = ui64Next;
+
+        if(psCpu->bSleeping || psBoard->bHibernating)
+        {
+            psCpu->ui64Cycle += ui64Step;
+            psCpu->ui64SleepCycles += ui64Step;
+            continue;
+        }
+
+        if(!psCpu->bThumb)
+        {
+            psCpu->ui32InsnPC = psCpu->ui32PC;
+            SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_INVSTATE);
+        }
+
+        psCpu->ui64Limit = psCpu->ui64Cycle + ui64Step;
+        CpuExecute(psMachine);
+    }
+
+    ThumbSync(psMachine);
+
+    return(CpuStopReason(psCpu));
+}
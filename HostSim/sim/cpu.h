@@ -0,0 +1,241 @@
+#ifndef __SIM_CPU_H__
+#define __SIM_CPU_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
+
+#include "board.h"
+#include "memory.h"
+
+/*
+ * Cortex-M4F instruction set simulator running firmware images on the
+ * simulated board.
+ */
+typedef struct tSimMachine tSimMachine;
+typedef struct tSimInsn tSimInsn;
+typedef struct tSimTranslator tSimTranslator;
+typedef struct tSimIdle tSimIdle;
+typedef struct tSimTiming tSimTiming;
+typedef struct tSimSnapshot tSimSnapshot;
+typedef struct tSimDebug tSimDebug;
+typedef struct tSimProfile tSimProfile;
+typedef struct tSimShadow tSimShadow;
+typedef struct tSimTrace tSimTrace;
+
+typedef void (*tSimExec)(tSimMachine *psMachine, const tSimInsn *psInsn);
+
+/*
+ * A predecoded instruction.  The operand fields are interpreted by the
+ * execution function; PC relative addresses are resolved at decode time.
+ * An entry with a NULL pfnExec has not been decoded yet.
+ */
+struct tSimInsn
+{
+    tSimExec pfnExec;
+    uint32_t ui32Imm;
+    uint8_t ui8Rd;
+    uint8_t ui8Rn;
+    uint8_t ui8Rm;
+    uint8_t ui8Ra;
+    uint8_t ui8Shift;
+    uint8_t ui8S;
+    uint8_t ui8Size;
+    uint8_t ui8Op;
+    uint8_t ui8Cycles;
+};
+
+/*
+ * tSimInsn.ui8Cycles: the issue cycles of the instruction when no branch is
+ * taken, and what else its cycles depend on: a single load or store
+ * pipelines with the one before, a literal load from flash pays the wait
+ * states and a division adds cycles for the bits of its quotient.  Only the
+ * timing model looks at them (see timing.h).
+ */
+#define SIM_CPU_CYCLES_MASK     0x1F
+#define SIM_CPU_CYCLES_PIPE     0x20
+#define SIM_CPU_CYCLES_FLASH    0x40
+#define SIM_CPU_CYCLES_DIVIDE   0x80
+
+/*
+ * Register number that always reads as zero, used as the base register of
+ * accesses whose address is resolved at decode time.
+ */
+#define SIM_CPU_REG_ZERO        16
+
+/*
+ * Bits of xPSR and CONTROL.
+ */
+#define SIM_CPU_XPSR_N          0x80000000U
+#define SIM_CPU_XPSR_Z          0x40000000U
+#define SIM_CPU_XPSR_C          0x20000000U
+#define SIM_CPU_XPSR_V          0x10000000U
+#define SIM_CPU_XPSR_Q          0x08000000U
+#define SIM_CPU_XPSR_T          0x01000000U
+#define SIM_CPU_XPSR_ALIGN      0x00000200U
+
+#define SIM_CPU_CONTROL_NPRIV   0x00000001U
+#define SIM_CPU_CONTROL_SPSEL   0x00000002U
+#define SIM_CPU_CONTROL_FPCA    0x00000004U
+
+/*
+ * Reasons for SimCpuRun() to return.
+ */
+typedef enum
+{
+    SIM_CPU_DONE,
+    SIM_CPU_LOCKUP,
+    SIM_CPU_BREAKPOINT,
+    SIM_CPU_STOPPED
+} tSimCpuStop;
+
+typedef struct
+{
+    /*
+     * R0-R15 and the zero register.  R13 is the active stack pointer and R15
+     * reads as the address of the current instruction plus four.
+     */
+    uint32_t pui32R[17];
+
+    /*
+     * Address of the next and of the current instruction.
+     */
+    uint32_t ui32PC;
+    uint32_t ui32InsnPC;
+
+    /*
+     * APSR flags, one byte each.
+     */
+    uint8_t ui8N;
+    uint8_t ui8Z;
+    uint8_t ui8C;
+    uint8_t ui8V;
+    uint8_t ui8Q;
+    uint8_t ui8GE;
+
+    bool bThumb;
+    bool bHandler;
+    uint32_t ui32IPSR;
+    uint32_t ui32IT;
+
+    /*
+     * The stack pointer that is not currently in R13.
+     */
+    uint32_t ui32OtherSP;
+    uint32_t ui32Control;
+    bool bPrimask;
+    bool bFaultmask;
+    uint32_t ui32BasePri;
+
+    uint32_t pui32S[32];
+    uint32_t ui32FPSCR;
+
+    bool bExclusive;
+    uint32_t ui32ExclusiveAddr;
+    bool bEvent;
+    bool bSleeping;
+    bool bLockup;
+    bool bBreakpoint;
+    bool bStop;
+
+    /*
+     * Cycles executed since power on.  The board is brought up to date with
+     * ui64Cycle before every peripheral access; execution stops whenever
+     * ui64Cycle reaches ui64Limit, which is lowered to end a slice early.
+     * Everything from ui64Cycle on survives a reset.
+     */
+    uint64_t ui64Cycle;
+    uint64_t ui64Limit;
+    uint64_t ui64End;
+    uint64_t ui64Insns;
+    uint64_t ui64SleepCycles;
+    uint32_t ui32Exceptions;
+    uint32_t ui32Resets;
+
+    jmp_buf sAbort;
+} tSimCpu;
+
+/*
+ * A complete simulated microcontroller.  psCode caches the decoded
+ * instructions of the flash and SRAM arena, one entry per halfword.  Code is
+ * translated to host code when psTranslator is set (see translate.h), idle
+ * loops are skipped when psIdle is set (see idle.h) and instructions take
+ * the cycles of a real Cortex-M4 when psTiming is set (see timing.h).
+ * psSnapshot is the snapshot the machine was last taken as or restored
+ * from, which only the pages written since have to be copied back from
+ * (see snapshot.h).  psDebug holds the breakpoints and watchpoints of a
+ * debugger (see debug.h), psProfile counts where the instructions and
+ * cycles go when set (see profile.h), psShadow checks the accesses to SRAM
+ * and the stack when set (see shadow.h) and psTrace logs the accesses to
+ * the peripherals when set (see trace.h).
+ */
+struct tSimMachine
+{
+    tSimBoard sBoard;
+    tSimMemory sMemory;
+    tSimCpu sCpu;
+    tSimInsn *psCode;
+    tSimTranslator *psTranslator;
+    tSimIdle *psIdle;
+    tSimTiming *psTiming;
+    const tSimSnapshot *psSnapshot;
+    tSimDebug *psDebug;
+    tSimProfile *psProfile;
+    tSimShadow *psShadow;
+    tSimTrace *psTrace;
+};
+
+bool SimCpuInit(tSimMachine *psMachine, const tSimBoardHooks *psHooks);
+void SimCpuFree(tSimMachine *psMachine);
+void SimCpuReset(tSimMachine *psMachine);
+void SimCpuInvalidate(tSimMachine *psMachine);
+void SimCpuInvalidateRange(tSimMachine *psMachine, uint32_t ui32Addr,
+                           uint32_t ui32Size);
+tSimCpuStop SimCpuRun(tSimMachine *psMachine, uint64_t ui64Cycles);
+void SimCpuStop(tSimMachine *psMachine);
+
+uint32_t SimCpuXPSR(const tSimCpu *psCpu);
+bool SimCpuReadMemory(tSimMachine *psMachine, uint32_t ui32Addr,
+                      uint32_t ui32Size, uint32_t *pui32Value);
+bool SimCpuWriteMemory(tSimMachine *psMachine, uint32_t ui32Addr,
+                       uint32_t ui32Size, uint32_t ui32Value);
+
+/*
+ * Services used by the instruction execution functions and the translator.
+ */
+const tSimInsn *SimCpuInsn(tSimMachine *psMachine, uint32_t ui32PC);
+uint32_t SimCpuLoadSlow(tSimMachine *psMachine, uint32_t ui32Addr,
+                        uint32_t ui32Size);
+void SimCpuStoreSlow(tSimMachine *psMachine, uint32_t ui32Addr,
+                     uint32_t ui32Size, uint32_t ui32Value);
+void SimCpuFault(tSimMachine *psMachine, uint32_t ui32Exc,
+                 uint32_t ui32Status) __attribute__((noreturn));
+void SimCpuBranchExchange(tSimMachine *psMachine, uint32_t ui32Target);
+uint32_t SimCpuSpecialRead(tSimMachine *psMachine, uint32_t ui32SYSm);
+void SimCpuSpecialWrite(tSimMachine *psMachine, uint32_t ui32SYSm,
+                        uint32_t ui32Mask, uint32_t ui32Value);
+void SimCpuChangeMask(tSimMachine *psMachine, bool bFaultmask,
+                      bool bDisable);
+void SimCpuWait(tSimMachine *psMachine, bool bForEvent);
+void SimCpuSupervisorCall(tSimMachine *psMachine);
+void SimCpuBreakpoint(tSimMachine *psMachine);
+void SimCpuFPUsed(tSimMachine *psMachine);
+
+/*
+ * Fault status bits of CFSR.
+ */
+#define SIM_CFSR_IACCVIOL       0x00000001U
+#define SIM_CFSR_MSTKERR        0x00000010U
+#define SIM_CFSR_IBUSERR        0x00000100U
+#define SIM_CFSR_PRECISERR      0x00000200U
+#define SIM_CFSR_UNSTKERR       0x00000800U
+#define SIM_CFSR_STKERR         0x00001000U
+#define SIM_CFSR_BFARVALID      0x00008000U
+#define SIM_CFSR_UNDEFINSTR     0x00010000U
+#define SIM_CFSR_INVSTATE       0x00020000U
+#define SIM_CFSR_INVPC          0x00040000U
+#define SIM_CFSR_NOCP           0x00080000U
+#define SIM_CFSR_UNALIGNED      0x01000000U
+#define SIM_CFSR_DIVBYZERO      0x02000000U
+
+#endif
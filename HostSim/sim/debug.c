@@ -0,0 +1,275 @@
+/*
+ * Breakpoints and watchpoints of a debugger (see debug.h).
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "idle.h"
+#include "thumb.h"
+
+bool
+SimDebugInit(tSimMachine *psMachine)
+{
+    psMachine->psDebug = calloc(1, sizeof(tSimDebug));
+
+    return(psMachine->psDebug != NULL);
+}
+
+void
+SimDebugFree(tSimMachine *psMachine)
+{
+    free(psMachine->psDebug);
+    psMachine->psDebug = NULL;
+}
+
+/*
+ * Rebuilds the filter of breakpoint addresses.
+ */
+static void
+DebugFilter(tSimDebug *psDebug)
+{
+    uint32_t ui32Idx, ui32Bit;
+
+    memset(psDebug->pui8Filter, 0, sizeof(psDebug->pui8Filter));
+
+    for(ui32Idx = 0; ui32Idx < psDebug->ui32Breaks; ui32Idx++)
+    {
+        ui32Bit = (psDebug->pui32Break[ui32Idx] >> 1) &
+                  (SIM_DEBUG_FILTER_BITS - 1);
+        psDebug->pui8Filter[ui32Bit / 8] |= 1 << (ui32Bit & 7);
+    }
+}
+
+bool
+SimDebugBreakpointAt(const tSimDebug *psDebug, uint32_t ui32Addr)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < psDebug->ui32Breaks; ui32Idx++)
+        if(psDebug->pui32Break[ui32Idx] == ui32Addr)
+            return(true);
+
+    return(false);
+}
+
+/*
+ * Sets or removes the breakpoint at an instruction.  Returns false if the
+ * table is full or there is no such breakpoint.
+ */
+bool
+SimDebugBreakpoint(tSimMachine *psMachine, uint32_t ui32Addr, bool bSet)
+{
+    tSimDebug *psDebug = psMachine->psDebug;
+    uint32_t ui32Idx;
+
+    ui32Addr &= ~1U;
+
+    for(ui32Idx = 0; ui32Idx < psDebug->ui32Breaks; ui32Idx++)
+        if(psDebug->pui32Break[ui32Idx] == ui32Addr)
+            break;
+
+    if(bSet)
+    {
+        if(ui32Idx < psDebug->ui32Breaks)
+            return(true);
+
+        if(psDebug->ui32Breaks == SIM_DEBUG_BREAKPOINTS)
+            return(false);
+
+        psDebug->pui32Break[psDebug->ui32Breaks++] = ui32Addr;
+
+        /*
+         * Loops already found not to be idle may be again without it, and
+         * those found idle must not skip over it.
+         */
+        SimIdleFlush(psMachine);
+    }
+    else
+    {
+        if(ui32Idx == psDebug->ui32Breaks)
+            return(false);
+
+        psDebug->pui32Break[ui32Idx] =
+            psDebug->pui32Break[--psDebug->ui32Breaks];
+        SimIdleFlush(psMachine);
+    }
+
+    DebugFilter(psDebug);
+
+    return(true);
+}
+
+/*
+ * Moves the SRAM pages under a write watchpoint to the slow path of writes,
+ * or back once no other watchpoint covers them.
+ */
+static void
+DebugWatchPages(tSimMachine *psMachine, const tSimWatchpoint *psWatch,
+                bool bWatch)
+{
+    tSimDebug *psDebug = psMachine->psDebug;
+    uint32_t ui32Page, ui32Last, ui32Idx;
+    bool bWatched;
+
+    if(!(psWatch->eKind & SIM_DEBUG_WRITE))
+        return;
+
+    ui32Last = (psWatch->ui32Addr + psWatch->ui32Size - 1) &
+               ~(SIM_MEM_PAGE_SIZE - 1);
+
+    for(ui32Page = psWatch->ui32Addr & ~(SIM_MEM_PAGE_SIZE - 1);
+        ui32Page <= ui32Last; ui32Page += SIM_MEM_PAGE_SIZE)
+    {
+        bWatched = bWatch;
+
+        for(ui32Idx = 0; !bWatched && (ui32Idx < psDebug->ui32Watches);
+            ui32Idx++)
+            bWatched = (psDebug->psWatch[ui32Idx].eKind & SIM_DEBUG_WRITE) &&
+                       (ui32Page <= psDebug->psWatch[ui32Idx].ui32Addr +
+                                    psDebug->psWatch[ui32Idx].ui32Size - 1) &&
+                       (psDebug->psWatch[ui32Idx].ui32Addr <=
+                        ui32Page + SIM_MEM_PAGE_SIZE - 1);
+
+        SimMemoryWatch(&psMachine->sMemory, ui32Page, bWatched);
+    }
+}
+
+/*
+ * Sets or removes a watchpoint on ui32Size bytes from ui32Addr.  Returns
+ * false if the table is full, there is no such watchpoint or the bytes
+ * cannot be watched for reads.
+ */
+bool
+SimDebugWatchpoint(tSimMachine *psMachine, uint32_t ui32Addr,
+                   uint32_t ui32Size, tSimDebugKind eKind, bool bSet)
+{
+    tSimDebug *psDebug = psMachine->psDebug;
+    tSimWatchpoint sWatch;
+    uint32_t ui32Idx;
+
+    if(!ui32Size || (ui32Addr + ui32Size - 1 < ui32Addr))
+        return(false);
+
+    for(ui32Idx = 0; ui32Idx < psDebug->ui32Watches; ui32Idx++)
+        if((psDebug->psWatch[ui32Idx].ui32Addr == ui32Addr) &&
+           (psDebug->psWatch[ui32Idx].ui32Size == ui32Size) &&
+           (psDebug->psWatch[ui32Idx].eKind == eKind))
+            break;
+
+    if(!bSet)
+    {
+        if(ui32Idx == psDebug->ui32Watches)
+            return(false);
+
+        sWatch = psDebug->psWatch[ui32Idx];
+        psDebug->psWatch[ui32Idx] = psDebug->psWatch[--psDebug->ui32Watches];
+        DebugWatchPages(psMachine, &sWatch, false);
+
+        return(true);
+    }
+
+    if(ui32Idx < psDebug->ui32Watches)
+        return(true);
+
+    if((psDebug->ui32Watches == SIM_DEBUG_WATCHPOINTS) ||
+       ((eKind & SIM_DEBUG_READ) &&
+        SimMemoryOffset(psMachine->sMemory.pui32Read, ui32Addr)))
+        return(false);
+
+    sWatch.ui32Addr = ui32Addr;
+    sWatch.ui32Size = ui32Size;
+    sWatch.eKind = eKind;
+    psDebug->psWatch[psDebug->ui32Watches++] = sWatch;
+    DebugWatchPages(psMachine, &sWatch, true);
+
+    return(true);
+}
+
+/*
+ * Removes all breakpoints and watchpoints, as a debugger detaching does.
+ */
+void
+SimDebugClear(tSimMachine *psMachine)
+{
+    tSimDebug *psDebug = psMachine->psDebug;
+
+    while(psDebug->ui32Watches)
+        SimDebugWatchpoint(psMachine, psDebug->psWatch[0].ui32Addr,
+                           psDebug->psWatch[0].ui32Size,
+                           psDebug->psWatch[0].eKind, false);
+
+    psDebug->ui32Breaks = 0;
+    DebugFilter(psDebug);
+    SimIdleFlush(psMachine);
+}
+
+/*
+ * Called before the processor resumes: the instruction it resumes at runs
+ * even if it has a breakpoint, and the last stop is forgotten.
+ */
+void
+SimDebugResume(tSimMachine *psMachine)
+{
+    tSimDebug *psDebug = psMachine->psDebug;
+
+    psDebug->ui32SkipPC = psMachine->sCpu.ui32PC;
+    psDebug->ui64SkipInsns = psMachine->sCpu.ui64Insns;
+    psDebug->bWatchHit = false;
+}
+
+/*
+ * Stops the processor before the instruction at ui32PC if it has a
+ * breakpoint, unless it is the one a resume runs first.
+ */
+bool
+SimDebugStop(tSimMachine *psMachine, uint32_t ui32PC)
+{
+    tSimDebug *psDebug = psMachine->psDebug;
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    if(!SimDebugBreakpointAt(psDebug, ui32PC) ||
+       ((ui32PC == psDebug->ui32SkipPC) &&
+        (psCpu->ui64Insns == psDebug->ui64SkipInsns)))
+        return(false);
+
+    psCpu->ui32PC = ui32PC;
+    psCpu->bBreakpoint = true;
+    ThumbEndSlice(psMachine);
+
+    return(true);
+}
+
+/*
+ * Stops the processor after the current instruction if an access hits a
+ * watchpoint.
+ */
+void
+SimDebugWatched(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+                bool bWrite)
+{
+    tSimDebug *psDebug = psMachine->psDebug;
+    const tSimWatchpoint *psWatch;
+    tSimDebugKind eKind = bWrite ? SIM_DEBUG_WRITE : SIM_DEBUG_READ;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < psDebug->ui32Watches; ui32Idx++)
+    {
+        psWatch = &psDebug->psWatch[ui32Idx];
+
+        if(!(psWatch->eKind & eKind) ||
+           (ui32Addr > psWatch->ui32Addr + psWatch->ui32Size - 1) ||
+           (ui32Addr + ui32Size - 1 < psWatch->ui32Addr))
+            continue;
+
+        if(!psDebug->bWatchHit)
+        {
+            psDebug->bWatchHit = true;
+            psDebug->ui32HitAddr = psWatch->ui32Addr;
+            psDebug->eHitKind = psWatch->eKind;
+        }
+
+        SimCpuStop(psMachine);
+        return;
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef __SIM_DEBUG_H__
+#define __SIM_DEBUG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpu.h"
+
+/*
+ * Breakpoints and watchpoints set by a debugger (see gdb.h), at no cost to
+ * a machine without them.
+ *
+ * A breakpoint stops the processor before the instruction at its address
+ * runs, as the flash patch unit of the Cortex-M4 does, without changing the
+ * memory.  CpuExecute() asks about the address of every instruction only
+ * while breakpoints are set, and a filter of one bit per halfword address
+ * modulo SIM_DEBUG_FILTER_BITS answers most of those without looking at the
+ * table.  A resume from a breakpoint first runs the instruction under it,
+ * so the processor does not stop at once again.  Loops holding a breakpoint
+ * are not fast-forwarded (see idle.h).
+ *
+ * A watchpoint stops the processor after an instruction reads or writes
+ * bytes it covers, as the DWT comparators do.  Peripheral registers are
+ * always accessed through the slow path of the processor, where accesses
+ * are checked, and SRAM pages with a write watchpoint are moved to the slow
+ * path of writes while it is set.  Reads of flash and SRAM always take the
+ * fast path, so read and access watchpoints can only be set on peripheral
+ * registers.
+ *
+ * Accesses made by the debugger itself are not watched.
+ */
+#define SIM_DEBUG_BREAKPOINTS   32
+#define SIM_DEBUG_WATCHPOINTS   8
+#define SIM_DEBUG_FILTER_BITS   4096
+
+typedef enum
+{
+    SIM_DEBUG_WRITE = 1,
+    SIM_DEBUG_READ = 2,
+    SIM_DEBUG_ACCESS = 3
+} tSimDebugKind;
+
+typedef struct
+{
+    uint32_t ui32Addr;
+    uint32_t ui32Size;
+    tSimDebugKind eKind;
+} tSimWatchpoint;
+
+struct tSimDebug
+{
+    uint32_t pui32Break[SIM_DEBUG_BREAKPOINTS];
+    uint32_t ui32Breaks;
+    uint8_t pui8Filter[SIM_DEBUG_FILTER_BITS / 8];
+
+    tSimWatchpoint psWatch[SIM_DEBUG_WATCHPOINTS];
+    uint32_t ui32Watches;
+
+    /*
+     * The instruction run by a resume without stopping at its breakpoint:
+     * the one at ui32SkipPC while ui64Insns instructions have been executed.
+     */
+    uint32_t ui32SkipPC;
+    uint64_t ui64SkipInsns;
+
+    /*
+     * The watchpoint that stopped the processor last, and the address and
+     * kind of the access that hit it.
+     */
+    bool bWatchHit;
+    uint32_t ui32HitAddr;
+    tSimDebugKind eHitKind;
+};
+
+bool SimDebugInit(tSimMachine *psMachine);
+void SimDebugFree(tSimMachine *psMachine);
+bool SimDebugBreakpoint(tSimMachine *psMachine, uint32_t ui32Addr,
+                        bool bSet);
+bool SimDebugWatchpoint(tSimMachine *psMachine, uint32_t ui32Addr,
+                        uint32_t ui32Size, tSimDebugKind eKind, bool bSet);
+void SimDebugClear(tSimMachine *psMachine);
+void SimDebugResume(tSimMachine *psMachine);
+bool SimDebugBreakpointAt(const tSimDebug *psDebug, uint32_t ui32Addr);
+bool SimDebugStop(tSimMachine *psMachine, uint32_t ui32PC);
+void SimDebugWatched(tSimMachine *psMachine, uint32_t ui32Addr,
+                     uint32_t ui32Size, bool bWrite);
+
+/*
+ * Called by CpuExecute() before the instruction at ui32PC runs, while
+ * breakpoints are set.  Returns true if the processor stops there.
+ */
+static inline bool
+SimDebugBreak(tSimMachine *psMachine, uint32_t ui32PC)
+{
+    uint32_t ui32Bit = (ui32PC >> 1) & (SIM_DEBUG_FILTER_BITS - 1);
+
+    if(!((psMachine->psDebug->pui8Filter[ui32Bit / 8] >> (ui32Bit & 7)) & 1))
+        return(false);
+
+    return(SimDebugStop(psMachine, ui32PC));
+}
+
+/*
+ * Called by the slow paths of the processor's accesses.
+ */
+static inline void
+SimDebugAccess(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+               bool bWrite)
+{
+    if(psMachine->psDebug && psMachine->psDebug->ui32Watches)
+        SimDebugWatched(psMachine, ui32Addr, ui32Size, bWrite);
+}
+
+#endif
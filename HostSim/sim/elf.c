@@ -0,0 +1,401 @@
+/*
+ * Loading of 32-bit little-endian ARM ELF images.
+ */
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "elf.h"
+
+static bool
+ElfError(tSimElf *psElf, const char *pcError)
+{
+    psElf->pcError = pcError;
+
+    return(false);
+}
+
+/*
+ * Returns the part of the file at ui32Offset, or NULL if it does not hold
+ * ui32Size bytes.
+ */
+static const void *
+ElfData(const tSimElf *psElf, uint32_t ui32Offset, uint32_t ui32Size)
+{
+    if((ui32Offset > psElf->szImage) ||
+       (ui32Size > psElf->szImage - ui32Offset))
+        return(NULL);
+
+    return(psElf->pui8Image + ui32Offset);
+}
+
+static const Elf32_Shdr *
+ElfSectionHeader(const tSimElf *psElf, uint32_t ui32Index)
+{
+    const Elf32_Ehdr *psHeader = (const Elf32_Ehdr *)psElf->pui8Image;
+
+    if((ui32Index >= psHeader->e_shnum) ||
+       (psHeader->e_shentsize != sizeof(Elf32_Shdr)))
+        return(NULL);
+
+    return(ElfData(psElf, psHeader->e_shoff + ui32Index * sizeof(Elf32_Shdr),
+                   sizeof(Elf32_Shdr)));
+}
+
+static const char *
+ElfString(const tSimElf *psElf, const Elf32_Shdr *psStrings,
+          uint32_t ui32Offset)
+{
+    const char *pcStrings;
+
+    if(!psStrings || (ui32Offset >= psStrings->sh_size))
+        return(NULL);
+
+    pcStrings = ElfData(psElf, psStrings->sh_offset, psStrings->sh_size);
+
+    if(!pcStrings || !memchr(pcStrings + ui32Offset, 0,
+                             psStrings->sh_size - ui32Offset))
+        return(NULL);
+
+    return(pcStrings + ui32Offset);
+}
+
+static int
+ElfSymbolCompare(const void *pvA, const void *pvB)
+{
+    const tSimElfSymbol *psA = pvA, *psB = pvB;
+
+    if(psA->ui32Value != psB->ui32Value)
+        return((psA->ui32Value < psB->ui32Value) ? -1 : 1);
+
+    /*
+     * Functions before other symbols at the same address.
+     */
+    return((int)psB->bFunction - (int)psA->bFunction);
+}
+
+static bool
+ElfReadSymbols(tSimElf *psElf)
+{
+    const Elf32_Ehdr *psHeader = (const Elf32_Ehdr *)psElf->pui8Image;
+    const Elf32_Shdr *psSection, *psStrings;
+    const Elf32_Sym *psSym;
+    const char *pcName;
+    uint32_t ui32Section, ui32Count, ui32Idx;
+
+    for(ui32Section = 0; ui32Section < psHeader->e_shnum; ui32Section++)
+    {
+        psSection = ElfSectionHeader(psElf, ui32Section);
+
+        if(psSection && (psSection->sh_type == SHT_SYMTAB))
+            break;
+    }
+
+    if(ui32Section == psHeader->e_shnum)
+        return(true);
+
+    psStrings = ElfSectionHeader(psElf, psSection->sh_link);
+    ui32Count = psSection->sh_size / sizeof(Elf32_Sym);
+    psSym = ElfData(psElf, psSection->sh_offset,
+                    ui32Count * sizeof(Elf32_Sym));
+
+    if(!psSym)
+        return(ElfError(psElf, "truncated symbol table"));
+
+    psElf->psSymbols = calloc(ui32Count ? ui32Count : 1,
+                              sizeof(tSimElfSymbol));
+
+    if(!psElf->psSymbols)
+        return(ElfError(psElf, "out of memory"));
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++, psSym++)
+    {
+        uint32_t ui32Type = ELF32_ST_TYPE(psSym->st_info);
+
+        if((psSym->st_shndx == SHN_UNDEF) ||
+           ((ui32Type != STT_FUNC) && (ui32Type != STT_OBJECT) &&
+            (ui32Type != STT_NOTYPE)))
+            continue;
+
+        pcName = ElfString(psElf, psStrings, psSym->st_name);
+
+        /*
+         * Skip the mapping symbols ($t, $d) that mark code and data.
+         */
+        if(!pcName || !*pcName || (*pcName == '$'))
+            continue;
+
+        psElf->psSymbols[psElf->ui32Symbols].pcName = pcName;
+        psElf->psSymbols[psElf->ui32Symbols].ui32Value =
+            (ui32Type == STT_FUNC) ? psSym->st_value & ~1U : psSym->st_value;
+        psElf->psSymbols[psElf->ui32Symbols].ui32Size = psSym->st_size;
+        psElf->psSymbols[psElf->ui32Symbols].bFunction =
+            (ui32Type == STT_FUNC);
+        psElf->ui32Symbols++;
+    }
+
+    qsort(psElf->psSymbols, psElf->ui32Symbols, sizeof(tSimElfSymbol),
+          ElfSymbolCompare);
+
+    return(true);
+}
+
+/*
+ * Reads and checks an image.  On failure psElf->pcError says why.
+ */
+bool
+SimElfOpen(tSimElf *psElf, const char *pcPath)
+{
+    const Elf32_Ehdr *psHeader;
+    FILE *psFile;
+    long lSize;
+
+    memset(psElf, 0, sizeof(*psElf));
+
+    psFile = fopen(pcPath, "rb");
+
+    if(!psFile)
+        return(ElfError(psElf, "cannot open file"));
+
+    if((fseek(psFile, 0, SEEK_END) != 0) || ((lSize = ftell(psFile)) < 0) ||
+       (fseek(psFile, 0, SEEK_SET) != 0))
+    {
+        fclose(psFile);
+        return(ElfError(psElf, "cannot read file"));
+    }
+
+    psElf->szImage = (size_t)lSize;
+    psElf->pui8Image = malloc(psElf->szImage ? psElf->szImage : 1);
+
+    if(!psElf->pui8Image ||
+       (fread(psElf->pui8Image, 1, psElf->szImage, psFile) != psElf->szImage))
+    {
+        fclose(psFile);
+        SimElfClose(psElf);
+        return(ElfError(psElf, "cannot read file"));
+    }
+
+    fclose(psFile);
+
+    psHeader = ElfData(psElf, 0, sizeof(Elf32_Ehdr));
+
+    if(!psHeader || memcmp(psHeader->e_ident, ELFMAG, SELFMAG) ||
+       (psHeader->e_ident[EI_CLASS] != ELFCLASS32) ||
+       (psHeader->e_ident[EI_DATA] != ELFDATA2LSB))
+    {
+        SimElfClose(psElf);
+        return(ElfError(psElf, "not a 32-bit little-endian ELF file"));
+    }
+
+    if((psHeader->e_machine != EM_ARM) || (psHeader->e_type != ET_EXEC))
+    {
+        SimElfClose(psElf);
+        return(ElfError(psElf, "not an ARM executable"));
+    }
+
+    psElf->ui32Entry = psHeader->e_entry;
+
+    if(!ElfReadSymbols(psElf))
+    {
+        const char *pcError = psElf->pcError;
+
+        SimElfClose(psElf);
+        return(ElfError(psElf, pcError));
+    }
+
+    return(true);
+}
+
+void
+SimElfClose(tSimElf *psElf)
+{
+    free(psElf->pui8Image);
+    free(psElf->psSymbols);
+    psElf->pui8Image = NULL;
+    psElf->psSymbols = NULL;
+    psElf->szImage = 0;
+    psElf->ui32Symbols = 0;
+}
+
+/*
+ * Programs the loadable segments at their physical (load) addresses, which
+ * places initialized data in flash as the startup code expects.  The rest of
+ * a segment's memory image is zeroed.
+ */
+bool
+SimElfLoad(tSimElf *psElf, tSimMemory *psMemory)
+{
+    const Elf32_Ehdr *psHeader = (const Elf32_Ehdr *)psElf->pui8Image;
+    const Elf32_Phdr *psSegment;
+    const uint8_t *pui8Data;
+    uint32_t ui32Idx, ui32Byte;
+    static const uint8_t ui8Zero;
+
+    if(psHeader->e_phentsize != sizeof(Elf32_Phdr))
+        return(ElfError(psElf, "bad program header size"));
+
+    for(ui32Idx = 0; ui32Idx < psHeader->e_phnum; ui32Idx++)
+    {
+        psSegment = ElfData(psElf,
+                            psHeader->e_phoff + ui32Idx * sizeof(Elf32_Phdr),
+                            sizeof(Elf32_Phdr));
+
+        if(!psSegment)
+            return(ElfError(psElf, "truncated program headers"));
+
+        if((psSegment->p_type != PT_LOAD) || !psSegment->p_memsz)
+            continue;
+
+        pui8Data = ElfData(psElf, psSegment->p_offset, psSegment->p_filesz);
+
+        if(!pui8Data || (psSegment->p_filesz > psSegment->p_memsz))
+            return(ElfError(psElf, "truncated segment"));
+
+        if(!SimMemoryLoad(psMemory, psSegment->p_paddr, pui8Data,
+                          psSegment->p_filesz))
+            return(ElfError(psElf, "segment outside flash and SRAM"));
+
+        for(ui32Byte = psSegment->p_filesz; ui32Byte < psSegment->p_memsz;
+            ui32Byte++)
+            if(!SimMemoryLoad(psMemory, psSegment->p_paddr + ui32Byte,
+                              &ui8Zero, 1))
+                return(ElfError(psElf, "segment outside flash and SRAM"));
+    }
+
+    return(true);
+}
+
+/*
+ * Returns the contents, address and size of a section, or NULL if there is
+ * no such section.  Sections without contents (.bss) return the image
+ * itself so the caller can still tell they exist.
+ */
+const void *
+SimElfSection(tSimElf *psElf, const char *pcName, uint32_t *pui32Addr,
+              uint32_t *pui32Size)
+{
+    const Elf32_Ehdr *psHeader = (const Elf32_Ehdr *)psElf->pui8Image;
+    const Elf32_Shdr *psSection, *psNames;
+    const char *pcSection;
+    uint32_t ui32Idx;
+
+    psNames = ElfSectionHeader(psElf, psHeader->e_shstrndx);
+
+    for(ui32Idx = 0; ui32Idx < psHeader->e_shnum; ui32Idx++)
+    {
+        psSection = ElfSectionHeader(psElf, ui32Idx);
+
+        if(!psSection)
+            break;
+
+        pcSection = ElfString(psElf, psNames, psSection->sh_name);
+
+        if(!pcSection || strcmp(pcSection, pcName))
+            continue;
+
+        if(pui32Addr)
+            *pui32Addr = psSection->sh_addr;
+
+        if(pui32Size)
+            *pui32Size = psSection->sh_size;
+
+        if(psSection->sh_type == SHT_NOBITS)
+            return(psElf->pui8Image);
+
+        return(ElfData(psElf, psSection->sh_offset, psSection->sh_size));
+    }
+
+    return(NULL);
+}
+
+/*
+ * Returns the contents of the image at an address, and in *pui32Size how many
+ * bytes of the section holding it follow, or NULL if no section with contents
+ * is loaded there.
+ */
+const void *
+SimElfData(const tSimElf *psElf, uint32_t ui32Addr, uint32_t *pui32Size)
+{
+    const Elf32_Ehdr *psHeader = (const Elf32_Ehdr *)psElf->pui8Image;
+    const Elf32_Shdr *psSection;
+    const uint8_t *pui8Data;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < psHeader->e_shnum; ui32Idx++)
+    {
+        psSection = ElfSectionHeader(psElf, ui32Idx);
+
+        if(!psSection)
+            break;
+
+        if(!(psSection->sh_flags & SHF_ALLOC) ||
+           (psSection->sh_type == SHT_NOBITS) ||
+           (ui32Addr < psSection->sh_addr) ||
+           (ui32Addr - psSection->sh_addr >= psSection->sh_size))
+            continue;
+
+        pui8Data = ElfData(psElf, psSection->sh_offset, psSection->sh_size);
+
+        if(!pui8Data)
+            return(NULL);
+
+        *pui32Size = psSection->sh_size - (ui32Addr - psSection->sh_addr);
+
+        return(pui8Data + (ui32Addr - psSection->sh_addr));
+    }
+
+    return(NULL);
+}
+
+const tSimElfSymbol *
+SimElfSymbol(const tSimElf *psElf, const char *pcName)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < psElf->ui32Symbols; ui32Idx++)
+        if(!strcmp(psElf->psSymbols[ui32Idx].pcName, pcName))
+            return(&psElf->psSymbols[ui32Idx]);
+
+    return(NULL);
+}
+
+/*
+ * Returns the function containing ui32Addr, or NULL.
+ */
+const tSimElfSymbol *
+SimElfSymbolAt(const tSimElf *psElf, uint32_t ui32Addr)
+{
+    const tSimElfSymbol *psBest = NULL;
+    uint32_t ui32Lo = 0, ui32Hi = psElf->ui32Symbols, ui32Mid;
+
+    /*
+     * Find the last symbol at or below the address, then walk back to the
+     * function it belongs to.
+     */
+    while(ui32Lo < ui32Hi)
+    {
+        ui32Mid = (ui32Lo + ui32Hi) / 2;
+
+        if(psElf->psSymbols[ui32Mid].ui32Value <= ui32Addr)
+            ui32Lo = ui32Mid + 1;
+        else
+            ui32Hi = ui32Mid;
+    }
+
+    while(ui32Lo--)
+    {
+        psBest = &psElf->psSymbols[ui32Lo];
+
+        if(psBest->bFunction)
+            break;
+
+        psBest = NULL;
+    }
+
+    if(!psBest || (psBest->ui32Size &&
+                   (ui32Addr >= psBest->ui32Value + psBest->ui32Size)))
+        return(NULL);
+
+    return(psBest);
+}
@@ -0,0 +1,49 @@
+#ifndef __SIM_ELF_H__
+#define __SIM_ELF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "memory.h"
+
+/*
+ * Firmware images in the ELF format produced by the GNU and CCS toolchains.
+ */
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32Value;
+    uint32_t ui32Size;
+    bool bFunction;
+} tSimElfSymbol;
+
+typedef struct
+{
+    uint8_t *pui8Image;
+    size_t szImage;
+    uint32_t ui32Entry;
+
+    /*
+     * Symbols sorted by address.
+     */
+    tSimElfSymbol *psSymbols;
+    uint32_t ui32Symbols;
+
+    /*
+     * Description of the last error.
+     */
+    const char *pcError;
+} tSimElf;
+
+bool SimElfOpen(tSimElf *psElf, const char *pcPath);
+void SimElfClose(tSimElf *psElf);
+bool SimElfLoad(tSimElf *psElf, tSimMemory *psMemory);
+const void *SimElfSection(tSimElf *psElf, const char *pcName,
+                          uint32_t *pui32Addr, uint32_t *pui32Size);
+const void *SimElfData(const tSimElf *psElf, uint32_t ui32Addr,
+                       uint32_t *pui32Size);
+const tSimElfSymbol *SimElfSymbol(const tSimElf *psElf, const char *pcName);
+const tSimElfSymbol *SimElfSymbolAt(const tSimElf *psElf, uint32_t ui32Addr);
+
+#endif
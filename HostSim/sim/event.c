@@ -0,0 +1,128 @@
+/*
+ * Deadline ordered event queue.
+ */
+#include <string.h>
+
+#include "event.h"
+
+static bool
+EventBefore(const tSimEventQueue *psQueue, uint32_t ui32A, uint32_t ui32B)
+{
+    if(psQueue->pui64Time[ui32A] != psQueue->pui64Time[ui32B])
+        return(psQueue->pui64Time[ui32A] < psQueue->pui64Time[ui32B]);
+
+    return(ui32A < ui32B);
+}
+
+static void
+EventPlace(tSimEventQueue *psQueue, uint32_t ui32Slot, uint32_t ui32Event)
+{
+    psQueue->pui8Heap[ui32Slot] = (uint8_t)ui32Event;
+    psQueue->pui8Slot[ui32Event] = (uint8_t)ui32Slot;
+}
+
+static void
+EventSiftUp(tSimEventQueue *psQueue, uint32_t ui32Slot)
+{
+    uint32_t ui32Event = psQueue->pui8Heap[ui32Slot];
+
+    while(ui32Slot > 0)
+    {
+        uint32_t ui32Parent = (ui32Slot - 1) / 2;
+
+        if(!EventBefore(psQueue, ui32Event, psQueue->pui8Heap[ui32Parent]))
+            break;
+
+        EventPlace(psQueue, ui32Slot, psQueue->pui8Heap[ui32Parent]);
+        ui32Slot = ui32Parent;
+    }
+
+    EventPlace(psQueue, ui32Slot, ui32Event);
+}
+
+static void
+EventSiftDown(tSimEventQueue *psQueue, uint32_t ui32Slot)
+{
+    uint32_t ui32Event = psQueue->pui8Heap[ui32Slot];
+
+    for(;;)
+    {
+        uint32_t ui32Child = ui32Slot * 2 + 1;
+
+        if(ui32Child >= psQueue->ui32Count)
+            break;
+
+        if((ui32Child + 1 < psQueue->ui32Count) &&
+           EventBefore(psQueue, psQueue->pui8Heap[ui32Child + 1],
+                       psQueue->pui8Heap[ui32Child]))
+            ui32Child++;
+
+        if(!EventBefore(psQueue, psQueue->pui8Heap[ui32Child], ui32Event))
+            break;
+
+        EventPlace(psQueue, ui32Slot, psQueue->pui8Heap[ui32Child]);
+        ui32Slot = ui32Child;
+    }
+
+    EventPlace(psQueue, ui32Slot, ui32Event);
+}
+
+void
+SimEventQueueInit(tSimEventQueue *psQueue)
+{
+    memset(psQueue, 0, sizeof(*psQueue));
+    memset(psQueue->pui8Slot, SIM_EVENT_NONE, sizeof(psQueue->pui8Slot));
+}
+
+void
+SimEventSchedule(tSimEventQueue *psQueue, uint32_t ui32Event,
+                 uint64_t ui64Time)
+{
+    uint32_t ui32Slot = psQueue->pui8Slot[ui32Event];
+
+    psQueue->pui64Time[ui32Event] = ui64Time;
+
+    /*
+     * A pending event is simply moved to its new position.
+     */
+    if(ui32Slot != SIM_EVENT_NONE)
+    {
+        EventSiftUp(psQueue, ui32Slot);
+        EventSiftDown(psQueue, psQueue->pui8Slot[ui32Event]);
+        return;
+    }
+
+    EventPlace(psQueue, psQueue->ui32Count, ui32Event);
+    EventSiftUp(psQueue, psQueue->ui32Count++);
+}
+
+void
+SimEventCancel(tSimEventQueue *psQueue, uint32_t ui32Event)
+{
+    uint32_t ui32Slot = psQueue->pui8Slot[ui32Event];
+    uint32_t ui32Last;
+
+    if(ui32Slot == SIM_EVENT_NONE)
+        return;
+
+    psQueue->pui8Slot[ui32Event] = SIM_EVENT_NONE;
+    ui32Last = psQueue->pui8Heap[--psQueue->ui32Count];
+
+    if(ui32Slot == psQueue->ui32Count)
+        return;
+
+    EventPlace(psQueue, ui32Slot, ui32Last);
+    EventSiftUp(psQueue, ui32Slot);
+    EventSiftDown(psQueue, psQueue->pui8Slot[ui32Last]);
+}
+
+uint32_t
+SimEventPop(tSimEventQueue *psQueue)
+{
+    uint32_t ui32Event = SimEventFirst(psQueue);
+
+    if(ui32Event != SIM_EVENT_NONE)
+        SimEventCancel(psQueue, ui32Event);
+
+    return(ui32Event);
+}
@@ -0,0 +1,76 @@
+#ifndef __SIM_EVENT_H__
+#define __SIM_EVENT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Every time based activity of the simulated board is identified by a fixed
+ * event number.  The board keeps one pending deadline per event, so the queue
+ * holds no pointers and a board can be copied with a plain memcpy().
+ */
+typedef enum
+{
+    SIM_EVENT_SYSTICK,
+
+    /*
+     * Half h (0 for A, 1 for B) of timer n is SIM_EVENT_TIMER0A + 2 * n + h.
+     */
+    SIM_EVENT_TIMER0A,
+
+    /*
+     * Sample sequencer s of ADC m is SIM_EVENT_ADC0SS0 + 4 * m + s.
+     */
+    SIM_EVENT_ADC0SS0 = SIM_EVENT_TIMER0A + 12,
+
+    /*
+     * End of the frame being transmitted, receive timeout and next poll of
+     * the receive line of UART n.
+     */
+    SIM_EVENT_UART0TX = SIM_EVENT_ADC0SS0 + 8,
+    SIM_EVENT_UART0RT = SIM_EVENT_UART0TX + 8,
+    SIM_EVENT_UART0RX = SIM_EVENT_UART0RT + 8,
+
+    SIM_EVENT_HIB = SIM_EVENT_UART0RX + 8,
+
+    /*
+     * Next character received from a recording (see replay.h).
+     */
+    SIM_EVENT_REPLAY,
+    SIM_EVENT_COUNT
+} tSimEventId;
+
+#define SIM_EVENT_NONE      0xFFU
+
+/*
+ * Binary min-heap of event numbers ordered by deadline (in picoseconds of
+ * simulated time).  Events sharing a deadline fire in event number order so
+ * that runs are reproducible.
+ */
+typedef struct
+{
+    uint64_t pui64Time[SIM_EVENT_COUNT];
+    uint8_t pui8Heap[SIM_EVENT_COUNT];
+    uint8_t pui8Slot[SIM_EVENT_COUNT];
+    uint32_t ui32Count;
+} tSimEventQueue;
+
+void SimEventQueueInit(tSimEventQueue *psQueue);
+void SimEventSchedule(tSimEventQueue *psQueue, uint32_t ui32Event,
+                      uint64_t ui64Time);
+void SimEventCancel(tSimEventQueue *psQueue, uint32_t ui32Event);
+uint32_t SimEventPop(tSimEventQueue *psQueue);
+
+static inline bool
+SimEventPending(const tSimEventQueue *psQueue, uint32_t ui32Event)
+{
+    return(psQueue->pui8Slot[ui32Event] != SIM_EVENT_NONE);
+}
+
+static inline uint32_t
+SimEventFirst(const tSimEventQueue *psQueue)
+{
+    return(psQueue->ui32Count ? psQueue->pui8Heap[0] : SIM_EVENT_NONE);
+}
+
+#endif
@@ -0,0 +1,1007 @@
+/*
+ * GDB remote serial protocol stub (see gdb.h).
+ */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "debug.h"
+#include "gdb.h"
+
+/*
+ * Signals of stops, as numbered by gdb.
+ */
+#define GDB_SIGINT              2
+#define GDB_SIGTRAP             5
+#define GDB_SIGSEGV             11
+
+/*
+ * Registers: R0-R15, xPSR, then the special registers with their SYSm
+ * numbers for MRS and MSR.
+ */
+#define GDB_REG_PC              15
+#define GDB_REG_XPSR            16
+#define GDB_REGS                23
+
+static const uint8_t g_pui8SYSm[GDB_REGS - GDB_REG_XPSR - 1] =
+{
+    8, 9, 16, 17, 19, 20
+};
+
+/*
+ * Longest a sleeping processor is run at once by a single step before the
+ * connection is looked at again.
+ */
+#define GDB_STEP_CYCLES         1000000
+
+static const char g_pcTargetXML[] =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\">"
+    "<architecture>arm</architecture>"
+    "<feature name=\"org.gnu.gdb.arm.m-profile\">"
+    "<reg name=\"r0\" bitsize=\"32\"/>"
+    "<reg name=\"r1\" bitsize=\"32\"/>"
+    "<reg name=\"r2\" bitsize=\"32\"/>"
+    "<reg name=\"r3\" bitsize=\"32\"/>"
+    "<reg name=\"r4\" bitsize=\"32\"/>"
+    "<reg name=\"r5\" bitsize=\"32\"/>"
+    "<reg name=\"r6\" bitsize=\"32\"/>"
+    "<reg name=\"r7\" bitsize=\"32\"/>"
+    "<reg name=\"r8\" bitsize=\"32\"/>"
+    "<reg name=\"r9\" bitsize=\"32\"/>"
+    "<reg name=\"r10\" bitsize=\"32\"/>"
+    "<reg name=\"r11\" bitsize=\"32\"/>"
+    "<reg name=\"r12\" bitsize=\"32\"/>"
+    "<reg name=\"sp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "<reg name=\"lr\" bitsize=\"32\"/>"
+    "<reg name=\"pc\" bitsize=\"32\" type=\"code_ptr\"/>"
+    "<reg name=\"xpsr\" bitsize=\"32\"/>"
+    "</feature>"
+    "<feature name=\"org.gnu.gdb.arm.m-system\">"
+    "<reg name=\"msp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "<reg name=\"psp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "</feature>"
+    "<feature name=\"org.tm4c.sim.m-masks\">"
+    "<reg name=\"primask\" bitsize=\"32\" group=\"system\"/>"
+    "<reg name=\"basepri\" bitsize=\"32\" group=\"system\"/>"
+    "<reg name=\"faultmask\" bitsize=\"32\" group=\"system\"/>"
+    "<reg name=\"control\" bitsize=\"32\" group=\"system\"/>"
+    "</feature>"
+    "</target>";
+
+typedef enum
+{
+    GDB_SERVE,
+    GDB_RESUME,
+    GDB_KILL
+} tGdbAction;
+
+/*
+ * Opens the port gdb connects to on the loopback interface.  Returns NULL
+ * if it cannot be opened.
+ */
+tSimGdb *
+SimGdbOpen(uint16_t ui16Port)
+{
+    struct sockaddr_in sAddr;
+    tSimGdb *psGdb;
+    int i32One = 1;
+
+    psGdb = calloc(1, sizeof(tSimGdb));
+
+    if(!psGdb)
+        return(NULL);
+
+    psGdb->i32Socket = -1;
+    psGdb->i32Listen = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    memset(&sAddr, 0, sizeof(sAddr));
+    sAddr.sin_family = AF_INET;
+    sAddr.sin_port = htons(ui16Port);
+    sAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if((psGdb->i32Listen < 0) ||
+       setsockopt(psGdb->i32Listen, SOL_SOCKET, SO_REUSEADDR, &i32One,
+                  sizeof(i32One)) ||
+       bind(psGdb->i32Listen, (struct sockaddr *)&sAddr, sizeof(sAddr)) ||
+       listen(psGdb->i32Listen, 1))
+    {
+        SimGdbClose(psGdb, 0);
+        return(NULL);
+    }
+
+    return(psGdb);
+}
+
+/*
+ * Waits for gdb to connect.  The processor stays stopped until it resumes
+ * it.
+ */
+bool
+SimGdbAccept(tSimGdb *psGdb)
+{
+    int i32One = 1;
+
+    do
+    {
+        psGdb->i32Socket = accept4(psGdb->i32Listen, NULL, NULL,
+                                   SOCK_CLOEXEC);
+    }
+    while((psGdb->i32Socket < 0) && (errno == EINTR));
+
+    if(psGdb->i32Socket < 0)
+        return(false);
+
+    setsockopt(psGdb->i32Socket, IPPROTO_TCP, TCP_NODELAY, &i32One,
+               sizeof(i32One));
+
+    close(psGdb->i32Listen);
+    psGdb->i32Listen = -1;
+
+    psGdb->bStopped = true;
+    psGdb->ui8Signal = GDB_SIGTRAP;
+
+    return(true);
+}
+
+/*
+ * Forgets a debugger that detached or went away.  The firmware goes on
+ * without its breakpoints and watchpoints.
+ */
+static void
+GdbDetach(tSimGdb *psGdb, tSimMachine *psMachine)
+{
+    if(psGdb->i32Socket >= 0)
+        close(psGdb->i32Socket);
+
+    psGdb->i32Socket = -1;
+    psGdb->bDetached = true;
+    psGdb->bStopped = false;
+    SimDebugClear(psMachine);
+}
+
+/*
+ * Returns the next byte from the debugger, waiting for it, or -1 if the
+ * connection is closed.
+ */
+static int32_t
+GdbByte(tSimGdb *psGdb)
+{
+    ssize_t sszRead;
+
+    if(psGdb->ui32InPos == psGdb->ui32InLen)
+    {
+        do
+        {
+            sszRead = recv(psGdb->i32Socket, psGdb->pui8In,
+                           sizeof(psGdb->pui8In), 0);
+        }
+        while((sszRead < 0) && (errno == EINTR));
+
+        if(sszRead <= 0)
+            return(-1);
+
+        psGdb->ui32InPos = 0;
+        psGdb->ui32InLen = (uint32_t)sszRead;
+    }
+
+    return(psGdb->pui8In[psGdb->ui32InPos++]);
+}
+
+static bool
+GdbWrite(tSimGdb *psGdb, const char *pcData, size_t szLength)
+{
+    ssize_t sszWritten;
+
+    while(szLength)
+    {
+        sszWritten = send(psGdb->i32Socket, pcData, szLength, MSG_NOSIGNAL);
+
+        if((sszWritten < 0) && (errno == EINTR))
+            continue;
+
+        if(sszWritten <= 0)
+            return(false);
+
+        pcData += sszWritten;
+        szLength -= (size_t)sszWritten;
+    }
+
+    return(true);
+}
+
+static int32_t
+GdbHexDigit(int32_t i32Char)
+{
+    if((i32Char >= '0') && (i32Char <= '9'))
+        return(i32Char - '0');
+
+    if((i32Char >= 'a') && (i32Char <= 'f'))
+        return(i32Char - 'a' + 10);
+
+    if((i32Char >= 'A') && (i32Char <= 'F'))
+        return(i32Char - 'A' + 10);
+
+    return(-1);
+}
+
+/*
+ * Parses a hexadecimal number, leaving *ppcText at the first character
+ * after it.
+ */
+static uint32_t
+GdbHex(const char **ppcText)
+{
+    uint32_t ui32Value = 0;
+    int32_t i32Digit;
+
+    while((i32Digit = GdbHexDigit(**ppcText)) >= 0)
+    {
+        ui32Value = (ui32Value << 4) | (uint32_t)i32Digit;
+        (*ppcText)++;
+    }
+
+    return(ui32Value);
+}
+
+/*
+ * Appends ui32Count bytes of a little-endian value to a reply in hex.
+ */
+static char *
+GdbPutHex(char *pcReply, uint32_t ui32Value, uint32_t ui32Count)
+{
+    static const char pcDigits[] = "0123456789abcdef";
+
+    while(ui32Count--)
+    {
+        *pcReply++ = pcDigits[(ui32Value >> 4) & 0xF];
+        *pcReply++ = pcDigits[ui32Value & 0xF];
+        ui32Value >>= 8;
+    }
+
+    *pcReply = '\0';
+
+    return(pcReply);
+}
+
+/*
+ * Parses a little-endian register value of four bytes in hex.
+ */
+static uint32_t
+GdbGetHex(const char **ppcText)
+{
+    uint32_t ui32Value = 0, ui32Byte;
+    int32_t i32High, i32Low;
+
+    for(ui32Byte = 0; ui32Byte < 4; ui32Byte++)
+    {
+        i32High = GdbHexDigit((*ppcText)[0]);
+        i32Low = (i32High >= 0) ? GdbHexDigit((*ppcText)[1]) : -1;
+
+        if(i32Low < 0)
+            break;
+
+        ui32Value |= (uint32_t)((i32High << 4) | i32Low) << (ui32Byte * 8);
+        *ppcText += 2;
+    }
+
+    return(ui32Value);
+}
+
+/*
+ * Sends a packet, with its checksum.
+ */
+static void
+GdbSend(tSimGdb *psGdb, const char *pcData)
+{
+    char pcTrailer[4];
+    uint8_t ui8Sum = 0;
+    const char *pcChar;
+
+    for(pcChar = pcData; *pcChar; pcChar++)
+        ui8Sum += (uint8_t)*pcChar;
+
+    snprintf(pcTrailer, sizeof(pcTrailer), "#%02x", ui8Sum);
+
+    if(GdbWrite(psGdb, "$", 1))
+        if(GdbWrite(psGdb, pcData, strlen(pcData)))
+            GdbWrite(psGdb, pcTrailer, 3);
+}
+
+/*
+ * Waits for the next packet from the debugger into pcPacket.  Returns false
+ * if the connection is closed.
+ */
+static bool
+GdbReceive(tSimGdb *psGdb)
+{
+    int32_t i32Char, i32High, i32Low;
+    uint32_t ui32Length;
+    uint8_t ui8Sum;
+
+    for(;;)
+    {
+        /*
+         * Acknowledgements and interrupts of a processor already stopped
+         * are passed over.
+         */
+        do
+        {
+            if((i32Char = GdbByte(psGdb)) < 0)
+                return(false);
+        }
+        while(i32Char != '$');
+
+        ui32Length = 0;
+        ui8Sum = 0;
+
+        while((i32Char = GdbByte(psGdb)) != '#')
+        {
+            if(i32Char < 0)
+                return(false);
+
+            if(ui32Length < SIM_GDB_PACKET_SIZE)
+                psGdb->pcPacket[ui32Length++] = (char)i32Char;
+
+            ui8Sum += (uint8_t)i32Char;
+        }
+
+        psGdb->pcPacket[ui32Length] = '\0';
+        psGdb->ui32PacketLength = ui32Length;
+
+        if(((i32High = GdbByte(psGdb)) < 0) || ((i32Low = GdbByte(psGdb)) < 0))
+            return(false);
+
+        if(psGdb->bNoAck)
+            return(true);
+
+        if((GdbHexDigit(i32High) << 4 | GdbHexDigit(i32Low)) == ui8Sum)
+        {
+            GdbWrite(psGdb, "+", 1);
+            return(true);
+        }
+
+        GdbWrite(psGdb, "-", 1);
+    }
+}
+
+/*
+ * Looks at the connection while the processor runs.  Returns true if the
+ * debugger wants it interrupted.
+ */
+static bool
+GdbInterrupted(tSimGdb *psGdb, tSimMachine *psMachine)
+{
+    struct pollfd sPoll;
+    struct timespec sNow;
+    uint64_t ui64Now;
+    ssize_t sszRead, sszByte;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    ui64Now = (uint64_t)sNow.tv_sec * 1000000000 + (uint64_t)sNow.tv_nsec;
+
+    if(ui64Now - psGdb->ui64Polled < SIM_GDB_POLL_MS * 1000000ULL)
+        return(false);
+
+    psGdb->ui64Polled = ui64Now;
+    sPoll.fd = psGdb->i32Socket;
+    sPoll.events = POLLIN;
+
+    if(poll(&sPoll, 1, 0) <= 0)
+        return(false);
+
+    sszRead = recv(psGdb->i32Socket, psGdb->pui8In, sizeof(psGdb->pui8In),
+                   MSG_DONTWAIT);
+
+    if(sszRead == 0)
+    {
+        GdbDetach(psGdb, psMachine);
+        return(false);
+    }
+
+    for(sszByte = 0; sszByte < sszRead; sszByte++)
+        if(psGdb->pui8In[sszByte] == 0x03)
+            return(true);
+
+    return(false);
+}
+
+static uint32_t
+GdbRegister(tSimMachine *psMachine, uint32_t ui32Reg)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    if(ui32Reg < GDB_REG_PC)
+        return(psCpu->pui32R[ui32Reg]);
+
+    if(ui32Reg == GDB_REG_PC)
+        return(psCpu->ui32PC);
+
+    if(ui32Reg == GDB_REG_XPSR)
+        return(SimCpuXPSR(psCpu));
+
+    return(SimCpuSpecialRead(psMachine,
+                             g_pui8SYSm[ui32Reg - GDB_REG_XPSR - 1]));
+}
+
+/*
+ * Writes a register.  Of xPSR only the flags can be written.
+ */
+static void
+GdbSetRegister(tSimMachine *psMachine, uint32_t ui32Reg, uint32_t ui32Value)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    if(ui32Reg < GDB_REG_PC)
+        psCpu->pui32R[ui32Reg] = ui32Value;
+    else if(ui32Reg == GDB_REG_PC)
+        psCpu->ui32PC = ui32Value & ~1U;
+    else if(ui32Reg == GDB_REG_XPSR)
+        SimCpuSpecialWrite(psMachine, 0, 3, ui32Value);
+    else
+        SimCpuSpecialWrite(psMachine, g_pui8SYSm[ui32Reg - GDB_REG_XPSR - 1],
+                           0, ui32Value);
+}
+
+/*
+ * Reads memory into a reply in hex, in words where they are aligned so that
+ * peripheral registers are read whole.
+ */
+static void
+GdbReadMemory(tSimGdb *psGdb, tSimMachine *psMachine, uint32_t ui32Addr,
+              uint32_t ui32Length)
+{
+    char *pcReply = psGdb->pcReply;
+    uint32_t ui32Size, ui32Value;
+
+    if(ui32Length > SIM_GDB_PACKET_SIZE / 2)
+        ui32Length = SIM_GDB_PACKET_SIZE / 2;
+
+    while(ui32Length)
+    {
+        ui32Size = (!(ui32Addr & 3) && (ui32Length >= 4)) ? 4 : 1;
+
+        if(!SimCpuReadMemory(psMachine, ui32Addr, ui32Size, &ui32Value))
+            break;
+
+        pcReply = GdbPutHex(pcReply, ui32Value, ui32Size);
+        ui32Addr += ui32Size;
+        ui32Length -= ui32Size;
+    }
+
+    if(pcReply == psGdb->pcReply)
+        strcpy(psGdb->pcReply, "E01");
+}
+
+/*
+ * Writes memory from the data of an M packet in hex, or an X packet in
+ * binary.
+ */
+static void
+GdbWriteMemory(tSimGdb *psGdb, tSimMachine *psMachine, const char *pcData,
+               bool bBinary)
+{
+    uint8_t pui8Data[SIM_GDB_PACKET_SIZE];
+    uint32_t ui32Addr, ui32Length, ui32Idx, ui32Size, ui32Value, ui32Byte;
+    const char *pcEnd = psGdb->pcPacket + psGdb->ui32PacketLength;
+
+    ui32Addr = GdbHex(&pcData);
+
+    if(*pcData++ != ',')
+    {
+        strcpy(psGdb->pcReply, "E01");
+        return;
+    }
+
+    ui32Length = GdbHex(&pcData);
+
+    if((*pcData++ != ':') || (ui32Length > sizeof(pui8Data)))
+    {
+        strcpy(psGdb->pcReply, "E01");
+        return;
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Length; ui32Idx++)
+    {
+        if(bBinary)
+        {
+            if(pcData >= pcEnd)
+                break;
+
+            ui32Byte = (uint8_t)*pcData++;
+
+            if((ui32Byte == '}') && (pcData < pcEnd))
+                ui32Byte = (uint8_t)*pcData++ ^ 0x20;
+        }
+        else
+        {
+            if((GdbHexDigit(pcData[0]) < 0) || (GdbHexDigit(pcData[1]) < 0))
+                break;
+
+            ui32Byte = (uint32_t)(GdbHexDigit(pcData[0]) << 4 |
+                                  GdbHexDigit(pcData[1]));
+            pcData += 2;
+        }
+
+        pui8Data[ui32Idx] = (uint8_t)ui32Byte;
+    }
+
+    if(ui32Idx < ui32Length)
+    {
+        strcpy(psGdb->pcReply, "E01");
+        return;
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Length; ui32Idx += ui32Size,
+        ui32Addr += ui32Size)
+    {
+        ui32Size = (!(ui32Addr & 3) && (ui32Length - ui32Idx >= 4)) ? 4 : 1;
+        ui32Value = 0;
+
+        for(ui32Byte = 0; ui32Byte < ui32Size; ui32Byte++)
+            ui32Value |= (uint32_t)pui8Data[ui32Idx + ui32Byte] <<
+                         (ui32Byte * 8);
+
+        if(!SimCpuWriteMemory(psMachine, ui32Addr, ui32Size, ui32Value))
+        {
+            strcpy(psGdb->pcReply, "E02");
+            return;
+        }
+    }
+
+    strcpy(psGdb->pcReply, "OK");
+}
+
+/*
+ * Z and z packets: breakpoints of both kinds, and watchpoints.
+ */
+static void
+GdbBreakpoint(tSimGdb *psGdb, tSimMachine *psMachine, const char *pcData,
+              bool bSet)
+{
+    static const tSimDebugKind peKind[] =
+    {
+        SIM_DEBUG_WRITE, SIM_DEBUG_READ, SIM_DEBUG_ACCESS
+    };
+    uint32_t ui32Type, ui32Addr, ui32Kind;
+    bool bDone;
+
+    ui32Type = GdbHex(&pcData);
+
+    if(*pcData++ != ',')
+        return;
+
+    ui32Addr = GdbHex(&pcData);
+
+    if(*pcData++ != ',')
+        return;
+
+    ui32Kind = GdbHex(&pcData);
+
+    if(ui32Type <= 1)
+        bDone = SimDebugBreakpoint(psMachine, ui32Addr, bSet);
+    else if(ui32Type <= 4)
+        bDone = SimDebugWatchpoint(psMachine, ui32Addr, ui32Kind,
+                                   peKind[ui32Type - 2], bSet);
+    else
+        return;
+
+    strcpy(psGdb->pcReply, bDone ? "OK" : "E01");
+}
+
+/*
+ * qXfer:features:read:target.xml:OFFSET,LENGTH.
+ */
+static void
+GdbFeatures(tSimGdb *psGdb, const char *pcData)
+{
+    uint32_t ui32Offset, ui32Length, ui32Size = sizeof(g_pcTargetXML) - 1;
+
+    if(strncmp(pcData, "target.xml:", 11))
+    {
+        strcpy(psGdb->pcReply, "E00");
+        return;
+    }
+
+    pcData += 11;
+    ui32Offset = GdbHex(&pcData);
+
+    if(*pcData++ != ',')
+    {
+        strcpy(psGdb->pcReply, "E00");
+        return;
+    }
+
+    ui32Length = GdbHex(&pcData);
+
+    if(ui32Length > SIM_GDB_PACKET_SIZE - 1)
+        ui32Length = SIM_GDB_PACKET_SIZE - 1;
+
+    if(ui32Offset >= ui32Size)
+    {
+        strcpy(psGdb->pcReply, "l");
+        return;
+    }
+
+    if(ui32Length > ui32Size - ui32Offset)
+        ui32Length = ui32Size - ui32Offset;
+
+    psGdb->pcReply[0] = (ui32Offset + ui32Length < ui32Size) ? 'm' : 'l';
+    memcpy(psGdb->pcReply + 1, g_pcTargetXML + ui32Offset, ui32Length);
+    psGdb->pcReply[ui32Length + 1] = '\0';
+}
+
+/*
+ * Sends the reason of the last stop.
+ */
+static void
+GdbStopReply(tSimGdb *psGdb, tSimMachine *psMachine)
+{
+    static const char * const ppcWatch[] =
+    {
+        [SIM_DEBUG_WRITE] = "watch",
+        [SIM_DEBUG_READ] = "rwatch",
+        [SIM_DEBUG_ACCESS] = "awatch"
+    };
+    const tSimDebug *psDebug = psMachine->psDebug;
+
+    if(psDebug->bWatchHit)
+        snprintf(psGdb->pcReply, sizeof(psGdb->pcReply), "T%02x%s:%x;",
+                 psGdb->ui8Signal, ppcWatch[psDebug->eHitKind],
+                 psDebug->ui32HitAddr);
+    else
+        snprintf(psGdb->pcReply, sizeof(psGdb->pcReply), "T%02x",
+                 psGdb->ui8Signal);
+
+    GdbSend(psGdb, psGdb->pcReply);
+}
+
+/*
+ * The processor stops and the debugger is told why.
+ */
+static void
+GdbStop(tSimGdb *psGdb, tSimMachine *psMachine, uint8_t ui8Signal)
+{
+    psGdb->bStopped = true;
+    psGdb->ui8Signal = ui8Signal;
+    GdbStopReply(psGdb, psMachine);
+}
+
+/*
+ * c, s, C, S and vCont: resumes at the address given, if any.
+ */
+static tGdbAction
+GdbResume(tSimGdb *psGdb, tSimMachine *psMachine, char cAction,
+          const char *pcData)
+{
+    if(((cAction == 'C') || (cAction == 'S')) && *pcData)
+    {
+        GdbHex(&pcData);
+
+        if(*pcData == ';')
+            pcData++;
+    }
+
+    if(*pcData)
+        psMachine->sCpu.ui32PC = GdbHex(&pcData) & ~1U;
+
+    psGdb->bStep = (cAction == 's') || (cAction == 'S');
+    psGdb->bStopped = false;
+    SimDebugResume(psMachine);
+
+    return(GDB_RESUME);
+}
+
+/*
+ * Handles the packet in pcPacket, answering it unless it resumes the
+ * processor.
+ */
+static tGdbAction
+GdbCommand(tSimGdb *psGdb, tSimMachine *psMachine)
+{
+    const char *pcData = psGdb->pcPacket + 1;
+    char *pcReply = psGdb->pcReply;
+    uint32_t ui32Reg, ui32Addr, ui32Length;
+
+    pcReply[0] = '\0';
+
+    switch(psGdb->pcPacket[0])
+    {
+        case '?':
+            GdbStopReply(psGdb, psMachine);
+            return(GDB_SERVE);
+
+        case 'g':
+            for(ui32Reg = 0; ui32Reg < GDB_REGS; ui32Reg++)
+                pcReply = GdbPutHex(pcReply, GdbRegister(psMachine, ui32Reg),
+                                    4);
+            break;
+
+        case 'G':
+            for(ui32Reg = 0; (ui32Reg < GDB_REGS) && *pcData; ui32Reg++)
+                GdbSetRegister(psMachine, ui32Reg, GdbGetHex(&pcData));
+
+            strcpy(pcReply, "OK");
+            break;
+
+        case 'p':
+            ui32Reg = GdbHex(&pcData);
+
+            if(ui32Reg < GDB_REGS)
+                GdbPutHex(pcReply, GdbRegister(psMachine, ui32Reg), 4);
+            else
+                strcpy(pcReply, "E01");
+            break;
+
+        case 'P':
+            ui32Reg = GdbHex(&pcData);
+
+            if((ui32Reg < GDB_REGS) && (*pcData++ == '='))
+            {
+                GdbSetRegister(psMachine, ui32Reg, GdbGetHex(&pcData));
+                strcpy(pcReply, "OK");
+            }
+            else
+                strcpy(pcReply, "E01");
+            break;
+
+        case 'm':
+            ui32Addr = GdbHex(&pcData);
+
+            if(*pcData++ != ',')
+            {
+                strcpy(pcReply, "E01");
+                break;
+            }
+
+            ui32Length = GdbHex(&pcData);
+            GdbReadMemory(psGdb, psMachine, ui32Addr, ui32Length);
+            break;
+
+        case 'M':
+        case 'X':
+            GdbWriteMemory(psGdb, psMachine, pcData,
+                           psGdb->pcPacket[0] == 'X');
+            break;
+
+        case 'c':
+        case 's':
+        case 'C':
+        case 'S':
+            return(GdbResume(psGdb, psMachine, psGdb->pcPacket[0], pcData));
+
+        case 'v':
+            if(!strcmp(pcData, "Cont?"))
+                strcpy(pcReply, "vCont;c;C;s;S");
+            else if(!strncmp(pcData, "Cont;", 5) &&
+                    strchr("cCsS", pcData[5]) && pcData[5])
+                return(GdbResume(psGdb, psMachine, pcData[5], ""));
+            else if(!strncmp(pcData, "Kill", 4))
+                return(GDB_KILL);
+            break;
+
+        case 'Z':
+        case 'z':
+            GdbBreakpoint(psGdb, psMachine, pcData,
+                          psGdb->pcPacket[0] == 'Z');
+            break;
+
+        case 'q':
+            if(!strncmp(pcData, "Supported", 9))
+                snprintf(pcReply, sizeof(psGdb->pcReply),
+                         "PacketSize=%x;qXfer:features:read+;"
+                         "QStartNoAckMode+", SIM_GDB_PACKET_SIZE);
+            else if(!strncmp(pcData, "Xfer:features:read:", 19))
+                GdbFeatures(psGdb, pcData + 19);
+            else if(!strcmp(pcData, "Attached"))
+                strcpy(pcReply, "1");
+            else if(!strcmp(pcData, "C"))
+                strcpy(pcReply, "QC1");
+            else if(!strcmp(pcData, "fThreadInfo"))
+                strcpy(pcReply, "m1");
+            else if(!strcmp(pcData, "sThreadInfo"))
+                strcpy(pcReply, "l");
+            else if(!strncmp(pcData, "Symbol", 6))
+                strcpy(pcReply, "OK");
+            break;
+
+        case 'Q':
+            if(!strcmp(pcData, "StartNoAckMode"))
+            {
+                GdbSend(psGdb, "OK");
+                psGdb->bNoAck = true;
+                return(GDB_SERVE);
+            }
+            break;
+
+        case 'H':
+        case 'T':
+            strcpy(pcReply, "OK");
+            break;
+
+        case 'D':
+            GdbSend(psGdb, "OK");
+            GdbDetach(psGdb, psMachine);
+            return(GDB_RESUME);
+
+        case 'k':
+            return(GDB_KILL);
+
+        default:
+            break;
+    }
+
+    GdbSend(psGdb, psGdb->pcReply);
+
+    return(GDB_SERVE);
+}
+
+/*
+ * Serves the debugger while the processor is stopped.  Returns false if the
+ * debugger kills the run.
+ */
+static bool
+GdbServe(tSimGdb *psGdb, tSimMachine *psMachine)
+{
+    tGdbAction eAction;
+
+    for(;;)
+    {
+        if(!GdbReceive(psGdb))
+        {
+            GdbDetach(psGdb, psMachine);
+            return(true);
+        }
+
+        eAction = GdbCommand(psGdb, psMachine);
+
+        if(eAction == GDB_KILL)
+        {
+            close(psGdb->i32Socket);
+            psGdb->i32Socket = -1;
+            return(false);
+        }
+
+        if(eAction == GDB_RESUME)
+            return(true);
+    }
+}
+
+/*
+ * Runs until an instruction has run or the processor has changed its course,
+ * for an exception or a reset.  A sleeping processor runs up to its next
+ * board event at a time.
+ */
+static tSimCpuStop
+GdbStep(tSimGdb *psGdb, tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimBoard *psBoard = &psMachine->sBoard;
+    uint64_t ui64Insns = psCpu->ui64Insns, ui64Cycles;
+    uint32_t ui32PC = psCpu->ui32PC;
+    tSimCpuStop eStop;
+
+    do
+    {
+        ui64Cycles = 1;
+
+        if(psCpu->bSleeping || psBoard->bHibernating)
+        {
+            ui64Cycles = SimBoardNextEvent(psBoard);
+
+            if(ui64Cycles > GDB_STEP_CYCLES)
+                ui64Cycles = GDB_STEP_CYCLES;
+            else if(!ui64Cycles)
+                ui64Cycles = 1;
+        }
+
+        eStop = SimCpuRun(psMachine, ui64Cycles);
+
+        if((eStop == SIM_CPU_DONE) && GdbInterrupted(psGdb, psMachine))
+            return(SIM_CPU_STOPPED);
+    }
+    while((eStop == SIM_CPU_DONE) && (psCpu->ui64Insns == ui64Insns) &&
+          (psCpu->ui32PC == ui32PC) && !psGdb->bDetached);
+
+    return(eStop);
+}
+
+/*
+ * Returns the signal reporting a stop of the processor: a lockup is a
+ * fault, a stop without a watchpoint hit is an interrupt by the debugger.
+ */
+static uint8_t
+GdbSignal(const tSimMachine *psMachine, tSimCpuStop eStop)
+{
+    if(eStop == SIM_CPU_LOCKUP)
+        return(GDB_SIGSEGV);
+
+    if((eStop == SIM_CPU_STOPPED) && !psMachine->psDebug->bWatchHit)
+        return(GDB_SIGINT);
+
+    return(GDB_SIGTRAP);
+}
+
+/*
+ * Runs the processor for ui64Cycles under the control of the debugger,
+ * serving it whenever the processor stops.  Returns SIM_CPU_STOPPED if the
+ * debugger kills the run and SIM_CPU_DONE otherwise.
+ */
+tSimCpuStop
+SimGdbRun(tSimGdb *psGdb, tSimMachine *psMachine, uint64_t ui64Cycles)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint64_t ui64End = psCpu->ui64Cycle + ui64Cycles;
+    tSimCpuStop eStop;
+
+    /*
+     * The debugger is served until it resumes, even at the end of the
+     * cycles, so that it is never left waiting for a stop.
+     */
+    for(;;)
+    {
+        if(psGdb->bStopped && !GdbServe(psGdb, psMachine))
+            return(SIM_CPU_STOPPED);
+
+        if(psCpu->ui64Cycle >= ui64End)
+            return(SIM_CPU_DONE);
+
+        if(psGdb->bDetached)
+            return(SimCpuRun(psMachine, ui64End - psCpu->ui64Cycle));
+
+        if(psGdb->bStep)
+        {
+            eStop = GdbStep(psGdb, psMachine);
+
+            if(!psGdb->bDetached)
+                GdbStop(psGdb, psMachine, GdbSignal(psMachine, eStop));
+            continue;
+        }
+
+        eStop = SimCpuRun(psMachine, ui64End - psCpu->ui64Cycle);
+
+        if(eStop == SIM_CPU_DONE)
+        {
+            if(GdbInterrupted(psGdb, psMachine))
+                GdbStop(psGdb, psMachine, GDB_SIGINT);
+        }
+        else
+            GdbStop(psGdb, psMachine, GdbSignal(psMachine, eStop));
+    }
+}
+
+/*
+ * Tells a debugger still attached that the program exited with ui8Status,
+ * and closes the connection.
+ */
+void
+SimGdbClose(tSimGdb *psGdb, uint8_t ui8Status)
+{
+    char pcReply[4];
+
+    if(!psGdb)
+        return;
+
+    if(psGdb->i32Socket >= 0)
+    {
+        snprintf(pcReply, sizeof(pcReply), "W%02x", ui8Status);
+        GdbSend(psGdb, pcReply);
+        close(psGdb->i32Socket);
+    }
+
+    if(psGdb->i32Listen >= 0)
+        close(psGdb->i32Listen);
+
+    free(psGdb);
+}
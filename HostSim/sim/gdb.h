@@ -0,0 +1,70 @@
+#ifndef __SIM_GDB_H__
+#define __SIM_GDB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpu.h"
+
+/*
+ * Stub of the GDB remote serial protocol, so that gdb can be attached to a
+ * firmware running on the instruction set simulator with
+ * `target remote localhost:PORT`.
+ *
+ * The stub listens on the loopback interface only and serves one debugger.
+ * While the processor is stopped, the stub waits for the requests of the
+ * debugger: reads and writes of the registers and of the memory map, the
+ * peripherals included, breakpoints and watchpoints (see debug.h) and
+ * single steps.  While it runs, it runs at the full speed of the simulator
+ * and the connection is only looked at every SIM_GDB_POLL_MS of host time,
+ * for the interrupt gdb sends on Ctrl-C.
+ *
+ * The registers are described to gdb as those of an M-profile core, with
+ * MSP, PSP, PRIMASK, BASEPRI, FAULTMASK and CONTROL after xPSR; the
+ * floating-point registers are not.  A debugger writes the special
+ * registers as MSR does.  A single step runs one instruction, or an
+ * exception entry; a sleeping processor steps to its wake-up.
+ *
+ * A debugger that detaches or goes away leaves the firmware running on
+ * without breakpoints and watchpoints.  The end of the run is reported to
+ * it as the exit of the program.
+ */
+#define SIM_GDB_PACKET_SIZE     4096
+#define SIM_GDB_POLL_MS         10
+
+typedef struct
+{
+    int i32Listen;
+    int i32Socket;
+    bool bNoAck;
+    bool bStopped;
+    bool bStep;
+    bool bDetached;
+
+    /*
+     * Signal of the last stop, as numbered by gdb.
+     */
+    uint8_t ui8Signal;
+
+    /*
+     * Host time of the last look at the connection while running, in
+     * nanoseconds.
+     */
+    uint64_t ui64Polled;
+
+    uint8_t pui8In[SIM_GDB_PACKET_SIZE];
+    uint32_t ui32InPos;
+    uint32_t ui32InLen;
+
+    char pcPacket[SIM_GDB_PACKET_SIZE + 1];
+    uint32_t ui32PacketLength;
+    char pcReply[SIM_GDB_PACKET_SIZE + 1];
+} tSimGdb;
+
+tSimGdb *SimGdbOpen(uint16_t ui16Port);
+bool SimGdbAccept(tSimGdb *psGdb);
+tSimCpuStop SimGdbRun(tSimGdb *psGdb, tSimMachine *psMachine,
+                      uint64_t ui64Cycles);
+void SimGdbClose(tSimGdb *psGdb, uint8_t ui8Status);
+
+#endif
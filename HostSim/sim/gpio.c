@@ -0,0 +1,378 @@
+/*
+ * General purpose I/O ports A to F.
+ */
+#include <string.h>
+
+#include "board.h"
+
+#define GPIO_O_DIR              0x400
+#define GPIO_O_IS               0x404
+#define GPIO_O_IBE              0x408
+#define GPIO_O_IEV              0x40C
+#define GPIO_O_IM               0x410
+#define GPIO_O_RIS              0x414
+#define GPIO_O_MIS              0x418
+#define GPIO_O_ICR              0x41C
+#define GPIO_O_AFSEL            0x420
+#define GPIO_O_DR2R             0x500
+#define GPIO_O_DR4R             0x504
+#define GPIO_O_DR8R             0x508
+#define GPIO_O_ODR              0x50C
+#define GPIO_O_PUR              0x510
+#define GPIO_O_PDR              0x514
+#define GPIO_O_SLR              0x518
+#define GPIO_O_DEN              0x51C
+#define GPIO_O_LOCK             0x520
+#define GPIO_O_CR               0x524
+#define GPIO_O_AMSEL            0x528
+#define GPIO_O_PCTL             0x52C
+#define GPIO_O_ADCCTL           0x530
+#define GPIO_O_DMACTL           0x534
+#define GPIO_O_PERIPHID4        0xFD0
+
+#define GPIO_LOCK_KEY           0x4C4F434BU
+
+static const uint8_t g_pui8Interrupt[SIM_GPIO_PORTS] =
+{
+    SIM_INT_GPIOA, SIM_INT_GPIOB, SIM_INT_GPIOC,
+    SIM_INT_GPIOD, SIM_INT_GPIOE, SIM_INT_GPIOF
+};
+
+/*
+ * Pins with JTAG or NMI functions are protected by the commit register.
+ */
+static const uint8_t g_pui8Commit[SIM_GPIO_PORTS] =
+{
+    0xFF, 0xFF, 0xF0, 0x7F, 0xFF, 0xFE
+};
+
+static const uint8_t g_pui8PeriphID[12] =
+{
+    0x00, 0x00, 0x00, 0x00, 0x61, 0x00, 0x18, 0x01, 0x0D, 0xF0, 0x05, 0xB1
+};
+
+/*
+ * Returns the level of the pins as seen by the input buffers.
+ */
+uint8_t
+SimGPIOPins(const tSimGPIO *psGPIO)
+{
+    return(((psGPIO->ui8Data & psGPIO->ui8Dir) |
+            (psGPIO->ui8Input & ~psGPIO->ui8Dir)) & psGPIO->ui8DEN);
+}
+
+static void
+GPIOUpdateLine(tSimBoard *psBoard, uint32_t ui32Port)
+{
+    tSimGPIO *psGPIO = &psBoard->psGPIO[ui32Port];
+
+    SimNVICSetLine(&psBoard->sNVIC, g_pui8Interrupt[ui32Port],
+                   (psGPIO->ui8RIS & psGPIO->ui8IM) != 0);
+}
+
+/*
+ * Runs the interrupt detection logic after the pin levels may have changed
+ * from ui8Old.
+ */
+static void
+GPIODetect(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Old)
+{
+    tSimGPIO *psGPIO = &psBoard->psGPIO[ui32Port];
+    uint8_t ui8New = SimGPIOPins(psGPIO);
+    uint8_t ui8Changed = ui8Old ^ ui8New;
+    uint8_t ui8Edge;
+
+    /*
+     * Edge sensitive pins latch either edge when IBE is set, otherwise the
+     * edge selected by IEV.
+     */
+    ui8Edge = ui8Changed & ~psGPIO->ui8IS &
+              (psGPIO->ui8IBE | ~(ui8New ^ psGPIO->ui8IEV));
+
+    /*
+     * Level sensitive pins follow the level selected by IEV.
+     */
+    psGPIO->ui8RIS = (psGPIO->ui8RIS & ~psGPIO->ui8IS) | ui8Edge |
+                     (psGPIO->ui8IS & ~(ui8New ^ psGPIO->ui8IEV));
+
+    GPIOUpdateLine(psBoard, ui32Port);
+}
+
+/*
+ * Reports a change of the driven outputs to the board.  While the
+ * hibernation module holds the pads, they keep the levels they had.
+ */
+void
+SimGPIOUpdate(tSimBoard *psBoard, uint32_t ui32Port)
+{
+    tSimGPIO *psGPIO = &psBoard->psGPIO[ui32Port];
+    uint8_t ui8Output = psGPIO->ui8Data & psGPIO->ui8Dir & psGPIO->ui8DEN;
+    uint8_t ui8Old = psGPIO->ui8Output;
+
+    if((ui8Output == ui8Old) || psBoard->sHib.bRetained)
+        return;
+
+    psGPIO->ui8Output = ui8Output;
+    SimBoardPinChange(psBoard, ui32Port, ui8Old, ui8Output);
+}
+
+void
+SimGPIOReset(tSimBoard *psBoard, uint32_t ui32Port)
+{
+    tSimGPIO *psGPIO = &psBoard->psGPIO[ui32Port];
+    uint8_t ui8Input = psGPIO->ui8Input;
+    uint8_t ui8Output = psGPIO->ui8Output;
+
+    memset(psGPIO, 0, sizeof(*psGPIO));
+
+    psGPIO->ui8Input = ui8Input;
+    psGPIO->ui8Output = ui8Output;
+    psGPIO->ui8DR2R = 0xFF;
+    psGPIO->ui8CR = g_pui8Commit[ui32Port];
+    psGPIO->bLocked = true;
+
+    /*
+     * PC0 to PC3 come out of reset as the JTAG port.
+     */
+    if(ui32Port == 2)
+    {
+        psGPIO->ui8AFSEL = 0x0F;
+        psGPIO->ui8DEN = 0x0F;
+        psGPIO->ui8PUR = 0x0F;
+        psGPIO->ui32PCTL = 0x00001111U;
+    }
+
+    SimGPIOUpdate(psBoard, ui32Port);
+}
+
+uint32_t
+SimGPIORead(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Offset,
+            bool bPeek)
+{
+    tSimGPIO *psGPIO = &psBoard->psGPIO[ui32Port];
+
+    (void)bPeek;
+
+    /*
+     * Address bits [9:2] mask the data register.
+     */
+    if(ui32Offset < GPIO_O_DIR)
+        return(SimGPIOPins(psGPIO) & (ui32Offset >> 2));
+
+    if(ui32Offset >= GPIO_O_PERIPHID4)
+        return(g_pui8PeriphID[(ui32Offset - GPIO_O_PERIPHID4) / 4]);
+
+    switch(ui32Offset)
+    {
+        case GPIO_O_DIR:
+            return(psGPIO->ui8Dir);
+
+        case GPIO_O_IS:
+            return(psGPIO->ui8IS);
+
+        case GPIO_O_IBE:
+            return(psGPIO->ui8IBE);
+
+        case GPIO_O_IEV:
+            return(psGPIO->ui8IEV);
+
+        case GPIO_O_IM:
+            return(psGPIO->ui8IM);
+
+        case GPIO_O_RIS:
+            return(psGPIO->ui8RIS);
+
+        case GPIO_O_MIS:
+            return(psGPIO->ui8RIS & psGPIO->ui8IM);
+
+        case GPIO_O_AFSEL:
+            return(psGPIO->ui8AFSEL);
+
+        case GPIO_O_DR2R:
+            return(psGPIO->ui8DR2R);
+
+        case GPIO_O_DR4R:
+            return(psGPIO->ui8DR4R);
+
+        case GPIO_O_DR8R:
+            return(psGPIO->ui8DR8R);
+
+        case GPIO_O_ODR:
+            return(psGPIO->ui8ODR);
+
+        case GPIO_O_PUR:
+            return(psGPIO->ui8PUR);
+
+        case GPIO_O_PDR:
+            return(psGPIO->ui8PDR);
+
+        case GPIO_O_SLR:
+            return(psGPIO->ui8SLR);
+
+        case GPIO_O_DEN:
+            return(psGPIO->ui8DEN);
+
+        case GPIO_O_LOCK:
+            return(psGPIO->bLocked ? 1 : 0);
+
+        case GPIO_O_CR:
+            return(psGPIO->ui8CR);
+
+        case GPIO_O_AMSEL:
+            return(psGPIO->ui8AMSEL);
+
+        case GPIO_O_PCTL:
+            return(psGPIO->ui32PCTL);
+
+        case GPIO_O_ADCCTL:
+            return(psGPIO->ui8ADCCTL);
+
+        case GPIO_O_DMACTL:
+            return(psGPIO->ui8DMACTL);
+
+        default:
+            return(0);
+    }
+}
+
+/*
+ * Writes a register whose bits are protected by the commit register.
+ */
+static void
+GPIOWriteCommitted(const tSimGPIO *psGPIO, uint8_t *pui8Reg, uint32_t ui32Value)
+{
+    *pui8Reg = (*pui8Reg & ~psGPIO->ui8CR) | (ui32Value & psGPIO->ui8CR);
+}
+
+void
+SimGPIOWrite(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Offset,
+             uint32_t ui32Value)
+{
+    tSimGPIO *psGPIO = &psBoard->psGPIO[ui32Port];
+    uint8_t ui8Old = SimGPIOPins(psGPIO);
+    uint8_t ui8Mask;
+
+    if(ui32Offset < GPIO_O_DIR)
+    {
+        ui8Mask = (uint8_t)(ui32Offset >> 2);
+        psGPIO->ui8Data = (psGPIO->ui8Data & ~ui8Mask) | (ui32Value & ui8Mask);
+    }
+    else
+    {
+        switch(ui32Offset)
+        {
+            case GPIO_O_DIR:
+                psGPIO->ui8Dir = ui32Value;
+                break;
+
+            case GPIO_O_IS:
+                psGPIO->ui8IS = ui32Value;
+                break;
+
+            case GPIO_O_IBE:
+                psGPIO->ui8IBE = ui32Value;
+                break;
+
+            case GPIO_O_IEV:
+                psGPIO->ui8IEV = ui32Value;
+                break;
+
+            case GPIO_O_IM:
+                psGPIO->ui8IM = ui32Value;
+                break;
+
+            case GPIO_O_ICR:
+                psGPIO->ui8RIS &= ~(ui32Value & ~psGPIO->ui8IS);
+                break;
+
+            case GPIO_O_AFSEL:
+                GPIOWriteCommitted(psGPIO, &psGPIO->ui8AFSEL, ui32Value);
+                break;
+
+            case GPIO_O_DR2R:
+                psGPIO->ui8DR2R = ui32Value;
+                psGPIO->ui8DR4R &= ~ui32Value;
+                psGPIO->ui8DR8R &= ~ui32Value;
+                break;
+
+            case GPIO_O_DR4R:
+                psGPIO->ui8DR4R = ui32Value;
+                psGPIO->ui8DR2R &= ~ui32Value;
+                psGPIO->ui8DR8R &= ~ui32Value;
+                break;
+
+            case GPIO_O_DR8R:
+                psGPIO->ui8DR8R = ui32Value;
+                psGPIO->ui8DR2R &= ~ui32Value;
+                psGPIO->ui8DR4R &= ~ui32Value;
+                break;
+
+            case GPIO_O_ODR:
+                psGPIO->ui8ODR = ui32Value;
+                break;
+
+            case GPIO_O_PUR:
+                GPIOWriteCommitted(psGPIO, &psGPIO->ui8PUR, ui32Value);
+                psGPIO->ui8PDR &= ~(ui32Value & psGPIO->ui8CR);
+                break;
+
+            case GPIO_O_PDR:
+                GPIOWriteCommitted(psGPIO, &psGPIO->ui8PDR, ui32Value);
+                psGPIO->ui8PUR &= ~(ui32Value & psGPIO->ui8CR);
+                break;
+
+            case GPIO_O_SLR:
+                psGPIO->ui8SLR = ui32Value;
+                break;
+
+            case GPIO_O_DEN:
+                GPIOWriteCommitted(psGPIO, &psGPIO->ui8DEN, ui32Value);
+                break;
+
+            case GPIO_O_LOCK:
+                psGPIO->bLocked = (ui32Value != GPIO_LOCK_KEY);
+                break;
+
+            case GPIO_O_CR:
+                if(!psGPIO->bLocked)
+                    psGPIO->ui8CR = ui32Value;
+                break;
+
+            case GPIO_O_AMSEL:
+                psGPIO->ui8AMSEL = ui32Value;
+                break;
+
+            case GPIO_O_PCTL:
+                psGPIO->ui32PCTL = ui32Value;
+                break;
+
+            case GPIO_O_ADCCTL:
+                psGPIO->ui8ADCCTL = ui32Value;
+                break;
+
+            case GPIO_O_DMACTL:
+                psGPIO->ui8DMACTL = ui32Value;
+                break;
+
+            default:
+                return;
+        }
+    }
+
+    SimGPIOUpdate(psBoard, ui32Port);
+    GPIODetect(psBoard, ui32Port, ui8Old);
+}
+
+/*
+ * Drives the pins selected by ui8Mask from outside the chip.
+ */
+void
+SimGPIOSetInput(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Mask,
+                uint8_t ui8Level)
+{
+    tSimGPIO *psGPIO = &psBoard->psGPIO[ui32Port];
+    uint8_t ui8Old = SimGPIOPins(psGPIO);
+
+    psGPIO->ui8Input = (psGPIO->ui8Input & ~ui8Mask) | (ui8Level & ui8Mask);
+    GPIODetect(psBoard, ui32Port, ui8Old);
+}
@@ -0,0 +1,54 @@
+#ifndef __SIM_GPIO_H__
+#define __SIM_GPIO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+#define SIM_GPIO_PORTS          6
+
+/*
+ * One GPIO port.  The APB and AHB apertures of a port share this state.
+ * ui8Input holds the level driven onto the pins from outside the chip and
+ * ui8Output the level the port drives, as last reported to the pin hook.
+ */
+typedef struct
+{
+    uint8_t ui8Data;
+    uint8_t ui8Dir;
+    uint8_t ui8IS;
+    uint8_t ui8IBE;
+    uint8_t ui8IEV;
+    uint8_t ui8IM;
+    uint8_t ui8RIS;
+    uint8_t ui8AFSEL;
+    uint8_t ui8DR2R;
+    uint8_t ui8DR4R;
+    uint8_t ui8DR8R;
+    uint8_t ui8ODR;
+    uint8_t ui8PUR;
+    uint8_t ui8PDR;
+    uint8_t ui8SLR;
+    uint8_t ui8DEN;
+    uint8_t ui8CR;
+    uint8_t ui8AMSEL;
+    uint8_t ui8ADCCTL;
+    uint8_t ui8DMACTL;
+    bool bLocked;
+    uint32_t ui32PCTL;
+    uint8_t ui8Input;
+    uint8_t ui8Output;
+} tSimGPIO;
+
+void SimGPIOReset(tSimBoard *psBoard, uint32_t ui32Port);
+uint32_t SimGPIORead(tSimBoard *psBoard, uint32_t ui32Port,
+                     uint32_t ui32Offset, bool bPeek);
+void SimGPIOWrite(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Offset,
+                  uint32_t ui32Value);
+void SimGPIOSetInput(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Mask,
+                     uint8_t ui8Level);
+uint8_t SimGPIOPins(const tSimGPIO *psGPIO);
+void SimGPIOUpdate(tSimBoard *psBoard, uint32_t ui32Port);
+
+#endif
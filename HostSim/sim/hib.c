@@ -0,0 +1,298 @@
+/*
+ * Hibernation module and real-time clock.
+ */
+#include <string.h>
+
+#include "board.h"
+
+#define HIB_O_RTCC              0x000
+#define HIB_O_RTCM0             0x004
+#define HIB_O_RTCLD             0x00C
+#define HIB_O_CTL               0x010
+#define HIB_O_IM                0x014
+#define HIB_O_RIS               0x018
+#define HIB_O_MIS               0x01C
+#define HIB_O_IC                0x020
+#define HIB_O_RTCT              0x024
+#define HIB_O_RTCSS             0x028
+#define HIB_O_DATA              0x030
+
+#define HIB_CTL_RTCEN           0x00000001U
+#define HIB_CTL_HIBREQ          0x00000002U
+#define HIB_CTL_RTCWEN          0x00000008U
+#define HIB_CTL_VDD3ON          0x00000100U
+#define HIB_CTL_RETCLR          0x40000000U
+#define HIB_CTL_WRC             0x80000000U
+
+#define HIB_RIS_RTCALT0         0x00000001U
+
+#define HIB_RTC_HZ              32768
+
+static void
+HibUpdateLine(tSimBoard *psBoard)
+{
+    SimNVICSetLine(&psBoard->sNVIC, SIM_INT_HIBERNATE,
+                   (psBoard->sHib.ui32RIS & psBoard->sHib.ui32IM) != 0);
+}
+
+/*
+ * Returns the number of whole seconds and, in pui32Sub, of RTC clock periods
+ * the counter has run since ui64Start.
+ */
+static uint64_t
+HibElapsed(const tSimBoard *psBoard, uint32_t *pui32Sub)
+{
+    const tSimHib *psHib = &psBoard->sHib;
+    uint64_t ui64Elapsed;
+
+    ui64Elapsed = ((psHib->ui32Ctl & HIB_CTL_RTCEN) &&
+                   (psBoard->ui64Time > psHib->ui64Start)) ?
+                  psBoard->ui64Time - psHib->ui64Start : 0;
+
+    if(pui32Sub)
+        *pui32Sub = (uint32_t)((ui64Elapsed % SIM_PS_PER_SECOND) *
+                               HIB_RTC_HZ / SIM_PS_PER_SECOND);
+
+    return(ui64Elapsed / SIM_PS_PER_SECOND);
+}
+
+static uint32_t
+HibCounter(const tSimBoard *psBoard)
+{
+    return(psBoard->sHib.ui32Load + (uint32_t)HibElapsed(psBoard, NULL));
+}
+
+/*
+ * Folds the whole seconds counted since ui64Start into ui32Load.
+ */
+static void
+HibSync(tSimBoard *psBoard)
+{
+    tSimHib *psHib = &psBoard->sHib;
+    uint64_t ui64Seconds = HibElapsed(psBoard, NULL);
+
+    psHib->ui32Load += (uint32_t)ui64Seconds;
+    psHib->ui64Start += ui64Seconds * SIM_PS_PER_SECOND;
+}
+
+/*
+ * Schedules the next time the counter reaches the match value.
+ */
+static void
+HibSchedule(tSimBoard *psBoard)
+{
+    tSimHib *psHib = &psBoard->sHib;
+    uint32_t ui32Seconds = psHib->ui32Match - psHib->ui32Load;
+    uint64_t ui64Deadline = psHib->ui64Start +
+                            (uint64_t)ui32Seconds * SIM_PS_PER_SECOND;
+
+    if(!(psHib->ui32Ctl & HIB_CTL_RTCEN) || !ui32Seconds ||
+       (ui64Deadline <= psBoard->ui64Time))
+    {
+        SimEventCancel(&psBoard->sEvents, SIM_EVENT_HIB);
+        return;
+    }
+
+    SimEventSchedule(&psBoard->sEvents, SIM_EVENT_HIB, ui64Deadline);
+}
+
+void
+SimHibReset(tSimBoard *psBoard)
+{
+    tSimHib *psHib = &psBoard->sHib;
+
+    memset(psHib, 0, sizeof(*psHib));
+
+    psHib->ui32Trim = 0x7FFF;
+    psHib->ui64Start = psBoard->ui64Time;
+}
+
+/*
+ * Restores the event and interrupt line of the module after the rest of the
+ * chip was reset.
+ */
+void
+SimHibResume(tSimBoard *psBoard)
+{
+    HibSchedule(psBoard);
+    HibUpdateLine(psBoard);
+}
+
+void
+SimHibEvent(tSimBoard *psBoard)
+{
+    tSimHib *psHib = &psBoard->sHib;
+
+    HibSync(psBoard);
+
+    psHib->ui32RIS |= HIB_RIS_RTCALT0;
+    HibUpdateLine(psBoard);
+
+    if(psBoard->psReplay)
+        SimReplayRTCMatch(psBoard, psHib->ui32Match);
+
+    /*
+     * A match enabled as a wake source ends hibernation with a power-on
+     * reset of the chip.
+     */
+    if(psBoard->bHibernating && (psHib->ui32Ctl & HIB_CTL_RTCWEN))
+    {
+        psHib->ui32Ctl &= ~HIB_CTL_HIBREQ;
+        psHib->ui64Wakes++;
+        psHib->ui64Hibernated += psBoard->ui64Time - psHib->ui64Entered;
+        psBoard->ui32ResetRequest |= SIM_RESET_POR;
+    }
+}
+
+/*
+ * Powers the chip down, holding the pads if GPIO retention is enabled.
+ */
+static void
+HibRequest(tSimBoard *psBoard)
+{
+    tSimHib *psHib = &psBoard->sHib;
+
+    /*
+     * From here until RETCLR is cleared, SimGPIOUpdate() leaves the pads
+     * alone: outputs the firmware changes after the wake produce no edges,
+     * and only the net change of each pin shows, as one edge, at the
+     * release.  HibernateWakeup, which turns the LED on again and never
+     * releases the pads, shows no edge after its first wake; see
+     * tests/golden/hibernate-wakeup.trace.
+     */
+    psHib->bRetained = (psHib->ui32Ctl & HIB_CTL_VDD3ON) != 0;
+    psHib->ui64Entered = psBoard->ui64Time;
+
+    SimBoardHibernate(psBoard);
+}
+
+/*
+ * Gives the pads back to the GPIO ports, which drive them from their
+ * registers again.
+ */
+static void
+HibRelease(tSimBoard *psBoard)
+{
+    uint32_t ui32Port;
+
+    psBoard->sHib.bRetained = false;
+
+    for(ui32Port = 0; ui32Port < SIM_GPIO_PORTS; ui32Port++)
+        SimGPIOUpdate(psBoard, ui32Port);
+}
+
+uint32_t
+SimHibRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek)
+{
+    tSimHib *psHib = &psBoard->sHib;
+    uint32_t ui32Sub;
+
+    (void)bPeek;
+
+    if((ui32Offset >= HIB_O_DATA) &&
+       (ui32Offset < HIB_O_DATA + SIM_HIB_DATA_WORDS * 4))
+        return(psHib->pui32Data[(ui32Offset - HIB_O_DATA) / 4]);
+
+    switch(ui32Offset)
+    {
+        case HIB_O_RTCC:
+            return(HibCounter(psBoard));
+
+        case HIB_O_RTCM0:
+            return(psHib->ui32Match);
+
+        case HIB_O_RTCLD:
+            return(psHib->ui32Load);
+
+        case HIB_O_CTL:
+            /*
+             * Writes complete at once, so WRC always reads as set.
+             */
+            return(psHib->ui32Ctl | HIB_CTL_WRC);
+
+        case HIB_O_IM:
+            return(psHib->ui32IM);
+
+        case HIB_O_RIS:
+            return(psHib->ui32RIS);
+
+        case HIB_O_MIS:
+            return(psHib->ui32RIS & psHib->ui32IM);
+
+        case HIB_O_RTCT:
+            return(psHib->ui32Trim);
+
+        case HIB_O_RTCSS:
+            HibElapsed(psBoard, &ui32Sub);
+            return(ui32Sub);
+
+        default:
+            return(0);
+    }
+}
+
+void
+SimHibWrite(tSimBoard *psBoard, uint32_t ui32Offset, uint32_t ui32Value)
+{
+    tSimHib *psHib = &psBoard->sHib;
+
+    if((ui32Offset >= HIB_O_DATA) &&
+       (ui32Offset < HIB_O_DATA + SIM_HIB_DATA_WORDS * 4))
+    {
+        psHib->pui32Data[(ui32Offset - HIB_O_DATA) / 4] = ui32Value;
+        return;
+    }
+
+    HibSync(psBoard);
+
+    switch(ui32Offset)
+    {
+        case HIB_O_RTCM0:
+            psHib->ui32Match = ui32Value;
+            break;
+
+        case HIB_O_RTCLD:
+            /*
+             * Loading the counter restarts the current second.
+             */
+            psHib->ui32Load = ui32Value;
+            psHib->ui64Start = psBoard->ui64Time;
+            break;
+
+        case HIB_O_CTL:
+            if((ui32Value & HIB_CTL_RTCEN) &&
+               !(psHib->ui32Ctl & HIB_CTL_RTCEN))
+                psHib->ui64Start = psBoard->ui64Time;
+
+            psHib->ui32Ctl = ui32Value & ~HIB_CTL_WRC;
+
+            if(psHib->bRetained && !(ui32Value & HIB_CTL_RETCLR))
+                HibRelease(psBoard);
+
+            if(ui32Value & HIB_CTL_HIBREQ)
+            {
+                HibRequest(psBoard);
+                return;
+            }
+            break;
+
+        case HIB_O_IM:
+            psHib->ui32IM = ui32Value & 0x1F;
+            HibUpdateLine(psBoard);
+            return;
+
+        case HIB_O_IC:
+            psHib->ui32RIS &= ~ui32Value;
+            HibUpdateLine(psBoard);
+            return;
+
+        case HIB_O_RTCT:
+            psHib->ui32Trim = ui32Value & 0xFFFF;
+            return;
+
+        default:
+            return;
+    }
+
+    HibSchedule(psBoard);
+}
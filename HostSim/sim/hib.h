@@ -0,0 +1,52 @@
+#ifndef __SIM_HIB_H__
+#define __SIM_HIB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+#define SIM_HIB_DATA_WORDS      16
+
+/*
+ * Hibernation module.  It is powered from the battery, so its state survives
+ * chip resets and hibernation; only SimBoardInit() clears it.
+ *
+ * The RTC is evaluated lazily: it counted ui32Load at ui64Start and advances
+ * once per second from there while RTCEN is set.  While the chip hibernates
+ * nothing else happens, so the board moves straight on to the match that
+ * wakes it, however far away, and a run of many wake cycles costs only what
+ * the firmware does while awake.
+ *
+ * When VDD3ON is set as the chip goes into hibernation, the pads keep the
+ * levels the GPIO ports drove, through the hibernation and the reset that
+ * ends it, until the firmware clears RETCLR again; bRetained is set in
+ * between.  A wake sets RTCALT0 in ui32RIS, as on the chip, for the firmware
+ * to tell it from a cold start.
+ *
+ * ui64Wakes and ui64Hibernated count the wakes from hibernation of the run
+ * and the time spent hibernating before them, since ui64Entered.
+ */
+typedef struct
+{
+    uint32_t ui32Ctl;
+    uint32_t ui32Load;
+    uint32_t ui32Match;
+    uint32_t ui32IM;
+    uint32_t ui32RIS;
+    uint32_t ui32Trim;
+    uint64_t ui64Start;
+    uint32_t pui32Data[SIM_HIB_DATA_WORDS];
+    bool bRetained;
+    uint64_t ui64Entered;
+    uint64_t ui64Wakes;
+    uint64_t ui64Hibernated;
+} tSimHib;
+
+void SimHibReset(tSimBoard *psBoard);
+void SimHibResume(tSimBoard *psBoard);
+uint32_t SimHibRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek);
+void SimHibWrite(tSimBoard *psBoard, uint32_t ui32Offset, uint32_t ui32Value);
+void SimHibEvent(tSimBoard *psBoard);
+
+#endif
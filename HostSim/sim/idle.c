@@ -0,0 +1,623 @@
+/*
+ * Fast-forwarding of idle loops (see idle.h).
+ *
+ * A loop qualifies if its body is a straight run of at most
+ * SIM_IDLE_MAX_INSNS instructions closed by a direct branch back to the
+ * head, and the body only computes registers and loads and stores words of
+ * flash and SRAM at addresses that stay the same from one iteration to the
+ * next.  Peripherals are never touched, so the board does not notice the
+ * skipped iterations, and nothing else can change the memory the loop reads
+ * before the next board event.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "idle.h"
+#include "thumb.h"
+#include "timing.h"
+
+/*
+ * Iterations run under observation: the first finds the memory the loop
+ * touches, the other two give the change one iteration makes.
+ */
+#define IDLE_RUNS               3
+
+/*
+ * Number of points at which the flags of the closing compare may change
+ * that the exit search looks at before it settles for skipping less.
+ */
+#define IDLE_EXIT_STEPS         32
+
+/*
+ * Registers kept track of: R0 to R14.
+ */
+#define IDLE_REGS               15
+
+typedef enum
+{
+    IDLE_OK,
+    IDLE_LATER,
+    IDLE_REJECT
+} tIdleResult;
+
+/*
+ * A loop body, from the head to the closing branch.
+ */
+typedef struct
+{
+    const tSimInsn *ppsInsn[SIM_IDLE_MAX_INSNS];
+    uint32_t pui32PC[SIM_IDLE_MAX_INSNS];
+    uint32_t ui32Insns;
+
+    /*
+     * Condition of the closing branch, 14 if it is unconditional.
+     */
+    uint32_t ui32Cond;
+
+    /*
+     * Index of the compare right before the closing branch or -1, whether
+     * it adds its operands (CMN, ADDS) rather than subtracting them, and
+     * whether the second operand is an immediate.
+     */
+    int32_t i32Compare;
+    bool bAdd;
+    bool bImmediate;
+
+    /*
+     * Set if every instruction computes an affine function of the registers
+     * and the words the loop stores, so a constant change per iteration
+     * stays constant.
+     */
+    bool bLinear;
+} tIdleBody;
+
+/*
+ * What the observed iterations saw: the address of every access, the words
+ * stored to, and the registers, stored words, flags and compare operands of
+ * each iteration.
+ */
+typedef struct
+{
+    uint32_t pui32Addr[SIM_IDLE_MAX_INSNS];
+    uint32_t pui32Store[SIM_IDLE_MAX_INSNS];
+    uint32_t ui32Stores;
+
+    uint32_t ppui32R[IDLE_RUNS][IDLE_REGS];
+    uint32_t ppui32Word[IDLE_RUNS][SIM_IDLE_MAX_INSNS];
+    uint32_t pui32Flags[IDLE_RUNS];
+    uint32_t pui32A[IDLE_RUNS];
+    uint32_t pui32B[IDLE_RUNS];
+    uint64_t pui64Cycle[IDLE_RUNS];
+} tIdleTrace;
+
+bool
+SimIdleInit(tSimMachine *psMachine)
+{
+    psMachine->psIdle = calloc(1, sizeof(tSimIdle));
+
+    return(psMachine->psIdle != NULL);
+}
+
+void
+SimIdleFree(tSimMachine *psMachine)
+{
+    free(psMachine->psIdle);
+    psMachine->psIdle = NULL;
+}
+
+/*
+ * Forgets the rejected loops, for use when code has changed.
+ */
+void
+SimIdleFlush(tSimMachine *psMachine)
+{
+    if(psMachine->psIdle)
+        memset(psMachine->psIdle->pui32Rejects, 0,
+               sizeof(psMachine->psIdle->pui32Rejects));
+}
+
+/*
+ * Returns true if a data-processing instruction is CMP, CMN, SUBS or ADDS
+ * with an immediate or a plain register other than the PC, which can
+ * close a loop whose exit is worked out.
+ */
+static bool
+IdleCompare(const tSimInsn *psInsn, bool *pbAdd, bool *pbImmediate)
+{
+    uint32_t ui32Op, ui32Kind;
+
+    if(!SimThumbDataProc(psInsn, &ui32Op, &ui32Kind) ||
+       (ui32Kind > DP_REG) || (psInsn->ui8S == THUMB_S_NEVER) ||
+       (psInsn->ui8Rn == 15) ||
+       ((ui32Kind == DP_REG) && (psInsn->ui8Rm == 15)))
+        return(false);
+
+    *pbImmediate = (ui32Kind == DP_IMM);
+
+    switch(ui32Op)
+    {
+        case DP_CMP:
+        case DP_SUB:
+            *pbAdd = false;
+            return(true);
+
+        case DP_CMN:
+        case DP_ADD:
+            *pbAdd = true;
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+/*
+ * Returns true for instructions whose result, if they write one, is an
+ * affine function of their operands.
+ */
+static bool
+IdleAffine(const tSimInsn *psInsn)
+{
+    uint32_t ui32Op, ui32Kind;
+
+    if(!SimThumbDataProc(psInsn, &ui32Op, &ui32Kind))
+        return(false);
+
+    if(ui32Kind > DP_REG)
+        return(false);
+
+    return((ui32Op == DP_ADD) || (ui32Op == DP_SUB) || (ui32Op == DP_RSB) ||
+           (ui32Op == DP_MOV) || (ui32Op == DP_MVN) || (ui32Op == DP_CMP) ||
+           (ui32Op == DP_CMN) || (ui32Op == DP_TST) || (ui32Op == DP_TEQ));
+}
+
+/*
+ * Returns true if an instruction computing registers leaves SP and PC
+ * alone.  The compare and test forms of data processing write nothing.
+ */
+static bool
+IdleRegisterSafe(const tSimInsn *psInsn)
+{
+    uint32_t ui32Op, ui32Kind;
+
+    if(SimThumbDataProc(psInsn, &ui32Op, &ui32Kind) && (ui32Op >= DP_TST) &&
+       (ui32Op <= DP_CMP))
+        return(true);
+
+    return((psInsn->ui8Rd != 13) && (psInsn->ui8Rd != 15));
+}
+
+/*
+ * Collects the body of the loop starting at ui32Head.  Returns false if it
+ * is not a straight run of suitable instructions closed by a branch back.
+ */
+static bool
+IdleDecode(tSimMachine *psMachine, uint32_t ui32Head, tIdleBody *psBody)
+{
+    const tSimInsn *psInsn;
+    uint32_t ui32PC = ui32Head, ui32Idx, ui32Cond, ui32Addr, ui32Size;
+    bool bLink, bStore, bStores = false, bNarrow = false;
+
+    psBody->ui32Insns = 0;
+    psBody->i32Compare = -1;
+    psBody->bLinear = true;
+
+    for(ui32Idx = 0; ui32Idx < SIM_IDLE_MAX_INSNS; ui32Idx++)
+    {
+        psInsn = SimCpuInsn(psMachine, ui32PC);
+
+        if(!psInsn ||
+           (psMachine->psDebug &&
+            SimDebugBreakpointAt(psMachine->psDebug, ui32PC)))
+            return(false);
+
+        psBody->ppsInsn[ui32Idx] = psInsn;
+        psBody->pui32PC[ui32Idx] = ui32PC;
+        psBody->ui32Insns++;
+
+        if(SimThumbDirectBranch(psInsn, &ui32Cond, &bLink))
+        {
+            if(bLink || (psInsn->ui32Imm != ui32Head))
+                return(false);
+
+            psBody->ui32Cond = ui32Cond;
+
+            if(ui32Idx &&
+               IdleCompare(psBody->ppsInsn[ui32Idx - 1], &psBody->bAdd,
+                           &psBody->bImmediate))
+                psBody->i32Compare = (int32_t)ui32Idx - 1;
+
+            /*
+             * Bytes and halfwords of a word the loop changes do not change
+             * by a constant amount.
+             */
+            if(bNarrow && bStores)
+                psBody->bLinear = false;
+
+            return(true);
+        }
+
+        if(SimThumbAccess(&psMachine->sCpu, psInsn, &ui32Addr, &ui32Size,
+                          &bStore))
+        {
+            if(!bStore && !IdleRegisterSafe(psInsn))
+                return(false);
+
+            bStores |= bStore;
+            bNarrow |= (ui32Size != 4);
+        }
+        else if(SimThumbPure(psInsn) && IdleRegisterSafe(psInsn))
+        {
+            if(!IdleAffine(psInsn))
+                psBody->bLinear = false;
+        }
+        else
+            return(false);
+
+        ui32PC += psInsn->ui8Size;
+    }
+
+    return(false);
+}
+
+/*
+ * Executes one instruction, as CpuExecute() does outside IT blocks.
+ */
+static void
+IdleStep(tSimMachine *psMachine, const tSimInsn *psInsn, uint32_t ui32PC)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    psCpu->ui32InsnPC = ui32PC;
+    psCpu->pui32R[15] = ui32PC + 4;
+    psCpu->ui32PC = ui32PC + psInsn->ui8Size;
+    psCpu->ui64Cycle++;
+    psCpu->ui64Insns++;
+
+    psInsn->pfnExec(psMachine, psInsn);
+
+    if(psMachine->psTiming)
+        SimTimingInsn(psMachine, psInsn, ui32PC + psInsn->ui8Size);
+}
+
+static uint32_t
+IdleFlags(const tSimCpu *psCpu)
+{
+    return((psCpu->ui8N << 3) | (psCpu->ui8Z << 2) | (psCpu->ui8C << 1) |
+           psCpu->ui8V);
+}
+
+/*
+ * Runs one iteration of the loop, checking every access before it is made.
+ * Returns IDLE_LATER if the loop was left.
+ */
+static tIdleResult
+IdleRun(tSimMachine *psMachine, const tIdleBody *psBody, tIdleTrace *psTrace,
+        uint32_t ui32Run)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimMemory *psMemory = &psMachine->sMemory;
+    const tSimInsn *psInsn;
+    uint32_t ui32Idx, ui32Addr, ui32Size, ui32Word;
+    bool bStore;
+
+    for(ui32Idx = 0; ui32Idx < psBody->ui32Insns; ui32Idx++)
+    {
+        psInsn = psBody->ppsInsn[ui32Idx];
+
+        if(SimThumbAccess(psCpu, psInsn, &ui32Addr, &ui32Size, &bStore))
+        {
+            if((ui32Addr & (ui32Size - 1)) ||
+               !SimMemoryOffset(bStore ? psMemory->pui32Write :
+                                         psMemory->pui32Read, ui32Addr))
+                return(IDLE_REJECT);
+
+            if(ui32Run && (psTrace->pui32Addr[ui32Idx] != ui32Addr))
+                return(IDLE_REJECT);
+
+            psTrace->pui32Addr[ui32Idx] = ui32Addr;
+
+            if(bStore && !ui32Run)
+            {
+                for(ui32Word = 0; ui32Word < psTrace->ui32Stores; ui32Word++)
+                    if(psTrace->pui32Store[ui32Word] == (ui32Addr & ~3U))
+                        break;
+
+                if(ui32Word == psTrace->ui32Stores)
+                    psTrace->pui32Store[psTrace->ui32Stores++] =
+                        ui32Addr & ~3U;
+            }
+        }
+
+        if((int32_t)ui32Idx == psBody->i32Compare)
+        {
+            psTrace->pui32A[ui32Run] = psCpu->pui32R[psInsn->ui8Rn];
+            psTrace->pui32B[ui32Run] = psBody->bImmediate ?
+                                       psInsn->ui32Imm :
+                                       psCpu->pui32R[psInsn->ui8Rm];
+        }
+
+        IdleStep(psMachine, psInsn, psBody->pui32PC[ui32Idx]);
+    }
+
+    if(psCpu->ui32PC != psBody->pui32PC[0])
+        return(IDLE_LATER);
+
+    memcpy(psTrace->ppui32R[ui32Run], psCpu->pui32R,
+           sizeof(psTrace->ppui32R[ui32Run]));
+
+    for(ui32Word = 0; ui32Word < psTrace->ui32Stores; ui32Word++)
+        SimMemoryRead(psMemory, psTrace->pui32Store[ui32Word], 4,
+                      &psTrace->ppui32Word[ui32Run][ui32Word]);
+
+    psTrace->pui32Flags[ui32Run] = IdleFlags(psCpu);
+    psTrace->pui64Cycle[ui32Run] = psCpu->ui64Cycle;
+
+    return(IDLE_OK);
+}
+
+/*
+ * Sets the flags as the closing compare does for the operands ui32A and
+ * ui32B and returns true if the closing branch is then taken.
+ */
+static bool
+IdleTaken(tSimCpu *psCpu, const tIdleBody *psBody, uint32_t ui32A,
+          uint32_t ui32B)
+{
+    uint32_t ui32Result;
+
+    if(psBody->bAdd)
+        ui32Result = ThumbAddWithCarry(ui32A, ui32B, 0, &psCpu->ui8C,
+                                       &psCpu->ui8V);
+    else
+        ui32Result = ThumbAddWithCarry(ui32A, ~ui32B, 1, &psCpu->ui8C,
+                                       &psCpu->ui8V);
+
+    ThumbSetNZ(psCpu, ui32Result);
+
+    return(ThumbCondition(psCpu, psBody->ui32Cond));
+}
+
+/*
+ * Returns the number of steps of ui32Step, taken as signed, after which
+ * ui32Value first moves into the other half of the unsigned range or wraps
+ * around, or UINT64_MAX if it stays put.
+ */
+static uint64_t
+IdleCrossing(uint32_t ui32Value, uint32_t ui32Step)
+{
+    int64_t i64Step = (int32_t)ui32Step;
+    uint64_t ui64Distance;
+
+    if(!i64Step)
+        return(UINT64_MAX);
+
+    if(i64Step > 0)
+    {
+        ui64Distance = ((ui32Value < 0x80000000U) ? 0x80000000ULL :
+                                                    0x100000000ULL) -
+                       ui32Value;
+
+        return((ui64Distance + (uint64_t)i64Step - 1) / (uint64_t)i64Step);
+    }
+
+    ui64Distance = (ui32Value >= 0x80000000U) ? ui32Value - 0x80000000U :
+                                                ui32Value;
+
+    return(ui64Distance / (uint64_t)-i64Step + 1);
+}
+
+/*
+ * Returns the number of steps after which ui32Value becomes or stops being
+ * zero without crossing a boundary IdleCrossing() looks for, or UINT64_MAX.
+ */
+static uint64_t
+IdleZero(uint32_t ui32Value, uint32_t ui32Step)
+{
+    int64_t i64Step = (int32_t)ui32Step;
+
+    if(!i64Step)
+        return(UINT64_MAX);
+
+    if(!ui32Value)
+        return(1);
+
+    if((i64Step < 0) && (ui32Value < 0x80000000U) &&
+       !(ui32Value % (uint64_t)-i64Step))
+        return(ui32Value / (uint64_t)-i64Step);
+
+    return(UINT64_MAX);
+}
+
+/*
+ * Returns the number of iterations, up to ui64Max, before the one that
+ * leaves the loop.  The operands of the closing compare are ui32A and ui32B
+ * in the next iteration and change by ui32StepA and ui32StepB in each.
+ *
+ * The flags only change when an operand or the result moves into the other
+ * half of the range, wraps around, or becomes or stops being zero, so the
+ * search hops from one such point to the next.
+ */
+static uint64_t
+IdleExit(const tIdleBody *psBody, uint32_t ui32A, uint32_t ui32StepA,
+         uint32_t ui32B, uint32_t ui32StepB, uint64_t ui64Max)
+{
+    uint32_t ui32Step, ui32Result, ui32StepResult;
+    uint64_t ui64Iter = 0, ui64Next, ui64Hop;
+    tSimCpu sFlags;
+
+    for(ui32Step = 0; ui32Step < IDLE_EXIT_STEPS; ui32Step++)
+    {
+        if(!IdleTaken(&sFlags, psBody, ui32A, ui32B))
+            return(ui64Iter);
+
+        ui32Result = psBody->bAdd ? ui32A + ui32B : ui32A - ui32B;
+        ui32StepResult = psBody->bAdd ? ui32StepA + ui32StepB :
+                                        ui32StepA - ui32StepB;
+
+        ui64Next = IdleCrossing(ui32A, ui32StepA);
+
+        if((ui64Hop = IdleCrossing(ui32B, ui32StepB)) < ui64Next)
+            ui64Next = ui64Hop;
+
+        if((ui64Hop = IdleCrossing(ui32Result, ui32StepResult)) < ui64Next)
+            ui64Next = ui64Hop;
+
+        if((ui64Hop = IdleZero(ui32Result, ui32StepResult)) < ui64Next)
+            ui64Next = ui64Hop;
+
+        if(ui64Next >= ui64Max - ui64Iter)
+            return(ui64Max);
+
+        ui64Iter += ui64Next;
+        ui32A += (uint32_t)ui64Next * ui32StepA;
+        ui32B += (uint32_t)ui64Next * ui32StepB;
+    }
+
+    return(ui64Iter);
+}
+
+/*
+ * Observes the loop at the PC and skips the iterations it can.
+ */
+static tIdleResult
+IdleExamine(tSimMachine *psMachine)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimIdle *psIdle = psMachine->psIdle;
+    tIdleBody sBody;
+    tIdleTrace sTrace;
+    tIdleResult eResult;
+    uint32_t pui32Delta[IDLE_REGS], pui32WordDelta[SIM_IDLE_MAX_INSNS];
+    uint32_t ui32Run, ui32Idx, ui32StepA, ui32StepB;
+    uint64_t ui64Max, ui64Skip, ui64Period;
+    bool bStill = true, bSteady = true;
+
+    if(psCpu->ui32IT || !IdleDecode(psMachine, psCpu->ui32PC, &sBody))
+        return(IDLE_REJECT);
+
+    /*
+     * The observed iterations must end before the slice does, as they are
+     * not interrupted.
+     */
+    if(psCpu->ui64Cycle + (IDLE_RUNS + 1) * sBody.ui32Insns *
+       (psMachine->psTiming ? SIM_TIMING_MAX_CYCLES : 1) >= psCpu->ui64Limit)
+        return(IDLE_LATER);
+
+    memset(&sTrace, 0, sizeof(sTrace));
+
+    for(ui32Run = 0; ui32Run < IDLE_RUNS; ui32Run++)
+        if((eResult = IdleRun(psMachine, &sBody, &sTrace, ui32Run)) !=
+           IDLE_OK)
+            return(eResult);
+
+    for(ui32Idx = 0; ui32Idx < IDLE_REGS; ui32Idx++)
+    {
+        pui32Delta[ui32Idx] = sTrace.ppui32R[2][ui32Idx] -
+                              sTrace.ppui32R[1][ui32Idx];
+        bStill &= !pui32Delta[ui32Idx];
+        bSteady &= (sTrace.ppui32R[1][ui32Idx] - sTrace.ppui32R[0][ui32Idx] ==
+                    pui32Delta[ui32Idx]);
+    }
+
+    for(ui32Idx = 0; ui32Idx < sTrace.ui32Stores; ui32Idx++)
+    {
+        pui32WordDelta[ui32Idx] = sTrace.ppui32Word[2][ui32Idx] -
+                                  sTrace.ppui32Word[1][ui32Idx];
+        bStill &= !pui32WordDelta[ui32Idx];
+        bSteady &= (sTrace.ppui32Word[1][ui32Idx] -
+                    sTrace.ppui32Word[0][ui32Idx] == pui32WordDelta[ui32Idx]);
+    }
+
+    /*
+     * An iteration takes a cycle per instruction, or as many as the timing
+     * model charged for the last two, which must agree.
+     */
+    ui64Period = sTrace.pui64Cycle[2] - sTrace.pui64Cycle[1];
+
+    if(ui64Period != sTrace.pui64Cycle[1] - sTrace.pui64Cycle[0])
+        return(IDLE_REJECT);
+
+    ui64Max = (psCpu->ui64Limit - psCpu->ui64Cycle) / ui64Period;
+
+    if(bStill && (sTrace.pui32Flags[1] == sTrace.pui32Flags[2]))
+    {
+        /*
+         * Every iteration is the same as the last: the loop only ends when
+         * an interrupt changes something.
+         */
+        ui64Skip = ui64Max;
+    }
+    else if(!bSteady || !sBody.bLinear)
+    {
+        return(IDLE_REJECT);
+    }
+    else if(sBody.ui32Cond == 14)
+    {
+        ui64Skip = ui64Max;
+    }
+    else
+    {
+        if(sBody.i32Compare < 0)
+            return(IDLE_REJECT);
+
+        ui32StepA = sTrace.pui32A[2] - sTrace.pui32A[1];
+        ui32StepB = sTrace.pui32B[2] - sTrace.pui32B[1];
+
+        if((sTrace.pui32A[1] - sTrace.pui32A[0] != ui32StepA) ||
+           (sTrace.pui32B[1] - sTrace.pui32B[0] != ui32StepB) ||
+           (ui32StepA && ui32StepB))
+            return(IDLE_REJECT);
+
+        ui64Skip = IdleExit(&sBody, sTrace.pui32A[2] + ui32StepA, ui32StepA,
+                            sTrace.pui32B[2] + ui32StepB, ui32StepB,
+                            ui64Max);
+
+        /*
+         * The flags are left as the last skipped compare set them.
+         */
+        if(ui64Skip)
+            IdleTaken(psCpu, &sBody,
+                      sTrace.pui32A[2] + (uint32_t)ui64Skip * ui32StepA,
+                      sTrace.pui32B[2] + (uint32_t)ui64Skip * ui32StepB);
+    }
+
+    if(!ui64Skip)
+        return(IDLE_OK);
+
+    for(ui32Idx = 0; ui32Idx < IDLE_REGS; ui32Idx++)
+        psCpu->pui32R[ui32Idx] += (uint32_t)ui64Skip * pui32Delta[ui32Idx];
+
+    for(ui32Idx = 0; ui32Idx < sTrace.ui32Stores; ui32Idx++)
+        SimMemoryWrite(&psMachine->sMemory, sTrace.pui32Store[ui32Idx], 4,
+                       sTrace.ppui32Word[2][ui32Idx] +
+                       (uint32_t)ui64Skip * pui32WordDelta[ui32Idx]);
+
+    psCpu->ui64Cycle += ui64Skip * ui64Period;
+    psIdle->ui64Skips++;
+    psIdle->ui64Cycles += ui64Skip * ui64Period;
+
+    return(IDLE_OK);
+}
+
+/*
+ * Looks at the loop at the PC once it has gone round SIM_IDLE_TRIGGER times,
+ * unless it was found not to be idle before.
+ */
+void
+SimIdleLoop(tSimMachine *psMachine)
+{
+    tSimIdle *psIdle = psMachine->psIdle;
+    uint32_t ui32Head = psMachine->sCpu.ui32PC;
+    uint32_t *pui32Reject;
+
+    pui32Reject = &psIdle->pui32Rejects[(ui32Head / 2) % SIM_IDLE_REJECTS];
+    psIdle->ui32Count = 0;
+
+    if(*pui32Reject == ui32Head)
+        return;
+
+    if(IdleExamine(psMachine) == IDLE_REJECT)
+        *pui32Reject = ui32Head;
+}
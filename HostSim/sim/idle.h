@@ -0,0 +1,74 @@
+#ifndef __SIM_IDLE_H__
+#define __SIM_IDLE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpu.h"
+
+/*
+ * Fast-forwarding of idle loops.  A short loop that keeps branching back to
+ * the same head is run for a few iterations under observation.  If every
+ * iteration leaves the machine as it found it, as in `while(1) {}` or a
+ * loop polling a flag an interrupt handler sets, nothing can change before
+ * the next board event and the iterations up to it are skipped.  If the
+ * registers and memory words it changes move by the same amount every
+ * iteration, as in SysCtlDelay() or a counter loop, the iteration that
+ * leaves the loop is worked out from the compare that closes it and the
+ * iterations before it are skipped, up to the next board event.
+ *
+ * Skipped iterations are charged their cycles but are not counted as
+ * executed instructions.
+ */
+#define SIM_IDLE_MAX_INSNS      16
+#define SIM_IDLE_MAX_BYTES      (SIM_IDLE_MAX_INSNS * 4)
+
+/*
+ * Iterations a loop runs before it is looked at, and the size of the table
+ * of loops found not to be idle.
+ */
+#define SIM_IDLE_TRIGGER        8
+#define SIM_IDLE_REJECTS        64
+
+struct tSimIdle
+{
+    /*
+     * Head of the loop last branched back to and the number of times in a
+     * row it was.
+     */
+    uint32_t ui32Head;
+    uint32_t ui32Count;
+
+    /*
+     * Heads of rejected loops, by address.
+     */
+    uint32_t pui32Rejects[SIM_IDLE_REJECTS];
+
+    uint64_t ui64Skips;
+    uint64_t ui64Cycles;
+};
+
+bool SimIdleInit(tSimMachine *psMachine);
+void SimIdleFree(tSimMachine *psMachine);
+void SimIdleFlush(tSimMachine *psMachine);
+void SimIdleLoop(tSimMachine *psMachine);
+
+/*
+ * Called after a branch back to a nearby address, with the PC at the
+ * target.
+ */
+static inline void
+SimIdleBranch(tSimMachine *psMachine)
+{
+    tSimIdle *psIdle = psMachine->psIdle;
+
+    if(psIdle->ui32Head != psMachine->sCpu.ui32PC)
+    {
+        psIdle->ui32Head = psMachine->sCpu.ui32PC;
+        psIdle->ui32Count = 0;
+    }
+    else if(++psIdle->ui32Count == SIM_IDLE_TRIGGER)
+        SimIdleLoop(psMachine);
+}
+
+#endif
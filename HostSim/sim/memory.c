@@ -0,0 +1,155 @@
+/*
+ * Flash and SRAM of the simulated microcontroller.
+ */
+#include <string.h>
+
+#include "memory.h"
+
+void
+SimMemoryInit(tSimMemory *psMemory)
+{
+    uint32_t ui32Page;
+
+    memset(psMemory, 0, sizeof(*psMemory));
+
+    /*
+     * Erased flash reads as all ones.
+     */
+    memset(psMemory->pui8Arena, 0xFF, SIM_FLASH_SIZE);
+
+    for(ui32Page = 0; ui32Page < SIM_FLASH_SIZE / SIM_MEM_PAGE_SIZE;
+        ui32Page++)
+        psMemory->pui32Read[SimMemoryPage(SIM_FLASH_BASE +
+                                          ui32Page * SIM_MEM_PAGE_SIZE)] =
+            ui32Page * SIM_MEM_PAGE_SIZE + 1;
+
+    for(ui32Page = 0; ui32Page < SIM_SRAM_SIZE / SIM_MEM_PAGE_SIZE;
+        ui32Page++)
+    {
+        int32_t i32Page = SimMemoryPage(SIM_SRAM_BASE +
+                                        ui32Page * SIM_MEM_PAGE_SIZE);
+
+        psMemory->pui32Read[i32Page] = SIM_MEM_SRAM_OFFSET +
+                                       ui32Page * SIM_MEM_PAGE_SIZE + 1;
+        psMemory->pui32Write[i32Page] = psMemory->pui32Read[i32Page];
+    }
+}
+
+/*
+ * Copies an image into flash or SRAM, as a programmer or debugger would.
+ * Returns false if part of the range is not backed by memory.
+ */
+bool
+SimMemoryLoad(tSimMemory *psMemory, uint32_t ui32Addr, const void *pvData,
+              uint32_t ui32Size)
+{
+    const uint8_t *pui8Data = pvData;
+    uint32_t ui32Offset;
+
+    while(ui32Size--)
+    {
+        ui32Offset = SimMemoryOffset(psMemory->pui32Read, ui32Addr++);
+
+        if(!ui32Offset)
+            return(false);
+
+        psMemory->pui8Arena[ui32Offset - 1] = *pui8Data++;
+        psMemory->pui8Dirty[(ui32Offset - 1) >> SIM_MEM_PAGE_SHIFT] = 1;
+    }
+
+    return(true);
+}
+
+/*
+ * Sends writes to an SRAM page through the slow path, or lets them take the
+ * fast path again.  Flash is never writable through the fast path.
+ */
+void
+SimMemoryProtect(tSimMemory *psMemory, uint32_t ui32Addr, bool bProtect)
+{
+    int32_t i32Page = SimMemoryPage(ui32Addr);
+    uint32_t ui32Arena;
+
+    if((i32Page < 0) || (ui32Addr < SIM_SRAM_BASE) ||
+       (ui32Addr >= SIM_SRAM_BASE + SIM_SRAM_SIZE))
+        return;
+
+    ui32Arena = (psMemory->pui32Read[i32Page] - 1) >> SIM_MEM_PAGE_SHIFT;
+    psMemory->pui8Code[ui32Arena] = bProtect;
+
+    if(bProtect || psMemory->pui8Dirty[ui32Arena])
+        psMemory->pui32Write[i32Page] =
+            (bProtect || psMemory->pui8Watch[ui32Arena]) ? 0 :
+            psMemory->pui32Read[i32Page];
+}
+
+/*
+ * Keeps writes to the SRAM page holding an address on the slow path while a
+ * debugger watches it, or lets them take the fast path again.
+ */
+void
+SimMemoryWatch(tSimMemory *psMemory, uint32_t ui32Addr, bool bWatch)
+{
+    int32_t i32Page = SimMemoryPage(ui32Addr);
+    uint32_t ui32Arena;
+
+    if((i32Page < 0) || (ui32Addr < SIM_SRAM_BASE) ||
+       (ui32Addr >= SIM_SRAM_BASE + SIM_SRAM_SIZE))
+        return;
+
+    ui32Arena = (psMemory->pui32Read[i32Page] - 1) >> SIM_MEM_PAGE_SHIFT;
+    psMemory->pui8Watch[ui32Arena] = bWatch;
+
+    if(bWatch || psMemory->pui8Dirty[ui32Arena])
+        psMemory->pui32Write[i32Page] =
+            (bWatch || psMemory->pui8Code[ui32Arena]) ? 0 :
+            psMemory->pui32Read[i32Page];
+}
+
+/*
+ * Starts marking the pages written from now on, forgetting the pages marked
+ * so far.
+ */
+void
+SimMemoryTrack(tSimMemory *psMemory)
+{
+    uint32_t ui32Page;
+
+    memset(psMemory->pui8Dirty, 0, sizeof(psMemory->pui8Dirty));
+
+    for(ui32Page = 0; ui32Page < SIM_SRAM_SIZE / SIM_MEM_PAGE_SIZE;
+        ui32Page++)
+        psMemory->pui32Write[SimMemoryPage(SIM_SRAM_BASE +
+                                           ui32Page * SIM_MEM_PAGE_SIZE)] = 0;
+}
+
+/*
+ * Marks the page holding an address as written, called from the slow path
+ * of writes.  An SRAM page written for the first time takes the fast path
+ * again unless it holds decoded instructions or is watched.
+ */
+void
+SimMemoryTouch(tSimMemory *psMemory, uint32_t ui32Addr)
+{
+    int32_t i32Page = SimMemoryPage(ui32Addr);
+    uint32_t ui32Arena;
+
+    if((i32Page < 0) || !psMemory->pui32Read[i32Page])
+        return;
+
+    ui32Arena = (psMemory->pui32Read[i32Page] - 1) >> SIM_MEM_PAGE_SHIFT;
+    psMemory->pui8Dirty[ui32Arena] = 1;
+
+    if((ui32Addr >= SIM_SRAM_BASE) && !psMemory->pui8Code[ui32Arena] &&
+       !psMemory->pui8Watch[ui32Arena])
+        psMemory->pui32Write[i32Page] = psMemory->pui32Read[i32Page];
+}
+
+bool
+SimMemoryProtected(const tSimMemory *psMemory, uint32_t ui32Addr)
+{
+    int32_t i32Page = SimMemoryPage(ui32Addr);
+
+    return((i32Page >= 0) && psMemory->pui32Read[i32Page] &&
+           !psMemory->pui32Write[i32Page]);
+}
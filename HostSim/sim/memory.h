@@ -0,0 +1,165 @@
+#ifndef __SIM_MEMORY_H__
+#define __SIM_MEMORY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*
+ * On-chip memories of the TM4C123GH6PM, laid out as in tm4c123gh6pm.lds.
+ */
+#define SIM_FLASH_BASE          0x00000000U
+#define SIM_FLASH_SIZE          0x00040000U
+#define SIM_SRAM_BASE           0x20000000U
+#define SIM_SRAM_SIZE           0x00008000U
+
+#define SIM_MEM_ARENA_SIZE      (SIM_FLASH_SIZE + SIM_SRAM_SIZE)
+#define SIM_MEM_SRAM_OFFSET     SIM_FLASH_SIZE
+
+/*
+ * The page tables cover the first megabyte of the code and SRAM regions in
+ * 4 KB pages.  An entry holds the offset of the page in the arena plus one,
+ * or zero if accesses to the page take the slow path: unmapped pages, writes
+ * to flash and writes to SRAM pages holding decoded instructions.
+ */
+#define SIM_MEM_PAGE_SHIFT      12
+#define SIM_MEM_PAGE_SIZE       (1U << SIM_MEM_PAGE_SHIFT)
+#define SIM_MEM_PAGES           512
+#define SIM_MEM_WINDOW_MASK     0xDFF00000U
+#define SIM_MEM_ARENA_PAGES     (SIM_MEM_ARENA_SIZE / SIM_MEM_PAGE_SIZE)
+
+/*
+ * pui8Dirty marks the pages of the arena written since SimMemoryTrack() was
+ * last called, for copying back only those from a snapshot (see
+ * snapshot.h).  While tracking, the first write to an SRAM page takes the
+ * slow path to mark it.  pui8Code marks the SRAM pages kept on the slow path
+ * because they hold decoded instructions, pui8Watch those kept there because
+ * a debugger watches writes to them (see debug.h).
+ */
+typedef struct
+{
+    uint32_t pui32Read[SIM_MEM_PAGES];
+    uint32_t pui32Write[SIM_MEM_PAGES];
+    uint8_t pui8Dirty[SIM_MEM_ARENA_PAGES];
+    uint8_t pui8Code[SIM_MEM_ARENA_PAGES];
+    uint8_t pui8Watch[SIM_MEM_ARENA_PAGES];
+    uint8_t pui8Arena[SIM_MEM_ARENA_SIZE];
+} tSimMemory;
+
+void SimMemoryInit(tSimMemory *psMemory);
+bool SimMemoryLoad(tSimMemory *psMemory, uint32_t ui32Addr,
+                   const void *pvData, uint32_t ui32Size);
+void SimMemoryProtect(tSimMemory *psMemory, uint32_t ui32Addr, bool bProtect);
+bool SimMemoryProtected(const tSimMemory *psMemory, uint32_t ui32Addr);
+void SimMemoryWatch(tSimMemory *psMemory, uint32_t ui32Addr, bool bWatch);
+void SimMemoryTrack(tSimMemory *psMemory);
+void SimMemoryTouch(tSimMemory *psMemory, uint32_t ui32Addr);
+
+/*
+ * Returns the page table index of an address, or -1 if the address lies
+ * outside the windows covered by the tables.
+ */
+static inline int32_t
+SimMemoryPage(uint32_t ui32Addr)
+{
+    if(ui32Addr & SIM_MEM_WINDOW_MASK)
+        return(-1);
+
+    return((int32_t)(((ui32Addr >> 21) & 0x100) |
+                     ((ui32Addr >> SIM_MEM_PAGE_SHIFT) & 0xFF)));
+}
+
+/*
+ * Returns the arena offset of an address plus one, or zero if the address is
+ * not backed by flash or SRAM.
+ */
+static inline uint32_t
+SimMemoryOffset(const uint32_t *pui32Table, uint32_t ui32Addr)
+{
+    int32_t i32Page = SimMemoryPage(ui32Addr);
+    uint32_t ui32Base;
+
+    if(i32Page < 0)
+        return(0);
+
+    ui32Base = pui32Table[i32Page];
+
+    return(ui32Base ? ui32Base + (ui32Addr & (SIM_MEM_PAGE_SIZE - 1)) : 0);
+}
+
+/*
+ * Fast paths for naturally contained accesses.  They return false if the
+ * access has to go through the slow path.
+ */
+static inline bool
+SimMemoryRead(const tSimMemory *psMemory, uint32_t ui32Addr,
+              uint32_t ui32Size, uint32_t *pui32Value)
+{
+    uint32_t ui32Offset = SimMemoryOffset(psMemory->pui32Read, ui32Addr);
+    const uint8_t *pui8Data;
+
+    if(!ui32Offset ||
+       ((ui32Addr & (SIM_MEM_PAGE_SIZE - 1)) > SIM_MEM_PAGE_SIZE - ui32Size))
+        return(false);
+
+    pui8Data = psMemory->pui8Arena + ui32Offset - 1;
+
+    switch(ui32Size)
+    {
+        case 1:
+            *pui32Value = *pui8Data;
+            break;
+
+        case 2:
+        {
+            uint16_t ui16Value;
+
+            memcpy(&ui16Value, pui8Data, 2);
+            *pui32Value = ui16Value;
+            break;
+        }
+
+        default:
+            memcpy(pui32Value, pui8Data, 4);
+            break;
+    }
+
+    return(true);
+}
+
+static inline bool
+SimMemoryWrite(tSimMemory *psMemory, uint32_t ui32Addr, uint32_t ui32Size,
+               uint32_t ui32Value)
+{
+    uint32_t ui32Offset = SimMemoryOffset(psMemory->pui32Write, ui32Addr);
+    uint8_t *pui8Data;
+
+    if(!ui32Offset ||
+       ((ui32Addr & (SIM_MEM_PAGE_SIZE - 1)) > SIM_MEM_PAGE_SIZE - ui32Size))
+        return(false);
+
+    pui8Data = psMemory->pui8Arena + ui32Offset - 1;
+
+    switch(ui32Size)
+    {
+        case 1:
+            *pui8Data = (uint8_t)ui32Value;
+            break;
+
+        case 2:
+        {
+            uint16_t ui16Value = (uint16_t)ui32Value;
+
+            memcpy(pui8Data, &ui16Value, 2);
+            break;
+        }
+
+        default:
+            memcpy(pui8Data, &ui32Value, 4);
+            break;
+    }
+
+    return(true);
+}
+
+#endif
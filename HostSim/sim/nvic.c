@@ -0,0 +1,570 @@
+/*
+ * Nested vectored interrupt controller and system control block.
+ */
+#include <string.h>
+
+#include "board.h"
+
+/*
+ * Register offsets within the system control space (0xE000E000).
+ */
+#define NVIC_O_ICTR         0x004
+#define NVIC_O_ACTLR        0x008
+#define NVIC_O_ISER         0x100
+#define NVIC_O_ICER         0x180
+#define NVIC_O_ISPR         0x200
+#define NVIC_O_ICPR         0x280
+#define NVIC_O_IABR         0x300
+#define NVIC_O_IPR          0x400
+#define NVIC_O_CPUID        0xD00
+#define NVIC_O_ICSR         0xD04
+#define NVIC_O_VTOR         0xD08
+#define NVIC_O_AIRCR        0xD0C
+#define NVIC_O_SCR          0xD10
+#define NVIC_O_CCR          0xD14
+#define NVIC_O_SHPR1        0xD18
+#define NVIC_O_SHPR3        0xD20
+#define NVIC_O_SHCSR        0xD24
+#define NVIC_O_CFSR         0xD28
+#define NVIC_O_HFSR         0xD2C
+#define NVIC_O_MMFAR        0xD34
+#define NVIC_O_BFAR         0xD38
+#define NVIC_O_CPACR        0xD88
+#define NVIC_O_STIR         0xF00
+#define NVIC_O_FPCCR        0xF34
+#define NVIC_O_FPCAR        0xF38
+#define NVIC_O_FPDSCR       0xF3C
+
+#define NVIC_CPUID          0x410FC241U
+#define NVIC_VECTKEY        0x05FAU
+
+#define ICSR_NMIPENDSET     (1U << 31)
+#define ICSR_PENDSVSET      (1U << 28)
+#define ICSR_PENDSVCLR      (1U << 27)
+#define ICSR_PENDSTSET      (1U << 26)
+#define ICSR_PENDSTCLR      (1U << 25)
+#define ICSR_ISRPENDING     (1U << 22)
+#define ICSR_RETTOBASE      (1U << 11)
+
+#define AIRCR_SYSRESETREQ   (1U << 2)
+
+static void
+MapSet(uint32_t *pui32Map, uint32_t ui32Exc, bool bSet)
+{
+    if(bSet)
+        pui32Map[ui32Exc / 32] |= 1U << (ui32Exc % 32);
+    else
+        pui32Map[ui32Exc / 32] &= ~(1U << (ui32Exc % 32));
+}
+
+/*
+ * Makes an exception pending, noting when it became so.
+ */
+static void
+NVICPend(tSimNVIC *psNVIC, uint32_t ui32Exc)
+{
+    if(!SimNVICBit(psNVIC->pui32Pending, ui32Exc))
+        psNVIC->pui64Pended[ui32Exc] = psNVIC->ui64Now;
+
+    MapSet(psNVIC->pui32Pending, ui32Exc, true);
+}
+
+/*
+ * Returns 32 bits of an exception indexed bitmap starting at IRQ 32 * n.
+ */
+static uint32_t
+MapIRQWord(const uint32_t *pui32Map, uint32_t ui32Word)
+{
+    uint32_t ui32Value = pui32Map[ui32Word] >> 16;
+
+    if(ui32Word + 1 < SIM_NVIC_WORDS)
+        ui32Value |= pui32Map[ui32Word + 1] << 16;
+
+    return(ui32Value);
+}
+
+void
+SimNVICReset(tSimNVIC *psNVIC)
+{
+    memset(psNVIC, 0, sizeof(*psNVIC));
+
+    psNVIC->ui32CCR = 0x00000200U;
+    psNVIC->ui32FPCCR = 0xC0000000U;
+
+    /*
+     * The system exceptions cannot be disabled in the NVIC; the configurable
+     * faults are gated by SHCSR instead.
+     */
+    psNVIC->pui32Enable[0] = 0x0000FFFCU;
+}
+
+int32_t
+SimNVICPriority(const tSimNVIC *psNVIC, uint32_t ui32Exc)
+{
+    switch(ui32Exc)
+    {
+        case SIM_EXC_RESET:
+            return(-3);
+
+        case SIM_EXC_NMI:
+            return(-2);
+
+        case SIM_EXC_HARDFAULT:
+            return(-1);
+
+        default:
+            return(psNVIC->pui8Priority[ui32Exc]);
+    }
+}
+
+int32_t
+SimNVICGroupPriority(const tSimNVIC *psNVIC, int32_t i32Priority)
+{
+    if(i32Priority < 0)
+        return(i32Priority);
+
+    return(i32Priority & (int32_t)(0xFFU << (psNVIC->ui32PriGroup + 1)) &
+           0xFF);
+}
+
+int32_t
+SimNVICExecPriority(const tSimNVIC *psNVIC, bool bPrimask,
+                    uint32_t ui32BasePri, bool bFaultMask)
+{
+    int32_t i32Prio = SIM_NVIC_THREAD_PRIO;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < psNVIC->ui32Depth; ui32Idx++)
+    {
+        int32_t i32Group =
+            SimNVICGroupPriority(psNVIC,
+                                 SimNVICPriority(psNVIC,
+                                                 psNVIC->pui8Stack[ui32Idx]));
+
+        if(i32Group < i32Prio)
+            i32Prio = i32Group;
+    }
+
+    if(ui32BasePri && (SimNVICGroupPriority(psNVIC, ui32BasePri) < i32Prio))
+        i32Prio = SimNVICGroupPriority(psNVIC, ui32BasePri);
+
+    if(bPrimask && (i32Prio > 0))
+        i32Prio = 0;
+
+    if(bFaultMask && (i32Prio > -1))
+        i32Prio = -1;
+
+    return(i32Prio);
+}
+
+uint32_t
+SimNVICPendingException(const tSimNVIC *psNVIC, int32_t i32ExecPriority)
+{
+    uint32_t ui32Best = 0, ui32Word;
+    int32_t i32BestPrio = SIM_NVIC_THREAD_PRIO;
+
+    for(ui32Word = 0; ui32Word < SIM_NVIC_WORDS; ui32Word++)
+    {
+        uint32_t ui32Ready = psNVIC->pui32Pending[ui32Word] &
+                             psNVIC->pui32Enable[ui32Word];
+
+        while(ui32Ready)
+        {
+            uint32_t ui32Exc = ui32Word * 32 + __builtin_ctz(ui32Ready);
+            int32_t i32Prio = SimNVICPriority(psNVIC, ui32Exc);
+
+            ui32Ready &= ui32Ready - 1;
+
+            /*
+             * Ties go to the lowest exception number, which is the first one
+             * found.
+             */
+            if(i32Prio < i32BestPrio)
+            {
+                ui32Best = ui32Exc;
+                i32BestPrio = i32Prio;
+            }
+        }
+    }
+
+    if(!ui32Best ||
+       (SimNVICGroupPriority(psNVIC, i32BestPrio) >= i32ExecPriority))
+        return(0);
+
+    return(ui32Best);
+}
+
+void
+SimNVICSetPending(tSimNVIC *psNVIC, uint32_t ui32Exc)
+{
+    NVICPend(psNVIC, ui32Exc);
+}
+
+void
+SimNVICClearPending(tSimNVIC *psNVIC, uint32_t ui32Exc)
+{
+    MapSet(psNVIC->pui32Pending, ui32Exc, false);
+}
+
+void
+SimNVICEnable(tSimNVIC *psNVIC, uint32_t ui32Exc, bool bEnable)
+{
+    MapSet(psNVIC->pui32Enable, ui32Exc, bEnable);
+}
+
+void
+SimNVICSetLine(tSimNVIC *psNVIC, uint32_t ui32Exc, bool bLevel)
+{
+    MapSet(psNVIC->pui32Level, ui32Exc, bLevel);
+
+    /*
+     * Peripheral interrupts are level sensitive: an asserted line keeps the
+     * interrupt pending unless it is already being serviced.
+     */
+    if(bLevel && !SimNVICBit(psNVIC->pui32Active, ui32Exc))
+        NVICPend(psNVIC, ui32Exc);
+}
+
+void
+SimNVICActivate(tSimNVIC *psNVIC, uint32_t ui32Exc)
+{
+    MapSet(psNVIC->pui32Pending, ui32Exc, false);
+    MapSet(psNVIC->pui32Active, ui32Exc, true);
+
+    if(psNVIC->ui32Depth < SIM_NVIC_DEPTH)
+        psNVIC->pui8Stack[psNVIC->ui32Depth++] = (uint8_t)ui32Exc;
+}
+
+void
+SimNVICDeactivate(tSimNVIC *psNVIC, uint32_t ui32Exc)
+{
+    uint32_t ui32Idx;
+
+    MapSet(psNVIC->pui32Active, ui32Exc, false);
+
+    for(ui32Idx = psNVIC->ui32Depth; ui32Idx > 0; ui32Idx--)
+    {
+        if(psNVIC->pui8Stack[ui32Idx - 1] == ui32Exc)
+        {
+            memmove(&psNVIC->pui8Stack[ui32Idx - 1],
+                    &psNVIC->pui8Stack[ui32Idx],
+                    psNVIC->ui32Depth - ui32Idx);
+            psNVIC->ui32Depth--;
+            break;
+        }
+    }
+
+    /*
+     * A level sensitive source that is still asserted pends again.
+     */
+    if(SimNVICBit(psNVIC->pui32Level, ui32Exc))
+        NVICPend(psNVIC, ui32Exc);
+}
+
+static uint32_t
+NVICReadICSR(const tSimNVIC *psNVIC)
+{
+    uint32_t ui32Value = SimNVICCurrent(psNVIC);
+    uint32_t ui32Pending = SimNVICPendingException(psNVIC,
+                                                   SIM_NVIC_THREAD_PRIO + 1);
+    uint32_t ui32Word;
+
+    ui32Value |= (ui32Pending & 0xFF) << 12;
+
+    if(psNVIC->ui32Depth <= 1)
+        ui32Value |= ICSR_RETTOBASE;
+
+    for(ui32Word = 0; ui32Word < SIM_NVIC_WORDS; ui32Word++)
+    {
+        if(MapIRQWord(psNVIC->pui32Pending, ui32Word))
+            ui32Value |= ICSR_ISRPENDING;
+    }
+
+    if(SimNVICBit(psNVIC->pui32Pending, SIM_EXC_NMI))
+        ui32Value |= ICSR_NMIPENDSET;
+
+    if(SimNVICBit(psNVIC->pui32Pending, SIM_EXC_PENDSV))
+        ui32Value |= ICSR_PENDSVSET;
+
+    if(SimNVICBit(psNVIC->pui32Pending, SIM_EXC_SYSTICK))
+        ui32Value |= ICSR_PENDSTSET;
+
+    return(ui32Value);
+}
+
+uint32_t
+SimNVICRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek)
+{
+    tSimNVIC *psNVIC = &psBoard->sNVIC;
+    uint32_t ui32Value = 0, ui32Idx;
+
+    (void)bPeek;
+
+    if((ui32Offset >= NVIC_O_ISER) && (ui32Offset < NVIC_O_ISER + 0x20))
+        return(MapIRQWord(psNVIC->pui32Enable, (ui32Offset & 0x1F) / 4));
+
+    if((ui32Offset >= NVIC_O_ICER) && (ui32Offset < NVIC_O_ICER + 0x20))
+        return(MapIRQWord(psNVIC->pui32Enable, (ui32Offset & 0x1F) / 4));
+
+    if((ui32Offset >= NVIC_O_ISPR) && (ui32Offset < NVIC_O_ISPR + 0x20))
+        return(MapIRQWord(psNVIC->pui32Pending, (ui32Offset & 0x1F) / 4));
+
+    if((ui32Offset >= NVIC_O_ICPR) && (ui32Offset < NVIC_O_ICPR + 0x20))
+        return(MapIRQWord(psNVIC->pui32Pending, (ui32Offset & 0x1F) / 4));
+
+    if((ui32Offset >= NVIC_O_IABR) && (ui32Offset < NVIC_O_IABR + 0x20))
+        return(MapIRQWord(psNVIC->pui32Active, (ui32Offset & 0x1F) / 4));
+
+    if((ui32Offset >= NVIC_O_IPR) &&
+       (ui32Offset < NVIC_O_IPR + SIM_NVIC_IRQS))
+    {
+        for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+        {
+            uint32_t ui32Exc = 16 + ui32Offset - NVIC_O_IPR + ui32Idx;
+
+            if(ui32Exc < SIM_NVIC_EXCEPTIONS)
+                ui32Value |= (uint32_t)psNVIC->pui8Priority[ui32Exc] <<
+                             (ui32Idx * 8);
+        }
+
+        return(ui32Value);
+    }
+
+    if((ui32Offset >= NVIC_O_SHPR1) && (ui32Offset <= NVIC_O_SHPR3))
+    {
+        for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+            ui32Value |= (uint32_t)psNVIC->pui8Priority[4 + ui32Offset -
+                                                        NVIC_O_SHPR1 +
+                                                        ui32Idx] <<
+                         (ui32Idx * 8);
+
+        return(ui32Value);
+    }
+
+    switch(ui32Offset)
+    {
+        case NVIC_O_ICTR:
+            return((SIM_NVIC_IRQS + 31) / 32 - 1);
+
+        case NVIC_O_ACTLR:
+            return(psNVIC->ui32ACTLR);
+
+        case NVIC_O_CPUID:
+            return(NVIC_CPUID);
+
+        case NVIC_O_ICSR:
+            return(NVICReadICSR(psNVIC));
+
+        case NVIC_O_VTOR:
+            return(psNVIC->ui32VTOR);
+
+        case NVIC_O_AIRCR:
+            return(0xFA050000U | (psNVIC->ui32PriGroup << 8));
+
+        case NVIC_O_SCR:
+            return(psNVIC->ui32SCR);
+
+        case NVIC_O_CCR:
+            return(psNVIC->ui32CCR);
+
+        case NVIC_O_SHCSR:
+            return(psNVIC->ui32SHCSR);
+
+        case NVIC_O_CFSR:
+            return(psNVIC->ui32CFSR);
+
+        case NVIC_O_HFSR:
+            return(psNVIC->ui32HFSR);
+
+        case NVIC_O_MMFAR:
+            return(psNVIC->ui32MMFAR);
+
+        case NVIC_O_BFAR:
+            return(psNVIC->ui32BFAR);
+
+        case NVIC_O_CPACR:
+            return(psNVIC->ui32CPACR);
+
+        case NVIC_O_FPCCR:
+            return(psNVIC->ui32FPCCR);
+
+        case NVIC_O_FPCAR:
+            return(psNVIC->ui32FPCAR);
+
+        case NVIC_O_FPDSCR:
+            return(psNVIC->ui32FPDSCR);
+
+        default:
+            return(0);
+    }
+}
+
+/*
+ * Applies a set or clear register write to 32 IRQs of a bitmap.
+ */
+static void
+NVICWriteIRQWord(uint32_t *pui32Map, uint32_t ui32Word, uint32_t ui32Value,
+                 bool bSet)
+{
+    uint32_t ui32Bit;
+
+    for(ui32Bit = 0; ui32Value; ui32Bit++, ui32Value >>= 1)
+    {
+        uint32_t ui32Exc = 16 + ui32Word * 32 + ui32Bit;
+
+        if((ui32Value & 1) && (ui32Exc < SIM_NVIC_EXCEPTIONS))
+            MapSet(pui32Map, ui32Exc, bSet);
+    }
+}
+
+void
+SimNVICWrite(tSimBoard *psBoard, uint32_t ui32Offset, uint32_t ui32Value)
+{
+    tSimNVIC *psNVIC = &psBoard->sNVIC;
+    uint32_t ui32Idx, ui32Word = (ui32Offset & 0x1F) / 4;
+
+    if((ui32Offset >= NVIC_O_ISER) && (ui32Offset < NVIC_O_ISER + 0x20))
+    {
+        NVICWriteIRQWord(psNVIC->pui32Enable, ui32Word, ui32Value, true);
+        return;
+    }
+
+    if((ui32Offset >= NVIC_O_ICER) && (ui32Offset < NVIC_O_ICER + 0x20))
+    {
+        NVICWriteIRQWord(psNVIC->pui32Enable, ui32Word, ui32Value, false);
+        return;
+    }
+
+    if((ui32Offset >= NVIC_O_ISPR) && (ui32Offset < NVIC_O_ISPR + 0x20))
+    {
+        for(ui32Idx = 0; ui32Idx < 32; ui32Idx++)
+            if(((ui32Value >> ui32Idx) & 1) &&
+               (16 + ui32Word * 32 + ui32Idx < SIM_NVIC_EXCEPTIONS))
+                NVICPend(psNVIC, 16 + ui32Word * 32 + ui32Idx);
+
+        return;
+    }
+
+    if((ui32Offset >= NVIC_O_ICPR) && (ui32Offset < NVIC_O_ICPR + 0x20))
+    {
+        NVICWriteIRQWord(psNVIC->pui32Pending, ui32Word, ui32Value, false);
+        return;
+    }
+
+    if((ui32Offset >= NVIC_O_IPR) &&
+       (ui32Offset < NVIC_O_IPR + SIM_NVIC_IRQS))
+    {
+        for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+        {
+            uint32_t ui32Exc = 16 + ui32Offset - NVIC_O_IPR + ui32Idx;
+
+            /*
+             * Only the top SIM_NVIC_PRIO_BITS bits are implemented.
+             */
+            if(ui32Exc < SIM_NVIC_EXCEPTIONS)
+                psNVIC->pui8Priority[ui32Exc] =
+                    (ui32Value >> (ui32Idx * 8)) &
+                    (0xFF << (8 - SIM_NVIC_PRIO_BITS)) & 0xFF;
+        }
+
+        return;
+    }
+
+    if((ui32Offset >= NVIC_O_SHPR1) && (ui32Offset <= NVIC_O_SHPR3))
+    {
+        for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+            psNVIC->pui8Priority[4 + ui32Offset - NVIC_O_SHPR1 + ui32Idx] =
+                (ui32Value >> (ui32Idx * 8)) &
+                (0xFF << (8 - SIM_NVIC_PRIO_BITS)) & 0xFF;
+
+        return;
+    }
+
+    switch(ui32Offset)
+    {
+        case NVIC_O_ACTLR:
+            psNVIC->ui32ACTLR = ui32Value & 0x307;
+            break;
+
+        case NVIC_O_ICSR:
+            if(ui32Value & ICSR_NMIPENDSET)
+                SimNVICSetPending(psNVIC, SIM_EXC_NMI);
+
+            if(ui32Value & ICSR_PENDSVSET)
+                SimNVICSetPending(psNVIC, SIM_EXC_PENDSV);
+            else if(ui32Value & ICSR_PENDSVCLR)
+                SimNVICClearPending(psNVIC, SIM_EXC_PENDSV);
+
+            if(ui32Value & ICSR_PENDSTSET)
+                SimNVICSetPending(psNVIC, SIM_EXC_SYSTICK);
+            else if(ui32Value & ICSR_PENDSTCLR)
+                SimNVICClearPending(psNVIC, SIM_EXC_SYSTICK);
+            break;
+
+        case NVIC_O_VTOR:
+            psNVIC->ui32VTOR = ui32Value & 0xFFFFFC00U;
+            break;
+
+        case NVIC_O_AIRCR:
+            if((ui32Value >> 16) != NVIC_VECTKEY)
+                break;
+
+            psNVIC->ui32PriGroup = (ui32Value >> 8) & 7;
+
+            if(ui32Value & AIRCR_SYSRESETREQ)
+                psBoard->ui32ResetRequest |= SIM_RESET_SW;
+            break;
+
+        case NVIC_O_SCR:
+            psNVIC->ui32SCR = ui32Value & 0x16;
+            break;
+
+        case NVIC_O_CCR:
+            psNVIC->ui32CCR = ui32Value & 0x31B;
+            break;
+
+        case NVIC_O_SHCSR:
+            psNVIC->ui32SHCSR = ui32Value & 0x0007FD8B;
+            break;
+
+        case NVIC_O_CFSR:
+            psNVIC->ui32CFSR &= ~ui32Value;
+            break;
+
+        case NVIC_O_HFSR:
+            psNVIC->ui32HFSR &= ~ui32Value;
+            break;
+
+        case NVIC_O_MMFAR:
+            psNVIC->ui32MMFAR = ui32Value;
+            break;
+
+        case NVIC_O_BFAR:
+            psNVIC->ui32BFAR = ui32Value;
+            break;
+
+        case NVIC_O_CPACR:
+            psNVIC->ui32CPACR = ui32Value & 0x00F00000U;
+            break;
+
+        case NVIC_O_STIR:
+            if((ui32Value & 0x1FF) < SIM_NVIC_IRQS)
+                SimNVICSetPending(psNVIC, 16 + (ui32Value & 0x1FF));
+            break;
+
+        case NVIC_O_FPCCR:
+            psNVIC->ui32FPCCR = ui32Value & 0xC0000001U;
+            break;
+
+        case NVIC_O_FPCAR:
+            psNVIC->ui32FPCAR = ui32Value & ~7U;
+            break;
+
+        case NVIC_O_FPDSCR:
+            psNVIC->ui32FPDSCR = ui32Value & 0x07C00000U;
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef __SIM_NVIC_H__
+#define __SIM_NVIC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+/*
+ * Exception numbers.  Peripheral interrupts use the same numbering as the
+ * INT_* values of TivaWare's hw_ints.h, i.e. IRQ n is exception 16 + n.
+ */
+#define SIM_EXC_RESET           1
+#define SIM_EXC_NMI             2
+#define SIM_EXC_HARDFAULT       3
+#define SIM_EXC_MEMMANAGE       4
+#define SIM_EXC_BUSFAULT        5
+#define SIM_EXC_USAGEFAULT      6
+#define SIM_EXC_SVCALL          11
+#define SIM_EXC_DEBUGMON        12
+#define SIM_EXC_PENDSV          14
+#define SIM_EXC_SYSTICK         15
+
+#define SIM_INT_GPIOA           16
+#define SIM_INT_GPIOB           17
+#define SIM_INT_GPIOC           18
+#define SIM_INT_GPIOD           19
+#define SIM_INT_GPIOE           20
+#define SIM_INT_UART0           21
+#define SIM_INT_UART1           22
+#define SIM_INT_ADC0SS0         30
+#define SIM_INT_TIMER0A         35
+#define SIM_INT_TIMER0B         36
+#define SIM_INT_TIMER1A         37
+#define SIM_INT_TIMER1B         38
+#define SIM_INT_TIMER2A         39
+#define SIM_INT_TIMER2B         40
+#define SIM_INT_GPIOF           46
+#define SIM_INT_UART2           49
+#define SIM_INT_TIMER3A         51
+#define SIM_INT_TIMER3B         52
+#define SIM_INT_HIBERNATE       59
+#define SIM_INT_ADC1SS0         64
+#define SIM_INT_UART3           75
+#define SIM_INT_UART4           76
+#define SIM_INT_UART5           77
+#define SIM_INT_UART6           78
+#define SIM_INT_UART7           79
+#define SIM_INT_TIMER4A         86
+#define SIM_INT_TIMER4B         87
+#define SIM_INT_TIMER5A         108
+#define SIM_INT_TIMER5B         109
+
+#define SIM_NVIC_IRQS           139
+#define SIM_NVIC_EXCEPTIONS     (16 + SIM_NVIC_IRQS)
+#define SIM_NVIC_WORDS          ((SIM_NVIC_EXCEPTIONS + 31) / 32)
+#define SIM_NVIC_PRIO_BITS      3
+#define SIM_NVIC_DEPTH          32
+
+/*
+ * Execution priority of thread mode, lower than any configurable priority.
+ */
+#define SIM_NVIC_THREAD_PRIO    256
+
+/*
+ * Nested vectored interrupt controller and system control block.  All bitmaps
+ * are indexed by exception number.
+ */
+typedef struct
+{
+    uint32_t pui32Enable[SIM_NVIC_WORDS];
+    uint32_t pui32Pending[SIM_NVIC_WORDS];
+    uint32_t pui32Active[SIM_NVIC_WORDS];
+    uint32_t pui32Level[SIM_NVIC_WORDS];
+    uint8_t pui8Priority[SIM_NVIC_EXCEPTIONS];
+
+    /*
+     * Activation order of the active exceptions, innermost last.
+     */
+    uint8_t pui8Stack[SIM_NVIC_DEPTH];
+    uint32_t ui32Depth;
+
+    uint32_t ui32VTOR;
+    uint32_t ui32PriGroup;
+    uint32_t ui32SCR;
+    uint32_t ui32CCR;
+    uint32_t ui32SHCSR;
+    uint32_t ui32CFSR;
+    uint32_t ui32HFSR;
+    uint32_t ui32MMFAR;
+    uint32_t ui32BFAR;
+    uint32_t ui32CPACR;
+    uint32_t ui32ACTLR;
+    uint32_t ui32FPCCR;
+    uint32_t ui32FPCAR;
+    uint32_t ui32FPDSCR;
+
+    /*
+     * Board cycle at which each exception last became pending, for the
+     * latency measurements of the timing model.  The board keeps ui64Now up
+     * to date.
+     */
+    uint64_t ui64Now;
+    uint64_t pui64Pended[SIM_NVIC_EXCEPTIONS];
+} tSimNVIC;
+
+void SimNVICReset(tSimNVIC *psNVIC);
+uint32_t SimNVICRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek);
+void SimNVICWrite(tSimBoard *psBoard, uint32_t ui32Offset, uint32_t ui32Value);
+
+void SimNVICSetPending(tSimNVIC *psNVIC, uint32_t ui32Exc);
+void SimNVICClearPending(tSimNVIC *psNVIC, uint32_t ui32Exc);
+void SimNVICSetLine(tSimNVIC *psNVIC, uint32_t ui32Exc, bool bLevel);
+void SimNVICEnable(tSimNVIC *psNVIC, uint32_t ui32Exc, bool bEnable);
+
+int32_t SimNVICPriority(const tSimNVIC *psNVIC, uint32_t ui32Exc);
+int32_t SimNVICGroupPriority(const tSimNVIC *psNVIC, int32_t i32Priority);
+int32_t SimNVICExecPriority(const tSimNVIC *psNVIC, bool bPrimask,
+                            uint32_t ui32BasePri, bool bFaultMask);
+uint32_t SimNVICPendingException(const tSimNVIC *psNVIC,
+                                 int32_t i32ExecPriority);
+void SimNVICActivate(tSimNVIC *psNVIC, uint32_t ui32Exc);
+void SimNVICDeactivate(tSimNVIC *psNVIC, uint32_t ui32Exc);
+
+static inline bool
+SimNVICBit(const uint32_t *pui32Map, uint32_t ui32Exc)
+{
+    return((pui32Map[ui32Exc / 32] >> (ui32Exc % 32)) & 1);
+}
+
+static inline uint32_t
+SimNVICCurrent(const tSimNVIC *psNVIC)
+{
+    return(psNVIC->ui32Depth ? psNVIC->pui8Stack[psNVIC->ui32Depth - 1] : 0);
+}
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * Work-stealing pool (see pool.h).
+ *
+ * Every worker owns a deque of job numbers in the manner of Chase and Lev.
+ * As all jobs are known before the pool starts, a deque is just the run of
+ * numbers between ui32Top and ui32Bottom: the owner takes from the bottom,
+ * thieves from the top, and the two only contend for the last job, which a
+ * compare and swap on ui32Top settles.
+ */
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "pool.h"
+
+typedef struct
+{
+    /*
+     * Written by thieves and, for the last job, the owner.
+     */
+    uint32_t ui32Top;
+
+    /*
+     * Written by the owner only.
+     */
+    uint32_t ui32Bottom;
+
+    uint64_t ui64Steals;
+
+    struct tPool *psPool;
+    uint32_t ui32Worker;
+    pthread_t sThread;
+} __attribute__((aligned(64))) tPoolWorker;
+
+typedef struct tPool
+{
+    tPoolWorker *psWorkers;
+    uint32_t ui32Workers;
+    tSimPoolJob pfnJob;
+    void *pvContext;
+} tPool;
+
+/*
+ * Takes the job at the bottom of a worker's own deque.  Returns false if the
+ * deque is empty.
+ */
+static bool
+PoolTake(tPoolWorker *psWorker, uint32_t *pui32Job)
+{
+    uint32_t ui32Top, ui32Bottom;
+    bool bTaken;
+
+    ui32Bottom = __atomic_load_n(&psWorker->ui32Bottom, __ATOMIC_RELAXED);
+    ui32Top = __atomic_load_n(&psWorker->ui32Top, __ATOMIC_RELAXED);
+
+    if(ui32Top >= ui32Bottom)
+        return(false);
+
+    ui32Bottom--;
+    __atomic_store_n(&psWorker->ui32Bottom, ui32Bottom, __ATOMIC_SEQ_CST);
+    ui32Top = __atomic_load_n(&psWorker->ui32Top, __ATOMIC_SEQ_CST);
+
+    if(ui32Top < ui32Bottom)
+    {
+        *pui32Job = ui32Bottom;
+        return(true);
+    }
+
+    /*
+     * One job left at most, which a thief may be taking at the same time.
+     */
+    bTaken = (ui32Top == ui32Bottom) &&
+             __atomic_compare_exchange_n(&psWorker->ui32Top, &ui32Top,
+                                         ui32Top + 1, false, __ATOMIC_SEQ_CST,
+                                         __ATOMIC_RELAXED);
+
+    __atomic_store_n(&psWorker->ui32Bottom, ui32Bottom + 1, __ATOMIC_RELAXED);
+
+    if(bTaken)
+        *pui32Job = ui32Bottom;
+
+    return(bTaken);
+}
+
+/*
+ * Takes the job at the top of another worker's deque.  Returns false if the
+ * deque is empty, or if another worker got the job first.
+ */
+static bool
+PoolSteal(tPoolWorker *psVictim, uint32_t *pui32Job)
+{
+    uint32_t ui32Top, ui32Bottom;
+
+    ui32Top = __atomic_load_n(&psVictim->ui32Top, __ATOMIC_SEQ_CST);
+    ui32Bottom = __atomic_load_n(&psVictim->ui32Bottom, __ATOMIC_SEQ_CST);
+
+    if(ui32Top >= ui32Bottom)
+        return(false);
+
+    if(!__atomic_compare_exchange_n(&psVictim->ui32Top, &ui32Top,
+                                    ui32Top + 1, false, __ATOMIC_SEQ_CST,
+                                    __ATOMIC_RELAXED))
+        return(false);
+
+    *pui32Job = ui32Top;
+    return(true);
+}
+
+/*
+ * Looks for a job to steal, starting with the worker after this one.
+ * Returns false once every deque is empty; as no jobs are added while the
+ * pool runs, the worker is then done.
+ */
+static bool
+PoolFind(tPoolWorker *psWorker, uint32_t *pui32Job)
+{
+    tPool *psPool = psWorker->psPool;
+    tPoolWorker *psVictim;
+    uint32_t ui32Idx, ui32Top;
+    bool bLeft;
+
+    do
+    {
+        bLeft = false;
+
+        for(ui32Idx = 1; ui32Idx < psPool->ui32Workers; ui32Idx++)
+        {
+            psVictim = &psPool->psWorkers[(psWorker->ui32Worker + ui32Idx) %
+                                          psPool->ui32Workers];
+
+            if(PoolSteal(psVictim, pui32Job))
+            {
+                psWorker->ui64Steals++;
+                return(true);
+            }
+
+            ui32Top = __atomic_load_n(&psVictim->ui32Top, __ATOMIC_SEQ_CST);
+
+            if(ui32Top < __atomic_load_n(&psVictim->ui32Bottom,
+                                         __ATOMIC_SEQ_CST))
+                bLeft = true;
+        }
+    }
+    while(bLeft);
+
+    return(false);
+}
+
+static void *
+PoolWorker(void *pvArg)
+{
+    tPoolWorker *psWorker = pvArg;
+    tPool *psPool = psWorker->psPool;
+    uint32_t ui32Job;
+
+    while(PoolTake(psWorker, &ui32Job) || PoolFind(psWorker, &ui32Job))
+        psPool->pfnJob(psPool->pvContext, ui32Job, psWorker->ui32Worker);
+
+    return(NULL);
+}
+
+/*
+ * Returns the number of host cores available to the process.
+ */
+uint32_t
+SimPoolCores(void)
+{
+    cpu_set_t sSet;
+    long i32Count;
+
+    if(!sched_getaffinity(0, sizeof(sSet), &sSet))
+        return((uint32_t)CPU_COUNT(&sSet));
+
+    i32Count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return((i32Count > 0) ? (uint32_t)i32Count : 1);
+}
+
+/*
+ * Runs jobs 0 to ui32Jobs - 1 on ui32Workers threads (one per core if zero)
+ * and returns once all of them are done.  Each worker is tied to a core of
+ * its own while there are enough.
+ */
+bool
+SimPoolRun(uint32_t ui32Jobs, uint32_t ui32Workers, tSimPoolJob pfnJob,
+           void *pvContext, tSimPoolStats *psStats)
+{
+    uint32_t ui32Idx, ui32Cores, ui32Cpu, ui32Started;
+    cpu_set_t sAllowed, sSet;
+    tPoolWorker *psWorker;
+    tPool sPool;
+    bool bPin;
+
+    ui32Cores = SimPoolCores();
+
+    if(!ui32Workers)
+        ui32Workers = ui32Cores;
+
+    if(ui32Workers > ui32Jobs)
+        ui32Workers = ui32Jobs ? ui32Jobs : 1;
+
+    sPool.psWorkers = aligned_alloc(64, ui32Workers * sizeof(tPoolWorker));
+    sPool.ui32Workers = ui32Workers;
+    sPool.pfnJob = pfnJob;
+    sPool.pvContext = pvContext;
+
+    if(!sPool.psWorkers)
+        return(false);
+
+    bPin = (ui32Workers <= ui32Cores) &&
+           !sched_getaffinity(0, sizeof(sAllowed), &sAllowed);
+
+    for(ui32Idx = 0, ui32Cpu = 0; ui32Idx < ui32Workers; ui32Idx++)
+    {
+        psWorker = &sPool.psWorkers[ui32Idx];
+        psWorker->ui32Top = (uint32_t)((uint64_t)ui32Jobs * ui32Idx /
+                                       ui32Workers);
+        psWorker->ui32Bottom = (uint32_t)((uint64_t)ui32Jobs *
+                                          (ui32Idx + 1) / ui32Workers);
+        psWorker->ui64Steals = 0;
+        psWorker->psPool = &sPool;
+        psWorker->ui32Worker = ui32Idx;
+    }
+
+    for(ui32Started = 0; ui32Started < ui32Workers; ui32Started++)
+    {
+        psWorker = &sPool.psWorkers[ui32Started];
+
+        if(pthread_create(&psWorker->sThread, NULL, PoolWorker, psWorker))
+            break;
+
+        if(!bPin)
+            continue;
+
+        while(!CPU_ISSET(ui32Cpu, &sAllowed))
+            ui32Cpu++;
+
+        CPU_ZERO(&sSet);
+        CPU_SET(ui32Cpu++, &sSet);
+        pthread_setaffinity_np(psWorker->sThread, sizeof(sSet), &sSet);
+    }
+
+    /*
+     * The jobs of workers that could not be started are stolen by the
+     * others; only if none started are they run here.
+     */
+    if(!ui32Started)
+    {
+        sPool.ui32Workers = 1;
+        sPool.psWorkers[0].ui32Bottom = ui32Jobs;
+        PoolWorker(&sPool.psWorkers[0]);
+    }
+
+    psStats->ui32Workers = ui32Started ? ui32Started : 1;
+    psStats->ui64Steals = 0;
+
+    for(ui32Idx = 0; ui32Idx < ui32Started; ui32Idx++)
+    {
+        pthread_join(sPool.psWorkers[ui32Idx].sThread, NULL);
+        psStats->ui64Steals += sPool.psWorkers[ui32Idx].ui64Steals;
+    }
+
+    free(sPool.psWorkers);
+
+    return(true);
+}
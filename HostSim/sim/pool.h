@@ -0,0 +1,35 @@
+#ifndef __SIM_POOL_H__
+#define __SIM_POOL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Work-stealing pool for running many independent jobs, such as simulated
+ * boards, on all host cores.
+ *
+ * The jobs are numbered 0 to ui32Jobs - 1 and dealt out to the workers in
+ * contiguous runs before the pool starts.  A worker takes its own jobs from
+ * the back of its run; one that runs out steals from the front of another
+ * worker's run, so long jobs do not hold up the others.  The pool keeps no
+ * state of its own between runs and the jobs share nothing through it but
+ * their context.
+ */
+
+/*
+ * Runs job ui32Job on worker ui32Worker.
+ */
+typedef void (*tSimPoolJob)(void *pvContext, uint32_t ui32Job,
+                            uint32_t ui32Worker);
+
+typedef struct
+{
+    uint32_t ui32Workers;
+    uint64_t ui64Steals;
+} tSimPoolStats;
+
+uint32_t SimPoolCores(void);
+bool SimPoolRun(uint32_t ui32Jobs, uint32_t ui32Workers, tSimPoolJob pfnJob,
+                void *pvContext, tSimPoolStats *psStats);
+
+#endif
@@ -0,0 +1,353 @@
+/*
+ * Profile of instructions and cycles by address and call stack (see
+ * profile.h).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+
+#define PROFILE_NODES           1024
+
+bool
+SimProfileInit(tSimMachine *psMachine, const tSimElf *psElf)
+{
+    tSimProfile *psProfile = calloc(1, sizeof(tSimProfile));
+
+    psMachine->psProfile = psProfile;
+
+    if(!psProfile)
+        return(false);
+
+    psProfile->psElf = psElf;
+    psProfile->pui64Insns = calloc(SIM_MEM_ARENA_SIZE / 2, sizeof(uint64_t));
+    psProfile->pui64Cycles = calloc(SIM_MEM_ARENA_SIZE / 2, sizeof(uint64_t));
+    psProfile->psNodes = calloc(PROFILE_NODES, sizeof(tSimProfileNode));
+
+    if(!psProfile->pui64Insns || !psProfile->pui64Cycles ||
+       !psProfile->psNodes)
+    {
+        SimProfileFree(psMachine);
+        return(false);
+    }
+
+    psProfile->psNodes[0].ui32Symbol = SIM_PROFILE_UNKNOWN;
+    psProfile->ui32Nodes = 1;
+    psProfile->ui32NodeSpace = PROFILE_NODES;
+
+    /*
+     * The first instruction is not where any is expected, which starts the
+     * call stack.
+     */
+    psProfile->ui32Expect = 1;
+    psProfile->ui32Resets = psMachine->sCpu.ui32Resets;
+    psProfile->ui64Cycle = psMachine->sCpu.ui64Cycle;
+    psProfile->ui64Sleep = psMachine->sCpu.ui64SleepCycles;
+
+    return(true);
+}
+
+void
+SimProfileFree(tSimMachine *psMachine)
+{
+    tSimProfile *psProfile = psMachine->psProfile;
+
+    if(!psProfile)
+        return;
+
+    free(psProfile->pui64Insns);
+    free(psProfile->pui64Cycles);
+    free(psProfile->psNodes);
+    free(psProfile);
+    psMachine->psProfile = NULL;
+}
+
+/*
+ * Returns the node of the function holding ui32Addr called from node
+ * ui32Parent, adding it if it is the first call, and counts the call.  If
+ * the tree cannot grow the call is counted in the caller.
+ */
+static uint32_t
+ProfileCall(tSimProfile *psProfile, uint32_t ui32Parent, uint32_t ui32Addr)
+{
+    const tSimElfSymbol *psSymbol = SimElfSymbolAt(psProfile->psElf, ui32Addr);
+    tSimProfileNode *psNode, *psNodes;
+    uint32_t ui32Symbol, ui32Node;
+
+    ui32Symbol = psSymbol ? (uint32_t)(psSymbol - psProfile->psElf->psSymbols) :
+                 SIM_PROFILE_UNKNOWN;
+
+    for(ui32Node = psProfile->psNodes[ui32Parent].ui32Child; ui32Node;
+        ui32Node = psProfile->psNodes[ui32Node].ui32Sibling)
+        if(psProfile->psNodes[ui32Node].ui32Symbol == ui32Symbol)
+            break;
+
+    if(!ui32Node)
+    {
+        if(psProfile->ui32Nodes == psProfile->ui32NodeSpace)
+        {
+            psNodes = realloc(psProfile->psNodes,
+                              2 * psProfile->ui32NodeSpace *
+                              sizeof(tSimProfileNode));
+
+            if(!psNodes)
+            {
+                psProfile->psNodes[ui32Parent].ui64Calls++;
+                return(ui32Parent);
+            }
+
+            psProfile->psNodes = psNodes;
+            psProfile->ui32NodeSpace *= 2;
+        }
+
+        ui32Node = psProfile->ui32Nodes++;
+        psNode = &psProfile->psNodes[ui32Node];
+        memset(psNode, 0, sizeof(*psNode));
+        psNode->ui32Symbol = ui32Symbol;
+        psNode->ui32Parent = ui32Parent;
+        psNode->ui32Sibling = psProfile->psNodes[ui32Parent].ui32Child;
+        psProfile->psNodes[ui32Parent].ui32Child = ui32Node;
+
+        /*
+         * Code outside any function, and functions of unknown size, are
+         * left by every branch and looked up again.
+         */
+        psNode->ui32Start = psSymbol ? psSymbol->ui32Value : ui32Addr;
+        psNode->ui32End = psSymbol ? psSymbol->ui32Value + psSymbol->ui32Size :
+                          ui32Addr;
+    }
+
+    psProfile->psNodes[ui32Node].ui64Calls++;
+
+    return(ui32Node);
+}
+
+static void
+ProfilePush(tSimProfile *psProfile, uint32_t ui32Return, uint32_t ui32Exc)
+{
+    tSimProfileFrame *psFrame;
+
+    if(psProfile->ui32Frames == SIM_PROFILE_DEPTH)
+    {
+        psProfile->ui64Overflows++;
+        return;
+    }
+
+    psFrame = &psProfile->psFrames[psProfile->ui32Frames++];
+    psFrame->ui32Return = ui32Return;
+    psFrame->ui32Node = psProfile->ui32Node;
+    psFrame->ui32Exc = ui32Exc;
+
+    if(ui32Exc)
+        psProfile->ui32Excs++;
+}
+
+/*
+ * Brings the call stack in line with the processor after execution went
+ * somewhere else than the instruction asked: a reset starts it afresh, and
+ * handlers the NVIC no longer has active are left for what they interrupted
+ * before those it newly activated are entered.
+ */
+static void
+ProfileResync(tSimMachine *psMachine, uint32_t ui32PC)
+{
+    tSimProfile *psProfile = psMachine->psProfile;
+    const tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    uint32_t ui32Frame, ui32Exc = 0, ui32Vector;
+
+    if(psMachine->sCpu.ui32Resets != psProfile->ui32Resets)
+    {
+        psProfile->ui32Resets = psMachine->sCpu.ui32Resets;
+        psProfile->ui32Frames = 0;
+        psProfile->ui32Excs = 0;
+        psProfile->ui32Node = 0;
+    }
+
+    for(ui32Frame = 0; ui32Frame < psProfile->ui32Frames; ui32Frame++)
+    {
+        if(!psProfile->psFrames[ui32Frame].ui32Exc)
+            continue;
+
+        if((ui32Exc == psNVIC->ui32Depth) ||
+           (psProfile->psFrames[ui32Frame].ui32Exc !=
+            psNVIC->pui8Stack[ui32Exc]))
+            break;
+
+        ui32Exc++;
+    }
+
+    if(ui32Frame < psProfile->ui32Frames)
+    {
+        psProfile->ui32Node = psProfile->psFrames[ui32Frame].ui32Node;
+        psProfile->ui32Frames = ui32Frame;
+        psProfile->ui32Excs = ui32Exc;
+    }
+
+    for(; ui32Exc < psNVIC->ui32Depth; ui32Exc++)
+    {
+        ProfilePush(psProfile, 0, psNVIC->pui8Stack[ui32Exc]);
+
+        if(!SimCpuReadMemory(psMachine,
+                             psNVIC->ui32VTOR + psNVIC->pui8Stack[ui32Exc] * 4,
+                             4, &ui32Vector))
+            ui32Vector = ui32PC;
+
+        psProfile->ui32Node = ProfileCall(psProfile, 0, ui32Vector & ~1U);
+    }
+
+    /*
+     * Thread mode starts at the function it was found in.
+     */
+    if(!psProfile->ui32Node)
+        psProfile->ui32Node = ProfileCall(psProfile, 0, ui32PC);
+}
+
+/*
+ * Follows a branch of the instruction before ui32Next: a call, a return or
+ * a tail call, unless it entered or returned from an exception.
+ */
+static void
+ProfileBranch(tSimMachine *psMachine, uint32_t ui32Next)
+{
+    tSimProfile *psProfile = psMachine->psProfile;
+    tSimCpu *psCpu = &psMachine->sCpu;
+    const tSimProfileNode *psNode = &psProfile->psNodes[psProfile->ui32Node];
+    const tSimProfileFrame *psTop;
+    uint32_t ui32Target = psCpu->ui32PC;
+    const tSimElfSymbol *psSymbol;
+
+    if((psMachine->sBoard.sNVIC.ui32Depth != psProfile->ui32Excs) ||
+       (psCpu->ui32Resets != psProfile->ui32Resets))
+    {
+        ProfileResync(psMachine, ui32Target);
+        return;
+    }
+
+    psTop = psProfile->ui32Frames ?
+            &psProfile->psFrames[psProfile->ui32Frames - 1] : NULL;
+
+    if((psCpu->pui32R[14] & ~1U) == ui32Next)
+    {
+        ProfilePush(psProfile, ui32Next, 0);
+        psProfile->ui32Node = ProfileCall(psProfile, psProfile->ui32Node,
+                                          ui32Target);
+    }
+    else if(psTop && !psTop->ui32Exc && (ui32Target == psTop->ui32Return))
+    {
+        psProfile->ui32Node = psTop->ui32Node;
+        psProfile->ui32Frames--;
+    }
+    else if((ui32Target < psNode->ui32Start) ||
+            (ui32Target >= psNode->ui32End))
+    {
+        psSymbol = SimElfSymbolAt(psProfile->psElf, ui32Target);
+
+        if((psSymbol ?
+            (uint32_t)(psSymbol - psProfile->psElf->psSymbols) :
+            SIM_PROFILE_UNKNOWN) != psNode->ui32Symbol)
+            psProfile->ui32Node = ProfileCall(psProfile, psNode->ui32Parent,
+                                              ui32Target);
+    }
+}
+
+/*
+ * Called by CpuExecute() after every instruction while profiling, with the
+ * address of the instruction and of the one following it.
+ */
+void
+SimProfileInsn(tSimMachine *psMachine, uint32_t ui32PC, uint32_t ui32Next)
+{
+    tSimProfile *psProfile = psMachine->psProfile;
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimProfileNode *psNode;
+    uint64_t ui64Sleep, ui64Cycles;
+    uint32_t ui32Offset;
+
+    ui64Sleep = psCpu->ui64SleepCycles - psProfile->ui64Sleep;
+    ui64Cycles = psCpu->ui64Cycle - psProfile->ui64Cycle - ui64Sleep;
+    psProfile->ui64Sleep = psCpu->ui64SleepCycles;
+    psProfile->ui64Cycle = psCpu->ui64Cycle;
+    psProfile->ui64SleepCycles += ui64Sleep;
+
+    if(ui32PC != psProfile->ui32Expect)
+        ProfileResync(psMachine, ui32PC);
+
+    psNode = &psProfile->psNodes[psProfile->ui32Node];
+    psNode->ui64Insns++;
+    psNode->ui64Cycles += ui64Cycles;
+    psProfile->ui64Insns++;
+    psProfile->ui64Cycles += ui64Cycles;
+
+    ui32Offset = SimMemoryOffset(psMachine->sMemory.pui32Read, ui32PC);
+
+    if(ui32Offset)
+    {
+        psProfile->pui64Insns[(ui32Offset - 1) / 2]++;
+        psProfile->pui64Cycles[(ui32Offset - 1) / 2] += ui64Cycles;
+    }
+
+    if(psCpu->ui32PC != ui32Next)
+        ProfileBranch(psMachine, ui32Next);
+
+    psProfile->ui32Expect = psCpu->ui32PC;
+}
+
+const char *
+SimProfileName(const tSimProfile *psProfile, uint32_t ui32Node)
+{
+    uint32_t ui32Symbol = psProfile->psNodes[ui32Node].ui32Symbol;
+
+    if(ui32Symbol == SIM_PROFILE_UNKNOWN)
+        return("[unknown]");
+
+    return(psProfile->psElf->psSymbols[ui32Symbol].pcName);
+}
+
+/*
+ * Writes the cycles of every call stack as folded stacks, with the cycles
+ * spent asleep as a stack of their own.  Returns false on a write error.
+ */
+bool
+SimProfileFold(const tSimProfile *psProfile, const char *pcPath)
+{
+    uint32_t pui32Path[SIM_PROFILE_DEPTH + SIM_NVIC_DEPTH + 1];
+    uint32_t ui32Node, ui32Depth, ui32Up;
+    FILE *psFile = fopen(pcPath, "w");
+    bool bOK;
+
+    if(!psFile)
+        return(false);
+
+    for(ui32Node = 1; ui32Node < psProfile->ui32Nodes; ui32Node++)
+    {
+        if(!psProfile->psNodes[ui32Node].ui64Cycles)
+            continue;
+
+        ui32Depth = 0;
+
+        for(ui32Up = ui32Node;
+            ui32Up && (ui32Depth < sizeof(pui32Path) / sizeof(pui32Path[0]));
+            ui32Up = psProfile->psNodes[ui32Up].ui32Parent)
+            pui32Path[ui32Depth++] = ui32Up;
+
+        while(ui32Depth--)
+            fprintf(psFile, "%s%c", SimProfileName(psProfile,
+                                                   pui32Path[ui32Depth]),
+                    ui32Depth ? ';' : ' ');
+
+        fprintf(psFile, "%llu\n",
+                (unsigned long long)psProfile->psNodes[ui32Node].ui64Cycles);
+    }
+
+    if(psProfile->ui64SleepCycles)
+        fprintf(psFile, "[sleep] %llu\n",
+                (unsigned long long)psProfile->ui64SleepCycles);
+
+    bOK = !ferror(psFile);
+
+    if(fclose(psFile))
+        bOK = false;
+
+    return(bOK);
+}
@@ -0,0 +1,118 @@
+#ifndef __SIM_PROFILE_H__
+#define __SIM_PROFILE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpu.h"
+#include "elf.h"
+
+/*
+ * Profile of the instructions and cycles a firmware spends where, by
+ * instruction and by call stack, for finding its hot spots.
+ *
+ * Every instruction executed is counted at its address along with the
+ * cycles since the one before, so the cycles of skipped idle loop iterations
+ * (see idle.h), of exception entries and, with the timing model, of stalls go to
+ * the instruction they precede or belong to.  Cycles spent asleep or
+ * hibernating are counted apart.
+ *
+ * The call stack is followed with the symbols of the image: an instruction
+ * that branches and sets LR to the address after itself calls a function, a
+ * branch to the return address of the innermost call returns from it and
+ * any other branch out of the function that was called is a tail call,
+ * which takes its place.  Exception handlers are stacks of their own,
+ * rooted at the handler, and whatever the handler interrupted goes on where
+ * it was once the NVIC no longer has it active.
+ *
+ * Calls are counted in a tree of the call stacks, one node per function
+ * called from a given stack, which can be written as the folded stacks of
+ * flame graph tools, one line per stack with the cycles spent in it:
+ *
+ *     Reset_Handler;main;UARTprintf;UARTvprintf;UARTwrite 1234
+ *
+ * Instructions translated to host code (see translate.h) are not seen.
+ */
+#define SIM_PROFILE_DEPTH       256
+
+/*
+ * Node of the tree of call stacks.  ui32Symbol is the index of the function
+ * in the symbols of the image, or SIM_PROFILE_UNKNOWN for code outside any
+ * function.  Nodes are linked to their parent, their first child and their
+ * next sibling by index; node 0 is the root.
+ */
+#define SIM_PROFILE_UNKNOWN     0xFFFFFFFFU
+
+typedef struct
+{
+    uint32_t ui32Symbol;
+    uint32_t ui32Parent;
+    uint32_t ui32Child;
+    uint32_t ui32Sibling;
+
+    /*
+     * Addresses of the function, to notice branches out of it without
+     * looking up the symbols.
+     */
+    uint32_t ui32Start;
+    uint32_t ui32End;
+
+    uint64_t ui64Calls;
+    uint64_t ui64Insns;
+    uint64_t ui64Cycles;
+} tSimProfileNode;
+
+/*
+ * An entry of the call stack: a call, returning to ui32Return, or the
+ * activation of exception ui32Exc.  Both go back to node ui32Node.
+ */
+typedef struct
+{
+    uint32_t ui32Return;
+    uint32_t ui32Node;
+    uint32_t ui32Exc;
+} tSimProfileFrame;
+
+struct tSimProfile
+{
+    const tSimElf *psElf;
+
+    /*
+     * Instructions and cycles by address of the flash and SRAM arena, one
+     * entry per halfword.
+     */
+    uint64_t *pui64Insns;
+    uint64_t *pui64Cycles;
+
+    tSimProfileNode *psNodes;
+    uint32_t ui32Nodes;
+    uint32_t ui32NodeSpace;
+    uint32_t ui32Node;
+
+    tSimProfileFrame psFrames[SIM_PROFILE_DEPTH];
+    uint32_t ui32Frames;
+    uint32_t ui32Excs;
+    uint64_t ui64Overflows;
+
+    /*
+     * Where the next instruction is expected and the processor counters at
+     * the last instruction.
+     */
+    uint32_t ui32Expect;
+    uint32_t ui32Resets;
+    uint64_t ui64Cycle;
+    uint64_t ui64Sleep;
+
+    uint64_t ui64Insns;
+    uint64_t ui64Cycles;
+    uint64_t ui64SleepCycles;
+};
+
+bool SimProfileInit(tSimMachine *psMachine, const tSimElf *psElf);
+void SimProfileFree(tSimMachine *psMachine);
+void SimProfileInsn(tSimMachine *psMachine, uint32_t ui32PC,
+                    uint32_t ui32Next);
+const char *SimProfileName(const tSimProfile *psProfile, uint32_t ui32Node);
+bool SimProfileFold(const tSimProfile *psProfile, const char *pcPath);
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * Pseudo-terminal at the other end of a UART (see pty.h).
+ */
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "pty.h"
+
+/*
+ * How long the terminal thread waits for the terminal before it looks at
+ * the rings again, and how long characters still in the transmit ring are
+ * given to get out at the end of a run, in milliseconds.
+ */
+#define PTY_IDLE_MS             1
+#define PTY_FLUSH_MS            200
+
+/*
+ * Writes out what the transmit ring holds, as far as the terminal takes it.
+ */
+static void
+PtyWrite(tSimPty *psPty)
+{
+    uint32_t ui32Tail = psPty->ui32TxTail, ui32Count, ui32Offset;
+    ssize_t sszWritten;
+
+    for(;;)
+    {
+        ui32Count = __atomic_load_n(&psPty->ui32TxHead, __ATOMIC_ACQUIRE) -
+                    ui32Tail;
+        ui32Offset = ui32Tail % SIM_PTY_RING_SIZE;
+
+        if(ui32Count > SIM_PTY_RING_SIZE - ui32Offset)
+            ui32Count = SIM_PTY_RING_SIZE - ui32Offset;
+
+        if(!ui32Count)
+            break;
+
+        sszWritten = write(psPty->i32Master, psPty->pui8Tx + ui32Offset,
+                           ui32Count);
+
+        if((sszWritten < 0) && (errno == EINTR))
+            continue;
+
+        if(sszWritten <= 0)
+            break;
+
+        ui32Tail += (uint32_t)sszWritten;
+        __atomic_store_n(&psPty->ui32TxTail, ui32Tail, __ATOMIC_RELEASE);
+    }
+}
+
+/*
+ * Reads what the host has written to the terminal into the receive ring, as
+ * far as it has room.
+ */
+static void
+PtyRead(tSimPty *psPty)
+{
+    uint32_t ui32Head = psPty->ui32RxHead, ui32Room, ui32Offset;
+    ssize_t sszRead;
+
+    for(;;)
+    {
+        ui32Room = SIM_PTY_RING_SIZE -
+                   (ui32Head - __atomic_load_n(&psPty->ui32RxTail,
+                                               __ATOMIC_ACQUIRE));
+        ui32Offset = ui32Head % SIM_PTY_RING_SIZE;
+
+        if(ui32Room > SIM_PTY_RING_SIZE - ui32Offset)
+            ui32Room = SIM_PTY_RING_SIZE - ui32Offset;
+
+        if(!ui32Room)
+            break;
+
+        sszRead = read(psPty->i32Master, psPty->pui8Rx + ui32Offset,
+                       ui32Room);
+
+        if((sszRead < 0) && (errno == EINTR))
+            continue;
+
+        if(sszRead <= 0)
+            break;
+
+        ui32Head += (uint32_t)sszRead;
+        __atomic_store_n(&psPty->ui32RxHead, ui32Head, __ATOMIC_RELEASE);
+    }
+}
+
+static bool
+PtyTxPending(tSimPty *psPty)
+{
+    return(__atomic_load_n(&psPty->ui32TxHead, __ATOMIC_ACQUIRE) !=
+           psPty->ui32TxTail);
+}
+
+static void *
+PtyThread(void *pvArg)
+{
+    tSimPty *psPty = pvArg;
+    struct pollfd sPoll;
+    uint32_t ui32Waited;
+
+    sPoll.fd = psPty->i32Master;
+
+    while(!__atomic_load_n(&psPty->bStop, __ATOMIC_ACQUIRE))
+    {
+        sPoll.events = POLLIN | (PtyTxPending(psPty) ? POLLOUT : 0);
+
+        if(poll(&sPoll, 1, PTY_IDLE_MS) < 0)
+            continue;
+
+        PtyWrite(psPty);
+        PtyRead(psPty);
+    }
+
+    /*
+     * The last characters sent get a little while to be read.
+     */
+    sPoll.events = POLLOUT;
+
+    for(ui32Waited = 0; PtyTxPending(psPty) && (ui32Waited < PTY_FLUSH_MS);
+        ui32Waited += PTY_IDLE_MS)
+    {
+        poll(&sPoll, 1, PTY_IDLE_MS);
+        PtyWrite(psPty);
+    }
+
+    return(NULL);
+}
+
+/*
+ * Opens a new pseudo-terminal and starts serving it.  Returns NULL if none
+ * can be had.
+ */
+tSimPty *
+SimPtyOpen(void)
+{
+    struct termios sTermios;
+    tSimPty *psPty;
+
+    psPty = calloc(1, sizeof(tSimPty));
+
+    if(!psPty)
+        return(NULL);
+
+    psPty->i32Slave = -1;
+    psPty->i32Master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if((psPty->i32Master < 0) || grantpt(psPty->i32Master) ||
+       unlockpt(psPty->i32Master) ||
+       ptsname_r(psPty->i32Master, psPty->pcName, sizeof(psPty->pcName)))
+    {
+        SimPtyClose(psPty);
+        return(NULL);
+    }
+
+    /*
+     * The terminal is set up for binary data, which the programs opening it
+     * may change again.
+     */
+    psPty->i32Slave = open(psPty->pcName, O_RDWR | O_NOCTTY);
+
+    if((psPty->i32Slave < 0) || tcgetattr(psPty->i32Slave, &sTermios))
+    {
+        SimPtyClose(psPty);
+        return(NULL);
+    }
+
+    cfmakeraw(&sTermios);
+
+    if(tcsetattr(psPty->i32Slave, TCSANOW, &sTermios) ||
+       pthread_create(&psPty->sThread, NULL, PtyThread, psPty))
+    {
+        SimPtyClose(psPty);
+        return(NULL);
+    }
+
+    psPty->bThread = true;
+
+    return(psPty);
+}
+
+/*
+ * Stops serving the terminal and closes it.  Returns the number of
+ * characters sent that the terminal never took, dropped or still in the
+ * ring.
+ */
+uint32_t
+SimPtyClose(tSimPty *psPty)
+{
+    uint32_t ui32Unsent;
+
+    if(!psPty)
+        return(0);
+
+    if(psPty->bThread)
+    {
+        __atomic_store_n(&psPty->bStop, true, __ATOMIC_RELEASE);
+        pthread_join(psPty->sThread, NULL);
+    }
+
+    ui32Unsent = (uint32_t)psPty->ui64Lost +
+                 (psPty->ui32TxHead - psPty->ui32TxTail);
+
+    if(psPty->i32Slave >= 0)
+        close(psPty->i32Slave);
+
+    if(psPty->i32Master >= 0)
+        close(psPty->i32Master);
+
+    free(psPty);
+
+    return(ui32Unsent);
+}
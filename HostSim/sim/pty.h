@@ -0,0 +1,93 @@
+#ifndef __SIM_PTY_H__
+#define __SIM_PTY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/*
+ * A pseudo-terminal standing for the other end of a UART's lines, so that
+ * terminal programs and test scripts on the host can talk to the firmware
+ * through /dev/pts/N.
+ *
+ * The master side is served by a thread of its own, which moves characters
+ * between the terminal and two single-producer, single-consumer rings: the
+ * simulation puts what the UART sends into one and takes what the host typed
+ * from the other, at the pace of the UART, without ever waiting on the
+ * terminal.  Characters sent while the transmit ring is full, because no
+ * program is reading the terminal, are dropped and counted.
+ *
+ * The slave side is also held open, in raw mode, so that the line discipline
+ * passes characters through untouched and the terminal does not hang up
+ * while no program has it open.
+ */
+#define SIM_PTY_RING_SIZE       4096
+
+typedef struct
+{
+    /*
+     * Written by the simulation thread.
+     */
+    uint32_t ui32TxHead __attribute__((aligned(64)));
+    uint32_t ui32RxTail;
+    uint64_t ui64Lost;
+
+    /*
+     * Written by the terminal thread.
+     */
+    uint32_t ui32TxTail __attribute__((aligned(64)));
+    uint32_t ui32RxHead;
+
+    uint8_t pui8Tx[SIM_PTY_RING_SIZE];
+    uint8_t pui8Rx[SIM_PTY_RING_SIZE];
+
+    int i32Master;
+    int i32Slave;
+    char pcName[64];
+    bool bStop;
+    bool bThread;
+    pthread_t sThread;
+} tSimPty;
+
+tSimPty *SimPtyOpen(void);
+uint32_t SimPtyClose(tSimPty *psPty);
+
+/*
+ * Sends a character to the programs reading the terminal.
+ */
+static inline void
+SimPtyTransmit(tSimPty *psPty, uint8_t ui8Byte)
+{
+    uint32_t ui32Head = psPty->ui32TxHead;
+
+    if(ui32Head - __atomic_load_n(&psPty->ui32TxTail, __ATOMIC_ACQUIRE) ==
+       SIM_PTY_RING_SIZE)
+    {
+        psPty->ui64Lost++;
+        return;
+    }
+
+    psPty->pui8Tx[ui32Head % SIM_PTY_RING_SIZE] = ui8Byte;
+    __atomic_store_n(&psPty->ui32TxHead, ui32Head + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Returns the next character written to the terminal by the host, or -1 if
+ * there is none.
+ */
+static inline int32_t
+SimPtyReceive(tSimPty *psPty)
+{
+    uint32_t ui32Tail = psPty->ui32RxTail;
+    uint8_t ui8Byte;
+
+    if(ui32Tail == __atomic_load_n(&psPty->ui32RxHead, __ATOMIC_ACQUIRE))
+        return(-1);
+
+    ui8Byte = psPty->pui8Rx[ui32Tail % SIM_PTY_RING_SIZE];
+    __atomic_store_n(&psPty->ui32RxTail, ui32Tail + 1, __ATOMIC_RELEASE);
+
+    return(ui8Byte);
+}
+
+#endif
@@ -0,0 +1,420 @@
+/*
+ * Record and replay of the inputs of the board (see replay.h).
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "replay.h"
+
+#define REPLAY_HEADER_SIZE      8
+
+/*
+ * Time after which a character the UART was not ready for is offered again.
+ */
+#define REPLAY_RETRY_PS         (SIM_PS_PER_SECOND / 1000)
+
+static tSimReplay *
+ReplayAlloc(void)
+{
+    tSimReplay *psReplay = calloc(1, sizeof(tSimReplay));
+
+    if(psReplay)
+        psReplay->i32Fd = -1;
+
+    return(psReplay);
+}
+
+/*
+ * Writes out the records gathered so far.
+ */
+static void
+ReplayFlush(tSimReplay *psReplay)
+{
+    const uint8_t *pui8Data = (const uint8_t *)psReplay->psBuffer;
+    size_t szLeft = psReplay->ui32Buffered * sizeof(tSimReplayRecord);
+    ssize_t sszWritten;
+
+    while(szLeft)
+    {
+        sszWritten = write(psReplay->i32Fd, pui8Data, szLeft);
+
+        if(sszWritten < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            psReplay->bWriteError = true;
+            break;
+        }
+
+        pui8Data += sszWritten;
+        szLeft -= (size_t)sszWritten;
+    }
+
+    psReplay->ui32Buffered = 0;
+}
+
+static void
+ReplayWrite(tSimReplay *psReplay, const tSimBoard *psBoard, uint32_t ui32Kind,
+            uint32_t ui32Unit, uint32_t ui32Value)
+{
+    tSimReplayRecord *psRecord;
+
+    if(psReplay->i32Fd < 0)
+        return;
+
+    psRecord = &psReplay->psBuffer[psReplay->ui32Buffered];
+    psRecord->ui64Cycle = psBoard->ui64Cycle;
+    psRecord->ui64Time = psBoard->ui64Time;
+    psRecord->ui8Kind = (uint8_t)ui32Kind;
+    psRecord->ui8Unit = (uint8_t)ui32Unit;
+    psRecord->ui16Reserved = 0;
+    psRecord->ui32Value = ui32Value;
+
+    psReplay->ui64Records++;
+
+    if(++psReplay->ui32Buffered == SIM_REPLAY_BUFFER)
+        ReplayFlush(psReplay);
+}
+
+/*
+ * Returns the next record of a kind still to be replayed, or NULL once there
+ * are no more.
+ */
+static const tSimReplayRecord *
+ReplayNext(tSimReplay *psReplay, uint32_t ui32Kind)
+{
+    size_t szIdx = psReplay->pszNext[ui32Kind];
+
+    while((szIdx < psReplay->szRecords) &&
+          (psReplay->psRecords[szIdx].ui8Kind != ui32Kind))
+        szIdx++;
+
+    psReplay->pszNext[ui32Kind] = szIdx;
+
+    return((szIdx < psReplay->szRecords) ? &psReplay->psRecords[szIdx] :
+           NULL);
+}
+
+/*
+ * Takes the record returned by ReplayNext(), counting a divergence if it is
+ * missing or does not match the input being replayed.
+ */
+static void
+ReplayTake(tSimReplay *psReplay, const tSimBoard *psBoard, uint32_t ui32Kind,
+           const tSimReplayRecord *psRecord, bool bMatch)
+{
+    if(psRecord)
+    {
+        psReplay->pszNext[ui32Kind]++;
+        psReplay->ui64Records++;
+    }
+
+    if(psRecord && bMatch && (psRecord->ui64Cycle == psBoard->ui64Cycle))
+        return;
+
+    if(!psReplay->ui64Divergences++)
+        psReplay->ui64Diverged = psBoard->ui64Cycle;
+}
+
+/*
+ * Creates a recording.  With no path nothing is logged, which still lets the
+ * recording send characters to a UART.  Returns NULL if the file cannot be
+ * created.
+ */
+tSimReplay *
+SimReplayRecord(const char *pcPath)
+{
+    tSimReplay *psReplay = ReplayAlloc();
+
+    if(!psReplay || !pcPath)
+        return(psReplay);
+
+    psReplay->psBuffer = malloc(SIM_REPLAY_BUFFER * sizeof(tSimReplayRecord));
+    psReplay->i32Fd = open(pcPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if(!psReplay->psBuffer || (psReplay->i32Fd < 0) ||
+       (write(psReplay->i32Fd, SIM_REPLAY_MAGIC, REPLAY_HEADER_SIZE) !=
+        REPLAY_HEADER_SIZE))
+    {
+        SimReplayClose(psReplay);
+        return(NULL);
+    }
+
+    return(psReplay);
+}
+
+/*
+ * Opens a recording for replay.  Returns NULL if the file cannot be read or
+ * is not a recording.
+ */
+tSimReplay *
+SimReplayOpen(const char *pcPath)
+{
+    tSimReplay *psReplay;
+    struct stat sStat;
+    uint8_t *pui8Map;
+    int i32Fd;
+
+    i32Fd = open(pcPath, O_RDONLY);
+
+    if(i32Fd < 0)
+        return(NULL);
+
+    if(fstat(i32Fd, &sStat) || (sStat.st_size < REPLAY_HEADER_SIZE) ||
+       ((sStat.st_size - REPLAY_HEADER_SIZE) % sizeof(tSimReplayRecord)))
+    {
+        close(i32Fd);
+        return(NULL);
+    }
+
+    pui8Map = mmap(NULL, (size_t)sStat.st_size, PROT_READ, MAP_PRIVATE,
+                   i32Fd, 0);
+    close(i32Fd);
+
+    if(pui8Map == MAP_FAILED)
+        return(NULL);
+
+    if(memcmp(pui8Map, SIM_REPLAY_MAGIC, REPLAY_HEADER_SIZE) ||
+       !(psReplay = ReplayAlloc()))
+    {
+        munmap(pui8Map, (size_t)sStat.st_size);
+        return(NULL);
+    }
+
+    psReplay->psRecords =
+        (const tSimReplayRecord *)(pui8Map + REPLAY_HEADER_SIZE);
+    psReplay->szRecords = ((size_t)sStat.st_size - REPLAY_HEADER_SIZE) /
+                          sizeof(tSimReplayRecord);
+    psReplay->szMapped = (size_t)sStat.st_size;
+
+    return(psReplay);
+}
+
+/*
+ * Closes a recording or replay.  Returns false if the recording could not be
+ * written completely.
+ */
+bool
+SimReplayClose(tSimReplay *psReplay)
+{
+    bool bOK;
+
+    if(!psReplay)
+        return(true);
+
+    if(psReplay->i32Fd >= 0)
+    {
+        ReplayFlush(psReplay);
+
+        if(close(psReplay->i32Fd))
+            psReplay->bWriteError = true;
+    }
+
+    if(psReplay->psRecords)
+        munmap((uint8_t *)psReplay->psRecords - REPLAY_HEADER_SIZE,
+               psReplay->szMapped);
+
+    bOK = !psReplay->bWriteError;
+
+    free(psReplay->psBuffer);
+    free(psReplay->pui8Input);
+    free(psReplay);
+
+    return(bOK);
+}
+
+/*
+ * Reads the characters to be sent to a UART by a recording from a file, or
+ * from the standard input if the path is "-".  Returns false if the file
+ * cannot be read.
+ */
+bool
+SimReplayInput(tSimReplay *psReplay, uint32_t ui32Port, const char *pcPath)
+{
+    size_t szSize = 0, szAlloc = 0, szRead;
+    uint8_t *pui8Data = NULL, *pui8New;
+    FILE *psFile;
+    bool bOK;
+
+    psFile = strcmp(pcPath, "-") ? fopen(pcPath, "rb") : stdin;
+
+    if(!psFile)
+        return(false);
+
+    do
+    {
+        if(szSize == szAlloc)
+        {
+            szAlloc = szAlloc ? szAlloc * 2 : 4096;
+            pui8New = realloc(pui8Data, szAlloc);
+
+            if(!pui8New)
+                break;
+
+            pui8Data = pui8New;
+        }
+
+        szRead = fread(pui8Data + szSize, 1, szAlloc - szSize, psFile);
+        szSize += szRead;
+    }
+    while(szRead);
+
+    bOK = !ferror(psFile) && (szSize < szAlloc);
+
+    if(psFile != stdin)
+        fclose(psFile);
+
+    if(!bOK)
+    {
+        free(pui8Data);
+        return(false);
+    }
+
+    free(psReplay->pui8Input);
+    psReplay->pui8Input = pui8Data;
+    psReplay->szInput = szSize;
+    psReplay->szInputNext = 0;
+    psReplay->ui32InputPort = ui32Port;
+
+    return(true);
+}
+
+/*
+ * Connects a recording or replay to a board, which must have been reset
+ * already.
+ */
+void
+SimReplayAttach(tSimBoard *psBoard, tSimReplay *psReplay)
+{
+    psBoard->psReplay = psReplay;
+    SimReplaySchedule(psBoard);
+}
+
+/*
+ * Schedules the next character to be received, ui64Delay picoseconds from
+ * now if it comes from the characters handed to a recording.
+ */
+static void
+ReplaySchedule(tSimBoard *psBoard, uint64_t ui64Delay)
+{
+    tSimReplay *psReplay = psBoard->psReplay;
+    const tSimReplayRecord *psRecord;
+
+    if(SimReplaying(psReplay))
+    {
+        psRecord = ReplayNext(psReplay, SIM_REPLAY_UART_RX);
+
+        if(psRecord)
+            SimEventSchedule(&psBoard->sEvents, SIM_EVENT_REPLAY,
+                             (psRecord->ui64Time > psBoard->ui64Time) ?
+                             psRecord->ui64Time : psBoard->ui64Time);
+    }
+    else if(psReplay->szInputNext < psReplay->szInput)
+    {
+        SimEventSchedule(&psBoard->sEvents, SIM_EVENT_REPLAY,
+                         psBoard->ui64Time + ui64Delay);
+    }
+}
+
+/*
+ * Schedules the next character to be received once the event queue has been
+ * set up.
+ */
+void
+SimReplaySchedule(tSimBoard *psBoard)
+{
+    if(psBoard->psReplay)
+        ReplaySchedule(psBoard, REPLAY_RETRY_PS);
+}
+
+void
+SimReplayEvent(tSimBoard *psBoard)
+{
+    tSimReplay *psReplay = psBoard->psReplay;
+    const tSimReplayRecord *psRecord;
+    uint32_t ui32Port = psReplay->ui32InputPort;
+
+    if(SimReplaying(psReplay))
+    {
+        psRecord = ReplayNext(psReplay, SIM_REPLAY_UART_RX);
+
+        if(psRecord && (psRecord->ui8Unit < SIM_UARTS))
+            SimUARTReceive(psBoard, psRecord->ui8Unit,
+                           (uint8_t)psRecord->ui32Value);
+
+        ReplayTake(psReplay, psBoard, SIM_REPLAY_UART_RX, psRecord, true);
+        ReplaySchedule(psBoard, 0);
+    }
+    else if(SimUARTReady(psBoard, ui32Port))
+    {
+        SimUARTReceive(psBoard, ui32Port,
+                       psReplay->pui8Input[psReplay->szInputNext++]);
+        ReplaySchedule(psBoard, SimUARTFramePs(psBoard, ui32Port));
+    }
+    else
+    {
+        ReplaySchedule(psBoard, REPLAY_RETRY_PS);
+    }
+}
+
+/*
+ * Logs or replaces the result of a conversion of an analog input.
+ */
+uint16_t
+SimReplayADC(tSimBoard *psBoard, uint32_t ui32Channel, uint16_t ui16Level)
+{
+    tSimReplay *psReplay = psBoard->psReplay;
+    const tSimReplayRecord *psRecord;
+
+    if(!SimReplaying(psReplay))
+    {
+        ReplayWrite(psReplay, psBoard, SIM_REPLAY_ADC, ui32Channel, ui16Level);
+        return(ui16Level);
+    }
+
+    psRecord = ReplayNext(psReplay, SIM_REPLAY_ADC);
+    ReplayTake(psReplay, psBoard, SIM_REPLAY_ADC, psRecord,
+               psRecord && (psRecord->ui8Unit == ui32Channel));
+
+    return(psRecord ? (uint16_t)psRecord->ui32Value : ui16Level);
+}
+
+/*
+ * Logs a character received on a UART.  Replayed characters come from
+ * SimReplayEvent() and are not logged again.
+ */
+void
+SimReplayUARTReceive(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Byte)
+{
+    if(!SimReplaying(psBoard->psReplay))
+        ReplayWrite(psBoard->psReplay, psBoard, SIM_REPLAY_UART_RX, ui32Port,
+                    ui8Byte);
+}
+
+/*
+ * Logs a match of the RTC, or checks it against the log.
+ */
+void
+SimReplayRTCMatch(tSimBoard *psBoard, uint32_t ui32Seconds)
+{
+    tSimReplay *psReplay = psBoard->psReplay;
+    const tSimReplayRecord *psRecord;
+
+    if(!SimReplaying(psReplay))
+    {
+        ReplayWrite(psReplay, psBoard, SIM_REPLAY_RTC_MATCH, 0, ui32Seconds);
+        return;
+    }
+
+    psRecord = ReplayNext(psReplay, SIM_REPLAY_RTC_MATCH);
+    ReplayTake(psReplay, psBoard, SIM_REPLAY_RTC_MATCH, psRecord,
+               psRecord && (psRecord->ui32Value == ui32Seconds));
+}
@@ -0,0 +1,122 @@
+#ifndef __SIM_REPLAY_H__
+#define __SIM_REPLAY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct tSimBoard tSimBoard;
+
+/*
+ * Record and replay of the inputs that reach the board from outside: the
+ * result of every ADC conversion, every character arriving on a UART and
+ * every match of the RTC, which with the wake pin ends hibernation.
+ *
+ * A recording is an append-only log of fixed size records, each stamped
+ * with the cycle and the time of the board, after an eight byte header.
+ * Records are written in the byte order of the host.  They are gathered in
+ * a buffer and written out with write(), which is safe in the service
+ * routine of the native runtime.  Characters for a UART can be handed to a
+ * recording, which sends them one frame apart while the receive FIFO has
+ * room.
+ *
+ * On replay the board takes its inputs from the log instead: conversions
+ * return the logged results in turn and characters are received at the
+ * logged times, so a run of the instruction set simulator is repeated bit
+ * for bit and can be stopped at any cycle to look at a failure.  RTC
+ * matches come from the simulated RTC as before and are only checked
+ * against the log.  Records that come at another cycle or for another
+ * input than logged count as divergences; runs of firmware compiled for
+ * the host are not cycle exact, so they see divergences in time but still
+ * get the logged values in order.
+ */
+#define SIM_REPLAY_MAGIC        "TM4CRPL1"
+#define SIM_REPLAY_BUFFER       4096
+
+typedef enum
+{
+    SIM_REPLAY_ADC = 1,
+    SIM_REPLAY_UART_RX,
+    SIM_REPLAY_RTC_MATCH,
+    SIM_REPLAY_KINDS
+} tSimReplayKind;
+
+/*
+ * One logged input.  ui8Unit is the analog channel or UART number and
+ * ui32Value the conversion result, character or RTC seconds.
+ */
+typedef struct
+{
+    uint64_t ui64Cycle;
+    uint64_t ui64Time;
+    uint8_t ui8Kind;
+    uint8_t ui8Unit;
+    uint16_t ui16Reserved;
+    uint32_t ui32Value;
+} tSimReplayRecord;
+
+typedef struct tSimReplay
+{
+    /*
+     * The log being written, or -1 if nothing is logged, and the records
+     * not written out yet.
+     */
+    int i32Fd;
+    tSimReplayRecord *psBuffer;
+    uint32_t ui32Buffered;
+    bool bWriteError;
+
+    /*
+     * Characters still to be sent to UART ui32InputPort.
+     */
+    uint8_t *pui8Input;
+    size_t szInput;
+    size_t szInputNext;
+    uint32_t ui32InputPort;
+
+    /*
+     * The mapped log being replayed.
+     */
+    const tSimReplayRecord *psRecords;
+    size_t szRecords;
+    size_t szMapped;
+
+    /*
+     * Index of the next record of every kind to replay.
+     */
+    size_t pszNext[SIM_REPLAY_KINDS];
+
+    /*
+     * Records logged or replayed, and the number of replayed inputs that
+     * did not match the log, with the cycle of the first.
+     */
+    uint64_t ui64Records;
+    uint64_t ui64Divergences;
+    uint64_t ui64Diverged;
+} tSimReplay;
+
+tSimReplay *SimReplayRecord(const char *pcPath);
+tSimReplay *SimReplayOpen(const char *pcPath);
+bool SimReplayClose(tSimReplay *psReplay);
+void SimReplayAttach(tSimBoard *psBoard, tSimReplay *psReplay);
+bool SimReplayInput(tSimReplay *psReplay, uint32_t ui32Port,
+                    const char *pcPath);
+
+/*
+ * Called by the board.
+ */
+void SimReplaySchedule(tSimBoard *psBoard);
+void SimReplayEvent(tSimBoard *psBoard);
+uint16_t SimReplayADC(tSimBoard *psBoard, uint32_t ui32Channel,
+                      uint16_t ui16Level);
+void SimReplayUARTReceive(tSimBoard *psBoard, uint32_t ui32Port,
+                          uint8_t ui8Byte);
+void SimReplayRTCMatch(tSimBoard *psBoard, uint32_t ui32Seconds);
+
+static inline bool
+SimReplaying(const tSimReplay *psReplay)
+{
+    return(psReplay && psReplay->psRecords);
+}
+
+#endif
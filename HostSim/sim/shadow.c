@@ -0,0 +1,236 @@
+/*
+ * Shadow state of the SRAM (see shadow.h).
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "shadow.h"
+
+#define SHADOW_BITBAND_BASE     0x22000000U
+#define SHADOW_BITBAND_END      (SHADOW_BITBAND_BASE + SIM_SRAM_SIZE * 32)
+
+bool
+SimShadowInit(tSimMachine *psMachine, tSimElf *psElf)
+{
+    tSimShadow *psShadow = calloc(1, sizeof(tSimShadow));
+    static const char * const ppcStatic[2] = { ".data", ".bss" };
+    uint32_t ui32Idx, ui32Addr, ui32Size;
+
+    psMachine->psShadow = psShadow;
+
+    if(!psShadow)
+        return(false);
+
+    if(SimElfSection(psElf, ".stack", &ui32Addr, &ui32Size))
+    {
+        psShadow->ui32StackLow = ui32Addr;
+        psShadow->ui32StackEnd = ui32Addr + ui32Size;
+    }
+
+    /*
+     * The stack starts where the core takes its stack pointer from at
+     * reset, which need not be the end of .stack.
+     */
+    if(!SimCpuReadMemory(psMachine, SIM_FLASH_BASE, 4,
+                         &psShadow->ui32StackTop) ||
+       (psShadow->ui32StackTop < SIM_SRAM_BASE) ||
+       (psShadow->ui32StackTop > SIM_SRAM_BASE + SIM_SRAM_SIZE))
+        psShadow->ui32StackTop = psShadow->ui32StackEnd ?
+                                 psShadow->ui32StackEnd :
+                                 SIM_SRAM_BASE + SIM_SRAM_SIZE;
+
+    if(!psShadow->ui32StackEnd)
+        psShadow->ui32StackEnd = psShadow->ui32StackTop;
+
+    for(ui32Idx = 0; ui32Idx < 2; ui32Idx++)
+        if(SimElfSection(psElf, ppcStatic[ui32Idx], &ui32Addr, &ui32Size) &&
+           ui32Size)
+        {
+            psShadow->pui32StaticLow[ui32Idx] = ui32Addr;
+            psShadow->pui32StaticHigh[ui32Idx] = ui32Addr + ui32Size - 1;
+        }
+
+    psShadow->ui32ClobberLow = 0xFFFFFFFFU;
+    psShadow->ui32LowestSP = psShadow->ui32StackTop;
+    psShadow->ui32LowestPC = psMachine->sCpu.ui32PC;
+
+    return(true);
+}
+
+void
+SimShadowFree(tSimMachine *psMachine)
+{
+    free(psMachine->psShadow);
+    psMachine->psShadow = NULL;
+}
+
+/*
+ * Counts a finding of the instruction being executed.
+ */
+static void
+ShadowReport(tSimMachine *psMachine, tSimShadowKind eKind, uint32_t ui32Addr,
+             uint32_t ui32SP)
+{
+    tSimShadow *psShadow = psMachine->psShadow;
+    tSimShadowSite *psSite;
+    uint32_t ui32PC = psMachine->sCpu.ui32InsnPC, ui32Idx;
+
+    psShadow->pui64Count[eKind]++;
+
+    for(ui32Idx = 0; ui32Idx < psShadow->ui32Sites; ui32Idx++)
+    {
+        psSite = &psShadow->psSites[ui32Idx];
+
+        if((psSite->eKind == eKind) && (psSite->ui32PC == ui32PC))
+        {
+            psSite->ui64Count++;
+            return;
+        }
+    }
+
+    if(psShadow->ui32Sites == SIM_SHADOW_SITES)
+        return;
+
+    psSite = &psShadow->psSites[psShadow->ui32Sites++];
+    psSite->eKind = eKind;
+    psSite->ui32PC = ui32PC;
+    psSite->ui32Addr = ui32Addr;
+    psSite->ui32SP = ui32SP;
+    psSite->ui64Count = 1;
+}
+
+/*
+ * Returns the SRAM offset of an access, a bit-band alias standing for the
+ * byte holding its bit, and clips its size to the SRAM.  Returns false if
+ * the access is not to SRAM.
+ */
+static bool
+ShadowRange(uint32_t *pui32Addr, uint32_t *pui32Size)
+{
+    uint32_t ui32Addr = *pui32Addr;
+
+    if((ui32Addr >= SHADOW_BITBAND_BASE) && (ui32Addr < SHADOW_BITBAND_END))
+    {
+        *pui32Addr = (ui32Addr - SHADOW_BITBAND_BASE) >> 5;
+        *pui32Size = 1;
+        return(true);
+    }
+
+    if((ui32Addr < SIM_SRAM_BASE) ||
+       (ui32Addr >= SIM_SRAM_BASE + SIM_SRAM_SIZE))
+        return(false);
+
+    *pui32Addr = ui32Addr - SIM_SRAM_BASE;
+
+    if(*pui32Size > SIM_SRAM_SIZE - *pui32Addr)
+        *pui32Size = SIM_SRAM_SIZE - *pui32Addr;
+
+    return(true);
+}
+
+/*
+ * Marks SRAM as written without checking anything, as for a debugger or a
+ * snapshot.
+ */
+void
+SimShadowDefine(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size)
+{
+    if(ShadowRange(&ui32Addr, &ui32Size))
+        memset(psMachine->psShadow->pui8Defined + ui32Addr, 1, ui32Size);
+}
+
+/*
+ * Called before the processor reads memory.
+ */
+void
+SimShadowLoad(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size)
+{
+    const uint8_t *pui8Defined;
+    uint32_t ui32Idx;
+
+    if(!ShadowRange(&ui32Addr, &ui32Size))
+        return;
+
+    pui8Defined = psMachine->psShadow->pui8Defined + ui32Addr;
+
+    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    {
+        if(!pui8Defined[ui32Idx])
+        {
+            ShadowReport(psMachine, SIM_SHADOW_UNDEFINED,
+                         SIM_SRAM_BASE + ui32Addr + ui32Idx,
+                         psMachine->sCpu.pui32R[13]);
+            return;
+        }
+    }
+}
+
+/*
+ * Called before the processor, or an exception entry, writes memory.  The
+ * writes to .data and .bss are checked against the stack pointer once the
+ * instruction is done.
+ */
+void
+SimShadowStore(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size)
+{
+    tSimShadow *psShadow = psMachine->psShadow;
+    uint32_t ui32Idx, ui32Last;
+
+    if(!ShadowRange(&ui32Addr, &ui32Size) || !ui32Size)
+        return;
+
+    memset(psShadow->pui8Defined + ui32Addr, 1, ui32Size);
+
+    ui32Addr += SIM_SRAM_BASE;
+    ui32Last = ui32Addr + ui32Size - 1;
+
+    for(ui32Idx = 0; ui32Idx < 2; ui32Idx++)
+    {
+        if(!psShadow->pui32StaticHigh[ui32Idx] ||
+           (ui32Last < psShadow->pui32StaticLow[ui32Idx]) ||
+           (ui32Addr > psShadow->pui32StaticHigh[ui32Idx]))
+            continue;
+
+        if(ui32Addr < psShadow->ui32ClobberLow)
+            psShadow->ui32ClobberLow = ui32Addr;
+
+        if(ui32Last > psShadow->ui32ClobberHigh)
+            psShadow->ui32ClobberHigh = ui32Last;
+    }
+}
+
+/*
+ * Called by CpuExecute() after every instruction while shadowing.
+ */
+void
+SimShadowInsn(tSimMachine *psMachine)
+{
+    tSimShadow *psShadow = psMachine->psShadow;
+    const tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32SP;
+
+    ui32SP = (!psCpu->bHandler &&
+              (psCpu->ui32Control & SIM_CPU_CONTROL_SPSEL)) ?
+             psCpu->ui32OtherSP : psCpu->pui32R[13];
+
+    if(ui32SP < psShadow->ui32LowestSP)
+    {
+        psShadow->ui32LowestSP = ui32SP;
+        psShadow->ui32LowestPC = psCpu->ui32InsnPC;
+    }
+
+    if((ui32SP < psShadow->ui32StackLow) || (ui32SP > psShadow->ui32StackTop))
+        ShadowReport(psMachine, SIM_SHADOW_OVERFLOW, ui32SP, ui32SP);
+
+    if(psShadow->ui32ClobberLow > psShadow->ui32ClobberHigh)
+        return;
+
+    if((psShadow->ui32ClobberHigh >= ui32SP) &&
+       (psShadow->ui32ClobberLow < psShadow->ui32StackTop))
+        ShadowReport(psMachine, SIM_SHADOW_CLOBBER,
+                     (psShadow->ui32ClobberLow > ui32SP) ?
+                     psShadow->ui32ClobberLow : ui32SP, ui32SP);
+
+    psShadow->ui32ClobberLow = 0xFFFFFFFFU;
+    psShadow->ui32ClobberHigh = 0;
+}
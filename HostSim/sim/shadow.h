@@ -0,0 +1,102 @@
+#ifndef __SIM_SHADOW_H__
+#define __SIM_SHADOW_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpu.h"
+#include "elf.h"
+
+/*
+ * Shadow state of the SRAM, for finding reads of memory never written and
+ * the stack outgrowing what the image reserves for it.
+ *
+ * Every byte of SRAM is marked once the processor, an exception entry or a
+ * debugger writes it, and a read of a byte not marked is reported; a
+ * bit-band write marks the whole byte holding the bit.  SRAM holds garbage
+ * at power on, so a firmware has to copy .data and clear .bss before it
+ * reads them; a run from a snapshot takes all of it as written.
+ * Only memory is shadowed, not registers: a register holding garbage stored
+ * to the stack marks the bytes as written.
+ *
+ * The stack is taken to be the .stack section of the image, up to the
+ * initial stack pointer in the vector table; the lowest main stack pointer
+ * after any instruction is the high-water mark of the run.  An instruction
+ * leaving the main stack pointer outside the stack, and a write to .data or
+ * .bss at or above the stack pointer after it, which is the stack grown
+ * into them, are reported.  The process stack is not checked.
+ *
+ * Findings are counted by kind and address of the instruction, the first
+ * SIM_SHADOW_SITES of them with the address they accessed.
+ */
+#define SIM_SHADOW_SITES        32
+
+typedef enum
+{
+    SIM_SHADOW_UNDEFINED,
+    SIM_SHADOW_OVERFLOW,
+    SIM_SHADOW_CLOBBER,
+    SIM_SHADOW_KINDS
+} tSimShadowKind;
+
+typedef struct
+{
+    tSimShadowKind eKind;
+    uint32_t ui32PC;
+    uint32_t ui32Addr;
+    uint32_t ui32SP;
+    uint64_t ui64Count;
+} tSimShadowSite;
+
+struct tSimShadow
+{
+    /*
+     * One byte per byte of SRAM, non-zero once written.
+     */
+    uint8_t pui8Defined[SIM_SRAM_SIZE];
+
+    /*
+     * The stack, from the lowest address to the initial stack pointer, and
+     * the end of .stack if it differs from the latter.  ui32StackLow is zero
+     * if the image has no .stack section.
+     */
+    uint32_t ui32StackLow;
+    uint32_t ui32StackTop;
+    uint32_t ui32StackEnd;
+
+    /*
+     * .data and .bss.
+     */
+    uint32_t pui32StaticLow[2];
+    uint32_t pui32StaticHigh[2];
+
+    /*
+     * Lowest and highest addresses of .data and .bss written by the current
+     * instruction, or an exception entry, if ui32ClobberLow is not above
+     * ui32ClobberHigh.
+     */
+    uint32_t ui32ClobberLow;
+    uint32_t ui32ClobberHigh;
+
+    /*
+     * High-water mark of the main stack and where it was reached.
+     */
+    uint32_t ui32LowestSP;
+    uint32_t ui32LowestPC;
+
+    tSimShadowSite psSites[SIM_SHADOW_SITES];
+    uint32_t ui32Sites;
+    uint64_t pui64Count[SIM_SHADOW_KINDS];
+};
+
+bool SimShadowInit(tSimMachine *psMachine, tSimElf *psElf);
+void SimShadowFree(tSimMachine *psMachine);
+void SimShadowDefine(tSimMachine *psMachine, uint32_t ui32Addr,
+                     uint32_t ui32Size);
+void SimShadowLoad(tSimMachine *psMachine, uint32_t ui32Addr,
+                   uint32_t ui32Size);
+void SimShadowStore(tSimMachine *psMachine, uint32_t ui32Addr,
+                    uint32_t ui32Size);
+void SimShadowInsn(tSimMachine *psMachine);
+
+#endif
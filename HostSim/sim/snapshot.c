@@ -0,0 +1,219 @@
+/*
+ * Snapshots of a machine (see snapshot.h).
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "idle.h"
+#include "snapshot.h"
+
+/*
+ * The jump buffer at the end of the processor state belongs to the run in
+ * progress.
+ */
+#define SNAPSHOT_CPU_SIZE       offsetof(tSimCpu, sAbort)
+
+typedef struct
+{
+    char pcMagic[8];
+    uint32_t ui32BoardSize;
+    uint32_t ui32CpuSize;
+    uint32_t ui32ArenaSize;
+    uint32_t ui32TimingSize;
+} tSnapshotHeader;
+
+/*
+ * Copies the state of the board, keeping the hooks and recording of the
+ * destination.
+ */
+static void
+SnapshotCopyBoard(tSimBoard *psTo, const tSimBoard *psFrom)
+{
+    tSimBoardHooks sHooks = psTo->sHooks;
+    tSimReplay *psReplay = psTo->psReplay;
+
+    memcpy(psTo, psFrom, sizeof(*psTo));
+    psTo->sHooks = sHooks;
+    psTo->psReplay = psReplay;
+}
+
+/*
+ * Takes a snapshot of a machine, which from then on tracks the pages written
+ * for restoring it.  Returns NULL if out of memory.
+ */
+tSimSnapshot *
+SimSnapshotTake(tSimMachine *psMachine)
+{
+    tSimSnapshot *psSnapshot = calloc(1, sizeof(tSimSnapshot));
+
+    if(!psSnapshot)
+        return(NULL);
+
+    SnapshotCopyBoard(&psSnapshot->sBoard, &psMachine->sBoard);
+    memcpy(&psSnapshot->sCpu, &psMachine->sCpu, SNAPSHOT_CPU_SIZE);
+    memcpy(psSnapshot->pui8Arena, psMachine->sMemory.pui8Arena,
+           SIM_MEM_ARENA_SIZE);
+
+    if(psMachine->psTiming)
+    {
+        psSnapshot->bTiming = true;
+        psSnapshot->sTiming = *psMachine->psTiming;
+    }
+
+    SimMemoryTrack(&psMachine->sMemory);
+    psMachine->psSnapshot = psSnapshot;
+
+    return(psSnapshot);
+}
+
+/*
+ * Puts a machine back into the state of a snapshot, outside SimCpuRun().
+ */
+void
+SimSnapshotRestore(tSimMachine *psMachine, const tSimSnapshot *psSnapshot)
+{
+    tSimMemory *psMemory = &psMachine->sMemory;
+    uint32_t ui32Page, ui32Offset, ui32Addr;
+
+    if(psMachine->psSnapshot != psSnapshot)
+    {
+        memcpy(psMemory->pui8Arena, psSnapshot->pui8Arena, SIM_MEM_ARENA_SIZE);
+        SimCpuInvalidate(psMachine);
+    }
+    else
+    {
+        for(ui32Page = 0; ui32Page < SIM_MEM_ARENA_PAGES; ui32Page++)
+        {
+            if(!psMemory->pui8Dirty[ui32Page])
+                continue;
+
+            ui32Offset = ui32Page * SIM_MEM_PAGE_SIZE;
+            memcpy(psMemory->pui8Arena + ui32Offset,
+                   psSnapshot->pui8Arena + ui32Offset, SIM_MEM_PAGE_SIZE);
+
+            ui32Addr = (ui32Offset < SIM_MEM_SRAM_OFFSET) ?
+                       SIM_FLASH_BASE + ui32Offset :
+                       SIM_SRAM_BASE + ui32Offset - SIM_MEM_SRAM_OFFSET;
+            SimCpuInvalidateRange(psMachine, ui32Addr, SIM_MEM_PAGE_SIZE);
+        }
+    }
+
+    SnapshotCopyBoard(&psMachine->sBoard, &psSnapshot->sBoard);
+    memcpy(&psMachine->sCpu, &psSnapshot->sCpu, SNAPSHOT_CPU_SIZE);
+
+    SimMemoryTrack(psMemory);
+    psMachine->psSnapshot = psSnapshot;
+
+    SimTimingReset(psMachine);
+
+    if(psMachine->psTiming && psSnapshot->bTiming)
+    {
+        psMachine->psTiming->bPipelined = psSnapshot->sTiming.bPipelined;
+        psMachine->psTiming->ui32Returning = psSnapshot->sTiming.ui32Returning;
+        memcpy(psMachine->psTiming->pui64Entered,
+               psSnapshot->sTiming.pui64Entered,
+               sizeof(psMachine->psTiming->pui64Entered));
+    }
+
+    if(psMachine->psIdle)
+        psMachine->psIdle->ui32Count = 0;
+}
+
+void
+SimSnapshotFree(tSimSnapshot *psSnapshot)
+{
+    free(psSnapshot);
+}
+
+/*
+ * Writes a snapshot to a file.  Returns false if it cannot be written.
+ */
+bool
+SimSnapshotSave(const tSimSnapshot *psSnapshot, const char *pcPath)
+{
+    tSnapshotHeader sHeader;
+    tSimBoard sBoard;
+    FILE *psFile;
+    bool bOK;
+
+    memset(&sHeader, 0, sizeof(sHeader));
+    memcpy(sHeader.pcMagic, SIM_SNAPSHOT_MAGIC, sizeof(sHeader.pcMagic));
+    sHeader.ui32BoardSize = sizeof(tSimBoard);
+    sHeader.ui32CpuSize = SNAPSHOT_CPU_SIZE;
+    sHeader.ui32ArenaSize = SIM_MEM_ARENA_SIZE;
+    sHeader.ui32TimingSize = psSnapshot->bTiming ? sizeof(tSimTiming) : 0;
+
+    /*
+     * The host pointers in the board mean nothing to another run.
+     */
+    sBoard = psSnapshot->sBoard;
+    memset(&sBoard.sHooks, 0, sizeof(sBoard.sHooks));
+    sBoard.psReplay = NULL;
+
+    psFile = fopen(pcPath, "wb");
+
+    if(!psFile)
+        return(false);
+
+    bOK = (fwrite(&sHeader, sizeof(sHeader), 1, psFile) == 1) &&
+          (fwrite(&sBoard, sizeof(sBoard), 1, psFile) == 1) &&
+          (fwrite(&psSnapshot->sCpu, SNAPSHOT_CPU_SIZE, 1, psFile) == 1) &&
+          (fwrite(psSnapshot->pui8Arena, SIM_MEM_ARENA_SIZE, 1, psFile) == 1) &&
+          (!psSnapshot->bTiming ||
+           (fwrite(&psSnapshot->sTiming, sizeof(tSimTiming), 1, psFile) == 1));
+
+    if(fclose(psFile))
+        bOK = false;
+
+    return(bOK);
+}
+
+/*
+ * Reads a snapshot saved by SimSnapshotSave().  Returns NULL if the file
+ * cannot be read or was not saved by this build.
+ */
+tSimSnapshot *
+SimSnapshotLoad(const char *pcPath)
+{
+    tSnapshotHeader sHeader;
+    tSimSnapshot *psSnapshot;
+    FILE *psFile;
+    bool bOK;
+
+    psFile = fopen(pcPath, "rb");
+
+    if(!psFile)
+        return(NULL);
+
+    psSnapshot = calloc(1, sizeof(tSimSnapshot));
+
+    bOK = psSnapshot &&
+          (fread(&sHeader, sizeof(sHeader), 1, psFile) == 1) &&
+          !memcmp(sHeader.pcMagic, SIM_SNAPSHOT_MAGIC,
+                  sizeof(sHeader.pcMagic)) &&
+          (sHeader.ui32BoardSize == sizeof(tSimBoard)) &&
+          (sHeader.ui32CpuSize == SNAPSHOT_CPU_SIZE) &&
+          (sHeader.ui32ArenaSize == SIM_MEM_ARENA_SIZE) &&
+          (!sHeader.ui32TimingSize ||
+           (sHeader.ui32TimingSize == sizeof(tSimTiming))) &&
+          (fread(&psSnapshot->sBoard, sizeof(tSimBoard), 1, psFile) == 1) &&
+          (fread(&psSnapshot->sCpu, SNAPSHOT_CPU_SIZE, 1, psFile) == 1) &&
+          (fread(psSnapshot->pui8Arena, SIM_MEM_ARENA_SIZE, 1, psFile) == 1) &&
+          (!sHeader.ui32TimingSize ||
+           (fread(&psSnapshot->sTiming, sizeof(tSimTiming), 1, psFile) == 1));
+
+    fclose(psFile);
+
+    if(bOK)
+        psSnapshot->bTiming = (sHeader.ui32TimingSize != 0);
+
+    if(!bOK)
+    {
+        free(psSnapshot);
+        return(NULL);
+    }
+
+    return(psSnapshot);
+}
@@ -0,0 +1,54 @@
+#ifndef __SIM_SNAPSHOT_H__
+#define __SIM_SNAPSHOT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpu.h"
+#include "timing.h"
+
+/*
+ * Snapshots of the whole state of a machine: the processor, the flash and
+ * SRAM and the peripherals with their pending events and interrupts.  A
+ * firmware is booted once, a snapshot is taken where its tests start, and
+ * each test forks from the snapshot instead of booting again.
+ *
+ * A machine restored from the snapshot it was last taken as or restored
+ * from copies back only the pages of memory written since, which the memory
+ * model marks as they are first written, so a fork costs the pages the test
+ * dirtied plus the few kilobytes of the processor and peripherals.  The
+ * decoded instructions of the pages copied back are forgotten.
+ *
+ * The hooks of the board and its recording (see replay.h) belong to the
+ * machine and are not part of a snapshot.  Of the timing model only the
+ * state of the pipeline and of the handlers in progress is; its clock and
+ * statistics stay with the machine.
+ *
+ * A snapshot can be saved to a file and loaded by later runs of the same
+ * build of the simulator.  Files hold the state in the layout and byte order
+ * of the host and are refused if the layout does not match.
+ */
+#define SIM_SNAPSHOT_MAGIC      "TM4CSNP1"
+
+struct tSimSnapshot
+{
+    tSimBoard sBoard;
+    tSimCpu sCpu;
+    uint8_t pui8Arena[SIM_MEM_ARENA_SIZE];
+
+    /*
+     * Set if the machine had a timing model, whose state is in sTiming.
+     */
+    bool bTiming;
+    tSimTiming sTiming;
+};
+
+tSimSnapshot *SimSnapshotTake(tSimMachine *psMachine);
+void SimSnapshotRestore(tSimMachine *psMachine,
+                        const tSimSnapshot *psSnapshot);
+void SimSnapshotFree(tSimSnapshot *psSnapshot);
+bool SimSnapshotSave(const tSimSnapshot *psSnapshot, const char *pcPath);
+tSimSnapshot *SimSnapshotLoad(const char *pcPath);
+
+#endif
@@ -0,0 +1,455 @@
+/*
+ * Analog input profiles (see stimulus.h).
+ */
+#include <endian.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stimulus.h"
+#include "board.h"
+
+/*
+ * Kinds with a period take it as their third parameter, which must not be
+ * zero.
+ */
+static const struct
+{
+    const char *pcName;
+    uint32_t ui32Params;
+    bool bPeriodic;
+}
+g_psKinds[] =
+{
+    [SIM_STIMULUS_CONST] = { "const", 1, false },
+    [SIM_STIMULUS_RAMP] = { "ramp", 3, true },
+    [SIM_STIMULUS_SQUARE] = { "square", 3, true },
+    [SIM_STIMULUS_SINE] = { "sine", 3, true },
+    [SIM_STIMULUS_CHIRP] = { "chirp", 5, true },
+    [SIM_STIMULUS_STEP] = { "step", 3, false },
+    [SIM_STIMULUS_NOISE] = { "noise", 2, false },
+    [SIM_STIMULUS_WALK] = { "walk", 2, false },
+    [SIM_STIMULUS_FILE] = { "file", 0, false },
+    [SIM_STIMULUS_RANDOM] = { "random", 0, false },
+};
+
+#define NUM_KINDS       (sizeof(g_psKinds) / sizeof(g_psKinds[0]))
+#define MAX_PARAMS      5
+
+/*
+ * Kinds a random profile is drawn from, in the order that keeps the
+ * profiles of existing seeds.
+ */
+static const tSimStimulusKind g_peRandomKinds[] =
+{
+    SIM_STIMULUS_CONST, SIM_STIMULUS_RAMP, SIM_STIMULUS_SQUARE,
+    SIM_STIMULUS_SINE, SIM_STIMULUS_NOISE, SIM_STIMULUS_WALK
+};
+
+#define NUM_RANDOM_KINDS (sizeof(g_peRandomKinds) / sizeof(g_peRandomKinds[0]))
+
+#define STIMULUS_DEFAULT_RATE   1000000U
+
+/*
+ * xorshift64* generator.
+ */
+static uint64_t
+StimulusNext(tSimStimulus *psStimulus)
+{
+    uint64_t ui64X = psStimulus->ui64State;
+
+    ui64X ^= ui64X >> 12;
+    ui64X ^= ui64X << 25;
+    ui64X ^= ui64X >> 27;
+    psStimulus->ui64State = ui64X;
+
+    return(ui64X * 0x2545F4914F6CDD1DULL);
+}
+
+/*
+ * Returns a number in [0, 1).
+ */
+static double
+StimulusUniform(tSimStimulus *psStimulus)
+{
+    return((double)(StimulusNext(psStimulus) >> 11) / 9007199254740992.0);
+}
+
+/*
+ * Maps the recording of a file profile, given as PATH[:RATE].
+ */
+static bool
+StimulusMap(tSimStimulus *psStimulus, const char *pcSpec)
+{
+    const char *pcRate = strrchr(pcSpec, ':');
+    struct stat sStat;
+    size_t szPath;
+    char *pcNext;
+    double dRate;
+    void *pvMap;
+    int i32Fd;
+
+    szPath = strlen(pcSpec);
+    psStimulus->ui32Rate = STIMULUS_DEFAULT_RATE;
+
+    if(pcRate)
+    {
+        dRate = strtod(pcRate + 1, &pcNext);
+
+        if((pcNext != pcRate + 1) && !*pcNext)
+        {
+            if((dRate < 1.0) || (dRate > 4294967295.0))
+                return(false);
+
+            psStimulus->ui32Rate = (uint32_t)dRate;
+            szPath = (size_t)(pcRate - pcSpec);
+        }
+    }
+
+    psStimulus->pcPath = strndup(pcSpec, szPath);
+
+    if(!psStimulus->pcPath)
+        return(false);
+
+    i32Fd = open(psStimulus->pcPath, O_RDONLY);
+
+    if(i32Fd < 0)
+        return(false);
+
+    if(fstat(i32Fd, &sStat) || (sStat.st_size < 2))
+    {
+        close(i32Fd);
+        return(false);
+    }
+
+    pvMap = mmap(NULL, (size_t)sStat.st_size, PROT_READ, MAP_SHARED, i32Fd,
+                 0);
+    close(i32Fd);
+
+    if(pvMap == MAP_FAILED)
+        return(false);
+
+    madvise(pvMap, (size_t)sStat.st_size, MADV_SEQUENTIAL);
+
+    psStimulus->pui16Samples = pvMap;
+    psStimulus->ui64Samples = (uint64_t)sStat.st_size / 2;
+
+    return(true);
+}
+
+bool
+SimStimulusParse(tSimStimulus *psStimulus, const char *pcSpec)
+{
+    double pdParam[MAX_PARAMS] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+    uint32_t ui32Kind, ui32Param;
+    const char *pcEnd;
+    char *pcNext;
+    size_t szName;
+
+    memset(psStimulus, 0, sizeof(*psStimulus));
+
+    pcEnd = strchr(pcSpec, ':');
+    szName = pcEnd ? (size_t)(pcEnd - pcSpec) : strlen(pcSpec);
+
+    for(ui32Kind = 0; ui32Kind < NUM_KINDS; ui32Kind++)
+        if((strlen(g_psKinds[ui32Kind].pcName) == szName) &&
+           !strncmp(g_psKinds[ui32Kind].pcName, pcSpec, szName))
+            break;
+
+    if(ui32Kind == NUM_KINDS)
+        return(false);
+
+    psStimulus->eKind = (tSimStimulusKind)ui32Kind;
+
+    if(ui32Kind == SIM_STIMULUS_FILE)
+        return(pcEnd && StimulusMap(psStimulus, pcEnd + 1));
+
+    for(ui32Param = 0; ui32Param < g_psKinds[ui32Kind].ui32Params;
+        ui32Param++)
+    {
+        if(!pcEnd || (*pcEnd != ':'))
+            return(false);
+
+        pdParam[ui32Param] = strtod(pcEnd + 1, &pcNext);
+
+        if(pcNext == pcEnd + 1)
+            return(false);
+
+        pcEnd = pcNext;
+    }
+
+    if(pcEnd && *pcEnd)
+        return(false);
+
+    psStimulus->dA = pdParam[0];
+    psStimulus->dB = pdParam[1];
+    psStimulus->dPeriod = pdParam[2];
+    psStimulus->dF0 = pdParam[3];
+    psStimulus->dF1 = pdParam[4];
+
+    if(g_psKinds[ui32Kind].bPeriodic && (psStimulus->dPeriod <= 0.0))
+        return(false);
+
+    return(true);
+}
+
+/*
+ * Seeds the generator, starts a walk over, and draws the kind and parameters
+ * of a random profile.
+ */
+void
+SimStimulusInit(tSimStimulus *psStimulus, uint64_t ui64Seed)
+{
+    uint64_t ui64Z = ui64Seed + 0x9E3779B97F4A7C15ULL;
+
+    /*
+     * splitmix64 spreads neighbouring seeds apart; the state must not be
+     * zero.
+     */
+    ui64Z = (ui64Z ^ (ui64Z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    ui64Z = (ui64Z ^ (ui64Z >> 27)) * 0x94D049BB133111EBULL;
+    ui64Z ^= ui64Z >> 31;
+    psStimulus->ui64State = ui64Z ? ui64Z : 1;
+    psStimulus->ui64Seed = ui64Z;
+    psStimulus->bBatch = false;
+
+    if(psStimulus->eKind == SIM_STIMULUS_RANDOM)
+    {
+        psStimulus->eKind =
+            g_peRandomKinds[StimulusNext(psStimulus) % NUM_RANDOM_KINDS];
+        psStimulus->dA = floor(StimulusUniform(psStimulus) *
+                               (SIM_STIMULUS_MAX + 1));
+        psStimulus->dB = floor(StimulusUniform(psStimulus) *
+                               (SIM_STIMULUS_MAX + 1));
+
+        if((psStimulus->eKind == SIM_STIMULUS_SINE) ||
+           (psStimulus->eKind == SIM_STIMULUS_NOISE))
+            psStimulus->dB /= 2;
+        else if(psStimulus->eKind == SIM_STIMULUS_WALK)
+            psStimulus->dB /= 64;
+
+        /*
+         * Periods from 10 ms to 10 s, evenly spread on a log scale.
+         */
+        psStimulus->dPeriod = pow(10.0, StimulusUniform(psStimulus) * 3 - 2);
+    }
+
+    psStimulus->dLevel = psStimulus->dA;
+}
+
+/*
+ * Returns sin(2 pi x) for x in (-1, 1), to well within a 12-bit result, with
+ * nothing the vectorizer cannot handle.
+ */
+static inline double
+StimulusSin(double dX)
+{
+    double dZ, dZ2;
+
+    /*
+     * Down to [-0.5, 0.5], then folded onto [-0.25, 0.25] around the peaks.
+     */
+    dX -= (double)(int32_t)(dX * 2);
+    dX = copysign(0.25 - fabs(fabs(dX) - 0.25), dX);
+
+    dZ = 2 * M_PI * dX;
+    dZ2 = dZ * dZ;
+
+    return(dZ * (1.0 + dZ2 * (-1.0 / 6 + dZ2 * (1.0 / 120 +
+                              dZ2 * (-1.0 / 5040 + dZ2 / 362880)))));
+}
+
+/*
+ * Returns the fractional part of dX, with the sign of dX, for |dX| < 2^31.
+ */
+static inline double
+StimulusFrac(double dX)
+{
+    return(dX - (double)(int32_t)dX);
+}
+
+/*
+ * Hashes a grid point into a number in [0, 1) for the noise.
+ */
+static inline double
+StimulusHash(uint64_t ui64Seed, uint64_t ui64Point)
+{
+    uint64_t ui64Z = ui64Seed ^ (ui64Point * 0x9E3779B97F4A7C15ULL);
+
+    ui64Z = (ui64Z ^ (ui64Z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    ui64Z = (ui64Z ^ (ui64Z >> 27)) * 0x94D049BB133111EBULL;
+    ui64Z ^= ui64Z >> 31;
+
+    return((double)(ui64Z >> 11) / 9007199254740992.0);
+}
+
+/*
+ * Computes the levels of the batch of grid points starting at ui64First.
+ * Phases are taken relative to the first point, so that they stay small
+ * however long the run.
+ */
+static void
+StimulusFill(tSimStimulus *psStimulus, uint64_t ui64First)
+{
+    const double dStep = (double)SIM_STIMULUS_GRID_PS / SIM_PS_PER_SECOND;
+    double pdLevel[SIM_STIMULUS_BATCH];
+    double dA = psStimulus->dA, dB = psStimulus->dB;
+    double dPeriod = psStimulus->dPeriod, dStart, dPhase, dDelta, dT, dK;
+    double dCycles, dFirst;
+    uint32_t ui32Idx;
+
+    dStart = (double)ui64First * dStep;
+
+    switch(psStimulus->eKind)
+    {
+        case SIM_STIMULUS_RAMP:
+        case SIM_STIMULUS_SQUARE:
+        case SIM_STIMULUS_SINE:
+            /*
+             * Whole periods between grid points make no difference.
+             */
+            dPhase = fmod(dStart, dPeriod) / dPeriod;
+            dDelta = fmod(dStep / dPeriod, 1.0);
+
+            for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+                pdLevel[ui32Idx] = StimulusFrac(dPhase + ui32Idx * dDelta);
+
+            if(psStimulus->eKind == SIM_STIMULUS_RAMP)
+                for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+                    pdLevel[ui32Idx] = dA + (dB - dA) * pdLevel[ui32Idx];
+            else if(psStimulus->eKind == SIM_STIMULUS_SQUARE)
+                for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+                    pdLevel[ui32Idx] = (pdLevel[ui32Idx] < 0.5) ? dA : dB;
+            else
+                for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+                    pdLevel[ui32Idx] = dA + dB * StimulusSin(pdLevel[ui32Idx]);
+            break;
+
+        case SIM_STIMULUS_CHIRP:
+            /*
+             * The phase in cycles at t into the sweep is
+             * F0 t + (F1 - F0) t^2 / 2 PERIOD.
+             */
+            dStart = fmod(dStart, dPeriod);
+            dK = (psStimulus->dF1 - psStimulus->dF0) / (2 * dPeriod);
+            dFirst = floor(dStart * (psStimulus->dF0 + dK * dStart));
+
+            for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+            {
+                dT = dStart + ui32Idx * dStep;
+                dT -= (dT >= dPeriod) ? dPeriod : 0.0;
+                dCycles = dT * (psStimulus->dF0 + dK * dT) - dFirst;
+                pdLevel[ui32Idx] = dA + dB * StimulusSin(StimulusFrac(dCycles));
+            }
+            break;
+
+        case SIM_STIMULUS_STEP:
+            for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+                pdLevel[ui32Idx] = (dStart + ui32Idx * dStep < dPeriod) ? dA :
+                                                                         dB;
+            break;
+
+        case SIM_STIMULUS_NOISE:
+            for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+                pdLevel[ui32Idx] = dA + dB *
+                                   (2 * StimulusHash(psStimulus->ui64Seed,
+                                                     ui64First + ui32Idx) - 1);
+            break;
+
+        default:
+            for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+                pdLevel[ui32Idx] = dA;
+            break;
+    }
+
+    for(ui32Idx = 0; ui32Idx < SIM_STIMULUS_BATCH; ui32Idx++)
+    {
+        dT = pdLevel[ui32Idx];
+        dT = (dT < 0.0) ? 0.0 : dT;
+        dT = (dT > SIM_STIMULUS_MAX) ? SIM_STIMULUS_MAX : dT;
+        psStimulus->pui16Batch[ui32Idx] = (uint16_t)(int32_t)(dT + 0.5);
+    }
+
+    psStimulus->ui64Batch = ui64First;
+    psStimulus->bBatch = true;
+}
+
+/*
+ * Returns the level at simulated time ui64Time, in picoseconds.  A walk
+ * takes a new step on every call, that is on every conversion.
+ */
+uint16_t
+SimStimulusLevel(tSimStimulus *psStimulus, uint64_t ui64Time)
+{
+    uint64_t ui64Point;
+
+    if(psStimulus->eKind == SIM_STIMULUS_WALK)
+    {
+        psStimulus->dLevel += psStimulus->dB *
+                              (2 * StimulusUniform(psStimulus) - 1);
+        psStimulus->dLevel = fmin(fmax(psStimulus->dLevel, 0.0),
+                                  SIM_STIMULUS_MAX);
+
+        return((uint16_t)lround(psStimulus->dLevel));
+    }
+
+    if(psStimulus->eKind == SIM_STIMULUS_FILE)
+    {
+        ui64Point = (uint64_t)((unsigned __int128)ui64Time *
+                               psStimulus->ui32Rate / SIM_PS_PER_SECOND);
+
+        return(le16toh(psStimulus->pui16Samples[ui64Point %
+                                                psStimulus->ui64Samples]) &
+               SIM_STIMULUS_MAX);
+    }
+
+    ui64Point = ui64Time / SIM_STIMULUS_GRID_PS;
+
+    if(!psStimulus->bBatch ||
+       (ui64Point - psStimulus->ui64Batch >= SIM_STIMULUS_BATCH))
+        StimulusFill(psStimulus, ui64Point);
+
+    return(psStimulus->pui16Batch[ui64Point - psStimulus->ui64Batch]);
+}
+
+/*
+ * Writes a profile in the form SimStimulusParse() takes.
+ */
+int
+SimStimulusFormat(const tSimStimulus *psStimulus, char *pcBuf, size_t szBuf)
+{
+    const char *pcName = g_psKinds[psStimulus->eKind].pcName;
+
+    if(psStimulus->eKind == SIM_STIMULUS_FILE)
+        return(snprintf(pcBuf, szBuf, "%s:%s:%u", pcName, psStimulus->pcPath,
+                        psStimulus->ui32Rate));
+
+    switch(g_psKinds[psStimulus->eKind].ui32Params)
+    {
+        case 1:
+            return(snprintf(pcBuf, szBuf, "%s:%g", pcName, psStimulus->dA));
+
+        case 2:
+            return(snprintf(pcBuf, szBuf, "%s:%g:%g", pcName, psStimulus->dA,
+                            psStimulus->dB));
+
+        case 3:
+            return(snprintf(pcBuf, szBuf, "%s:%g:%g:%g", pcName,
+                            psStimulus->dA, psStimulus->dB,
+                            psStimulus->dPeriod));
+
+        case 5:
+            return(snprintf(pcBuf, szBuf, "%s:%g:%g:%g:%g:%g", pcName,
+                            psStimulus->dA, psStimulus->dB,
+                            psStimulus->dPeriod, psStimulus->dF0,
+                            psStimulus->dF1));
+
+        default:
+            return(snprintf(pcBuf, szBuf, "%s", pcName));
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef __SIM_STIMULUS_H__
+#define __SIM_STIMULUS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Levels applied to an analog input over simulated time, as 12-bit ADC
+ * results.  A profile is written as its kind followed by its parameters,
+ * separated by colons; times are in seconds and frequencies in hertz:
+ *
+ *     const:LEVEL
+ *     ramp:FROM:TO:PERIOD         sawtooth from FROM to TO
+ *     square:LOW:HIGH:PERIOD
+ *     sine:MID:AMPLITUDE:PERIOD
+ *     chirp:MID:AMPLITUDE:PERIOD:F0:F1
+ *                                 sine sweeping from F0 to F1 over PERIOD,
+ *                                 then starting over
+ *     step:FROM:TO:TIME           FROM until TIME, TO from then on
+ *     noise:MID:AMPLITUDE         uniform noise around MID
+ *     walk:START:STEP             random walk of up to STEP per conversion
+ *     file:PATH[:RATE]            samples recorded at RATE per second
+ *                                 (1000000 if not given), played in a loop
+ *     random                      a const, ramp, square, sine, noise or
+ *                                 walk profile with parameters drawn from
+ *                                 the seed
+ *
+ * A recording is a file of 16-bit little endian samples, of which the low
+ * 12 bits are used.  It is mapped into memory rather than read, so it can
+ * be larger than memory and a sample costs a load; the mapping is shared by
+ * copies of the profile and lasts until the process exits.
+ *
+ * The generators other than the walk are sampled every SIM_STIMULUS_GRID_PS,
+ * the period of the ADC at its full rate, and the level at a conversion is
+ * that of the last grid point.  They are computed SIM_STIMULUS_BATCH grid
+ * points at a time in loops without calls or branches, which the compiler
+ * turns into vector instructions (all but the hash of the noise), and a
+ * conversion mostly only looks its level up in the batch.
+ *
+ * The noise, the walk and the parameters of random profiles come from the
+ * seed given to SimStimulusInit(), so a run is reproducible.  The noise at
+ * a grid point depends on the seed and the point alone, whatever the
+ * conversions before.
+ */
+typedef enum
+{
+    SIM_STIMULUS_CONST,
+    SIM_STIMULUS_RAMP,
+    SIM_STIMULUS_SQUARE,
+    SIM_STIMULUS_SINE,
+    SIM_STIMULUS_CHIRP,
+    SIM_STIMULUS_STEP,
+    SIM_STIMULUS_NOISE,
+    SIM_STIMULUS_WALK,
+    SIM_STIMULUS_FILE,
+    SIM_STIMULUS_RANDOM
+} tSimStimulusKind;
+
+#define SIM_STIMULUS_MAX        4095
+#define SIM_STIMULUS_GRID_PS    1000000ULL
+#define SIM_STIMULUS_BATCH      256
+
+typedef struct
+{
+    tSimStimulusKind eKind;
+    double dA;
+    double dB;
+    double dPeriod;
+    double dF0;
+    double dF1;
+
+    /*
+     * The mapped samples of a recording and their rate.
+     */
+    const char *pcPath;
+    const uint16_t *pui16Samples;
+    uint64_t ui64Samples;
+    uint32_t ui32Rate;
+
+    /*
+     * State of the random number generator and level of a walk.
+     */
+    uint64_t ui64State;
+    uint64_t ui64Seed;
+    double dLevel;
+
+    /*
+     * Levels of the grid points from ui64Batch on.
+     */
+    uint64_t ui64Batch;
+    bool bBatch;
+    uint16_t pui16Batch[SIM_STIMULUS_BATCH];
+} tSimStimulus;
+
+bool SimStimulusParse(tSimStimulus *psStimulus, const char *pcSpec);
+void SimStimulusInit(tSimStimulus *psStimulus, uint64_t ui64Seed);
+uint16_t SimStimulusLevel(tSimStimulus *psStimulus, uint64_t ui64Time);
+int SimStimulusFormat(const tSimStimulus *psStimulus, char *pcBuf,
+                      size_t szBuf);
+
+#endif
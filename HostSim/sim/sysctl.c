@@ -0,0 +1,373 @@
+/*
+ * System control: clocking, peripheral clock gating and reset status.
+ */
+#include <string.h>
+
+#include "board.h"
+
+#define SYSCTL_O_DID0           0x000
+#define SYSCTL_O_DID1           0x004
+#define SYSCTL_O_DC0            0x008
+#define SYSCTL_O_RIS            0x050
+#define SYSCTL_O_IMC            0x054
+#define SYSCTL_O_MISC           0x058
+#define SYSCTL_O_GPIOHBCTL      0x06C
+#define SYSCTL_O_RCGC0          0x100
+#define SYSCTL_O_RCGC1          0x104
+#define SYSCTL_O_RCGC2          0x108
+#define SYSCTL_O_PLLSTAT        0x168
+#define SYSCTL_O_PPBASE         0x300
+
+#define SYSCTL_RIS_PLLLRIS      0x00000040U
+#define SYSCTL_RIS_MOSCPUPRIS   0x00000100U
+
+#define SYSCTL_RCC_OSCSRC_S     4
+#define SYSCTL_RCC_XTAL_S       6
+#define SYSCTL_RCC_BYPASS       0x00000800U
+#define SYSCTL_RCC_USESYSDIV    0x00400000U
+#define SYSCTL_RCC_SYSDIV_S     23
+#define SYSCTL_RCC2_USERCC2     0x80000000U
+#define SYSCTL_RCC2_DIV400      0x40000000U
+#define SYSCTL_RCC2_SYSDIV2_S   23
+#define SYSCTL_RCC2_SYSDIV2LSB  0x00400000U
+#define SYSCTL_RCC2_BYPASS2     0x00000800U
+
+/*
+ * Clock periods in picoseconds.
+ */
+#define SYSCTL_PLL_PS           2500U
+#define SYSCTL_PIOSC_PS         62500U
+#define SYSCTL_LFIOSC_PS        33333333U
+#define SYSCTL_HIBOSC_PS        30517578U
+
+/*
+ * Crystal periods indexed by RCC.XTAL, zero for reserved values.
+ */
+static const uint32_t g_pui32XtalPs[32] =
+{
+    0, 0, 0, 0, 0, 0,
+    250000, 244141, 203451, 200000, 195313, 166667, 162760, 135634,
+    125000, 122070, 100000, 83333, 81380, 73746, 69841, 62500,
+    61035, 55556, 50000, 41667, 40000, 0, 0, 0, 0, 0
+};
+
+/*
+ * Peripherals present on the TM4C123GH6PM, as reported by the PPxxx and
+ * indexed by the offset of the register in each block.
+ */
+static const struct
+{
+    uint16_t ui16Offset;
+    uint32_t ui32Mask;
+}
+g_psPeripherals[] =
+{
+    { 0x000, 0x03 },        // Watchdog
+    { 0x004, 0x3F },        // Timer
+    { 0x008, 0x3F },        // GPIO
+    { 0x00C, 0x01 },        // uDMA
+    { 0x014, 0x01 },        // Hibernation
+    { 0x018, 0xFF },        // UART
+    { 0x01C, 0x0F },        // SSI
+    { 0x020, 0x0F },        // I2C
+    { 0x028, 0x01 },        // USB
+    { 0x034, 0x03 },        // CAN
+    { 0x038, 0x03 },        // ADC
+    { 0x03C, 0x01 },        // Analog comparator
+    { 0x040, 0x03 },        // PWM
+    { 0x044, 0x03 },        // QEI
+    { 0x058, 0x01 },        // EEPROM
+    { 0x05C, 0x3F },        // Wide timer
+};
+
+/*
+ * Bits of the legacy RCGC0, RCGC1 and RCGC2 registers and the RCGCxxx bits
+ * they alias.
+ */
+static const struct
+{
+    uint16_t ui16Legacy;
+    uint8_t ui8LegacyBit;
+    uint16_t ui16Offset;
+    uint8_t ui8Bit;
+}
+g_psLegacy[] =
+{
+    { SYSCTL_O_RCGC0, 3, 0x000, 0 },
+    { SYSCTL_O_RCGC0, 28, 0x000, 1 },
+    { SYSCTL_O_RCGC0, 6, 0x014, 0 },
+    { SYSCTL_O_RCGC0, 16, 0x038, 0 },
+    { SYSCTL_O_RCGC0, 17, 0x038, 1 },
+    { SYSCTL_O_RCGC0, 20, 0x040, 0 },
+    { SYSCTL_O_RCGC0, 24, 0x034, 0 },
+    { SYSCTL_O_RCGC0, 25, 0x034, 1 },
+    { SYSCTL_O_RCGC1, 0, 0x018, 0 },
+    { SYSCTL_O_RCGC1, 1, 0x018, 1 },
+    { SYSCTL_O_RCGC1, 2, 0x018, 2 },
+    { SYSCTL_O_RCGC1, 4, 0x01C, 0 },
+    { SYSCTL_O_RCGC1, 5, 0x01C, 1 },
+    { SYSCTL_O_RCGC1, 8, 0x044, 0 },
+    { SYSCTL_O_RCGC1, 9, 0x044, 1 },
+    { SYSCTL_O_RCGC1, 12, 0x020, 0 },
+    { SYSCTL_O_RCGC1, 14, 0x020, 1 },
+    { SYSCTL_O_RCGC1, 16, 0x004, 0 },
+    { SYSCTL_O_RCGC1, 17, 0x004, 1 },
+    { SYSCTL_O_RCGC1, 18, 0x004, 2 },
+    { SYSCTL_O_RCGC1, 19, 0x004, 3 },
+    { SYSCTL_O_RCGC1, 24, 0x03C, 0 },
+    { SYSCTL_O_RCGC2, 0, 0x008, 0 },
+    { SYSCTL_O_RCGC2, 1, 0x008, 1 },
+    { SYSCTL_O_RCGC2, 2, 0x008, 2 },
+    { SYSCTL_O_RCGC2, 3, 0x008, 3 },
+    { SYSCTL_O_RCGC2, 4, 0x008, 4 },
+    { SYSCTL_O_RCGC2, 5, 0x008, 5 },
+    { SYSCTL_O_RCGC2, 13, 0x00C, 0 },
+    { SYSCTL_O_RCGC2, 16, 0x028, 0 },
+};
+
+#define NUM_PERIPHERALS     (sizeof(g_psPeripherals) / sizeof(g_psPeripherals[0]))
+#define NUM_LEGACY          (sizeof(g_psLegacy) / sizeof(g_psLegacy[0]))
+
+#define REG(psSysCtl, ui32Offset)   ((psSysCtl)->pui32Reg[(ui32Offset) / 4])
+
+void
+SimSysCtlReset(tSimSysCtl *psSysCtl, uint32_t ui32Cause)
+{
+    uint32_t ui32Resc = REG(psSysCtl, SIM_SYSCTL_O_RESC);
+    uint32_t ui32Idx;
+
+    memset(psSysCtl, 0, sizeof(*psSysCtl));
+
+    /*
+     * A power-on reset clears the previously latched causes.
+     */
+    if(ui32Cause & SIM_RESET_POR)
+        ui32Resc = 0;
+
+    REG(psSysCtl, SYSCTL_O_DID0) = 0x18050102U;
+    REG(psSysCtl, SYSCTL_O_DID1) = 0x10A1606EU;
+    REG(psSysCtl, SYSCTL_O_DC0) = 0x007F007FU;
+    REG(psSysCtl, SYSCTL_O_RIS) = SYSCTL_RIS_PLLLRIS | SYSCTL_RIS_MOSCPUPRIS;
+    REG(psSysCtl, SIM_SYSCTL_O_RESC) = ui32Resc | ui32Cause;
+    REG(psSysCtl, SIM_SYSCTL_O_RCC) = 0x078E3AD1U;
+    REG(psSysCtl, SYSCTL_O_GPIOHBCTL) = 0x00007E00U;
+    REG(psSysCtl, SIM_SYSCTL_O_RCC2) = 0x07C06810U;
+    REG(psSysCtl, SYSCTL_O_PLLSTAT) = 0x00000001U;
+
+    for(ui32Idx = 0; ui32Idx < NUM_PERIPHERALS; ui32Idx++)
+        REG(psSysCtl, SYSCTL_O_PPBASE + g_psPeripherals[ui32Idx].ui16Offset) =
+            g_psPeripherals[ui32Idx].ui32Mask;
+}
+
+/*
+ * Returns the system clock period, in picoseconds, selected by RCC and RCC2.
+ */
+uint64_t
+SimSysCtlClockPeriod(const tSimSysCtl *psSysCtl)
+{
+    uint32_t ui32RCC = REG(psSysCtl, SIM_SYSCTL_O_RCC);
+    uint32_t ui32RCC2 = REG(psSysCtl, SIM_SYSCTL_O_RCC2);
+    bool bUseRCC2 = (ui32RCC2 & SYSCTL_RCC2_USERCC2) != 0;
+    uint32_t ui32Src, ui32Div;
+    uint64_t ui64Period;
+    bool bBypass;
+
+    if(bUseRCC2)
+    {
+        ui32Src = (ui32RCC2 >> SYSCTL_RCC_OSCSRC_S) & 7;
+        bBypass = (ui32RCC2 & SYSCTL_RCC2_BYPASS2) != 0;
+    }
+    else
+    {
+        ui32Src = (ui32RCC >> SYSCTL_RCC_OSCSRC_S) & 3;
+        bBypass = (ui32RCC & SYSCTL_RCC_BYPASS) != 0;
+    }
+
+    if(!bBypass)
+    {
+        /*
+         * The PLL runs at 400 MHz and is divided by two unless DIV400 is
+         * set, in which case SYSDIV2LSB extends the divisor.
+         */
+        if(bUseRCC2 && (ui32RCC2 & SYSCTL_RCC2_DIV400))
+        {
+            ui32Div = ((ui32RCC2 >> 22) & 0x7F) + 1;
+            return((uint64_t)SYSCTL_PLL_PS * ui32Div);
+        }
+
+        ui32Div = bUseRCC2 ? ((ui32RCC2 >> SYSCTL_RCC2_SYSDIV2_S) & 0x3F) + 1 :
+                  ((ui32RCC >> SYSCTL_RCC_SYSDIV_S) & 0xF) + 1;
+
+        return((uint64_t)SYSCTL_PLL_PS * 2 * ui32Div);
+    }
+
+    switch(ui32Src)
+    {
+        case 0:
+            ui64Period = g_pui32XtalPs[(ui32RCC >> SYSCTL_RCC_XTAL_S) & 0x1F];
+
+            if(!ui64Period)
+                ui64Period = SYSCTL_PIOSC_PS;
+            break;
+
+        case 1:
+            ui64Period = SYSCTL_PIOSC_PS;
+            break;
+
+        case 2:
+            ui64Period = SYSCTL_PIOSC_PS * 4;
+            break;
+
+        case 3:
+            ui64Period = SYSCTL_LFIOSC_PS;
+            break;
+
+        default:
+            ui64Period = SYSCTL_HIBOSC_PS;
+            break;
+    }
+
+    if(ui32RCC & SYSCTL_RCC_USESYSDIV)
+    {
+        ui32Div = bUseRCC2 ? ((ui32RCC2 >> SYSCTL_RCC2_SYSDIV2_S) & 0x3F) + 1 :
+                  ((ui32RCC >> SYSCTL_RCC_SYSDIV_S) & 0xF) + 1;
+        ui64Period *= ui32Div;
+    }
+
+    return(ui64Period);
+}
+
+static uint32_t
+SysCtlLegacyRead(const tSimSysCtl *psSysCtl, uint32_t ui32Offset)
+{
+    uint32_t ui32Value = 0, ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NUM_LEGACY; ui32Idx++)
+    {
+        if((g_psLegacy[ui32Idx].ui16Legacy == ui32Offset) &&
+           SimSysCtlClocked(psSysCtl, g_psLegacy[ui32Idx].ui16Offset,
+                            g_psLegacy[ui32Idx].ui8Bit))
+            ui32Value |= 1U << g_psLegacy[ui32Idx].ui8LegacyBit;
+    }
+
+    return(ui32Value);
+}
+
+static void
+SysCtlLegacyWrite(tSimSysCtl *psSysCtl, uint32_t ui32Offset,
+                  uint32_t ui32Value)
+{
+    uint32_t ui32Idx, ui32Reg;
+
+    for(ui32Idx = 0; ui32Idx < NUM_LEGACY; ui32Idx++)
+    {
+        if(g_psLegacy[ui32Idx].ui16Legacy != ui32Offset)
+            continue;
+
+        ui32Reg = (SIM_SYSCTL_O_RCGCBASE + g_psLegacy[ui32Idx].ui16Offset) / 4;
+
+        if((ui32Value >> g_psLegacy[ui32Idx].ui8LegacyBit) & 1)
+            psSysCtl->pui32Reg[ui32Reg] |= 1U << g_psLegacy[ui32Idx].ui8Bit;
+        else
+            psSysCtl->pui32Reg[ui32Reg] &= ~(1U << g_psLegacy[ui32Idx].ui8Bit);
+    }
+}
+
+uint32_t
+SimSysCtlRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek)
+{
+    tSimSysCtl *psSysCtl = &psBoard->sSysCtl;
+
+    (void)bPeek;
+
+    switch(ui32Offset)
+    {
+        case SYSCTL_O_MISC:
+            return(REG(psSysCtl, SYSCTL_O_RIS) & REG(psSysCtl, SYSCTL_O_IMC));
+
+        case SYSCTL_O_RCGC0:
+        case SYSCTL_O_RCGC1:
+        case SYSCTL_O_RCGC2:
+            return(SysCtlLegacyRead(psSysCtl, ui32Offset));
+
+        default:
+            break;
+    }
+
+    /*
+     * Peripherals are ready as soon as their clock is enabled.
+     */
+    if((ui32Offset >= SIM_SYSCTL_O_PRBASE) &&
+       (ui32Offset < SIM_SYSCTL_O_PRBASE + 0x100))
+        return(REG(psSysCtl, ui32Offset - SIM_SYSCTL_O_PRBASE +
+                   SIM_SYSCTL_O_RCGCBASE));
+
+    return(REG(psSysCtl, ui32Offset & 0xFFC));
+}
+
+void
+SimSysCtlWrite(tSimBoard *psBoard, uint32_t ui32Offset, uint32_t ui32Value)
+{
+    tSimSysCtl *psSysCtl = &psBoard->sSysCtl;
+    uint32_t ui32Idx;
+
+    switch(ui32Offset)
+    {
+        case SYSCTL_O_DID0:
+        case SYSCTL_O_DID1:
+        case SYSCTL_O_DC0:
+        case SYSCTL_O_RIS:
+        case SYSCTL_O_PLLSTAT:
+            return;
+
+        case SYSCTL_O_MISC:
+            REG(psSysCtl, SYSCTL_O_RIS) &= ~ui32Value;
+            return;
+
+        case SIM_SYSCTL_O_RESC:
+            REG(psSysCtl, SIM_SYSCTL_O_RESC) = ui32Value;
+            return;
+
+        case SIM_SYSCTL_O_RCC:
+        case SIM_SYSCTL_O_RCC2:
+            REG(psSysCtl, ui32Offset) = ui32Value;
+            SimBoardClockSet(psBoard, SimSysCtlClockPeriod(psSysCtl));
+
+            /*
+             * The PLL locks instantly; report it so that drivers polling
+             * for the lock do not spin.
+             */
+            REG(psSysCtl, SYSCTL_O_RIS) |= SYSCTL_RIS_PLLLRIS;
+            return;
+
+        case SYSCTL_O_RCGC0:
+        case SYSCTL_O_RCGC1:
+        case SYSCTL_O_RCGC2:
+            SysCtlLegacyWrite(psSysCtl, ui32Offset, ui32Value);
+            return;
+
+        default:
+            break;
+    }
+
+    /*
+     * The peripheral present and ready registers are read-only.
+     */
+    if(((ui32Offset >= SYSCTL_O_PPBASE) &&
+        (ui32Offset < SYSCTL_O_PPBASE + 0x100)) ||
+       ((ui32Offset >= SIM_SYSCTL_O_PRBASE) &&
+        (ui32Offset < SIM_SYSCTL_O_PRBASE + 0x100)))
+        return;
+
+    /*
+     * Only implemented peripherals can have their clocks enabled.
+     */
+    if((ui32Offset >= SIM_SYSCTL_O_RCGCBASE) &&
+       (ui32Offset < SIM_SYSCTL_O_RCGCBASE + 0x300))
+    {
+        ui32Idx = (ui32Offset & 0xFF) + SYSCTL_O_PPBASE;
+        ui32Value &= REG(psSysCtl, ui32Idx);
+    }
+
+    REG(psSysCtl, ui32Offset & 0xFFC) = ui32Value;
+}
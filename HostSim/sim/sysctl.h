@@ -0,0 +1,56 @@
+#ifndef __SIM_SYSCTL_H__
+#define __SIM_SYSCTL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+/*
+ * Register offsets used outside of the system control model.
+ */
+#define SIM_SYSCTL_O_RESC       0x05C
+#define SIM_SYSCTL_O_RCC        0x060
+#define SIM_SYSCTL_O_RCC2       0x070
+#define SIM_SYSCTL_O_RCGCBASE   0x600
+#define SIM_SYSCTL_O_PRBASE     0xA00
+
+/*
+ * Reset causes, as reported in RESC.
+ */
+#define SIM_RESET_EXT           0x00000001U
+#define SIM_RESET_POR           0x00000002U
+#define SIM_RESET_BOR           0x00000004U
+#define SIM_RESET_WDT0          0x00000008U
+#define SIM_RESET_SW            0x00000010U
+#define SIM_RESET_WDT1          0x00000020U
+#define SIM_RESET_MOSCFAIL      0x00010000U
+
+/*
+ * System control is a plain register file; only the registers with side
+ * effects are decoded on access.
+ */
+typedef struct
+{
+    uint32_t pui32Reg[1024];
+} tSimSysCtl;
+
+void SimSysCtlReset(tSimSysCtl *psSysCtl, uint32_t ui32Cause);
+uint32_t SimSysCtlRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek);
+void SimSysCtlWrite(tSimBoard *psBoard, uint32_t ui32Offset,
+                    uint32_t ui32Value);
+uint64_t SimSysCtlClockPeriod(const tSimSysCtl *psSysCtl);
+
+/*
+ * Returns true if the run mode clock of a peripheral is enabled.  The offset
+ * selects one of the RCGCxxx registers, e.g. 0x008 for GPIO.
+ */
+static inline bool
+SimSysCtlClocked(const tSimSysCtl *psSysCtl, uint32_t ui32Offset,
+                 uint32_t ui32Instance)
+{
+    return((psSysCtl->pui32Reg[(SIM_SYSCTL_O_RCGCBASE + ui32Offset) / 4] >>
+            ui32Instance) & 1);
+}
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * SysTick timer.
+ */
+#include <string.h>
+
+#include "board.h"
+
+static uint64_t
+SysTickPeriod(const tSimBoard *psBoard)
+{
+    if(psBoard->sSysTick.ui32Ctrl & SIM_SYSTICK_CLKSOURCE)
+        return(psBoard->ui32CyclePs);
+
+    return(SIM_SYSTICK_ALTCLK_PS);
+}
+
+void
+SimSysTickReset(tSimSysTick *psSysTick)
+{
+    memset(psSysTick, 0, sizeof(*psSysTick));
+    psSysTick->ui32Ctrl = SIM_SYSTICK_CLKSOURCE;
+}
+
+/*
+ * Brings ui32Value up to date with the current time.  The zero crossings
+ * themselves are handled by SimSysTickEvent(), so at most one reload can lie
+ * between the epoch and now.
+ */
+void
+SimSysTickSync(tSimBoard *psBoard)
+{
+    tSimSysTick *psSysTick = &psBoard->sSysTick;
+    uint64_t ui64Period, ui64Ticks;
+
+    if(!(psSysTick->ui32Ctrl & SIM_SYSTICK_ENABLE) ||
+       (psBoard->ui64Time <= psSysTick->ui64Epoch))
+        return;
+
+    ui64Period = SysTickPeriod(psBoard);
+    ui64Ticks = (psBoard->ui64Time - psSysTick->ui64Epoch) / ui64Period;
+
+    if(!ui64Ticks)
+        return;
+
+    if(psSysTick->ui32Value)
+    {
+        psSysTick->ui32Value = (ui64Ticks < psSysTick->ui32Value) ?
+                               psSysTick->ui32Value - (uint32_t)ui64Ticks : 0;
+    }
+    else if(psSysTick->ui32Load)
+    {
+        psSysTick->ui32Value =
+            (ui64Ticks <= psSysTick->ui32Load) ?
+            psSysTick->ui32Load + 1 - (uint32_t)ui64Ticks : 0;
+    }
+
+    psSysTick->ui64Epoch += ui64Ticks * ui64Period;
+}
+
+/*
+ * Schedules the next transition of the counter to zero.
+ */
+void
+SimSysTickSchedule(tSimBoard *psBoard)
+{
+    tSimSysTick *psSysTick = &psBoard->sSysTick;
+    uint64_t ui64Ticks;
+
+    ui64Ticks = psSysTick->ui32Value ? psSysTick->ui32Value :
+                (uint64_t)psSysTick->ui32Load + 1;
+
+    if(!(psSysTick->ui32Ctrl & SIM_SYSTICK_ENABLE) ||
+       (!psSysTick->ui32Value && !psSysTick->ui32Load))
+    {
+        SimEventCancel(&psBoard->sEvents, SIM_EVENT_SYSTICK);
+        return;
+    }
+
+    SimEventSchedule(&psBoard->sEvents, SIM_EVENT_SYSTICK,
+                     psSysTick->ui64Epoch +
+                     ui64Ticks * SysTickPeriod(psBoard));
+}
+
+void
+SimSysTickEvent(tSimBoard *psBoard, uint64_t ui64Deadline)
+{
+    tSimSysTick *psSysTick = &psBoard->sSysTick;
+
+    psSysTick->ui64Epoch = ui64Deadline;
+    psSysTick->ui32Value = 0;
+    psSysTick->bCountFlag = true;
+
+    if(psSysTick->ui32Ctrl & SIM_SYSTICK_TICKINT)
+        SimNVICSetPending(&psBoard->sNVIC, SIM_EXC_SYSTICK);
+
+    SimSysTickSchedule(psBoard);
+}
+
+uint32_t
+SimSysTickRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek)
+{
+    tSimSysTick *psSysTick = &psBoard->sSysTick;
+    uint32_t ui32Value;
+
+    switch(ui32Offset)
+    {
+        case SIM_SYSTICK_O_CTRL:
+            ui32Value = psSysTick->ui32Ctrl;
+
+            if(psSysTick->bCountFlag)
+                ui32Value |= SIM_SYSTICK_COUNTFLAG;
+
+            if(!bPeek)
+                psSysTick->bCountFlag = false;
+
+            return(ui32Value);
+
+        case SIM_SYSTICK_O_LOAD:
+            return(psSysTick->ui32Load);
+
+        case SIM_SYSTICK_O_VAL:
+            SimSysTickSync(psBoard);
+            return(psSysTick->ui32Value);
+
+        case SIM_SYSTICK_O_CALIB:
+            return(0xC0000000U);
+
+        default:
+            return(0);
+    }
+}
+
+void
+SimSysTickWrite(tSimBoard *psBoard, uint32_t ui32Offset, uint32_t ui32Value)
+{
+    tSimSysTick *psSysTick = &psBoard->sSysTick;
+
+    SimSysTickSync(psBoard);
+
+    switch(ui32Offset)
+    {
+        case SIM_SYSTICK_O_CTRL:
+            /*
+             * The counter starts from the current value on the first clock
+             * edge after it is enabled.
+             */
+            if((ui32Value & SIM_SYSTICK_ENABLE) &&
+               !(psSysTick->ui32Ctrl & SIM_SYSTICK_ENABLE))
+                psSysTick->ui64Epoch = psBoard->ui64Time;
+
+            psSysTick->ui32Ctrl = ui32Value & (SIM_SYSTICK_ENABLE |
+                                               SIM_SYSTICK_TICKINT |
+                                               SIM_SYSTICK_CLKSOURCE);
+            break;
+
+        case SIM_SYSTICK_O_LOAD:
+            psSysTick->ui32Load = ui32Value & 0x00FFFFFFU;
+            break;
+
+        case SIM_SYSTICK_O_VAL:
+            /*
+             * Any write clears the counter and COUNTFLAG; the next clock edge
+             * reloads it.
+             */
+            psSysTick->ui32Value = 0;
+            psSysTick->ui64Epoch = psBoard->ui64Time;
+            psSysTick->bCountFlag = false;
+            break;
+
+        default:
+            return;
+    }
+
+    SimSysTickSchedule(psBoard);
+}
@@ -0,0 +1,48 @@
+#ifndef __SIM_SYSTICK_H__
+#define __SIM_SYSTICK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+/*
+ * SysTick register offsets within the system control space.
+ */
+#define SIM_SYSTICK_O_CTRL      0x010
+#define SIM_SYSTICK_O_LOAD      0x014
+#define SIM_SYSTICK_O_VAL       0x018
+#define SIM_SYSTICK_O_CALIB     0x01C
+
+#define SIM_SYSTICK_ENABLE      0x00000001U
+#define SIM_SYSTICK_TICKINT     0x00000002U
+#define SIM_SYSTICK_CLKSOURCE   0x00000004U
+#define SIM_SYSTICK_COUNTFLAG   0x00010000U
+
+/*
+ * Period of the alternate SysTick clock (PIOSC / 4) in picoseconds.
+ */
+#define SIM_SYSTICK_ALTCLK_PS   250000U
+
+/*
+ * The counter is evaluated lazily: while it runs, ui32Value holds the count
+ * at ui64Epoch, which always lies on a counter clock edge.
+ */
+typedef struct
+{
+    uint32_t ui32Ctrl;
+    uint32_t ui32Load;
+    uint32_t ui32Value;
+    bool bCountFlag;
+    uint64_t ui64Epoch;
+} tSimSysTick;
+
+void SimSysTickReset(tSimSysTick *psSysTick);
+uint32_t SimSysTickRead(tSimBoard *psBoard, uint32_t ui32Offset, bool bPeek);
+void SimSysTickWrite(tSimBoard *psBoard, uint32_t ui32Offset,
+                     uint32_t ui32Value);
+void SimSysTickSync(tSimBoard *psBoard);
+void SimSysTickSchedule(tSimBoard *psBoard);
+void SimSysTickEvent(tSimBoard *psBoard, uint64_t ui64Deadline);
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Decoder of telemetry frames (see telemetry.h).
+ */
+#include <string.h>
+
+#include "telemetry.h"
+
+/*
+ * The CRC-16/CCITT-FALSE of every byte value, built on first use.
+ */
+static uint16_t g_pui16TelemetryCRC[256];
+
+static void
+TelemetryCRCTable(void)
+{
+    uint32_t ui32Byte, ui32Bit;
+    uint16_t ui16CRC;
+
+    for(ui32Byte = 0; ui32Byte < 256; ui32Byte++)
+    {
+        ui16CRC = (uint16_t)(ui32Byte << 8);
+
+        for(ui32Bit = 0; ui32Bit < 8; ui32Bit++)
+            ui16CRC = (uint16_t)((ui16CRC << 1) ^
+                                 ((ui16CRC & 0x8000) ? 0x1021 : 0));
+
+        g_pui16TelemetryCRC[ui32Byte] = ui16CRC;
+    }
+}
+
+/*
+ * Adds bytes to a CRC-16/CCITT-FALSE, which starts from 0xFFFF.  A frame,
+ * CRC included, comes to zero.
+ */
+uint16_t
+SimTelemetryCRC(uint16_t ui16CRC, const uint8_t *pui8Bytes, size_t szBytes)
+{
+    if(!g_pui16TelemetryCRC[1])
+        TelemetryCRCTable();
+
+    while(szBytes--)
+        ui16CRC = (uint16_t)(ui16CRC << 8) ^
+                  g_pui16TelemetryCRC[(ui16CRC >> 8) ^ *pui8Bytes++];
+
+    return(ui16CRC);
+}
+
+void
+SimTelemetryInit(tSimTelemetry *psTelemetry, tSimTelemetryHandler pfnHandler,
+                 void *pvContext)
+{
+    memset(psTelemetry, 0, sizeof(*psTelemetry));
+    psTelemetry->pfnHandler = pfnHandler;
+    psTelemetry->pvContext = pvContext;
+
+    SimTelemetryCRC(0xFFFF, NULL, 0);
+}
+
+/*
+ * COBS decodes a frame in place, returning its size or -1 if it is not a
+ * valid encoding.  Decoding never writes ahead of where it reads.
+ */
+static int
+TelemetryUnstuff(uint8_t *pui8Frame, uint32_t ui32Encoded)
+{
+    uint32_t ui32In = 0, ui32Out = 0, ui32Code;
+
+    while(ui32In < ui32Encoded)
+    {
+        ui32Code = pui8Frame[ui32In++];
+
+        if(!ui32Code || (ui32In + ui32Code - 1 > ui32Encoded))
+            return(-1);
+
+        memmove(pui8Frame + ui32Out, pui8Frame + ui32In, ui32Code - 1);
+        ui32In += ui32Code - 1;
+        ui32Out += ui32Code - 1;
+
+        if((ui32Code < 0xFF) && (ui32In < ui32Encoded))
+            pui8Frame[ui32Out++] = 0;
+    }
+
+    return((int)ui32Out);
+}
+
+/*
+ * Decodes the bytes gathered up to a zero.
+ */
+static void
+TelemetryFrame(tSimTelemetry *psTelemetry)
+{
+    tSimTelemetryStats *psStats = &psTelemetry->sStats;
+    tSimTelemetryFrame sFrame;
+    uint8_t *pui8Frame = psTelemetry->pui8Encoded;
+    bool bSynced = psTelemetry->bSynced;
+    int i32Size = -1;
+
+    psTelemetry->bSynced = true;
+
+    /*
+     * Back to back zeros, as before the first frame, are no frame at all.
+     */
+    if(!psTelemetry->ui32Encoded && !psTelemetry->bOverrun)
+        return;
+
+    if(!psTelemetry->bOverrun)
+        i32Size = TelemetryUnstuff(pui8Frame, psTelemetry->ui32Encoded);
+
+    if((i32Size < SIM_TELEMETRY_HEADER + SIM_TELEMETRY_CRC) ||
+       SimTelemetryCRC(0xFFFF, pui8Frame, (size_t)i32Size))
+    {
+        if(bSynced)
+            psStats->ui64Bad++;
+        else
+            psStats->ui64Skipped += psTelemetry->ui32Encoded;
+
+        return;
+    }
+
+    sFrame.ui16Seq = (uint16_t)(pui8Frame[0] | (pui8Frame[1] << 8));
+    sFrame.ui8Channel = pui8Frame[2];
+    sFrame.pui8Data = pui8Frame + SIM_TELEMETRY_HEADER;
+    sFrame.ui32Len = (uint32_t)i32Size - SIM_TELEMETRY_HEADER -
+                     SIM_TELEMETRY_CRC;
+
+    if(psTelemetry->bSeqValid)
+        psStats->ui64Lost += (uint16_t)(sFrame.ui16Seq -
+                                        psTelemetry->ui16NextSeq);
+
+    psTelemetry->ui16NextSeq = sFrame.ui16Seq + 1;
+    psTelemetry->bSeqValid = true;
+
+    psStats->ui64Frames++;
+    psStats->ui64DataBytes += sFrame.ui32Len;
+
+    if(psTelemetry->pfnHandler)
+        psTelemetry->pfnHandler(psTelemetry->pvContext, &sFrame);
+}
+
+/*
+ * Feeds received bytes to the decoder, which calls the handler for every
+ * frame they complete.
+ */
+void
+SimTelemetryFeed(tSimTelemetry *psTelemetry, const uint8_t *pui8Bytes,
+                 size_t szBytes)
+{
+    const uint8_t *pui8End = pui8Bytes + szBytes, *pui8Zero;
+    uint32_t ui32Copy;
+
+    psTelemetry->sStats.ui64Bytes += szBytes;
+
+    while(pui8Bytes < pui8End)
+    {
+        pui8Zero = memchr(pui8Bytes, 0, (size_t)(pui8End - pui8Bytes));
+        ui32Copy = (uint32_t)((pui8Zero ? pui8Zero : pui8End) - pui8Bytes);
+
+        /*
+         * Whatever does not fit is not a frame, but is counted as skipped
+         * if it came before the first one.
+         */
+        if(ui32Copy > SIM_TELEMETRY_ENCODED_MAX - psTelemetry->ui32Encoded)
+        {
+            if(!psTelemetry->bSynced)
+                psTelemetry->sStats.ui64Skipped +=
+                    psTelemetry->ui32Encoded + ui32Copy;
+
+            psTelemetry->bOverrun = true;
+            psTelemetry->ui32Encoded = 0;
+        }
+        else if(!psTelemetry->bOverrun)
+        {
+            memcpy(psTelemetry->pui8Encoded + psTelemetry->ui32Encoded,
+                   pui8Bytes, ui32Copy);
+            psTelemetry->ui32Encoded += ui32Copy;
+        }
+        else if(!psTelemetry->bSynced)
+            psTelemetry->sStats.ui64Skipped += ui32Copy;
+
+        pui8Bytes += ui32Copy;
+
+        if(pui8Zero)
+        {
+            TelemetryFrame(psTelemetry);
+            psTelemetry->ui32Encoded = 0;
+            psTelemetry->bOverrun = false;
+            pui8Bytes++;
+        }
+    }
+}
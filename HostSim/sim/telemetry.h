@@ -0,0 +1,96 @@
+#ifndef __SIM_TELEMETRY_H__
+#define __SIM_TELEMETRY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Decoder of the telemetry frames a firmware built with UART_TELEMETRY sends
+ * with UARTTelemetrySend() (see uarttelemetry.h of the CCS projects).
+ *
+ * The bytes received are fed in as they come, in pieces of any size.  The
+ * decoder gathers them up to each zero, COBS decodes what it gathered, and
+ * if that holds a header, data and a CRC that checks, hands the frame to a
+ * handler.  Missing sequence numbers are counted as frames lost, whether the
+ * firmware dropped them for want of room or the line lost bytes of them.
+ * Anything gathered before the first zero is counted as skipped rather than
+ * as bad, as it is mostly text or the tail of a frame the capture started in
+ * the middle of.
+ *
+ * Must match uarttelemetry.h.
+ */
+#define SIM_TELEMETRY_DATA_MAX  249
+#define SIM_TELEMETRY_HEADER    3
+#define SIM_TELEMETRY_CRC       2
+
+/*
+ * Largest frame before and after encoding, not counting the zero ending it.
+ */
+#define SIM_TELEMETRY_FRAME_MAX (SIM_TELEMETRY_HEADER +                        \
+                                 SIM_TELEMETRY_DATA_MAX + SIM_TELEMETRY_CRC)
+#define SIM_TELEMETRY_ENCODED_MAX \
+                                (SIM_TELEMETRY_FRAME_MAX + 1)
+
+typedef struct
+{
+    uint16_t ui16Seq;
+    uint8_t ui8Channel;
+    const uint8_t *pui8Data;
+    uint32_t ui32Len;
+} tSimTelemetryFrame;
+
+typedef void (*tSimTelemetryHandler)(void *pvContext,
+                                     const tSimTelemetryFrame *psFrame);
+
+typedef struct
+{
+    uint64_t ui64Frames;
+    uint64_t ui64DataBytes;
+    uint64_t ui64Lost;
+
+    /*
+     * Frames that would not decode, were too short or too long, or failed
+     * their CRC.
+     */
+    uint64_t ui64Bad;
+
+    /*
+     * Bytes received before the first frame.
+     */
+    uint64_t ui64Skipped;
+
+    /*
+     * All the bytes fed in.
+     */
+    uint64_t ui64Bytes;
+} tSimTelemetryStats;
+
+typedef struct
+{
+    tSimTelemetryHandler pfnHandler;
+    void *pvContext;
+
+    /*
+     * The bytes gathered since the last zero, and whether there were more
+     * than a frame can have.
+     */
+    uint8_t pui8Encoded[SIM_TELEMETRY_ENCODED_MAX];
+    uint32_t ui32Encoded;
+    bool bOverrun;
+
+    bool bSynced;
+    bool bSeqValid;
+    uint16_t ui16NextSeq;
+
+    tSimTelemetryStats sStats;
+} tSimTelemetry;
+
+void SimTelemetryInit(tSimTelemetry *psTelemetry,
+                      tSimTelemetryHandler pfnHandler, void *pvContext);
+void SimTelemetryFeed(tSimTelemetry *psTelemetry, const uint8_t *pui8Bytes,
+                      size_t szBytes);
+uint16_t SimTelemetryCRC(uint16_t ui16CRC, const uint8_t *pui8Bytes,
+                         size_t szBytes);
+
+#endif
@@ -0,0 +1,3024 @@
+/*
+ * Thumb-2 instruction set of the Cortex-M4: decoder and execution functions.
+ *
+ * Every instruction is decoded once into a tSimInsn that names the function
+ * executing it, with the register numbers and immediates already extracted.
+ * Encodings that differ only in their operands share execution functions.
+ */
+#include <string.h>
+
+#include "thumb.h"
+
+#define REG(n)                  (psCpu->pui32R[(n)])
+
+/*
+ * tSimInsn.ui8Shift of shifted register operands.
+ */
+#define THUMB_SHIFT(type, amount) (((type) << 6) | (amount))
+#define THUMB_SHIFT_TYPE(shift) ((shift) >> 6)
+#define THUMB_SHIFT_AMOUNT(shift) ((shift) & 0x3F)
+
+/*
+ * tSimInsn.ui8Op of loads and stores with writeback and of LDM/STM.
+ */
+#define THUMB_WRITEBACK         0x01
+#define THUMB_INDEX             0x02
+
+#define THUMB_INLINE            static inline __attribute__((always_inline))
+
+static uint32_t
+ThumbSignExtend(uint32_t ui32Value, uint32_t ui32Bits)
+{
+    uint32_t ui32Sign = 1U << (ui32Bits - 1);
+
+    return((ui32Value ^ ui32Sign) - ui32Sign);
+}
+
+static uint32_t
+ThumbRotate(uint32_t ui32Value, uint32_t ui32Amount)
+{
+    ui32Amount &= 31;
+
+    return(ui32Amount ? (ui32Value >> ui32Amount) |
+                        (ui32Value << (32 - ui32Amount)) : ui32Value);
+}
+
+/*
+ * Saturates a signed value to ui32Bits bits, returning true if it had to be
+ * clipped.
+ */
+static bool
+ThumbSignedSat(int64_t i64Value, uint32_t ui32Bits, int32_t *pi32Result)
+{
+    int64_t i64Max = ((int64_t)1 << (ui32Bits - 1)) - 1;
+    int64_t i64Min = -((int64_t)1 << (ui32Bits - 1));
+
+    if(i64Value > i64Max)
+    {
+        *pi32Result = (int32_t)i64Max;
+        return(true);
+    }
+
+    if(i64Value < i64Min)
+    {
+        *pi32Result = (int32_t)i64Min;
+        return(true);
+    }
+
+    *pi32Result = (int32_t)i64Value;
+    return(false);
+}
+
+static bool
+ThumbUnsignedSat(int64_t i64Value, uint32_t ui32Bits, uint32_t *pui32Result)
+{
+    int64_t i64Max = ((int64_t)1 << ui32Bits) - 1;
+
+    if(i64Value > i64Max)
+    {
+        *pui32Result = (uint32_t)i64Max;
+        return(true);
+    }
+
+    if(i64Value < 0)
+    {
+        *pui32Result = 0;
+        return(true);
+    }
+
+    *pui32Result = (uint32_t)i64Value;
+    return(false);
+}
+
+void
+SimThumbUndefined(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_UNDEFINSTR);
+}
+
+static void
+ExecNoCoprocessor(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_NOCP);
+}
+
+/*****************************************************************************
+ *
+ * Data processing.
+ *
+ *****************************************************************************/
+
+/*
+ * Second operands: an immediate, a register, a register shifted by an
+ * immediate and a register shifted by a register (held in ui8Ra).
+ */
+THUMB_INLINE uint32_t
+OperandImm(const tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t *pui32Carry)
+{
+    *pui32Carry = (psInsn->ui8Shift == THUMB_CARRY_KEEP) ? psCpu->ui8C :
+                  psInsn->ui8Shift;
+
+    return(psInsn->ui32Imm);
+}
+
+THUMB_INLINE uint32_t
+OperandReg(const tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t *pui32Carry)
+{
+    *pui32Carry = psCpu->ui8C;
+
+    return(REG(psInsn->ui8Rm));
+}
+
+THUMB_INLINE uint32_t
+OperandShi(const tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t *pui32Carry)
+{
+    return(ThumbShiftC(REG(psInsn->ui8Rm), THUMB_SHIFT_TYPE(psInsn->ui8Shift),
+                       THUMB_SHIFT_AMOUNT(psInsn->ui8Shift), psCpu->ui8C,
+                       pui32Carry));
+}
+
+THUMB_INLINE uint32_t
+OperandShr(const tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t *pui32Carry)
+{
+    uint32_t ui32Amount = REG(psInsn->ui8Ra) & 0xFF;
+
+    if(!ui32Amount)
+    {
+        *pui32Carry = psCpu->ui8C;
+        return(REG(psInsn->ui8Rm));
+    }
+
+    return(ThumbShiftC(REG(psInsn->ui8Rm), THUMB_SHIFT_TYPE(psInsn->ui8Shift),
+                       ui32Amount, psCpu->ui8C, pui32Carry));
+}
+
+/*
+ * The operations.  Logical operations take the carry from the shifter,
+ * arithmetic ones compute carry and overflow.
+ */
+THUMB_INLINE void
+AluLogic(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Result,
+         uint32_t ui32Carry, bool bWrite)
+{
+    if(bWrite)
+        REG(psInsn->ui8Rd) = ui32Result;
+
+    if(!bWrite || ThumbSetFlags(psCpu, psInsn))
+    {
+        ThumbSetNZ(psCpu, ui32Result);
+        psCpu->ui8C = (uint8_t)ui32Carry;
+    }
+}
+
+THUMB_INLINE void
+AluArith(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32A,
+         uint32_t ui32B, uint32_t ui32Carry, bool bWrite)
+{
+    uint32_t ui32Result;
+
+    if(bWrite && !ThumbSetFlags(psCpu, psInsn))
+    {
+        REG(psInsn->ui8Rd) = ui32A + ui32B + ui32Carry;
+        return;
+    }
+
+    ui32Result = ThumbAddWithCarry(ui32A, ui32B, ui32Carry, &psCpu->ui8C,
+                                   &psCpu->ui8V);
+    ThumbSetNZ(psCpu, ui32Result);
+
+    if(bWrite)
+        REG(psInsn->ui8Rd) = ui32Result;
+}
+
+THUMB_INLINE void
+AluAND(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, REG(psInsn->ui8Rn) & ui32Op2, ui32Carry, true);
+}
+
+THUMB_INLINE void
+AluTST(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, REG(psInsn->ui8Rn) & ui32Op2, ui32Carry, false);
+}
+
+THUMB_INLINE void
+AluBIC(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, REG(psInsn->ui8Rn) & ~ui32Op2, ui32Carry, true);
+}
+
+THUMB_INLINE void
+AluORR(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, REG(psInsn->ui8Rn) | ui32Op2, ui32Carry, true);
+}
+
+THUMB_INLINE void
+AluORN(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, REG(psInsn->ui8Rn) | ~ui32Op2, ui32Carry, true);
+}
+
+THUMB_INLINE void
+AluEOR(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, REG(psInsn->ui8Rn) ^ ui32Op2, ui32Carry, true);
+}
+
+THUMB_INLINE void
+AluTEQ(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, REG(psInsn->ui8Rn) ^ ui32Op2, ui32Carry, false);
+}
+
+THUMB_INLINE void
+AluMOV(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, ui32Op2, ui32Carry, true);
+}
+
+THUMB_INLINE void
+AluMVN(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluLogic(psCpu, psInsn, ~ui32Op2, ui32Carry, true);
+}
+
+THUMB_INLINE void
+AluADD(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluArith(psCpu, psInsn, REG(psInsn->ui8Rn), ui32Op2, 0, true);
+}
+
+THUMB_INLINE void
+AluCMN(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluArith(psCpu, psInsn, REG(psInsn->ui8Rn), ui32Op2, 0, false);
+}
+
+THUMB_INLINE void
+AluADC(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluArith(psCpu, psInsn, REG(psInsn->ui8Rn), ui32Op2, psCpu->ui8C, true);
+}
+
+THUMB_INLINE void
+AluSUB(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluArith(psCpu, psInsn, REG(psInsn->ui8Rn), ~ui32Op2, 1, true);
+}
+
+THUMB_INLINE void
+AluCMP(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluArith(psCpu, psInsn, REG(psInsn->ui8Rn), ~ui32Op2, 1, false);
+}
+
+THUMB_INLINE void
+AluSBC(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluArith(psCpu, psInsn, REG(psInsn->ui8Rn), ~ui32Op2, psCpu->ui8C, true);
+}
+
+THUMB_INLINE void
+AluRSB(tSimCpu *psCpu, const tSimInsn *psInsn, uint32_t ui32Op2,
+       uint32_t ui32Carry)
+{
+    AluArith(psCpu, psInsn, ~REG(psInsn->ui8Rn), ui32Op2, 1, true);
+}
+
+#define THUMB_DP_KIND(op, kind)                                               \
+    static void                                                               \
+    Exec##op##kind(tSimMachine *psMachine, const tSimInsn *psInsn)            \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+        uint32_t ui32Carry;                                                   \
+        uint32_t ui32Op2 = Operand##kind(psCpu, psInsn, &ui32Carry);          \
+                                                                              \
+        Alu##op(psCpu, psInsn, ui32Op2, ui32Carry);                           \
+    }
+
+#define THUMB_DP(op)                                                          \
+    THUMB_DP_KIND(op, Imm)                                                    \
+    THUMB_DP_KIND(op, Reg)                                                    \
+    THUMB_DP_KIND(op, Shi)                                                    \
+    THUMB_DP_KIND(op, Shr)
+
+THUMB_DP(AND)
+THUMB_DP(TST)
+THUMB_DP(BIC)
+THUMB_DP(ORR)
+THUMB_DP(ORN)
+THUMB_DP(EOR)
+THUMB_DP(TEQ)
+THUMB_DP(MOV)
+THUMB_DP(MVN)
+THUMB_DP(ADD)
+THUMB_DP(CMN)
+THUMB_DP(ADC)
+THUMB_DP(SUB)
+THUMB_DP(CMP)
+THUMB_DP(SBC)
+THUMB_DP(RSB)
+
+#define THUMB_DP_ROW(op)                                                      \
+    { Exec##op##Imm, Exec##op##Reg, Exec##op##Shi, Exec##op##Shr }
+
+static const tSimExec g_ppfnDataProc[DP_ROWS][4] =
+{
+    [DP_AND] = THUMB_DP_ROW(AND),
+    [DP_BIC] = THUMB_DP_ROW(BIC),
+    [DP_ORR] = THUMB_DP_ROW(ORR),
+    [DP_ORN] = THUMB_DP_ROW(ORN),
+    [DP_EOR] = THUMB_DP_ROW(EOR),
+    [DP_ADD] = THUMB_DP_ROW(ADD),
+    [DP_ADC] = THUMB_DP_ROW(ADC),
+    [DP_SBC] = THUMB_DP_ROW(SBC),
+    [DP_SUB] = THUMB_DP_ROW(SUB),
+    [DP_RSB] = THUMB_DP_ROW(RSB),
+    [DP_TST] = THUMB_DP_ROW(TST),
+    [DP_TEQ] = THUMB_DP_ROW(TEQ),
+    [DP_CMN] = THUMB_DP_ROW(CMN),
+    [DP_CMP] = THUMB_DP_ROW(CMP),
+    [DP_MOV] = THUMB_DP_ROW(MOV),
+    [DP_MVN] = THUMB_DP_ROW(MVN),
+};
+
+/*
+ * MOV and ADD writing the PC (16-bit encodings only).
+ */
+static void
+ExecMovPC(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    psCpu->ui32PC = REG(psInsn->ui8Rm) & ~1U;
+}
+
+static void
+ExecAddPC(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    psCpu->ui32PC = (REG(15) + REG(psInsn->ui8Rm)) & ~1U;
+}
+
+/*****************************************************************************
+ *
+ * Multiplication and division.
+ *
+ *****************************************************************************/
+
+static void
+ExecMUL(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Result = REG(psInsn->ui8Rn) * REG(psInsn->ui8Rm);
+
+    REG(psInsn->ui8Rd) = ui32Result;
+
+    if(ThumbSetFlags(psCpu, psInsn))
+        ThumbSetNZ(psCpu, ui32Result);
+}
+
+static void
+ExecMLA(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = REG(psInsn->ui8Rn) * REG(psInsn->ui8Rm) +
+                         REG(psInsn->ui8Ra);
+}
+
+static void
+ExecMLS(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = REG(psInsn->ui8Ra) -
+                         REG(psInsn->ui8Rn) * REG(psInsn->ui8Rm);
+}
+
+static void
+ExecUDIV(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Divisor = REG(psInsn->ui8Rm);
+
+    if(!ui32Divisor)
+    {
+        if(psMachine->sBoard.sNVIC.ui32CCR & 0x10)
+            SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_DIVBYZERO);
+
+        REG(psInsn->ui8Rd) = 0;
+        return;
+    }
+
+    REG(psInsn->ui8Rd) = REG(psInsn->ui8Rn) / ui32Divisor;
+}
+
+static void
+ExecSDIV(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    int32_t i32Dividend = (int32_t)REG(psInsn->ui8Rn);
+    int32_t i32Divisor = (int32_t)REG(psInsn->ui8Rm);
+
+    if(!i32Divisor)
+    {
+        if(psMachine->sBoard.sNVIC.ui32CCR & 0x10)
+            SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_DIVBYZERO);
+
+        REG(psInsn->ui8Rd) = 0;
+        return;
+    }
+
+    if((i32Dividend == INT32_MIN) && (i32Divisor == -1))
+    {
+        REG(psInsn->ui8Rd) = 0x80000000U;
+        return;
+    }
+
+    REG(psInsn->ui8Rd) = (uint32_t)(i32Dividend / i32Divisor);
+}
+
+/*
+ * Long multiplies: RdLo in ui8Rd, RdHi in ui8Ra.  ui8Op selects the
+ * operation.
+ */
+enum
+{
+    LONG_SMULL, LONG_UMULL, LONG_SMLAL, LONG_UMLAL, LONG_UMAAL
+};
+
+static void
+ExecLongMul(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32N = REG(psInsn->ui8Rn), ui32M = REG(psInsn->ui8Rm);
+    uint64_t ui64Acc = ((uint64_t)REG(psInsn->ui8Ra) << 32) |
+                       REG(psInsn->ui8Rd);
+    uint64_t ui64Result;
+
+    switch(psInsn->ui8Op)
+    {
+        case LONG_SMULL:
+            ui64Result = (uint64_t)((int64_t)(int32_t)ui32N *
+                                    (int32_t)ui32M);
+            break;
+
+        case LONG_UMULL:
+            ui64Result = (uint64_t)ui32N * ui32M;
+            break;
+
+        case LONG_SMLAL:
+            ui64Result = (uint64_t)((int64_t)(int32_t)ui32N *
+                                    (int32_t)ui32M) + ui64Acc;
+            break;
+
+        case LONG_UMLAL:
+            ui64Result = (uint64_t)ui32N * ui32M + ui64Acc;
+            break;
+
+        default:
+            ui64Result = (uint64_t)ui32N * ui32M + REG(psInsn->ui8Rd) +
+                         REG(psInsn->ui8Ra);
+            break;
+    }
+
+    REG(psInsn->ui8Rd) = (uint32_t)ui64Result;
+    REG(psInsn->ui8Ra) = (uint32_t)(ui64Result >> 32);
+}
+
+/*
+ * Signed DSP multiplies.  ui8Op holds the half selectors (bit 0 for Rm,
+ * bit 1 for Rn), or the exchange and rounding bits.  ui8Ra is the zero
+ * register for the forms without accumulator.
+ */
+static int32_t
+ThumbHalf(uint32_t ui32Value, uint32_t ui32Top)
+{
+    return(ui32Top ? (int16_t)(ui32Value >> 16) : (int16_t)ui32Value);
+}
+
+static void
+ExecSMLAxy(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    int64_t i64Result;
+
+    i64Result = (int64_t)ThumbHalf(REG(psInsn->ui8Rn), psInsn->ui8Op & 2) *
+                ThumbHalf(REG(psInsn->ui8Rm), psInsn->ui8Op & 1) +
+                (int32_t)REG(psInsn->ui8Ra);
+
+    if(i64Result != (int32_t)i64Result)
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = (uint32_t)i64Result;
+}
+
+static void
+ExecSMLAWy(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    int64_t i64Result;
+
+    i64Result = (((int64_t)(int32_t)REG(psInsn->ui8Rn) *
+                  ThumbHalf(REG(psInsn->ui8Rm), psInsn->ui8Op & 1)) >> 16) +
+                (int32_t)REG(psInsn->ui8Ra);
+
+    if(i64Result != (int32_t)i64Result)
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = (uint32_t)i64Result;
+}
+
+/*
+ * SMLAD, SMLSD, SMUAD and SMUSD.  Bit 0 of ui8Op exchanges the halves of
+ * Rm, bit 1 subtracts the second product.
+ */
+static void
+ExecSMLAD(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = REG(psInsn->ui8Rm);
+    int64_t i64P1, i64P2, i64Result;
+
+    if(psInsn->ui8Op & 1)
+        ui32M = ThumbRotate(ui32M, 16);
+
+    i64P1 = (int64_t)ThumbHalf(REG(psInsn->ui8Rn), 0) * ThumbHalf(ui32M, 0);
+    i64P2 = (int64_t)ThumbHalf(REG(psInsn->ui8Rn), 1) * ThumbHalf(ui32M, 1);
+    i64Result = ((psInsn->ui8Op & 2) ? i64P1 - i64P2 : i64P1 + i64P2) +
+                (int32_t)REG(psInsn->ui8Ra);
+
+    if(i64Result != (int32_t)i64Result)
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = (uint32_t)i64Result;
+}
+
+/*
+ * SMLALD and SMLSLD, with the same ui8Op bits; RdLo in ui8Rd, RdHi in
+ * ui8Ra.
+ */
+static void
+ExecSMLALD(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = REG(psInsn->ui8Rm);
+    int64_t i64P1, i64P2;
+    uint64_t ui64Result;
+
+    if(psInsn->ui8Op & 1)
+        ui32M = ThumbRotate(ui32M, 16);
+
+    i64P1 = (int64_t)ThumbHalf(REG(psInsn->ui8Rn), 0) * ThumbHalf(ui32M, 0);
+    i64P2 = (int64_t)ThumbHalf(REG(psInsn->ui8Rn), 1) * ThumbHalf(ui32M, 1);
+    ui64Result = (((uint64_t)REG(psInsn->ui8Ra) << 32) | REG(psInsn->ui8Rd)) +
+                 (uint64_t)((psInsn->ui8Op & 2) ? i64P1 - i64P2 :
+                            i64P1 + i64P2);
+
+    REG(psInsn->ui8Rd) = (uint32_t)ui64Result;
+    REG(psInsn->ui8Ra) = (uint32_t)(ui64Result >> 32);
+}
+
+static void
+ExecSMLALxy(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint64_t ui64Result;
+
+    ui64Result = (((uint64_t)REG(psInsn->ui8Ra) << 32) | REG(psInsn->ui8Rd)) +
+                 (uint64_t)((int64_t)ThumbHalf(REG(psInsn->ui8Rn),
+                                               psInsn->ui8Op & 2) *
+                            ThumbHalf(REG(psInsn->ui8Rm), psInsn->ui8Op & 1));
+
+    REG(psInsn->ui8Rd) = (uint32_t)ui64Result;
+    REG(psInsn->ui8Ra) = (uint32_t)(ui64Result >> 32);
+}
+
+/*
+ * SMMUL, SMMLA and SMMLS.  Bit 0 of ui8Op rounds, bit 1 subtracts.
+ */
+static void
+ExecSMMLA(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    int64_t i64Product = (int64_t)(int32_t)REG(psInsn->ui8Rn) *
+                         (int32_t)REG(psInsn->ui8Rm);
+    int64_t i64Result = (int64_t)((uint64_t)REG(psInsn->ui8Ra) << 32);
+
+    i64Result = (psInsn->ui8Op & 2) ? i64Result - i64Product :
+                i64Result + i64Product;
+
+    if(psInsn->ui8Op & 1)
+        i64Result += 0x80000000LL;
+
+    REG(psInsn->ui8Rd) = (uint32_t)((uint64_t)i64Result >> 32);
+}
+
+static void
+ExecUSADA8(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32N = REG(psInsn->ui8Rn), ui32M = REG(psInsn->ui8Rm);
+    uint32_t ui32Sum = REG(psInsn->ui8Ra), ui32Lane;
+    int32_t i32Diff;
+
+    for(ui32Lane = 0; ui32Lane < 32; ui32Lane += 8)
+    {
+        i32Diff = (int32_t)((ui32N >> ui32Lane) & 0xFF) -
+                  (int32_t)((ui32M >> ui32Lane) & 0xFF);
+        ui32Sum += (i32Diff < 0) ? -i32Diff : i32Diff;
+    }
+
+    REG(psInsn->ui8Rd) = ui32Sum;
+}
+
+/*****************************************************************************
+ *
+ * Saturation, packing, extension and bit manipulation.
+ *
+ *****************************************************************************/
+
+/*
+ * SSAT and USAT.  ui8Shift is the shift applied to Rn, ui32Imm the width.
+ */
+static void
+ExecSSAT(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Carry;
+    int32_t i32Result;
+
+    if(ThumbSignedSat((int32_t)OperandShi(psCpu, psInsn, &ui32Carry),
+                      psInsn->ui32Imm, &i32Result))
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = (uint32_t)i32Result;
+}
+
+static void
+ExecUSAT(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Carry, ui32Result;
+
+    if(ThumbUnsignedSat((int32_t)OperandShi(psCpu, psInsn, &ui32Carry),
+                        psInsn->ui32Imm, &ui32Result))
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = ui32Result;
+}
+
+static void
+ExecSSAT16(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32N = REG(psInsn->ui8Rn);
+    int32_t i32Lo, i32Hi;
+
+    if(ThumbSignedSat((int16_t)ui32N, psInsn->ui32Imm, &i32Lo) |
+       ThumbSignedSat((int16_t)(ui32N >> 16), psInsn->ui32Imm, &i32Hi))
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = ((uint32_t)i32Lo & 0xFFFF) | ((uint32_t)i32Hi << 16);
+}
+
+static void
+ExecUSAT16(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32N = REG(psInsn->ui8Rn), ui32Lo, ui32Hi;
+
+    if(ThumbUnsignedSat((int16_t)ui32N, psInsn->ui32Imm, &ui32Lo) |
+       ThumbUnsignedSat((int16_t)(ui32N >> 16), psInsn->ui32Imm, &ui32Hi))
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = ui32Lo | (ui32Hi << 16);
+}
+
+/*
+ * PKHBT and PKHTB; bit 0 of ui8Op selects PKHTB.
+ */
+static void
+ExecPKH(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Carry, ui32Op2 = OperandShi(psCpu, psInsn, &ui32Carry);
+
+    if(psInsn->ui8Op & 1)
+        REG(psInsn->ui8Rd) = (REG(psInsn->ui8Rn) & 0xFFFF0000U) |
+                             (ui32Op2 & 0xFFFF);
+    else
+        REG(psInsn->ui8Rd) = (REG(psInsn->ui8Rn) & 0xFFFF) |
+                             (ui32Op2 & 0xFFFF0000U);
+}
+
+/*
+ * Extensions with optional addition.  Rm is rotated by ui8Shift bits; Rn is
+ * the zero register for the forms without addition.
+ */
+static void
+ExecSXTB(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = REG(psInsn->ui8Rn) +
+                         (uint32_t)(int8_t)ThumbRotate(REG(psInsn->ui8Rm),
+                                                       psInsn->ui8Shift);
+}
+
+static void
+ExecSXTH(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = REG(psInsn->ui8Rn) +
+                         (uint32_t)(int16_t)ThumbRotate(REG(psInsn->ui8Rm),
+                                                        psInsn->ui8Shift);
+}
+
+static void
+ExecUXTB(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = REG(psInsn->ui8Rn) +
+                         (ThumbRotate(REG(psInsn->ui8Rm), psInsn->ui8Shift) &
+                          0xFF);
+}
+
+static void
+ExecUXTH(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = REG(psInsn->ui8Rn) +
+                         (ThumbRotate(REG(psInsn->ui8Rm), psInsn->ui8Shift) &
+                          0xFFFF);
+}
+
+static void
+ExecSXTB16(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = ThumbRotate(REG(psInsn->ui8Rm), psInsn->ui8Shift);
+    uint32_t ui32N = REG(psInsn->ui8Rn);
+
+    REG(psInsn->ui8Rd) =
+        ((ui32N + (uint32_t)(int8_t)ui32M) & 0xFFFF) |
+        (((ui32N >> 16) + (uint32_t)(int8_t)(ui32M >> 16)) << 16);
+}
+
+static void
+ExecUXTB16(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = ThumbRotate(REG(psInsn->ui8Rm), psInsn->ui8Shift);
+    uint32_t ui32N = REG(psInsn->ui8Rn);
+
+    REG(psInsn->ui8Rd) = ((ui32N + (ui32M & 0xFF)) & 0xFFFF) |
+                         (((ui32N >> 16) + ((ui32M >> 16) & 0xFF)) << 16);
+}
+
+/*
+ * SBFX and UBFX: ui8Shift is the lsb, ui32Imm the width.
+ */
+static void
+ExecSBFX(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = ThumbSignExtend(
+        (REG(psInsn->ui8Rn) >> psInsn->ui8Shift) &
+        (uint32_t)((1ULL << psInsn->ui32Imm) - 1), psInsn->ui32Imm);
+}
+
+static void
+ExecUBFX(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = (REG(psInsn->ui8Rn) >> psInsn->ui8Shift) &
+                         (uint32_t)((1ULL << psInsn->ui32Imm) - 1);
+}
+
+/*
+ * BFI and BFC (Rn is the zero register): ui32Imm is the mask of the field,
+ * ui8Shift its lsb.
+ */
+static void
+ExecBFI(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = (REG(psInsn->ui8Rd) & ~psInsn->ui32Imm) |
+                         ((REG(psInsn->ui8Rn) << psInsn->ui8Shift) &
+                          psInsn->ui32Imm);
+}
+
+static void
+ExecMOVT(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = (REG(psInsn->ui8Rd) & 0xFFFF) | psInsn->ui32Imm;
+}
+
+static void
+ExecCLZ(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = REG(psInsn->ui8Rm);
+
+    REG(psInsn->ui8Rd) = ui32M ? (uint32_t)__builtin_clz(ui32M) : 32;
+}
+
+static void
+ExecRBIT(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = REG(psInsn->ui8Rm);
+
+    ui32M = ((ui32M >> 1) & 0x55555555U) | ((ui32M & 0x55555555U) << 1);
+    ui32M = ((ui32M >> 2) & 0x33333333U) | ((ui32M & 0x33333333U) << 2);
+    ui32M = ((ui32M >> 4) & 0x0F0F0F0FU) | ((ui32M & 0x0F0F0F0FU) << 4);
+
+    REG(psInsn->ui8Rd) = __builtin_bswap32(ui32M);
+}
+
+static void
+ExecREV(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(psInsn->ui8Rd) = __builtin_bswap32(REG(psInsn->ui8Rm));
+}
+
+static void
+ExecREV16(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = REG(psInsn->ui8Rm);
+
+    REG(psInsn->ui8Rd) = ((ui32M >> 8) & 0x00FF00FFU) |
+                         ((ui32M << 8) & 0xFF00FF00U);
+}
+
+static void
+ExecREVSH(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = REG(psInsn->ui8Rm);
+
+    REG(psInsn->ui8Rd) = (uint32_t)(int16_t)(((ui32M & 0xFF) << 8) |
+                                             ((ui32M >> 8) & 0xFF));
+}
+
+/*
+ * QADD, QSUB, QDADD and QDSUB.  Bit 0 of ui8Op subtracts, bit 1 doubles Rn.
+ */
+static void
+ExecQADD(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    int64_t i64N = (int32_t)REG(psInsn->ui8Rn);
+    int32_t i32N, i32Result;
+
+    if(psInsn->ui8Op & 2)
+    {
+        if(ThumbSignedSat(i64N * 2, 32, &i32N))
+            psCpu->ui8Q = 1;
+
+        i64N = i32N;
+    }
+
+    if(ThumbSignedSat((psInsn->ui8Op & 1) ?
+                      (int64_t)(int32_t)REG(psInsn->ui8Rm) - i64N :
+                      (int64_t)(int32_t)REG(psInsn->ui8Rm) + i64N, 32,
+                      &i32Result))
+        psCpu->ui8Q = 1;
+
+    REG(psInsn->ui8Rd) = (uint32_t)i32Result;
+}
+
+/*
+ * Parallel addition and subtraction.  ui8Op holds the prefix in bits 5:3
+ * (see PAR_*) and the operation in bits 2:0 (the op1 field of the encoding).
+ */
+#define PAR_S                   0
+#define PAR_Q                   1
+#define PAR_SH                  2
+#define PAR_U                   4
+#define PAR_UQ                  5
+#define PAR_UH                  6
+
+static void
+ExecParallel(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32N = REG(psInsn->ui8Rn), ui32M = REG(psInsn->ui8Rm);
+    uint32_t ui32Prefix = psInsn->ui8Op >> 3, ui32Op = psInsn->ui8Op & 7;
+    uint32_t ui32Bits, ui32Lanes, ui32Lane, ui32Mask, ui32Result = 0;
+    uint32_t ui32GE = 0, ui32Value;
+    bool bSigned = !(ui32Prefix & 4), bSub;
+    int64_t i64A, i64B, i64R;
+    int32_t i32Sat;
+
+    ui32Bits = ((ui32Op == 0) || (ui32Op == 4)) ? 8 : 16;
+    ui32Lanes = 32 / ui32Bits;
+    ui32Mask = (1U << ui32Bits) - 1;
+
+    for(ui32Lane = 0; ui32Lane < ui32Lanes; ui32Lane++)
+    {
+        uint32_t ui32OtherLane = ui32Lane;
+
+        /*
+         * ASX (op 2) and SAX (op 6) cross the halfwords of Rm.
+         */
+        if((ui32Op == 2) || (ui32Op == 6))
+            ui32OtherLane = 1 - ui32Lane;
+
+        bSub = (ui32Op == 4) || (ui32Op == 5) ||
+               ((ui32Op == 2) && (ui32Lane == 0)) ||
+               ((ui32Op == 6) && (ui32Lane == 1));
+
+        i64A = (ui32N >> (ui32Lane * ui32Bits)) & ui32Mask;
+        i64B = (ui32M >> (ui32OtherLane * ui32Bits)) & ui32Mask;
+
+        if(bSigned)
+        {
+            i64A = (int32_t)ThumbSignExtend((uint32_t)i64A, ui32Bits);
+            i64B = (int32_t)ThumbSignExtend((uint32_t)i64B, ui32Bits);
+        }
+
+        i64R = bSub ? i64A - i64B : i64A + i64B;
+
+        switch(ui32Prefix)
+        {
+            case PAR_Q:
+                ThumbSignedSat(i64R, ui32Bits, &i32Sat);
+                ui32Value = (uint32_t)i32Sat;
+                break;
+
+            case PAR_UQ:
+                ThumbUnsignedSat(i64R, ui32Bits, &ui32Value);
+                break;
+
+            case PAR_SH:
+            case PAR_UH:
+                ui32Value = (uint32_t)(i64R >> 1);
+                break;
+
+            default:
+                ui32Value = (uint32_t)i64R;
+
+                if(bSigned ? (i64R >= 0) :
+                   (bSub ? (i64R >= 0) : (i64R > ui32Mask)))
+                    ui32GE |= ((ui32Bits == 8) ? 1U : 3U) <<
+                              (ui32Lane * ui32Bits / 8);
+                break;
+        }
+
+        ui32Result |= (ui32Value & ui32Mask) << (ui32Lane * ui32Bits);
+    }
+
+    if((ui32Prefix == PAR_S) || (ui32Prefix == PAR_U))
+        psCpu->ui8GE = (uint8_t)ui32GE;
+
+    REG(psInsn->ui8Rd) = ui32Result;
+}
+
+static void
+ExecSEL(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Mask = 0, ui32Lane;
+
+    for(ui32Lane = 0; ui32Lane < 4; ui32Lane++)
+        if((psCpu->ui8GE >> ui32Lane) & 1)
+            ui32Mask |= 0xFFU << (ui32Lane * 8);
+
+    REG(psInsn->ui8Rd) = (REG(psInsn->ui8Rn) & ui32Mask) |
+                         (REG(psInsn->ui8Rm) & ~ui32Mask);
+}
+
+/*****************************************************************************
+ *
+ * Loads and stores.
+ *
+ *****************************************************************************/
+
+/*
+ * Addressing modes, in the order of the columns of g_ppfnLoadStore: offset
+ * by an immediate (ui32Imm, possibly negative), offset by a shifted
+ * register, pre-indexed and post-indexed with writeback.
+ */
+#define LS_IMM                  0
+#define LS_REG                  1
+#define LS_PRE                  2
+#define LS_POST                 3
+
+THUMB_INLINE uint32_t
+LoadExtend(uint32_t ui32Value, uint32_t ui32Size, bool bSigned)
+{
+    if(!bSigned)
+        return(ui32Value);
+
+    return((ui32Size == 1) ? (uint32_t)(int8_t)ui32Value :
+                             (uint32_t)(int16_t)ui32Value);
+}
+
+THUMB_INLINE void
+LoadCommit(tSimMachine *psMachine, const tSimInsn *psInsn, uint32_t ui32Value)
+{
+    if(psInsn->ui8Rd == 15)
+        SimCpuBranchExchange(psMachine, ui32Value);
+    else
+        psMachine->sCpu.pui32R[psInsn->ui8Rd] = ui32Value;
+}
+
+#define THUMB_LOAD(name, size, sign)                                          \
+    static void                                                               \
+    Exec##name##Imm(tSimMachine *psMachine, const tSimInsn *psInsn)           \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+        uint32_t ui32Value = ThumbLoad(psMachine,                             \
+                                       REG(psInsn->ui8Rn) + psInsn->ui32Imm,  \
+                                       size);                                 \
+                                                                              \
+        LoadCommit(psMachine, psInsn, LoadExtend(ui32Value, size, sign));     \
+    }                                                                         \
+                                                                              \
+    static void                                                               \
+    Exec##name##Reg(tSimMachine *psMachine, const tSimInsn *psInsn)           \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+        uint32_t ui32Value = ThumbLoad(psMachine,                             \
+                                       REG(psInsn->ui8Rn) +                   \
+                                       (REG(psInsn->ui8Rm) <<                 \
+                                        psInsn->ui8Shift), size);             \
+                                                                              \
+        LoadCommit(psMachine, psInsn, LoadExtend(ui32Value, size, sign));     \
+    }                                                                         \
+                                                                              \
+    static void                                                               \
+    Exec##name##Pre(tSimMachine *psMachine, const tSimInsn *psInsn)           \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+        uint32_t ui32Addr = REG(psInsn->ui8Rn) + psInsn->ui32Imm;             \
+        uint32_t ui32Value = ThumbLoad(psMachine, ui32Addr, size);            \
+                                                                              \
+        REG(psInsn->ui8Rn) = ui32Addr;                                        \
+        LoadCommit(psMachine, psInsn, LoadExtend(ui32Value, size, sign));     \
+    }                                                                         \
+                                                                              \
+    static void                                                               \
+    Exec##name##Post(tSimMachine *psMachine, const tSimInsn *psInsn)          \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+        uint32_t ui32Addr = REG(psInsn->ui8Rn);                               \
+        uint32_t ui32Value = ThumbLoad(psMachine, ui32Addr, size);            \
+                                                                              \
+        REG(psInsn->ui8Rn) = ui32Addr + psInsn->ui32Imm;                      \
+        LoadCommit(psMachine, psInsn, LoadExtend(ui32Value, size, sign));     \
+    }
+
+#define THUMB_STORE(name, size)                                               \
+    static void                                                               \
+    Exec##name##Imm(tSimMachine *psMachine, const tSimInsn *psInsn)           \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+                                                                              \
+        ThumbStore(psMachine, REG(psInsn->ui8Rn) + psInsn->ui32Imm, size,     \
+                   REG(psInsn->ui8Rd));                                       \
+    }                                                                         \
+                                                                              \
+    static void                                                               \
+    Exec##name##Reg(tSimMachine *psMachine, const tSimInsn *psInsn)           \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+                                                                              \
+        ThumbStore(psMachine,                                                 \
+                   REG(psInsn->ui8Rn) + (REG(psInsn->ui8Rm) <<                \
+                                         psInsn->ui8Shift), size,             \
+                   REG(psInsn->ui8Rd));                                       \
+    }                                                                         \
+                                                                              \
+    static void                                                               \
+    Exec##name##Pre(tSimMachine *psMachine, const tSimInsn *psInsn)           \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+        uint32_t ui32Addr = REG(psInsn->ui8Rn) + psInsn->ui32Imm;             \
+                                                                              \
+        ThumbStore(psMachine, ui32Addr, size, REG(psInsn->ui8Rd));            \
+        REG(psInsn->ui8Rn) = ui32Addr;                                        \
+    }                                                                         \
+                                                                              \
+    static void                                                               \
+    Exec##name##Post(tSimMachine *psMachine, const tSimInsn *psInsn)          \
+    {                                                                         \
+        tSimCpu *psCpu = &psMachine->sCpu;                                    \
+        uint32_t ui32Addr = REG(psInsn->ui8Rn);                               \
+                                                                              \
+        ThumbStore(psMachine, ui32Addr, size, REG(psInsn->ui8Rd));            \
+        REG(psInsn->ui8Rn) = ui32Addr + psInsn->ui32Imm;                      \
+    }
+
+THUMB_LOAD(LDR, 4, false)
+THUMB_LOAD(LDRH, 2, false)
+THUMB_LOAD(LDRSH, 2, true)
+THUMB_LOAD(LDRB, 1, false)
+THUMB_LOAD(LDRSB, 1, true)
+THUMB_STORE(STR, 4)
+THUMB_STORE(STRH, 2)
+THUMB_STORE(STRB, 1)
+
+#define THUMB_LS_ROW(name)                                                    \
+    { Exec##name##Imm, Exec##name##Reg, Exec##name##Pre, Exec##name##Post }
+
+/*
+ * Indexed by size (0 byte, 1 halfword, 2 word) and kind.
+ */
+enum
+{
+    LS_STORE, LS_LOAD, LS_LOAD_SIGNED
+};
+
+static const tSimExec g_ppfnLoadStore[3][3][4] =
+{
+    {
+        THUMB_LS_ROW(STRB),
+        THUMB_LS_ROW(LDRB),
+        THUMB_LS_ROW(LDRSB)
+    },
+    {
+        THUMB_LS_ROW(STRH),
+        THUMB_LS_ROW(LDRH),
+        THUMB_LS_ROW(LDRSH)
+    },
+    {
+        THUMB_LS_ROW(STR),
+        THUMB_LS_ROW(LDR),
+        { 0 }
+    }
+};
+
+/*
+ * LDRD and STRD: Rt in ui8Rd, Rt2 in ui8Ra, THUMB_INDEX and THUMB_WRITEBACK
+ * in ui8Op.
+ */
+static void
+ExecLDRD(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Offset = REG(psInsn->ui8Rn) + psInsn->ui32Imm;
+    uint32_t ui32Addr = (psInsn->ui8Op & THUMB_INDEX) ? ui32Offset :
+                        REG(psInsn->ui8Rn);
+    uint32_t ui32Lo, ui32Hi;
+
+    ThumbCheckAligned(psMachine, ui32Addr, 4);
+    ui32Lo = ThumbLoad(psMachine, ui32Addr, 4);
+    ui32Hi = ThumbLoad(psMachine, ui32Addr + 4, 4);
+
+    if(psInsn->ui8Op & THUMB_WRITEBACK)
+        REG(psInsn->ui8Rn) = ui32Offset;
+
+    REG(psInsn->ui8Rd) = ui32Lo;
+    REG(psInsn->ui8Ra) = ui32Hi;
+}
+
+static void
+ExecSTRD(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Offset = REG(psInsn->ui8Rn) + psInsn->ui32Imm;
+    uint32_t ui32Addr = (psInsn->ui8Op & THUMB_INDEX) ? ui32Offset :
+                        REG(psInsn->ui8Rn);
+
+    ThumbCheckAligned(psMachine, ui32Addr, 4);
+    ThumbStore(psMachine, ui32Addr, 4, REG(psInsn->ui8Rd));
+    ThumbStore(psMachine, ui32Addr + 4, 4, REG(psInsn->ui8Ra));
+
+    if(psInsn->ui8Op & THUMB_WRITEBACK)
+        REG(psInsn->ui8Rn) = ui32Offset;
+}
+
+/*
+ * Load and store multiple, increment after or decrement before.  ui32Imm is
+ * the register list.  Lists that fit in one page of flash or SRAM are copied
+ * straight from or to the arena.
+ */
+THUMB_INLINE uint32_t
+ThumbRegisterCount(uint32_t ui32List)
+{
+    uint32_t ui32Count;
+
+    for(ui32Count = 0; ui32List; ui32Count++)
+        ui32List &= ui32List - 1;
+
+    return(ui32Count);
+}
+
+THUMB_INLINE uint8_t *
+ThumbBlock(tSimMachine *psMachine, const uint32_t *pui32Table,
+           uint32_t ui32Addr, uint32_t ui32Count)
+{
+    uint32_t ui32Offset = SimMemoryOffset(pui32Table, ui32Addr);
+
+    if(!ui32Offset ||
+       ((ui32Addr & (SIM_MEM_PAGE_SIZE - 1)) + ui32Count * 4 >
+        SIM_MEM_PAGE_SIZE))
+        return(NULL);
+
+    return(psMachine->sMemory.pui8Arena + ui32Offset - 1);
+}
+
+static void
+LoadMultiple(tSimMachine *psMachine, const tSimInsn *psInsn, uint32_t ui32Addr,
+             uint32_t ui32Count, uint32_t ui32Final)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t pui32Value[16], ui32List = psInsn->ui32Imm, ui32Reg, ui32Idx;
+    const uint8_t *pui8Data;
+
+    ThumbCheckAligned(psMachine, ui32Addr, 4);
+
+    /*
+     * All words are read before any register changes, so a fault leaves the
+     * instruction restartable.
+     */
+    pui8Data = ThumbBlock(psMachine, psMachine->sMemory.pui32Read, ui32Addr,
+                          ui32Count);
+
+    if(pui8Data)
+    {
+        if(psMachine->psShadow)
+            SimShadowLoad(psMachine, ui32Addr, ui32Count * 4);
+
+        memcpy(pui32Value, pui8Data, ui32Count * 4);
+    }
+    else
+        for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+            pui32Value[ui32Idx] = ThumbLoad(psMachine, ui32Addr + ui32Idx * 4,
+                                            4);
+
+    if(psInsn->ui8Op & THUMB_WRITEBACK)
+        REG(psInsn->ui8Rn) = ui32Final;
+
+    for(ui32Idx = 0; ui32List & 0x7FFF; ui32Idx++)
+    {
+        ui32Reg = __builtin_ctz(ui32List);
+        REG(ui32Reg) = pui32Value[ui32Idx];
+        ui32List &= ui32List - 1;
+    }
+
+    if(ui32List)
+        SimCpuBranchExchange(psMachine, pui32Value[ui32Idx]);
+}
+
+static void
+StoreMultiple(tSimMachine *psMachine, const tSimInsn *psInsn,
+              uint32_t ui32Addr, uint32_t ui32Count, uint32_t ui32Final)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32List = psInsn->ui32Imm, ui32Reg, ui32Value;
+    uint8_t *pui8Data;
+
+    ThumbCheckAligned(psMachine, ui32Addr, 4);
+
+    pui8Data = ThumbBlock(psMachine, psMachine->sMemory.pui32Write, ui32Addr,
+                          ui32Count);
+
+    if(pui8Data && psMachine->psShadow)
+        SimShadowStore(psMachine, ui32Addr, ui32Count * 4);
+
+    for(; ui32List; ui32List &= ui32List - 1, ui32Addr += 4)
+    {
+        ui32Reg = __builtin_ctz(ui32List);
+        ui32Value = REG(ui32Reg);
+
+        if(pui8Data)
+        {
+            memcpy(pui8Data, &ui32Value, 4);
+            pui8Data += 4;
+        }
+        else
+            ThumbStore(psMachine, ui32Addr, 4, ui32Value);
+    }
+
+    if(psInsn->ui8Op & THUMB_WRITEBACK)
+        REG(psInsn->ui8Rn) = ui32Final;
+}
+
+static void
+ExecLDM(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    uint32_t ui32Base = psMachine->sCpu.pui32R[psInsn->ui8Rn];
+    uint32_t ui32Count = ThumbRegisterCount(psInsn->ui32Imm);
+
+    LoadMultiple(psMachine, psInsn, ui32Base, ui32Count,
+                 ui32Base + 4 * ui32Count);
+}
+
+static void
+ExecLDMDB(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    uint32_t ui32Count = ThumbRegisterCount(psInsn->ui32Imm);
+    uint32_t ui32Base = psMachine->sCpu.pui32R[psInsn->ui8Rn] - 4 * ui32Count;
+
+    LoadMultiple(psMachine, psInsn, ui32Base, ui32Count, ui32Base);
+}
+
+static void
+ExecSTM(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    uint32_t ui32Base = psMachine->sCpu.pui32R[psInsn->ui8Rn];
+    uint32_t ui32Count = ThumbRegisterCount(psInsn->ui32Imm);
+
+    StoreMultiple(psMachine, psInsn, ui32Base, ui32Count,
+                  ui32Base + 4 * ui32Count);
+}
+
+static void
+ExecSTMDB(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    uint32_t ui32Count = ThumbRegisterCount(psInsn->ui32Imm);
+    uint32_t ui32Base = psMachine->sCpu.pui32R[psInsn->ui8Rn] - 4 * ui32Count;
+
+    StoreMultiple(psMachine, psInsn, ui32Base, ui32Count, ui32Base);
+}
+
+/*
+ * Exclusive accesses.  The local monitor does not compare addresses, as on
+ * the Cortex-M4.  ui8Shift is the access size; STREX returns its status in
+ * ui8Ra.
+ */
+static void
+ExecLDREX(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Addr = REG(psInsn->ui8Rn) + psInsn->ui32Imm;
+
+    ThumbCheckAligned(psMachine, ui32Addr, psInsn->ui8Shift);
+    REG(psInsn->ui8Rd) = ThumbLoad(psMachine, ui32Addr, psInsn->ui8Shift);
+    psCpu->bExclusive = true;
+    psCpu->ui32ExclusiveAddr = ui32Addr;
+}
+
+static void
+ExecSTREX(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Addr = REG(psInsn->ui8Rn) + psInsn->ui32Imm;
+
+    ThumbCheckAligned(psMachine, ui32Addr, psInsn->ui8Shift);
+
+    if(!psCpu->bExclusive)
+    {
+        REG(psInsn->ui8Ra) = 1;
+        return;
+    }
+
+    ThumbStore(psMachine, ui32Addr, psInsn->ui8Shift, REG(psInsn->ui8Rd));
+    psCpu->bExclusive = false;
+    REG(psInsn->ui8Ra) = 0;
+}
+
+static void
+ExecCLREX(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    psMachine->sCpu.bExclusive = false;
+}
+
+/*****************************************************************************
+ *
+ * Branches and control.
+ *
+ *****************************************************************************/
+
+/*
+ * Branch targets are absolute addresses in ui32Imm; conditional branches
+ * keep their condition in ui8Op.
+ */
+static void
+ExecB(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    psMachine->sCpu.ui32PC = psInsn->ui32Imm;
+}
+
+static void
+ExecBcc(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    if(ThumbCondition(&psMachine->sCpu, psInsn->ui8Op))
+        psMachine->sCpu.ui32PC = psInsn->ui32Imm;
+}
+
+static void
+ExecBL(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    REG(14) = psCpu->ui32PC | 1;
+    psCpu->ui32PC = psInsn->ui32Imm;
+}
+
+static void
+ExecBX(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuBranchExchange(psMachine, psMachine->sCpu.pui32R[psInsn->ui8Rm]);
+}
+
+static void
+ExecBLX(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Target = REG(psInsn->ui8Rm);
+
+    REG(14) = psCpu->ui32PC | 1;
+    SimCpuBranchExchange(psMachine, ui32Target);
+}
+
+/*
+ * CBZ and CBNZ; ui8Op is set for CBNZ.
+ */
+static void
+ExecCBZ(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    if((REG(psInsn->ui8Rn) != 0) == psInsn->ui8Op)
+        psCpu->ui32PC = psInsn->ui32Imm;
+}
+
+/*
+ * TBB and TBH; ui8Shift is the size of the table entries.
+ */
+static void
+ExecTBB(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Offset;
+
+    ui32Offset = ThumbLoad(psMachine, REG(psInsn->ui8Rn) +
+                           REG(psInsn->ui8Rm) * psInsn->ui8Shift,
+                           psInsn->ui8Shift);
+
+    psCpu->ui32PC = REG(15) + 2 * ui32Offset;
+}
+
+static void
+ExecIT(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    psMachine->sCpu.ui32IT = psInsn->ui32Imm;
+}
+
+static void
+ExecNOP(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+}
+
+static void
+ExecWFI(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuWait(psMachine, false);
+}
+
+static void
+ExecWFE(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuWait(psMachine, true);
+}
+
+static void
+ExecSEV(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    psMachine->sCpu.bEvent = true;
+}
+
+static void
+ExecSVC(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuSupervisorCall(psMachine);
+}
+
+static void
+ExecBKPT(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuBreakpoint(psMachine);
+}
+
+/*
+ * CPSIE and CPSID: bit 0 of ui8Op selects PRIMASK, bit 1 FAULTMASK and
+ * bit 2 disables.
+ */
+static void
+ExecCPS(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    if(psInsn->ui8Op & 1)
+        SimCpuChangeMask(psMachine, false, psInsn->ui8Op & 4);
+
+    if(psInsn->ui8Op & 2)
+        SimCpuChangeMask(psMachine, true, psInsn->ui8Op & 4);
+}
+
+/*
+ * MRS and MSR: ui32Imm is SYSm, ui8Op the MSR mask.
+ */
+static void
+ExecMRS(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    uint32_t ui32Value = SimCpuSpecialRead(psMachine, psInsn->ui32Imm);
+
+    psMachine->sCpu.pui32R[psInsn->ui8Rd] = ui32Value;
+}
+
+static void
+ExecMSR(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    SimCpuSpecialWrite(psMachine, psInsn->ui32Imm, psInsn->ui8Op,
+                       psMachine->sCpu.pui32R[psInsn->ui8Rn]);
+}
+
+/*****************************************************************************
+ *
+ * Decoder.
+ *
+ *****************************************************************************/
+
+static void
+DecodeSet(tSimInsn *psInsn, tSimExec pfnExec, uint32_t ui32Rd, uint32_t ui32Rn,
+          uint32_t ui32Rm, uint32_t ui32Imm)
+{
+    psInsn->pfnExec = pfnExec;
+    psInsn->ui8Rd = (uint8_t)ui32Rd;
+    psInsn->ui8Rn = (uint8_t)ui32Rn;
+    psInsn->ui8Rm = (uint8_t)ui32Rm;
+    psInsn->ui32Imm = ui32Imm;
+}
+
+/*
+ * Data-processing instruction with a register operand shifted by an
+ * immediate, using the plain register form when there is no shift.
+ */
+static void
+DecodeShifted(tSimInsn *psInsn, uint32_t ui32Row, uint32_t ui32Rd,
+              uint32_t ui32Rn, uint32_t ui32Rm, uint32_t ui32Type,
+              uint32_t ui32Imm5)
+{
+    if((ui32Type == THUMB_LSL) && !ui32Imm5)
+    {
+        DecodeSet(psInsn, g_ppfnDataProc[ui32Row][DP_REG], ui32Rd, ui32Rn,
+                  ui32Rm, 0);
+        return;
+    }
+
+    /*
+     * DecodeImmShift(): LSR and ASR by 0 mean by 32, ROR by 0 is RRX.
+     */
+    if(!ui32Imm5 && ((ui32Type == THUMB_LSR) || (ui32Type == THUMB_ASR)))
+        ui32Imm5 = 32;
+
+    DecodeSet(psInsn, g_ppfnDataProc[ui32Row][DP_SHI], ui32Rd, ui32Rn, ui32Rm,
+              0);
+    psInsn->ui8Shift = THUMB_SHIFT(ui32Type, ui32Imm5);
+}
+
+static void
+DecodeImmediate(tSimInsn *psInsn, uint32_t ui32Row, uint32_t ui32Rd,
+                uint32_t ui32Rn, uint32_t ui32Imm, uint32_t ui32Carry)
+{
+    DecodeSet(psInsn, g_ppfnDataProc[ui32Row][DP_IMM], ui32Rd, ui32Rn, 0,
+              ui32Imm);
+    psInsn->ui8Shift = (uint8_t)ui32Carry;
+}
+
+static void
+DecodeLoadStore(tSimInsn *psInsn, uint32_t ui32Size, uint32_t ui32Kind,
+                uint32_t ui32Mode, uint32_t ui32Rt, uint32_t ui32Rn,
+                uint32_t ui32Rm, uint32_t ui32Imm)
+{
+    DecodeSet(psInsn, g_ppfnLoadStore[ui32Size][ui32Kind][ui32Mode], ui32Rt,
+              ui32Rn, ui32Rm, ui32Imm);
+}
+
+static bool
+Decode16(uint32_t ui32PC, uint32_t ui32Hw, tSimInsn *psInsn)
+{
+    uint32_t ui32Rd = ui32Hw & 7, ui32Rn = (ui32Hw >> 3) & 7, ui32Op;
+    uint32_t ui32Rm = (ui32Hw >> 6) & 7, ui32Imm8 = ui32Hw & 0xFF;
+    uint32_t ui32Imm5 = (ui32Hw >> 6) & 0x1F, ui32Hi = (ui32Hw >> 8) & 7;
+
+    psInsn->ui8S = THUMB_S_OUTSIDE_IT;
+
+    switch(ui32Hw >> 12)
+    {
+        case 0x0:
+        case 0x1:
+            ui32Op = (ui32Hw >> 9) & 0x1F;
+
+            if(ui32Op < 0x0C)
+            {
+                DecodeShifted(psInsn, DP_MOV, ui32Rd, 0, ui32Rn, ui32Op >> 2,
+                              ui32Imm5);
+                return(true);
+            }
+
+            switch(ui32Op)
+            {
+                case 0x0C:
+                    DecodeSet(psInsn, ExecADDReg, ui32Rd, ui32Rn, ui32Rm, 0);
+                    return(true);
+
+                case 0x0D:
+                    DecodeSet(psInsn, ExecSUBReg, ui32Rd, ui32Rn, ui32Rm, 0);
+                    return(true);
+
+                case 0x0E:
+                    DecodeImmediate(psInsn, DP_ADD, ui32Rd, ui32Rn, ui32Rm,
+                                    THUMB_CARRY_KEEP);
+                    return(true);
+
+                default:
+                    DecodeImmediate(psInsn, DP_SUB, ui32Rd, ui32Rn, ui32Rm,
+                                    THUMB_CARRY_KEEP);
+                    return(true);
+            }
+
+        case 0x2:
+        case 0x3:
+        {
+            static const uint8_t pui8Row[4] =
+            {
+                DP_MOV, DP_CMP, DP_ADD, DP_SUB
+            };
+
+            DecodeImmediate(psInsn, pui8Row[(ui32Hw >> 11) & 3], ui32Hi,
+                            ui32Hi, ui32Imm8, THUMB_CARRY_KEEP);
+            return(true);
+        }
+
+        case 0x4:
+            if(!(ui32Hw & 0x0800))
+                break;
+
+            /*
+             * LDR (literal).
+             */
+            DecodeLoadStore(psInsn, 2, LS_LOAD, LS_IMM, ui32Hi,
+                            SIM_CPU_REG_ZERO, 0,
+                            ((ui32PC + 4) & ~3U) + ui32Imm8 * 4);
+            return(true);
+
+        case 0x5:
+        {
+            static const uint8_t pui8Size[8] = { 2, 1, 0, 0, 2, 1, 0, 1 };
+            static const uint8_t pui8Kind[8] =
+            {
+                LS_STORE, LS_STORE, LS_STORE, LS_LOAD_SIGNED,
+                LS_LOAD, LS_LOAD, LS_LOAD, LS_LOAD_SIGNED
+            };
+
+            ui32Op = (ui32Hw >> 9) & 7;
+            DecodeLoadStore(psInsn, pui8Size[ui32Op], pui8Kind[ui32Op],
+                            LS_REG, ui32Rd, ui32Rn, ui32Rm, 0);
+            psInsn->ui8Shift = 0;
+            return(true);
+        }
+
+        case 0x6:
+            DecodeLoadStore(psInsn, 2, (ui32Hw & 0x0800) ? LS_LOAD : LS_STORE,
+                            LS_IMM, ui32Rd, ui32Rn, 0, ui32Imm5 * 4);
+            return(true);
+
+        case 0x7:
+            DecodeLoadStore(psInsn, 0, (ui32Hw & 0x0800) ? LS_LOAD : LS_STORE,
+                            LS_IMM, ui32Rd, ui32Rn, 0, ui32Imm5);
+            return(true);
+
+        case 0x8:
+            DecodeLoadStore(psInsn, 1, (ui32Hw & 0x0800) ? LS_LOAD : LS_STORE,
+                            LS_IMM, ui32Rd, ui32Rn, 0, ui32Imm5 * 2);
+            return(true);
+
+        case 0x9:
+            DecodeLoadStore(psInsn, 2, (ui32Hw & 0x0800) ? LS_LOAD : LS_STORE,
+                            LS_IMM, ui32Hi, 13, 0, ui32Imm8 * 4);
+            return(true);
+
+        case 0xA:
+            psInsn->ui8S = THUMB_S_NEVER;
+
+            if(ui32Hw & 0x0800)
+                DecodeImmediate(psInsn, DP_ADD, ui32Hi, 13, ui32Imm8 * 4,
+                                THUMB_CARRY_KEEP);
+            else
+                DecodeImmediate(psInsn, DP_MOV, ui32Hi, 0,
+                                ((ui32PC + 4) & ~3U) + ui32Imm8 * 4,
+                                THUMB_CARRY_KEEP);
+            return(true);
+
+        case 0xB:
+            psInsn->ui8S = THUMB_S_NEVER;
+
+            switch((ui32Hw >> 8) & 0xF)
+            {
+                case 0x0:
+                    DecodeImmediate(psInsn, (ui32Hw & 0x80) ? DP_SUB : DP_ADD,
+                                    13, 13, (ui32Hw & 0x7F) * 4,
+                                    THUMB_CARRY_KEEP);
+                    return(true);
+
+                case 0x1:
+                case 0x3:
+                case 0x9:
+                case 0xB:
+                    DecodeSet(psInsn, ExecCBZ, 0, ui32Rd, 0,
+                              ui32PC + 4 + ((ui32Hw >> 3) & 0x1F) * 2 +
+                              ((ui32Hw & 0x0200) ? 64 : 0));
+                    psInsn->ui8Op = (ui32Hw >> 11) & 1;
+                    return(true);
+
+                case 0x2:
+                {
+                    static const tSimExec ppfnExtend[4] =
+                    {
+                        ExecSXTH, ExecSXTB, ExecUXTH, ExecUXTB
+                    };
+
+                    DecodeSet(psInsn, ppfnExtend[(ui32Hw >> 6) & 3], ui32Rd,
+                              SIM_CPU_REG_ZERO, ui32Rn, 0);
+                    psInsn->ui8Shift = 0;
+                    return(true);
+                }
+
+                case 0x4:
+                case 0x5:
+                    DecodeSet(psInsn, ExecSTMDB, 0, 13, 0,
+                              ui32Imm8 | ((ui32Hw & 0x100) ? 0x4000 : 0));
+                    psInsn->ui8Op = THUMB_WRITEBACK;
+                    return(psInsn->ui32Imm != 0);
+
+                case 0x6:
+                    if((ui32Hw & 0xFFEC) != 0xB660)
+                        break;
+
+                    DecodeSet(psInsn, ExecCPS, 0, 0, 0, 0);
+                    psInsn->ui8Op = ((ui32Hw & 2) ? 1 : 0) |
+                                    ((ui32Hw & 1) ? 2 : 0) |
+                                    ((ui32Hw & 0x10) ? 4 : 0);
+                    return((ui32Hw & 3) != 0);
+
+                case 0xA:
+                {
+                    static const tSimExec ppfnReverse[4] =
+                    {
+                        ExecREV, ExecREV16, NULL, ExecREVSH
+                    };
+
+                    if(!ppfnReverse[(ui32Hw >> 6) & 3])
+                        break;
+
+                    DecodeSet(psInsn, ppfnReverse[(ui32Hw >> 6) & 3], ui32Rd,
+                              0, ui32Rn, 0);
+                    return(true);
+                }
+
+                case 0xC:
+                case 0xD:
+                    DecodeSet(psInsn, ExecLDM, 0, 13, 0,
+                              ui32Imm8 | ((ui32Hw & 0x100) ? 0x8000 : 0));
+                    psInsn->ui8Op = THUMB_WRITEBACK;
+                    return(psInsn->ui32Imm != 0);
+
+                case 0xE:
+                    DecodeSet(psInsn, ExecBKPT, 0, 0, 0, ui32Imm8);
+                    return(true);
+
+                case 0xF:
+                    if(ui32Hw & 0xF)
+                    {
+                        DecodeSet(psInsn, ExecIT, 0, 0, 0, ui32Imm8);
+                        return(true);
+                    }
+
+                    switch(ui32Imm8 >> 4)
+                    {
+                        case 2:
+                            DecodeSet(psInsn, ExecWFE, 0, 0, 0, 0);
+                            return(true);
+
+                        case 3:
+                            DecodeSet(psInsn, ExecWFI, 0, 0, 0, 0);
+                            return(true);
+
+                        case 4:
+                            DecodeSet(psInsn, ExecSEV, 0, 0, 0, 0);
+                            return(true);
+
+                        default:
+                            DecodeSet(psInsn, ExecNOP, 0, 0, 0, 0);
+                            return(true);
+                    }
+
+                default:
+                    break;
+            }
+            break;
+
+        case 0xC:
+        {
+            uint32_t ui32List = ui32Imm8;
+
+            if(!ui32List)
+                break;
+
+            DecodeSet(psInsn, (ui32Hw & 0x0800) ? ExecLDM : ExecSTM, 0,
+                      ui32Hi, 0, ui32List);
+
+            /*
+             * LDM does not write the base back if it is in the list.
+             */
+            psInsn->ui8Op = (!(ui32Hw & 0x0800) || !((ui32List >> ui32Hi) & 1)) ?
+                            THUMB_WRITEBACK : 0;
+            return(true);
+        }
+
+        case 0xD:
+            ui32Op = (ui32Hw >> 8) & 0xF;
+
+            if(ui32Op == 0xE)
+                break;
+
+            if(ui32Op == 0xF)
+            {
+                DecodeSet(psInsn, ExecSVC, 0, 0, 0, ui32Imm8);
+                return(true);
+            }
+
+            DecodeSet(psInsn, ExecBcc, 0, 0, 0,
+                      ui32PC + 4 + ThumbSignExtend(ui32Imm8 << 1, 9));
+            psInsn->ui8Op = (uint8_t)ui32Op;
+            return(true);
+
+        case 0xE:
+            DecodeSet(psInsn, ExecB, 0, 0, 0,
+                      ui32PC + 4 + ThumbSignExtend((ui32Hw & 0x7FF) << 1,
+                                                   12));
+            return(true);
+
+        default:
+            break;
+    }
+
+    /*
+     * Data processing (0100 00) and special data / branch exchange
+     * (0100 01).
+     */
+    if((ui32Hw >> 10) == 0x10)
+    {
+        static const uint8_t pui8Row[16] =
+        {
+            DP_AND, DP_EOR, DP_MOV, DP_MOV, DP_MOV, DP_ADC, DP_SBC, DP_MOV,
+            DP_TST, DP_RSB, DP_CMP, DP_CMN, DP_ORR, 0, DP_BIC, DP_MVN
+        };
+
+        ui32Op = (ui32Hw >> 6) & 0xF;
+
+        switch(ui32Op)
+        {
+            case 0x2:
+            case 0x3:
+            case 0x4:
+            case 0x7:
+            {
+                static const uint8_t pui8Type[8] =
+                {
+                    0, 0, THUMB_LSL, THUMB_LSR, THUMB_ASR, 0, 0, THUMB_ROR
+                };
+
+                DecodeSet(psInsn, g_ppfnDataProc[DP_MOV][DP_SHR], ui32Rd, 0,
+                          ui32Rd, 0);
+                psInsn->ui8Ra = (uint8_t)ui32Rn;
+                psInsn->ui8Shift = THUMB_SHIFT(pui8Type[ui32Op], 0);
+                return(true);
+            }
+
+            case 0x9:
+                DecodeImmediate(psInsn, DP_RSB, ui32Rd, ui32Rn, 0,
+                                THUMB_CARRY_KEEP);
+                return(true);
+
+            case 0xD:
+                DecodeSet(psInsn, ExecMUL, ui32Rd, ui32Rn, ui32Rd, 0);
+                return(true);
+
+            case 0xF:
+                DecodeSet(psInsn, g_ppfnDataProc[pui8Row[ui32Op]][DP_REG],
+                          ui32Rd, 0, ui32Rn, 0);
+                return(true);
+
+            default:
+                DecodeSet(psInsn, g_ppfnDataProc[pui8Row[ui32Op]][DP_REG],
+                          ui32Rd, ui32Rd, ui32Rn, 0);
+                return(true);
+        }
+    }
+
+    if((ui32Hw >> 10) == 0x11)
+    {
+        ui32Rd = (ui32Hw & 7) | ((ui32Hw >> 4) & 8);
+        ui32Rm = (ui32Hw >> 3) & 0xF;
+        psInsn->ui8S = THUMB_S_NEVER;
+
+        switch((ui32Hw >> 8) & 3)
+        {
+            case 0:
+                DecodeSet(psInsn, (ui32Rd == 15) ? ExecAddPC : ExecADDReg,
+                          ui32Rd, ui32Rd, ui32Rm, 0);
+                return(true);
+
+            case 1:
+                DecodeSet(psInsn, ExecCMPReg, 0, ui32Rd, ui32Rm, 0);
+                return(true);
+
+            case 2:
+                DecodeSet(psInsn, (ui32Rd == 15) ? ExecMovPC : ExecMOVReg,
+                          ui32Rd, 0, ui32Rm, 0);
+                return(true);
+
+            default:
+                DecodeSet(psInsn, (ui32Hw & 0x80) ? ExecBLX : ExecBX, 0, 0,
+                          ui32Rm, 0);
+                return(true);
+        }
+    }
+
+    return(false);
+}
+
+/*
+ * ThumbExpandImm_C().  Returns the carry out, or THUMB_CARRY_KEEP.
+ */
+static uint32_t
+DecodeModifiedImmediate(uint32_t ui32Imm12, uint32_t *pui32Value)
+{
+    uint32_t ui32Imm8 = ui32Imm12 & 0xFF;
+
+    if(!(ui32Imm12 & 0xC00))
+    {
+        switch((ui32Imm12 >> 8) & 3)
+        {
+            case 0:
+                *pui32Value = ui32Imm8;
+                break;
+
+            case 1:
+                *pui32Value = ui32Imm8 | (ui32Imm8 << 16);
+                break;
+
+            case 2:
+                *pui32Value = (ui32Imm8 << 8) | (ui32Imm8 << 24);
+                break;
+
+            default:
+                *pui32Value = ui32Imm8 * 0x01010101U;
+                break;
+        }
+
+        return(THUMB_CARRY_KEEP);
+    }
+
+    *pui32Value = ThumbRotate(0x80 | (ui32Imm12 & 0x7F), ui32Imm12 >> 7);
+
+    return(*pui32Value >> 31);
+}
+
+/*
+ * Maps the op field of the data-processing encodings to a row of
+ * g_ppfnDataProc, taking the compare and move aliases into account.
+ */
+static int32_t
+DecodeDataProcRow(uint32_t ui32Op, uint32_t ui32Rd, uint32_t ui32Rn,
+                  bool bSetFlags)
+{
+    switch(ui32Op)
+    {
+        case DP_AND:
+            return(((ui32Rd == 15) && bSetFlags) ? DP_TST : DP_AND);
+
+        case DP_ORR:
+            return((ui32Rn == 15) ? DP_MOV : DP_ORR);
+
+        case DP_ORN:
+            return((ui32Rn == 15) ? DP_MVN : DP_ORN);
+
+        case DP_EOR:
+            return(((ui32Rd == 15) && bSetFlags) ? DP_TEQ : DP_EOR);
+
+        case DP_ADD:
+            return(((ui32Rd == 15) && bSetFlags) ? DP_CMN : DP_ADD);
+
+        case DP_SUB:
+            return(((ui32Rd == 15) && bSetFlags) ? DP_CMP : DP_SUB);
+
+        case DP_BIC:
+        case DP_ADC:
+        case DP_SBC:
+        case DP_RSB:
+            return(ui32Op);
+
+        default:
+            return(-1);
+    }
+}
+
+static bool
+DecodeDataProcessing(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn,
+                     bool bImmediate)
+{
+    uint32_t ui32Op = (ui32Hw1 >> 5) & 0xF, ui32Rn = ui32Hw1 & 0xF;
+    uint32_t ui32Rd = (ui32Hw2 >> 8) & 0xF, ui32Value, ui32Carry;
+    bool bSetFlags = (ui32Hw1 >> 4) & 1;
+    int32_t i32Row = DecodeDataProcRow(ui32Op, ui32Rd, ui32Rn, bSetFlags);
+
+    psInsn->ui8S = bSetFlags ? THUMB_S_ALWAYS : THUMB_S_NEVER;
+
+    if(!bImmediate && (ui32Op == 6))
+    {
+        /*
+         * PKHBT and PKHTB.
+         */
+        DecodeShifted(psInsn, DP_MOV, ui32Rd, ui32Rn, ui32Hw2 & 0xF,
+                      (ui32Hw2 >> 4) & 3,
+                      ((ui32Hw2 >> 10) & 0x1C) | ((ui32Hw2 >> 6) & 3));
+        psInsn->pfnExec = ExecPKH;
+        psInsn->ui8Op = (ui32Hw2 >> 5) & 1;
+        return(true);
+    }
+
+    if(i32Row < 0)
+        return(false);
+
+    if((ui32Rd == 15) && ((i32Row < DP_TST) || (i32Row > DP_CMP)))
+        return(false);
+
+    if(bImmediate)
+    {
+        ui32Carry = DecodeModifiedImmediate(((ui32Hw1 & 0x0400) << 1) |
+                                            ((ui32Hw2 >> 4) & 0x700) |
+                                            (ui32Hw2 & 0xFF), &ui32Value);
+        DecodeImmediate(psInsn, i32Row, ui32Rd, ui32Rn, ui32Value, ui32Carry);
+        return(true);
+    }
+
+    DecodeShifted(psInsn, i32Row, ui32Rd, ui32Rn, ui32Hw2 & 0xF,
+                  (ui32Hw2 >> 4) & 3,
+                  ((ui32Hw2 >> 10) & 0x1C) | ((ui32Hw2 >> 6) & 3));
+    return(true);
+}
+
+static bool
+DecodePlainImmediate(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+                     tSimInsn *psInsn)
+{
+    uint32_t ui32Rn = ui32Hw1 & 0xF, ui32Rd = (ui32Hw2 >> 8) & 0xF;
+    uint32_t ui32Imm12 = ((ui32Hw1 & 0x0400) << 1) | ((ui32Hw2 >> 4) & 0x700) |
+                         (ui32Hw2 & 0xFF);
+    uint32_t ui32Lsb = ((ui32Hw2 >> 10) & 0x1C) | ((ui32Hw2 >> 6) & 3);
+    uint32_t ui32Field = ui32Hw2 & 0x1F;
+
+    psInsn->ui8S = THUMB_S_NEVER;
+
+    switch((ui32Hw1 >> 4) & 0x1F)
+    {
+        case 0x00:
+            if(ui32Rn == 15)
+                DecodeImmediate(psInsn, DP_MOV, ui32Rd, 0,
+                                ((ui32PC + 4) & ~3U) + ui32Imm12,
+                                THUMB_CARRY_KEEP);
+            else
+                DecodeImmediate(psInsn, DP_ADD, ui32Rd, ui32Rn, ui32Imm12,
+                                THUMB_CARRY_KEEP);
+            return(true);
+
+        case 0x0A:
+            if(ui32Rn == 15)
+                DecodeImmediate(psInsn, DP_MOV, ui32Rd, 0,
+                                ((ui32PC + 4) & ~3U) - ui32Imm12,
+                                THUMB_CARRY_KEEP);
+            else
+                DecodeImmediate(psInsn, DP_SUB, ui32Rd, ui32Rn, ui32Imm12,
+                                THUMB_CARRY_KEEP);
+            return(true);
+
+        case 0x04:
+            DecodeImmediate(psInsn, DP_MOV, ui32Rd, 0,
+                            ((ui32Hw1 & 0xF) << 12) | ui32Imm12,
+                            THUMB_CARRY_KEEP);
+            return(true);
+
+        case 0x0C:
+            DecodeSet(psInsn, ExecMOVT, ui32Rd, 0, 0,
+                      (((ui32Hw1 & 0xF) << 12) | ui32Imm12) << 16);
+            return(true);
+
+        case 0x10:
+        case 0x12:
+            if(((ui32Hw1 >> 4) & 0x1F) == 0x12 && !ui32Lsb)
+            {
+                DecodeSet(psInsn, ExecSSAT16, ui32Rd, ui32Rn, 0,
+                          (ui32Hw2 & 0xF) + 1);
+                return(true);
+            }
+
+            DecodeSet(psInsn, ExecSSAT, ui32Rd, 0, ui32Rn, ui32Field + 1);
+            psInsn->ui8Shift = THUMB_SHIFT((ui32Hw1 & 0x20) ? THUMB_ASR :
+                                           THUMB_LSL, ui32Lsb);
+            return(true);
+
+        case 0x18:
+        case 0x1A:
+            if(((ui32Hw1 >> 4) & 0x1F) == 0x1A && !ui32Lsb)
+            {
+                DecodeSet(psInsn, ExecUSAT16, ui32Rd, ui32Rn, 0,
+                          ui32Hw2 & 0xF);
+                return(true);
+            }
+
+            DecodeSet(psInsn, ExecUSAT, ui32Rd, 0, ui32Rn, ui32Field);
+            psInsn->ui8Shift = THUMB_SHIFT((ui32Hw1 & 0x20) ? THUMB_ASR :
+                                           THUMB_LSL, ui32Lsb);
+            return(true);
+
+        case 0x14:
+            DecodeSet(psInsn, ExecSBFX, ui32Rd, ui32Rn, 0, ui32Field + 1);
+            psInsn->ui8Shift = (uint8_t)ui32Lsb;
+            return(ui32Lsb + ui32Field < 32);
+
+        case 0x1C:
+            DecodeSet(psInsn, ExecUBFX, ui32Rd, ui32Rn, 0, ui32Field + 1);
+            psInsn->ui8Shift = (uint8_t)ui32Lsb;
+            return(ui32Lsb + ui32Field < 32);
+
+        case 0x16:
+            if(ui32Field < ui32Lsb)
+                return(false);
+
+            DecodeSet(psInsn, ExecBFI, ui32Rd,
+                      (ui32Rn == 15) ? SIM_CPU_REG_ZERO : ui32Rn, 0,
+                      (uint32_t)(((1ULL << (ui32Field + 1)) - 1) &
+                                 ~((1ULL << ui32Lsb) - 1)));
+            psInsn->ui8Shift = (uint8_t)ui32Lsb;
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+static bool
+DecodeBranchMisc(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+                 tSimInsn *psInsn)
+{
+    uint32_t ui32Op = (ui32Hw1 >> 4) & 0x7F, ui32S = (ui32Hw1 >> 10) & 1;
+    uint32_t ui32J1 = (ui32Hw2 >> 13) & 1, ui32J2 = (ui32Hw2 >> 11) & 1;
+    uint32_t ui32Offset;
+
+    switch((ui32Hw2 >> 12) & 5)
+    {
+        case 0:
+            if((ui32Op & 0x38) != 0x38)
+            {
+                ui32Offset = (ui32S << 20) | (ui32J2 << 19) | (ui32J1 << 18) |
+                             ((ui32Hw1 & 0x3F) << 12) |
+                             ((ui32Hw2 & 0x7FF) << 1);
+                DecodeSet(psInsn, ExecBcc, 0, 0, 0,
+                          ui32PC + 4 + ThumbSignExtend(ui32Offset, 21));
+                psInsn->ui8Op = (ui32Hw1 >> 6) & 0xF;
+                return(true);
+            }
+
+            switch(ui32Op)
+            {
+                case 0x38:
+                case 0x39:
+                    DecodeSet(psInsn, ExecMSR, 0, ui32Hw1 & 0xF, 0,
+                              ui32Hw2 & 0xFF);
+                    psInsn->ui8Op = (ui32Hw2 >> 10) & 3;
+                    return(true);
+
+                case 0x3A:
+                    switch(ui32Hw2 & 0xFF)
+                    {
+                        case 2:
+                            DecodeSet(psInsn, ExecWFE, 0, 0, 0, 0);
+                            return(true);
+
+                        case 3:
+                            DecodeSet(psInsn, ExecWFI, 0, 0, 0, 0);
+                            return(true);
+
+                        case 4:
+                            DecodeSet(psInsn, ExecSEV, 0, 0, 0, 0);
+                            return(true);
+
+                        default:
+                            DecodeSet(psInsn, ExecNOP, 0, 0, 0, 0);
+                            return(true);
+                    }
+
+                case 0x3B:
+                    switch((ui32Hw2 >> 4) & 0xF)
+                    {
+                        case 2:
+                            DecodeSet(psInsn, ExecCLREX, 0, 0, 0, 0);
+                            return(true);
+
+                        case 4:
+                        case 5:
+                        case 6:
+                            DecodeSet(psInsn, ExecNOP, 0, 0, 0, 0);
+                            return(true);
+
+                        default:
+                            return(false);
+                    }
+
+                case 0x3E:
+                case 0x3F:
+                    DecodeSet(psInsn, ExecMRS, (ui32Hw2 >> 8) & 0xF, 0, 0,
+                              ui32Hw2 & 0xFF);
+                    return(true);
+
+                default:
+                    return(false);
+            }
+
+        case 1:
+        case 5:
+            ui32Offset = (ui32S << 24) | ((~(ui32J1 ^ ui32S) & 1) << 23) |
+                         ((~(ui32J2 ^ ui32S) & 1) << 22) |
+                         ((ui32Hw1 & 0x3FF) << 12) | ((ui32Hw2 & 0x7FF) << 1);
+            DecodeSet(psInsn, (ui32Hw2 & 0x4000) ? ExecBL : ExecB, 0, 0, 0,
+                      ui32PC + 4 + ThumbSignExtend(ui32Offset, 25));
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+static bool
+DecodeLoadStoreMultiple(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn)
+{
+    uint32_t ui32Rn = ui32Hw1 & 0xF;
+    bool bLoad = (ui32Hw1 >> 4) & 1, bWriteback = (ui32Hw1 >> 5) & 1;
+
+    switch((ui32Hw1 >> 7) & 3)
+    {
+        case 1:
+            DecodeSet(psInsn, bLoad ? ExecLDM : ExecSTM, 0, ui32Rn, 0,
+                      ui32Hw2);
+            break;
+
+        case 2:
+            DecodeSet(psInsn, bLoad ? ExecLDMDB : ExecSTMDB, 0, ui32Rn, 0,
+                      ui32Hw2);
+            break;
+
+        default:
+            return(false);
+    }
+
+    psInsn->ui8Op = bWriteback ? THUMB_WRITEBACK : 0;
+
+    return(ui32Hw2 != 0);
+}
+
+static bool
+DecodeDualExclusive(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+                    tSimInsn *psInsn)
+{
+    uint32_t ui32Op1 = (ui32Hw1 >> 7) & 3, ui32Op2 = (ui32Hw1 >> 4) & 3;
+    uint32_t ui32Rn = ui32Hw1 & 0xF, ui32Rt = (ui32Hw2 >> 12) & 0xF;
+    uint32_t ui32Imm = (ui32Hw2 & 0xFF) * 4;
+
+    if((ui32Op1 & 2) || (ui32Op2 & 2))
+    {
+        bool bAdd = (ui32Hw1 >> 7) & 1;
+
+        DecodeSet(psInsn, (ui32Hw1 & 0x10) ? ExecLDRD : ExecSTRD, ui32Rt,
+                  ui32Rn, 0, bAdd ? ui32Imm : -ui32Imm);
+        psInsn->ui8Ra = (ui32Hw2 >> 8) & 0xF;
+        psInsn->ui8Op = ((ui32Hw1 & 0x100) ? THUMB_INDEX : 0) |
+                        ((ui32Hw1 & 0x20) ? THUMB_WRITEBACK : 0);
+
+        /*
+         * LDRD (literal) is resolved to an absolute address.
+         */
+        if(ui32Rn == 15)
+        {
+            psInsn->ui8Rn = SIM_CPU_REG_ZERO;
+            psInsn->ui32Imm += (ui32PC + 4) & ~3U;
+            psInsn->ui8Op = THUMB_INDEX;
+        }
+
+        return(true);
+    }
+
+    if(ui32Op1 == 0)
+    {
+        DecodeSet(psInsn, ui32Op2 ? ExecLDREX : ExecSTREX, ui32Rt, ui32Rn, 0,
+                  ui32Imm);
+        psInsn->ui8Ra = (ui32Hw2 >> 8) & 0xF;
+        psInsn->ui8Shift = 4;
+        return(true);
+    }
+
+    switch(((ui32Op2 & 1) << 4) | ((ui32Hw2 >> 4) & 0xF))
+    {
+        case 0x04:
+        case 0x05:
+            DecodeSet(psInsn, ExecSTREX, ui32Rt, ui32Rn, 0, 0);
+            psInsn->ui8Ra = ui32Hw2 & 0xF;
+            psInsn->ui8Shift = (ui32Hw2 & 0x10) ? 2 : 1;
+            return(true);
+
+        case 0x10:
+        case 0x11:
+            DecodeSet(psInsn, ExecTBB, 0, ui32Rn, ui32Hw2 & 0xF, 0);
+            psInsn->ui8Shift = (ui32Hw2 & 0x10) ? 2 : 1;
+            return(true);
+
+        case 0x14:
+        case 0x15:
+            DecodeSet(psInsn, ExecLDREX, ui32Rt, ui32Rn, 0, 0);
+            psInsn->ui8Shift = (ui32Hw2 & 0x10) ? 2 : 1;
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+/*
+ * Single loads and stores: ui32Size is 0, 1 or 2 for byte, halfword and
+ * word accesses.
+ */
+static bool
+DecodeSingle(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+             tSimInsn *psInsn, uint32_t ui32Size, uint32_t ui32Kind)
+{
+    uint32_t ui32Rn = ui32Hw1 & 0xF, ui32Rt = (ui32Hw2 >> 12) & 0xF;
+    uint32_t ui32Imm8 = ui32Hw2 & 0xFF;
+
+    if(ui32Rn == 15)
+    {
+        uint32_t ui32Base = (ui32PC + 4) & ~3U, ui32Imm12 = ui32Hw2 & 0xFFF;
+
+        if(ui32Kind == LS_STORE)
+            return(false);
+
+        DecodeLoadStore(psInsn, ui32Size, ui32Kind, LS_IMM, ui32Rt,
+                        SIM_CPU_REG_ZERO, 0,
+                        (ui32Hw1 & 0x80) ? ui32Base + ui32Imm12 :
+                                           ui32Base - ui32Imm12);
+        return(true);
+    }
+
+    if(ui32Hw1 & 0x80)
+    {
+        DecodeLoadStore(psInsn, ui32Size, ui32Kind, LS_IMM, ui32Rt, ui32Rn, 0,
+                        ui32Hw2 & 0xFFF);
+        return(true);
+    }
+
+    if(ui32Hw2 & 0x800)
+    {
+        bool bIndex = (ui32Hw2 >> 10) & 1, bAdd = (ui32Hw2 >> 9) & 1;
+        bool bWriteback = (ui32Hw2 >> 8) & 1;
+        uint32_t ui32Offset = bAdd ? ui32Imm8 : -ui32Imm8;
+
+        if(!bIndex && !bWriteback)
+            return(false);
+
+        DecodeLoadStore(psInsn, ui32Size, ui32Kind,
+                        !bWriteback ? LS_IMM : bIndex ? LS_PRE : LS_POST,
+                        ui32Rt, ui32Rn, 0, ui32Offset);
+        return(true);
+    }
+
+    if((ui32Hw2 & 0xFC0) == 0)
+    {
+        DecodeLoadStore(psInsn, ui32Size, ui32Kind, LS_REG, ui32Rt, ui32Rn,
+                        ui32Hw2 & 0xF, 0);
+        psInsn->ui8Shift = (ui32Hw2 >> 4) & 3;
+        return(true);
+    }
+
+    return(false);
+}
+
+static bool
+DecodeDataProcReg(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn)
+{
+    uint32_t ui32Op1 = (ui32Hw1 >> 4) & 0xF, ui32Op2 = (ui32Hw2 >> 4) & 0xF;
+    uint32_t ui32Rn = ui32Hw1 & 0xF, ui32Rd = (ui32Hw2 >> 8) & 0xF;
+    uint32_t ui32Rm = ui32Hw2 & 0xF;
+
+    psInsn->ui8S = THUMB_S_NEVER;
+
+    if(!(ui32Op1 & 8) && !ui32Op2)
+    {
+        /*
+         * LSL, LSR, ASR and ROR by register.
+         */
+        DecodeSet(psInsn, g_ppfnDataProc[DP_MOV][DP_SHR], ui32Rd, 0, ui32Rn,
+                  0);
+        psInsn->ui8Ra = (uint8_t)ui32Rm;
+        psInsn->ui8Shift = THUMB_SHIFT(ui32Op1 >> 1, 0);
+        psInsn->ui8S = (ui32Op1 & 1) ? THUMB_S_ALWAYS : THUMB_S_NEVER;
+        return(true);
+    }
+
+    if(!(ui32Op1 & 8) && (ui32Op2 & 8))
+    {
+        static const tSimExec ppfnExtend[6] =
+        {
+            ExecSXTH, ExecUXTH, ExecSXTB16, ExecUXTB16, ExecSXTB, ExecUXTB
+        };
+
+        if(ui32Op1 > 5)
+            return(false);
+
+        DecodeSet(psInsn, ppfnExtend[ui32Op1], ui32Rd,
+                  (ui32Rn == 15) ? SIM_CPU_REG_ZERO : ui32Rn, ui32Rm, 0);
+        psInsn->ui8Shift = (uint8_t)(((ui32Hw2 >> 4) & 3) * 8);
+        return(true);
+    }
+
+    if((ui32Op1 & 8) && !(ui32Op2 & 8))
+    {
+        static const uint8_t pui8Prefix[8] =
+        {
+            PAR_S, PAR_Q, PAR_SH, 0xFF, PAR_U, PAR_UQ, PAR_UH, 0xFF
+        };
+        uint32_t ui32Prefix = pui8Prefix[ui32Op2 & 7];
+
+        if((ui32Prefix == 0xFF) || ((ui32Op1 & 7) == 3) ||
+           ((ui32Op1 & 7) == 7))
+            return(false);
+
+        DecodeSet(psInsn, ExecParallel, ui32Rd, ui32Rn, ui32Rm, 0);
+        psInsn->ui8Op = (uint8_t)((ui32Prefix << 3) | (ui32Op1 & 7));
+        return(true);
+    }
+
+    if(((ui32Op1 & 0xC) == 8) && ((ui32Op2 & 0xC) == 8))
+    {
+        switch(((ui32Op1 & 3) << 2) | (ui32Op2 & 3))
+        {
+            case 0x0:
+            case 0x1:
+            case 0x2:
+            case 0x3:
+                DecodeSet(psInsn, ExecQADD, ui32Rd, ui32Rn, ui32Rm, 0);
+                psInsn->ui8Op = ((ui32Op2 & 1) ? 2 : 0) |
+                                ((ui32Op2 & 2) ? 1 : 0);
+                return(true);
+
+            case 0x4:
+                DecodeSet(psInsn, ExecREV, ui32Rd, 0, ui32Rm, 0);
+                return(true);
+
+            case 0x5:
+                DecodeSet(psInsn, ExecREV16, ui32Rd, 0, ui32Rm, 0);
+                return(true);
+
+            case 0x6:
+                DecodeSet(psInsn, ExecRBIT, ui32Rd, 0, ui32Rm, 0);
+                return(true);
+
+            case 0x7:
+                DecodeSet(psInsn, ExecREVSH, ui32Rd, 0, ui32Rm, 0);
+                return(true);
+
+            case 0x8:
+                DecodeSet(psInsn, ExecSEL, ui32Rd, ui32Rn, ui32Rm, 0);
+                return(true);
+
+            case 0xC:
+                DecodeSet(psInsn, ExecCLZ, ui32Rd, 0, ui32Rm, 0);
+                return(true);
+
+            default:
+                return(false);
+        }
+    }
+
+    return(false);
+}
+
+static bool
+DecodeMultiply(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn)
+{
+    uint32_t ui32Op1 = (ui32Hw1 >> 4) & 7, ui32Op2 = (ui32Hw2 >> 4) & 3;
+    uint32_t ui32Rn = ui32Hw1 & 0xF, ui32Rd = (ui32Hw2 >> 8) & 0xF;
+    uint32_t ui32Rm = ui32Hw2 & 0xF, ui32Ra = (ui32Hw2 >> 12) & 0xF;
+
+    psInsn->ui8S = THUMB_S_NEVER;
+    psInsn->ui8Ra = (ui32Ra == 15) ? SIM_CPU_REG_ZERO : (uint8_t)ui32Ra;
+
+    switch(ui32Op1)
+    {
+        case 0:
+            if(ui32Op2 == 0)
+            {
+                DecodeSet(psInsn, (ui32Ra == 15) ? ExecMUL : ExecMLA, ui32Rd,
+                          ui32Rn, ui32Rm, 0);
+                return(true);
+            }
+
+            if(ui32Op2 == 1)
+            {
+                DecodeSet(psInsn, ExecMLS, ui32Rd, ui32Rn, ui32Rm, 0);
+                psInsn->ui8Ra = (uint8_t)ui32Ra;
+                return(true);
+            }
+
+            return(false);
+
+        case 1:
+            DecodeSet(psInsn, ExecSMLAxy, ui32Rd, ui32Rn, ui32Rm, 0);
+            psInsn->ui8Op = ((ui32Op2 & 2) ? 2 : 0) | (ui32Op2 & 1);
+            return(true);
+
+        case 2:
+        case 4:
+            if(ui32Op2 & 2)
+                return(false);
+
+            DecodeSet(psInsn, ExecSMLAD, ui32Rd, ui32Rn, ui32Rm, 0);
+            psInsn->ui8Op = (ui32Op2 & 1) | ((ui32Op1 == 4) ? 2 : 0);
+            return(true);
+
+        case 3:
+            if(ui32Op2 & 2)
+                return(false);
+
+            DecodeSet(psInsn, ExecSMLAWy, ui32Rd, ui32Rn, ui32Rm, 0);
+            psInsn->ui8Op = ui32Op2 & 1;
+            return(true);
+
+        case 5:
+        case 6:
+            if(ui32Op2 & 2)
+                return(false);
+
+            DecodeSet(psInsn, ExecSMMLA, ui32Rd, ui32Rn, ui32Rm, 0);
+            psInsn->ui8Op = (ui32Op2 & 1) | ((ui32Op1 == 6) ? 2 : 0);
+            return(true);
+
+        default:
+            if(ui32Op2)
+                return(false);
+
+            DecodeSet(psInsn, ExecUSADA8, ui32Rd, ui32Rn, ui32Rm, 0);
+            return(true);
+    }
+}
+
+static bool
+DecodeLongMultiply(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn)
+{
+    uint32_t ui32Op1 = (ui32Hw1 >> 4) & 7, ui32Op2 = (ui32Hw2 >> 4) & 0xF;
+    uint32_t ui32Rn = ui32Hw1 & 0xF, ui32RdLo = (ui32Hw2 >> 12) & 0xF;
+    uint32_t ui32RdHi = (ui32Hw2 >> 8) & 0xF, ui32Rm = ui32Hw2 & 0xF;
+
+    psInsn->ui8S = THUMB_S_NEVER;
+    DecodeSet(psInsn, ExecLongMul, ui32RdLo, ui32Rn, ui32Rm, 0);
+    psInsn->ui8Ra = (uint8_t)ui32RdHi;
+
+    switch((ui32Op1 << 4) | ui32Op2)
+    {
+        case 0x00:
+            psInsn->ui8Op = LONG_SMULL;
+            return(true);
+
+        case 0x20:
+            psInsn->ui8Op = LONG_UMULL;
+            return(true);
+
+        case 0x40:
+            psInsn->ui8Op = LONG_SMLAL;
+            return(true);
+
+        case 0x60:
+            psInsn->ui8Op = LONG_UMLAL;
+            return(true);
+
+        case 0x66:
+            psInsn->ui8Op = LONG_UMAAL;
+            return(true);
+
+        case 0x1F:
+            DecodeSet(psInsn, ExecSDIV, ui32RdHi, ui32Rn, ui32Rm, 0);
+            return(true);
+
+        case 0x3F:
+            DecodeSet(psInsn, ExecUDIV, ui32RdHi, ui32Rn, ui32Rm, 0);
+            return(true);
+
+        case 0x48:
+        case 0x49:
+        case 0x4A:
+        case 0x4B:
+            psInsn->pfnExec = ExecSMLALxy;
+            psInsn->ui8Op = ui32Op2 & 3;
+            return(true);
+
+        case 0x4C:
+        case 0x4D:
+        case 0x5C:
+        case 0x5D:
+            psInsn->pfnExec = ExecSMLALD;
+            psInsn->ui8Op = (ui32Op2 & 1) | ((ui32Op1 == 5) ? 2 : 0);
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+static bool
+Decode32(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+         tSimInsn *psInsn)
+{
+    uint32_t ui32Op2 = (ui32Hw1 >> 4) & 0x7F;
+
+    psInsn->ui8S = THUMB_S_NEVER;
+
+    switch((ui32Hw1 >> 11) & 3)
+    {
+        case 1:
+            if(!(ui32Op2 & 0x64))
+                return(DecodeLoadStoreMultiple(ui32Hw1, ui32Hw2, psInsn));
+
+            if((ui32Op2 & 0x64) == 0x04)
+                return(DecodeDualExclusive(ui32PC, ui32Hw1, ui32Hw2, psInsn));
+
+            if((ui32Op2 & 0x60) == 0x20)
+                return(DecodeDataProcessing(ui32Hw1, ui32Hw2, psInsn, false));
+
+            break;
+
+        case 2:
+            if(ui32Hw2 & 0x8000)
+                return(DecodeBranchMisc(ui32PC, ui32Hw1, ui32Hw2, psInsn));
+
+            if(!(ui32Op2 & 0x20))
+                return(DecodeDataProcessing(ui32Hw1, ui32Hw2, psInsn, true));
+
+            return(DecodePlainImmediate(ui32PC, ui32Hw1, ui32Hw2, psInsn));
+
+        default:
+            if((ui32Op2 & 0x71) == 0x00)
+            {
+                static const uint8_t pui8Size[4] = { 0, 1, 2, 0xFF };
+
+                if(pui8Size[(ui32Op2 >> 1) & 3] == 0xFF)
+                    return(false);
+
+                return(DecodeSingle(ui32PC, ui32Hw1, ui32Hw2, psInsn,
+                                    pui8Size[(ui32Op2 >> 1) & 3], LS_STORE));
+            }
+
+            if((ui32Op2 & 0x67) == 0x01 || (ui32Op2 & 0x67) == 0x03)
+            {
+                uint32_t ui32Size = (ui32Op2 & 2) ? 1 : 0;
+
+                /*
+                 * Loads to the PC of bytes and halfwords are the PLD and
+                 * PLI hints.
+                 */
+                if(((ui32Hw2 >> 12) & 0xF) == 15)
+                {
+                    DecodeSet(psInsn, ExecNOP, 0, 0, 0, 0);
+                    return(true);
+                }
+
+                return(DecodeSingle(ui32PC, ui32Hw1, ui32Hw2, psInsn,
+                                    ui32Size,
+                                    (ui32Hw1 & 0x100) ? LS_LOAD_SIGNED :
+                                                        LS_LOAD));
+            }
+
+            if((ui32Op2 & 0x77) == 0x05)
+                return(DecodeSingle(ui32PC, ui32Hw1, ui32Hw2, psInsn, 2,
+                                    LS_LOAD));
+
+            if((ui32Op2 & 0x70) == 0x20)
+                return(DecodeDataProcReg(ui32Hw1, ui32Hw2, psInsn));
+
+            if((ui32Op2 & 0x78) == 0x30)
+                return(DecodeMultiply(ui32Hw1, ui32Hw2, psInsn));
+
+            if((ui32Op2 & 0x78) == 0x38)
+                return(DecodeLongMultiply(ui32Hw1, ui32Hw2, psInsn));
+
+            break;
+    }
+
+    /*
+     * Coprocessor space: only the floating-point unit is present.
+     */
+    if((ui32Op2 & 0x40) && ((ui32Hw1 & 0xEC00) == 0xEC00))
+    {
+        if(((ui32Hw2 >> 9) & 7) == 5)
+            return(SimVFPDecode(ui32PC, ui32Hw1, ui32Hw2, psInsn));
+
+        DecodeSet(psInsn, ExecNoCoprocessor, 0, 0, 0, 0);
+        return(true);
+    }
+
+    return(false);
+}
+
+/*
+ * Decodes the instruction at ui32PC.  Undecodable encodings execute as
+ * UNDEFINED; the return value tells whether the decode succeeded.
+ */
+bool
+SimThumbDecode(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+               tSimInsn *psInsn)
+{
+    bool bValid;
+
+    memset(psInsn, 0, sizeof(*psInsn));
+
+    if((ui32Hw1 >> 11) < 0x1D)
+    {
+        psInsn->ui8Size = 2;
+        bValid = Decode16(ui32PC, ui32Hw1, psInsn);
+    }
+    else
+    {
+        psInsn->ui8Size = 4;
+        bValid = Decode32(ui32PC, ui32Hw1, ui32Hw2, psInsn);
+    }
+
+    if(!bValid || !psInsn->pfnExec)
+    {
+        psInsn->pfnExec = SimThumbUndefined;
+        return(false);
+    }
+
+    return(true);
+}
+
+/*
+ * Reports the operation and second operand kind of a data-processing
+ * instruction, so it can be translated to host code.  Returns false for other
+ * instructions.
+ */
+bool
+SimThumbDataProc(const tSimInsn *psInsn, uint32_t *pui32Op,
+                 uint32_t *pui32Kind)
+{
+    uint32_t ui32Op, ui32Kind;
+
+    for(ui32Op = 0; ui32Op < DP_ROWS; ui32Op++)
+    {
+        for(ui32Kind = 0; ui32Kind < 4; ui32Kind++)
+        {
+            if(g_ppfnDataProc[ui32Op][ui32Kind] &&
+               (g_ppfnDataProc[ui32Op][ui32Kind] == psInsn->pfnExec))
+            {
+                *pui32Op = ui32Op;
+                *pui32Kind = ui32Kind;
+                return(true);
+            }
+        }
+    }
+
+    return(false);
+}
+
+/*
+ * Reports the condition and target of B, B<c> and BL, and whether the
+ * return address goes to LR.  Returns false for other instructions.
+ */
+bool
+SimThumbDirectBranch(const tSimInsn *psInsn, uint32_t *pui32Cond,
+                     bool *pbLink)
+{
+    if(psInsn->pfnExec == ExecBcc)
+        *pui32Cond = psInsn->ui8Op;
+    else if((psInsn->pfnExec == ExecB) || (psInsn->pfnExec == ExecBL))
+        *pui32Cond = 14;
+    else
+        return(false);
+
+    *pbLink = (psInsn->pfnExec == ExecBL);
+
+    return(true);
+}
+
+/*
+ * Returns true if the instruction may transfer control, start an IT block or
+ * change what the processor is waiting for, so a translated block ends
+ * after it.
+ */
+bool
+SimThumbEndsBlock(const tSimInsn *psInsn)
+{
+    static const tSimExec ppfnFlow[] =
+    {
+        ExecMovPC, ExecAddPC, ExecB, ExecBcc, ExecBL, ExecBX, ExecBLX,
+        ExecCBZ, ExecTBB, ExecIT, ExecWFI, ExecWFE, ExecSVC, ExecBKPT,
+        ExecCPS, ExecMSR, ExecNoCoprocessor, SimThumbUndefined
+    };
+    uint32_t ui32Idx, ui32Op, ui32Kind;
+
+    for(ui32Idx = 0; ui32Idx < sizeof(ppfnFlow) / sizeof(ppfnFlow[0]);
+        ui32Idx++)
+        if(psInsn->pfnExec == ppfnFlow[ui32Idx])
+            return(true);
+
+    /*
+     * LDM/POP with the PC in the register list and loads into the PC.  The
+     * compare and test forms of data processing leave Rd at 15.
+     */
+    if((psInsn->pfnExec == ExecLDM) || (psInsn->pfnExec == ExecLDMDB))
+        return((psInsn->ui32Imm & 0x8000) != 0);
+
+    return((psInsn->ui8Rd == 15) &&
+           !SimThumbDataProc(psInsn, &ui32Op, &ui32Kind));
+}
+
+/*
+ * Reports the address, size and direction of a load or store of a single
+ * register without writeback, so idle loops can be checked for the memory
+ * they touch.  Returns false for other instructions.
+ */
+bool
+SimThumbAccess(const tSimCpu *psCpu, const tSimInsn *psInsn,
+               uint32_t *pui32Addr, uint32_t *pui32Size, bool *pbStore)
+{
+    uint32_t ui32Size, ui32Kind, ui32Mode;
+
+    for(ui32Size = 0; ui32Size < 3; ui32Size++)
+    {
+        for(ui32Kind = 0; ui32Kind < 3; ui32Kind++)
+        {
+            for(ui32Mode = LS_IMM; ui32Mode <= LS_REG; ui32Mode++)
+            {
+                if(!g_ppfnLoadStore[ui32Size][ui32Kind][ui32Mode] ||
+                   (g_ppfnLoadStore[ui32Size][ui32Kind][ui32Mode] !=
+                    psInsn->pfnExec))
+                    continue;
+
+                *pui32Addr = REG(psInsn->ui8Rn) +
+                             ((ui32Mode == LS_IMM) ? psInsn->ui32Imm :
+                              (REG(psInsn->ui8Rm) << psInsn->ui8Shift));
+                *pui32Size = 1U << ui32Size;
+                *pbStore = (ui32Kind == LS_STORE);
+
+                return(true);
+            }
+        }
+    }
+
+    return(false);
+}
+
+/*
+ * Reports the size and kind of a load or store of a single register without
+ * writeback, and whether its offset is a shifted register rather than an
+ * immediate, for the translator to emit it inline.  Returns false for other
+ * instructions.
+ */
+bool
+SimThumbLoadStore(const tSimInsn *psInsn, uint32_t *pui32Size, bool *pbStore,
+                  bool *pbSigned, bool *pbReg)
+{
+    uint32_t ui32Size, ui32Kind, ui32Mode;
+
+    for(ui32Size = 0; ui32Size < 3; ui32Size++)
+    {
+        for(ui32Kind = 0; ui32Kind < 3; ui32Kind++)
+        {
+            for(ui32Mode = LS_IMM; ui32Mode <= LS_REG; ui32Mode++)
+            {
+                if(!g_ppfnLoadStore[ui32Size][ui32Kind][ui32Mode] ||
+                   (g_ppfnLoadStore[ui32Size][ui32Kind][ui32Mode] !=
+                    psInsn->pfnExec))
+                    continue;
+
+                *pui32Size = 1U << ui32Size;
+                *pbStore = (ui32Kind == LS_STORE);
+                *pbSigned = (ui32Kind == LS_LOAD_SIGNED);
+                *pbReg = (ui32Mode == LS_REG);
+
+                return(true);
+            }
+        }
+    }
+
+    return(false);
+}
+
+/*
+ * Returns true for the instructions that only compute a register from other
+ * registers and the flags, leaving the rest of the machine alone: data
+ * processing, multiplies, extends and bit field operations.
+ */
+bool
+SimThumbPure(const tSimInsn *psInsn)
+{
+    static const tSimExec ppfnPure[] =
+    {
+        ExecMUL, ExecMLA, ExecMLS, ExecSXTB, ExecSXTH, ExecUXTB, ExecUXTH,
+        ExecSBFX, ExecUBFX, ExecBFI, ExecMOVT, ExecCLZ, ExecRBIT, ExecREV,
+        ExecREV16, ExecREVSH, ExecNOP
+    };
+    uint32_t ui32Idx, ui32Op, ui32Kind;
+
+    for(ui32Idx = 0; ui32Idx < sizeof(ppfnPure) / sizeof(ppfnPure[0]);
+        ui32Idx++)
+        if(psInsn->pfnExec == ppfnPure[ui32Idx])
+            return(true);
+
+    return(SimThumbDataProc(psInsn, &ui32Op, &ui32Kind));
+}
+
+/*
+ * Returns tSimInsn.ui8Cycles for a decoded instruction: its issue cycles on
+ * the Cortex-M4 with zero wait state memory, not counting the pipeline
+ * refill of a taken branch, and how they vary at run time.
+ */
+uint8_t
+SimThumbCycles(const tSimInsn *psInsn)
+{
+    tSimExec pfnExec = psInsn->pfnExec;
+    uint32_t ui32Size, ui32Kind, ui32Mode, ui32Cycles;
+
+    for(ui32Size = 0; ui32Size < 3; ui32Size++)
+    {
+        for(ui32Kind = 0; ui32Kind < 3; ui32Kind++)
+        {
+            for(ui32Mode = LS_IMM; ui32Mode <= LS_POST; ui32Mode++)
+            {
+                if(!pfnExec ||
+                   (g_ppfnLoadStore[ui32Size][ui32Kind][ui32Mode] != pfnExec))
+                    continue;
+
+                if((ui32Kind != LS_STORE) &&
+                   (psInsn->ui8Rn == SIM_CPU_REG_ZERO) &&
+                   (psInsn->ui32Imm < SIM_FLASH_BASE + SIM_FLASH_SIZE))
+                    return(2 | SIM_CPU_CYCLES_PIPE | SIM_CPU_CYCLES_FLASH);
+
+                return(2 | SIM_CPU_CYCLES_PIPE);
+            }
+        }
+    }
+
+    if((pfnExec == ExecLDM) || (pfnExec == ExecLDMDB) ||
+       (pfnExec == ExecSTM) || (pfnExec == ExecSTMDB))
+        return((uint8_t)(1 + ThumbRegisterCount(psInsn->ui32Imm)));
+
+    if((pfnExec == ExecLDRD) || (pfnExec == ExecSTRD))
+        return(((psInsn->ui8Rn == SIM_CPU_REG_ZERO) &&
+                (psInsn->ui32Imm < SIM_FLASH_BASE + SIM_FLASH_SIZE)) ?
+               (3 | SIM_CPU_CYCLES_FLASH) : 3);
+
+    if((pfnExec == ExecUDIV) || (pfnExec == ExecSDIV))
+        return(2 | SIM_CPU_CYCLES_DIVIDE);
+
+    if((pfnExec == ExecMLA) || (pfnExec == ExecMLS) ||
+       (pfnExec == ExecLDREX) || (pfnExec == ExecSTREX) ||
+       (pfnExec == ExecTBB) || (pfnExec == ExecMRS) || (pfnExec == ExecMSR))
+        return(2);
+
+    ui32Cycles = SimVFPCycles(psInsn);
+
+    return((uint8_t)(ui32Cycles ? ui32Cycles : 1));
+}
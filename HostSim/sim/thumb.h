@@ -0,0 +1,264 @@
+#ifndef __SIM_THUMB_H__
+#define __SIM_THUMB_H__
+
+#include "cpu.h"
+#include "shadow.h"
+
+/*
+ * Interface between the processor core and the instruction decoders.
+ *
+ * Shift types as encoded in the instructions.
+ */
+#define THUMB_LSL               0
+#define THUMB_LSR               1
+#define THUMB_ASR               2
+#define THUMB_ROR               3
+
+/*
+ * Values of tSimInsn.ui8S: flags are never set, set outside IT blocks only
+ * (the 16-bit encodings) or always set.
+ */
+#define THUMB_S_NEVER           0
+#define THUMB_S_OUTSIDE_IT      1
+#define THUMB_S_ALWAYS          2
+
+/*
+ * tSimInsn.ui8Shift of immediate operands: the carry out of the immediate
+ * expansion, or THUMB_CARRY_KEEP if the carry flag is unchanged.
+ */
+#define THUMB_CARRY_KEEP        0xFF
+
+/*
+ * Data-processing operations, indexed by the op field of the 32-bit
+ * encodings.  The compare and test forms (Rd == PC with S set) use the rows
+ * past the end.
+ */
+enum
+{
+    DP_AND = 0, DP_BIC = 1, DP_ORR = 2, DP_ORN = 3, DP_EOR = 4, DP_ADD = 8,
+    DP_ADC = 10, DP_SBC = 11, DP_SUB = 13, DP_RSB = 14,
+    DP_TST = 16, DP_TEQ, DP_CMN, DP_CMP, DP_MOV, DP_MVN, DP_ROWS
+};
+
+/*
+ * Kinds of second operand: an immediate, a register, a register shifted by
+ * an immediate and a register shifted by a register.
+ */
+#define DP_IMM                  0
+#define DP_REG                  1
+#define DP_SHI                  2
+#define DP_SHR                  3
+
+bool SimThumbDecode(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+                    tSimInsn *psInsn);
+bool SimVFPDecode(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+                  tSimInsn *psInsn);
+void SimThumbUndefined(tSimMachine *psMachine, const tSimInsn *psInsn);
+bool SimThumbDataProc(const tSimInsn *psInsn, uint32_t *pui32Op,
+                      uint32_t *pui32Kind);
+bool SimThumbDirectBranch(const tSimInsn *psInsn, uint32_t *pui32Cond,
+                          bool *pbLink);
+bool SimThumbEndsBlock(const tSimInsn *psInsn);
+bool SimThumbAccess(const tSimCpu *psCpu, const tSimInsn *psInsn,
+                    uint32_t *pui32Addr, uint32_t *pui32Size, bool *pbStore);
+bool SimThumbLoadStore(const tSimInsn *psInsn, uint32_t *pui32Size,
+                       bool *pbStore, bool *pbSigned, bool *pbReg);
+bool SimThumbPure(const tSimInsn *psInsn);
+uint8_t SimThumbCycles(const tSimInsn *psInsn);
+uint32_t SimVFPCycles(const tSimInsn *psInsn);
+
+static inline bool
+ThumbSetFlags(const tSimCpu *psCpu, const tSimInsn *psInsn)
+{
+    return(psInsn->ui8S > (psCpu->ui32IT != 0));
+}
+
+static inline void
+ThumbSetNZ(tSimCpu *psCpu, uint32_t ui32Result)
+{
+    psCpu->ui8N = ui32Result >> 31;
+    psCpu->ui8Z = (ui32Result == 0);
+}
+
+static inline bool
+ThumbCondition(const tSimCpu *psCpu, uint32_t ui32Cond)
+{
+    bool bResult;
+
+    switch(ui32Cond >> 1)
+    {
+        case 0:
+            bResult = psCpu->ui8Z;
+            break;
+
+        case 1:
+            bResult = psCpu->ui8C;
+            break;
+
+        case 2:
+            bResult = psCpu->ui8N;
+            break;
+
+        case 3:
+            bResult = psCpu->ui8V;
+            break;
+
+        case 4:
+            bResult = psCpu->ui8C && !psCpu->ui8Z;
+            break;
+
+        case 5:
+            bResult = (psCpu->ui8N == psCpu->ui8V);
+            break;
+
+        case 6:
+            bResult = (psCpu->ui8N == psCpu->ui8V) && !psCpu->ui8Z;
+            break;
+
+        default:
+            return(true);
+    }
+
+    return((ui32Cond & 1) ? !bResult : bResult);
+}
+
+static inline uint32_t
+ThumbAddWithCarry(uint32_t ui32A, uint32_t ui32B, uint32_t ui32Carry,
+                  uint8_t *pui8Carry, uint8_t *pui8Overflow)
+{
+    uint64_t ui64Sum = (uint64_t)ui32A + ui32B + ui32Carry;
+    uint32_t ui32Result = (uint32_t)ui64Sum;
+
+    *pui8Carry = (uint8_t)(ui64Sum >> 32);
+    *pui8Overflow = (uint8_t)((~(ui32A ^ ui32B) & (ui32A ^ ui32Result)) >> 31);
+
+    return(ui32Result);
+}
+
+/*
+ * Shift_C() of the architecture.  An ROR by zero stands for RRX.
+ */
+static inline uint32_t
+ThumbShiftC(uint32_t ui32Value, uint32_t ui32Type, uint32_t ui32Amount,
+            uint32_t ui32CarryIn, uint32_t *pui32CarryOut)
+{
+    if(ui32Amount == 0)
+    {
+        if(ui32Type != THUMB_ROR)
+        {
+            *pui32CarryOut = ui32CarryIn;
+            return(ui32Value);
+        }
+
+        *pui32CarryOut = ui32Value & 1;
+        return((ui32Value >> 1) | (ui32CarryIn << 31));
+    }
+
+    switch(ui32Type)
+    {
+        case THUMB_LSL:
+            if(ui32Amount > 32)
+            {
+                *pui32CarryOut = 0;
+                return(0);
+            }
+
+            *pui32CarryOut = (ui32Value >> (32 - ui32Amount)) & 1;
+            return((ui32Amount == 32) ? 0 : ui32Value << ui32Amount);
+
+        case THUMB_LSR:
+            if(ui32Amount > 32)
+            {
+                *pui32CarryOut = 0;
+                return(0);
+            }
+
+            *pui32CarryOut = (ui32Value >> (ui32Amount - 1)) & 1;
+            return((ui32Amount == 32) ? 0 : ui32Value >> ui32Amount);
+
+        case THUMB_ASR:
+            if(ui32Amount >= 32)
+            {
+                *pui32CarryOut = ui32Value >> 31;
+                return((uint32_t)((int32_t)ui32Value >> 31));
+            }
+
+            *pui32CarryOut = (ui32Value >> (ui32Amount - 1)) & 1;
+            return((uint32_t)((int32_t)ui32Value >> ui32Amount));
+
+        default:
+            ui32Amount &= 31;
+            ui32Value = (ui32Value >> ui32Amount) |
+                        (ui32Value << ((32 - ui32Amount) & 31));
+            *pui32CarryOut = ui32Value >> 31;
+            return(ui32Value);
+    }
+}
+
+/*
+ * Brings the board up to date with the processor before it is accessed.
+ */
+static inline void
+ThumbSync(tSimMachine *psMachine)
+{
+    if(psMachine->sCpu.ui64Cycle > psMachine->sBoard.ui64Cycle)
+        SimBoardAdvance(&psMachine->sBoard,
+                        psMachine->sCpu.ui64Cycle -
+                        psMachine->sBoard.ui64Cycle);
+}
+
+/*
+ * Data accesses.  Aligned accesses to flash and SRAM are handled inline,
+ * everything else goes through the slow path, which may fault.
+ */
+static inline uint32_t
+ThumbLoad(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size)
+{
+    uint32_t ui32Value;
+
+    if(__builtin_expect(psMachine->psShadow != NULL, 0))
+        SimShadowLoad(psMachine, ui32Addr, ui32Size);
+
+    if(!(ui32Addr & (ui32Size - 1)) &&
+       SimMemoryRead(&psMachine->sMemory, ui32Addr, ui32Size, &ui32Value))
+        return(ui32Value);
+
+    return(SimCpuLoadSlow(psMachine, ui32Addr, ui32Size));
+}
+
+static inline void
+ThumbStore(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+           uint32_t ui32Value)
+{
+    if(__builtin_expect(psMachine->psShadow != NULL, 0))
+        SimShadowStore(psMachine, ui32Addr, ui32Size);
+
+    if(!(ui32Addr & (ui32Size - 1)) &&
+       SimMemoryWrite(&psMachine->sMemory, ui32Addr, ui32Size, ui32Value))
+        return;
+
+    SimCpuStoreSlow(psMachine, ui32Addr, ui32Size, ui32Value);
+}
+
+/*
+ * Accesses that must be word aligned whatever CCR.UNALIGN_TRP says.
+ */
+static inline void
+ThumbCheckAligned(tSimMachine *psMachine, uint32_t ui32Addr,
+                  uint32_t ui32Size)
+{
+    if(ui32Addr & (ui32Size - 1))
+        SimCpuFault(psMachine, SIM_EXC_USAGEFAULT, SIM_CFSR_UNALIGNED);
+}
+
+/*
+ * Ends the current slice after this instruction, so pending exceptions and
+ * changed deadlines are looked at.
+ */
+static inline void
+ThumbEndSlice(tSimMachine *psMachine)
+{
+    psMachine->sCpu.ui64Limit = 0;
+}
+
+#endif
@@ -0,0 +1,397 @@
+/*
+ * 16/32-bit general purpose timers 0 to 5.
+ */
+#include <string.h>
+
+#include "board.h"
+
+#define TIMER_O_CFG             0x000
+#define TIMER_O_TAMR            0x004
+#define TIMER_O_TBMR            0x008
+#define TIMER_O_CTL             0x00C
+#define TIMER_O_IMR             0x018
+#define TIMER_O_RIS             0x01C
+#define TIMER_O_MIS             0x020
+#define TIMER_O_ICR             0x024
+#define TIMER_O_TAILR           0x028
+#define TIMER_O_TBILR           0x02C
+#define TIMER_O_TAMATCHR        0x030
+#define TIMER_O_TBMATCHR        0x034
+#define TIMER_O_TAPR            0x038
+#define TIMER_O_TBPR            0x03C
+#define TIMER_O_TAR             0x048
+#define TIMER_O_TBR             0x04C
+#define TIMER_O_TAV             0x050
+#define TIMER_O_TBV             0x054
+#define TIMER_O_PP              0xFC0
+
+#define TIMER_CFG_32_BIT        0
+#define TIMER_CFG_16_BIT        4
+
+#define TIMER_MR_ONE_SHOT       1
+#define TIMER_MR_PERIODIC       2
+#define TIMER_MR_MODE_M         3
+#define TIMER_MR_CDIR           0x010
+#define TIMER_MR_ILD            0x100
+
+#define TIMER_CTL_EN            0x001
+
+/*
+ * Register and bit positions of half B are those of half A moved by these
+ * amounts.
+ */
+#define TIMER_HALF_REG          4
+#define TIMER_HALF_BIT          8
+
+#define TIMER_RIS_TOR           0x001
+
+static const uint8_t g_pui8Interrupt[SIM_TIMERS][2] =
+{
+    { SIM_INT_TIMER0A, SIM_INT_TIMER0B },
+    { SIM_INT_TIMER1A, SIM_INT_TIMER1B },
+    { SIM_INT_TIMER2A, SIM_INT_TIMER2B },
+    { SIM_INT_TIMER3A, SIM_INT_TIMER3B },
+    { SIM_INT_TIMER4A, SIM_INT_TIMER4B },
+    { SIM_INT_TIMER5A, SIM_INT_TIMER5B },
+};
+
+static uint32_t
+TimerEvent(uint32_t ui32Timer, uint32_t ui32Half)
+{
+    return(SIM_EVENT_TIMER0A + ui32Timer * 2 + ui32Half);
+}
+
+/*
+ * Returns the largest count of a half: the full 32 bits of half A when the
+ * halves are concatenated, 16 bits otherwise.
+ */
+static uint32_t
+TimerWidth(const tSimTimer *psTimer)
+{
+    return((psTimer->ui32Config == TIMER_CFG_32_BIT) ? 0xFFFFFFFFU : 0xFFFFU);
+}
+
+/*
+ * Returns true if a half is counting in one of the modeled modes.
+ */
+static bool
+TimerRunning(const tSimTimer *psTimer, uint32_t ui32Half)
+{
+    uint32_t ui32Mode = psTimer->psHalf[ui32Half].ui32Mode & TIMER_MR_MODE_M;
+
+    if(!((psTimer->ui32Ctl >> (ui32Half * TIMER_HALF_BIT)) & TIMER_CTL_EN) ||
+       ((ui32Mode != TIMER_MR_ONE_SHOT) && (ui32Mode != TIMER_MR_PERIODIC)))
+        return(false);
+
+    if(psTimer->ui32Config == TIMER_CFG_32_BIT)
+        return(ui32Half == 0);
+
+    return(psTimer->ui32Config == TIMER_CFG_16_BIT);
+}
+
+/*
+ * Returns the period of a counter tick in picoseconds.  The prescaler
+ * divides the system clock of the 16-bit halves only.
+ */
+static uint64_t
+TimerPeriod(const tSimBoard *psBoard, const tSimTimer *psTimer,
+            uint32_t ui32Half)
+{
+    if(psTimer->ui32Config == TIMER_CFG_32_BIT)
+        return(psBoard->ui32CyclePs);
+
+    return((uint64_t)psBoard->ui32CyclePs *
+           (psTimer->psHalf[ui32Half].ui32Prescale + 1));
+}
+
+static void
+TimerUpdateLines(tSimBoard *psBoard, uint32_t ui32Timer)
+{
+    tSimTimer *psTimer = &psBoard->psTimer[ui32Timer];
+    uint32_t ui32Masked = psTimer->ui32RIS & psTimer->ui32IM;
+
+    SimNVICSetLine(&psBoard->sNVIC, g_pui8Interrupt[ui32Timer][0],
+                   (ui32Masked & 0x00FF) != 0);
+    SimNVICSetLine(&psBoard->sNVIC, g_pui8Interrupt[ui32Timer][1],
+                   (ui32Masked & 0xFF00) != 0);
+}
+
+void
+SimTimerReset(tSimBoard *psBoard, uint32_t ui32Timer)
+{
+    tSimTimer *psTimer = &psBoard->psTimer[ui32Timer];
+
+    memset(psTimer, 0, sizeof(*psTimer));
+
+    psTimer->psHalf[0].ui32Load = 0xFFFFFFFFU;
+    psTimer->psHalf[0].ui32Value = 0xFFFFFFFFU;
+    psTimer->psHalf[0].ui32Match = 0xFFFFFFFFU;
+    psTimer->psHalf[1].ui32Load = 0xFFFFU;
+    psTimer->psHalf[1].ui32Value = 0xFFFFU;
+    psTimer->psHalf[1].ui32Match = 0xFFFFU;
+}
+
+/*
+ * Brings the counters up to date with the current time.  The timeouts
+ * themselves are handled by SimTimerEvent(), so at most one reload can lie
+ * between the epoch and now.
+ */
+void
+SimTimerSync(tSimBoard *psBoard, uint32_t ui32Timer)
+{
+    tSimTimer *psTimer = &psBoard->psTimer[ui32Timer];
+    tSimTimerHalf *psHalf;
+    uint64_t ui64Period, ui64Ticks;
+    uint32_t ui32Half;
+
+    for(ui32Half = 0; ui32Half < 2; ui32Half++)
+    {
+        psHalf = &psTimer->psHalf[ui32Half];
+
+        if(!TimerRunning(psTimer, ui32Half) ||
+           (psBoard->ui64Time <= psHalf->ui64Epoch))
+            continue;
+
+        ui64Period = TimerPeriod(psBoard, psTimer, ui32Half);
+        ui64Ticks = (psBoard->ui64Time - psHalf->ui64Epoch) / ui64Period;
+
+        if(!ui64Ticks)
+            continue;
+
+        if(psHalf->ui32Value)
+            psHalf->ui32Value = (ui64Ticks < psHalf->ui32Value) ?
+                                psHalf->ui32Value - (uint32_t)ui64Ticks : 0;
+        else
+            psHalf->ui32Value =
+                (ui64Ticks <= psHalf->ui32Load) ?
+                psHalf->ui32Load + 1 - (uint32_t)ui64Ticks : 0;
+
+        psHalf->ui64Epoch += ui64Ticks * ui64Period;
+    }
+}
+
+/*
+ * Schedules the next timeout of both halves.
+ */
+void
+SimTimerSchedule(tSimBoard *psBoard, uint32_t ui32Timer)
+{
+    tSimTimer *psTimer = &psBoard->psTimer[ui32Timer];
+    tSimTimerHalf *psHalf;
+    uint64_t ui64Ticks;
+    uint32_t ui32Half;
+
+    for(ui32Half = 0; ui32Half < 2; ui32Half++)
+    {
+        psHalf = &psTimer->psHalf[ui32Half];
+
+        if(!TimerRunning(psTimer, ui32Half))
+        {
+            SimEventCancel(&psBoard->sEvents,
+                           TimerEvent(ui32Timer, ui32Half));
+            continue;
+        }
+
+        ui64Ticks = psHalf->ui32Value ? psHalf->ui32Value :
+                    (uint64_t)psHalf->ui32Load + 1;
+
+        SimEventSchedule(&psBoard->sEvents, TimerEvent(ui32Timer, ui32Half),
+                         psHalf->ui64Epoch +
+                         ui64Ticks * TimerPeriod(psBoard, psTimer, ui32Half));
+    }
+}
+
+void
+SimTimerEvent(tSimBoard *psBoard, uint32_t ui32Timer, uint32_t ui32Half,
+              uint64_t ui64Deadline)
+{
+    tSimTimer *psTimer = &psBoard->psTimer[ui32Timer];
+    tSimTimerHalf *psHalf = &psTimer->psHalf[ui32Half];
+
+    SimTimerSync(psBoard, ui32Timer);
+
+    psHalf->ui64Epoch = ui64Deadline;
+    psHalf->ui32Value = 0;
+    psTimer->ui32RIS |= TIMER_RIS_TOR << (ui32Half * TIMER_HALF_BIT);
+
+    /*
+     * A one-shot timer stops at its timeout.
+     */
+    if((psHalf->ui32Mode & TIMER_MR_MODE_M) == TIMER_MR_ONE_SHOT)
+        psTimer->ui32Ctl &= ~(TIMER_CTL_EN << (ui32Half * TIMER_HALF_BIT));
+
+    TimerUpdateLines(psBoard, ui32Timer);
+    SimTimerSchedule(psBoard, ui32Timer);
+}
+
+/*
+ * Returns the count of a half as software sees it.
+ */
+static uint32_t
+TimerCount(const tSimTimerHalf *psHalf)
+{
+    if(psHalf->ui32Mode & TIMER_MR_CDIR)
+        return(psHalf->ui32Load - psHalf->ui32Value);
+
+    return(psHalf->ui32Value);
+}
+
+uint32_t
+SimTimerRead(tSimBoard *psBoard, uint32_t ui32Timer, uint32_t ui32Offset,
+             bool bPeek)
+{
+    tSimTimer *psTimer = &psBoard->psTimer[ui32Timer];
+    uint32_t ui32Half = 0;
+
+    (void)bPeek;
+
+    switch(ui32Offset)
+    {
+        case TIMER_O_CFG:
+            return(psTimer->ui32Config);
+
+        case TIMER_O_TBMR:
+            ui32Half = 1;
+            // Fall through.
+        case TIMER_O_TAMR:
+            return(psTimer->psHalf[ui32Half].ui32Mode);
+
+        case TIMER_O_CTL:
+            return(psTimer->ui32Ctl);
+
+        case TIMER_O_IMR:
+            return(psTimer->ui32IM);
+
+        case TIMER_O_RIS:
+            return(psTimer->ui32RIS);
+
+        case TIMER_O_MIS:
+            return(psTimer->ui32RIS & psTimer->ui32IM);
+
+        case TIMER_O_TBILR:
+            ui32Half = 1;
+            // Fall through.
+        case TIMER_O_TAILR:
+            return(psTimer->psHalf[ui32Half].ui32Load);
+
+        case TIMER_O_TBMATCHR:
+            ui32Half = 1;
+            // Fall through.
+        case TIMER_O_TAMATCHR:
+            return(psTimer->psHalf[ui32Half].ui32Match);
+
+        case TIMER_O_TBPR:
+            ui32Half = 1;
+            // Fall through.
+        case TIMER_O_TAPR:
+            return(psTimer->psHalf[ui32Half].ui32Prescale);
+
+        case TIMER_O_TBR:
+        case TIMER_O_TBV:
+            ui32Half = 1;
+            // Fall through.
+        case TIMER_O_TAR:
+        case TIMER_O_TAV:
+            SimTimerSync(psBoard, ui32Timer);
+            return(TimerCount(&psTimer->psHalf[ui32Half]));
+
+        case TIMER_O_PP:
+            return(0);
+
+        default:
+            return(0);
+    }
+}
+
+void
+SimTimerWrite(tSimBoard *psBoard, uint32_t ui32Timer, uint32_t ui32Offset,
+              uint32_t ui32Value)
+{
+    tSimTimer *psTimer = &psBoard->psTimer[ui32Timer];
+    tSimTimerHalf *psHalf;
+    uint32_t ui32Half, ui32Enable;
+
+    SimTimerSync(psBoard, ui32Timer);
+
+    switch(ui32Offset)
+    {
+        case TIMER_O_CFG:
+            psTimer->ui32Config = ui32Value & 7;
+            break;
+
+        case TIMER_O_TAMR:
+        case TIMER_O_TBMR:
+            ui32Half = (ui32Offset - TIMER_O_TAMR) / TIMER_HALF_REG;
+            psTimer->psHalf[ui32Half].ui32Mode = ui32Value & 0xFFF;
+            break;
+
+        case TIMER_O_CTL:
+            /*
+             * A half starts from its current count on the first clock edge
+             * after it is enabled.
+             */
+            ui32Enable = ui32Value & ~psTimer->ui32Ctl;
+
+            for(ui32Half = 0; ui32Half < 2; ui32Half++)
+                if((ui32Enable >> (ui32Half * TIMER_HALF_BIT)) & TIMER_CTL_EN)
+                    psTimer->psHalf[ui32Half].ui64Epoch = psBoard->ui64Time;
+
+            psTimer->ui32Ctl = ui32Value & 0x7F7F;
+            break;
+
+        case TIMER_O_IMR:
+            psTimer->ui32IM = ui32Value & 0x10F1F;
+            TimerUpdateLines(psBoard, ui32Timer);
+            return;
+
+        case TIMER_O_ICR:
+            psTimer->ui32RIS &= ~ui32Value;
+            TimerUpdateLines(psBoard, ui32Timer);
+            return;
+
+        case TIMER_O_TAILR:
+        case TIMER_O_TBILR:
+            ui32Half = (ui32Offset - TIMER_O_TAILR) / TIMER_HALF_REG;
+            psHalf = &psTimer->psHalf[ui32Half];
+            psHalf->ui32Load = ui32Value & (ui32Half ? 0xFFFFU :
+                                            TimerWidth(psTimer));
+
+            /*
+             * Unless ILD defers it to the next timeout, a new load value
+             * restarts the count.
+             */
+            if(!(psHalf->ui32Mode & TIMER_MR_ILD) ||
+               !TimerRunning(psTimer, ui32Half))
+            {
+                psHalf->ui32Value = psHalf->ui32Load;
+                psHalf->ui64Epoch = psBoard->ui64Time;
+            }
+            break;
+
+        case TIMER_O_TAMATCHR:
+        case TIMER_O_TBMATCHR:
+            ui32Half = (ui32Offset - TIMER_O_TAMATCHR) / TIMER_HALF_REG;
+            psTimer->psHalf[ui32Half].ui32Match = ui32Value;
+            return;
+
+        case TIMER_O_TAPR:
+        case TIMER_O_TBPR:
+            ui32Half = (ui32Offset - TIMER_O_TAPR) / TIMER_HALF_REG;
+            psTimer->psHalf[ui32Half].ui32Prescale = ui32Value & 0xFF;
+            break;
+
+        case TIMER_O_TAV:
+        case TIMER_O_TBV:
+            ui32Half = (ui32Offset - TIMER_O_TAV) / TIMER_HALF_REG;
+            psHalf = &psTimer->psHalf[ui32Half];
+            psHalf->ui32Value = (psHalf->ui32Mode & TIMER_MR_CDIR) ?
+                                psHalf->ui32Load - ui32Value : ui32Value;
+            psHalf->ui64Epoch = psBoard->ui64Time;
+            break;
+
+        default:
+            return;
+    }
+
+    SimTimerSchedule(psBoard, ui32Timer);
+}
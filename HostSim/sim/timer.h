@@ -0,0 +1,50 @@
+#ifndef __SIM_TIMER_H__
+#define __SIM_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+#define SIM_TIMERS              6
+
+/*
+ * One half (A or B) of a general purpose timer.  As with SysTick the counter
+ * is evaluated lazily: while the half runs, ui32Value holds the number of
+ * ticks left until the timeout at ui64Epoch, which lies on a tick edge.
+ */
+typedef struct
+{
+    uint32_t ui32Mode;
+    uint32_t ui32Load;
+    uint32_t ui32Match;
+    uint32_t ui32Prescale;
+    uint32_t ui32Value;
+    uint64_t ui64Epoch;
+} tSimTimerHalf;
+
+/*
+ * One 16/32-bit general purpose timer module.  The periodic and one-shot
+ * modes are modeled, counting down or up, as one 32-bit timer or as two
+ * 16-bit halves with prescalers.
+ */
+typedef struct
+{
+    uint32_t ui32Config;
+    uint32_t ui32Ctl;
+    uint32_t ui32IM;
+    uint32_t ui32RIS;
+    tSimTimerHalf psHalf[2];
+} tSimTimer;
+
+void SimTimerReset(tSimBoard *psBoard, uint32_t ui32Timer);
+uint32_t SimTimerRead(tSimBoard *psBoard, uint32_t ui32Timer,
+                      uint32_t ui32Offset, bool bPeek);
+void SimTimerWrite(tSimBoard *psBoard, uint32_t ui32Timer, uint32_t ui32Offset,
+                   uint32_t ui32Value);
+void SimTimerSync(tSimBoard *psBoard, uint32_t ui32Timer);
+void SimTimerSchedule(tSimBoard *psBoard, uint32_t ui32Timer);
+void SimTimerEvent(tSimBoard *psBoard, uint32_t ui32Timer, uint32_t ui32Half,
+                   uint64_t ui64Deadline);
+
+#endif
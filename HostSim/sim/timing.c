@@ -0,0 +1,268 @@
+/*
+ * Cycle-approximate timing of the Cortex-M4 (see timing.h).
+ *
+ * Instructions are charged as they execute.  Exception entry and return are
+ * charged here, and the latency and handler cycles of every exception, and
+ * the cycles pending exceptions spend blocked, are gathered on the way.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "timing.h"
+
+#define FPCCR_LSPEN             0x40000000U
+
+bool
+SimTimingInit(tSimMachine *psMachine, uint32_t ui32ClockHz)
+{
+    tSimTiming *psTiming = calloc(1, sizeof(tSimTiming));
+
+    if(!psTiming)
+        return(false);
+
+    psTiming->ui32ClockHz = ui32ClockHz;
+    psMachine->psTiming = psTiming;
+
+    return(true);
+}
+
+void
+SimTimingFree(tSimMachine *psMachine)
+{
+    free(psMachine->psTiming);
+    psMachine->psTiming = NULL;
+}
+
+/*
+ * Forgets the state of the pipeline and of the active handlers when the
+ * processor is reset.  The statistics are kept.
+ */
+void
+SimTimingReset(tSimMachine *psMachine)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+
+    if(!psTiming)
+        return;
+
+    psTiming->bPipelined = false;
+    psTiming->ui32Returning = 0;
+    psTiming->bChained = false;
+    psTiming->ui64Switched = psMachine->sCpu.ui64Cycle;
+    memset(psTiming->pui64Entered, 0, sizeof(psTiming->pui64Entered));
+}
+
+/*
+ * Returns the clock the timing is worked out for, in Hz.
+ */
+uint32_t
+SimTimingClock(const tSimMachine *psMachine)
+{
+    if(psMachine->psTiming->ui32ClockHz)
+        return(psMachine->psTiming->ui32ClockHz);
+
+    return(SimBoardClockHz(&psMachine->sBoard));
+}
+
+static void
+TimingRecord(uint64_t ui64Value, uint64_t *pui64Min, uint64_t *pui64Max,
+             uint64_t *pui64Sum, bool bFirst)
+{
+    if(bFirst || (ui64Value < *pui64Min))
+        *pui64Min = ui64Value;
+
+    if(bFirst || (ui64Value > *pui64Max))
+        *pui64Max = ui64Value;
+
+    *pui64Sum += ui64Value;
+}
+
+/*
+ * Returns the exception whose handler the innermost active one preempted, or
+ * zero for thread mode.
+ */
+static uint32_t
+TimingPreempted(const tSimNVIC *psNVIC)
+{
+    return((psNVIC->ui32Depth > 1) ?
+           psNVIC->pui8Stack[psNVIC->ui32Depth - 2] : 0);
+}
+
+/*
+ * Charges the cycles since the last switch of context to the exceptions
+ * that were left pending meanwhile, as blocked by ui32Running.  ui32Entering
+ * is being entered, so is no longer pending, but waited all the same.
+ */
+static void
+TimingBlocked(tSimMachine *psMachine, uint32_t ui32Running,
+              uint32_t ui32Entering)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+    const tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    uint64_t ui64Now = psMachine->sCpu.ui64Cycle, ui64From;
+    uint32_t ui32Word, ui32Ready, ui32Exc;
+
+    for(ui32Word = 0; ui32Word < SIM_NVIC_WORDS; ui32Word++)
+    {
+        ui32Ready = psNVIC->pui32Pending[ui32Word] &
+                    psNVIC->pui32Enable[ui32Word];
+
+        if(ui32Entering / 32 == ui32Word)
+            ui32Ready |= 1U << (ui32Entering % 32);
+
+        while(ui32Ready)
+        {
+            ui32Exc = ui32Word * 32 + __builtin_ctz(ui32Ready);
+            ui32Ready &= ui32Ready - 1;
+
+            ui64From = psNVIC->pui64Pended[ui32Exc];
+
+            if(ui64From < psTiming->ui64Switched)
+                ui64From = psTiming->ui64Switched;
+
+            if(ui32Exc && (ui32Exc != ui32Running) && (ui64Now > ui64From))
+                psTiming->pui64Blocked[ui32Exc][ui32Running] +=
+                    ui64Now - ui64From;
+        }
+    }
+
+    psTiming->ui64Switched = ui64Now;
+}
+
+/*
+ * Records the cycles the handler that returned last took, from its first
+ * instruction to the end of the one returning from it, once the cycles of
+ * that instruction have all been charged.
+ */
+static void
+TimingReturned(tSimMachine *psMachine, uint32_t ui32Entering)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+    uint32_t ui32Exc = psTiming->ui32Returning;
+    tSimTimingStats *psStats = &psTiming->psStats[ui32Exc];
+
+    psTiming->ui32Returning = 0;
+    TimingBlocked(psMachine, ui32Exc, ui32Entering);
+
+    if(!psTiming->pui64Entered[ui32Exc])
+        return;
+
+    TimingRecord(psMachine->sCpu.ui64Cycle - psTiming->pui64Entered[ui32Exc],
+                 &psStats->ui64CyclesMin, &psStats->ui64CyclesMax,
+                 &psStats->ui64CyclesSum, !psStats->ui64Returns);
+
+    psStats->ui64Returns++;
+    psTiming->pui64Entered[ui32Exc] = 0;
+}
+
+/*
+ * Charges a pending exception return that did not tail-chain.  Called
+ * before the processor goes on after looking for exceptions to take.
+ */
+void
+SimTimingResume(tSimMachine *psMachine)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+
+    if(!psTiming->ui32Returning)
+        return;
+
+    TimingReturned(psMachine, 0);
+    psMachine->sCpu.ui64Cycle += SIM_TIMING_RETURN;
+
+    if(psMachine->sCpu.ui32PC < SIM_FLASH_BASE + SIM_FLASH_SIZE)
+        psMachine->sCpu.ui64Cycle += SimTimingWaitStates(psMachine);
+}
+
+/*
+ * Charges the entry into the handler of ui32Exc, which has just been made.
+ * bFP is set if a floating-point frame was stacked.
+ */
+void
+SimTimingEntry(tSimMachine *psMachine, uint32_t ui32Exc, bool bFP)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+
+    psTiming->bChained = (psTiming->ui32Returning != 0);
+
+    if(psTiming->bChained)
+    {
+        TimingReturned(psMachine, ui32Exc);
+        psCpu->ui64Cycle += SIM_TIMING_TAIL_CHAIN;
+    }
+    else
+    {
+        TimingBlocked(psMachine, TimingPreempted(psNVIC), ui32Exc);
+        psCpu->ui64Cycle += SIM_TIMING_ENTRY;
+
+        if(bFP && !(psNVIC->ui32FPCCR & FPCCR_LSPEN))
+            psCpu->ui64Cycle += SIM_TIMING_LAZY_FP;
+    }
+
+    if(psCpu->ui32PC < SIM_FLASH_BASE + SIM_FLASH_SIZE)
+        psCpu->ui64Cycle += SimTimingWaitStates(psMachine);
+
+    psTiming->bPipelined = false;
+}
+
+/*
+ * Records the latency of ui32Exc, whose handler is about to run after the
+ * entry charged by SimTimingEntry().  bLate is set if it arrived late and
+ * took over the entry of another exception.
+ */
+void
+SimTimingEntered(tSimMachine *psMachine, uint32_t ui32Exc, bool bLate)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimNVIC *psNVIC = &psMachine->sBoard.sNVIC;
+    tSimTimingStats *psStats = &psTiming->psStats[ui32Exc];
+    uint32_t ui32Preempted, ui32Bin;
+    uint64_t ui64Latency;
+
+    psTiming->pui64Entered[ui32Exc] = psCpu->ui64Cycle;
+
+    ui64Latency = (psCpu->ui64Cycle > psNVIC->pui64Pended[ui32Exc]) ?
+                  psCpu->ui64Cycle - psNVIC->pui64Pended[ui32Exc] : 0;
+
+    TimingRecord(ui64Latency, &psStats->ui64LatencyMin,
+                 &psStats->ui64LatencyMax, &psStats->ui64LatencySum,
+                 !psStats->ui64Count);
+
+    ui32Bin = ui64Latency ? 64 - __builtin_clzll(ui64Latency) : 0;
+    psStats->pui64Latency[(ui32Bin < SIM_TIMING_HIST_BINS) ?
+                          ui32Bin : SIM_TIMING_HIST_BINS - 1]++;
+
+    psStats->ui64Count++;
+
+    if(psTiming->bChained)
+        psStats->ui64TailChains++;
+
+    if(bLate)
+        psStats->ui64LateArrivals++;
+
+    /*
+     * A tail-chained handler carries on the preemption of the one it
+     * follows.
+     */
+    ui32Preempted = TimingPreempted(psNVIC);
+
+    if(ui32Preempted && !psTiming->bChained)
+    {
+        psStats->ui64Preemptions++;
+        psTiming->psStats[ui32Preempted].ui64Preempted++;
+    }
+}
+
+/*
+ * Notes the return from the handler of ui32Exc, made by the instruction
+ * executing.  It is charged by SimTimingEntry() if it tail-chains and by
+ * SimTimingResume() otherwise.
+ */
+void
+SimTimingReturn(tSimMachine *psMachine, uint32_t ui32Exc)
+{
+    psMachine->psTiming->ui32Returning = ui32Exc;
+}
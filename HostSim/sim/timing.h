@@ -0,0 +1,196 @@
+#ifndef __SIM_TIMING_H__
+#define __SIM_TIMING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpu.h"
+#include "memory.h"
+
+/*
+ * Cycle-approximate timing of the Cortex-M4 and its flash, for predicting
+ * how long interrupt handlers take.  Without it every instruction takes one
+ * cycle.  With it:
+ *
+ * - every instruction takes its issue cycles from the Cortex-M4 technical
+ *   reference manual (tSimInsn.ui8Cycles), with neighbouring single loads
+ *   and stores pipelined and divisions ending early for small quotients;
+ * - a taken branch, or any other write to the PC, costs a pipeline refill
+ *   of one cycle plus the flash wait states if the target is in flash;
+ * - literal loads from flash pay the wait states, while sequential fetches
+ *   are covered by the prefetch buffer;
+ * - exception entry takes 12 cycles, exception return 10 and a return that
+ *   tail-chains into the next handler 6, each plus the wait states of the
+ *   first fetch.  Floating-point context is stacked lazily and costs
+ *   nothing extra unless FPCCR.LSPEN is clear.
+ *
+ * The flash needs one wait state above 40 MHz.  The wait states follow the
+ * clock the firmware sets unless a clock is given to SimTimingInit(); that
+ * clock then also converts cycles to time in the report, so the cycles of
+ * the same firmware can be predicted for other clocks.
+ *
+ * A higher priority exception that becomes pending during the stacking of
+ * another arrives late: it takes over the entry, and the exception that was
+ * being entered stays pending until the late one returns and tail-chains
+ * into it.
+ *
+ * For every exception the latency, from the cycle it became pending to
+ * the first instruction of its handler, and the cycles of the handler up to
+ * its return are recorded.  Handlers interrupted by others are charged the
+ * cycles of the nested ones.  The latencies are also counted in a histogram
+ * of powers of two, bin n holding those below 2^n cycles, and the entries
+ * are told apart into those that preempted another handler, tail-chained or
+ * arrived late.
+ *
+ * pui64Blocked[w][r] sums the cycles exception w spent pending while
+ * exception r ran, its stacking and return included, or, for r zero, while
+ * thread mode finished an instruction or ran with w masked.  It shows which
+ * handlers hold up which under a given priority scheme.
+ */
+#define SIM_TIMING_FLASH_HZ     40000000U
+#define SIM_TIMING_ENTRY        12
+#define SIM_TIMING_RETURN       10
+#define SIM_TIMING_TAIL_CHAIN   6
+#define SIM_TIMING_LAZY_FP      17
+#define SIM_TIMING_HIST_BINS    24
+
+/*
+ * Most cycles any one instruction can be charged, for code that needs to
+ * bound the cycles of a run of instructions.
+ */
+#define SIM_TIMING_MAX_CYCLES   32
+
+typedef struct
+{
+    uint64_t ui64Count;
+    uint64_t ui64Returns;
+    uint64_t ui64LatencyMin;
+    uint64_t ui64LatencyMax;
+    uint64_t ui64LatencySum;
+    uint64_t ui64CyclesMin;
+    uint64_t ui64CyclesMax;
+    uint64_t ui64CyclesSum;
+    uint64_t ui64Preemptions;
+    uint64_t ui64TailChains;
+    uint64_t ui64LateArrivals;
+    uint64_t ui64Preempted;
+    uint64_t pui64Latency[SIM_TIMING_HIST_BINS];
+} tSimTimingStats;
+
+struct tSimTiming
+{
+    /*
+     * Clock fixed by SimTimingInit() or zero, and the clock period the wait
+     * states were last worked out for.
+     */
+    uint32_t ui32ClockHz;
+    uint32_t ui32CyclePs;
+    uint32_t ui32WaitStates;
+
+    /*
+     * Set while the previous instruction was a single load or store, which
+     * the next one can pipeline with.
+     */
+    bool bPipelined;
+
+    /*
+     * Exception whose return has not been charged yet, or zero.  The return
+     * is charged once it is known whether it tail-chains.
+     */
+    uint32_t ui32Returning;
+
+    /*
+     * Cycle at which the handler of each active exception was entered.
+     */
+    uint64_t pui64Entered[SIM_NVIC_EXCEPTIONS];
+
+    /*
+     * Set by SimTimingEntry() if the entry tail-chained.
+     */
+    bool bChained;
+
+    /*
+     * Cycle up to which the pending exceptions have been charged to
+     * pui64Blocked.
+     */
+    uint64_t ui64Switched;
+
+    tSimTimingStats psStats[SIM_NVIC_EXCEPTIONS];
+    uint64_t pui64Blocked[SIM_NVIC_EXCEPTIONS][SIM_NVIC_EXCEPTIONS];
+};
+
+bool SimTimingInit(tSimMachine *psMachine, uint32_t ui32ClockHz);
+void SimTimingFree(tSimMachine *psMachine);
+void SimTimingReset(tSimMachine *psMachine);
+void SimTimingEntry(tSimMachine *psMachine, uint32_t ui32Exc, bool bFP);
+void SimTimingEntered(tSimMachine *psMachine, uint32_t ui32Exc, bool bLate);
+void SimTimingReturn(tSimMachine *psMachine, uint32_t ui32Exc);
+void SimTimingResume(tSimMachine *psMachine);
+uint32_t SimTimingClock(const tSimMachine *psMachine);
+
+/*
+ * Returns the flash wait states at the current clock.
+ */
+static inline uint32_t
+SimTimingWaitStates(tSimMachine *psMachine)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+
+    if(psTiming->ui32CyclePs != psMachine->sBoard.ui32CyclePs)
+    {
+        psTiming->ui32CyclePs = psMachine->sBoard.ui32CyclePs;
+        psTiming->ui32WaitStates = (SimTimingClock(psMachine) - 1) /
+                                   SIM_TIMING_FLASH_HZ;
+    }
+
+    return(psTiming->ui32WaitStates);
+}
+
+/*
+ * Charges the cycles of an instruction beyond the one CpuExecute() counts,
+ * once it has executed.  ui32Next is the address of the instruction after
+ * it.
+ */
+static inline void
+SimTimingInsn(tSimMachine *psMachine, const tSimInsn *psInsn,
+              uint32_t ui32Next)
+{
+    tSimTiming *psTiming = psMachine->psTiming;
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Cycles = psInsn->ui8Cycles & SIM_CPU_CYCLES_MASK, ui32Bits;
+    bool bPipelined = (psInsn->ui8Cycles & SIM_CPU_CYCLES_PIPE) != 0;
+
+    if(bPipelined && psTiming->bPipelined)
+        ui32Cycles--;
+
+    psTiming->bPipelined = bPipelined;
+
+    if(psInsn->ui8Cycles & SIM_CPU_CYCLES_FLASH)
+        ui32Cycles += SimTimingWaitStates(psMachine);
+
+    /*
+     * The divider retires a few quotient bits per cycle and stops once the
+     * rest are zero.
+     */
+    if(psInsn->ui8Cycles & SIM_CPU_CYCLES_DIVIDE)
+    {
+        ui32Bits = psCpu->pui32R[psInsn->ui8Rd];
+        ui32Bits = ui32Bits ? 32 - __builtin_clz(ui32Bits) : 0;
+        ui32Cycles += (ui32Bits * 5) / 16;
+    }
+
+    if((psCpu->ui32PC != ui32Next) && !psTiming->ui32Returning)
+    {
+        ui32Cycles++;
+
+        if(psCpu->ui32PC < SIM_FLASH_BASE + SIM_FLASH_SIZE)
+            ui32Cycles += SimTimingWaitStates(psMachine);
+
+        psTiming->bPipelined = false;
+    }
+
+    if(ui32Cycles > 1)
+        psCpu->ui64Cycle += ui32Cycles - 1;
+}
+
+#endif
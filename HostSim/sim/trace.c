@@ -0,0 +1,426 @@
+/*
+ * Trace of the register accesses of the processor (see trace.h).
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+#define TRACE_HEADER_SIZE       8
+#define TRACE_INDEX_BLOCKS      1024
+
+/*
+ * Writes out a buffer, retrying short writes.
+ */
+static void
+TraceWrite(tSimTrace *psTrace, const void *pvData, size_t szLeft)
+{
+    const uint8_t *pui8Data = pvData;
+    ssize_t sszWritten;
+
+    while(szLeft)
+    {
+        sszWritten = write(psTrace->i32Fd, pui8Data, szLeft);
+
+        if(sszWritten < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            psTrace->bWriteError = true;
+            break;
+        }
+
+        pui8Data += sszWritten;
+        szLeft -= (size_t)sszWritten;
+    }
+}
+
+static void
+TraceFlush(tSimTrace *psTrace)
+{
+    TraceWrite(psTrace, psTrace->pui8Buffer, psTrace->ui32Buffered);
+    psTrace->ui64Written += psTrace->ui32Buffered;
+    psTrace->ui32Buffered = 0;
+}
+
+static inline uint8_t *
+TracePutVarint(uint8_t *pui8Data, uint64_t ui64Value)
+{
+    while(ui64Value >= 0x80)
+    {
+        *pui8Data++ = (uint8_t)ui64Value | 0x80;
+        ui64Value >>= 7;
+    }
+
+    *pui8Data++ = (uint8_t)ui64Value;
+
+    return(pui8Data);
+}
+
+/*
+ * Signed differences of addresses, with the sign in the lowest bit so small
+ * steps either way take a byte.
+ */
+static inline uint32_t
+TraceZigZag(uint32_t ui32Value, uint32_t ui32Before)
+{
+    int32_t i32Diff = (int32_t)(ui32Value - ui32Before);
+
+    return(((uint32_t)i32Diff << 1) ^ (uint32_t)(i32Diff >> 31));
+}
+
+static inline uint32_t
+TraceUnZigZag(uint32_t ui32Value, uint32_t ui32Before)
+{
+    return(ui32Before + ((ui32Value >> 1) ^ (0U - (ui32Value & 1))));
+}
+
+/*
+ * Starts tracing the register accesses of a machine to a file.  Returns
+ * false if the file cannot be created.
+ */
+bool
+SimTraceInit(tSimMachine *psMachine, const char *pcPath)
+{
+    tSimTrace *psTrace = calloc(1, sizeof(tSimTrace));
+
+    psMachine->psTrace = psTrace;
+
+    if(!psTrace)
+        return(false);
+
+    psTrace->pui8Buffer = malloc(SIM_TRACE_BUFFER);
+    psTrace->psIndex = malloc(TRACE_INDEX_BLOCKS * sizeof(tSimTraceIndex));
+    psTrace->ui64IndexSpace = TRACE_INDEX_BLOCKS;
+    psTrace->i32Fd = open(pcPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if(!psTrace->pui8Buffer || !psTrace->psIndex || (psTrace->i32Fd < 0) ||
+       (write(psTrace->i32Fd, SIM_TRACE_MAGIC, TRACE_HEADER_SIZE) !=
+        TRACE_HEADER_SIZE))
+    {
+        SimTraceClose(psMachine);
+        return(false);
+    }
+
+    return(true);
+}
+
+/*
+ * Writes out the rest of the records and the index and stops tracing.
+ * Returns false if the trace could not be written completely.
+ */
+bool
+SimTraceClose(tSimMachine *psMachine)
+{
+    tSimTrace *psTrace = psMachine->psTrace;
+    static const uint8_t pui8Pad[8];
+    tSimTraceFooter sFooter;
+    bool bOK;
+
+    if(!psTrace)
+        return(true);
+
+    if(psTrace->i32Fd >= 0)
+    {
+        TraceFlush(psTrace);
+
+        /*
+         * The index is aligned for the reader to use it where it is mapped.
+         */
+        TraceWrite(psTrace, pui8Pad, -psTrace->ui64Written & 7);
+        psTrace->ui64Written += -psTrace->ui64Written & 7;
+
+        memset(&sFooter, 0, sizeof(sFooter));
+        sFooter.ui64Index = TRACE_HEADER_SIZE + psTrace->ui64Written;
+        sFooter.ui64Blocks = psTrace->ui64Blocks;
+        sFooter.ui64Records = psTrace->ui64Records;
+        memcpy(sFooter.pcMagic, SIM_TRACE_FOOTER_MAGIC,
+               sizeof(sFooter.pcMagic));
+
+        TraceWrite(psTrace, psTrace->psIndex,
+                   psTrace->ui64Blocks * sizeof(tSimTraceIndex));
+        TraceWrite(psTrace, &sFooter, sizeof(sFooter));
+
+        if(close(psTrace->i32Fd))
+            psTrace->bWriteError = true;
+    }
+    else
+        psTrace->bWriteError = true;
+
+    bOK = !psTrace->bWriteError;
+
+    free(psTrace->pui8Buffer);
+    free(psTrace->psIndex);
+    free(psTrace);
+    psMachine->psTrace = NULL;
+
+    return(bOK);
+}
+
+/*
+ * Called for every register access of the processor.
+ */
+void
+SimTraceAccess(tSimMachine *psMachine, uint32_t ui32Addr, uint32_t ui32Size,
+               uint32_t ui32Value, bool bWrite)
+{
+    tSimTrace *psTrace = psMachine->psTrace;
+    tSimTraceState *psState = &psTrace->sState;
+    uint64_t ui64Cycle = psMachine->sCpu.ui64Cycle;
+    uint32_t ui32PC = psMachine->sCpu.ui32InsnPC;
+    tSimTraceIndex *psIndex;
+    uint8_t *pui8Data;
+
+    if(psTrace->ui32Buffered > SIM_TRACE_BUFFER - SIM_TRACE_RECORD_MAX)
+        TraceFlush(psTrace);
+
+    /*
+     * A block starts over from zero.  Should the index not grow, the
+     * block is only found by reading the one before.
+     */
+    if(!(psTrace->ui64Records % SIM_TRACE_BLOCK))
+    {
+        memset(psState, 0, sizeof(*psState));
+
+        if(psTrace->ui64Blocks == psTrace->ui64IndexSpace)
+        {
+            psIndex = realloc(psTrace->psIndex, 2 * psTrace->ui64IndexSpace *
+                                                sizeof(tSimTraceIndex));
+
+            if(psIndex)
+            {
+                psTrace->psIndex = psIndex;
+                psTrace->ui64IndexSpace *= 2;
+            }
+        }
+
+        if(psTrace->ui64Blocks < psTrace->ui64IndexSpace)
+        {
+            psIndex = &psTrace->psIndex[psTrace->ui64Blocks++];
+            psIndex->ui64Offset = psTrace->ui64Written +
+                                  psTrace->ui32Buffered;
+            psIndex->ui64Cycle = ui64Cycle;
+            psIndex->ui64Record = psTrace->ui64Records;
+        }
+    }
+
+    pui8Data = psTrace->pui8Buffer + psTrace->ui32Buffered;
+    *pui8Data++ = (uint8_t)ui32Size | (bWrite ? SIM_TRACE_WRITE : 0);
+    pui8Data = TracePutVarint(pui8Data, ui64Cycle - psState->ui64Cycle);
+    pui8Data = TracePutVarint(pui8Data, TraceZigZag(ui32PC, psState->ui32PC));
+    pui8Data = TracePutVarint(pui8Data,
+                              TraceZigZag(ui32Addr, psState->ui32Addr));
+    pui8Data = TracePutVarint(pui8Data, ui32Value);
+
+    psTrace->ui32Buffered = (uint32_t)(pui8Data - psTrace->pui8Buffer);
+    psTrace->ui64Records++;
+
+    psState->ui64Cycle = ui64Cycle;
+    psState->ui32PC = ui32PC;
+    psState->ui32Addr = ui32Addr;
+}
+
+/*
+ * Opens a trace for reading.  Returns false if the file cannot be read or is
+ * not a trace.
+ */
+bool
+SimTraceOpen(tSimTraceReader *psReader, const char *pcPath)
+{
+    const tSimTraceFooter *psFooter;
+    struct stat sStat;
+    uint8_t *pui8Map;
+    size_t szSize;
+    int i32Fd;
+
+    memset(psReader, 0, sizeof(*psReader));
+
+    i32Fd = open(pcPath, O_RDONLY);
+
+    if(i32Fd < 0)
+        return(false);
+
+    if(fstat(i32Fd, &sStat) || (sStat.st_size < TRACE_HEADER_SIZE))
+    {
+        close(i32Fd);
+        return(false);
+    }
+
+    szSize = (size_t)sStat.st_size;
+    pui8Map = mmap(NULL, szSize, PROT_READ, MAP_PRIVATE, i32Fd, 0);
+    close(i32Fd);
+
+    if(pui8Map == MAP_FAILED)
+        return(false);
+
+    if(memcmp(pui8Map, SIM_TRACE_MAGIC, TRACE_HEADER_SIZE))
+    {
+        munmap(pui8Map, szSize);
+        return(false);
+    }
+
+    psReader->pui8Map = pui8Map;
+    psReader->szMap = szSize;
+    psReader->pui8Records = pui8Map + TRACE_HEADER_SIZE;
+    psReader->szRecords = szSize - TRACE_HEADER_SIZE;
+    psReader->ui64Records = UINT64_MAX;
+
+    /*
+     * A trace with a footer that makes sense has an index; one without is
+     * read to the end of the file.
+     */
+    if(szSize < TRACE_HEADER_SIZE + sizeof(tSimTraceFooter))
+        return(true);
+
+    psFooter = (const tSimTraceFooter *)(pui8Map + szSize -
+                                         sizeof(tSimTraceFooter));
+
+    if(memcmp(psFooter->pcMagic, SIM_TRACE_FOOTER_MAGIC,
+              sizeof(psFooter->pcMagic)) ||
+       (psFooter->ui64Index < TRACE_HEADER_SIZE) ||
+       (psFooter->ui64Blocks > szSize / sizeof(tSimTraceIndex)) ||
+       (psFooter->ui64Index + psFooter->ui64Blocks * sizeof(tSimTraceIndex) +
+        sizeof(tSimTraceFooter) != szSize))
+        return(true);
+
+    psReader->szRecords = psFooter->ui64Index - TRACE_HEADER_SIZE;
+    psReader->psIndex = (const tSimTraceIndex *)(pui8Map +
+                                                 psFooter->ui64Index);
+    psReader->ui64Blocks = psFooter->ui64Blocks;
+    psReader->ui64Records = psFooter->ui64Records;
+
+    return(true);
+}
+
+void
+SimTraceReaderClose(tSimTraceReader *psReader)
+{
+    if(psReader->pui8Map)
+        munmap((void *)psReader->pui8Map, psReader->szMap);
+
+    memset(psReader, 0, sizeof(*psReader));
+}
+
+static bool
+TraceGetVarint(tSimTraceReader *psReader, uint64_t *pui64Value)
+{
+    uint64_t ui64Value = 0;
+    uint32_t ui32Shift;
+    uint8_t ui8Byte;
+
+    for(ui32Shift = 0; ui32Shift < 64; ui32Shift += 7)
+    {
+        if(psReader->szPos == psReader->szRecords)
+            return(false);
+
+        ui8Byte = psReader->pui8Records[psReader->szPos++];
+        ui64Value |= (uint64_t)(ui8Byte & 0x7F) << ui32Shift;
+
+        if(!(ui8Byte & 0x80))
+        {
+            *pui64Value = ui64Value;
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+/*
+ * Decodes the next record.  Returns false at the end of the trace, or of
+ * what was written of it.
+ */
+bool
+SimTraceNext(tSimTraceReader *psReader, tSimTraceRecord *psRecord)
+{
+    tSimTraceState *psState = &psReader->sState;
+    uint64_t ui64Cycle, ui64PC, ui64Addr, ui64Value;
+    uint8_t ui8Flags;
+
+    if((psReader->szPos == psReader->szRecords) ||
+       (psReader->ui64Record == psReader->ui64Records))
+        return(false);
+
+    if(!(psReader->ui64Record % SIM_TRACE_BLOCK))
+        memset(psState, 0, sizeof(*psState));
+
+    ui8Flags = psReader->pui8Records[psReader->szPos++];
+
+    if(!TraceGetVarint(psReader, &ui64Cycle) ||
+       !TraceGetVarint(psReader, &ui64PC) ||
+       !TraceGetVarint(psReader, &ui64Addr) ||
+       !TraceGetVarint(psReader, &ui64Value))
+    {
+        psReader->szPos = psReader->szRecords;
+        return(false);
+    }
+
+    psState->ui64Cycle += ui64Cycle;
+    psState->ui32PC = TraceUnZigZag((uint32_t)ui64PC, psState->ui32PC);
+    psState->ui32Addr = TraceUnZigZag((uint32_t)ui64Addr, psState->ui32Addr);
+    psReader->ui64Record++;
+
+    psRecord->ui64Cycle = psState->ui64Cycle;
+    psRecord->ui32PC = psState->ui32PC;
+    psRecord->ui32Addr = psState->ui32Addr;
+    psRecord->ui32Value = (uint32_t)ui64Value;
+    psRecord->ui8Size = ui8Flags & SIM_TRACE_SIZE_MASK;
+    psRecord->bWrite = (ui8Flags & SIM_TRACE_WRITE) != 0;
+
+    return(true);
+}
+
+/*
+ * Moves to the first record at or after a cycle: the block it is in is
+ * looked up in the index, and decoded up to it.
+ */
+void
+SimTraceSeek(tSimTraceReader *psReader, uint64_t ui64Cycle)
+{
+    const tSimTraceIndex *psIndex = NULL;
+    uint64_t ui64Low = 0, ui64High = psReader->ui64Blocks, ui64Mid;
+    tSimTraceRecord sRecord;
+    tSimTraceState sState;
+    uint64_t ui64Record;
+    size_t szPos;
+
+    while(ui64Low < ui64High)
+    {
+        ui64Mid = ui64Low + (ui64High - ui64Low) / 2;
+
+        if(psReader->psIndex[ui64Mid].ui64Cycle <= ui64Cycle)
+        {
+            psIndex = &psReader->psIndex[ui64Mid];
+            ui64Low = ui64Mid + 1;
+        }
+        else
+            ui64High = ui64Mid;
+    }
+
+    psReader->szPos = (psIndex && (psIndex->ui64Offset < psReader->szRecords)) ?
+                      (size_t)psIndex->ui64Offset : 0;
+    psReader->ui64Record = psReader->szPos ? psIndex->ui64Record : 0;
+    memset(&psReader->sState, 0, sizeof(psReader->sState));
+
+    for(;;)
+    {
+        szPos = psReader->szPos;
+        ui64Record = psReader->ui64Record;
+        sState = psReader->sState;
+
+        if(!SimTraceNext(psReader, &sRecord) ||
+           (sRecord.ui64Cycle >= ui64Cycle))
+        {
+            psReader->szPos = szPos;
+            psReader->ui64Record = ui64Record;
+            psReader->sState = sState;
+            return;
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#ifndef __SIM_TRACE_H__
+#define __SIM_TRACE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpu.h"
+
+/*
+ * Trace of the register accesses of a firmware on the instruction set
+ * simulator: every load and store of the processor to the peripherals
+ * (0x40000000 to 0x400FFFFF and their bit-band alias) and to the System
+ * Control Space, with the cycle, the address of the instruction, the
+ * address, the value and the width.  Accesses of a debugger are not traced.
+ *
+ * Records are packed into a byte stream: a byte holding the width and the
+ * direction, then the cycle as the unsigned difference to the record
+ * before, the instruction and register addresses as signed differences and
+ * the value itself, all as LEB128 varints (seven bits a byte, the top bit
+ * set on all bytes but the last).  A register access mostly takes six to
+ * ten bytes.  Every SIM_TRACE_BLOCK records the differences start over from
+ * zero, and the offset and first cycle of every such block are kept in an
+ * index written after the records when the trace is closed, so a reader
+ * finds any cycle with a binary search and decodes at most a block to get
+ * there.  A trace cut short, by a crash say, has no index and is read from
+ * the start.
+ *
+ * The stream is written with write() from a buffer, after an eight byte
+ * header.  The index entries, aligned to eight bytes, and the footer that
+ * locates them are in the byte order of the host.
+ */
+#define SIM_TRACE_MAGIC         "TM4CTRC1"
+#define SIM_TRACE_FOOTER_MAGIC  "TM4CTRCX"
+#define SIM_TRACE_BLOCK         4096
+#define SIM_TRACE_BUFFER        65536
+
+/*
+ * Largest encoding of a record: the byte of flags and four varints, the
+ * cycle taking up to ten bytes and the others up to five.
+ */
+#define SIM_TRACE_RECORD_MAX    26
+
+/*
+ * Flags of a record.
+ */
+#define SIM_TRACE_SIZE_MASK     0x07
+#define SIM_TRACE_WRITE         0x08
+
+typedef struct
+{
+    uint64_t ui64Cycle;
+    uint32_t ui32PC;
+    uint32_t ui32Addr;
+    uint32_t ui32Value;
+    uint8_t ui8Size;
+    bool bWrite;
+} tSimTraceRecord;
+
+typedef struct
+{
+    uint64_t ui64Offset;
+    uint64_t ui64Cycle;
+    uint64_t ui64Record;
+} tSimTraceIndex;
+
+typedef struct
+{
+    uint64_t ui64Index;
+    uint64_t ui64Blocks;
+    uint64_t ui64Records;
+    char pcMagic[8];
+} tSimTraceFooter;
+
+/*
+ * What the differences of the next record are taken from.
+ */
+typedef struct
+{
+    uint64_t ui64Cycle;
+    uint32_t ui32PC;
+    uint32_t ui32Addr;
+} tSimTraceState;
+
+struct tSimTrace
+{
+    int i32Fd;
+    bool bWriteError;
+
+    uint8_t *pui8Buffer;
+    uint32_t ui32Buffered;
+
+    /*
+     * Bytes written out before the buffer.
+     */
+    uint64_t ui64Written;
+
+    tSimTraceState sState;
+    uint64_t ui64Records;
+
+    tSimTraceIndex *psIndex;
+    uint64_t ui64Blocks;
+    uint64_t ui64IndexSpace;
+};
+
+/*
+ * A trace being read, mapped into memory.
+ */
+typedef struct
+{
+    const uint8_t *pui8Map;
+    size_t szMap;
+
+    /*
+     * The records, the index if the trace has one and where the next
+     * record is decoded.  Records end at the index, after ui64Records of
+     * them, or at the end of a trace without one.
+     */
+    const uint8_t *pui8Records;
+    size_t szRecords;
+    uint64_t ui64Records;
+    const tSimTraceIndex *psIndex;
+    uint64_t ui64Blocks;
+    size_t szPos;
+    uint64_t ui64Record;
+    tSimTraceState sState;
+} tSimTraceReader;
+
+bool SimTraceInit(tSimMachine *psMachine, const char *pcPath);
+bool SimTraceClose(tSimMachine *psMachine);
+void SimTraceAccess(tSimMachine *psMachine, uint32_t ui32Addr,
+                    uint32_t ui32Size, uint32_t ui32Value, bool bWrite);
+
+bool SimTraceOpen(tSimTraceReader *psReader, const char *pcPath);
+void SimTraceReaderClose(tSimTraceReader *psReader);
+bool SimTraceNext(tSimTraceReader *psReader, tSimTraceRecord *psRecord);
+void SimTraceSeek(tSimTraceReader *psReader, uint64_t ui64Cycle);
+
+/*
+ * Called by the slow paths of the processor's accesses.
+ */
+static inline bool
+SimTraced(uint32_t ui32Addr)
+{
+    return(((ui32Addr >= 0x40000000U) && (ui32Addr < 0x40100000U)) ||
+           ((ui32Addr >= 0x42000000U) && (ui32Addr < 0x44000000U)) ||
+           ((ui32Addr >= 0xE000E000U) && (ui32Addr < 0xE000F000U)));
+}
+
+#endif
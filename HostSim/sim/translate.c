@@ -0,0 +1,970 @@
+/*
+ * Translation of Thumb-2 basic blocks to x86-64 host code.
+ *
+ * Translated code keeps rbx pointing at the tSimCpu and r12 at the
+ * tSimMachine; eax and ecx hold intermediate values.  The simulated
+ * registers and flags stay in memory, so execution functions, faults and
+ * the interpreter see the same state whichever of them runs an instruction.
+ */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "idle.h"
+#include "thumb.h"
+#include "translate.h"
+
+/*
+ * Host registers, ALU operations and condition codes.
+ */
+#define X86_EAX                 0
+#define X86_ECX                 1
+#define X86_EDX                 2
+
+#define X86_ADD                 0
+#define X86_OR                  1
+#define X86_ADC                 2
+#define X86_SBB                 3
+#define X86_AND                 4
+#define X86_SUB                 5
+#define X86_XOR                 6
+#define X86_CMP                 7
+
+#define X86_CC_O                0x0
+#define X86_CC_C                0x2
+#define X86_CC_NC               0x3
+#define X86_CC_Z                0x4
+#define X86_CC_NZ               0x5
+#define X86_CC_S                0x8
+#define X86_JMP                 0x10
+
+/*
+ * Offsets of the processor state from rbx.
+ */
+#define CPU_REG(n)              (offsetof(tSimCpu, pui32R) + 4 * (n))
+#define CPU_FIELD(field)        offsetof(tSimCpu, field)
+
+/*
+ * Offsets of the memory page tables and arena from r12.
+ */
+#define MEM_FIELD(field)        (offsetof(tSimMachine, sMemory) +             \
+                                 offsetof(tSimMemory, field))
+
+/*
+ * Host code space needed by an instruction and by the block entry and exit,
+ * at most.
+ */
+#define TRANSLATE_INSN_BYTES    256
+#define TRANSLATE_BLOCK_BYTES   64
+
+typedef struct
+{
+    uint8_t *pui8Pos;
+
+    /*
+     * Displacements of the jumps to the block exit.
+     */
+    uint8_t *ppui8Exit[2 * SIM_TRANSLATE_BLOCK_INSNS];
+    uint32_t ui32Exits;
+} tEmitter;
+
+static void
+Emit8(tEmitter *psEmit, uint32_t ui32Byte)
+{
+    *psEmit->pui8Pos++ = (uint8_t)ui32Byte;
+}
+
+static void
+Emit32(tEmitter *psEmit, uint32_t ui32Value)
+{
+    memcpy(psEmit->pui8Pos, &ui32Value, 4);
+    psEmit->pui8Pos += 4;
+}
+
+static void
+Emit64(tEmitter *psEmit, uint64_t ui64Value)
+{
+    memcpy(psEmit->pui8Pos, &ui64Value, 8);
+    psEmit->pui8Pos += 8;
+}
+
+/*
+ * ModRM addressing [rbx + disp32], with ui32Reg in the reg field.
+ */
+static void
+EmitCpu(tEmitter *psEmit, uint32_t ui32Reg, uint32_t ui32Disp)
+{
+    Emit8(psEmit, 0x83 | (ui32Reg << 3));
+    Emit32(psEmit, ui32Disp);
+}
+
+/*
+ * mov r32, [rbx + disp]
+ */
+static void
+EmitLoad(tEmitter *psEmit, uint32_t ui32Reg, uint32_t ui32Disp)
+{
+    Emit8(psEmit, 0x8B);
+    EmitCpu(psEmit, ui32Reg, ui32Disp);
+}
+
+/*
+ * mov [rbx + disp], eax
+ */
+static void
+EmitStore(tEmitter *psEmit, uint32_t ui32Disp)
+{
+    Emit8(psEmit, 0x89);
+    EmitCpu(psEmit, X86_EAX, ui32Disp);
+}
+
+/*
+ * mov dword [rbx + disp], imm32
+ */
+static void
+EmitStoreImm(tEmitter *psEmit, uint32_t ui32Disp, uint32_t ui32Value)
+{
+    Emit8(psEmit, 0xC7);
+    EmitCpu(psEmit, 0, ui32Disp);
+    Emit32(psEmit, ui32Value);
+}
+
+/*
+ * setcc byte [rbx + disp]
+ */
+static void
+EmitSet(tEmitter *psEmit, uint32_t ui32CC, uint32_t ui32Disp)
+{
+    Emit8(psEmit, 0x0F);
+    Emit8(psEmit, 0x90 | ui32CC);
+    EmitCpu(psEmit, 0, ui32Disp);
+}
+
+/*
+ * jcc (or jmp if ui32CC is X86_JMP) to a place not emitted yet.  Returns
+ * the displacement for EmitPatch().
+ */
+static uint8_t *
+EmitJump(tEmitter *psEmit, uint32_t ui32CC)
+{
+    uint8_t *pui8Disp;
+
+    if(ui32CC == X86_JMP)
+        Emit8(psEmit, 0xE9);
+    else
+    {
+        Emit8(psEmit, 0x0F);
+        Emit8(psEmit, 0x80 | ui32CC);
+    }
+
+    pui8Disp = psEmit->pui8Pos;
+    Emit32(psEmit, 0);
+
+    return(pui8Disp);
+}
+
+/*
+ * Points a jump emitted by EmitJump() or EmitExit() at the current position.
+ */
+static void
+EmitPatch(tEmitter *psEmit, uint8_t *pui8Disp)
+{
+    int32_t i32Rel = (int32_t)(psEmit->pui8Pos - pui8Disp - 4);
+
+    memcpy(pui8Disp, &i32Rel, 4);
+}
+
+/*
+ * jcc to the block exit, patched once the exit is emitted.
+ */
+static void
+EmitExit(tEmitter *psEmit, uint32_t ui32CC)
+{
+    psEmit->ppui8Exit[psEmit->ui32Exits++] = EmitJump(psEmit, ui32CC);
+}
+
+/*
+ * Accounts for instructions run since the last call, or takes back an
+ * account when ui32Insns is negated (the immediate is sign extended).
+ */
+static void
+EmitCount(tEmitter *psEmit, uint32_t ui32Insns)
+{
+    if(!ui32Insns)
+        return;
+
+    /*
+     * add qword [rbx + disp], imm32
+     */
+    Emit8(psEmit, 0x48);
+    Emit8(psEmit, 0x81);
+    EmitCpu(psEmit, 0, CPU_FIELD(ui64Cycle));
+    Emit32(psEmit, ui32Insns);
+    Emit8(psEmit, 0x48);
+    Emit8(psEmit, 0x81);
+    EmitCpu(psEmit, 0, CPU_FIELD(ui64Insns));
+    Emit32(psEmit, ui32Insns);
+}
+
+/*
+ * Translates the data-processing instructions that take an immediate or an
+ * unshifted register operand and do not involve the PC.  Returns false if
+ * the instruction has to call its execution function instead.
+ */
+static bool
+TranslateDataProc(tEmitter *psEmit, const tSimInsn *psInsn)
+{
+    uint32_t ui32Op, ui32Kind, ui32Alu, ui32Imm = psInsn->ui32Imm;
+    bool bArith = false, bWrite = true, bInvert = false, bMove = false;
+    bool bReverse = false;
+
+    if(!SimThumbDataProc(psInsn, &ui32Op, &ui32Kind) || (ui32Kind > DP_REG) ||
+       (psInsn->ui8Rn == 15) ||
+       ((ui32Kind == DP_REG) && (psInsn->ui8Rm == 15)))
+        return(false);
+
+    switch(ui32Op)
+    {
+        case DP_AND:
+            ui32Alu = X86_AND;
+            break;
+
+        case DP_BIC:
+            ui32Alu = X86_AND;
+            bInvert = true;
+            break;
+
+        case DP_ORR:
+            ui32Alu = X86_OR;
+            break;
+
+        case DP_ORN:
+            ui32Alu = X86_OR;
+            bInvert = true;
+            break;
+
+        case DP_EOR:
+            ui32Alu = X86_XOR;
+            break;
+
+        case DP_TST:
+            ui32Alu = X86_AND;
+            bWrite = false;
+            break;
+
+        case DP_TEQ:
+            ui32Alu = X86_XOR;
+            bWrite = false;
+            break;
+
+        case DP_MOV:
+            ui32Alu = X86_OR;
+            bMove = true;
+            break;
+
+        case DP_MVN:
+            ui32Alu = X86_OR;
+            bMove = true;
+            bInvert = true;
+            break;
+
+        case DP_ADD:
+        case DP_CMN:
+            ui32Alu = X86_ADD;
+            bArith = true;
+            bWrite = (ui32Op == DP_ADD);
+            break;
+
+        case DP_ADC:
+            ui32Alu = X86_ADC;
+            bArith = true;
+            break;
+
+        case DP_SUB:
+        case DP_CMP:
+            ui32Alu = X86_SUB;
+            bArith = true;
+            bWrite = (ui32Op == DP_SUB);
+            break;
+
+        case DP_SBC:
+            ui32Alu = X86_SBB;
+            bArith = true;
+            break;
+
+        case DP_RSB:
+            ui32Alu = X86_SUB;
+            bArith = true;
+            bReverse = true;
+            break;
+
+        default:
+            return(false);
+    }
+
+    if(bWrite && (psInsn->ui8Rd == 15))
+        return(false);
+
+    /*
+     * The second operand goes to ecx, or stays an immediate.
+     */
+    if(ui32Kind == DP_REG)
+    {
+        EmitLoad(psEmit, X86_ECX, CPU_REG(psInsn->ui8Rm));
+
+        if(bInvert)
+        {
+            /*
+             * not ecx
+             */
+            Emit8(psEmit, 0xF7);
+            Emit8(psEmit, 0xD1);
+        }
+    }
+    else if(bInvert)
+        ui32Imm = ~ui32Imm;
+
+    if(bMove || bReverse)
+    {
+        if(ui32Kind == DP_REG)
+        {
+            /*
+             * mov eax, ecx
+             */
+            Emit8(psEmit, 0x89);
+            Emit8(psEmit, 0xC8);
+        }
+        else
+        {
+            /*
+             * mov eax, imm32
+             */
+            Emit8(psEmit, 0xB8);
+            Emit32(psEmit, ui32Imm);
+        }
+
+        if(bReverse)
+        {
+            /*
+             * sub eax, [rbx + Rn]
+             */
+            Emit8(psEmit, (ui32Alu << 3) | 3);
+            EmitCpu(psEmit, X86_EAX, CPU_REG(psInsn->ui8Rn));
+        }
+    }
+    else
+    {
+        EmitLoad(psEmit, X86_EAX, CPU_REG(psInsn->ui8Rn));
+
+        /*
+         * The host carry is loaded last, as the C flag for ADC and as the
+         * borrow (its inverse) for SBC.
+         */
+        if(ui32Alu == X86_ADC)
+        {
+            /*
+             * bt dword [rbx + C], 0
+             */
+            Emit8(psEmit, 0x0F);
+            Emit8(psEmit, 0xBA);
+            EmitCpu(psEmit, 4, CPU_FIELD(ui8C));
+            Emit8(psEmit, 0);
+        }
+        else if(ui32Alu == X86_SBB)
+        {
+            /*
+             * cmp byte [rbx + C], 1
+             */
+            Emit8(psEmit, 0x80);
+            EmitCpu(psEmit, X86_CMP, CPU_FIELD(ui8C));
+            Emit8(psEmit, 1);
+        }
+
+        if(ui32Kind == DP_REG)
+        {
+            /*
+             * op eax, ecx
+             */
+            Emit8(psEmit, (ui32Alu << 3) | 1);
+            Emit8(psEmit, 0xC8);
+        }
+        else
+        {
+            /*
+             * op eax, imm32
+             */
+            Emit8(psEmit, (ui32Alu << 3) | 5);
+            Emit32(psEmit, ui32Imm);
+        }
+    }
+
+    /*
+     * Compares and tests always set the flags.  Blocks only run outside IT
+     * blocks, where the 16-bit encodings set them too.
+     */
+    if(!bWrite || (psInsn->ui8S != THUMB_S_NEVER))
+    {
+        if(!bArith)
+        {
+            /*
+             * test eax, eax
+             */
+            Emit8(psEmit, 0x85);
+            Emit8(psEmit, 0xC0);
+        }
+
+        EmitSet(psEmit, X86_CC_S, CPU_FIELD(ui8N));
+        EmitSet(psEmit, X86_CC_Z, CPU_FIELD(ui8Z));
+
+        if(bArith)
+        {
+            /*
+             * The host borrow of subtractions is the inverse of the carry.
+             */
+            EmitSet(psEmit, (ui32Alu == X86_ADD) || (ui32Alu == X86_ADC) ?
+                    X86_CC_C : X86_CC_NC, CPU_FIELD(ui8C));
+            EmitSet(psEmit, X86_CC_O, CPU_FIELD(ui8V));
+        }
+        else if((ui32Kind == DP_IMM) &&
+                (psInsn->ui8Shift != THUMB_CARRY_KEEP))
+        {
+            /*
+             * mov byte [rbx + C], imm8
+             */
+            Emit8(psEmit, 0xC6);
+            EmitCpu(psEmit, 0, CPU_FIELD(ui8C));
+            Emit8(psEmit, psInsn->ui8Shift);
+        }
+    }
+
+    if(bWrite)
+        EmitStore(psEmit, CPU_REG(psInsn->ui8Rd));
+
+    return(true);
+}
+
+/*
+ * Translates B, B<c> and BL, which end the block.  The condition is
+ * evaluated from the flags into eax.  The address of the branch is stored
+ * as the interpreter does, for the idle loop detector.
+ */
+static bool
+TranslateBranch(tEmitter *psEmit, const tSimInsn *psInsn, uint32_t ui32PC)
+{
+    uint32_t ui32Cond, ui32Next = ui32PC + psInsn->ui8Size;
+    bool bLink;
+
+    if(!SimThumbDirectBranch(psInsn, &ui32Cond, &bLink))
+        return(false);
+
+    if(bLink)
+        EmitStoreImm(psEmit, CPU_REG(14), ui32Next | 1);
+
+    EmitStoreImm(psEmit, CPU_FIELD(ui32InsnPC), ui32PC);
+    EmitStoreImm(psEmit, CPU_FIELD(ui32PC), ui32Next);
+
+    if((ui32Cond >> 1) != 7)
+    {
+        /*
+         * movzx eax, byte [rbx + flag] of Z, C, N or V, or the combinations
+         * for HI (C && !Z), GE (N == V) and GT (N == V && !Z).
+         */
+        static const uint8_t pui8Flag[7] =
+        {
+            CPU_FIELD(ui8Z), CPU_FIELD(ui8C), CPU_FIELD(ui8N),
+            CPU_FIELD(ui8V), CPU_FIELD(ui8Z), CPU_FIELD(ui8N),
+            CPU_FIELD(ui8N)
+        };
+
+        Emit8(psEmit, 0x0F);
+        Emit8(psEmit, 0xB6);
+        EmitCpu(psEmit, X86_EAX, pui8Flag[ui32Cond >> 1]);
+
+        switch(ui32Cond >> 1)
+        {
+            case 4:
+                /*
+                 * xor eax, 1; and al, [rbx + C]
+                 */
+                Emit8(psEmit, 0x83);
+                Emit8(psEmit, 0xF0);
+                Emit8(psEmit, 1);
+                Emit8(psEmit, 0x22);
+                EmitCpu(psEmit, X86_EAX, CPU_FIELD(ui8C));
+                break;
+
+            case 5:
+            case 6:
+                /*
+                 * xor al, [rbx + V]; or al, [rbx + Z]; xor eax, 1
+                 */
+                Emit8(psEmit, 0x32);
+                EmitCpu(psEmit, X86_EAX, CPU_FIELD(ui8V));
+
+                if((ui32Cond >> 1) == 6)
+                {
+                    Emit8(psEmit, 0x0A);
+                    EmitCpu(psEmit, X86_EAX, CPU_FIELD(ui8Z));
+                }
+
+                Emit8(psEmit, 0x83);
+                Emit8(psEmit, 0xF0);
+                Emit8(psEmit, 1);
+                break;
+        }
+
+        /*
+         * test eax, eax; jz/jnz over the store of the target
+         */
+        Emit8(psEmit, 0x85);
+        Emit8(psEmit, 0xC0);
+        Emit8(psEmit, (ui32Cond & 1) ? 0x75 : 0x74);
+        Emit8(psEmit, 10);
+    }
+
+    EmitStoreImm(psEmit, CPU_FIELD(ui32PC), psInsn->ui32Imm);
+
+    return(true);
+}
+
+/*
+ * Calls the execution function of an instruction, with the processor state
+ * set up as the interpreter does.  Unless the instruction ends the block,
+ * the block is left when it changed the PC or ended the slice.
+ */
+static void
+TranslateCall(tEmitter *psEmit, const tSimInsn *psInsn, uint32_t ui32PC,
+              bool bEnds)
+{
+    uint32_t ui32Next = ui32PC + psInsn->ui8Size;
+
+    EmitStoreImm(psEmit, CPU_FIELD(ui32InsnPC), ui32PC);
+    EmitStoreImm(psEmit, CPU_REG(15), ui32PC + 4);
+    EmitStoreImm(psEmit, CPU_FIELD(ui32PC), ui32Next);
+
+    /*
+     * mov rdi, r12; mov rsi, psInsn; mov rax, pfnExec; call rax
+     */
+    Emit8(psEmit, 0x4C);
+    Emit8(psEmit, 0x89);
+    Emit8(psEmit, 0xE7);
+    Emit8(psEmit, 0x48);
+    Emit8(psEmit, 0xBE);
+    Emit64(psEmit, (uintptr_t)psInsn);
+    Emit8(psEmit, 0x48);
+    Emit8(psEmit, 0xB8);
+    Emit64(psEmit, (uintptr_t)psInsn->pfnExec);
+    Emit8(psEmit, 0xFF);
+    Emit8(psEmit, 0xD0);
+
+    if(bEnds)
+        return;
+
+    /*
+     * cmp dword [rbx + PC], imm32; jne exit
+     */
+    Emit8(psEmit, 0x81);
+    EmitCpu(psEmit, X86_CMP, CPU_FIELD(ui32PC));
+    Emit32(psEmit, ui32Next);
+    EmitExit(psEmit, X86_CC_NZ);
+
+    /*
+     * mov rax, [rbx + ui64Cycle]; cmp rax, [rbx + ui64Limit]; jae exit
+     */
+    Emit8(psEmit, 0x48);
+    EmitLoad(psEmit, X86_EAX, CPU_FIELD(ui64Cycle));
+    Emit8(psEmit, 0x48);
+    Emit8(psEmit, 0x3B);
+    EmitCpu(psEmit, X86_EAX, CPU_FIELD(ui64Limit));
+    EmitExit(psEmit, X86_CC_NC);
+}
+
+/*
+ * Translates loads and stores of a single register with an immediate or
+ * register offset and no writeback.  An aligned access to a page that the
+ * page tables map for it is made on the arena directly; any other goes out
+ * of line to the execution function, which takes the slow path to the
+ * board, the debugger and the fault handling.  The ui32Pending instructions
+ * not yet accounted for, this one included, are accounted for around the
+ * call only.
+ */
+static bool
+TranslateLoadStore(tEmitter *psEmit, const tSimInsn *psInsn, uint32_t ui32PC,
+                   uint32_t ui32Pending)
+{
+    uint8_t *ppui8Slow[3], *pui8Done;
+    uint32_t ui32Size, ui32Slow = 0, ui32Idx, ui32Op;
+    bool bStore, bSigned, bReg;
+
+    if(!SimThumbLoadStore(psInsn, &ui32Size, &bStore, &bSigned, &bReg) ||
+       (psInsn->ui8Rd == 15) || (psInsn->ui8Rn == 15) ||
+       (bReg && (psInsn->ui8Rm == 15)))
+        return(false);
+
+    /*
+     * The address goes to eax.
+     */
+    EmitLoad(psEmit, X86_EAX, CPU_REG(psInsn->ui8Rn));
+
+    if(bReg)
+    {
+        EmitLoad(psEmit, X86_ECX, CPU_REG(psInsn->ui8Rm));
+
+        if(psInsn->ui8Shift)
+        {
+            /*
+             * shl ecx, imm8
+             */
+            Emit8(psEmit, 0xC1);
+            Emit8(psEmit, 0xE1);
+            Emit8(psEmit, psInsn->ui8Shift);
+        }
+
+        /*
+         * add eax, ecx
+         */
+        Emit8(psEmit, 0x01);
+        Emit8(psEmit, 0xC8);
+    }
+    else if(psInsn->ui32Imm)
+    {
+        /*
+         * add eax, imm32
+         */
+        Emit8(psEmit, 0x05);
+        Emit32(psEmit, psInsn->ui32Imm);
+    }
+
+    /*
+     * test al, size - 1; jnz slow.  An aligned access stays in its page.
+     */
+    if(ui32Size > 1)
+    {
+        Emit8(psEmit, 0xA8);
+        Emit8(psEmit, ui32Size - 1);
+        ppui8Slow[ui32Slow++] = EmitJump(psEmit, X86_CC_NZ);
+    }
+
+    /*
+     * test eax, SIM_MEM_WINDOW_MASK; jnz slow
+     */
+    Emit8(psEmit, 0xA9);
+    Emit32(psEmit, SIM_MEM_WINDOW_MASK);
+    ppui8Slow[ui32Slow++] = EmitJump(psEmit, X86_CC_NZ);
+
+    /*
+     * The page number as in SimMemoryPage():
+     * mov ecx, eax; shr ecx, 21; and ecx, 0x100;
+     * mov edx, eax; shr edx, 12; movzx edx, dl; or ecx, edx
+     */
+    Emit8(psEmit, 0x89);
+    Emit8(psEmit, 0xC1);
+    Emit8(psEmit, 0xC1);
+    Emit8(psEmit, 0xE9);
+    Emit8(psEmit, 21);
+    Emit8(psEmit, 0x81);
+    Emit8(psEmit, 0xE1);
+    Emit32(psEmit, 0x100);
+    Emit8(psEmit, 0x89);
+    Emit8(psEmit, 0xC2);
+    Emit8(psEmit, 0xC1);
+    Emit8(psEmit, 0xEA);
+    Emit8(psEmit, SIM_MEM_PAGE_SHIFT);
+    Emit8(psEmit, 0x0F);
+    Emit8(psEmit, 0xB6);
+    Emit8(psEmit, 0xD2);
+    Emit8(psEmit, 0x09);
+    Emit8(psEmit, 0xD1);
+
+    /*
+     * mov ecx, [r12 + rcx * 4 + table]; test ecx, ecx; jz slow
+     */
+    Emit8(psEmit, 0x41);
+    Emit8(psEmit, 0x8B);
+    Emit8(psEmit, 0x8C);
+    Emit8(psEmit, 0x8C);
+    Emit32(psEmit, bStore ? MEM_FIELD(pui32Write) : MEM_FIELD(pui32Read));
+    Emit8(psEmit, 0x85);
+    Emit8(psEmit, 0xC9);
+    ppui8Slow[ui32Slow++] = EmitJump(psEmit, X86_CC_Z);
+
+    /*
+     * and eax, SIM_MEM_PAGE_SIZE - 1; add ecx, eax, leaving the arena
+     * offset plus one in rcx.
+     */
+    Emit8(psEmit, 0x25);
+    Emit32(psEmit, SIM_MEM_PAGE_SIZE - 1);
+    Emit8(psEmit, 0x01);
+    Emit8(psEmit, 0xC1);
+
+    /*
+     * The access to [r12 + rcx + arena - 1]: mov [..], dl/dx/edx for
+     * stores, mov eax, [..] or movzx/movsx eax, byte/word [..] for loads.
+     */
+    if(bStore)
+    {
+        EmitLoad(psEmit, X86_EDX, CPU_REG(psInsn->ui8Rd));
+
+        if(ui32Size == 2)
+            Emit8(psEmit, 0x66);
+
+        Emit8(psEmit, 0x41);
+        Emit8(psEmit, (ui32Size == 1) ? 0x88 : 0x89);
+        Emit8(psEmit, 0x94);
+    }
+    else
+    {
+        Emit8(psEmit, 0x41);
+
+        if(ui32Size == 4)
+            Emit8(psEmit, 0x8B);
+        else
+        {
+            ui32Op = (ui32Size == 1) ? 0xB6 : 0xB7;
+            Emit8(psEmit, 0x0F);
+            Emit8(psEmit, bSigned ? ui32Op + 8 : ui32Op);
+        }
+
+        Emit8(psEmit, 0x84);
+    }
+
+    Emit8(psEmit, 0x0C);
+    Emit32(psEmit, MEM_FIELD(pui8Arena) - 1);
+
+    if(!bStore)
+        EmitStore(psEmit, CPU_REG(psInsn->ui8Rd));
+
+    pui8Done = EmitJump(psEmit, X86_JMP);
+
+    /*
+     * The slow path, leaving the block counted up to here if it exits.
+     */
+    for(ui32Idx = 0; ui32Idx < ui32Slow; ui32Idx++)
+        EmitPatch(psEmit, ppui8Slow[ui32Idx]);
+
+    EmitCount(psEmit, ui32Pending);
+    TranslateCall(psEmit, psInsn, ui32PC, false);
+    EmitCount(psEmit, -ui32Pending);
+    EmitPatch(psEmit, pui8Done);
+
+    return(true);
+}
+
+/*
+ * Translates the block starting at ui32PC, whose arena offset plus one is
+ * ui32Offset.  Returns NULL if its first instruction cannot be fetched.
+ */
+static tSimBlock *
+TranslateBlock(tSimMachine *psMachine, uint32_t ui32PC, uint32_t ui32Offset)
+{
+    tSimTranslator *psTranslator = psMachine->psTranslator;
+    const tSimInsn *psInsn;
+    tSimBlock *psBlock;
+    tEmitter sEmit;
+    uint8_t *pui8Start;
+    uint32_t ui32Insns = 0, ui32Pending = 0, ui32Exit, ui32Start = ui32PC;
+    uint32_t ui32Last = ui32PC;
+    bool bEnds = false;
+
+    if(SIM_TRANSLATE_CODE_SIZE - psTranslator->szUsed <
+       TRANSLATE_BLOCK_BYTES +
+       SIM_TRANSLATE_BLOCK_INSNS * TRANSLATE_INSN_BYTES)
+        SimTranslateFlush(psMachine);
+
+    pui8Start = psTranslator->pui8Code + psTranslator->szUsed;
+    sEmit.pui8Pos = pui8Start;
+    sEmit.ui32Exits = 0;
+
+    /*
+     * push rbx; push r12; push rbp; mov r12, rdi; lea rbx, [rdi + sCpu]
+     */
+    Emit8(&sEmit, 0x53);
+    Emit8(&sEmit, 0x41);
+    Emit8(&sEmit, 0x54);
+    Emit8(&sEmit, 0x55);
+    Emit8(&sEmit, 0x49);
+    Emit8(&sEmit, 0x89);
+    Emit8(&sEmit, 0xFC);
+    Emit8(&sEmit, 0x48);
+    Emit8(&sEmit, 0x8D);
+    Emit8(&sEmit, 0x9F);
+    Emit32(&sEmit, offsetof(tSimMachine, sCpu));
+
+    while(!bEnds && (ui32Insns < SIM_TRANSLATE_BLOCK_INSNS))
+    {
+        psInsn = SimCpuInsn(psMachine, ui32PC);
+
+        if(!psInsn)
+            break;
+
+        ui32Insns++;
+        ui32Pending++;
+
+        if(TranslateDataProc(&sEmit, psInsn) ||
+           TranslateLoadStore(&sEmit, psInsn, ui32PC, ui32Pending))
+            psTranslator->ui64Native++;
+        else
+        {
+            bEnds = SimThumbEndsBlock(psInsn);
+            EmitCount(&sEmit, ui32Pending);
+            ui32Pending = 0;
+
+            if(TranslateBranch(&sEmit, psInsn, ui32PC))
+                psTranslator->ui64Native++;
+            else
+            {
+                TranslateCall(&sEmit, psInsn, ui32PC, bEnds);
+                psTranslator->ui64Calls++;
+            }
+        }
+
+        ui32Last = ui32PC;
+        ui32PC += psInsn->ui8Size;
+    }
+
+    if(!ui32Insns)
+        return(NULL);
+
+    if(!bEnds)
+    {
+        EmitCount(&sEmit, ui32Pending);
+        EmitStoreImm(&sEmit, CPU_FIELD(ui32PC), ui32PC);
+    }
+
+    /*
+     * pop rbp; pop r12; pop rbx; ret
+     */
+    for(ui32Exit = 0; ui32Exit < sEmit.ui32Exits; ui32Exit++)
+        EmitPatch(&sEmit, sEmit.ppui8Exit[ui32Exit]);
+
+    Emit8(&sEmit, 0x5D);
+    Emit8(&sEmit, 0x41);
+    Emit8(&sEmit, 0x5C);
+    Emit8(&sEmit, 0x5B);
+    Emit8(&sEmit, 0xC3);
+
+    psTranslator->szUsed += sEmit.pui8Pos - pui8Start;
+
+    psBlock = &psTranslator->psBlocks[psTranslator->ui32Blocks++];
+    psBlock->pfnEntry = (void (*)(tSimMachine *))(void *)pui8Start;
+    psBlock->ui32PC = ui32Start;
+    psBlock->ui32Insns = ui32Insns;
+    psBlock->ui32Last = ui32Last;
+    psBlock->ui32End = ui32PC;
+    psTranslator->pui32Index[(ui32Offset - 1) / 2] =
+        psTranslator->ui32Blocks;
+
+    return(psBlock);
+}
+
+bool
+SimTranslateInit(tSimMachine *psMachine)
+{
+    tSimTranslator *psTranslator;
+
+    psTranslator = calloc(1, sizeof(*psTranslator));
+
+    if(!psTranslator)
+        return(false);
+
+    psTranslator->pui8Code = mmap(NULL, SIM_TRANSLATE_CODE_SIZE,
+                                  PROT_READ | PROT_WRITE | PROT_EXEC,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    psTranslator->psBlocks = calloc(SIM_MEM_ARENA_SIZE / 2,
+                                    sizeof(tSimBlock));
+    psTranslator->pui32Index = calloc(SIM_MEM_ARENA_SIZE / 2,
+                                      sizeof(uint32_t));
+    psMachine->psTranslator = psTranslator;
+
+    if((psTranslator->pui8Code == MAP_FAILED) || !psTranslator->psBlocks ||
+       !psTranslator->pui32Index)
+    {
+        SimTranslateFree(psMachine);
+        return(false);
+    }
+
+    return(true);
+}
+
+void
+SimTranslateFree(tSimMachine *psMachine)
+{
+    tSimTranslator *psTranslator = psMachine->psTranslator;
+
+    if(!psTranslator)
+        return;
+
+    if(psTranslator->pui8Code && (psTranslator->pui8Code != MAP_FAILED))
+        munmap(psTranslator->pui8Code, SIM_TRANSLATE_CODE_SIZE);
+
+    free(psTranslator->psBlocks);
+    free(psTranslator->pui32Index);
+    free(psTranslator);
+    psMachine->psTranslator = NULL;
+}
+
+/*
+ * Drops all translated code.  A block that is running may finish, as its
+ * code stays in place until the next translation.
+ */
+void
+SimTranslateFlush(tSimMachine *psMachine)
+{
+    tSimTranslator *psTranslator = psMachine->psTranslator;
+
+    psTranslator->szUsed = 0;
+    psTranslator->ui32Blocks = 0;
+    psTranslator->ui32Flushes++;
+    memset(psTranslator->pui32Index, 0,
+           (SIM_MEM_ARENA_SIZE / 2) * sizeof(uint32_t));
+}
+
+/*
+ * Runs translated blocks from the current PC while they fit in the slice.
+ * Returns false if none ran, leaving the next instruction to the
+ * interpreter: inside IT blocks, at the end of the slice and on fetch
+ * faults.
+ */
+bool
+SimTranslateRun(tSimMachine *psMachine)
+{
+    tSimTranslator *psTranslator = psMachine->psTranslator;
+    tSimCpu *psCpu = &psMachine->sCpu;
+    tSimBlock *psBlock;
+    uint32_t ui32Offset, ui32Block;
+    bool bRan = false;
+
+    while(!psCpu->ui32IT)
+    {
+        ui32Offset = SimMemoryOffset(psMachine->sMemory.pui32Read,
+                                     psCpu->ui32PC);
+
+        if(!ui32Offset)
+            break;
+
+        ui32Block = psTranslator->pui32Index[(ui32Offset - 1) / 2];
+        psBlock = ui32Block ? &psTranslator->psBlocks[ui32Block - 1] :
+                  TranslateBlock(psMachine, psCpu->ui32PC, ui32Offset);
+
+        if(!psBlock ||
+           (psCpu->ui64Cycle + psBlock->ui32Insns > psCpu->ui64Limit))
+            break;
+
+        psBlock->pfnEntry(psMachine);
+        bRan = true;
+
+        /*
+         * The last instruction branching back a little may close an idle
+         * loop, measured from the end of the branch as the interpreter
+         * does.  A block left earlier, at the end of the slice, did not
+         * branch.
+         */
+        if(psMachine->psIdle && (psCpu->ui32InsnPC == psBlock->ui32Last) &&
+           (psCpu->ui32PC < psBlock->ui32End) &&
+           (psBlock->ui32End - psCpu->ui32PC <= SIM_IDLE_MAX_BYTES))
+            SimIdleBranch(psMachine);
+    }
+
+    return(bRan);
+}
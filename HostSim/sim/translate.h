@@ -0,0 +1,64 @@
+#ifndef __SIM_TRANSLATE_H__
+#define __SIM_TRANSLATE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cpu.h"
+
+/*
+ * Translation of firmware code to x86-64 host code, one basic block at a
+ * time, as execution reaches it.  Simple data-processing instructions,
+ * direct branches and loads and stores of a single register become host
+ * instructions working on the register file in tSimCpu and the memory
+ * arena; everything else calls the execution function of the decoded
+ * instruction, as do the loads and stores that miss the page tables, so
+ * peripheral accesses still reach the board.
+ *
+ * A block runs only if the slice has room for all of its instructions.  It
+ * leaves early when an instruction changes the PC or ends the slice.
+ */
+#define SIM_TRANSLATE_CODE_SIZE (16U << 20)
+#define SIM_TRANSLATE_BLOCK_INSNS 64
+
+typedef struct
+{
+    void (*pfnEntry)(tSimMachine *psMachine);
+    uint32_t ui32PC;
+    uint32_t ui32Insns;
+
+    /*
+     * Address of the last instruction and of the one after it.
+     */
+    uint32_t ui32Last;
+    uint32_t ui32End;
+} tSimBlock;
+
+struct tSimTranslator
+{
+    /*
+     * Host code, filled from the start and emptied all at once.
+     */
+    uint8_t *pui8Code;
+    size_t szUsed;
+
+    /*
+     * The blocks, and for every halfword of the arena the number of the
+     * block starting there plus one.
+     */
+    tSimBlock *psBlocks;
+    uint32_t ui32Blocks;
+    uint32_t *pui32Index;
+
+    uint32_t ui32Flushes;
+    uint64_t ui64Native;
+    uint64_t ui64Calls;
+};
+
+bool SimTranslateInit(tSimMachine *psMachine);
+void SimTranslateFree(tSimMachine *psMachine);
+void SimTranslateFlush(tSimMachine *psMachine);
+bool SimTranslateRun(tSimMachine *psMachine);
+
+#endif
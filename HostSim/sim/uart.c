@@ -0,0 +1,534 @@
+/*
+ * UARTs 0 to 7.
+ */
+#include <string.h>
+
+#include "board.h"
+
+#define UART_O_DR               0x000
+#define UART_O_RSR              0x004
+#define UART_O_FR               0x018
+#define UART_O_IBRD             0x024
+#define UART_O_FBRD             0x028
+#define UART_O_LCRH             0x02C
+#define UART_O_CTL              0x030
+#define UART_O_IFLS             0x034
+#define UART_O_IM               0x038
+#define UART_O_RIS              0x03C
+#define UART_O_MIS              0x040
+#define UART_O_ICR              0x044
+#define UART_O_CC               0xFC8
+
+#define UART_RSR_OE             0x00000008U
+
+#define UART_FR_BUSY            0x00000008U
+#define UART_FR_RXFE            0x00000010U
+#define UART_FR_TXFF            0x00000020U
+#define UART_FR_RXFF            0x00000040U
+#define UART_FR_TXFE            0x00000080U
+
+#define UART_LCRH_PEN           0x00000002U
+#define UART_LCRH_STP2          0x00000008U
+#define UART_LCRH_FEN           0x00000010U
+#define UART_LCRH_WLEN_S        5
+
+#define UART_CTL_UARTEN         0x00000001U
+#define UART_CTL_EOT            0x00000010U
+#define UART_CTL_HSE            0x00000020U
+#define UART_CTL_TXE            0x00000100U
+#define UART_CTL_RXE            0x00000200U
+
+#define UART_INT_RX             0x00000010U
+#define UART_INT_TX             0x00000020U
+#define UART_INT_RT             0x00000040U
+#define UART_INT_OE             0x00000400U
+#define UART_INT_M              0x000007F0U
+
+#define UART_CC_PIOSC           5
+
+/*
+ * A receive timeout is signalled after the line has been idle for this many
+ * bit times.
+ */
+#define UART_TIMEOUT_BITS       32
+
+/*
+ * An idle polled receive line is looked at every millisecond.
+ */
+#define UART_POLL_PS            (SIM_PS_PER_SECOND / 1000)
+
+static const uint8_t g_pui8Interrupt[SIM_UARTS] =
+{
+    SIM_INT_UART0, SIM_INT_UART1, SIM_INT_UART2, SIM_INT_UART3,
+    SIM_INT_UART4, SIM_INT_UART5, SIM_INT_UART6, SIM_INT_UART7
+};
+
+/*
+ * FIFO levels selected by the TXIFLSEL and RXIFLSEL fields of IFLS.
+ */
+static const uint8_t g_pui8Level[8] = { 2, 4, 8, 12, 14, 14, 14, 14 };
+
+static uint32_t
+UARTDepth(const tSimUART *psUART)
+{
+    return((psUART->ui32LCRH & UART_LCRH_FEN) ? SIM_UART_FIFO : 1);
+}
+
+static uint32_t
+UARTTxLevel(const tSimUART *psUART)
+{
+    return((psUART->ui32LCRH & UART_LCRH_FEN) ?
+           g_pui8Level[psUART->ui32IFLS & 7] : 0);
+}
+
+static uint32_t
+UARTRxLevel(const tSimUART *psUART)
+{
+    return((psUART->ui32LCRH & UART_LCRH_FEN) ?
+           g_pui8Level[(psUART->ui32IFLS >> 3) & 7] : 1);
+}
+
+static void
+UARTUpdateLine(tSimBoard *psBoard, uint32_t ui32Port)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+
+    SimNVICSetLine(&psBoard->sNVIC, g_pui8Interrupt[ui32Port],
+                   (psUART->ui32RIS & psUART->ui32IM & UART_INT_M) != 0);
+}
+
+/*
+ * Returns the duration of one bit in picoseconds.
+ */
+static uint64_t
+UARTBitPs(const tSimBoard *psBoard, uint32_t ui32Port)
+{
+    const tSimUART *psUART = &psBoard->psUART[ui32Port];
+    uint64_t ui64ClockPs, ui64Divisor;
+
+    if(psUART->ui8Line & SIM_UART_LINE_INSTANT)
+        return(psBoard->ui32CyclePs);
+
+    ui64ClockPs = (psUART->ui32CC == UART_CC_PIOSC) ? SIM_UART_PIOSC_PS :
+                  psBoard->ui32CyclePs;
+
+    /*
+     * The divisor is in 1/64ths of the baud clock; a UART that was never
+     * programmed runs at the fastest rate.
+     */
+    ui64Divisor = psUART->ui32IBRD * 64 + psUART->ui32FBRD;
+
+    if(ui64Divisor < 64)
+        ui64Divisor = 64;
+
+    return(ui64ClockPs * ui64Divisor *
+           ((psUART->ui32Ctl & UART_CTL_HSE) ? 8 : 16) / 64);
+}
+
+/*
+ * Returns the duration of a frame in picoseconds: the start bit, the data
+ * bits, the parity bit and the stop bits.
+ */
+uint64_t
+SimUARTFramePs(const tSimBoard *psBoard, uint32_t ui32Port)
+{
+    const tSimUART *psUART = &psBoard->psUART[ui32Port];
+    uint32_t ui32Bits;
+
+    ui32Bits = 1 + 5 + ((psUART->ui32LCRH >> UART_LCRH_WLEN_S) & 3) +
+               ((psUART->ui32LCRH & UART_LCRH_PEN) ? 1 : 0) +
+               ((psUART->ui32LCRH & UART_LCRH_STP2) ? 2 : 1);
+
+    return(ui32Bits * UARTBitPs(psBoard, ui32Port));
+}
+
+static void
+UARTPollSchedule(tSimBoard *psBoard, uint32_t ui32Port, uint64_t ui64Delay)
+{
+    SimEventSchedule(&psBoard->sEvents, SIM_EVENT_UART0RX + ui32Port,
+                     psBoard->ui64Time + ui64Delay);
+}
+
+void
+SimUARTReset(tSimBoard *psBoard, uint32_t ui32Port)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+    uint8_t ui8Line = psUART->ui8Line;
+
+    memset(psUART, 0, sizeof(*psUART));
+
+    psUART->ui32Ctl = UART_CTL_TXE | UART_CTL_RXE;
+    psUART->ui32IFLS = 0x12;
+    psUART->ui8Line = ui8Line;
+
+    if(ui8Line & SIM_UART_LINE_POLLED)
+        UARTPollSchedule(psBoard, ui32Port, UART_POLL_PS);
+}
+
+/*
+ * Connects the lines of a UART to the environment (SIM_UART_LINE_*).
+ */
+void
+SimUARTConnect(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Line)
+{
+    psBoard->psUART[ui32Port].ui8Line = (uint8_t)ui32Line;
+
+    if(ui32Line & SIM_UART_LINE_POLLED)
+        UARTPollSchedule(psBoard, ui32Port, 0);
+    else
+        SimEventCancel(&psBoard->sEvents, SIM_EVENT_UART0RX + ui32Port);
+}
+
+/*
+ * Moves the next character from the transmit FIFO into the shift register
+ * and starts its frame at ui64Start.
+ */
+static void
+UARTTxStart(tSimBoard *psBoard, uint32_t ui32Port, uint64_t ui64Start)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+    uint32_t ui32Level = UARTTxLevel(psUART);
+
+    if(!psUART->ui8TxCount ||
+       ((psUART->ui32Ctl & (UART_CTL_UARTEN | UART_CTL_TXE)) !=
+        (UART_CTL_UARTEN | UART_CTL_TXE)))
+        return;
+
+    psUART->ui8TxShift = psUART->pui8TxFIFO[psUART->ui8TxHead];
+    psUART->ui8TxHead = (psUART->ui8TxHead + 1) % SIM_UART_FIFO;
+    psUART->ui8TxCount--;
+
+    /*
+     * The transmit interrupt fires as the FIFO drains through its trigger
+     * level, unless it is held back to the end of transmission.
+     */
+    if(!(psUART->ui32Ctl & UART_CTL_EOT) &&
+       (psUART->ui8TxCount == ui32Level))
+    {
+        psUART->ui32RIS |= UART_INT_TX;
+        UARTUpdateLine(psBoard, ui32Port);
+    }
+
+    SimEventSchedule(&psBoard->sEvents, SIM_EVENT_UART0TX + ui32Port,
+                     ui64Start + SimUARTFramePs(psBoard, ui32Port));
+}
+
+/*
+ * Completes the frame in the shift register.
+ */
+void
+SimUARTTxEvent(tSimBoard *psBoard, uint32_t ui32Port, uint64_t ui64Deadline)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+
+    if(psBoard->sHooks.pfnUARTTransmit)
+        psBoard->sHooks.pfnUARTTransmit(psBoard->sHooks.pvContext, psBoard,
+                                        ui32Port, psUART->ui8TxShift);
+
+    UARTTxStart(psBoard, ui32Port, ui64Deadline);
+
+    if(!SimEventPending(&psBoard->sEvents, SIM_EVENT_UART0TX + ui32Port) &&
+       (psUART->ui32Ctl & UART_CTL_EOT))
+    {
+        psUART->ui32RIS |= UART_INT_TX;
+        UARTUpdateLine(psBoard, ui32Port);
+    }
+}
+
+void
+SimUARTTimeoutEvent(tSimBoard *psBoard, uint32_t ui32Port)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+
+    if(!psUART->ui8RxCount)
+        return;
+
+    psUART->ui32RIS |= UART_INT_RT;
+    UARTUpdateLine(psBoard, ui32Port);
+}
+
+/*
+ * Polls the receive line: a character that has arrived is received and the
+ * next one is looked for a frame later.  The line is left alone while the
+ * receive FIFO is full, and while a recording is replayed, which supplies
+ * the characters itself.
+ */
+void
+SimUARTPollEvent(tSimBoard *psBoard, uint32_t ui32Port)
+{
+    const tSimUART *psUART = &psBoard->psUART[ui32Port];
+    uint64_t ui64Delay = UART_POLL_PS;
+    int32_t i32Byte;
+
+    if(!(psUART->ui8Line & SIM_UART_LINE_POLLED) ||
+       !psBoard->sHooks.pfnUARTPoll || SimReplaying(psBoard->psReplay))
+        return;
+
+    if(SimUARTReady(psBoard, ui32Port))
+    {
+        i32Byte = psBoard->sHooks.pfnUARTPoll(psBoard->sHooks.pvContext,
+                                              psBoard, ui32Port);
+
+        if(i32Byte >= 0)
+        {
+            SimUARTReceive(psBoard, ui32Port, (uint8_t)i32Byte);
+            ui64Delay = SimUARTFramePs(psBoard, ui32Port);
+        }
+    }
+    else if(psUART->ui8RxCount)
+    {
+        ui64Delay = SimUARTFramePs(psBoard, ui32Port);
+    }
+
+    UARTPollSchedule(psBoard, ui32Port, ui64Delay);
+}
+
+/*
+ * Returns true if the receiver is enabled and its FIFO has room for another
+ * character.
+ */
+bool
+SimUARTReady(const tSimBoard *psBoard, uint32_t ui32Port)
+{
+    const tSimUART *psUART = &psBoard->psUART[ui32Port];
+
+    return(((psUART->ui32Ctl & (UART_CTL_UARTEN | UART_CTL_RXE)) ==
+            (UART_CTL_UARTEN | UART_CTL_RXE)) &&
+           (psUART->ui8RxCount < UARTDepth(psUART)));
+}
+
+/*
+ * Delivers a character arriving on the receive line.  Returns false if the
+ * receiver is disabled or the character overran the FIFO.
+ */
+bool
+SimUARTReceive(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Byte)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+
+    if(psBoard->psReplay)
+        SimReplayUARTReceive(psBoard, ui32Port, ui8Byte);
+
+    if((psUART->ui32Ctl & (UART_CTL_UARTEN | UART_CTL_RXE)) !=
+       (UART_CTL_UARTEN | UART_CTL_RXE))
+        return(false);
+
+    if(psUART->ui8RxCount == UARTDepth(psUART))
+    {
+        psUART->ui32RIS |= UART_INT_OE;
+        psUART->ui32RSR |= UART_RSR_OE;
+        UARTUpdateLine(psBoard, ui32Port);
+        return(false);
+    }
+
+    psUART->pui16RxFIFO[(psUART->ui8RxHead + psUART->ui8RxCount++) %
+                        SIM_UART_FIFO] = ui8Byte;
+
+    if(psUART->ui8RxCount == UARTRxLevel(psUART))
+    {
+        psUART->ui32RIS |= UART_INT_RX;
+        UARTUpdateLine(psBoard, ui32Port);
+    }
+
+    SimEventSchedule(&psBoard->sEvents, SIM_EVENT_UART0RT + ui32Port,
+                     psBoard->ui64Time +
+                     UART_TIMEOUT_BITS * UARTBitPs(psBoard, ui32Port));
+
+    return(true);
+}
+
+static uint32_t
+UARTReadData(tSimBoard *psBoard, uint32_t ui32Port, bool bPeek)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+    uint32_t ui32Value;
+
+    if(!psUART->ui8RxCount)
+        return(0);
+
+    ui32Value = psUART->pui16RxFIFO[psUART->ui8RxHead];
+
+    if(bPeek)
+        return(ui32Value);
+
+    psUART->ui8RxHead = (psUART->ui8RxHead + 1) % SIM_UART_FIFO;
+    psUART->ui8RxCount--;
+
+    /*
+     * The receive interrupts clear themselves as the FIFO is read.
+     */
+    if(psUART->ui8RxCount < UARTRxLevel(psUART))
+        psUART->ui32RIS &= ~UART_INT_RX;
+
+    if(!psUART->ui8RxCount)
+    {
+        psUART->ui32RIS &= ~UART_INT_RT;
+        SimEventCancel(&psBoard->sEvents, SIM_EVENT_UART0RT + ui32Port);
+    }
+
+    UARTUpdateLine(psBoard, ui32Port);
+
+    return(ui32Value);
+}
+
+static void
+UARTWriteData(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Byte)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+
+    if(psUART->ui8TxCount == UARTDepth(psUART))
+        return;
+
+    psUART->pui8TxFIFO[(psUART->ui8TxHead + psUART->ui8TxCount++) %
+                       SIM_UART_FIFO] = ui8Byte;
+
+    if(!(psUART->ui32Ctl & UART_CTL_EOT) &&
+       (psUART->ui8TxCount > UARTTxLevel(psUART)))
+    {
+        psUART->ui32RIS &= ~UART_INT_TX;
+        UARTUpdateLine(psBoard, ui32Port);
+    }
+
+    if(!SimEventPending(&psBoard->sEvents, SIM_EVENT_UART0TX + ui32Port))
+        UARTTxStart(psBoard, ui32Port, psBoard->ui64Time);
+}
+
+uint32_t
+SimUARTRead(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Offset,
+            bool bPeek)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+    uint32_t ui32Value;
+
+    switch(ui32Offset)
+    {
+        case UART_O_DR:
+            return(UARTReadData(psBoard, ui32Port, bPeek));
+
+        case UART_O_RSR:
+            return(psUART->ui32RSR);
+
+        case UART_O_FR:
+            ui32Value = 0;
+
+            if(!psUART->ui8TxCount)
+                ui32Value |= UART_FR_TXFE;
+
+            if(psUART->ui8TxCount == UARTDepth(psUART))
+                ui32Value |= UART_FR_TXFF;
+
+            if(!psUART->ui8RxCount)
+                ui32Value |= UART_FR_RXFE;
+
+            if(psUART->ui8RxCount == UARTDepth(psUART))
+                ui32Value |= UART_FR_RXFF;
+
+            if(psUART->ui8TxCount ||
+               SimEventPending(&psBoard->sEvents,
+                               SIM_EVENT_UART0TX + ui32Port))
+                ui32Value |= UART_FR_BUSY;
+
+            return(ui32Value);
+
+        case UART_O_IBRD:
+            return(psUART->ui32IBRD);
+
+        case UART_O_FBRD:
+            return(psUART->ui32FBRD);
+
+        case UART_O_LCRH:
+            return(psUART->ui32LCRH);
+
+        case UART_O_CTL:
+            return(psUART->ui32Ctl);
+
+        case UART_O_IFLS:
+            return(psUART->ui32IFLS);
+
+        case UART_O_IM:
+            return(psUART->ui32IM);
+
+        case UART_O_RIS:
+            return(psUART->ui32RIS);
+
+        case UART_O_MIS:
+            return(psUART->ui32RIS & psUART->ui32IM);
+
+        case UART_O_CC:
+            return(psUART->ui32CC);
+
+        default:
+            return(0);
+    }
+}
+
+void
+SimUARTWrite(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Offset,
+             uint32_t ui32Value)
+{
+    tSimUART *psUART = &psBoard->psUART[ui32Port];
+
+    switch(ui32Offset)
+    {
+        case UART_O_DR:
+            UARTWriteData(psBoard, ui32Port, (uint8_t)ui32Value);
+            break;
+
+        case UART_O_RSR:
+            psUART->ui32RSR = 0;
+            break;
+
+        case UART_O_IBRD:
+            psUART->ui32IBRD = ui32Value & 0xFFFF;
+            break;
+
+        case UART_O_FBRD:
+            psUART->ui32FBRD = ui32Value & 0x3F;
+            break;
+
+        case UART_O_LCRH:
+            /*
+             * Turning the FIFOs off leaves a single holding register.
+             */
+            if(!(ui32Value & UART_LCRH_FEN))
+            {
+                if(psUART->ui8TxCount > 1)
+                    psUART->ui8TxCount = 1;
+
+                if(psUART->ui8RxCount > 1)
+                    psUART->ui8RxCount = 1;
+            }
+
+            psUART->ui32LCRH = ui32Value & 0xFF;
+            break;
+
+        case UART_O_CTL:
+            psUART->ui32Ctl = ui32Value & 0xFBF;
+
+            if(!SimEventPending(&psBoard->sEvents,
+                                SIM_EVENT_UART0TX + ui32Port))
+                UARTTxStart(psBoard, ui32Port, psBoard->ui64Time);
+            break;
+
+        case UART_O_IFLS:
+            psUART->ui32IFLS = ui32Value & 0x3F;
+            break;
+
+        case UART_O_IM:
+            psUART->ui32IM = ui32Value & UART_INT_M;
+            UARTUpdateLine(psBoard, ui32Port);
+            break;
+
+        case UART_O_ICR:
+            psUART->ui32RIS &= ~ui32Value;
+            UARTUpdateLine(psBoard, ui32Port);
+            break;
+
+        case UART_O_CC:
+            psUART->ui32CC = ui32Value & 0xF;
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef __SIM_UART_H__
+#define __SIM_UART_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct tSimBoard tSimBoard;
+
+#define SIM_UARTS               8
+#define SIM_UART_FIFO           16
+
+/*
+ * Period of the precision internal oscillator, which the UARTs may use as
+ * their baud clock, in picoseconds.
+ */
+#define SIM_UART_PIOSC_PS       62500U
+
+/*
+ * How the lines of a UART are connected to the environment, which survives
+ * resets.  The receive line of a polled UART takes its characters from the
+ * board's pfnUARTPoll hook, one frame apart while the receive FIFO has room,
+ * so nothing sent from outside is lost to an overrun.  An instant UART
+ * ignores its baud rate and sends every bit in one system clock, so a frame
+ * takes about ten.
+ */
+#define SIM_UART_LINE_POLLED    0x01
+#define SIM_UART_LINE_INSTANT   0x02
+
+/*
+ * One UART.  The transmitter shifts out ui8TxShift while its end of frame
+ * event is pending and hands every completed frame to the board's transmit
+ * hook.  Received characters are pushed into the receive FIFO whole, with
+ * their error bits.
+ */
+typedef struct
+{
+    uint32_t ui32Ctl;
+    uint32_t ui32IBRD;
+    uint32_t ui32FBRD;
+    uint32_t ui32LCRH;
+    uint32_t ui32IFLS;
+    uint32_t ui32IM;
+    uint32_t ui32RIS;
+    uint32_t ui32RSR;
+    uint32_t ui32CC;
+    uint8_t pui8TxFIFO[SIM_UART_FIFO];
+    uint8_t ui8TxHead;
+    uint8_t ui8TxCount;
+    uint8_t ui8TxShift;
+    uint16_t pui16RxFIFO[SIM_UART_FIFO];
+    uint8_t ui8RxHead;
+    uint8_t ui8RxCount;
+    uint8_t ui8Line;
+} tSimUART;
+
+void SimUARTReset(tSimBoard *psBoard, uint32_t ui32Port);
+void SimUARTConnect(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Line);
+uint32_t SimUARTRead(tSimBoard *psBoard, uint32_t ui32Port,
+                     uint32_t ui32Offset, bool bPeek);
+void SimUARTWrite(tSimBoard *psBoard, uint32_t ui32Port, uint32_t ui32Offset,
+                  uint32_t ui32Value);
+void SimUARTTxEvent(tSimBoard *psBoard, uint32_t ui32Port,
+                    uint64_t ui64Deadline);
+void SimUARTTimeoutEvent(tSimBoard *psBoard, uint32_t ui32Port);
+void SimUARTPollEvent(tSimBoard *psBoard, uint32_t ui32Port);
+bool SimUARTReady(const tSimBoard *psBoard, uint32_t ui32Port);
+bool SimUARTReceive(tSimBoard *psBoard, uint32_t ui32Port, uint8_t ui8Byte);
+uint64_t SimUARTFramePs(const tSimBoard *psBoard, uint32_t ui32Port);
+
+#endif
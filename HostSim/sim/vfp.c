@@ -0,0 +1,921 @@
+/*
+ * FPv4-SP floating-point unit of the Cortex-M4F: decoder and execution
+ * functions.
+ *
+ * Arithmetic uses the host's single precision, rounded to nearest.  FPSCR
+ * honours the flush-to-zero and default NaN modes and records invalid
+ * operations, divisions by zero and input denormals; the other cumulative
+ * exception flags are not tracked.
+ */
+#include <math.h>
+#include <string.h>
+
+#include "thumb.h"
+
+#define FPSCR_DN                0x02000000U
+#define FPSCR_FZ                0x01000000U
+#define FPSCR_IDC               0x00000080U
+#define FPSCR_DZC               0x00000002U
+#define FPSCR_IOC               0x00000001U
+#define FPSCR_MASK              0xF7C0009FU
+
+#define VFP_DEFAULT_NAN         0x7FC00000U
+
+/*
+ * tSimInsn.ui8Op of the transfers between memory and extension registers.
+ */
+#define VFP_INDEX               0x01
+#define VFP_WRITEBACK           0x02
+#define VFP_DECREMENT           0x04
+
+/*
+ * Checks the access to the unit before every instruction.  The common case,
+ * full access with the floating-point context already active, is inline.
+ */
+static inline void
+VFPUse(tSimMachine *psMachine)
+{
+    if((((psMachine->sBoard.sNVIC.ui32CPACR >> 20) & 3) != 3) ||
+       !(psMachine->sCpu.ui32Control & SIM_CPU_CONTROL_FPCA))
+        SimCpuFPUsed(psMachine);
+}
+
+static uint32_t
+VFPBits(float fValue)
+{
+    uint32_t ui32Bits;
+
+    memcpy(&ui32Bits, &fValue, 4);
+
+    return(ui32Bits);
+}
+
+static float
+VFPFloat(uint32_t ui32Bits)
+{
+    float fValue;
+
+    memcpy(&fValue, &ui32Bits, 4);
+
+    return(fValue);
+}
+
+static bool
+VFPDenormal(uint32_t ui32Bits)
+{
+    return(!(ui32Bits & 0x7F800000U) && (ui32Bits & 0x007FFFFFU));
+}
+
+static float
+VFPOperand(tSimCpu *psCpu, uint32_t ui32Reg)
+{
+    uint32_t ui32Bits = psCpu->pui32S[ui32Reg];
+
+    if((psCpu->ui32FPSCR & FPSCR_FZ) && VFPDenormal(ui32Bits))
+    {
+        psCpu->ui32FPSCR |= FPSCR_IDC;
+        ui32Bits &= 0x80000000U;
+    }
+
+    return(VFPFloat(ui32Bits));
+}
+
+static void
+VFPResult(tSimCpu *psCpu, uint32_t ui32Reg, float fValue)
+{
+    uint32_t ui32Bits = VFPBits(fValue);
+
+    if(isnan(fValue) && (psCpu->ui32FPSCR & FPSCR_DN))
+        ui32Bits = VFP_DEFAULT_NAN;
+    else if((psCpu->ui32FPSCR & FPSCR_FZ) && VFPDenormal(ui32Bits))
+        ui32Bits &= 0x80000000U;
+
+    psCpu->pui32S[ui32Reg] = ui32Bits;
+}
+
+/*
+ * Records an invalid operation when a NaN comes out of operands that were
+ * not NaNs (or a signalling NaN went in).
+ */
+static void
+VFPCheckInvalid(tSimCpu *psCpu, float fResult, float fA, float fB)
+{
+    if(isnan(fResult) && ((!isnan(fA) && !isnan(fB)) ||
+                          (isnan(fA) && !(VFPBits(fA) & 0x00400000U)) ||
+                          (isnan(fB) && !(VFPBits(fB) & 0x00400000U))))
+        psCpu->ui32FPSCR |= FPSCR_IOC;
+}
+
+/*
+ * Arithmetic.  ui8Rd, ui8Rn and ui8Rm are single-precision register
+ * numbers; ui8Op selects the operation.
+ */
+enum
+{
+    VFP_VMLA, VFP_VMLS, VFP_VNMLS, VFP_VNMLA, VFP_VMUL, VFP_VNMUL, VFP_VADD,
+    VFP_VSUB, VFP_VDIV, VFP_VFNMS, VFP_VFNMA, VFP_VFMA, VFP_VFMS
+};
+
+static void
+ExecVArith(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    float fN, fM, fD, fResult;
+
+    VFPUse(psMachine);
+
+    fN = VFPOperand(psCpu, psInsn->ui8Rn);
+    fM = VFPOperand(psCpu, psInsn->ui8Rm);
+    fD = VFPOperand(psCpu, psInsn->ui8Rd);
+
+    switch(psInsn->ui8Op)
+    {
+        case VFP_VMLA:
+            fResult = fD + fN * fM;
+            break;
+
+        case VFP_VMLS:
+            fResult = fD - fN * fM;
+            break;
+
+        case VFP_VNMLS:
+            fResult = -fD + fN * fM;
+            break;
+
+        case VFP_VNMLA:
+            fResult = -fD - fN * fM;
+            break;
+
+        case VFP_VMUL:
+            fResult = fN * fM;
+            break;
+
+        case VFP_VNMUL:
+            fResult = -(fN * fM);
+            break;
+
+        case VFP_VADD:
+            fResult = fN + fM;
+            break;
+
+        case VFP_VSUB:
+            fResult = fN - fM;
+            break;
+
+        case VFP_VDIV:
+            if((fM == 0.0f) && !isnan(fN) && !isinf(fN) && (fN != 0.0f))
+                psCpu->ui32FPSCR |= FPSCR_DZC;
+
+            fResult = fN / fM;
+            break;
+
+        case VFP_VFNMS:
+            fResult = fmaf(fN, fM, -fD);
+            break;
+
+        case VFP_VFNMA:
+            fResult = fmaf(-fN, fM, -fD);
+            break;
+
+        case VFP_VFMA:
+            fResult = fmaf(fN, fM, fD);
+            break;
+
+        default:
+            fResult = fmaf(-fN, fM, fD);
+            break;
+    }
+
+    VFPCheckInvalid(psCpu, fResult, fN, fM);
+    VFPResult(psCpu, psInsn->ui8Rd, fResult);
+}
+
+/*
+ * Operations on one register: ui8Op selects the operation.
+ */
+enum
+{
+    VFP_VMOV, VFP_VABS, VFP_VNEG, VFP_VSQRT
+};
+
+static void
+ExecVUnary(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = psCpu->pui32S[psInsn->ui8Rm];
+    float fM;
+
+    VFPUse(psMachine);
+
+    switch(psInsn->ui8Op)
+    {
+        case VFP_VMOV:
+            psCpu->pui32S[psInsn->ui8Rd] = ui32M;
+            break;
+
+        case VFP_VABS:
+            psCpu->pui32S[psInsn->ui8Rd] = ui32M & 0x7FFFFFFFU;
+            break;
+
+        case VFP_VNEG:
+            psCpu->pui32S[psInsn->ui8Rd] = ui32M ^ 0x80000000U;
+            break;
+
+        default:
+            fM = VFPOperand(psCpu, psInsn->ui8Rm);
+            VFPCheckInvalid(psCpu, sqrtf(fM), fM, 0.0f);
+            VFPResult(psCpu, psInsn->ui8Rd, sqrtf(fM));
+            break;
+    }
+}
+
+static void
+ExecVMOVImm(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    VFPUse(psMachine);
+
+    psMachine->sCpu.pui32S[psInsn->ui8Rd] = psInsn->ui32Imm;
+}
+
+/*
+ * VCMP and VCMPE; ui8Rm is the zero register for the comparisons with
+ * zero, ui8Op is set for VCMPE.
+ */
+static void
+ExecVCMP(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    float fD, fM;
+    uint32_t ui32Flags;
+
+    VFPUse(psMachine);
+
+    fD = VFPOperand(psCpu, psInsn->ui8Rd);
+    fM = (psInsn->ui8Rm == 0xFF) ? 0.0f : VFPOperand(psCpu, psInsn->ui8Rm);
+
+    if(isnan(fD) || isnan(fM))
+    {
+        ui32Flags = 0x3;
+
+        if(psInsn->ui8Op || (isnan(fD) && !(VFPBits(fD) & 0x00400000U)) ||
+           (isnan(fM) && !(VFPBits(fM) & 0x00400000U)))
+            psCpu->ui32FPSCR |= FPSCR_IOC;
+    }
+    else if(fD == fM)
+        ui32Flags = 0x6;
+    else if(fD < fM)
+        ui32Flags = 0x8;
+    else
+        ui32Flags = 0x2;
+
+    psCpu->ui32FPSCR = (psCpu->ui32FPSCR & 0x0FFFFFFFU) | (ui32Flags << 28);
+}
+
+/*
+ * Conversions between floating point and integers.  ui8Op holds the VCVT_*
+ * bits; ui32Imm is the number of fraction bits of the fixed-point forms.
+ */
+#define VCVT_TO_INT             0x01
+#define VCVT_SIGNED             0x02
+#define VCVT_TRUNCATE           0x04
+#define VCVT_HALF               0x08
+
+static uint32_t
+VFPToInteger(tSimCpu *psCpu, float fValue, bool bSigned, bool bTruncate,
+             uint32_t ui32Bits)
+{
+    double dValue = bTruncate ? trunc(fValue) : nearbyint(fValue);
+    double dMax, dMin;
+
+    if(isnan(fValue))
+    {
+        psCpu->ui32FPSCR |= FPSCR_IOC;
+        return(0);
+    }
+
+    dMax = bSigned ? ldexp(1.0, ui32Bits - 1) - 1 : ldexp(1.0, ui32Bits) - 1;
+    dMin = bSigned ? -ldexp(1.0, ui32Bits - 1) : 0.0;
+
+    if(dValue > dMax)
+    {
+        psCpu->ui32FPSCR |= FPSCR_IOC;
+        dValue = dMax;
+    }
+    else if(dValue < dMin)
+    {
+        psCpu->ui32FPSCR |= FPSCR_IOC;
+        dValue = dMin;
+    }
+
+    return(bSigned ? (uint32_t)(int64_t)dValue : (uint32_t)(uint64_t)dValue);
+}
+
+static void
+ExecVCVT(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = psCpu->pui32S[psInsn->ui8Rm];
+    bool bSigned = psInsn->ui8Op & VCVT_SIGNED;
+    uint32_t ui32Bits = (psInsn->ui8Op & VCVT_HALF) ? 16 : 32;
+    double dScale = ldexp(1.0, psInsn->ui32Imm);
+
+    VFPUse(psMachine);
+
+    if(psInsn->ui8Op & VCVT_TO_INT)
+    {
+        uint32_t ui32Result;
+
+        ui32Result = VFPToInteger(psCpu, (float)(VFPOperand(psCpu,
+                                                 psInsn->ui8Rm) * dScale),
+                                  bSigned, psInsn->ui8Op & VCVT_TRUNCATE,
+                                  ui32Bits);
+
+        if(ui32Bits == 16)
+            ui32Result = bSigned ? (uint32_t)(int16_t)ui32Result :
+                                   ui32Result & 0xFFFF;
+
+        psCpu->pui32S[psInsn->ui8Rd] = ui32Result;
+        return;
+    }
+
+    if(ui32Bits == 16)
+        ui32M = bSigned ? (uint32_t)(int16_t)ui32M : ui32M & 0xFFFF;
+
+    VFPResult(psCpu, psInsn->ui8Rd,
+              (float)((bSigned ? (double)(int32_t)ui32M : (double)ui32M) /
+                      dScale));
+}
+
+/*
+ * VCVTB and VCVTT between single and half precision: ui8Shift selects the
+ * half of the register, ui8Op is set for the conversion to half precision.
+ */
+static uint32_t
+VFPHalfToSingle(uint32_t ui32Half)
+{
+    uint32_t ui32Sign = (ui32Half & 0x8000) << 16;
+    uint32_t ui32Exp = (ui32Half >> 10) & 0x1F, ui32Frac = ui32Half & 0x3FF;
+
+    if(ui32Exp == 0x1F)
+        return(ui32Sign | 0x7F800000U | (ui32Frac << 13) |
+               (ui32Frac ? 0x00400000U : 0));
+
+    if(!ui32Exp)
+        return(ui32Sign | VFPBits(ldexpf((float)ui32Frac, -24)));
+
+    return(ui32Sign | ((ui32Exp + 112) << 23) | (ui32Frac << 13));
+}
+
+static uint32_t
+VFPSingleToHalf(uint32_t ui32Single)
+{
+    uint32_t ui32Sign = (ui32Single >> 16) & 0x8000;
+    float fAbs = fabsf(VFPFloat(ui32Single));
+    int32_t i32Exp;
+    uint32_t ui32Mant;
+
+    if(isnan(fAbs))
+        return(ui32Sign | 0x7E00 | ((ui32Single >> 13) & 0x1FF));
+
+    if(fAbs >= 65520.0f)
+        return(ui32Sign | 0x7C00);
+
+    if(fAbs < ldexpf(1.0f, -14))
+        return(ui32Sign | (uint32_t)nearbyintf(ldexpf(fAbs, 24)));
+
+    frexpf(fAbs, &i32Exp);
+    ui32Mant = (uint32_t)nearbyintf(ldexpf(fAbs, 11 - i32Exp));
+
+    return(ui32Sign + ((uint32_t)(i32Exp + 14) << 10) + ui32Mant - 0x400);
+}
+
+static void
+ExecVCVTHalf(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32M = psCpu->pui32S[psInsn->ui8Rm];
+    uint32_t ui32Shift = psInsn->ui8Shift;
+
+    VFPUse(psMachine);
+
+    if(psInsn->ui8Op)
+        psCpu->pui32S[psInsn->ui8Rd] =
+            (psCpu->pui32S[psInsn->ui8Rd] & ~(0xFFFFU << ui32Shift)) |
+            (VFPSingleToHalf(ui32M) << ui32Shift);
+    else
+        psCpu->pui32S[psInsn->ui8Rd] =
+            VFPHalfToSingle((ui32M >> ui32Shift) & 0xFFFF);
+}
+
+/*
+ * Transfers between core and extension registers.  ui8Rd is the core
+ * register, ui8Rn the single-precision register.
+ */
+static void
+ExecVMOVToCore(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    VFPUse(psMachine);
+
+    psCpu->pui32R[psInsn->ui8Rd] = psCpu->pui32S[psInsn->ui8Rn];
+}
+
+static void
+ExecVMOVFromCore(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    VFPUse(psMachine);
+
+    psCpu->pui32S[psInsn->ui8Rn] = psCpu->pui32R[psInsn->ui8Rd];
+}
+
+/*
+ * Two core registers (ui8Rd and ui8Ra) and two consecutive single-precision
+ * registers starting at ui8Rn.
+ */
+static void
+ExecVMOV2ToCore(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    VFPUse(psMachine);
+
+    psCpu->pui32R[psInsn->ui8Rd] = psCpu->pui32S[psInsn->ui8Rn];
+    psCpu->pui32R[psInsn->ui8Ra] = psCpu->pui32S[psInsn->ui8Rn + 1];
+}
+
+static void
+ExecVMOV2FromCore(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    VFPUse(psMachine);
+
+    psCpu->pui32S[psInsn->ui8Rn] = psCpu->pui32R[psInsn->ui8Rd];
+    psCpu->pui32S[psInsn->ui8Rn + 1] = psCpu->pui32R[psInsn->ui8Ra];
+}
+
+static void
+ExecVMRS(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    VFPUse(psMachine);
+
+    if(psInsn->ui8Rd != 15)
+    {
+        psCpu->pui32R[psInsn->ui8Rd] = psCpu->ui32FPSCR;
+        return;
+    }
+
+    psCpu->ui8N = (psCpu->ui32FPSCR >> 31) & 1;
+    psCpu->ui8Z = (psCpu->ui32FPSCR >> 30) & 1;
+    psCpu->ui8C = (psCpu->ui32FPSCR >> 29) & 1;
+    psCpu->ui8V = (psCpu->ui32FPSCR >> 28) & 1;
+}
+
+static void
+ExecVMSR(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+
+    VFPUse(psMachine);
+
+    psCpu->ui32FPSCR = psCpu->pui32R[psInsn->ui8Rd] & FPSCR_MASK;
+}
+
+/*
+ * Loads and stores of extension registers: ui8Rd is the first
+ * single-precision register, ui8Ra the number of words and ui32Imm the
+ * offset of VLDR and VSTR.
+ */
+static uint32_t
+VFPAddress(tSimMachine *psMachine, const tSimInsn *psInsn,
+           uint32_t *pui32Final)
+{
+    uint32_t ui32Base = psMachine->sCpu.pui32R[psInsn->ui8Rn];
+    uint32_t ui32Bytes = psInsn->ui8Ra * 4U;
+
+    if(psInsn->ui8Op & VFP_INDEX)
+    {
+        *pui32Final = ui32Base;
+        return(ui32Base + psInsn->ui32Imm);
+    }
+
+    if(psInsn->ui8Op & VFP_DECREMENT)
+    {
+        *pui32Final = ui32Base - ui32Bytes;
+        return(ui32Base - ui32Bytes);
+    }
+
+    *pui32Final = ui32Base + ui32Bytes;
+    return(ui32Base);
+}
+
+static void
+ExecVLDM(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t pui32Value[32], ui32Final, ui32Addr, ui32Idx;
+
+    VFPUse(psMachine);
+
+    ui32Addr = VFPAddress(psMachine, psInsn, &ui32Final);
+    ThumbCheckAligned(psMachine, ui32Addr, 4);
+
+    for(ui32Idx = 0; ui32Idx < psInsn->ui8Ra; ui32Idx++)
+        pui32Value[ui32Idx] = ThumbLoad(psMachine, ui32Addr + ui32Idx * 4, 4);
+
+    for(ui32Idx = 0; ui32Idx < psInsn->ui8Ra; ui32Idx++)
+        psCpu->pui32S[(psInsn->ui8Rd + ui32Idx) & 31] = pui32Value[ui32Idx];
+
+    if(psInsn->ui8Op & VFP_WRITEBACK)
+        psCpu->pui32R[psInsn->ui8Rn] = ui32Final;
+}
+
+static void
+ExecVSTM(tSimMachine *psMachine, const tSimInsn *psInsn)
+{
+    tSimCpu *psCpu = &psMachine->sCpu;
+    uint32_t ui32Final, ui32Addr, ui32Idx;
+
+    VFPUse(psMachine);
+
+    ui32Addr = VFPAddress(psMachine, psInsn, &ui32Final);
+    ThumbCheckAligned(psMachine, ui32Addr, 4);
+
+    for(ui32Idx = 0; ui32Idx < psInsn->ui8Ra; ui32Idx++)
+        ThumbStore(psMachine, ui32Addr + ui32Idx * 4, 4,
+                   psCpu->pui32S[(psInsn->ui8Rd + ui32Idx) & 31]);
+
+    if(psInsn->ui8Op & VFP_WRITEBACK)
+        psCpu->pui32R[psInsn->ui8Rn] = ui32Final;
+}
+
+/*****************************************************************************
+ *
+ * Decoder.
+ *
+ *****************************************************************************/
+
+static void
+VFPSet(tSimInsn *psInsn, tSimExec pfnExec, uint32_t ui32Rd, uint32_t ui32Rn,
+       uint32_t ui32Rm, uint32_t ui32Op)
+{
+    psInsn->pfnExec = pfnExec;
+    psInsn->ui8Rd = (uint8_t)ui32Rd;
+    psInsn->ui8Rn = (uint8_t)ui32Rn;
+    psInsn->ui8Rm = (uint8_t)ui32Rm;
+    psInsn->ui8Op = (uint8_t)ui32Op;
+}
+
+/*
+ * VFPExpandImm() for single precision.
+ */
+static uint32_t
+VFPExpandImm(uint32_t ui32Imm8)
+{
+    return(((ui32Imm8 & 0x80) << 24) |
+           ((ui32Imm8 & 0x40) ? 0x3E000000U : 0x40000000U) |
+           ((ui32Imm8 & 0x3F) << 19));
+}
+
+static bool
+VFPDecodeLoadStore(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+                   tSimInsn *psInsn)
+{
+    uint32_t ui32Op = (ui32Hw1 >> 4) & 0x1F, ui32Rn = ui32Hw1 & 0xF;
+    uint32_t ui32Imm8 = ui32Hw2 & 0xFF, ui32Vd = (ui32Hw2 >> 12) & 0xF;
+    uint32_t ui32D = (ui32Hw1 >> 6) & 1, ui32First, ui32Words;
+    bool bDouble = (ui32Hw2 >> 8) & 1, bLoad = ui32Op & 1;
+
+    ui32First = bDouble ? ((ui32D << 4) | ui32Vd) * 2 : (ui32Vd << 1) | ui32D;
+
+    if(bDouble && ui32D)
+        return(false);
+
+    VFPSet(psInsn, bLoad ? ExecVLDM : ExecVSTM, ui32First, ui32Rn, 0, 0);
+
+    /*
+     * VLDR and VSTR.
+     */
+    if((ui32Op & 0x13) == 0x10 || (ui32Op & 0x13) == 0x11)
+    {
+        psInsn->ui8Ra = bDouble ? 2 : 1;
+        psInsn->ui8Op = VFP_INDEX;
+        psInsn->ui32Imm = (ui32Hw1 & 0x80) ? ui32Imm8 * 4 : -(ui32Imm8 * 4);
+
+        if(ui32Rn == 15)
+        {
+            if(!bLoad)
+                return(false);
+
+            psInsn->ui8Rn = SIM_CPU_REG_ZERO;
+            psInsn->ui32Imm += (ui32PC + 4) & ~3U;
+        }
+
+        return(true);
+    }
+
+    /*
+     * VLDM and VSTM: increment after (P = 0, U = 1) or decrement before with
+     * writeback (P = 1, U = 0, W = 1).
+     */
+    ui32Words = bDouble ? ui32Imm8 & ~1U : ui32Imm8;
+
+    if(!ui32Words || (ui32First + ui32Words > 32) || (ui32Rn == 15))
+        return(false);
+
+    psInsn->ui8Ra = (uint8_t)ui32Words;
+
+    switch(ui32Op & 0x18)
+    {
+        case 0x08:
+            psInsn->ui8Op = (ui32Op & 2) ? VFP_WRITEBACK : 0;
+            return(true);
+
+        case 0x10:
+            psInsn->ui8Op = VFP_DECREMENT | VFP_WRITEBACK;
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+static bool
+VFPDecodeDataProcessing(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn)
+{
+    uint32_t ui32Opc1 = ((ui32Hw1 >> 5) & 4) | ((ui32Hw1 >> 4) & 3);
+    uint32_t ui32Opc2 = ui32Hw1 & 0xF, ui32Op = (ui32Hw2 >> 6) & 1;
+    uint32_t ui32Sd = (((ui32Hw2 >> 12) & 0xF) << 1) | ((ui32Hw1 >> 6) & 1);
+    uint32_t ui32Sn = (ui32Opc2 << 1) | ((ui32Hw2 >> 7) & 1);
+    uint32_t ui32Sm = ((ui32Hw2 & 0xF) << 1) | ((ui32Hw2 >> 5) & 1);
+
+    /*
+     * Double precision is not implemented by the FPv4-SP.
+     */
+    if(ui32Hw2 & 0x100)
+        return(false);
+
+    switch(ui32Opc1)
+    {
+        case 0:
+            VFPSet(psInsn, ExecVArith, ui32Sd, ui32Sn, ui32Sm,
+                   ui32Op ? VFP_VMLS : VFP_VMLA);
+            return(true);
+
+        case 1:
+            VFPSet(psInsn, ExecVArith, ui32Sd, ui32Sn, ui32Sm,
+                   ui32Op ? VFP_VNMLA : VFP_VNMLS);
+            return(true);
+
+        case 2:
+            VFPSet(psInsn, ExecVArith, ui32Sd, ui32Sn, ui32Sm,
+                   ui32Op ? VFP_VNMUL : VFP_VMUL);
+            return(true);
+
+        case 3:
+            VFPSet(psInsn, ExecVArith, ui32Sd, ui32Sn, ui32Sm,
+                   ui32Op ? VFP_VSUB : VFP_VADD);
+            return(true);
+
+        case 4:
+            if(ui32Op)
+                return(false);
+
+            VFPSet(psInsn, ExecVArith, ui32Sd, ui32Sn, ui32Sm, VFP_VDIV);
+            return(true);
+
+        case 5:
+            VFPSet(psInsn, ExecVArith, ui32Sd, ui32Sn, ui32Sm,
+                   ui32Op ? VFP_VFNMA : VFP_VFNMS);
+            return(true);
+
+        case 6:
+            VFPSet(psInsn, ExecVArith, ui32Sd, ui32Sn, ui32Sm,
+                   ui32Op ? VFP_VFMS : VFP_VFMA);
+            return(true);
+
+        default:
+            break;
+    }
+
+    if(!ui32Op)
+    {
+        VFPSet(psInsn, ExecVMOVImm, ui32Sd, 0, 0, 0);
+        psInsn->ui32Imm = VFPExpandImm((ui32Opc2 << 4) | (ui32Hw2 & 0xF));
+        return(true);
+    }
+
+    switch(ui32Opc2)
+    {
+        case 0x0:
+            VFPSet(psInsn, ExecVUnary, ui32Sd, 0, ui32Sm,
+                   (ui32Hw2 & 0x80) ? VFP_VABS : VFP_VMOV);
+            return(true);
+
+        case 0x1:
+            VFPSet(psInsn, ExecVUnary, ui32Sd, 0, ui32Sm,
+                   (ui32Hw2 & 0x80) ? VFP_VSQRT : VFP_VNEG);
+            return(true);
+
+        case 0x2:
+        case 0x3:
+            VFPSet(psInsn, ExecVCVTHalf, ui32Sd, 0, ui32Sm, ui32Opc2 & 1);
+            psInsn->ui8Shift = (ui32Hw2 & 0x80) ? 16 : 0;
+            return(true);
+
+        case 0x4:
+        case 0x5:
+            VFPSet(psInsn, ExecVCMP, ui32Sd, 0,
+                   (ui32Opc2 & 1) ? 0xFF : ui32Sm, (ui32Hw2 >> 7) & 1);
+            return(true);
+
+        case 0x8:
+            VFPSet(psInsn, ExecVCVT, ui32Sd, 0, ui32Sm,
+                   (ui32Hw2 & 0x80) ? VCVT_SIGNED : 0);
+            return(true);
+
+        case 0xA:
+        case 0xB:
+        case 0xE:
+        case 0xF:
+        {
+            /*
+             * Fixed point, converted in place.
+             */
+            uint32_t ui32Size = (ui32Hw2 & 0x80) ? 32 : 16;
+            uint32_t ui32Imm5 = ((ui32Hw2 & 0xF) << 1) | ((ui32Hw2 >> 5) & 1);
+
+            if(ui32Imm5 > ui32Size)
+                return(false);
+
+            VFPSet(psInsn, ExecVCVT, ui32Sd, 0, ui32Sd,
+                   ((ui32Opc2 & 4) ? VCVT_TO_INT | VCVT_TRUNCATE : 0) |
+                   ((ui32Opc2 & 1) ? 0 : VCVT_SIGNED) |
+                   ((ui32Size == 16) ? VCVT_HALF : 0));
+            psInsn->ui32Imm = ui32Size - ui32Imm5;
+            return(true);
+        }
+
+        case 0xC:
+        case 0xD:
+            VFPSet(psInsn, ExecVCVT, ui32Sd, 0, ui32Sm,
+                   VCVT_TO_INT | ((ui32Opc2 & 1) ? VCVT_SIGNED : 0) |
+                   ((ui32Hw2 & 0x80) ? VCVT_TRUNCATE : 0));
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+static bool
+VFPDecodeTransfer(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn)
+{
+    uint32_t ui32A = (ui32Hw1 >> 5) & 7, ui32Rt = (ui32Hw2 >> 12) & 0xF;
+    bool bToCore = (ui32Hw1 >> 4) & 1;
+    uint32_t ui32Sn;
+
+    if(!(ui32Hw2 & 0x100))
+    {
+        if(ui32A == 0)
+        {
+            ui32Sn = ((ui32Hw1 & 0xF) << 1) | ((ui32Hw2 >> 7) & 1);
+            VFPSet(psInsn, bToCore ? ExecVMOVToCore : ExecVMOVFromCore,
+                   ui32Rt, ui32Sn, 0, 0);
+            return(true);
+        }
+
+        if((ui32A == 7) && ((ui32Hw1 & 0xF) == 1))
+        {
+            VFPSet(psInsn, bToCore ? ExecVMRS : ExecVMSR, ui32Rt, 0, 0, 0);
+            return(bToCore || (ui32Rt != 15));
+        }
+
+        return(false);
+    }
+
+    /*
+     * VMOV between a core register and half of a double-precision register.
+     */
+    if(((ui32A & 6) != 0) || (ui32Hw2 & 0x60) || (ui32Hw2 & 0x80))
+        return(false);
+
+    ui32Sn = (ui32Hw1 & 0xF) * 2 + (ui32A & 1);
+    VFPSet(psInsn, bToCore ? ExecVMOVToCore : ExecVMOVFromCore, ui32Rt,
+           ui32Sn, 0, 0);
+    return(true);
+}
+
+static bool
+VFPDecodeTransfer64(uint32_t ui32Hw1, uint32_t ui32Hw2, tSimInsn *psInsn)
+{
+    uint32_t ui32Vm = ui32Hw2 & 0xF, ui32M = (ui32Hw2 >> 5) & 1, ui32Sm;
+    bool bToCore = (ui32Hw1 >> 4) & 1;
+
+    if((ui32Hw2 & 0xD0) != 0x10)
+        return(false);
+
+    if(ui32Hw2 & 0x100)
+    {
+        if(ui32M)
+            return(false);
+
+        ui32Sm = ui32Vm * 2;
+    }
+    else
+    {
+        ui32Sm = (ui32Vm << 1) | ui32M;
+
+        if(ui32Sm == 31)
+            return(false);
+    }
+
+    VFPSet(psInsn, bToCore ? ExecVMOV2ToCore : ExecVMOV2FromCore,
+           (ui32Hw2 >> 12) & 0xF, ui32Sm, 0, 0);
+    psInsn->ui8Ra = ui32Hw1 & 0xF;
+    return(true);
+}
+
+/*
+ * Decodes a coprocessor instruction for coprocessors 10 and 11.
+ */
+bool
+SimVFPDecode(uint32_t ui32PC, uint32_t ui32Hw1, uint32_t ui32Hw2,
+             tSimInsn *psInsn)
+{
+    uint32_t ui32Op1 = (ui32Hw1 >> 4) & 0x3F;
+
+    /*
+     * The unconditional (0xFxxx) forms are Advanced SIMD, not present.
+     */
+    if(ui32Hw1 & 0x1000)
+        return(false);
+
+    if((ui32Op1 & 0x3E) == 0x04)
+        return(VFPDecodeTransfer64(ui32Hw1, ui32Hw2, psInsn));
+
+    if(!(ui32Op1 & 0x20))
+    {
+        if(!(ui32Op1 & 0x3A))
+            return(false);
+
+        return(VFPDecodeLoadStore(ui32PC, ui32Hw1, ui32Hw2, psInsn));
+    }
+
+    if((ui32Op1 & 0x30) != 0x20)
+        return(false);
+
+    if(!(ui32Hw2 & 0x10))
+        return(VFPDecodeDataProcessing(ui32Hw1, ui32Hw2, psInsn));
+
+    return(VFPDecodeTransfer(ui32Hw1, ui32Hw2, psInsn));
+}
+
+/*
+ * Returns the issue cycles of a floating-point instruction on the
+ * Cortex-M4F as for tSimInsn.ui8Cycles, or zero for other instructions.
+ */
+uint32_t
+SimVFPCycles(const tSimInsn *psInsn)
+{
+    if(psInsn->pfnExec == ExecVArith)
+    {
+        if(psInsn->ui8Op == VFP_VDIV)
+            return(14);
+
+        if((psInsn->ui8Op == VFP_VMUL) || (psInsn->ui8Op == VFP_VNMUL) ||
+           (psInsn->ui8Op == VFP_VADD) || (psInsn->ui8Op == VFP_VSUB))
+            return(1);
+
+        return(3);
+    }
+
+    if(psInsn->pfnExec == ExecVUnary)
+        return((psInsn->ui8Op == VFP_VSQRT) ? 14 : 1);
+
+    if((psInsn->pfnExec == ExecVLDM) &&
+       (psInsn->ui8Rn == SIM_CPU_REG_ZERO) &&
+       (psInsn->ui32Imm < SIM_FLASH_BASE + SIM_FLASH_SIZE))
+        return((1 + psInsn->ui8Ra) | SIM_CPU_CYCLES_FLASH);
+
+    if((psInsn->pfnExec == ExecVLDM) || (psInsn->pfnExec == ExecVSTM))
+        return(1 + psInsn->ui8Ra);
+
+    if((psInsn->pfnExec == ExecVMOV2ToCore) ||
+       (psInsn->pfnExec == ExecVMOV2FromCore))
+        return(2);
+
+    if((psInsn->pfnExec == ExecVCMP) || (psInsn->pfnExec == ExecVCVT) ||
+       (psInsn->pfnExec == ExecVCVTHalf) || (psInsn->pfnExec == ExecVMOVImm) ||
+       (psInsn->pfnExec == ExecVMOVToCore) ||
+       (psInsn->pfnExec == ExecVMOVFromCore) ||
+       (psInsn->pfnExec == ExecVMRS) || (psInsn->pfnExec == ExecVMSR))
+        return(1);
+
+    return(0);
+}
@@ -0,0 +1,529 @@
+/*
+ * Waveform capture to VCD (see wave.h).
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+#include "pool.h"
+#include "wave.h"
+
+/*
+ * Text is handed to the compressors in chunks of WAVE_CHUNK_SIZE bytes.  A
+ * chunk is passed on once less than WAVE_CHANGE_MAX, the most one change can
+ * add, is left in it.
+ */
+#define WAVE_CHUNK_SIZE         (1024 * 1024)
+#define WAVE_CHANGE_MAX         (24 + 8 * 3)
+#define WAVE_MAX_COMPRESSORS    8
+#define WAVE_CHUNKS             (2 * WAVE_MAX_COMPRESSORS + 2)
+
+/*
+ * How long the writer thread sleeps when the ring is empty.
+ */
+#define WAVE_IDLE_NS            1000000
+
+/*
+ * Identifier of pin n of port p in the VCD file: one printable character.
+ */
+#define WAVE_ID(p, n)           ((char)('!' + (p) * 8 + (n)))
+
+typedef struct
+{
+    char *pcText;
+    uint32_t ui32Len;
+    uint8_t *pui8Out;
+    uint32_t ui32Out;
+    bool bReady;
+} tWaveChunk;
+
+struct tSimWaveWriter
+{
+    tSimWave *psWave;
+    FILE *psFile;
+    bool bCompress;
+    bool bError;
+    bool bStop;
+    pthread_t sThread;
+
+    /*
+     * Levels last written, the time of the last change, and the chunk being
+     * filled.
+     */
+    uint8_t pui8Level[SIM_GPIO_PORTS];
+    uint64_t ui64Time;
+    uint64_t ui64Edges;
+    tWaveChunk *psChunk;
+
+    /*
+     * Chunk n is in slot n % WAVE_CHUNKS.  Chunks before ui64Filled have
+     * been filled, those before ui64Taken taken by a compressor and those
+     * before ui64Written written to the file.
+     */
+    tWaveChunk psChunks[WAVE_CHUNKS];
+    uint64_t ui64Filled;
+    uint64_t ui64Taken;
+    uint64_t ui64Written;
+    bool bDone;
+    pthread_mutex_t sLock;
+    pthread_cond_t sCond;
+    pthread_t psCompressors[WAVE_MAX_COMPRESSORS];
+    uint32_t ui32Compressors;
+};
+
+static void
+WaveWrite(tSimWaveWriter *psWriter, const void *pvData, size_t szData)
+{
+    if(szData && (fwrite(pvData, 1, szData, psWriter->psFile) != szData))
+        psWriter->bError = true;
+}
+
+/*
+ * Writes the chunks that are ready, in order.  Called with the lock held.
+ */
+static void
+WaveWriteReady(tSimWaveWriter *psWriter)
+{
+    tWaveChunk *psChunk;
+
+    while(psWriter->ui64Written < psWriter->ui64Taken)
+    {
+        psChunk = &psWriter->psChunks[psWriter->ui64Written % WAVE_CHUNKS];
+
+        if(!psChunk->bReady)
+            break;
+
+        WaveWrite(psWriter, psChunk->pui8Out, psChunk->ui32Out);
+        psChunk->bReady = false;
+        psWriter->ui64Written++;
+    }
+
+    pthread_cond_broadcast(&psWriter->sCond);
+}
+
+static void *
+WaveCompressor(void *pvArg)
+{
+    tSimWaveWriter *psWriter = pvArg;
+    tWaveChunk *psChunk;
+    z_stream sStream;
+
+    memset(&sStream, 0, sizeof(sStream));
+
+    /*
+     * Level 1 keeps up best and still shrinks the regular text of a VCD file
+     * many times over.  15 + 16 asks for a gzip wrapper.
+     */
+    if(deflateInit2(&sStream, 1, Z_DEFLATED, 15 + 16, 8,
+                    Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        pthread_mutex_lock(&psWriter->sLock);
+        psWriter->bError = true;
+        pthread_mutex_unlock(&psWriter->sLock);
+        return(NULL);
+    }
+
+    pthread_mutex_lock(&psWriter->sLock);
+
+    for(;;)
+    {
+        while((psWriter->ui64Taken == psWriter->ui64Filled) &&
+              !psWriter->bDone)
+            pthread_cond_wait(&psWriter->sCond, &psWriter->sLock);
+
+        if(psWriter->ui64Taken == psWriter->ui64Filled)
+            break;
+
+        psChunk = &psWriter->psChunks[psWriter->ui64Taken++ % WAVE_CHUNKS];
+
+        pthread_mutex_unlock(&psWriter->sLock);
+
+        deflateReset(&sStream);
+        sStream.next_in = (Bytef *)psChunk->pcText;
+        sStream.avail_in = psChunk->ui32Len;
+        sStream.next_out = psChunk->pui8Out;
+        sStream.avail_out = compressBound(WAVE_CHUNK_SIZE) + 64;
+
+        if(deflate(&sStream, Z_FINISH) != Z_STREAM_END)
+            psWriter->bError = true;
+
+        psChunk->ui32Out = (uint32_t)sStream.total_out;
+
+        pthread_mutex_lock(&psWriter->sLock);
+
+        psChunk->bReady = true;
+        WaveWriteReady(psWriter);
+    }
+
+    pthread_mutex_unlock(&psWriter->sLock);
+    deflateEnd(&sStream);
+
+    return(NULL);
+}
+
+/*
+ * Passes the chunk being filled on and starts on the next one.
+ */
+static void
+WaveSubmit(tSimWaveWriter *psWriter)
+{
+    if(!psWriter->bCompress)
+    {
+        WaveWrite(psWriter, psWriter->psChunk->pcText,
+                  psWriter->psChunk->ui32Len);
+        psWriter->psChunk->ui32Len = 0;
+        return;
+    }
+
+    pthread_mutex_lock(&psWriter->sLock);
+
+    psWriter->ui64Filled++;
+    pthread_cond_broadcast(&psWriter->sCond);
+
+    while(psWriter->ui64Filled >= psWriter->ui64Written + WAVE_CHUNKS)
+        pthread_cond_wait(&psWriter->sCond, &psWriter->sLock);
+
+    psWriter->psChunk = &psWriter->psChunks[psWriter->ui64Filled %
+                                            WAVE_CHUNKS];
+
+    pthread_mutex_unlock(&psWriter->sLock);
+
+    psWriter->psChunk->ui32Len = 0;
+}
+
+static void
+WaveTime(tSimWaveWriter *psWriter, uint64_t ui64Time)
+{
+    tWaveChunk *psChunk = psWriter->psChunk;
+    char pcDigits[20];
+    uint32_t ui32Count = 0;
+
+    do
+    {
+        pcDigits[ui32Count++] = (char)('0' + ui64Time % 10);
+        ui64Time /= 10;
+    }
+    while(ui64Time);
+
+    psChunk->pcText[psChunk->ui32Len++] = '#';
+
+    while(ui32Count)
+        psChunk->pcText[psChunk->ui32Len++] = pcDigits[--ui32Count];
+
+    psChunk->pcText[psChunk->ui32Len++] = '\n';
+}
+
+/*
+ * Writes the pins of a port that changed.
+ */
+static void
+WaveChange(tSimWaveWriter *psWriter, const tSimWaveChange *psChange)
+{
+    uint8_t ui8Changed;
+    uint32_t ui32Pin;
+    char *pcOut;
+
+    ui8Changed = psWriter->pui8Level[psChange->ui8Port] ^ psChange->ui8Level;
+
+    if(!ui8Changed)
+        return;
+
+    if(psWriter->psChunk->ui32Len > WAVE_CHUNK_SIZE - WAVE_CHANGE_MAX)
+        WaveSubmit(psWriter);
+
+    if(psChange->ui64Time != psWriter->ui64Time)
+    {
+        WaveTime(psWriter, psChange->ui64Time);
+        psWriter->ui64Time = psChange->ui64Time;
+    }
+
+    pcOut = psWriter->psChunk->pcText + psWriter->psChunk->ui32Len;
+
+    for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+    {
+        if(!((ui8Changed >> ui32Pin) & 1))
+            continue;
+
+        *pcOut++ = ((psChange->ui8Level >> ui32Pin) & 1) ? '1' : '0';
+        *pcOut++ = WAVE_ID(psChange->ui8Port, ui32Pin);
+        *pcOut++ = '\n';
+        psWriter->ui64Edges++;
+    }
+
+    psWriter->psChunk->ui32Len = (uint32_t)(pcOut -
+                                            psWriter->psChunk->pcText);
+    psWriter->pui8Level[psChange->ui8Port] = psChange->ui8Level;
+}
+
+static void
+WaveDrain(tSimWaveWriter *psWriter)
+{
+    tSimWave *psWave = psWriter->psWave;
+    uint32_t ui32Tail = psWave->ui32Tail, ui32Head;
+
+    ui32Head = __atomic_load_n(&psWave->ui32Head, __ATOMIC_ACQUIRE);
+
+    while(ui32Tail != ui32Head)
+    {
+        WaveChange(psWriter, &psWave->psRing[ui32Tail % SIM_WAVE_RING_SIZE]);
+
+        /*
+         * Hand the slots back in batches, so the simulation thread does not
+         * see the tail move on every change.
+         */
+        if(!(++ui32Tail % 256))
+            __atomic_store_n(&psWave->ui32Tail, ui32Tail, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&psWave->ui32Tail, ui32Tail, __ATOMIC_RELEASE);
+}
+
+static void *
+WaveWriter(void *pvArg)
+{
+    static const struct timespec sIdle = { 0, WAVE_IDLE_NS };
+    tSimWaveWriter *psWriter = pvArg;
+    tSimWave *psWave = psWriter->psWave;
+    bool bStop;
+
+    do
+    {
+        bStop = __atomic_load_n(&psWriter->bStop, __ATOMIC_ACQUIRE);
+
+        if(psWave->ui32Tail ==
+           __atomic_load_n(&psWave->ui32Head, __ATOMIC_ACQUIRE))
+            nanosleep(&sIdle, NULL);
+        else
+            WaveDrain(psWriter);
+    }
+    while(!bStop);
+
+    /*
+     * Changes made before the stop was seen.
+     */
+    WaveDrain(psWriter);
+
+    return(NULL);
+}
+
+/*
+ * Writes the header, declaring one wire per pin, all low at time zero.
+ */
+static void
+WaveHeader(tSimWaveWriter *psWriter)
+{
+    uint32_t ui32Port, ui32Pin;
+    char *pcOut = psWriter->psChunk->pcText;
+    time_t sNow = time(NULL);
+
+    pcOut += sprintf(pcOut, "$date %.24s $end\n"
+                     "$version TM4C123GH6PM simulator $end\n"
+                     "$timescale 1ps $end\n"
+                     "$scope module tm4c123gh6pm $end\n", ctime(&sNow));
+
+    for(ui32Port = 0; ui32Port < SIM_GPIO_PORTS; ui32Port++)
+    {
+        pcOut += sprintf(pcOut, "$scope module GPIO%c $end\n", 'A' + ui32Port);
+
+        for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+            pcOut += sprintf(pcOut, "$var wire 1 %c P%c%u $end\n",
+                             WAVE_ID(ui32Port, ui32Pin), 'A' + ui32Port,
+                             ui32Pin);
+
+        pcOut += sprintf(pcOut, "$upscope $end\n");
+    }
+
+    pcOut += sprintf(pcOut, "$upscope $end\n$enddefinitions $end\n"
+                     "#0\n$dumpvars\n");
+
+    for(ui32Port = 0; ui32Port < SIM_GPIO_PORTS; ui32Port++)
+        for(ui32Pin = 0; ui32Pin < 8; ui32Pin++)
+            pcOut += sprintf(pcOut, "0%c\n", WAVE_ID(ui32Port, ui32Pin));
+
+    pcOut += sprintf(pcOut, "$end\n");
+
+    psWriter->psChunk->ui32Len = (uint32_t)(pcOut -
+                                            psWriter->psChunk->pcText);
+}
+
+/*
+ * Writes out the chunk being filled and waits for the compressors to finish
+ * the rest.
+ */
+static void
+WaveFinish(tSimWaveWriter *psWriter)
+{
+    uint32_t ui32Thread;
+
+    if(!psWriter->bCompress)
+    {
+        WaveSubmit(psWriter);
+        return;
+    }
+
+    pthread_mutex_lock(&psWriter->sLock);
+
+    if(psWriter->psChunk->ui32Len)
+        psWriter->ui64Filled++;
+
+    psWriter->bDone = true;
+    pthread_cond_broadcast(&psWriter->sCond);
+    pthread_mutex_unlock(&psWriter->sLock);
+
+    for(ui32Thread = 0; ui32Thread < psWriter->ui32Compressors; ui32Thread++)
+        pthread_join(psWriter->psCompressors[ui32Thread], NULL);
+
+    /*
+     * Without compressors nothing was written.
+     */
+    if(!psWriter->ui32Compressors)
+        psWriter->bError = true;
+}
+
+static void
+WaveFree(tSimWave *psWave)
+{
+    tSimWaveWriter *psWriter = psWave->psWriter;
+    uint32_t ui32Chunk;
+
+    if(psWriter)
+    {
+        for(ui32Chunk = 0; ui32Chunk < WAVE_CHUNKS; ui32Chunk++)
+        {
+            free(psWriter->psChunks[ui32Chunk].pcText);
+            free(psWriter->psChunks[ui32Chunk].pui8Out);
+        }
+
+        if(psWriter->psFile)
+            fclose(psWriter->psFile);
+
+        pthread_mutex_destroy(&psWriter->sLock);
+        pthread_cond_destroy(&psWriter->sCond);
+        free(psWriter);
+    }
+
+    free(psWave->psRing);
+    free(psWave);
+}
+
+/*
+ * Opens a waveform file and starts its writer thread and, for a .gz file,
+ * one compressor thread for every host core the simulation and the writer
+ * leave free.  Returns NULL if the file cannot be created.
+ */
+tSimWave *
+SimWaveOpen(const char *pcPath)
+{
+    size_t szPath = strlen(pcPath);
+    tSimWaveWriter *psWriter;
+    uint32_t ui32Chunk, ui32Cores;
+    tWaveChunk *psChunk;
+    tSimWave *psWave;
+
+    psWave = aligned_alloc(64, (sizeof(tSimWave) + 63) & ~(size_t)63);
+
+    if(!psWave)
+        return(NULL);
+
+    memset(psWave, 0, sizeof(*psWave));
+    psWave->psRing = malloc(SIM_WAVE_RING_SIZE * sizeof(tSimWaveChange));
+    psWave->psWriter = psWriter = calloc(1, sizeof(*psWriter));
+
+    if(!psWave->psRing || !psWriter)
+    {
+        WaveFree(psWave);
+        return(NULL);
+    }
+
+    psWriter->psWave = psWave;
+    psWriter->bCompress = (szPath > 3) && !strcmp(pcPath + szPath - 3, ".gz");
+    pthread_mutex_init(&psWriter->sLock, NULL);
+    pthread_cond_init(&psWriter->sCond, NULL);
+
+    for(ui32Chunk = 0; ui32Chunk < (psWriter->bCompress ? WAVE_CHUNKS : 1);
+        ui32Chunk++)
+    {
+        psChunk = &psWriter->psChunks[ui32Chunk];
+        psChunk->pcText = malloc(WAVE_CHUNK_SIZE);
+
+        if(psWriter->bCompress)
+            psChunk->pui8Out = malloc(compressBound(WAVE_CHUNK_SIZE) + 64);
+
+        if(!psChunk->pcText || (psWriter->bCompress && !psChunk->pui8Out))
+        {
+            WaveFree(psWave);
+            return(NULL);
+        }
+    }
+
+    psWriter->psChunk = &psWriter->psChunks[0];
+    psWriter->psFile = fopen(pcPath, "wb");
+
+    if(!psWriter->psFile)
+    {
+        WaveFree(psWave);
+        return(NULL);
+    }
+
+    WaveHeader(psWriter);
+
+    if(psWriter->bCompress)
+    {
+        ui32Cores = SimPoolCores();
+        ui32Cores = (ui32Cores > 2) ? ui32Cores - 2 : 1;
+
+        while((psWriter->ui32Compressors < ui32Cores) &&
+              (psWriter->ui32Compressors < WAVE_MAX_COMPRESSORS) &&
+              !pthread_create(&psWriter->psCompressors[
+                                  psWriter->ui32Compressors],
+                              NULL, WaveCompressor, psWriter))
+            psWriter->ui32Compressors++;
+    }
+
+    if((psWriter->bCompress && !psWriter->ui32Compressors) ||
+       pthread_create(&psWriter->sThread, NULL, WaveWriter, psWriter))
+    {
+        WaveFinish(psWriter);
+        WaveFree(psWave);
+        return(NULL);
+    }
+
+    return(psWave);
+}
+
+/*
+ * Writes the changes still in the ring, ends the waveform at time ui64Time
+ * and closes the file.  Returns false if anything could not be written.
+ */
+bool
+SimWaveClose(tSimWave *psWave, uint64_t ui64Time, uint64_t *pui64Edges)
+{
+    tSimWaveWriter *psWriter = psWave->psWriter;
+    bool bOk;
+
+    __atomic_store_n(&psWriter->bStop, true, __ATOMIC_RELEASE);
+    pthread_join(psWriter->sThread, NULL);
+
+    if(ui64Time > psWriter->ui64Time)
+    {
+        if(psWriter->psChunk->ui32Len > WAVE_CHUNK_SIZE - WAVE_CHANGE_MAX)
+            WaveSubmit(psWriter);
+
+        WaveTime(psWriter, ui64Time);
+    }
+
+    WaveFinish(psWriter);
+
+    bOk = !psWriter->bError && !fclose(psWriter->psFile);
+    psWriter->psFile = NULL;
+
+    if(pui64Edges)
+        *pui64Edges = psWriter->ui64Edges;
+
+    WaveFree(psWave);
+
+    return(bOk);
+}
@@ -0,0 +1,82 @@
+#ifndef __SIM_WAVE_H__
+#define __SIM_WAVE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sched.h>
+
+#include "gpio.h"
+
+/*
+ * Waveform capture of the GPIO pins to a VCD file, which GTKWave, Surfer and
+ * the other waveform viewers open directly.  A path ending in .gz is written
+ * gzip compressed, which GTKWave also reads (vcd2fst, shipped with GTKWave,
+ * turns either into FST).
+ *
+ * The simulation thread only puts the new level of a port into a
+ * single-producer, single-consumer ring.  A writer thread of its own turns
+ * the changes into text, in chunks that compressor threads deflate in
+ * parallel into gzip members of their own; concatenated in order, they make
+ * up one gzip file.  If the writer falls a whole ring behind, the simulation
+ * waits for it rather than lose edges.
+ *
+ * Times are in picoseconds of simulated time, which is a whole number of
+ * cycles at every system clock frequency.
+ */
+#define SIM_WAVE_RING_SIZE      65536
+
+typedef struct
+{
+    uint64_t ui64Time;
+    uint8_t ui8Port;
+    uint8_t ui8Level;
+} tSimWaveChange;
+
+typedef struct tSimWaveWriter tSimWaveWriter;
+
+typedef struct
+{
+    /*
+     * Written by the simulation thread.
+     */
+    uint32_t ui32Head __attribute__((aligned(64)));
+    uint64_t ui64Stalls;
+
+    /*
+     * Written by the writer thread.
+     */
+    uint32_t ui32Tail __attribute__((aligned(64)));
+
+    tSimWaveChange *psRing;
+    tSimWaveWriter *psWriter;
+} tSimWave;
+
+tSimWave *SimWaveOpen(const char *pcPath);
+bool SimWaveClose(tSimWave *psWave, uint64_t ui64Time, uint64_t *pui64Edges);
+
+/*
+ * Records the level of a port at simulated time ui64Time.
+ */
+static inline void
+SimWaveChange(tSimWave *psWave, uint64_t ui64Time, uint32_t ui32Port,
+              uint8_t ui8Level)
+{
+    uint32_t ui32Head = psWave->ui32Head;
+    tSimWaveChange *psChange;
+
+    while(ui32Head - __atomic_load_n(&psWave->ui32Tail, __ATOMIC_ACQUIRE) ==
+          SIM_WAVE_RING_SIZE)
+    {
+        psWave->ui64Stalls++;
+        sched_yield();
+    }
+
+    psChange = &psWave->psRing[ui32Head % SIM_WAVE_RING_SIZE];
+    psChange->ui64Time = ui64Time;
+    psChange->ui8Port = (uint8_t)ui32Port;
+    psChange->ui8Level = ui8Level;
+
+    __atomic_store_n(&psWave->ui32Head, ui32Head + 1, __ATOMIC_RELEASE);
+}
+
+#endif
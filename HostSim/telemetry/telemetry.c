@@ -0,0 +1,157 @@
+/*
+ * Decodes the telemetry frames a firmware built with UART_TELEMETRY sends
+ * over a UART (see uarttelemetry.h of the CCS projects), from a capture file
+ * or the standard input.
+ *
+ * Every frame is printed on a line of its own, its sequence number and
+ * channel followed by its data, as bytes in hex or, for the channels given
+ * with --u16 or --u32, as little-endian unsigned words in decimal, which is
+ * how the Potentiometer firmware sends its samples and counters.  With
+ * --quiet only the counts of frames, frames lost and bad frames are printed,
+ * on the standard error as they always are.
+ */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../sim/telemetry.h"
+
+/*
+ * How the data of each channel is printed: bytes, or words of two or four
+ * bytes.
+ */
+typedef struct
+{
+    uint8_t pui8Width[256];
+    bool bQuiet;
+} tTelemetryOutput;
+
+static void
+TelemetryPrint(void *pvContext, const tSimTelemetryFrame *psFrame)
+{
+    const tTelemetryOutput *psOutput = pvContext;
+    uint32_t ui32Width = psOutput->pui8Width[psFrame->ui8Channel];
+    const uint8_t *pui8Data = psFrame->pui8Data;
+    uint32_t ui32Idx, ui32Value;
+
+    if(psOutput->bQuiet)
+        return;
+
+    printf("%5u %3u:", psFrame->ui16Seq, psFrame->ui8Channel);
+
+    for(ui32Idx = 0; ui32Idx + ui32Width <= psFrame->ui32Len;
+        ui32Idx += ui32Width)
+    {
+        ui32Value = pui8Data[ui32Idx];
+
+        if(ui32Width == 1)
+        {
+            printf(" %02x", ui32Value);
+            continue;
+        }
+
+        ui32Value |= (uint32_t)pui8Data[ui32Idx + 1] << 8;
+
+        if(ui32Width == 4)
+            ui32Value |= ((uint32_t)pui8Data[ui32Idx + 2] << 16) |
+                         ((uint32_t)pui8Data[ui32Idx + 3] << 24);
+
+        printf(" %u", ui32Value);
+    }
+
+    /*
+     * Bytes left over from the last word.
+     */
+    for(; ui32Idx < psFrame->ui32Len; ui32Idx++)
+        printf(" %02x", pui8Data[ui32Idx]);
+
+    putchar('\n');
+}
+
+static void
+Usage(const char *pcName)
+{
+    fprintf(stderr, "Usage: %s [--u16 CHANNEL]... [--u32 CHANNEL]... "
+            "[--quiet] [capture]\n", pcName);
+    exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const struct option psOptions[] =
+    {
+        { "u16", required_argument, NULL, '2' },
+        { "u32", required_argument, NULL, '4' },
+        { "quiet", no_argument, NULL, 'q' },
+        { NULL, 0, NULL, 0 }
+    };
+    const tSimTelemetryStats *psStats;
+    tTelemetryOutput sOutput;
+    tSimTelemetry sTelemetry;
+    uint8_t pui8Buffer[65536];
+    FILE *psInput = stdin;
+    unsigned long ulChannel;
+    size_t szRead;
+    char *pcEnd;
+    int i32Opt;
+
+    memset(sOutput.pui8Width, 1, sizeof(sOutput.pui8Width));
+    sOutput.bQuiet = false;
+
+    while((i32Opt = getopt_long(argc, argv, "q", psOptions, NULL)) != -1)
+    {
+        switch(i32Opt)
+        {
+            case '2':
+            case '4':
+                ulChannel = strtoul(optarg, &pcEnd, 0);
+
+                if(*pcEnd || (ulChannel > 255))
+                    Usage(argv[0]);
+
+                sOutput.pui8Width[ulChannel] = (uint8_t)(i32Opt - '0');
+                break;
+
+            case 'q':
+                sOutput.bQuiet = true;
+                break;
+
+            default:
+                Usage(argv[0]);
+        }
+    }
+
+    if(optind < argc - 1)
+        Usage(argv[0]);
+
+    if((optind == argc - 1) && strcmp(argv[optind], "-") &&
+       !(psInput = fopen(argv[optind], "rb")))
+    {
+        fprintf(stderr, "%s: cannot open\n", argv[optind]);
+        return(1);
+    }
+
+    SimTelemetryInit(&sTelemetry, TelemetryPrint, &sOutput);
+
+    while((szRead = fread(pui8Buffer, 1, sizeof(pui8Buffer), psInput)) != 0)
+        SimTelemetryFeed(&sTelemetry, pui8Buffer, szRead);
+
+    fflush(stdout);
+
+    psStats = &sTelemetry.sStats;
+    fprintf(stderr, "%llu frames, %llu lost, %llu bad, %llu bytes skipped; "
+            "%llu of %llu bytes data\n",
+            (unsigned long long)psStats->ui64Frames,
+            (unsigned long long)psStats->ui64Lost,
+            (unsigned long long)psStats->ui64Bad,
+            (unsigned long long)psStats->ui64Skipped,
+            (unsigned long long)psStats->ui64DataBytes,
+            (unsigned long long)psStats->ui64Bytes);
+
+    if(psInput != stdin)
+        fclose(psInput);
+
+    return((psStats->ui64Lost || psStats->ui64Bad) ? 1 : 0);
+}
@@ -0,0 +1,171 @@
+/*
+ * Program run by the interpreter and by the translator in turn for the
+ * differential test of the instruction set simulator (see iss_diff.c).
+ *
+ * It mixes what the translator turns into host code, data processing with
+ * and without flags and direct branches, with what it leaves to the
+ * execution functions: loads and stores of every size to flash and SRAM,
+ * unaligned words across an SRAM page, stack and multiple transfers,
+ * shifted operands, multiplies and divides, IT blocks, calls and a
+ * peripheral register.  The loop runs on a xorshift generator so that every
+ * pass takes other paths, and ends in a loop of its own.
+ */
+    .syntax unified
+    .cpu cortex-m4
+    .thumb
+
+    .section .isr_vector,"a",%progbits
+    .word __stack_end__
+    .word Reset_Handler
+    .rept 14
+    .word Fault_Handler
+    .endr
+
+    .text
+
+    .thumb_func
+Fault_Handler:
+    bkpt #0
+    b Fault_Handler
+
+/*
+ * Adds the four words at r10 + r1 * 4 up into r0, post-incrementing.
+ */
+    .thumb_func
+Sum:
+    push {r4, lr}
+    add r4, r10, r1, lsl #2
+    ldr r3, [r4], #4
+    add r0, r0, r3
+    ldr r3, [r4], #4
+    eor r0, r0, r3
+    ldr r3, [r4], #4
+    sub r0, r0, r3
+    ldr r3, [r4]
+    ror r0, r0, #7
+    add r0, r0, r3
+    pop {r4, pc}
+
+    .thumb_func
+    .global Reset_Handler
+Reset_Handler:
+    /*
+     * RCGCGPIO, written and read back through the board.
+     */
+    ldr r0, =0x400FE608
+    movs r1, #0x20
+    str r1, [r0]
+    ldr r1, [r0]
+
+    ldr r9, =Table
+    ldr r10, =0x20002000
+    ldr r11, =0x20003FFC
+    ldr r0, =0x2545F491
+    movs r5, #0
+    movs r6, #0
+    movs r7, #0
+    mov r8, #3000
+
+Loop:
+    /*
+     * xorshift32
+     */
+    eor r0, r0, r0, lsl #13
+    eor r0, r0, r0, lsr #17
+    eor r0, r0, r0, lsl #5
+
+    /*
+     * A byte of the table in flash, and a word and a halfword into SRAM.
+     */
+    and r1, r0, #0xFC
+    ldrb r2, [r9, r1]
+    str r0, [r10, r1, lsl #2]
+    strh r0, [r10, r1]
+    ldrsh r3, [r10, r1]
+    ldrsb r4, [r10, r1]
+    add r5, r5, r3
+    subs r5, r5, r4
+
+    /*
+     * A word across the page boundary at r11 + 4.
+     */
+    str r0, [r11, #2]
+    ldr r3, [r11, #2]
+    ldrh r4, [r11, #4]
+    eors r3, r3, r4
+
+    /*
+     * 64-bit sum in r7:r6.
+     */
+    adds r6, r6, r3
+    adc r7, r7, #0
+
+    /*
+     * Multiplies and a divide by an odd divisor.
+     */
+    orr r2, r2, #1
+    mul r3, r3, r2
+    udiv r4, r0, r2
+    mls r4, r4, r2, r0
+    add r5, r5, r4
+    add r5, r5, r3
+
+    cmp r2, #0x80
+    ite hs
+    addhs r6, r6, #1
+    sublo r7, r7, #1
+    it lo
+    eorlo r5, r5, r2
+
+    /*
+     * Stack and multiple transfers.
+     */
+    push {r0-r3}
+    movs r0, #0
+    movs r3, #0
+    pop {r0-r3}
+    add r4, r10, #0x1000
+    stmia r4, {r0, r5, r6, r7}
+    ldmdb r4!, {r2, r3}
+    add r5, r5, r2
+
+    /*
+     * The sum of four words, called now and then.
+     */
+    tst r0, #0x300
+    bne 1f
+    push {r0}
+    bl Sum
+    mov r5, r0
+    pop {r0}
+1:
+    asrs r3, r5, #3
+    bmi 2f
+    lsls r3, r3, #2
+2:
+    bics r5, r5, r3
+    it eq
+    addeq r5, r5, r0
+
+    subs r8, r8, #1
+    bne Loop
+
+    /*
+     * The results, left in SRAM.
+     */
+    ldr r1, =0x20001000
+    stmia r1, {r0, r5, r6, r7}
+
+Done:
+    b Done
+
+    .ltorg
+
+    .section .rodata
+    .align 2
+Table:
+    .set n, 0
+    .rept 256
+    .byte (n * 167 + 13) & 0xFF
+    .set n, n + 1
+    .endr
@@ -0,0 +1,32 @@
+/*
+ * Format strings of deferred log records, in the .uartlog section as
+ * UARTlog() places them, for the test of the tm4c-log decoder on the
+ * records of golden/log.capture.
+ */
+    .syntax unified
+    .cpu cortex-m4
+    .thumb
+
+    .section .isr_vector,"a",%progbits
+    .word __stack_end__
+    .word Reset_Handler
+
+    .text
+    .thumb_func
+    .global Reset_Handler
+Reset_Handler:
+    b Reset_Handler
+
+    .section .rodata
+Name:
+    .asciz "potentiometer"
+
+    .section .uartlog,"a",%progbits
+Format0:
+    .asciz "---->> Enable GPIO F.\n"
+Format1:
+    .asciz "---->> Configured clock rate %d.\n"
+Format2:
+    .asciz "[%8s] %08x %5d\n"
+Format3:
+    .asciz "%c %u%% of %x\n"
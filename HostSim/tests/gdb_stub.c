@@ -0,0 +1,286 @@
+/*
+ * Smoke test of the GDB remote serial protocol stub: a client thread plays
+ * the part of gdb against a firmware image run by the stub, going through
+ * the packets of a short session, breakpoint, step, memory and register
+ * accesses, a watchpoint and the detach, and checks every reply.
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../sim/debug.h"
+#include "../sim/elf.h"
+#include "../sim/gdb.h"
+
+/*
+ * Cycles the firmware runs for, the session included.
+ */
+#define GDB_TEST_CYCLES         400000
+
+typedef struct
+{
+    uint16_t ui16Port;
+    uint32_t ui32Loop;
+    uint32_t ui32Vector;
+    uint32_t ui32Failures;
+} tGdbTest;
+
+/*
+ * The 32-bit word in the byte order of the target, as gdb sees it.
+ */
+static void
+GdbTestWord(char *pcHex, uint32_t ui32Word)
+{
+    snprintf(pcHex, 9, "%02x%02x%02x%02x", ui32Word & 0xFF,
+             (ui32Word >> 8) & 0xFF, (ui32Word >> 16) & 0xFF, ui32Word >> 24);
+}
+
+static bool
+GdbTestRecv(int i32Socket, char *pcByte)
+{
+    return(recv(i32Socket, pcByte, 1, 0) == 1);
+}
+
+/*
+ * Sends a packet and returns its reply in pcReply, acknowledging it.
+ */
+static bool
+GdbTestTransact(int i32Socket, const char *pcRequest, char *pcReply,
+                size_t szReply)
+{
+    char pcPacket[SIM_GDB_PACKET_SIZE + 8], cByte;
+    uint32_t ui32Sum = 0, ui32Len = 0;
+    const char *pcChar;
+    int i32Len;
+
+    for(pcChar = pcRequest; *pcChar; pcChar++)
+        ui32Sum += (uint8_t)*pcChar;
+
+    i32Len = snprintf(pcPacket, sizeof(pcPacket), "$%s#%02x", pcRequest,
+                      ui32Sum & 0xFF);
+
+    if(send(i32Socket, pcPacket, (size_t)i32Len, 0) != i32Len)
+        return(false);
+
+    /*
+     * The acknowledgement of the request, then the reply up to its
+     * checksum.
+     */
+    do
+    {
+        if(!GdbTestRecv(i32Socket, &cByte))
+            return(false);
+    }
+    while(cByte != '$');
+
+    ui32Sum = 0;
+
+    for(;;)
+    {
+        if(!GdbTestRecv(i32Socket, &cByte))
+            return(false);
+
+        if(cByte == '#')
+            break;
+
+        if(ui32Len < szReply - 1)
+            pcReply[ui32Len++] = cByte;
+
+        ui32Sum += (uint8_t)cByte;
+    }
+
+    pcReply[ui32Len] = '\0';
+
+    if(!GdbTestRecv(i32Socket, &pcPacket[0]) ||
+       !GdbTestRecv(i32Socket, &pcPacket[1]))
+        return(false);
+
+    pcPacket[2] = '\0';
+
+    if(strtoul(pcPacket, NULL, 16) != (ui32Sum & 0xFF))
+        return(false);
+
+    return(send(i32Socket, "+", 1, 0) == 1);
+}
+
+/*
+ * Sends a request and checks that the reply starts with pcExpect.
+ */
+static void
+GdbTestCheck(tGdbTest *psTest, int i32Socket, const char *pcRequest,
+             const char *pcExpect)
+{
+    char pcReply[SIM_GDB_PACKET_SIZE + 1];
+
+    if(!GdbTestTransact(i32Socket, pcRequest, pcReply, sizeof(pcReply)))
+    {
+        printf("%s: no reply\n", pcRequest);
+        psTest->ui32Failures++;
+    }
+    else if(strncmp(pcReply, pcExpect, strlen(pcExpect)))
+    {
+        printf("%s: replied %.60s, expected %s\n", pcRequest, pcReply,
+               pcExpect);
+        psTest->ui32Failures++;
+    }
+    else
+        printf("%s: %.60s\n", pcRequest, pcReply);
+}
+
+static void *
+GdbTestClient(void *pvTest)
+{
+    tGdbTest *psTest = pvTest;
+    struct sockaddr_in sAddr;
+    char pcRequest[64], pcExpect[64];
+    int i32Socket;
+
+    i32Socket = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&sAddr, 0, sizeof(sAddr));
+    sAddr.sin_family = AF_INET;
+    sAddr.sin_port = htons(psTest->ui16Port);
+    sAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if((i32Socket < 0) ||
+       connect(i32Socket, (struct sockaddr *)&sAddr, sizeof(sAddr)))
+    {
+        printf("cannot connect\n");
+        psTest->ui32Failures++;
+        return(NULL);
+    }
+
+    GdbTestCheck(psTest, i32Socket, "qSupported:swbreak+", "PacketSize=");
+    GdbTestCheck(psTest, i32Socket, "?", "T05");
+
+    /*
+     * The initial stack pointer, from the vector table in flash.
+     */
+    GdbTestWord(pcExpect, psTest->ui32Vector);
+    GdbTestCheck(psTest, i32Socket, "m0,4", pcExpect);
+
+    /*
+     * A breakpoint at the loop, and a step over its first instruction,
+     * which is a 32-bit one.
+     */
+    snprintf(pcRequest, sizeof(pcRequest), "Z0,%x,2", psTest->ui32Loop);
+    GdbTestCheck(psTest, i32Socket, pcRequest, "OK");
+    GdbTestCheck(psTest, i32Socket, "c", "T05");
+    GdbTestWord(pcExpect, psTest->ui32Loop);
+    GdbTestCheck(psTest, i32Socket, "pf", pcExpect);
+    GdbTestCheck(psTest, i32Socket, "s", "T05");
+    GdbTestWord(pcExpect, psTest->ui32Loop + 4);
+    GdbTestCheck(psTest, i32Socket, "pf", pcExpect);
+    snprintf(pcRequest, sizeof(pcRequest), "z0,%x,2", psTest->ui32Loop);
+    GdbTestCheck(psTest, i32Socket, pcRequest, "OK");
+
+    /*
+     * Memory and registers written and read back.
+     */
+    GdbTestCheck(psTest, i32Socket, "M20001000,4:78563412", "OK");
+    GdbTestCheck(psTest, i32Socket, "m20001000,4", "78563412");
+    GdbTestCheck(psTest, i32Socket, "P1=efbeadde", "OK");
+    GdbTestCheck(psTest, i32Socket, "p1", "efbeadde");
+    GdbTestCheck(psTest, i32Socket, "g", "");
+
+    /*
+     * A watchpoint on the results, which the program stores at its end.
+     */
+    GdbTestCheck(psTest, i32Socket, "Z2,20001000,4", "OK");
+    GdbTestCheck(psTest, i32Socket, "c", "T05watch:20001000;");
+    GdbTestCheck(psTest, i32Socket, "z2,20001000,4", "OK");
+
+    GdbTestCheck(psTest, i32Socket, "D", "OK");
+    close(i32Socket);
+
+    return(NULL);
+}
+
+int
+main(int argc, char *argv[])
+{
+    const tSimElfSymbol *psLoop;
+    struct sockaddr_in sAddr;
+    socklen_t sAddrLen = sizeof(sAddr);
+    tSimBoardHooks sHooks;
+    tSimMachine *psMachine;
+    const uint32_t *pui32Vector;
+    uint32_t ui32Size;
+    pthread_t sClient;
+    tSimGdb *psGdb;
+    tSimElf sElf;
+    tGdbTest sTest;
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "Usage: %s firmware.elf\n", argv[0]);
+        return(2);
+    }
+
+    if(!SimElfOpen(&sElf, argv[1]))
+    {
+        fprintf(stderr, "%s: %s\n", argv[1], sElf.pcError);
+        return(1);
+    }
+
+    pui32Vector = SimElfData(&sElf, 0, &ui32Size);
+
+    if(!(psLoop = SimElfSymbol(&sElf, "Loop")) || !pui32Vector)
+    {
+        fprintf(stderr, "%s: no Loop or no vector table\n", argv[1]);
+        return(1);
+    }
+
+    memset(&sHooks, 0, sizeof(sHooks));
+    psMachine = calloc(1, sizeof(*psMachine));
+
+    if(!psMachine || !SimCpuInit(psMachine, &sHooks) ||
+       !SimDebugInit(psMachine) || !SimElfLoad(&sElf, &psMachine->sMemory))
+    {
+        fprintf(stderr, "cannot set up the machine\n");
+        return(1);
+    }
+
+    SimCpuInvalidate(psMachine);
+    SimCpuReset(psMachine);
+
+    /*
+     * Any free port will do.
+     */
+    if(!(psGdb = SimGdbOpen(0)) ||
+       getsockname(psGdb->i32Listen, (struct sockaddr *)&sAddr, &sAddrLen))
+    {
+        fprintf(stderr, "cannot listen\n");
+        return(1);
+    }
+
+    memset(&sTest, 0, sizeof(sTest));
+    sTest.ui16Port = ntohs(sAddr.sin_port);
+    sTest.ui32Loop = psLoop->ui32Value;
+    sTest.ui32Vector = pui32Vector[0];
+
+    pthread_create(&sClient, NULL, GdbTestClient, &sTest);
+
+    if(!SimGdbAccept(psGdb))
+    {
+        fprintf(stderr, "cannot accept\n");
+        return(1);
+    }
+
+    while((psMachine->sCpu.ui64Cycle < GDB_TEST_CYCLES) &&
+          (SimGdbRun(psGdb, psMachine, GDB_TEST_CYCLES -
+                     psMachine->sCpu.ui64Cycle) == SIM_CPU_DONE))
+        ;
+
+    pthread_join(sClient, NULL);
+    SimGdbClose(psGdb, 0);
+    SimCpuFree(psMachine);
+    free(psMachine);
+    SimElfClose(&sElf);
+
+    return(sTest.ui32Failures ? 1 : 0);
+}
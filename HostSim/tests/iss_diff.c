@@ -0,0 +1,178 @@
+/*
+ * Differential test of the instruction set simulator: runs a firmware image
+ * on two machines, one interpreting and one translating, in slices of a few
+ * cycles, and fails at the first slice after which their registers, flags,
+ * counts or SRAM differ.  The slices end the translated blocks at every
+ * possible place, so a block leaving the processor state other than the
+ * interpreter would is caught at the instruction that did it.  Every slice
+ * size is run without and with idle loop skipping, which the two engines
+ * must trigger at the same iteration.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../sim/cpu.h"
+#include "../sim/elf.h"
+#include "../sim/idle.h"
+#include "../sim/translate.h"
+
+/*
+ * Cycles run by each machine, and the sizes of the slices they are run in.
+ */
+#define DIFF_CYCLES             400000
+static const uint32_t g_pui32Slices[] = { 3, 7, 97, 1000 };
+
+static tSimMachine *
+DiffMachine(tSimElf *psElf, bool bTranslate, bool bIdle)
+{
+    tSimBoardHooks sHooks;
+    tSimMachine *psMachine;
+
+    memset(&sHooks, 0, sizeof(sHooks));
+    psMachine = calloc(1, sizeof(*psMachine));
+
+    if(!psMachine || !SimCpuInit(psMachine, &sHooks) ||
+       (bTranslate && !SimTranslateInit(psMachine)) ||
+       (bIdle && !SimIdleInit(psMachine)) ||
+       !SimElfLoad(psElf, &psMachine->sMemory))
+    {
+        fprintf(stderr, "cannot set up the machine\n");
+        exit(1);
+    }
+
+    SimCpuInvalidate(psMachine);
+    SimCpuReset(psMachine);
+
+    return(psMachine);
+}
+
+/*
+ * Returns true if the two processors and their SRAM are in the same state,
+ * printing what differs otherwise.
+ */
+static bool
+DiffCompare(const tSimMachine *psA, const tSimMachine *psB)
+{
+    const tSimCpu *psCpuA = &psA->sCpu, *psCpuB = &psB->sCpu;
+    bool bSame = true;
+    uint32_t ui32Reg;
+
+    for(ui32Reg = 0; ui32Reg < 15; ui32Reg++)
+    {
+        if(psCpuA->pui32R[ui32Reg] != psCpuB->pui32R[ui32Reg])
+        {
+            printf("  r%u: %08x interpreted, %08x translated\n", ui32Reg,
+                   psCpuA->pui32R[ui32Reg], psCpuB->pui32R[ui32Reg]);
+            bSame = false;
+        }
+    }
+
+    if((psCpuA->ui32PC != psCpuB->ui32PC) ||
+       (SimCpuXPSR(psCpuA) != SimCpuXPSR(psCpuB)) ||
+       (psCpuA->ui64Cycle != psCpuB->ui64Cycle) ||
+       (psCpuA->ui64Insns != psCpuB->ui64Insns))
+    {
+        printf("  pc %08x xpsr %08x cycle %llu insns %llu interpreted\n"
+               "  pc %08x xpsr %08x cycle %llu insns %llu translated\n",
+               psCpuA->ui32PC, SimCpuXPSR(psCpuA),
+               (unsigned long long)psCpuA->ui64Cycle,
+               (unsigned long long)psCpuA->ui64Insns,
+               psCpuB->ui32PC, SimCpuXPSR(psCpuB),
+               (unsigned long long)psCpuB->ui64Cycle,
+               (unsigned long long)psCpuB->ui64Insns);
+        bSame = false;
+    }
+
+    if(memcmp(psA->sMemory.pui8Arena + SIM_MEM_SRAM_OFFSET,
+              psB->sMemory.pui8Arena + SIM_MEM_SRAM_OFFSET, SIM_SRAM_SIZE))
+    {
+        printf("  SRAM differs\n");
+        bSame = false;
+    }
+
+    return(bSame);
+}
+
+int
+main(int argc, char *argv[])
+{
+    tSimMachine *psInterp, *psTrans;
+    const tSimElfSymbol *psDone;
+    uint64_t ui64Run;
+    uint32_t ui32Slice, ui32Idx;
+    const char *pcMode;
+    tSimElf sElf;
+    bool bIdle;
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "Usage: %s firmware.elf\n", argv[0]);
+        return(2);
+    }
+
+    if(!SimElfOpen(&sElf, argv[1]))
+    {
+        fprintf(stderr, "%s: %s\n", argv[1], sElf.pcError);
+        return(1);
+    }
+
+    psDone = SimElfSymbol(&sElf, "Done");
+
+    for(ui32Idx = 0;
+        ui32Idx < 2 * sizeof(g_pui32Slices) / sizeof(g_pui32Slices[0]);
+        ui32Idx++)
+    {
+        ui32Slice = g_pui32Slices[ui32Idx / 2];
+        bIdle = (ui32Idx & 1) != 0;
+        pcMode = bIdle ? ", idle skipped" : "";
+        psInterp = DiffMachine(&sElf, false, bIdle);
+        psTrans = DiffMachine(&sElf, true, bIdle);
+
+        for(ui64Run = 0; ui64Run < DIFF_CYCLES; ui64Run += ui32Slice)
+        {
+            SimCpuRun(psInterp, ui32Slice);
+            SimCpuRun(psTrans, ui32Slice);
+
+            if(!DiffCompare(psInterp, psTrans))
+            {
+                printf("slices of %u%s: differs after cycle %llu, from "
+                       "%08x\n", ui32Slice, pcMode,
+                       (unsigned long long)psInterp->sCpu.ui64Cycle,
+                       psInterp->sCpu.ui32InsnPC);
+                return(1);
+            }
+        }
+
+        /*
+         * A program that faulted or never got to its end compares equal
+         * but tests little.
+         */
+        if(psDone && ((psInterp->sCpu.ui32PC & ~1U) != psDone->ui32Value))
+        {
+            printf("slices of %u%s: not at Done but at %08x\n", ui32Slice,
+                   pcMode, psInterp->sCpu.ui32PC);
+            return(1);
+        }
+
+        printf("slices of %u%s: %llu instructions the same, in %u blocks",
+               ui32Slice, pcMode,
+               (unsigned long long)psTrans->sCpu.ui64Insns,
+               psTrans->psTranslator->ui32Blocks);
+
+        if(bIdle)
+            printf(", %llu cycles skipped",
+                   (unsigned long long)psTrans->psIdle->ui64Cycles);
+
+        printf("\n");
+
+        SimCpuFree(psInterp);
+        SimCpuFree(psTrans);
+        free(psInterp);
+        free(psTrans);
+    }
+
+    SimElfClose(&sElf);
+
+    return(0);
+}
@@ -0,0 +1,80 @@
+/*
+ * Benchmark of the ring buffers of uartstdio.c, built with UART_BUFFERED:
+ * the bytes moved per cycle of the time stamp counter through the transmit
+ * buffer, written 48 at a time and sent by the interrupt handler, and
+ * through the receive buffer, received 16 at a time and read a character at
+ * a time.  The cycles include those of the model of the UART, which are the
+ * same for any version of the ring buffers, so the figures compare versions
+ * rather than give the cost on the chip.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "utils/uartstdio.h"
+#include "uart_model.h"
+
+#define BENCH_TX_WRITES         1000000
+#define BENCH_RX_RECEIVES       1000000
+#define BENCH_RUNS              5
+
+int
+main(void)
+{
+    char pcBuf[48];
+    uint64_t ui64Start, ui64Cycles, ui64Best, ui64Bytes;
+    uint32_t ui32Run, ui32Idx;
+
+    TestUARTHandler(0, UARTStdioIntHandler);
+    UARTStdioConfig(0, 115200, 16000000);
+    UARTEchoSet(false);
+    memset(pcBuf, 'x', sizeof(pcBuf));
+
+    /*
+     * The best of a few runs, the others having been slowed by the rest of
+     * the machine.
+     */
+    for(ui64Best = ~0ULL, ui32Run = 0; ui32Run < BENCH_RUNS; ui32Run++)
+    {
+        ui64Start = __rdtsc();
+
+        for(ui32Idx = 0; ui32Idx < BENCH_TX_WRITES; ui32Idx++)
+        {
+            UARTwrite(pcBuf, sizeof(pcBuf));
+            TestUARTDrain(0);
+        }
+
+        ui64Cycles = __rdtsc() - ui64Start;
+
+        if(ui64Cycles < ui64Best)
+            ui64Best = ui64Cycles;
+
+        TestUARTCaptureClear(0);
+    }
+
+    ui64Bytes = (uint64_t)BENCH_TX_WRITES * sizeof(pcBuf);
+    printf("transmit: %.3f bytes/cycle\n", (double)ui64Bytes / ui64Best);
+
+    for(ui64Best = ~0ULL, ui32Run = 0; ui32Run < BENCH_RUNS; ui32Run++)
+    {
+        ui64Start = __rdtsc();
+
+        for(ui32Idx = 0; ui32Idx < BENCH_RX_RECEIVES; ui32Idx++)
+        {
+            TestUARTReceive(0, pcBuf, 16);
+
+            while(UARTRxBytesAvail())
+                UARTgetc();
+        }
+
+        ui64Cycles = __rdtsc() - ui64Start;
+
+        if(ui64Cycles < ui64Best)
+            ui64Best = ui64Cycles;
+    }
+
+    ui64Bytes = (uint64_t)BENCH_RX_RECEIVES * 16;
+    printf("receive: %.3f bytes/cycle\n", (double)ui64Bytes / ui64Best);
+
+    return(0);
+}
@@ -0,0 +1,179 @@
+/*
+ * Test of the uDMA transmit path of uartstdio.c, built with UART_BUFFERED
+ * and UART_BUFFERED_DMA: writes of random lengths go through the transmit
+ * buffer and the uDMA to the line, which sends random numbers of bytes in
+ * between, and what it sent must be what was written, LFs made CRLFs.  The
+ * model fails the test if a transfer is longer than the uDMA can move or is
+ * set up while one is running, and as it moves the bytes only when the FIFO
+ * has room, a span overwritten before it was sent shows in the output.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/uartstdio.h"
+#include "uart_model.h"
+
+#define DMA_TEST_WRITES         20000
+#define DMA_TEST_WRITE_MAX      1500
+
+static uint32_t g_ui32Random = 1;
+
+static uint32_t
+DMATestRandom(void)
+{
+    g_ui32Random ^= g_ui32Random << 13;
+    g_ui32Random ^= g_ui32Random >> 17;
+    g_ui32Random ^= g_ui32Random << 5;
+
+    return(g_ui32Random);
+}
+
+/*
+ * What the line should have sent, and how much of it.
+ */
+static uint8_t *g_pui8Expect;
+static uint32_t g_ui32Expect;
+
+/*
+ * Writes random printable text with LFs in it, up to ui32Len bytes, and
+ * returns the number taken.
+ */
+static uint32_t
+DMATestWrite(uint32_t ui32Len)
+{
+    char pcBuf[DMA_TEST_WRITE_MAX];
+    uint32_t ui32Idx;
+    int iTaken;
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+        pcBuf[ui32Idx] = (DMATestRandom() % 40) ? ' ' + (DMATestRandom() % 95) :
+                         '\n';
+
+    iTaken = UARTwrite(pcBuf, ui32Len);
+
+    for(ui32Idx = 0; ui32Idx < (uint32_t)iTaken; ui32Idx++)
+    {
+        if(pcBuf[ui32Idx] == '\n')
+            g_pui8Expect[g_ui32Expect++] = '\r';
+
+        g_pui8Expect[g_ui32Expect++] = pcBuf[ui32Idx];
+    }
+
+    return((uint32_t)iTaken);
+}
+
+/*
+ * Compares the capture of UART0 with the expected output from ui32From on.
+ */
+static bool
+DMATestCheck(const char *pcTest, uint32_t ui32From)
+{
+    const uint8_t *pui8Capture;
+    uint32_t ui32Len, ui32Idx;
+
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+
+    if(ui32Len != g_ui32Expect - ui32From)
+    {
+        printf("%s: %u bytes sent, %u written\n", pcTest, ui32Len,
+               g_ui32Expect - ui32From);
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pui8Capture[ui32Idx] != g_pui8Expect[ui32From + ui32Idx])
+        {
+            printf("%s: byte %u sent as %02x, written as %02x\n", pcTest,
+                   ui32Idx, pui8Capture[ui32Idx],
+                   g_pui8Expect[ui32From + ui32Idx]);
+            return(false);
+        }
+    }
+
+    printf("%s: %u bytes sent as written\n", pcTest, ui32Len);
+
+    return(true);
+}
+
+int
+main(void)
+{
+    uint32_t ui32Write, ui32Len, ui32Taken, ui32Sent, ui32Before;
+    const uint8_t *pui8Capture;
+    bool bPass = true;
+
+    g_pui8Expect = malloc(TEST_UART_CAPTURE);
+
+    TestUARTHandler(0, UARTStdioIntHandler);
+    UARTStdioConfig(0, 115200, 16000000);
+
+    /*
+     * Writes and sends of random sizes, the writes often long enough for
+     * the buffer to wrap and spans to be cut at the uDMA's limit.
+     */
+    for(ui32Write = 0; ui32Write < DMA_TEST_WRITES; ui32Write++)
+    {
+        DMATestWrite(1 + (DMATestRandom() % DMA_TEST_WRITE_MAX));
+        TestUARTSend(0, DMATestRandom() % (2 * DMA_TEST_WRITE_MAX));
+    }
+
+    TestUARTDrain(0);
+    bPass &= DMATestCheck("random writes", 0);
+
+    /*
+     * Discarding the buffer while the uDMA is halfway through a span: the
+     * line sends what was in the FIFO, then what is written next.
+     */
+    TestUARTCaptureClear(0);
+    g_ui32Expect = 0;
+    DMATestWrite(DMA_TEST_WRITE_MAX);
+    TestUARTSend(0, 100);
+    UARTFlushTx(true);
+    ui32Before = g_ui32Expect;
+    TestUARTDrain(0);
+    pui8Capture = TestUARTCapture(0, &ui32Sent);
+
+    if((ui32Sent < 100) || (ui32Sent > 100 + TEST_UART_FIFO) ||
+       memcmp(pui8Capture, g_pui8Expect, ui32Sent))
+    {
+        printf("discard: %u bytes sent after the discard\n", ui32Sent);
+        bPass = false;
+    }
+
+    TestUARTCaptureClear(0);
+    g_ui32Expect = ui32Before;
+    DMATestWrite(DMA_TEST_WRITE_MAX);
+    TestUARTDrain(0);
+    bPass &= DMATestCheck("discard", ui32Before);
+
+    /*
+     * The line sending from a timer signal, preempting the writer anywhere,
+     * and UARTFlushTx(false) waiting for the uDMA to take everything.
+     */
+    TestUARTCaptureClear(0);
+    g_ui32Expect = 0;
+    TestUARTPreempt(50, 64);
+
+    for(ui32Write = 0; ui32Write < DMA_TEST_WRITES; ui32Write++)
+    {
+        ui32Len = 1 + (DMATestRandom() % 200);
+
+        for(ui32Taken = 0; ui32Taken < ui32Len; )
+            ui32Taken += DMATestWrite(ui32Len - ui32Taken);
+    }
+
+    UARTFlushTx(false);
+    TestUARTPreempt(0, 0);
+    TestUARTDrain(0);
+    bPass &= DMATestCheck("preempted writes", 0);
+
+    if(TestUARTErrors())
+    {
+        printf("%u misuses of the model\n", TestUARTErrors());
+        bPass = false;
+    }
+
+    return(bPass ? 0 : 1);
+}
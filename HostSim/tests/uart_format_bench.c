@@ -0,0 +1,123 @@
+/*
+ * Benchmark of the number formatting of UARTprintf(): the cycles of the time
+ * stamp counter per call for the format string the projects log the clock
+ * rate with and for single numbers.  Built without UART_BUFFERED and linked
+ * without the model, it has a UART of its own that takes a byte for the cost
+ * of a store, so the cycles are mostly those of formatting and of the call
+ * per byte sent that any unbuffered uartstdio.c makes.  make bench also
+ * builds it against tests/baseline/uartstdio.c to compare the two.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <x86intrin.h>
+
+#include "utils/uartstdio.h"
+
+#define BENCH_CALLS             100000
+#define BENCH_RUNS              30
+
+/*
+ * The driverlib calls the unbuffered uartstdio.c makes, the UART keeping the
+ * last byte sent.
+ */
+static volatile unsigned char g_ucSent;
+
+bool
+SysCtlPeripheralPresent(uint32_t ui32Peripheral)
+{
+    return(true);
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+void
+UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                    uint32_t ui32Baud, uint32_t ui32Config)
+{
+}
+
+void
+UARTEnable(uint32_t ui32Base)
+{
+}
+
+void
+UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    g_ucSent = ucData;
+}
+
+int32_t
+UARTCharGet(uint32_t ui32Base)
+{
+    return('\r');
+}
+
+/*
+ * Returns the best of a few runs of BENCH_CALLS calls of UARTprintf() with
+ * one argument, in cycles per call, the others having been slowed by the
+ * rest of the machine.
+ */
+static double
+FormatBenchRun(const char *pcFormat, uint32_t ui32Value)
+{
+    uint64_t ui64Start, ui64Cycles, ui64Best;
+    uint32_t ui32Run, ui32Idx;
+
+    for(ui64Best = ~0ULL, ui32Run = 0; ui32Run < BENCH_RUNS; ui32Run++)
+    {
+        ui64Start = __rdtsc();
+
+        for(ui32Idx = 0; ui32Idx < BENCH_CALLS; ui32Idx++)
+            UARTprintf(pcFormat, ui32Value);
+
+        ui64Cycles = __rdtsc() - ui64Start;
+
+        if(ui64Cycles < ui64Best)
+            ui64Best = ui64Cycles;
+    }
+
+    return((double)ui64Best / BENCH_CALLS);
+}
+
+int
+main(void)
+{
+    static const struct
+    {
+        const char *pcFormat;
+        uint32_t ui32Value;
+    }
+    psBench[] =
+    {
+        { "---->> Configured clock rate %d.\n", 40000000 },
+        { "---->> Configured clock rate %d.\n", 16000000 },
+        { "%d", 40000000 },
+        { "%d", 1234 },
+        { "%d", (uint32_t)-57 },
+        { "%u", 4294967295U },
+        { "%08x", 0xdeadbeef },
+        { "%5d", 42 },
+    };
+    char pcName[40];
+    uint32_t ui32Bench;
+
+    UARTStdioConfig(0, 115200, 16000000);
+
+    for(ui32Bench = 0; ui32Bench < sizeof(psBench) / sizeof(psBench[0]);
+        ui32Bench++)
+    {
+        snprintf(pcName, sizeof(pcName), "\"%.*s\"",
+                 (int)strcspn(psBench[ui32Bench].pcFormat, "\n"),
+                 psBench[ui32Bench].pcFormat);
+        printf("%-36s %11d: %6.1f cycles/call\n", pcName,
+               (int32_t)psBench[ui32Bench].ui32Value,
+               FormatBenchRun(psBench[ui32Bench].pcFormat,
+                              psBench[ui32Bench].ui32Value));
+    }
+
+    return(0);
+}
@@ -0,0 +1,366 @@
+/*
+ * Test of the line framed input of uartstdio.c, built with UART_BUFFERED,
+ * UART_RX_LINES and a receive buffer small enough for lines to wrap around
+ * its end all the time: lines must come out of UARTLineGet() whole, in one
+ * part or two, and in order, lines too long for the buffer or for which the
+ * queue has no room must be thrown away whole, and neither backspace nor
+ * UARTFlushRx() may cut into a line queued before.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/uartstdio.h"
+#include "uartline.h"
+#include "uart_model.h"
+
+#define LINES_TEST_INPUT        (200U << 10)
+#define LINES_TEST_LINE_MAX     40
+
+static uint32_t g_ui32Random = 1;
+
+static uint32_t
+LinesTestRandom(void)
+{
+    g_ui32Random ^= g_ui32Random << 13;
+    g_ui32Random ^= g_ui32Random >> 17;
+    g_ui32Random ^= g_ui32Random << 5;
+
+    return(g_ui32Random);
+}
+
+/*
+ * Receives a string on UART0 and sends what the handler has to send, the
+ * echo with it.
+ */
+static void
+LinesTestReceive(const char *pcInput)
+{
+    TestUARTReceive(0, pcInput, strlen(pcInput));
+    TestUARTDrain(0);
+}
+
+/*
+ * Gets the oldest line into pcBuf, null terminated, and releases it.
+ * Returns the number of parts it was in, or 0 if there was no line.
+ */
+static uint32_t
+LinesTestGet(char *pcBuf)
+{
+    tUARTLine sLine;
+
+    if(!UARTLineGet(&sLine))
+        return(0);
+
+    memcpy(pcBuf, sLine.ppcPart[0], sLine.pui32PartLen[0]);
+    memcpy(pcBuf + sLine.pui32PartLen[0], sLine.ppcPart[1],
+           sLine.pui32PartLen[1]);
+    pcBuf[sLine.ui32Len] = 0;
+
+    if(sLine.pui32PartLen[0] + sLine.pui32PartLen[1] != sLine.ui32Len)
+        pcBuf[0] = '?';
+
+    UARTLineRelease(&sLine);
+
+    return(sLine.pui32PartLen[1] ? 2 : 1);
+}
+
+/*
+ * Checks that the next lines are those of ppcLines, and that no others
+ * follow, leaving ui32Left bytes of a partial line in the buffer.
+ */
+static bool
+LinesTestExpect(const char *pcTest, const char * const *ppcLines,
+                uint32_t ui32Lines, uint32_t ui32Left)
+{
+    char pcBuf[UART_RX_BUFFER_SIZE + 1];
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < ui32Lines; ui32Idx++)
+    {
+        if(!LinesTestGet(pcBuf))
+            strcpy(pcBuf, "(none)");
+
+        if(strcmp(pcBuf, ppcLines[ui32Idx]))
+        {
+            printf("%s: line %u is \"%s\", not \"%s\"\n", pcTest, ui32Idx,
+                   pcBuf, ppcLines[ui32Idx]);
+            return(false);
+        }
+    }
+
+    if(LinesTestGet(pcBuf))
+    {
+        printf("%s: line \"%s\" after the last\n", pcTest, pcBuf);
+        return(false);
+    }
+
+    if(UARTRxBytesAvail() != (int)ui32Left)
+    {
+        printf("%s: %d bytes left after the lines\n", pcTest,
+               UARTRxBytesAvail());
+        return(false);
+    }
+
+    printf("%s: %u lines, %u bytes left\n", pcTest, ui32Lines, ui32Left);
+
+    return(true);
+}
+
+/*
+ * Checks the echo sent since the capture was cleared.
+ */
+static bool
+LinesTestEcho(const char *pcTest, const char *pcEcho)
+{
+    const uint8_t *pui8Capture;
+    uint32_t ui32Len;
+
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+
+    if((ui32Len != strlen(pcEcho)) || memcmp(pui8Capture, pcEcho, ui32Len))
+    {
+        printf("%s: echo of %u bytes not as expected\n", pcTest, ui32Len);
+        return(false);
+    }
+
+    TestUARTCaptureClear(0);
+
+    return(true);
+}
+
+/*
+ * The input of the preempted test: numbered lines, the number of the line
+ * in decimal followed by letters up to a random length, ended by a CR, an
+ * LF or a CRLF, and the number of lines ended before each byte.
+ */
+static uint8_t *g_pui8Input;
+static uint32_t *g_pui32Ended;
+static uint32_t g_ui32Released;
+
+/*
+ * Flow control of the input: the signal receives more only while the
+ * buffer has room for all it might, and the queue for all the lines it
+ * might end, two in four bytes.
+ */
+static bool
+LinesTestReady(void)
+{
+    return((UARTRxBytesAvail() <= UART_RX_BUFFER_SIZE - 4) &&
+           (g_pui32Ended[TestUARTInputDone(0)] - g_ui32Released <=
+            UART_RX_LINES - 2));
+}
+
+int
+main(void)
+{
+    static const char * const ppcEdited[] = { "hello", "wold", "ab" };
+    static const char * const ppcKept[] = { "abc", "xy" };
+    static const char * const ppcNext[] = { "next", "after" };
+    static const char * const ppcQueued[] = { "a", "b", "c", "d", "g" };
+    static const char * const ppcFlushed[] = { "ial", "ok" };
+    static const char * const ppcEscaped[] = { "esc", "aped" };
+    char pcBuf[UART_RX_BUFFER_SIZE + 2];
+    uint32_t ui32Len, ui32Idx, ui32Lines, ui32Parts, ui32Wrapped;
+    uint32_t ui32Offset, ui32End;
+    bool bPass = true;
+
+    TestUARTHandler(0, UARTStdioIntHandler);
+    UARTStdioConfig(0, 115200, 16000000);
+
+    /*
+     * Line editing with echo: a CRLF ends one line, backspace rubs out, ESC
+     * ends a line too, and a partial line is not returned.
+     */
+    LinesTestReceive("hello\r\nwor\bld\x1b" "ab\rpart");
+    bPass &= LinesTestEcho("edited",
+                           "hello\r\n\rwor\b \bld\r\n\rab\r\n\rpart");
+    bPass &= LinesTestExpect("edited", ppcEdited, 3, 4);
+
+    /*
+     * Flushing the partial line mid line makes the rest of it a line of its
+     * own, and backspace stops at the flush.
+     */
+    UARTFlushRx();
+    LinesTestReceive("\b\b\b\b\bial\nok\n");
+    bPass &= LinesTestEcho("flushed", "ial\r\n\rok\r\n\r");
+    bPass &= LinesTestExpect("flushed", ppcFlushed, 2, 0);
+
+    /*
+     * Backspace does not cross the end of a line queued and not yet
+     * released.
+     */
+    LinesTestReceive("abc\r\b\b\b\bxy\r");
+    bPass &= LinesTestEcho("backspace", "abc\r\n\rxy\r\n\r");
+    bPass &= LinesTestExpect("backspace", ppcKept, 2, 0);
+
+    /*
+     * Without echo, a line longer than the buffer is thrown away whole and
+     * the next kept.  A line that with its terminator fills the buffer
+     * exactly fits, one a byte longer does not.
+     */
+    UARTEchoSet(false);
+    memset(pcBuf, 'z', UART_RX_BUFFER_SIZE);
+    pcBuf[UART_RX_BUFFER_SIZE] = 0;
+    LinesTestReceive(pcBuf);
+    LinesTestReceive(pcBuf);
+    LinesTestReceive("\nnext\r\n");
+    bPass &= LinesTestExpect("overflow", ppcNext, 1, 0);
+
+    pcBuf[UART_RX_BUFFER_SIZE - 1] = 0;
+    LinesTestReceive(pcBuf);
+    LinesTestReceive("\r");
+    ui32Len = LinesTestGet(pcBuf) ? strlen(pcBuf) : 0;
+
+    if(ui32Len != UART_RX_BUFFER_SIZE - 1)
+    {
+        printf("overflow: line filling the buffer read as %u bytes\n",
+               ui32Len);
+        bPass = false;
+    }
+
+    memset(pcBuf, 'z', UART_RX_BUFFER_SIZE);
+    pcBuf[UART_RX_BUFFER_SIZE] = 0;
+    LinesTestReceive(pcBuf);
+    LinesTestReceive("\rafter\r");
+    bPass &= LinesTestExpect("overflow", ppcNext + 1, 1, 0);
+
+    /*
+     * Without echo, ESC ends a line as it does with echo.
+     */
+    LinesTestReceive("esc\x1b" "aped\n");
+    bPass &= LinesTestExpect("escape", ppcEscaped, 2, 0);
+
+    /*
+     * With the queue full, the lines that end are thrown away until one is
+     * released.
+     */
+    LinesTestReceive("a\nb\nc\nd\ne\nf\n");
+    bPass &= LinesTestExpect("queue full", ppcQueued, UART_RX_LINES, 0);
+    LinesTestReceive("g\n");
+    bPass &= LinesTestExpect("queue full", ppcQueued + 4, 1, 0);
+
+    /*
+     * Lines of every length that fits starting at every offset of the
+     * buffer, the longer ones wrapping around its end.
+     */
+    for(ui32Wrapped = ui32Offset = 0; ui32Offset < UART_RX_BUFFER_SIZE;
+        ui32Offset++)
+    {
+        for(ui32Len = 0; ui32Len < UART_RX_BUFFER_SIZE; ui32Len++)
+        {
+            for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+                pcBuf[ui32Idx] = 'a' + ((ui32Offset + ui32Idx) % 26);
+
+            pcBuf[ui32Len] = '\n';
+            pcBuf[ui32Len + 1] = 0;
+            LinesTestReceive(pcBuf);
+            ui32Parts = LinesTestGet(pcBuf);
+
+            if((ui32Parts == 0) || (strlen(pcBuf) != ui32Len) ||
+               (ui32Len && (pcBuf[ui32Len - 1] !=
+                            (char)('a' + ((ui32Offset + ui32Len - 1) % 26)))))
+            {
+                printf("wrap: line of %u bytes not read back\n", ui32Len);
+                bPass = false;
+            }
+
+            ui32Wrapped += (ui32Parts == 2);
+        }
+
+        /*
+         * Move the start of the next lines on by one byte.
+         */
+        LinesTestReceive("\n");
+        LinesTestGet(pcBuf);
+    }
+
+    printf("wrap: %u lines in two parts\n", ui32Wrapped);
+    bPass &= (ui32Wrapped != 0) && LinesTestExpect("wrap", 0, 0, 0);
+
+    /*
+     * Lines received from the signal, preempting the reader anywhere.
+     */
+    g_pui8Input = malloc(LINES_TEST_INPUT + LINES_TEST_LINE_MAX);
+    g_pui32Ended = calloc(LINES_TEST_INPUT + LINES_TEST_LINE_MAX + 1,
+                          sizeof(uint32_t));
+
+    for(ui32Len = ui32Lines = 0; ui32Len < LINES_TEST_INPUT; ui32Lines++)
+    {
+        ui32Idx = ui32Len;
+        ui32End = ui32Len + (LinesTestRandom() % LINES_TEST_LINE_MAX);
+        ui32Len += sprintf((char *)g_pui8Input + ui32Len, "%u", ui32Lines);
+
+        while(ui32Len < ui32End)
+            g_pui8Input[ui32Len++] = 'a' + (LinesTestRandom() % 26);
+
+        switch(LinesTestRandom() % 3)
+        {
+            case 0:
+                g_pui8Input[ui32Len++] = '\r';
+                break;
+
+            case 1:
+                g_pui8Input[ui32Len++] = '\n';
+                break;
+
+            default:
+                g_pui8Input[ui32Len++] = '\r';
+                g_pui8Input[ui32Len++] = '\n';
+                break;
+        }
+
+        for(; ui32Idx < ui32Len; ui32Idx++)
+            g_pui32Ended[ui32Idx + 1] = g_pui32Ended[ui32Idx] +
+                                        ((g_pui8Input[ui32Idx] == '\r') ||
+                                         ((g_pui8Input[ui32Idx] == '\n') &&
+                                          (g_pui8Input[ui32Idx - 1] !=
+                                           '\r')));
+    }
+
+    TestUARTInput(0, g_pui8Input, ui32Len, 4, LinesTestReady);
+    TestUARTPreempt(20, 64);
+
+    for(ui32Wrapped = 0; g_ui32Released < ui32Lines; )
+    {
+        /*
+         * A line missing once all the input has been received is lost.
+         */
+        ui32Idx = TestUARTInputDone(0);
+
+        if(!(ui32Parts = LinesTestGet(pcBuf)))
+        {
+            if(ui32Idx < ui32Len)
+                continue;
+
+            printf("preempted: line %u lost\n", g_ui32Released);
+            bPass = false;
+            break;
+        }
+
+        if((strtoul(pcBuf, 0, 10) != g_ui32Released) ||
+           strpbrk(pcBuf, "\r\n"))
+        {
+            printf("preempted: line %u read as \"%s\"\n", g_ui32Released,
+                   pcBuf);
+            bPass = false;
+            break;
+        }
+
+        ui32Wrapped += (ui32Parts == 2);
+        g_ui32Released++;
+    }
+
+    TestUARTPreempt(0, 0);
+    printf("preempted: %u lines, %u in two parts\n", g_ui32Released,
+           ui32Wrapped);
+    bPass &= LinesTestExpect("preempted", 0, 0, 0);
+
+    if(TestUARTErrors())
+    {
+        printf("%u misuses of the model\n", TestUARTErrors());
+        bPass = false;
+    }
+
+    return(bPass ? 0 : 1);
+}
@@ -0,0 +1,840 @@
+/*
+ * Model of the UART, interrupt controller and uDMA calls of uartstdio.c
+ * (see uart_model.h).
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "uart_model.h"
+
+#define TEST_UDMA_CHANNELS      32
+#define TEST_UDMA_SPAN_MAX      1024
+
+/*
+ * Rounds of interrupts taken in a row before the model gives up on a handler
+ * that never clears its interrupt.
+ */
+#define TEST_INT_ROUNDS         1000
+
+typedef struct
+{
+    /*
+     * The FIFOs, as a count of the bytes in them from a head index.
+     */
+    uint8_t pui8Tx[TEST_UART_FIFO];
+    uint32_t ui32TxHead;
+    uint32_t ui32TxCount;
+    uint8_t pui8Rx[TEST_UART_FIFO];
+    uint32_t ui32RxHead;
+    uint32_t ui32RxCount;
+
+    /*
+     * The FIFO levels of UARTFIFOLevelSet(), in bytes, and the interrupt
+     * registers.
+     */
+    uint32_t ui32TxLevel;
+    uint32_t ui32RxLevel;
+    uint32_t ui32IM;
+    uint32_t ui32RIS;
+    bool bDMA;
+
+    /*
+     * The interrupt controller's view of the UART.
+     */
+    bool bEnabled;
+    bool bPending;
+    void (*pfnHandler)(void);
+
+    uint8_t *pui8Capture;
+    uint32_t ui32Captured;
+
+    /*
+     * The input of TestUARTInput(), received by the timer signal.
+     */
+    const uint8_t *pui8Input;
+    uint32_t ui32InputLen;
+    volatile uint32_t ui32Input;
+    uint32_t ui32InputBytes;
+    bool (*pfnReady)(void);
+} tTestUART;
+
+typedef struct
+{
+    bool bEnabled;
+    bool bAssigned;
+    uint32_t ui32Port;
+    const uint8_t *pui8Src;
+    uint32_t ui32Count;
+} tTestDMA;
+
+static tTestUART g_psUARTs[TEST_UART_PORTS];
+static tTestDMA g_psChannels[TEST_UDMA_CHANNELS];
+static bool g_bMasked;
+static bool g_bInHandler;
+static uint32_t g_ui32Errors;
+
+/*
+ * The model is entered by the program and by the timer signal.  The signal
+ * only does its work when the program is outside the model, and otherwise
+ * leaves it to the program on its way out.
+ */
+static volatile sig_atomic_t g_iBusy;
+static volatile sig_atomic_t g_iTick;
+static uint32_t g_ui32PreemptBytes;
+
+static void ModelTick(void);
+
+static void
+ModelEnter(void)
+{
+    g_iBusy++;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+static void
+ModelLeave(void)
+{
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    if((g_iBusy == 1) && g_iTick)
+    {
+        g_iTick = 0;
+        ModelTick();
+    }
+
+    g_iBusy--;
+}
+
+static void
+ModelError(const char *pcError)
+{
+    if(g_ui32Errors++ < 10)
+        fprintf(stderr, "uart model: %s\n", pcError);
+}
+
+static tTestUART *
+ModelUART(uint32_t ui32Base)
+{
+    uint32_t ui32Port = (ui32Base - UART0_BASE) >> 12;
+
+    if((ui32Port >= TEST_UART_PORTS) ||
+       (ui32Base != UART0_BASE + (ui32Port << 12)))
+    {
+        ModelError("not UART0 to UART2");
+        return(&g_psUARTs[0]);
+    }
+
+    return(&g_psUARTs[ui32Port]);
+}
+
+static tTestUART *
+ModelInt(uint32_t ui32Interrupt)
+{
+    switch(ui32Interrupt)
+    {
+        case INT_UART0:
+            return(&g_psUARTs[0]);
+
+        case INT_UART1:
+            return(&g_psUARTs[1]);
+
+        case INT_UART2:
+            return(&g_psUARTs[2]);
+
+        default:
+            ModelError("not the interrupt of UART0 to UART2");
+            return(NULL);
+    }
+}
+
+/*
+ * Takes the interrupts that are raised, enabled and unmasked, until there
+ * are none left.  Handlers do not nest.
+ */
+static void
+ModelDeliver(void)
+{
+    tTestUART *psUART;
+    uint32_t ui32Port, ui32Round;
+    bool bTaken = true;
+
+    for(ui32Round = 0; bTaken && !g_bMasked && !g_bInHandler; ui32Round++)
+    {
+        if(ui32Round == TEST_INT_ROUNDS)
+        {
+            ModelError("interrupt never cleared");
+            return;
+        }
+
+        bTaken = false;
+
+        for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+        {
+            psUART = &g_psUARTs[ui32Port];
+
+            if(!psUART->bEnabled || !psUART->pfnHandler ||
+               (!psUART->bPending && !(psUART->ui32RIS & psUART->ui32IM)))
+                continue;
+
+            psUART->bPending = false;
+            g_bInHandler = true;
+            psUART->pfnHandler();
+            g_bInHandler = false;
+            bTaken = true;
+        }
+    }
+}
+
+/*
+ * Lets the uDMA channels of the transmit FIFOs fill them.  A channel that
+ * has moved all its bytes disables itself and interrupts on the vector of
+ * its UART.
+ */
+static void
+ModelDMA(void)
+{
+    tTestDMA *psChannel;
+    tTestUART *psUART;
+    uint32_t ui32Channel;
+
+    for(ui32Channel = 0; ui32Channel < TEST_UDMA_CHANNELS; ui32Channel++)
+    {
+        psChannel = &g_psChannels[ui32Channel];
+
+        if(!psChannel->bEnabled || !psChannel->bAssigned)
+            continue;
+
+        psUART = &g_psUARTs[psChannel->ui32Port];
+
+        if(!psUART->bDMA)
+            continue;
+
+        while(psChannel->ui32Count && (psUART->ui32TxCount < TEST_UART_FIFO))
+        {
+            psUART->pui8Tx[(psUART->ui32TxHead + psUART->ui32TxCount++) %
+                           TEST_UART_FIFO] = *psChannel->pui8Src++;
+            psChannel->ui32Count--;
+        }
+
+        if(!psChannel->ui32Count)
+        {
+            psChannel->bEnabled = false;
+            psUART->bPending = true;
+        }
+    }
+}
+
+static void
+ModelPut(tTestUART *psUART, uint8_t ui8Byte)
+{
+    psUART->pui8Tx[(psUART->ui32TxHead + psUART->ui32TxCount++) %
+                   TEST_UART_FIFO] = ui8Byte;
+
+    if(psUART->ui32TxCount > psUART->ui32TxLevel)
+        psUART->ui32RIS &= ~UART_INT_TX;
+}
+
+static uint32_t
+ModelReceive(uint32_t ui32Port, const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    tTestUART *psUART = &g_psUARTs[ui32Port];
+    uint32_t ui32Idx, ui32Taken = 0;
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(psUART->ui32RxCount == TEST_UART_FIFO)
+        {
+            psUART->ui32RIS |= UART_INT_OE;
+            continue;
+        }
+
+        psUART->pui8Rx[(psUART->ui32RxHead + psUART->ui32RxCount++) %
+                       TEST_UART_FIFO] = pui8Data[ui32Idx];
+        ui32Taken++;
+
+        if(psUART->ui32RxCount >= psUART->ui32RxLevel)
+        {
+            psUART->ui32RIS |= UART_INT_RX;
+            ModelDeliver();
+        }
+    }
+
+    if(psUART->ui32RxCount)
+        psUART->ui32RIS |= UART_INT_RT;
+
+    ModelDeliver();
+
+    return(ui32Taken);
+}
+
+static uint32_t
+ModelSend(uint32_t ui32Port, uint32_t ui32Bytes)
+{
+    tTestUART *psUART = &g_psUARTs[ui32Port];
+    uint32_t ui32Sent;
+
+    if(!psUART->pui8Capture &&
+       !(psUART->pui8Capture = malloc(TEST_UART_CAPTURE)))
+    {
+        ModelError("no memory for the capture");
+        return(0);
+    }
+
+    for(ui32Sent = 0; (ui32Sent < ui32Bytes) && psUART->ui32TxCount;
+        ui32Sent++)
+    {
+        if(psUART->ui32Captured == TEST_UART_CAPTURE)
+            ModelError("capture full");
+        else
+            psUART->pui8Capture[psUART->ui32Captured++] =
+                psUART->pui8Tx[psUART->ui32TxHead];
+
+        psUART->ui32TxHead = (psUART->ui32TxHead + 1) % TEST_UART_FIFO;
+
+        /*
+         * The transmit interrupt is raised as the FIFO goes down through
+         * its level, and a uDMA transfer may be done.  Nothing else can be
+         * raised by a byte going out, so the interrupts need looking at
+         * only then.
+         */
+        if(--psUART->ui32TxCount == psUART->ui32TxLevel)
+        {
+            psUART->ui32RIS |= UART_INT_TX;
+            ModelDeliver();
+        }
+
+        if(psUART->bDMA)
+        {
+            ModelDMA();
+            ModelDeliver();
+        }
+    }
+
+    return(ui32Sent);
+}
+
+static void
+ModelTick(void)
+{
+    tTestUART *psUART;
+    uint32_t ui32Port, ui32Len;
+
+    for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+    {
+        psUART = &g_psUARTs[ui32Port];
+
+        if(!psUART->pfnHandler)
+            continue;
+
+        ModelSend(ui32Port, g_ui32PreemptBytes);
+
+        ui32Len = psUART->ui32InputLen - psUART->ui32Input;
+
+        if(ui32Len > psUART->ui32InputBytes)
+            ui32Len = psUART->ui32InputBytes;
+
+        if(ui32Len && psUART->pfnReady())
+            psUART->ui32Input +=
+                ModelReceive(ui32Port, psUART->pui8Input + psUART->ui32Input,
+                             ui32Len);
+    }
+}
+
+static void
+ModelSignal(int iSignal)
+{
+    if(g_iBusy)
+    {
+        g_iTick = 1;
+        return;
+    }
+
+    ModelEnter();
+    ModelTick();
+    ModelLeave();
+}
+
+void
+TestUARTHandler(uint32_t ui32Port, void (*pfnHandler)(void))
+{
+    g_psUARTs[ui32Port].pfnHandler = pfnHandler;
+}
+
+/*
+ * Sends up to ui32Bytes bytes out of the transmit FIFO, taking the
+ * interrupts this raises, and returns how many were sent.
+ */
+uint32_t
+TestUARTSend(uint32_t ui32Port, uint32_t ui32Bytes)
+{
+    uint32_t ui32Sent;
+
+    ModelEnter();
+    ui32Sent = ModelSend(ui32Port, ui32Bytes);
+    ModelLeave();
+
+    return(ui32Sent);
+}
+
+/*
+ * Sends until the transmit FIFO stays empty.
+ */
+void
+TestUARTDrain(uint32_t ui32Port)
+{
+    while(TestUARTSend(ui32Port, TEST_UART_FIFO))
+        ;
+}
+
+/*
+ * Receives bytes, taking the interrupts as the receive FIFO fills, and the
+ * receive timeout after the last.  Returns the number of bytes that found
+ * room in the FIFO.
+ */
+uint32_t
+TestUARTReceive(uint32_t ui32Port, const void *pvData, uint32_t ui32Len)
+{
+    uint32_t ui32Taken;
+
+    ModelEnter();
+    ui32Taken = ModelReceive(ui32Port, pvData, ui32Len);
+    ModelLeave();
+
+    return(ui32Taken);
+}
+
+/*
+ * Gives the timer signal of TestUARTPreempt() bytes to receive, up to
+ * ui32Bytes of them at every tick.  pfnReady stands in for a flow control
+ * line: the signal receives only while it returns true.
+ */
+void
+TestUARTInput(uint32_t ui32Port, const void *pvData, uint32_t ui32Len,
+              uint32_t ui32Bytes, bool (*pfnReady)(void))
+{
+    tTestUART *psUART = &g_psUARTs[ui32Port];
+
+    ModelEnter();
+    psUART->pui8Input = pvData;
+    psUART->ui32InputLen = ui32Len;
+    psUART->ui32Input = 0;
+    psUART->ui32InputBytes = ui32Bytes;
+    psUART->pfnReady = pfnReady;
+    ModelLeave();
+}
+
+/*
+ * Returns how many bytes of the input have been received.
+ */
+uint32_t
+TestUARTInputDone(uint32_t ui32Port)
+{
+    return(g_psUARTs[ui32Port].ui32Input);
+}
+
+const uint8_t *
+TestUARTCapture(uint32_t ui32Port, uint32_t *pui32Len)
+{
+    *pui32Len = g_psUARTs[ui32Port].ui32Captured;
+
+    return(g_psUARTs[ui32Port].pui8Capture);
+}
+
+void
+TestUARTCaptureClear(uint32_t ui32Port)
+{
+    g_psUARTs[ui32Port].ui32Captured = 0;
+}
+
+/*
+ * Sends ui32Bytes bytes of every UART with a handler from a timer signal
+ * every ui32Usec microseconds, or stops doing so if ui32Usec is zero.
+ */
+void
+TestUARTPreempt(uint32_t ui32Usec, uint32_t ui32Bytes)
+{
+    struct itimerval sTimer;
+    struct sigaction sAction;
+
+    memset(&sAction, 0, sizeof(sAction));
+    sAction.sa_handler = ModelSignal;
+    sigemptyset(&sAction.sa_mask);
+    sAction.sa_flags = SA_RESTART;
+    sigaction(SIGALRM, &sAction, NULL);
+
+    g_ui32PreemptBytes = ui32Bytes;
+    memset(&sTimer, 0, sizeof(sTimer));
+    sTimer.it_interval.tv_usec = ui32Usec;
+    sTimer.it_value.tv_usec = ui32Usec;
+    setitimer(ITIMER_REAL, &sTimer, NULL);
+}
+
+uint32_t
+TestUARTErrors(void)
+{
+    return(g_ui32Errors);
+}
+
+/*
+ * driverlib.
+ */
+bool
+SysCtlPeripheralPresent(uint32_t ui32Peripheral)
+{
+    return((ui32Peripheral == SYSCTL_PERIPH_UART0) ||
+           (ui32Peripheral == SYSCTL_PERIPH_UART1) ||
+           (ui32Peripheral == SYSCTL_PERIPH_UART2));
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+bool
+IntMasterEnable(void)
+{
+    bool bMasked = g_bMasked;
+
+    ModelEnter();
+    g_bMasked = false;
+    ModelDeliver();
+    ModelLeave();
+
+    return(bMasked);
+}
+
+bool
+IntMasterDisable(void)
+{
+    bool bMasked = g_bMasked;
+
+    g_bMasked = true;
+
+    return(bMasked);
+}
+
+void
+IntEnable(uint32_t ui32Interrupt)
+{
+    tTestUART *psUART = ModelInt(ui32Interrupt);
+
+    if(!psUART)
+        return;
+
+    ModelEnter();
+    psUART->bEnabled = true;
+    ModelDeliver();
+    ModelLeave();
+}
+
+void
+IntDisable(uint32_t ui32Interrupt)
+{
+    tTestUART *psUART = ModelInt(ui32Interrupt);
+
+    if(psUART)
+        psUART->bEnabled = false;
+}
+
+void
+IntPendSet(uint32_t ui32Interrupt)
+{
+    tTestUART *psUART = ModelInt(ui32Interrupt);
+
+    if(!psUART)
+        return;
+
+    ModelEnter();
+    psUART->bPending = true;
+    ModelDeliver();
+    ModelLeave();
+}
+
+void
+UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                    uint32_t ui32Baud, uint32_t ui32Config)
+{
+    ModelUART(ui32Base);
+}
+
+void
+UARTEnable(uint32_t ui32Base)
+{
+}
+
+void
+UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                 uint32_t ui32RxLevel)
+{
+    static const uint8_t pui8Eighths[] = { 1, 2, 4, 6, 7 };
+    tTestUART *psUART = ModelUART(ui32Base);
+
+    if((ui32TxLevel > UART_FIFO_TX7_8) || (ui32RxLevel > UART_FIFO_RX7_8))
+    {
+        ModelError("bad FIFO level");
+        return;
+    }
+
+    psUART->ui32TxLevel = pui8Eighths[ui32TxLevel] * TEST_UART_FIFO / 8;
+    psUART->ui32RxLevel = pui8Eighths[ui32RxLevel >> 3] * TEST_UART_FIFO / 8;
+}
+
+void
+UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    tTestUART *psUART = ModelUART(ui32Base);
+
+    ModelEnter();
+    psUART->ui32IM |= ui32IntFlags;
+    ModelDeliver();
+    ModelLeave();
+}
+
+void
+UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    ModelEnter();
+    ModelUART(ui32Base)->ui32IM &= ~ui32IntFlags;
+    ModelLeave();
+}
+
+uint32_t
+UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    tTestUART *psUART = ModelUART(ui32Base);
+
+    return(bMasked ? (psUART->ui32RIS & psUART->ui32IM) : psUART->ui32RIS);
+}
+
+void
+UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    ModelEnter();
+    ModelUART(ui32Base)->ui32RIS &= ~ui32IntFlags;
+    ModelLeave();
+}
+
+bool
+UARTSpaceAvail(uint32_t ui32Base)
+{
+    return(ModelUART(ui32Base)->ui32TxCount < TEST_UART_FIFO);
+}
+
+bool
+UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    tTestUART *psUART = ModelUART(ui32Base);
+    bool bPut = false;
+
+    ModelEnter();
+
+    if(psUART->ui32TxCount < TEST_UART_FIFO)
+    {
+        ModelPut(psUART, ucData);
+        bPut = true;
+    }
+
+    ModelLeave();
+
+    return(bPut);
+}
+
+/*
+ * Waits for room by sending a byte.
+ */
+void
+UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    tTestUART *psUART = ModelUART(ui32Base);
+
+    ModelEnter();
+
+    if(psUART->ui32TxCount == TEST_UART_FIFO)
+        ModelSend(psUART - g_psUARTs, 1);
+
+    ModelPut(psUART, ucData);
+    ModelLeave();
+}
+
+bool
+UARTCharsAvail(uint32_t ui32Base)
+{
+    return(ModelUART(ui32Base)->ui32RxCount != 0);
+}
+
+int32_t
+UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    tTestUART *psUART = ModelUART(ui32Base);
+    int32_t i32Char = -1;
+
+    ModelEnter();
+
+    if(psUART->ui32RxCount)
+    {
+        i32Char = psUART->pui8Rx[psUART->ui32RxHead];
+        psUART->ui32RxHead = (psUART->ui32RxHead + 1) % TEST_UART_FIFO;
+        psUART->ui32RxCount--;
+    }
+
+    ModelLeave();
+
+    return(i32Char);
+}
+
+/*
+ * Nothing arrives while waiting, so an empty FIFO is an error.
+ */
+int32_t
+UARTCharGet(uint32_t ui32Base)
+{
+    int32_t i32Char = UARTCharGetNonBlocking(ui32Base);
+
+    if(i32Char < 0)
+    {
+        ModelError("UARTCharGet() would wait for ever");
+        return(0);
+    }
+
+    return(i32Char);
+}
+
+void
+UARTDMAEnable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    tTestUART *psUART = ModelUART(ui32Base);
+
+    ModelEnter();
+
+    if(ui32DMAFlags & UART_DMA_TX)
+        psUART->bDMA = true;
+
+    ModelDMA();
+    ModelDeliver();
+    ModelLeave();
+}
+
+void
+UARTDMADisable(uint32_t ui32Base, uint32_t ui32DMAFlags)
+{
+    if(ui32DMAFlags & UART_DMA_TX)
+        ModelUART(ui32Base)->bDMA = false;
+}
+
+void
+uDMAEnable(void)
+{
+}
+
+void
+uDMAControlBaseSet(void *pControlTable)
+{
+}
+
+void
+uDMAChannelAssign(uint32_t ui32Mapping)
+{
+    tTestDMA *psChannel = &g_psChannels[ui32Mapping & 0x1F];
+
+    psChannel->bAssigned = true;
+
+    switch(ui32Mapping)
+    {
+        case UDMA_CH9_UART0TX:
+            psChannel->ui32Port = 0;
+            break;
+
+        case UDMA_CH23_UART1TX:
+            psChannel->ui32Port = 1;
+            break;
+
+        case UDMA_CH1_UART2TX:
+            psChannel->ui32Port = 2;
+            break;
+
+        default:
+            ModelError("not a transmit channel of UART0 to UART2");
+            psChannel->bAssigned = false;
+            break;
+    }
+}
+
+void
+uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+}
+
+/*
+ * Byte transfers from memory to the data register are all the model moves.
+ */
+void
+uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control)
+{
+    if((ui32Control & 0xFF000000) != (UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                                      UDMA_DST_INC_NONE))
+        ModelError("not a byte transfer to a register");
+}
+
+void
+uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                       void *pvSrcAddr, void *pvDstAddr,
+                       uint32_t ui32TransferSize)
+{
+    tTestDMA *psChannel = &g_psChannels[ui32ChannelStructIndex & 0x1F];
+
+    if(psChannel->bEnabled)
+        ModelError("transfer set up on a running channel");
+
+    if((ui32ChannelStructIndex & UDMA_ALT_SELECT) ||
+       (ui32Mode != UDMA_MODE_BASIC))
+        ModelError("not a basic transfer on the primary structure");
+
+    if(!ui32TransferSize || (ui32TransferSize > TEST_UDMA_SPAN_MAX))
+        ModelError("transfer of no bytes or more than the uDMA can move");
+
+    if(!psChannel->bAssigned ||
+       ((uintptr_t)pvDstAddr !=
+        UART0_BASE + (psChannel->ui32Port << 12) + UART_O_DR))
+        ModelError("transfer not to the data register of its UART");
+
+    psChannel->pui8Src = pvSrcAddr;
+    psChannel->ui32Count = ui32TransferSize;
+}
+
+void
+uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    ModelEnter();
+    g_psChannels[ui32ChannelNum & 0x1F].bEnabled = true;
+    ModelDMA();
+    ModelDeliver();
+    ModelLeave();
+}
+
+void
+uDMAChannelDisable(uint32_t ui32ChannelNum)
+{
+    g_psChannels[ui32ChannelNum & 0x1F].bEnabled = false;
+}
+
+bool
+uDMAChannelIsEnabled(uint32_t ui32ChannelNum)
+{
+    return(g_psChannels[ui32ChannelNum & 0x1F].bEnabled);
+}
+
+void
+uDMAIntClear(uint32_t ui32ChanMask)
+{
+}
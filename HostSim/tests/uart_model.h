@@ -0,0 +1,46 @@
+#ifndef __TESTS_UART_MODEL_H__
+#define __TESTS_UART_MODEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Model of the driverlib calls uartstdio.c makes to the UART, the interrupt
+ * controller and the uDMA, for testing the projects' copy of it on the host
+ * without the simulator.
+ *
+ * UART0 to UART2 each have 16 byte FIFOs.  The line sends bytes out of the
+ * transmit FIFO into a capture buffer only when a test calls
+ * TestUARTSend(), and TestUARTReceive() puts bytes into the receive FIFO as
+ * if they had arrived.  A uDMA channel assigned to the transmit FIFO of a
+ * UART fills it while it has room, and interrupts on the vector of the UART
+ * when its transfer is done.
+ *
+ * Interrupts are taken at once when they are raised, enabled and unmasked,
+ * by calling the handler given to TestUARTHandler(), and never nest.  With
+ * TestUARTPreempt(), a timer signal also sends a few bytes of every UART at
+ * random points of the program, and receives a few of the bytes given to
+ * TestUARTInput(), so the handlers preempt the code using the ring buffers
+ * as they would on the chip.
+ *
+ * Misuse of the model, such as a uDMA transfer set up while the channel is
+ * running, is counted in TestUARTErrors().
+ */
+#define TEST_UART_PORTS         3
+#define TEST_UART_FIFO          16
+#define TEST_UART_CAPTURE       (64U << 20)
+
+void TestUARTHandler(uint32_t ui32Port, void (*pfnHandler)(void));
+uint32_t TestUARTSend(uint32_t ui32Port, uint32_t ui32Bytes);
+void TestUARTDrain(uint32_t ui32Port);
+uint32_t TestUARTReceive(uint32_t ui32Port, const void *pvData,
+                         uint32_t ui32Len);
+const uint8_t *TestUARTCapture(uint32_t ui32Port, uint32_t *pui32Len);
+void TestUARTCaptureClear(uint32_t ui32Port);
+void TestUARTPreempt(uint32_t ui32Usec, uint32_t ui32Bytes);
+void TestUARTInput(uint32_t ui32Port, const void *pvData, uint32_t ui32Len,
+                   uint32_t ui32Bytes, bool (*pfnReady)(void));
+uint32_t TestUARTInputDone(uint32_t ui32Port);
+uint32_t TestUARTErrors(void);
+
+#endif
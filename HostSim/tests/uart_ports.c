@@ -0,0 +1,295 @@
+/*
+ * Test of the ports of uartport.h, built with UART_STDIO_PORTS for UART1 and
+ * UART2 beside the console on UART0, and transmit and receive buffers of
+ * different sizes: each port must keep to its own UART, buffers and echo
+ * setting, with the console and the other port busy at the same time, and
+ * flushing one must leave the others alone.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uartport.h"
+#include "uart_model.h"
+
+#define PORTS_TEST_OUTPUT       (1U << 20)
+#define PORTS_TEST_INPUT        (64U << 10)
+
+static uint32_t g_ui32Random = 1;
+
+static uint32_t
+PortsTestRandom(void)
+{
+    g_ui32Random ^= g_ui32Random << 13;
+    g_ui32Random ^= g_ui32Random >> 17;
+    g_ui32Random ^= g_ui32Random << 5;
+
+    return(g_ui32Random);
+}
+
+/*
+ * What each UART should have sent, and how much of it.
+ */
+static uint8_t *g_ppui8Expect[TEST_UART_PORTS];
+static uint32_t g_pui32Expect[TEST_UART_PORTS];
+
+static tUARTPort *g_psPort1, *g_psPort2;
+
+static void
+PortsTestExpect(uint32_t ui32Port, const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pcBuf[ui32Idx] == '\n')
+            g_ppui8Expect[ui32Port][g_pui32Expect[ui32Port]++] = '\r';
+
+        g_ppui8Expect[ui32Port][g_pui32Expect[ui32Port]++] = pcBuf[ui32Idx];
+    }
+}
+
+/*
+ * Writes all of ui32Len bytes to the console, or to the port of the UART,
+ * retrying while the buffer is full.
+ */
+static void
+PortsTestWrite(uint32_t ui32Port, const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Taken;
+
+    for(ui32Taken = 0; ui32Taken < ui32Len; )
+    {
+        if(ui32Port == 0)
+            ui32Taken += UARTwrite(pcBuf + ui32Taken, ui32Len - ui32Taken);
+        else
+            ui32Taken += UARTPortWrite((ui32Port == 1) ? g_psPort1 :
+                                       g_psPort2, pcBuf + ui32Taken,
+                                       ui32Len - ui32Taken);
+    }
+
+    PortsTestExpect(ui32Port, pcBuf, ui32Len);
+}
+
+/*
+ * Compares the bytes of the capture of a UART that are in pcSet, or all of
+ * them if it is 0, with what it should have sent.
+ */
+static bool
+PortsTestCheck(const char *pcTest, uint32_t ui32Port, const char *pcSet)
+{
+    const uint8_t *pui8Capture;
+    uint32_t ui32Len, ui32Idx, ui32Sent = 0;
+
+    pui8Capture = TestUARTCapture(ui32Port, &ui32Len);
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pcSet && !strchr(pcSet, pui8Capture[ui32Idx]))
+            continue;
+
+        if((ui32Sent == g_pui32Expect[ui32Port]) ||
+           (pui8Capture[ui32Idx] != g_ppui8Expect[ui32Port][ui32Sent]))
+        {
+            printf("%s: UART%u byte %u out of order\n", pcTest, ui32Port,
+                   ui32Idx);
+            return(false);
+        }
+
+        ui32Sent++;
+    }
+
+    if(ui32Sent != g_pui32Expect[ui32Port])
+    {
+        printf("%s: UART%u sent %u bytes, %u expected\n", pcTest, ui32Port,
+               ui32Sent, g_pui32Expect[ui32Port]);
+        return(false);
+    }
+
+    printf("%s: UART%u sent %u bytes in order\n", pcTest, ui32Port, ui32Sent);
+
+    return(true);
+}
+
+static void
+PortsTestClear(void)
+{
+    uint32_t ui32Port;
+
+    for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+    {
+        TestUARTDrain(ui32Port);
+        TestUARTCaptureClear(ui32Port);
+        g_pui32Expect[ui32Port] = 0;
+    }
+}
+
+static bool
+PortsTestReady(void)
+{
+    return(UARTPortRxBytesAvail(g_psPort1) <= UART1_RX_BUFFER_SIZE - 4);
+}
+
+int
+main(void)
+{
+    static const char pcLower[] = "abcdefghijklmnopqrstuvwxyz\n";
+    static const char pcOutput[] = "abcdefghijklmnopqrstuvwxyz\r\n";
+    static const char pcUpper[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    uint32_t ui32Port, ui32Len, ui32Idx, ui32Read;
+    char pcBuf[128];
+    uint8_t *pui8Input;
+    bool bPass = true;
+
+    for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+        g_ppui8Expect[ui32Port] = malloc(TEST_UART_CAPTURE);
+
+    pui8Input = malloc(PORTS_TEST_INPUT);
+
+    TestUARTHandler(0, UARTStdioIntHandler);
+    TestUARTHandler(1, UARTPort1IntHandler);
+    TestUARTHandler(2, UARTPort2IntHandler);
+    UARTStdioConfig(0, 115200, 16000000);
+    g_psPort1 = UARTPortOpen(1, 115200, 16000000);
+    g_psPort2 = UARTPortOpen(2, 115200, 16000000);
+
+    /*
+     * The buffers of each port are its own size.
+     */
+    if((UARTTxBytesFree() != UART_TX_BUFFER_SIZE) ||
+       (UARTPortTxBytesFree(g_psPort1) != UART1_TX_BUFFER_SIZE) ||
+       (UARTPortTxBytesFree(g_psPort2) != UART_TX_BUFFER_SIZE))
+    {
+        printf("sizes: %d, %d and %d bytes free\n", UARTTxBytesFree(),
+               UARTPortTxBytesFree(g_psPort1),
+               UARTPortTxBytesFree(g_psPort2));
+        bPass = false;
+    }
+
+    /*
+     * Formatted output and echo on the UART of each port, UART2 without
+     * echo, and lines read back from each.
+     */
+    UARTPortEchoSet(g_psPort2, false);
+    UARTprintf("console %d\n", 0);
+    PortsTestExpect(0, "console 0\n", 10);
+    UARTPortPrintf(g_psPort1, "port %u, %s\n", 1, "echo");
+    PortsTestExpect(1, "port 1, echo\n", 13);
+    UARTPortPrintf(g_psPort2, "port %x\n", 2);
+    PortsTestExpect(2, "port 2\n", 7);
+
+    TestUARTReceive(1, "one\r", 4);
+    memcpy(g_ppui8Expect[1] + g_pui32Expect[1], "one\r\n\r", 6);
+    g_pui32Expect[1] += 6;
+    TestUARTReceive(2, "two\r", 4);
+
+    for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+        TestUARTDrain(ui32Port);
+
+    if((UARTRxBytesAvail() != 0) || (UARTPortPeek(g_psPort1, '\r') != 3) ||
+       (UARTPortGets(g_psPort1, pcBuf, sizeof(pcBuf)) != 3) ||
+       strcmp(pcBuf, "one") ||
+       (UARTPortGets(g_psPort2, pcBuf, sizeof(pcBuf)) != 3) ||
+       strcmp(pcBuf, "two"))
+    {
+        printf("lines: not read back from their own ports\n");
+        bPass = false;
+    }
+
+    for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+        bPass &= PortsTestCheck("echo", ui32Port, 0);
+
+    /*
+     * Flushing the buffers of one port leaves the others alone.
+     */
+    PortsTestClear();
+    TestUARTReceive(1, "left", 4);
+    PortsTestExpect(1, "left", 4);
+    TestUARTReceive(2, "flushed", 7);
+    PortsTestWrite(0, "console kept\n", 13);
+    PortsTestWrite(1, "port 1 kept\n", 12);
+
+    /*
+     * The FIFO of UART2 has taken the first 16 bytes when the rest is
+     * discarded.
+     */
+    UARTPortWrite(g_psPort2, "port 2 discarded\n", 17);
+    PortsTestExpect(2, "port 2 discarded", 16);
+    UARTPortFlushTx(g_psPort2, true);
+    UARTPortFlushRx(g_psPort2);
+
+    for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+    {
+        TestUARTDrain(ui32Port);
+        bPass &= PortsTestCheck("flush", ui32Port, 0);
+    }
+
+    if((UARTPortRxBytesAvail(g_psPort1) != 4) ||
+       (UARTPortRxBytesAvail(g_psPort2) != 0) ||
+       (UARTPortTxBytesFree(g_psPort2) != UART_TX_BUFFER_SIZE))
+    {
+        printf("flush: UART1 has %d bytes, UART2 %d\n",
+               UARTPortRxBytesAvail(g_psPort1),
+               UARTPortRxBytesAvail(g_psPort2));
+        bPass = false;
+    }
+
+    UARTPortFlushRx(g_psPort1);
+
+    /*
+     * All three written at once, and sent from the timer signal, with input
+     * received and echoed on UART1 meanwhile.
+     */
+    PortsTestClear();
+
+    for(ui32Idx = 0; ui32Idx < PORTS_TEST_INPUT; ui32Idx++)
+        pui8Input[ui32Idx] = pcUpper[PortsTestRandom() % 26];
+
+    TestUARTInput(1, pui8Input, PORTS_TEST_INPUT, 4, PortsTestReady);
+    TestUARTPreempt(20, 64);
+
+    for(ui32Read = 0; (ui32Read < PORTS_TEST_INPUT) ||
+        (g_pui32Expect[0] < PORTS_TEST_OUTPUT); )
+    {
+        ui32Port = PortsTestRandom() % TEST_UART_PORTS;
+        ui32Len = 1 + (PortsTestRandom() % 100);
+
+        for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+            pcBuf[ui32Idx] = pcLower[PortsTestRandom() % 27];
+
+        PortsTestWrite(ui32Port, pcBuf, ui32Len);
+
+        while(UARTPortRxBytesAvail(g_psPort1))
+        {
+            if(UARTPortGetc(g_psPort1) != pui8Input[ui32Read++])
+            {
+                printf("preempted: UART1 byte %u read out of order\n",
+                       ui32Read - 1);
+                bPass = false;
+            }
+        }
+    }
+
+    UARTFlushTx(false);
+    UARTPortFlushTx(g_psPort1, false);
+    UARTPortFlushTx(g_psPort2, false);
+    TestUARTPreempt(0, 0);
+
+    for(ui32Port = 0; ui32Port < TEST_UART_PORTS; ui32Port++)
+    {
+        TestUARTDrain(ui32Port);
+        bPass &= PortsTestCheck("preempted", ui32Port, pcOutput);
+    }
+
+    memcpy(g_ppui8Expect[1], pui8Input, PORTS_TEST_INPUT);
+    g_pui32Expect[1] = PORTS_TEST_INPUT;
+    bPass &= PortsTestCheck("preempted echo", 1, pcUpper);
+
+    if(TestUARTErrors())
+    {
+        printf("%u misuses of the model\n", TestUARTErrors());
+        bPass = false;
+    }
+
+    return(bPass ? 0 : 1);
+}
@@ -0,0 +1,224 @@
+/*
+ * Stress test of the ring buffers of uartstdio.c, built with UART_BUFFERED
+ * and buffers small enough to wrap all the time: output written while a
+ * timer signal sends it, preempting the writer anywhere, must be sent as
+ * written, and input received from the signal must be read as received, its
+ * echo sent in order with the output around it.  Echo that comes while the
+ * output is part way through a write, or finds the buffer full, waits for
+ * the write to end; none is lost at the rates used here.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/uartstdio.h"
+#include "uart_model.h"
+
+#define RING_TEST_OUTPUT        (2U << 20)
+#define RING_TEST_INPUT         (200U << 10)
+#define RING_TEST_WRITE_MAX     200
+
+static uint32_t g_ui32Random = 1;
+
+static uint32_t
+RingTestRandom(void)
+{
+    g_ui32Random ^= g_ui32Random << 13;
+    g_ui32Random ^= g_ui32Random >> 17;
+    g_ui32Random ^= g_ui32Random << 5;
+
+    return(g_ui32Random);
+}
+
+/*
+ * What the line should have sent, and how much of it.
+ */
+static uint8_t *g_pui8Expect;
+static uint32_t g_ui32Expect;
+
+/*
+ * Writes all of ui32Len bytes, retrying while the buffer is full, and adds
+ * them to what is expected with their LFs made CRLFs.
+ */
+static void
+RingTestWrite(const char *pcBuf, uint32_t ui32Len)
+{
+    uint32_t ui32Idx, ui32Taken;
+
+    for(ui32Taken = 0; ui32Taken < ui32Len; )
+        ui32Taken += UARTwrite(pcBuf + ui32Taken, ui32Len - ui32Taken);
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pcBuf[ui32Idx] == '\n')
+            g_pui8Expect[g_ui32Expect++] = '\r';
+
+        g_pui8Expect[g_ui32Expect++] = pcBuf[ui32Idx];
+    }
+}
+
+/*
+ * Compares the bytes of the capture of UART0 that are in pcSet, or all of
+ * them if it is 0, with pui8Expect.
+ */
+static bool
+RingTestCheck(const char *pcTest, const char *pcSet, const uint8_t *pui8Expect,
+              uint32_t ui32Expect)
+{
+    const uint8_t *pui8Capture;
+    uint32_t ui32Len, ui32Idx, ui32Sent = 0;
+
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pcSet && !strchr(pcSet, pui8Capture[ui32Idx]))
+            continue;
+
+        if((ui32Sent == ui32Expect) ||
+           (pui8Capture[ui32Idx] != pui8Expect[ui32Sent]))
+        {
+            printf("%s: byte %u of the capture out of order\n", pcTest,
+                   ui32Idx);
+            return(false);
+        }
+
+        ui32Sent++;
+    }
+
+    if(ui32Sent != ui32Expect)
+    {
+        printf("%s: %u bytes sent, %u expected\n", pcTest, ui32Sent,
+               ui32Expect);
+        return(false);
+    }
+
+    printf("%s: %u bytes sent in order\n", pcTest, ui32Sent);
+
+    return(true);
+}
+
+/*
+ * Flow control of the input: the signal receives more only while the
+ * receive buffer has room for all it might.
+ */
+static bool
+RingTestReady(void)
+{
+    return(UARTRxBytesAvail() <= UART_RX_BUFFER_SIZE - 4);
+}
+
+int
+main(void)
+{
+    static const char pcLower[] = "abcdefghijklmnopqrstuvwxyz\n";
+    static const char pcOutput[] = "abcdefghijklmnopqrstuvwxyz\r\n";
+    static const char pcUpper[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    char pcBuf[RING_TEST_WRITE_MAX];
+    uint32_t ui32Len, ui32Idx, ui32Read;
+    uint8_t *pui8Input;
+    bool bPass = true;
+
+    g_pui8Expect = malloc(TEST_UART_CAPTURE);
+    pui8Input = malloc(RING_TEST_INPUT);
+
+    TestUARTHandler(0, UARTStdioIntHandler);
+    UARTStdioConfig(0, 115200, 16000000);
+
+    /*
+     * Echo behind output already in the FIFO and the buffer, then behind a
+     * buffer too full to take it at once.
+     */
+    RingTestWrite("first line of output\nsecond line of output\n", 43);
+    TestUARTReceive(0, "ab", 2);
+    memcpy(g_pui8Expect + g_ui32Expect, "ab", 2);
+    g_ui32Expect += 2;
+
+    while((ui32Len = UARTwrite("full\n", 5)) == 5)
+    {
+        memcpy(g_pui8Expect + g_ui32Expect, "full\r\n", 6);
+        g_ui32Expect += 6;
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+        g_pui8Expect[g_ui32Expect++] = "full"[ui32Idx];
+
+    TestUARTReceive(0, "cd", 2);
+    memcpy(g_pui8Expect + g_ui32Expect, "cd", 2);
+    g_ui32Expect += 2;
+    TestUARTDrain(0);
+    UARTFlushRx();
+    bPass &= RingTestCheck("echo", 0, g_pui8Expect, g_ui32Expect);
+
+    /*
+     * Output of random bytes and lengths, sent from the signal.
+     */
+    TestUARTCaptureClear(0);
+    g_ui32Expect = 0;
+    UARTEchoSet(false);
+    TestUARTPreempt(20, 64);
+
+    while(g_ui32Expect < RING_TEST_OUTPUT)
+    {
+        ui32Len = 1 + (RingTestRandom() % RING_TEST_WRITE_MAX);
+
+        for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+            pcBuf[ui32Idx] = 1 + (RingTestRandom() % 255);
+
+        RingTestWrite(pcBuf, ui32Len);
+    }
+
+    UARTFlushTx(false);
+    TestUARTPreempt(0, 0);
+    TestUARTDrain(0);
+    bPass &= RingTestCheck("preempted output", 0, g_pui8Expect, g_ui32Expect);
+
+    /*
+     * Input received from the signal and echoed while output is written.
+     */
+    TestUARTCaptureClear(0);
+    g_ui32Expect = 0;
+    UARTEchoSet(true);
+
+    for(ui32Idx = 0; ui32Idx < RING_TEST_INPUT; ui32Idx++)
+        pui8Input[ui32Idx] = pcUpper[RingTestRandom() % 26];
+
+    TestUARTInput(0, pui8Input, RING_TEST_INPUT, 4, RingTestReady);
+    TestUARTPreempt(20, 64);
+
+    for(ui32Read = 0; ui32Read < RING_TEST_INPUT; )
+    {
+        ui32Len = 1 + (RingTestRandom() % 40);
+
+        for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+            pcBuf[ui32Idx] = pcLower[RingTestRandom() % 27];
+
+        RingTestWrite(pcBuf, ui32Len);
+
+        while(UARTRxBytesAvail())
+        {
+            if(UARTgetc() != pui8Input[ui32Read++])
+            {
+                printf("preempted input: byte %u read out of order\n",
+                       ui32Read - 1);
+                bPass = false;
+            }
+        }
+    }
+
+    UARTFlushTx(false);
+    TestUARTPreempt(0, 0);
+    TestUARTDrain(0);
+    bPass &= RingTestCheck("preempted input", pcUpper, pui8Input,
+                           RING_TEST_INPUT);
+    bPass &= RingTestCheck("output around the echo", pcOutput, g_pui8Expect,
+                           g_ui32Expect);
+
+    if(TestUARTErrors())
+    {
+        printf("%u misuses of the model\n", TestUARTErrors());
+        bPass = false;
+    }
+
+    return(bPass ? 0 : 1);
+}
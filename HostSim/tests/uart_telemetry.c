@@ -0,0 +1,415 @@
+/*
+ * End to end test of the telemetry frames of uartstdio.c, built with
+ * UART_BUFFERED and UART_TELEMETRY: the frames UARTTelemetrySend() encodes
+ * into the transmit buffer are sent by the model of the UART and fed to the
+ * decoder of sim/telemetry.c, which must hand back every frame sent, with
+ * its data, and count as lost exactly those dropped for want of room.  The
+ * frames include empty ones, ones of UART_TELEMETRY_DATA_MAX bytes with and
+ * without zeros, and enough of them for the sequence number to wrap; a
+ * capture with bytes changed or cut out must fail the CRC of the frames hit
+ * and only those.  Deferred log records between frames, zeros and all, must
+ * cost no frame.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/uartstdio.h"
+#include "uarttelemetry.h"
+#include "uartlog.h"
+#include "uart_model.h"
+#include "../sim/telemetry.h"
+
+#define TELEMETRY_TEST_FRAMES   20000
+#define TELEMETRY_TEST_WRAP     70000
+#define TELEMETRY_TEST_LOGS     2000
+#define TELEMETRY_TEST_SENDS    (2 * TELEMETRY_TEST_FRAMES +                  \
+                                 TELEMETRY_TEST_WRAP + TELEMETRY_TEST_LOGS + 8)
+
+static uint32_t g_ui32Random = 1;
+
+static uint32_t
+TelemetryTestRandom(void)
+{
+    g_ui32Random ^= g_ui32Random << 13;
+    g_ui32Random ^= g_ui32Random >> 17;
+    g_ui32Random ^= g_ui32Random << 5;
+
+    return(g_ui32Random);
+}
+
+/*
+ * Every call of UARTTelemetrySend() in order, with the length of its data,
+ * and which of them sent their frame.  The channel and data of a frame come
+ * from its number, a quarter of the bytes zeros unless bZeroFree.
+ */
+static uint8_t g_pui8Len[TELEMETRY_TEST_SENDS];
+static bool g_pbZeroFree[TELEMETRY_TEST_SENDS];
+static bool g_pbSent[TELEMETRY_TEST_SENDS];
+static uint32_t g_ui32Sends;
+
+static uint8_t
+TelemetryTestData(uint32_t ui32Send, uint8_t *pui8Data)
+{
+    uint32_t ui32Hash, ui32Idx;
+
+    ui32Hash = (ui32Send + 1) * 0x9E3779B9;
+
+    for(ui32Idx = 0; ui32Idx < g_pui8Len[ui32Send]; ui32Idx++)
+    {
+        ui32Hash ^= ui32Hash << 13;
+        ui32Hash ^= ui32Hash >> 17;
+        ui32Hash ^= ui32Hash << 5;
+        pui8Data[ui32Idx] = (uint8_t)(ui32Hash >> 8);
+
+        if(g_pbZeroFree[ui32Send])
+            pui8Data[ui32Idx] |= !pui8Data[ui32Idx];
+        else if(!(ui32Hash & 3))
+            pui8Data[ui32Idx] = 0;
+    }
+
+    return((uint8_t)ui32Send);
+}
+
+static bool
+TelemetryTestSend(uint32_t ui32Len, bool bZeroFree)
+{
+    uint8_t pui8Data[UART_TELEMETRY_DATA_MAX], ui8Channel;
+    uint32_t ui32Send = g_ui32Sends++;
+
+    g_pui8Len[ui32Send] = ui32Len;
+    g_pbZeroFree[ui32Send] = bZeroFree;
+    ui8Channel = TelemetryTestData(ui32Send, pui8Data);
+    g_pbSent[ui32Send] = UARTTelemetrySend(ui8Channel, pui8Data, ui32Len);
+
+    return(g_pbSent[ui32Send]);
+}
+
+/*
+ * Returns the number of runs of bytes without a zero in a deferred log
+ * record, each of which the decoder takes for a frame.
+ */
+static uint32_t
+TelemetryTestRuns(const uint8_t *pui8Record, uint32_t ui32Len)
+{
+    uint32_t ui32Idx, ui32Runs = 0;
+
+    for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pui8Record[ui32Idx] &&
+           (!ui32Idx || !pui8Record[ui32Idx - 1]))
+            ui32Runs++;
+    }
+
+    return(ui32Runs);
+}
+
+/*
+ * The frames decoded are checked against the sends from g_ui32Check on,
+ * skipping those dropped, and those that differ counted.
+ */
+static uint32_t g_ui32Check, g_ui32Wrong;
+
+static void
+TelemetryTestHandler(void *pvContext, const tSimTelemetryFrame *psFrame)
+{
+    uint8_t pui8Data[UART_TELEMETRY_DATA_MAX];
+    uint32_t *pui32Skip = pvContext;
+
+    while((g_ui32Check < g_ui32Sends) &&
+          (!g_pbSent[g_ui32Check] ||
+           ((uint16_t)g_ui32Check != psFrame->ui16Seq)))
+    {
+        if(g_pbSent[g_ui32Check])
+            (*pui32Skip)++;
+
+        g_ui32Check++;
+    }
+
+    if((g_ui32Check == g_ui32Sends) ||
+       (psFrame->ui8Channel != TelemetryTestData(g_ui32Check, pui8Data)) ||
+       (psFrame->ui32Len != g_pui8Len[g_ui32Check]) ||
+       memcmp(psFrame->pui8Data, pui8Data, psFrame->ui32Len))
+    {
+        g_ui32Wrong++;
+    }
+
+    g_ui32Check++;
+}
+
+/*
+ * Decodes the capture of UART0 from the sends from ui32First to ui32Last, a
+ * byte at a time if bBytewise, and checks the frames and counts against
+ * those expected: ui32Bad frames failing, and as many more lost, and
+ * ui32Noise runs of bytes that were never frames failing as well.
+ */
+static bool
+TelemetryTestDecode(const char *pcTest, const uint8_t *pui8Capture,
+                    uint32_t ui32Len, uint32_t ui32First, uint32_t ui32Last,
+                    uint32_t ui32Skipped, uint32_t ui32Bad, uint32_t ui32Noise,
+                    bool bBytewise)
+{
+    tSimTelemetry sTelemetry;
+    uint32_t ui32Idx, ui32Sent = 0, ui32Lost = 0, ui32Missed = 0;
+
+    /*
+     * The first and last frames of every part of the test are sent, so
+     * every frame dropped in between is seen as lost.
+     */
+    for(ui32Idx = ui32First; ui32Idx < ui32Last; ui32Idx++)
+    {
+        if(g_pbSent[ui32Idx])
+            ui32Sent++;
+        else
+            ui32Lost++;
+    }
+
+    g_ui32Check = ui32First;
+    g_ui32Wrong = 0;
+    SimTelemetryInit(&sTelemetry, TelemetryTestHandler, &ui32Missed);
+
+    if(bBytewise)
+    {
+        for(ui32Idx = 0; ui32Idx < ui32Len; ui32Idx++)
+            SimTelemetryFeed(&sTelemetry, pui8Capture + ui32Idx, 1);
+    }
+    else
+    {
+        SimTelemetryFeed(&sTelemetry, pui8Capture, ui32Len);
+    }
+
+    if((sTelemetry.sStats.ui64Frames != ui32Sent - ui32Bad) ||
+       (sTelemetry.sStats.ui64Lost != ui32Lost + ui32Bad) ||
+       (sTelemetry.sStats.ui64Bad != ui32Bad + ui32Noise) ||
+       (sTelemetry.sStats.ui64Skipped != ui32Skipped) ||
+       (ui32Missed != ui32Bad) || g_ui32Wrong)
+    {
+        printf("%s: %llu frames, %llu lost, %llu bad, %llu bytes skipped, "
+               "%u wrong; %u sent, %u dropped, %u damaged\n", pcTest,
+               (unsigned long long)sTelemetry.sStats.ui64Frames,
+               (unsigned long long)sTelemetry.sStats.ui64Lost,
+               (unsigned long long)sTelemetry.sStats.ui64Bad,
+               (unsigned long long)sTelemetry.sStats.ui64Skipped,
+               g_ui32Wrong, ui32Sent, ui32Lost, ui32Bad);
+        return(false);
+    }
+
+    printf("%s: %u frames decoded, %u lost, %u bad\n", pcTest,
+           ui32Sent - ui32Bad, ui32Lost + ui32Bad, ui32Bad);
+
+    return(true);
+}
+
+int
+main(void)
+{
+    static const char pcLogFormat[] = "%d %d";
+    const uint8_t *pui8Capture;
+    uint8_t *pui8Damaged;
+    uint32_t ui32Len, ui32Idx, ui32First, ui32Frame, ui32Damaged, ui32Start;
+    uint32_t ui32Noise, pui32Record[3];
+    bool bPass = true;
+
+    pui8Damaged = malloc(TEST_UART_CAPTURE);
+
+    TestUARTHandler(0, UARTStdioIntHandler);
+    UARTStdioConfig(0, 115200, 16000000);
+
+    /*
+     * Text, then frames of random lengths with and without zeros, the
+     * longest among them, sent faster than the line can take them so that
+     * some are dropped.  The first frame is preceded by a zero, which ends
+     * the text.
+     */
+    ui32First = g_ui32Sends;
+    UARTprintf("boot text %d\n", 42);
+
+    TelemetryTestSend(0, false);
+    TelemetryTestSend(UART_TELEMETRY_DATA_MAX, false);
+
+    for(ui32Frame = 0; ui32Frame < TELEMETRY_TEST_FRAMES; ui32Frame++)
+    {
+        ui32Len = TelemetryTestRandom() % 8;
+        ui32Len = (ui32Len == 0) ? UART_TELEMETRY_DATA_MAX :
+                  TelemetryTestRandom() % (UART_TELEMETRY_DATA_MAX + 1);
+        TelemetryTestSend(ui32Len, !(TelemetryTestRandom() % 4));
+        TestUARTSend(0, TelemetryTestRandom() % 300);
+    }
+
+    TestUARTDrain(0);
+    TelemetryTestSend(1, false);
+    TestUARTDrain(0);
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+    bPass &= TelemetryTestDecode("frames", pui8Capture, ui32Len, ui32First,
+                                 g_ui32Sends, 14, 0, 0, false);
+    bPass &= TelemetryTestDecode("frames a byte at a time", pui8Capture,
+                                 ui32Len, ui32First, g_ui32Sends, 14, 0, 0,
+                                 true);
+
+    /*
+     * A byte in the middle of every hundredth frame changed, or cut out as
+     * if the line had lost it.  (A frame whose CRC ends in a zero, losing
+     * the code byte that stands for that zero and nothing else, would pass
+     * with its last byte of data taken for the CRC; a CRC without a final
+     * XOR cannot tell.)
+     */
+    memcpy(pui8Damaged, pui8Capture, ui32Len);
+
+    for(ui32Idx = ui32Start = 14, ui32Frame = ui32Damaged = 0;
+        ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pui8Damaged[ui32Idx])
+            continue;
+
+        if(++ui32Frame % 100 == 50)
+        {
+            pui8Damaged[(ui32Start + ui32Idx) / 2] ^= 0x5a;
+            pui8Damaged[(ui32Start + ui32Idx) / 2] |=
+                !pui8Damaged[(ui32Start + ui32Idx) / 2];
+            ui32Damaged++;
+        }
+
+        ui32Start = ui32Idx + 1;
+    }
+
+    bPass &= TelemetryTestDecode("bytes changed", pui8Damaged, ui32Len,
+                                 ui32First, g_ui32Sends, 14, ui32Damaged, 0,
+                                 false);
+
+    memcpy(pui8Damaged, pui8Capture, ui32Len);
+
+    for(ui32Idx = ui32Start = 14, ui32Frame = ui32Damaged = 0;
+        ui32Idx < ui32Len; ui32Idx++)
+    {
+        if(pui8Damaged[ui32Idx])
+            continue;
+
+        if(++ui32Frame % 100 == 50)
+        {
+            memmove(pui8Damaged + (ui32Start + ui32Idx) / 2,
+                    pui8Damaged + (ui32Start + ui32Idx) / 2 + 1,
+                    ui32Len - (ui32Start + ui32Idx) / 2 - 1);
+            ui32Len--;
+            ui32Idx--;
+            ui32Damaged++;
+        }
+
+        ui32Start = ui32Idx + 1;
+    }
+
+    bPass &= TelemetryTestDecode("bytes cut out", pui8Damaged, ui32Len,
+                                 ui32First, g_ui32Sends, 14, ui32Damaged, 0,
+                                 false);
+
+    /*
+     * A frame of UART_TELEMETRY_DATA_MAX bytes without a zero is 254 bytes
+     * without a zero before encoding, so its code byte is 255.
+     */
+    TestUARTCaptureClear(0);
+    ui32First = g_ui32Sends;
+    TelemetryTestSend(UART_TELEMETRY_DATA_MAX, true);
+    TestUARTDrain(0);
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+
+    if((ui32Len != UART_TELEMETRY_FRAME_SIZE(UART_TELEMETRY_DATA_MAX)) ||
+       (pui8Capture[0] != 255) || memchr(pui8Capture, 0, ui32Len - 1) ||
+       pui8Capture[ui32Len - 1])
+    {
+        printf("longest: frame not encoded as %u bytes, code 255\n",
+               UART_TELEMETRY_FRAME_SIZE(UART_TELEMETRY_DATA_MAX));
+        bPass = false;
+    }
+
+    bPass &= TelemetryTestDecode("longest", pui8Capture, ui32Len, ui32First,
+                                 g_ui32Sends, 0, 0, 0, false);
+
+
+    /*
+     * Enough short frames for the sequence number to wrap, the frame that
+     * takes 0 again preceded by a zero.
+     */
+    TestUARTCaptureClear(0);
+    ui32First = g_ui32Sends;
+
+    for(ui32Frame = 0; ui32Frame < TELEMETRY_TEST_WRAP; ui32Frame++)
+    {
+        TelemetryTestSend(ui32Frame % 8, false);
+        TestUARTDrain(0);
+    }
+
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+    bPass &= TelemetryTestDecode("sequence wrap", pui8Capture, ui32Len,
+                                 ui32First, g_ui32Sends, 0, 0, 0, false);
+
+    /*
+     * Frames sent from a timer signal, preempting the sender anywhere.  The
+     * sender waits for room for most of them, and drops the rest if there
+     * is none.
+     */
+    TestUARTCaptureClear(0);
+    ui32First = g_ui32Sends;
+    TestUARTPreempt(20, 64);
+
+    for(ui32Frame = 0; ui32Frame < TELEMETRY_TEST_FRAMES; ui32Frame++)
+    {
+        ui32Len = TelemetryTestRandom() % 64;
+
+        if(TelemetryTestRandom() % 4)
+        {
+            while(UARTTxBytesFree() < (int)UART_TELEMETRY_FRAME_SIZE(ui32Len))
+            {
+            }
+        }
+
+        TelemetryTestSend(ui32Len, false);
+    }
+
+    UARTFlushTx(false);
+    TelemetryTestSend(1, false);
+    UARTFlushTx(false);
+    TestUARTPreempt(0, 0);
+    TestUARTDrain(0);
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+    bPass &= TelemetryTestDecode("preempted", pui8Capture, ui32Len,
+                                 ui32First, g_ui32Sends, 0, 0, 0, false);
+
+    /*
+     * A deferred log record, with zeros among its arguments but not at its
+     * end, after every frame.  The decoder takes the pieces of the records for bad frames,
+     * but every frame must come through.
+     */
+    TestUARTCaptureClear(0);
+    ui32First = g_ui32Sends;
+
+    for(ui32Frame = ui32Noise = 0; ui32Frame < TELEMETRY_TEST_LOGS;
+        ui32Frame++)
+    {
+        TelemetryTestSend(TelemetryTestRandom() % 64, false);
+
+        pui32Record[0] = UART_LOG_MARK | 2 |
+                         ((uint32_t)(uintptr_t)pcLogFormat << 8);
+        pui32Record[1] = ui32Frame & 0xFF00;
+        pui32Record[2] = 0x5A000000 | (ui32Frame & 0xFF);
+        ui32Noise += TelemetryTestRuns((const uint8_t *)pui32Record,
+                                       sizeof(pui32Record));
+
+        UARTLogWrite2(pcLogFormat, pui32Record[1], pui32Record[2]);
+        TestUARTDrain(0);
+    }
+
+    TelemetryTestSend(1, false);
+    TestUARTDrain(0);
+
+    pui8Capture = TestUARTCapture(0, &ui32Len);
+    bPass &= TelemetryTestDecode("log records", pui8Capture, ui32Len,
+                                 ui32First, g_ui32Sends, 0, 0, ui32Noise,
+                                 false);
+
+    if(TestUARTErrors())
+    {
+        printf("%u misuses of the model\n", TestUARTErrors());
+        bPass = false;
+    }
+
+    return(bPass ? 0 : 1);
+}
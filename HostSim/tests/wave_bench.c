@@ -0,0 +1,212 @@
+/*
+ * Benchmark of the waveform capture: the time a firmware toggling PF1 as
+ * fast as it can takes to simulate, without a waveform, with a VCD file and
+ * with a gzip compressed one, interpreted and translated.  Three times are
+ * compared: the host time until the file is closed, so a writer left behind
+ * is charged for; the processor time of the simulation thread, which is
+ * what the capture slows the simulation by when the writer and the
+ * compressors have cores of their own; and the processor time of all the
+ * threads, which is what it costs on a single core.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../sim/cpu.h"
+#include "../sim/translate.h"
+#include "../sim/wave.h"
+
+#define BENCH_CYCLES            (32ULL << 20)
+#define BENCH_RUNS              5
+
+/*
+ * The firmware: the vector table, then
+ *
+ *  0x40    ldr r0, =0x400FE608     RCGCGPIO
+ *          movs r1, #0x20
+ *          str r1, [r0]
+ *          ldr r0, =0x40025000     GPIOF
+ *          movs r1, #0x0E
+ *          str.w r1, [r0, #0x400]  DIR
+ *          str.w r1, [r0, #0x51C]  DEN
+ *          movs r2, #0x02
+ *          movs r1, #0
+ *  0x56    eors r1, r2
+ *          str.w r1, [r0, #0x3FC]  DATA
+ *          b 0x56
+ *
+ * which changes PF1 every three instructions.
+ */
+static const uint16_t g_pui16Toggle[] =
+{
+    0x8000, 0x2000, 0x0041, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000,
+    0x4807, 0x2120, 0x6001, 0x4807, 0x210E, 0xF8C0, 0x1400, 0xF8C0,
+    0x151C, 0x2202, 0x2100, 0x4051, 0xF8C0, 0x13FC, 0xE7FB, 0xBF00,
+    0xE608, 0x400F, 0x5000, 0x4002
+};
+
+static tSimWave *g_psWave;
+static uint64_t g_ui64Edges;
+
+static void
+BenchPinChange(void *pvContext, tSimBoard *psBoard, uint32_t ui32Port,
+               uint8_t ui8Old, uint8_t ui8New)
+{
+    if(g_psWave)
+        SimWaveChange(g_psWave, psBoard->ui64Time, ui32Port, ui8New);
+
+    g_ui64Edges++;
+}
+
+static double
+BenchSeconds(clockid_t sClock)
+{
+    struct timespec sNow;
+
+    clock_gettime(sClock, &sNow);
+
+    return(sNow.tv_sec + sNow.tv_nsec / 1e9);
+}
+
+/*
+ * The times compared, in the order above.
+ */
+#define BENCH_CLOCKS            3
+
+static const clockid_t g_psClocks[BENCH_CLOCKS] =
+{
+    CLOCK_MONOTONIC, CLOCK_THREAD_CPUTIME_ID, CLOCK_PROCESS_CPUTIME_ID
+};
+
+/*
+ * Runs the firmware for BENCH_CYCLES cycles, capturing to pcPath unless it
+ * is 0, and lowers the times in pdBest to those of the run if they are
+ * less.
+ */
+static void
+BenchRun(bool bTranslate, const char *pcPath, double *pdBest)
+{
+    tSimBoardHooks sHooks;
+    tSimMachine *psMachine;
+    double pdStart[BENCH_CLOCKS], dTime;
+    uint32_t ui32Clock;
+
+    memset(&sHooks, 0, sizeof(sHooks));
+    sHooks.pfnPinChange = BenchPinChange;
+    psMachine = calloc(1, sizeof(*psMachine));
+
+    if(!psMachine || !SimCpuInit(psMachine, &sHooks) ||
+       (bTranslate && !SimTranslateInit(psMachine)) ||
+       !SimMemoryLoad(&psMachine->sMemory, 0, g_pui16Toggle,
+                      sizeof(g_pui16Toggle)))
+    {
+        fprintf(stderr, "cannot set up the machine\n");
+        exit(1);
+    }
+
+    SimCpuInvalidate(psMachine);
+    SimCpuReset(psMachine);
+    g_ui64Edges = 0;
+
+    if(pcPath && !(g_psWave = SimWaveOpen(pcPath)))
+    {
+        fprintf(stderr, "%s: cannot create\n", pcPath);
+        exit(1);
+    }
+
+    for(ui32Clock = 0; ui32Clock < BENCH_CLOCKS; ui32Clock++)
+        pdStart[ui32Clock] = BenchSeconds(g_psClocks[ui32Clock]);
+
+    SimCpuRun(psMachine, BENCH_CYCLES);
+
+    /*
+     * The simulation thread is done once the run is.
+     */
+    dTime = BenchSeconds(CLOCK_THREAD_CPUTIME_ID) - pdStart[1];
+
+    if(dTime < pdBest[1])
+        pdBest[1] = dTime;
+
+    if(g_psWave && !SimWaveClose(g_psWave, psMachine->sBoard.ui64Time, NULL))
+    {
+        fprintf(stderr, "%s: write error\n", pcPath);
+        exit(1);
+    }
+
+    g_psWave = NULL;
+
+    for(ui32Clock = 0; ui32Clock < BENCH_CLOCKS; ui32Clock += 2)
+    {
+        dTime = BenchSeconds(g_psClocks[ui32Clock]) - pdStart[ui32Clock];
+
+        if(dTime < pdBest[ui32Clock])
+            pdBest[ui32Clock] = dTime;
+    }
+
+    SimCpuFree(psMachine);
+    free(psMachine);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const char * const ppcMode[3] = { "none", "vcd", "vcd.gz" };
+    const char *ppcPath[3] = { NULL, NULL, NULL };
+    char pcVcd[256], pcGz[256];
+    double ppdBest[3][BENCH_CLOCKS];
+    uint32_t ui32Mode, ui32Run, ui32Translate, ui32Clock;
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "Usage: %s directory\n", argv[0]);
+        return(2);
+    }
+
+    snprintf(pcVcd, sizeof(pcVcd), "%s/wave_bench.vcd", argv[1]);
+    snprintf(pcGz, sizeof(pcGz), "%s/wave_bench.vcd.gz", argv[1]);
+    ppcPath[1] = pcVcd;
+    ppcPath[2] = pcGz;
+
+    for(ui32Translate = 0; ui32Translate < 2; ui32Translate++)
+    {
+        /*
+         * The best of a few runs of each, the others having been slowed by
+         * the rest of the machine.
+         */
+        for(ui32Mode = 0; ui32Mode < 3; ui32Mode++)
+        {
+            for(ui32Clock = 0; ui32Clock < BENCH_CLOCKS; ui32Clock++)
+                ppdBest[ui32Mode][ui32Clock] = 1e9;
+
+            for(ui32Run = 0; ui32Run < BENCH_RUNS; ui32Run++)
+                BenchRun(ui32Translate != 0, ppcPath[ui32Mode],
+                         ppdBest[ui32Mode]);
+        }
+
+        printf("%s, %.1f M edges per host second; against no waveform, "
+               "host time,\nsimulation thread and all threads:\n",
+               ui32Translate ? "translated" : "interpreted",
+               g_ui64Edges / ppdBest[0][0] / 1e6);
+
+        for(ui32Mode = 1; ui32Mode < 3; ui32Mode++)
+        {
+            printf("  %-6s", ppcMode[ui32Mode]);
+
+            for(ui32Clock = 0; ui32Clock < BENCH_CLOCKS; ui32Clock++)
+                printf(" %+7.1f%%", 100 * (ppdBest[ui32Mode][ui32Clock] /
+                                           ppdBest[0][ui32Clock] - 1));
+
+            printf("\n");
+        }
+    }
+
+    remove(pcVcd);
+    remove(pcGz);
+
+    return(0);
+}
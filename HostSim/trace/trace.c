@@ -0,0 +1,225 @@
+/*
+ * Prints or compares the register access traces written by the instruction
+ * set simulator with --trace (see trace.h).
+ *
+ * A trace is printed one access a line, from the first access at or after
+ * --from on, found through the index of the trace, up to --to.  Two traces
+ * are compared access by access, direction, address, width and value but
+ * not cycle or instruction address, so two builds of a firmware doing the
+ * same to the hardware compare equal however fast they do it.  Reads, of
+ * status registers polled a varying number of times say, can be left out
+ * with --writes, and the accesses looked at narrowed to a range of
+ * addresses with --address.
+ */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../sim/trace.h"
+
+/*
+ * Differences listed before a comparison gives up.
+ */
+#define TRACE_DIFFERENCES       10
+
+typedef struct
+{
+    uint64_t ui64From;
+    uint64_t ui64To;
+    uint32_t ui32Low;
+    uint32_t ui32High;
+    bool bWrites;
+} tTraceFilter;
+
+/*
+ * Returns the next access of a trace the filter lets through.
+ */
+static bool
+TraceNext(tSimTraceReader *psReader, const tTraceFilter *psFilter,
+          tSimTraceRecord *psRecord)
+{
+    while(SimTraceNext(psReader, psRecord))
+    {
+        if(psRecord->ui64Cycle > psFilter->ui64To)
+            return(false);
+
+        if((psRecord->ui32Addr >= psFilter->ui32Low) &&
+           (psRecord->ui32Addr <= psFilter->ui32High) &&
+           (psRecord->bWrite || !psFilter->bWrites))
+            return(true);
+    }
+
+    return(false);
+}
+
+static void
+TracePrint(const char *pcPrefix, const tSimTraceRecord *psRecord)
+{
+    printf("%s%12llu  0x%08x  %c%u 0x%08x = 0x%0*x\n", pcPrefix,
+           (unsigned long long)psRecord->ui64Cycle, psRecord->ui32PC,
+           psRecord->bWrite ? 'W' : 'R', psRecord->ui8Size,
+           psRecord->ui32Addr, psRecord->ui8Size * 2, psRecord->ui32Value);
+}
+
+static int
+TraceDump(const char *pcPath, const tTraceFilter *psFilter)
+{
+    tSimTraceReader sReader;
+    tSimTraceRecord sRecord;
+
+    if(!SimTraceOpen(&sReader, pcPath))
+    {
+        fprintf(stderr, "%s: not a trace\n", pcPath);
+        return(1);
+    }
+
+    SimTraceSeek(&sReader, psFilter->ui64From);
+
+    printf("       cycle          pc   access\n");
+
+    while(TraceNext(&sReader, psFilter, &sRecord))
+        TracePrint("", &sRecord);
+
+    SimTraceReaderClose(&sReader);
+
+    return(0);
+}
+
+static int
+TraceDiff(const char *pcPathA, const char *pcPathB,
+          const tTraceFilter *psFilter)
+{
+    tSimTraceReader sReaderA, sReaderB;
+    tSimTraceRecord sA, sB;
+    uint64_t ui64Compared = 0;
+    uint32_t ui32Differences = 0;
+    bool bA, bB;
+
+    if(!SimTraceOpen(&sReaderA, pcPathA))
+    {
+        fprintf(stderr, "%s: not a trace\n", pcPathA);
+        return(2);
+    }
+
+    if(!SimTraceOpen(&sReaderB, pcPathB))
+    {
+        fprintf(stderr, "%s: not a trace\n", pcPathB);
+        SimTraceReaderClose(&sReaderA);
+        return(2);
+    }
+
+    SimTraceSeek(&sReaderA, psFilter->ui64From);
+    SimTraceSeek(&sReaderB, psFilter->ui64From);
+
+    for(;;)
+    {
+        bA = TraceNext(&sReaderA, psFilter, &sA);
+        bB = TraceNext(&sReaderB, psFilter, &sB);
+
+        if(!bA || !bB)
+        {
+            if(bA || bB)
+            {
+                printf("%s ends after %llu accesses\n", bA ? pcPathB : pcPathA,
+                       (unsigned long long)ui64Compared);
+                ui32Differences++;
+            }
+
+            break;
+        }
+
+        if((sA.bWrite != sB.bWrite) || (sA.ui32Addr != sB.ui32Addr) ||
+           (sA.ui8Size != sB.ui8Size) || (sA.ui32Value != sB.ui32Value))
+        {
+            printf("access %llu:\n", (unsigned long long)ui64Compared);
+            TracePrint("< ", &sA);
+            TracePrint("> ", &sB);
+
+            if(++ui32Differences == TRACE_DIFFERENCES)
+                break;
+        }
+
+        ui64Compared++;
+    }
+
+    printf("%llu accesses compared, %s\n", (unsigned long long)ui64Compared,
+           ui32Differences ? "traces differ" : "no differences");
+
+    SimTraceReaderClose(&sReaderA);
+    SimTraceReaderClose(&sReaderB);
+
+    return(ui32Differences ? 1 : 0);
+}
+
+static void
+Usage(const char *pcName)
+{
+    fprintf(stderr, "Usage: %s [--from CYCLE] [--to CYCLE] "
+            "[--address LOW[-HIGH]] [--writes]\n"
+            "       trace | --diff trace trace\n", pcName);
+    exit(2);
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const struct option psOptions[] =
+    {
+        { "from", required_argument, NULL, 'f' },
+        { "to", required_argument, NULL, 't' },
+        { "address", required_argument, NULL, 'a' },
+        { "writes", no_argument, NULL, 'w' },
+        { "diff", no_argument, NULL, 'd' },
+        { NULL, 0, NULL, 0 }
+    };
+    tTraceFilter sFilter;
+    bool bDiff = false;
+    char *pcEnd;
+    int i32Opt;
+
+    memset(&sFilter, 0, sizeof(sFilter));
+    sFilter.ui64To = UINT64_MAX;
+    sFilter.ui32High = UINT32_MAX;
+
+    while((i32Opt = getopt_long(argc, argv, "f:t:a:wd", psOptions,
+                                NULL)) != -1)
+    {
+        switch(i32Opt)
+        {
+            case 'f':
+                sFilter.ui64From = strtoull(optarg, NULL, 0);
+                break;
+
+            case 't':
+                sFilter.ui64To = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'a':
+                sFilter.ui32Low = (uint32_t)strtoul(optarg, &pcEnd, 0);
+                sFilter.ui32High = (*pcEnd == '-') ?
+                                   (uint32_t)strtoul(pcEnd + 1, NULL, 0) :
+                                   sFilter.ui32Low;
+                break;
+
+            case 'w':
+                sFilter.bWrites = true;
+                break;
+
+            case 'd':
+                bDiff = true;
+                break;
+
+            default:
+                Usage(argv[0]);
+        }
+    }
+
+    if(optind != argc - (bDiff ? 2 : 1))
+        Usage(argv[0]);
+
+    if(bDiff)
+        return(TraceDiff(argv[optind], argv[optind + 1], &sFilter));
+
+    return(TraceDump(argv[optind], &sFilter));
+}